@@ -0,0 +1,57 @@
+/* Timing macros shared by the benchmark examples.
+
+  Copyright (C) 2026 Free Software Foundation
+
+  Copying and distribution of this file, with or without modification,
+  are permitted in any medium without royalty provided the copyright
+  notice and this notice are preserved.
+
+   This file is part of the GNUstep Base Library.
+*/
+#ifndef _benchmark_h
+#define _benchmark_h
+
+#include <Foundation/Foundation.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Runs the code (one or more statements) once and prints the title
+ * with the rate at which it did 'ops' units of work.
+ */
+#define	BENCH_RATE(title, ops, units, ...) \
+  { \
+    NSDate		*benchStart = [NSDate date]; \
+    NSTimeInterval	benchTime; \
+    { __VA_ARGS__ } \
+    benchTime = -[benchStart timeIntervalSinceNow]; \
+    printf("%-40s %12.1f %s (%.3f seconds)\n", \
+      (title), (ops) / benchTime, (units), benchTime); \
+  }
+
+/* Evaluates the expression 'count' times, each in its own autorelease
+ * pool and with the iteration number in 'i', and prints the rate.
+ */
+#define	BENCH_EACH(title, count, ...) \
+  BENCH_RATE(title, (count), "per second", \
+    NSUInteger	i; \
+    for (i = 0; i < (count); i++) \
+      { \
+	CREATE_AUTORELEASE_POOL(benchPool); \
+	(void)(__VA_ARGS__); \
+	RELEASE(benchPool); \
+      })
+
+/* Returns the numeric command line argument at index n, or 'def' if
+ * there is none.
+ */
+static inline NSUInteger
+benchArgument(int argc, char **argv, int n, NSUInteger def)
+{
+  if (argc > n)
+    {
+      return (NSUInteger)strtoul(argv[n], 0, 10);
+    }
+  return def;
+}
+
+#endif
@@ -0,0 +1,75 @@
+/* A simple benchmark of base64 and hexadecimal coding throughput.
+
+  Copyright (C) 2026 Free Software Foundation
+
+  Copying and distribution of this file, with or without modification,
+  are permitted in any medium without royalty provided the copyright
+  notice and this notice are preserved.
+
+   Run as 'benchmark_codec [megabytes]' to time coding of a buffer of
+   the given size (the default is 16 megabytes) and report the
+   throughput of each operation in megabytes of input per second. */
+
+#include "benchmark.h"
+#include <GNUstepBase/GSMime.h>
+#include <GNUstepBase/NSData+GNUstepBase.h>
+
+#define	ROUNDS	10
+
+/* Codes the data ROUNDS times and prints the throughput in megabytes
+ * of input per second.
+ */
+#define	BENCH(title, size, ...) \
+  BENCH_RATE(title, ROUNDS * (size) / 1000000.0, "MB/s", \
+    unsigned	r; \
+    for (r = 0; r < ROUNDS; r++) \
+      { \
+	CREATE_AUTORELEASE_POOL(arp); \
+	(void)(__VA_ARGS__); \
+	RELEASE(arp); \
+      })
+
+int
+main(int argc, char **argv)
+{
+  NSUInteger		size = benchArgument(argc, argv, 1, 16);
+  NSMutableData		*raw;
+  NSData		*b64;
+  NSData		*b64Lines;
+  NSString		*hex;
+  unsigned char		*bytes;
+  NSUInteger		i;
+  CREATE_AUTORELEASE_POOL(pool);
+
+  size *= 1000000;
+  raw = [NSMutableData dataWithLength: size];
+  bytes = [raw mutableBytes];
+  for (i = 0; i < size; i++)
+    {
+      bytes[i] = (unsigned char)(i * 7 + (i >> 8));
+    }
+  b64 = [raw base64EncodedDataWithOptions: 0];
+  b64Lines = [raw base64EncodedDataWithOptions:
+    NSDataBase64Encoding76CharacterLineLength];
+  hex = [raw hexadecimalRepresentation];
+  printf("Coding %lu bytes %d times\n", (unsigned long)size, ROUNDS);
+
+  BENCH("-base64EncodedDataWithOptions:", size,
+    [raw base64EncodedDataWithOptions: 0]);
+  BENCH("-base64EncodedDataWithOptions: 76", size,
+    [raw base64EncodedDataWithOptions:
+      NSDataBase64Encoding76CharacterLineLength]);
+  BENCH("-initWithBase64EncodedData:options:", [b64 length],
+    AUTORELEASE([[NSData alloc] initWithBase64EncodedData: b64 options: 0]));
+  BENCH("+[GSMimeDocument encodeBase64:]", size,
+    [GSMimeDocument encodeBase64: raw]);
+  BENCH("+[GSMimeDocument decodeBase64:] 76", [b64Lines length],
+    [GSMimeDocument decodeBase64: b64Lines]);
+  BENCH("-hexadecimalRepresentation", size,
+    [raw hexadecimalRepresentation]);
+  BENCH("-initWithHexadecimalRepresentation:", [hex length],
+    AUTORELEASE([[NSData alloc] initWithHexadecimalRepresentation: hex]));
+
+  RELEASE(pool);
+  return 0;
+}
@@ -0,0 +1,174 @@
+/* A simple benchmark of distributed notification throughput.
+
+  Copyright (C) 2026 Free Software Foundation
+
+  Copying and distribution of this file, with or without modification,
+  are permitted in any medium without royalty provided the copyright
+  notice and this notice are preserved.
+
+   Run as 'benchmark_distributednotification [clients [posts]]' to start
+   one, two, four ... up to clients (the default is sixteen) observing
+   processes and time posting posts notifications (the default is two
+   thousand) with a small userInfo until every observer has received
+   them all, reporting the rate in posts per second for each number of
+   clients.  The processes talk to each other through gdnc, which is
+   started if it is not already running. */
+
+#include <Foundation/Foundation.h>
+#include <stdlib.h>
+
+static NSString	*Post = @"GSBenchmarkPost";
+static NSString	*Ready = @"GSBenchmarkReady";
+static NSString	*Done = @"GSBenchmarkDone";
+static NSString	*Finished = @"GSBenchmarkFinished";
+
+@interface Counter : NSObject
+{
+@public
+  NSUInteger	posts;
+  NSUInteger	replies;
+  BOOL		done;
+}
+@end
+
+@implementation Counter
+- (void) post: (NSNotification*)n
+{
+  posts++;
+}
+- (void) done: (NSNotification*)n
+{
+  done = YES;
+}
+- (void) reply: (NSNotification*)n
+{
+  replies++;
+}
+@end
+
+static void
+waitFor(Counter *counter, NSUInteger replies)
+{
+  NSRunLoop	*loop = [NSRunLoop currentRunLoop];
+  NSDate	*limit = [NSDate dateWithTimeIntervalSinceNow: 120.0];
+
+  while (counter->replies < replies && [limit timeIntervalSinceNow] > 0)
+    {
+      NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+
+      [loop runMode: NSDefaultRunLoopMode
+	 beforeDate: [NSDate dateWithTimeIntervalSinceNow: 0.1]];
+      [arp release];
+    }
+}
+
+/* An observing process counts the posts until told that the poster is
+ * done, then replies with the count.
+ */
+static int
+observe(void)
+{
+  NSDistributedNotificationCenter	*dnc;
+  NSRunLoop				*loop = [NSRunLoop currentRunLoop];
+  Counter				*counter = [Counter new];
+  NSString				*count;
+
+  dnc = [NSDistributedNotificationCenter defaultCenter];
+  [dnc addObserver: counter selector: @selector(post:)
+	      name: Post object: nil];
+  [dnc addObserver: counter selector: @selector(done:)
+	      name: Done object: nil];
+  [dnc postNotificationName: Ready object: nil];
+  while (counter->done == NO)
+    {
+      NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+
+      [loop runMode: NSDefaultRunLoopMode
+	 beforeDate: [NSDate dateWithTimeIntervalSinceNow: 0.1]];
+      [arp release];
+    }
+  count = [NSString stringWithFormat: @"%lu", (unsigned long)counter->posts];
+  [dnc postNotificationName: Finished object: count];
+  return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+  unsigned				clients = 16;
+  unsigned				posts = 2000;
+  NSDistributedNotificationCenter	*dnc;
+  NSDictionary				*info;
+  NSString				*path;
+  Counter				*counter;
+  unsigned				n;
+  CREATE_AUTORELEASE_POOL(pool);
+
+  if (argc > 1 && strcmp(argv[1], "--observe") == 0)
+    {
+      return observe();
+    }
+  if (argc > 1)
+    {
+      clients = (unsigned)atoi(argv[1]);
+    }
+  if (argc > 2)
+    {
+      posts = (unsigned)atoi(argv[2]);
+    }
+
+  dnc = [NSDistributedNotificationCenter defaultCenter];
+  counter = [Counter new];
+  path = [[NSBundle mainBundle] executablePath];
+  info = [NSDictionary dictionaryWithObjectsAndKeys:
+    @"value", @"key", [NSNumber numberWithInt: 42], @"number",
+    [NSDate date], @"date", nil];
+
+  for (n = 1; n <= clients; n *= 2)
+    {
+      NSMutableArray	*tasks = [NSMutableArray array];
+      NSDate		*start;
+      NSTimeInterval	t;
+      unsigned		i;
+
+      [dnc addObserver: counter selector: @selector(reply:)
+		  name: Ready object: nil];
+      counter->replies = 0;
+      for (i = 0; i < n; i++)
+	{
+	  [tasks addObject: [NSTask launchedTaskWithLaunchPath: path
+	    arguments: [NSArray arrayWithObject: @"--observe"]]];
+	}
+      waitFor(counter, n);
+      [dnc removeObserver: counter name: Ready object: nil];
+      if (counter->replies < n)
+	{
+	  printf("Only %lu of %u clients started\n",
+	    (unsigned long)counter->replies, n);
+	  return 1;
+	}
+
+      [dnc addObserver: counter selector: @selector(reply:)
+		  name: Finished object: nil];
+      counter->replies = 0;
+      start = [NSDate date];
+      for (i = 0; i < posts; i++)
+	{
+	  [dnc postNotificationName: Post object: nil userInfo: info];
+	}
+      [dnc postNotificationName: Done object: nil];
+      waitFor(counter, n);
+      t = -[start timeIntervalSinceNow];
+      [dnc removeObserver: counter name: Finished object: nil];
+      printf("%3u clients %12.0f posts per second (%.3f seconds)\n",
+	n, posts / t, t);
+      for (i = 0; i < n; i++)
+	{
+	  [[tasks objectAtIndex: i] waitUntilExit];
+	}
+    }
+
+  [counter release];
+  RELEASE(pool);
+  return 0;
+}
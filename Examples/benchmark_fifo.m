@@ -0,0 +1,72 @@
+/* A simple benchmark of NSMutableArray used as a queue.
+
+  Copyright (C) 2026 Free Software Foundation
+
+  Copying and distribution of this file, with or without modification,
+  are permitted in any medium without royalty provided the copyright
+  notice and this notice are preserved.
+
+   Run as 'benchmark_fifo [count]' (the default count is 1000000) to
+   time adding and removing that many objects at the ends of a mutable
+   array, as the library does for operation queues, stream caches and
+   run loop performers, and report the rate in operations per second. */
+
+#include "benchmark.h"
+
+int
+main(int argc, char **argv)
+{
+  NSUInteger		count = benchArgument(argc, argv, 1, 1000000);
+  NSMutableArray	*a;
+  id			o = @"object";
+  NSUInteger		i;
+  CREATE_AUTORELEASE_POOL(pool);
+
+  printf("Queue operations on %lu objects\n", (unsigned long)count);
+
+  a = [NSMutableArray array];
+  BENCH_RATE("fill with -addObject:", count, "ops/s",
+    for (i = 0; i < count; i++) [a addObject: o];)
+  BENCH_RATE("drain with -removeObjectAtIndex: 0", count, "ops/s",
+    for (i = 0; i < count; i++) [a removeObjectAtIndex: 0];)
+
+  BENCH_RATE("fill with -insertObject:atIndex: 0", count, "ops/s",
+    for (i = 0; i < count; i++) [a insertObject: o atIndex: 0];)
+  BENCH_RATE("drain with -removeLastObject", count, "ops/s",
+    for (i = 0; i < count; i++) [a removeLastObject];)
+
+  for (i = 0; i < 1000; i++)
+    {
+      [a addObject: o];
+    }
+  BENCH_RATE("steady queue of 1000 (add and remove)", 2 * count, "ops/s",
+    for (i = 0; i < count; i++)
+      {
+	[a addObject: o];
+	[a removeObjectAtIndex: 0];
+      })
+  [a removeAllObjects];
+
+  for (i = 0; i < count; i++)
+    {
+      [a addObject: o];
+    }
+  BENCH_RATE("steady queue of all (add and remove)", 2 * count, "ops/s",
+    for (i = 0; i < count; i++)
+      {
+	[a addObject: o];
+	[a removeObjectAtIndex: 0];
+      })
+  BENCH_RATE("-objectAtIndex: after queue use", count, "ops/s",
+    for (i = 0; i < count; i++) [a objectAtIndex: i];)
+  BENCH_RATE("fast enumeration after queue use", count, "ops/s",
+    NSFastEnumerationState	state;
+    id				buf[16];
+
+    memset(&state, '\0', sizeof(state));
+    while ([a countByEnumeratingWithState: &state objects: buf count: 16] > 0)
+      ;)
+
+  RELEASE(pool);
+  return 0;
+}
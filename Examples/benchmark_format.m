@@ -0,0 +1,38 @@
+/* A simple benchmark of string formatting with common constant formats.
+
+  Copyright (C) 2026 Free Software Foundation
+
+  Copying and distribution of this file, with or without modification,
+  are permitted in any medium without royalty provided the copyright
+  notice and this notice are preserved.
+
+   Run as 'benchmark_format [count]' to time count iterations of each
+   format (the default is one million). */
+
+#include "benchmark.h"
+
+int
+main(int argc, char **argv)
+{
+  NSUInteger	count = benchArgument(argc, argv, 1, 1000000);
+  NSString	*obj = @"object description";
+  NSMutableString	*m;
+  CREATE_AUTORELEASE_POOL(pool);
+
+  printf("Formatting %lu strings with each format\n", (unsigned long)count);
+
+  BENCH_EACH("%@", count, [NSString stringWithFormat: @"%@", obj]);
+  BENCH_EACH("%d", count, [NSString stringWithFormat: @"%d", (int)i]);
+  BENCH_EACH("%lu", count,
+    [NSString stringWithFormat: @"%lu", (unsigned long)i]);
+  BENCH_EACH("%.3f", count, [NSString stringWithFormat: @"%.3f", i / 7.0]);
+  BENCH_EACH("key-%@-%d", count,
+    [NSString stringWithFormat: @"key-%@-%d", obj, (int)i]);
+
+  m = [NSMutableString string];
+  BENCH_EACH("appendFormat: %@ %d", count,
+    ([m setString: @""], [m appendFormat: @"%@ %d", obj, (int)i], 0));
+
+  RELEASE(pool);
+  return 0;
+}
@@ -0,0 +1,91 @@
+/* A simple benchmark of message forwarding through a proxy.
+
+  Copyright (C) 2026 Free Software Foundation
+
+  Copying and distribution of this file, with or without modification,
+  are permitted in any medium without royalty provided the copyright
+  notice and this notice are preserved.
+
+   Run as 'benchmark_forwarding [count]' to time count messages of each
+   kind (the default is one million). */
+
+#include "benchmark.h"
+
+@interface	Target : NSObject
+- (int) add: (int)a to: (int)b;
+- (double) scale: (double)d;
+- (id) echo: (id)o;
+- (NSRange) rangeFrom: (NSUInteger)l;
+@end
+
+@implementation	Target
+- (int) add: (int)a to: (int)b
+{
+  return a + b;
+}
+- (double) scale: (double)d
+{
+  return d * 2.0;
+}
+- (id) echo: (id)o
+{
+  return o;
+}
+- (NSRange) rangeFrom: (NSUInteger)l
+{
+  return NSMakeRange(l, l);
+}
+@end
+
+@interface	Forwarder : NSProxy
+{
+  id	target;
+}
+- (id) initWithTarget: (id)t;
+@end
+
+@implementation	Forwarder
+- (void) dealloc
+{
+  RELEASE(target);
+  [super dealloc];
+}
+- (void) forwardInvocation: (NSInvocation*)anInvocation
+{
+  [anInvocation invokeWithTarget: target];
+}
+- (id) initWithTarget: (id)t
+{
+  target = RETAIN(t);
+  return self;
+}
+- (NSMethodSignature*) methodSignatureForSelector: (SEL)aSelector
+{
+  return [target methodSignatureForSelector: aSelector];
+}
+@end
+
+int
+main(int argc, char **argv)
+{
+  NSUInteger		count = benchArgument(argc, argv, 1, 1000000);
+  CREATE_AUTORELEASE_POOL(pool);
+  Target		*t = AUTORELEASE([Target new]);
+  id			p;
+  NSMethodSignature	*sig;
+
+  p = AUTORELEASE([[Forwarder alloc] initWithTarget: t]);
+  sig = [t methodSignatureForSelector: @selector(add:to:)];
+  printf("Sending %lu messages of each kind\n", (unsigned long)count);
+
+  BENCH_EACH("direct add:to:", count, [t add: 1 to: (int)i]);
+  BENCH_EACH("forwarded add:to:", count, [p add: 1 to: (int)i]);
+  BENCH_EACH("forwarded scale:", count, [p scale: (double)i]);
+  BENCH_EACH("forwarded echo:", count, [p echo: t]);
+  BENCH_EACH("forwarded rangeFrom:", count, [p rangeFrom: i]);
+  BENCH_EACH("invocationWithMethodSignature:", count,
+    [NSInvocation invocationWithMethodSignature: sig]);
+
+  RELEASE(pool);
+  return 0;
+}
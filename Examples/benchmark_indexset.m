@@ -0,0 +1,91 @@
+/* A simple benchmark of NSIndexSet holding large scattered sets.
+
+  Copyright (C) 2026 Free Software Foundation
+
+  Copying and distribution of this file, with or without modification,
+  are permitted in any medium without royalty provided the copyright
+  notice and this notice are preserved.
+
+   Run as 'benchmark_indexset [range]' (the default range is 10000000)
+   to time building sets holding a random half of the indexes in that
+   range, membership tests, unions, intersections and differences of
+   such sets, and enumeration, reporting the rate in operations per
+   second. */
+
+#include "benchmark.h"
+
+static NSMutableIndexSet *
+scattered(NSUInteger range, unsigned seed)
+{
+  NSMutableIndexSet	*s = [NSMutableIndexSet indexSet];
+  NSUInteger		i;
+
+  srandom(seed);
+  for (i = 0; i < range; i++)
+    {
+      if (random() & 1)
+	{
+	  [s addIndex: i];
+	}
+    }
+  return s;
+}
+
+int
+main(int argc, char **argv)
+{
+  NSUInteger		range = benchArgument(argc, argv, 1, 10000000);
+  NSMutableIndexSet	*a;
+  NSMutableIndexSet	*b;
+  NSMutableIndexSet	*m;
+  NSUInteger		found = 0;
+  NSUInteger		i;
+  CREATE_AUTORELEASE_POOL(pool);
+
+  printf("Index sets with a random half of %lu indexes\n",
+    (unsigned long)range);
+
+  BENCH_RATE("build with -addIndex:", range, "ops/s", a = scattered(range, 1);)
+  b = scattered(range, 2);
+  printf("sizes %lu and %lu\n",
+    (unsigned long)[a count], (unsigned long)[b count]);
+
+  BENCH_RATE("-containsIndex:", range, "ops/s",
+    for (i = 0; i < range; i++) found += [a containsIndex: i];)
+  BENCH_RATE("-indexGreaterThanIndex: walk", [a count], "ops/s",
+    for (i = [a firstIndex]; i != NSNotFound;
+      i = [a indexGreaterThanIndex: i]) found++;)
+
+  m = [a mutableCopy];
+  BENCH_RATE("-addIndexes: (union)", range, "ops/s", [m addIndexes: b];)
+  printf("union has %lu\n", (unsigned long)[m count]);
+  [m release];
+
+  m = [a mutableCopy];
+  BENCH_RATE("-intersectIndexes:", range, "ops/s", [m intersectIndexes: b];)
+  printf("intersection has %lu\n", (unsigned long)[m count]);
+  [m release];
+
+  m = [a mutableCopy];
+  BENCH_RATE("-removeIndexes: (difference)", range, "ops/s",
+    [m removeIndexes: b];)
+  printf("difference has %lu\n", (unsigned long)[m count]);
+  [m release];
+
+  BENCH_RATE("-isEqual: copy", range, "ops/s",
+    m = [a copy]; found += [m isEqual: a]; [m release];)
+
+  BENCH_RATE("-getIndexes:maxCount:inIndexRange:", [a count], "ops/s",
+    NSUInteger	buf[1024];
+    NSRange	r = NSMakeRange(0, NSNotFound);
+    NSUInteger	n;
+    while ((n = [a getIndexes: buf maxCount: 1024 inIndexRange: &r]) > 0)
+      found += n;)
+
+  BENCH_RATE("remove every index with -removeIndex:", range, "ops/s",
+    for (i = 0; i < range; i++) [a removeIndex: i];)
+
+  printf("(checksum %lu)\n", (unsigned long)found);
+  RELEASE(pool);
+  return 0;
+}
@@ -0,0 +1,91 @@
+/* A simple benchmark of GSMimeParser header parsing.
+
+  Copyright (C) 2026 Free Software Foundation
+
+  Copying and distribution of this file, with or without modification,
+  are permitted in any medium without royalty provided the copyright
+  notice and this notice are preserved.
+
+   Run as 'benchmark_mimeparser [count]' to time parsing the headers of
+   count (the default is fifty thousand) typical HTTP requests and
+   responses and looking up their content length, reporting the rate in
+   messages parsed per second. */
+
+#include "benchmark.h"
+#include <GNUstepBase/GSMime.h>
+
+/* Request headers as an HTTP server would pass them to the parser,
+ * after taking off the request line.
+ */
+static const char *request =
+  "Host: www.example.com\r\n"
+  "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:120.0) Gecko/20100101\r\n"
+  "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+  "Accept-Language: en-GB,en;q=0.5\r\n"
+  "Accept-Encoding: gzip, deflate, br\r\n"
+  "Connection: keep-alive\r\n"
+  "Cookie: session=0123456789abcdef; theme=dark\r\n"
+  "Upgrade-Insecure-Requests: 1\r\n"
+  "If-None-Match: \"5f8a-1234\"\r\n"
+  "Cache-Control: max-age=0\r\n"
+  "Content-Length: 0\r\n"
+  "\r\n";
+
+static const char *response =
+  "HTTP/1.1 200 OK\r\n"
+  "Date: Thu, 02 Oct 2008 17:07:20 GMT\r\n"
+  "Server: Apache/2.4.57 (Unix)\r\n"
+  "Last-Modified: Wed, 01 Oct 2008 09:00:00 GMT\r\n"
+  "ETag: \"5f8a-1234\"\r\n"
+  "Accept-Ranges: bytes\r\n"
+  "Vary: Accept-Encoding\r\n"
+  "Cache-Control: max-age=3600\r\n"
+  "Content-Type: text/html; charset=utf-8\r\n"
+  "Content-Length: 5\r\n"
+  "\r\n"
+  "hello";
+
+int
+main(int argc, char **argv)
+{
+  NSUInteger	count = benchArgument(argc, argv, 1, 50000);
+  NSData	*req;
+  NSData	*rsp;
+  NSUInteger	total = 0;
+  NSUInteger	i;
+  CREATE_AUTORELEASE_POOL(pool);
+
+  req = [NSData dataWithBytes: request length: strlen(request)];
+  rsp = [NSData dataWithBytes: response length: strlen(response)];
+
+  BENCH_RATE("request headers", count, "per second",
+    for (i = 0; i < count; i++)
+      {
+	CREATE_AUTORELEASE_POOL(arp);
+	GSMimeParser	*parser = [GSMimeParser new];
+	NSData		*body = nil;
+
+	[parser parseHeaders: req remaining: &body];
+	total += [[[[parser mimeDocument] headerNamed: @"content-length"]
+	  value] intValue];
+	[parser release];
+	RELEASE(arp);
+      })
+
+  BENCH_RATE("response headers and body", count, "per second",
+    for (i = 0; i < count; i++)
+      {
+	CREATE_AUTORELEASE_POOL(arp);
+	GSMimeParser	*parser = [GSMimeParser new];
+
+	[parser parse: rsp];
+	total += [[[[parser mimeDocument] headerNamed: @"content-length"]
+	  value] intValue];
+	[parser release];
+	RELEASE(arp);
+      })
+
+  printf("(checksum %lu)\n", (unsigned long)total);
+  RELEASE(pool);
+  return 0;
+}
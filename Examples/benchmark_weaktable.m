@@ -0,0 +1,95 @@
+/* A benchmark of weak NSHashTable and NSMapTable under object churn.
+
+  Copyright (C) 2026 Free Software Foundation
+
+  Copying and distribution of this file, with or without modification,
+  are permitted in any medium without royalty provided the copyright
+  notice and this notice are preserved.
+
+   Run as 'benchmark_weaktable [count] [live]' (the defaults are 1000000
+   and 1000) to add 'count' short-lived objects to weak tables, while
+   keeping the most recent 'live' of them alive and looking them up, as
+   a cache keyed by weak objects does.  Reports the rate of operations,
+   the number of entries left in each table and the number of dead
+   entries purged.  Weak references need runtime support; without it
+   the objects are never zeroed and the tables simply grow. */
+
+#include "benchmark.h"
+
+/* Reports the dead entries purged while the table was in use, then
+ * the number purged by the full sweep -count has to do.
+ */
+static void
+report(id table)
+{
+  NSUInteger	before = 0;
+  NSUInteger	after = 0;
+  NSUInteger	live;
+
+  [table getPurged: &before sweeps: 0];
+  live = [table count];
+  [table getPurged: &after sweeps: 0];
+  printf("  %lu dead entries purged in use, %lu left for -count,"
+    " %lu live\n", (unsigned long)before, (unsigned long)(after - before),
+    (unsigned long)live);
+}
+
+int
+main(int argc, char **argv)
+{
+  NSUInteger	count = benchArgument(argc, argv, 1, 1000000);
+  NSUInteger	live = benchArgument(argc, argv, 2, 1000);
+  NSHashTable	*h;
+  NSMapTable	*m;
+  id		*ring;
+  NSUInteger	i;
+  CREATE_AUTORELEASE_POOL(pool);
+
+  if (live == 0)
+    {
+      live = 1;
+    }
+  ring = calloc(live, sizeof(id));
+  printf("Weak tables with %lu objects added, %lu alive at a time\n",
+    (unsigned long)count, (unsigned long)live);
+
+  h = [NSHashTable weakObjectsHashTable];
+  BENCH_RATE("weak hash table add, member, die", 2 * count, "ops/s",
+    for (i = 0; i < count; i++)
+      {
+	NSUInteger	slot = i % live;
+	id		o = [NSObject new];
+
+	[h addObject: o];
+	[ring[slot] release];
+	ring[slot] = o;
+	[h member: ring[(i * 7) % live]];
+      })
+  report(h);
+
+  for (i = 0; i < live; i++)
+    {
+      DESTROY(ring[i]);
+    }
+  m = [NSMapTable weakToStrongObjectsMapTable];
+  BENCH_RATE("weak-key map table set, get, die", 2 * count, "ops/s",
+    for (i = 0; i < count; i++)
+      {
+	NSUInteger	slot = i % live;
+	id		o = [NSObject new];
+
+	[m setObject: @"value" forKey: o];
+	[ring[slot] release];
+	ring[slot] = o;
+	[m objectForKey: ring[(i * 7) % live]];
+      })
+  report(m);
+
+  for (i = 0; i < live; i++)
+    {
+      DESTROY(ring[i]);
+    }
+  free(ring);
+  RELEASE(pool);
+  return 0;
+}
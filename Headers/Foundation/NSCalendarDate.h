@@ -32,6 +32,38 @@ extern "C" {
 @class	NSTimeZone;
 @class	NSTimeZoneDetail;
 
+/**
+ * The calendar fields of a date in a particular time zone, as produced
+ * by the +getFields:forTimeIntervals:count:timeZone: method.
+ * This is a GNUstep extension.
+ * <deflist>
+ *   <term>year</term><desc>The year of the common era</desc>
+ *   <term>dayOfCommonEra</term><desc>Days since the start of the era</desc>
+ *   <term>offset</term><desc>Seconds from GMT in the time zone</desc>
+ *   <term>dayOfYear</term><desc>1 to 366</desc>
+ *   <term>millisecond</term><desc>0 to 999</desc>
+ *   <term>month</term><desc>1 to 12</desc>
+ *   <term>day</term><desc>The day of the month (1 to 31)</desc>
+ *   <term>hour</term><desc>0 to 23</desc>
+ *   <term>minute</term><desc>0 to 59</desc>
+ *   <term>second</term><desc>0 to 59</desc>
+ *   <term>dayOfWeek</term><desc>0 (sunday) to 6 (saturday)</desc>
+ * </deflist>
+ */
+typedef struct {
+  int32_t	year;
+  int32_t	dayOfCommonEra;
+  int32_t	offset;
+  uint16_t	dayOfYear;
+  uint16_t	millisecond;
+  uint8_t	month;
+  uint8_t	day;
+  uint8_t	hour;
+  uint8_t	minute;
+  uint8_t	second;
+  uint8_t	dayOfWeek;
+} GSCalendarFields;
+
 @interface NSCalendarDate : NSDate
 {
 #if	GS_EXPOSE(NSCalendarDate)
@@ -123,6 +155,26 @@ extern "C" {
 
 @end
 
+#if OS_API_VERSION(GS_API_NONE, GS_API_LATEST)
+
+@interface NSCalendarDate (GSCalendarFields)
+/**
+ * Breaks each of count time intervals (since the reference date) into
+ * its calendar fields in aTimeZone (or the local time zone if aTimeZone
+ * is nil), storing the results in the corresponding element of fields.
+ * <br />
+ * This is a GNUstep extension, much faster than creating a calendar
+ * date for each interval when bucketing large numbers of times by day
+ * or by hour.
+ */
++ (void) getFields: (GSCalendarFields*)fields
+  forTimeIntervals: (const NSTimeInterval*)intervals
+	     count: (NSUInteger)count
+	  timeZone: (NSTimeZone*)aTimeZone;
+@end
+
+#endif
+
 #if OS_API_VERSION(GS_API_NONE, GS_API_NONE)
 
 @interface NSCalendarDate (GregorianDate)
@@ -33,6 +33,7 @@
 #import	<Foundation/NSTimer.h>
 #import	<Foundation/NSRunLoop.h>
 #import	<Foundation/NSMapTable.h>
+#import	<GNUstepBase/GSBlocks.h>
 
 #if	defined(__cplusplus)
 extern "C" {
@@ -42,6 +43,7 @@ extern "C" {
 @class NSPort;
 @class NSPortNameServer;
 @class NSData;
+@class NSException;
 @class NSInvocation;
 
 /*
@@ -160,6 +162,28 @@ GS_NSConnection_IVARS;
 - (NSDictionary*) statistics;
 @end
 
+#if	OS_API_VERSION(GS_API_NONE, GS_API_NONE)
+/**
+ * Block called when the reply to an asynchronous request arrives.<br />
+ * The invocation is the one that was sent, with its return value and
+ * any pass-by-reference arguments filled in from the reply.<br />
+ * The exception is nil on success, or the exception raised by the
+ * remote method (or raised locally when the request could not be
+ * completed).
+ */
+DEFINE_BLOCK_TYPE(GSConnectionCompletionBlock, void, NSInvocation*,
+  NSException*);
+
+@interface	NSConnection (GSAsynchronous)
+- (BOOL) batchesRequests;
+- (void) flushBatchedRequests;
+- (void) sendInvocation: (NSInvocation*)inv
+	       forProxy: (NSDistantObject*)proxy
+	     completion: (GSConnectionCompletionBlock)block;
+- (void) setBatchesRequests: (BOOL)flag;
+@end
+#endif
+
 
 /**
  * This category represents an informal protocol to which NSConnection
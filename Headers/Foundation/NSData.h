@@ -50,6 +50,21 @@ enum {
 };
 #endif
 
+#if OS_API_VERSION(100900,GS_API_LATEST) 
+enum {
+  NSDataBase64DecodingIgnoreUnknownCharacters = (1UL << 0)
+};
+typedef NSUInteger NSDataBase64DecodingOptions;
+
+enum {
+  NSDataBase64Encoding64CharacterLineLength = (1UL << 0),
+  NSDataBase64Encoding76CharacterLineLength = (1UL << 1),
+  NSDataBase64EncodingEndLineWithCarriageReturn = (1UL << 4),
+  NSDataBase64EncodingEndLineWithLineFeed = (1UL << 5)
+};
+typedef NSUInteger NSDataBase64EncodingOptions;
+#endif
+
 @interface NSData : NSObject <NSCoding, NSCopying, NSMutableCopying>
 
 // Allocating and Initializing a Data Object
@@ -163,6 +178,43 @@ enum {
             options: (NSUInteger)writeOptionsMask
               error: (NSError **)errorPtr;
 #endif
+
+#if OS_API_VERSION(100900,GS_API_LATEST) 
+/**
+ * Returns the receiver's contents base64 encoded (using the standard
+ * alphabet with '=' padding) as ASCII data.<br />
+ * If the options include a line length, line endings are inserted
+ * after each 64 or 76 characters, using CR and/or LF as given by the
+ * options (CRLF if neither is specified).
+ */
+- (NSData*) base64EncodedDataWithOptions:
+  (NSDataBase64EncodingOptions)options;
+
+/**
+ * Returns the receiver's contents base64 encoded as a string.<br />
+ * See -base64EncodedDataWithOptions:
+ */
+- (NSString*) base64EncodedStringWithOptions:
+  (NSDataBase64EncodingOptions)options;
+
+/**
+ * Initialises the receiver with the result of decoding the base64 data.
+ * <br />Returns nil if the data contains characters which are not part
+ * of the base64 alphabet (unless the options contain
+ * NSDataBase64DecodingIgnoreUnknownCharacters) or is otherwise not a
+ * valid encoding.  Missing padding at the end is tolerated.
+ */
+- (id) initWithBase64EncodedData: (NSData*)base64Data
+			 options: (NSDataBase64DecodingOptions)options;
+
+/**
+ * Initialises the receiver with the result of decoding the base64
+ * string.<br />
+ * See -initWithBase64EncodedData:options:
+ */
+- (id) initWithBase64EncodedString: (NSString*)base64String
+			   options: (NSDataBase64DecodingOptions)options;
+#endif
 @end
 
 #if OS_API_VERSION(GS_API_NONE, GS_API_NONE)
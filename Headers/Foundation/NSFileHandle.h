@@ -210,6 +210,9 @@ GS_EXPORT NSString * const NSFileHandleOperationException;
 - (void) writeInBackgroundAndNotify: (NSData*)item forModes: (NSArray*)modes;
 - (void) writeInBackgroundAndNotify: (NSData*)item;
 - (BOOL) writeInProgress;
+- (unsigned long long) writeFromFileHandle: (NSFileHandle*)source
+				    offset: (unsigned long long)offset
+				    length: (unsigned long long)length;
 @end
 
 /**
@@ -316,6 +319,15 @@ GS_EXPORT NSString * const NSFileHandleOperationException;
  *   information for certificates issued by our trusted authorites but
  *   no longer valid.
  *   </desc>
+ *   <term>GSTLSSessionKey</term>
+ *   <desc>A string identifying the remote end of an outgoing connection
+ *   (normally its address and port) for session resumption.  Session data
+ *   from a completed connection is cached under this key and used to try
+ *   to resume the session (avoiding a full handshake) when a new
+ *   connection is made with the same key.<br />
+ *   If this is not specified, the address and port of the remote end
+ *   of the connection are used.
+ *   </desc>
  *   <term>GSTLSVerify</term>
  *   <desc>A boolean specifying whether we should require the remote end to
  *   supply a valid certificate in order to establish an encrypted connection.
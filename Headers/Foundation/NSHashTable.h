@@ -156,6 +156,12 @@ typedef NSUInteger NSHashTableOptions;
 
 @end
 
+#if	OS_API_VERSION(GS_API_NONE, GS_API_NONE)
+@interface	NSHashTable (GNUstep)
+- (void) getPurged: (NSUInteger*)purged sweeps: (NSUInteger*)sweeps;
+@end
+#endif
+
 
 /**
  * Type for enumerating.<br />
@@ -208,6 +208,16 @@ DEFINE_BLOCK_TYPE(GSIndexSetEnumerationBlock, void, NSUInteger, BOOL*);
  */
 - (void) addIndexesInRange: (NSRange)aRange;
 
+#if OS_API_VERSION(GS_API_NONE, GS_API_LATEST)
+/**
+ * Removes from the receiver all the indexes which are not also present
+ * in aSet.<br />
+ * This is a GNUstep extension.  When both sets are large and dense
+ * this combines whole blocks of indexes at a time.
+ */
+- (void) intersectIndexes: (NSIndexSet*)aSet;
+#endif
+
 /**
  * Removes all indexes stored in the receiver.
  */
@@ -165,6 +165,12 @@ typedef NSUInteger NSMapTableOptions;
 - (NSPointerFunctions*) valuePointerFunctions;
 @end
 
+#if	OS_API_VERSION(GS_API_NONE, GS_API_NONE)
+@interface	NSMapTable (GNUstep)
+- (void) getPurged: (NSUInteger*)purged sweeps: (NSUInteger*)sweeps;
+@end
+#endif
+
 /**
  * Type for enumerating.<br />
  * NB. Implementation detail ... in GNUstep the layout <strong>must</strong>
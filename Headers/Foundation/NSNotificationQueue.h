@@ -138,6 +138,14 @@ struct _NSNotificationQueueList;
 
 @end
 
+#if	OS_API_VERSION(GS_API_NONE, GS_API_NONE)
+@interface	NSNotificationQueue (GNUstep)
+- (void) getEnqueued: (NSUInteger*)enqueued
+	   coalesced: (NSUInteger*)coalesced
+	      posted: (NSUInteger*)posted;
+@end
+#endif
+
 #if	defined(__cplusplus)
 }
 #endif
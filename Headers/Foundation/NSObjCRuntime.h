@@ -141,6 +141,9 @@ GS_EXPORT NSLog_printf_handler	*_NSLog_printf_handler;
 GS_EXPORT int	_NSLogDescriptor;
 @class NSRecursiveLock;
 GS_EXPORT NSRecursiveLock	*GSLogLock(void);
+GS_EXPORT void	GSLogFlush(void);
+GS_EXPORT void	GSLogCounters(NSUInteger *queued, NSUInteger *written,
+  NSUInteger *delayed, NSUInteger *dropped);
 #endif
 
 GS_EXPORT void			NSLog (NSString *format, ...);
@@ -89,7 +89,7 @@ extern "C" {
 #ifndef	_IN_PORT_CODER_M
 #undef	GSIArray
 #endif
-  NSMutableDictionary	*_cInfo;	/* Class version information.	*/
+  NSMutableDictionary	*_cInfo;	/* Unused, kept for the ABI.	*/
   unsigned		_cursor;	/* Position in data buffer.	*/
   unsigned		_version;	/* Version of archiver used.	*/
   NSZone		*_zone;		/* Zone for allocating objs.	*/
@@ -32,7 +32,7 @@
 extern "C" {
 #endif
 
-@class NSTimer, NSDate, NSPort;
+@class NSTimer, NSDate, NSDictionary, NSPort;
 
 /**
  * Run loop mode used to deal with input sources other than NSConnections or
@@ -182,6 +182,16 @@ typedef	enum {
 	        type: (RunLoopEventType)type
 	     forMode: (NSString*)mode
 		 all: (BOOL)removeAll;
+/** Returns counters (as NSNumber objects) describing the timers in the
+ * specified mode, or nil if the receiver has never had anything in that
+ * mode.  The keys are Timers (the number of timers held, which includes
+ * invalidated ones not yet removed), Fires (the number of times a timer
+ * has been fired), Lateness (the total time in seconds by which timers
+ * were fired after their fire dates) and MaxLateness (the greatest
+ * time by which a timer was fired late).<br />
+ * This should be called in the thread of the run loop.
+ */
+- (NSDictionary*) timerStatisticsForMode: (NSString*)mode;
 @end
 
 #if	defined(__cplusplus)
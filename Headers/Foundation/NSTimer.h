@@ -52,13 +52,16 @@ extern "C" {
   id		_info;
 #endif
 #if     GS_NONFRAGILE
+#  if	defined(GS_NSTimer_IVARS)
+@public GS_NSTimer_IVARS
+#  endif
 #else
   /* Pointer to private additional data used to avoid breaking ABI
    * when we don't have the non-fragile ABI available.
    * Use this mechanism rather than changing the instance variable
    * layout (see Source/GSInternal.h for details).
    */
-  @private id _internal GS_UNUSED_IVAR;
+  @private id _internal;
 #endif
 }
 
@@ -102,6 +105,18 @@ extern "C" {
 - (void) setFireDate: (NSDate*)fireDate;
 #endif
 
+#if	OS_API_VERSION(100900, GS_API_LATEST)
+/** Returns the tolerance set by -setTolerance:
+ */
+- (NSTimeInterval) tolerance;
+
+/** Sets the amount of time (zero by default) after its fire date by
+ * which the timer may be fired.  A run loop uses this to fire timers
+ * due at about the same time together, waking up less often.
+ */
+- (void) setTolerance: (NSTimeInterval)tolerance;
+#endif
+
 @end
 
 #if	defined(__cplusplus)
@@ -263,6 +263,35 @@ typedef NSUInteger NSXMLDocumentContentKind;
 
 @end
 
+#if	OS_API_VERSION(GS_API_NONE, GS_API_NONE)
+/**
+ * Block called for each matching element found by
+ * +enumerateElementsNamed:inData:options:error:usingBlock:<br />
+ * Setting *stop to YES ends the enumeration.
+ */
+DEFINE_BLOCK_TYPE(GSXMLElementEnumerationBlock, void, NSXMLElement*, BOOL*);
+
+@interface	NSXMLDocument (GSStreaming)
+/**
+ * Parses data incrementally, calling block with each element whose
+ * name is name, without building a tree for the whole document.<br />
+ * Each element passed to the block is a complete copy of that part of
+ * the document, detached from any tree, and may be retained by the
+ * block.  Memory use is proportional to the size of the largest
+ * matching element rather than to the size of the document, so this
+ * is suitable for processing large files made of many records.<br />
+ * The mask accepts the same input options as -initWithData:options:error:
+ * and the method returns NO (setting *error if error is not NULL) if
+ * the data is not well formed.
+ */
++ (BOOL) enumerateElementsNamed: (NSString*)name
+			 inData: (NSData*)data
+			options: (NSUInteger)mask
+			  error: (NSError**)error
+		     usingBlock: (GSXMLElementEnumerationBlock)block;
+@end
+#endif
+
 #if	defined(__cplusplus)
 }
 #endif
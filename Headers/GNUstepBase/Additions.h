@@ -31,10 +31,13 @@
 #import	<GNUstepBase/GNUstep.h>
 
 #import	<GNUstepBase/GSBlocks.h>
+#import	<GNUstepBase/GSDigest.h>
 #import	<GNUstepBase/GSFunctions.h>
+#import	<GNUstepBase/GSHTTPServer.h>
 #import	<GNUstepBase/GSLocale.h>
 #import	<GNUstepBase/GSLock.h>
 #import	<GNUstepBase/GSMime.h>
+#import	<GNUstepBase/GSRunLoopPool.h>
 #import	<GNUstepBase/GSXML.h>
 #import	<GNUstepBase/Unicode.h>
 
@@ -60,7 +60,8 @@ enum {
  METHODTYPE_REPLY,
  PROXY_RELEASE,
  PROXY_RETAIN,
- RETAIN_REPLY
+ RETAIN_REPLY,
+ MESSAGE_BATCH
 };
 
 
@@ -79,6 +80,12 @@ enum {
 - (void) forwardInvocation: (NSInvocation *)inv 
 		  forProxy: (NSDistantObject*)object;
 - (const char *) typeForSelector: (SEL)sel remoteTarget: (unsigned)target;
+
+- (NSMethodSignature*) cachedSignatureForSelector: (SEL)aSelector
+					    proxy: (NSDistantObject*)aProxy;
+- (void) cacheSignature: (NSMethodSignature*)aSignature
+	    forSelector: (SEL)aSelector
+		  proxy: (NSDistantObject*)aProxy;
 @end
 
 @interface NSPort (Internal)
@@ -0,0 +1,232 @@
+/** Interface for incremental message digests
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNUstep Base Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02111 USA.
+
+   AutogsdocSource: Additions/GSDigest.m
+*/
+
+#ifndef __GSDigest_h_GNUSTEP_BASE_INCLUDE
+#define __GSDigest_h_GNUSTEP_BASE_INCLUDE
+#import <GNUstepBase/GSVersionMacros.h>
+
+#if	OS_API_VERSION(GS_API_NONE,GS_API_LATEST)
+
+#ifdef NeXT_Foundation_LIBRARY
+#import <Foundation/Foundation.h>
+#else
+#import	<Foundation/NSObject.h>
+#import	<Foundation/NSData.h>
+#import	<Foundation/NSStream.h>
+#endif
+
+#if	defined(__cplusplus)
+extern "C" {
+#endif
+
+@class	NSFileHandle;
+@class	NSString;
+
+/**
+ * The algorithms supported by [GSDigest].
+ * <deflist>
+ *   <term>GSDigestMD5</term>
+ *   <desc>MD5, producing a 16 byte digest</desc>
+ *   <term>GSDigestSHA1</term>
+ *   <desc>SHA-1, producing a 20 byte digest</desc>
+ *   <term>GSDigestSHA256</term>
+ *   <desc>SHA-256, producing a 32 byte digest</desc>
+ *   <term>GSDigestSHA512</term>
+ *   <desc>SHA-512, producing a 64 byte digest</desc>
+ *   <term>GSDigestCRC32C</term>
+ *   <desc>The Castagnoli CRC (as used by iSCSI and SCTP), producing
+ *   a 4 byte big-endian checksum</desc>
+ * </deflist>
+ */
+typedef enum {
+  GSDigestMD5 = 0,
+  GSDigestSHA1,
+  GSDigestSHA256,
+  GSDigestSHA512,
+  GSDigestCRC32C
+} GSDigestAlgorithm;
+
+/**
+ * An incremental message digest.<br />
+ * Data may be added in pieces of any size, so very large files or
+ * network streams may be checksummed without holding all the data in
+ * memory.  Hardware support (SHA extensions and the SSE4.2 crc32
+ * instruction) is used where the processor provides it.
+ */
+@interface	GSDigest : NSObject <NSCopying>
+{
+@private
+  GSDigestAlgorithm	_algorithm;
+  void			*_context;
+}
+
+/**
+ * Returns the digest of the data in the specified file, reading it
+ * in chunks so that files of any size may be processed.<br />
+ * Returns nil if the file cannot be read.
+ */
++ (NSData*) digestOfContentsOfFile: (NSString*)path
+			 algorithm: (GSDigestAlgorithm)algorithm;
+
+/**
+ * Returns an autoreleased digest object using the specified algorithm.
+ */
++ (GSDigest*) digestWithAlgorithm: (GSDigestAlgorithm)algorithm;
+
+/** Returns the algorithm used by the receiver.
+ */
+- (GSDigestAlgorithm) algorithm;
+
+/**
+ * Makes the receiver observe background reads on aHandle
+ * (those started by -readInBackgroundAndNotify and
+ * -readToEndOfFileInBackgroundAndNotify) so that all data read is
+ * added to the digest as it arrives.
+ */
+- (void) attachToFileHandle: (NSFileHandle*)aHandle;
+
+/**
+ * Stops the receiver observing background reads on aHandle.
+ */
+- (void) detachFromFileHandle: (NSFileHandle*)aHandle;
+
+/**
+ * Returns the digest of all the data added since the receiver was
+ * created or last reset.  This does not alter the receiver, so more
+ * data may be added afterwards.
+ */
+- (NSData*) digest;
+
+/** Returns the number of bytes in the digest.
+ */
+- (NSUInteger) digestLength;
+
+/** <init />
+ * Initialises the receiver to compute a digest using algorithm.
+ */
+- (id) initWithAlgorithm: (GSDigestAlgorithm)algorithm;
+
+/**
+ * Discards all data added so far.
+ */
+- (void) reset;
+
+/**
+ * Adds length bytes to the digest.
+ */
+- (void) updateWithBytes: (const void*)bytes length: (NSUInteger)length;
+
+/**
+ * Adds the contents of the file at path to the digest, reading it in
+ * chunks.  Returns NO if the file could not be read.
+ */
+- (BOOL) updateWithContentsOfFile: (NSString*)path;
+
+/**
+ * Adds the bytes of data to the digest.
+ */
+- (void) updateWithData: (NSData*)data;
+
+/**
+ * Reads aHandle to end of file, adding everything read to the digest.
+ * Returns NO if a read fails.
+ */
+- (BOOL) updateWithFileHandle: (NSFileHandle*)aHandle;
+
+/**
+ * Reads aStream (opening it if necessary) until it reaches its end,
+ * adding everything read to the digest.  The stream is not closed.
+ * Returns NO if the stream reports an error.
+ */
+- (BOOL) updateWithStream: (NSInputStream*)aStream;
+@end
+
+/**
+ * An input stream which reads from another stream, adding all the data
+ * read to a digest.  This allows a digest to be computed as the data
+ * is consumed by some other code.<br />
+ * Events from the underlying stream are passed on to the delegate of
+ * the receiver.
+ */
+@interface	GSDigestInputStream : NSInputStream
+{
+@private
+  NSInputStream	*_stream;
+  GSDigest	*_digest;
+  id		_delegate;
+}
+
+/**
+ * Returns an autoreleased stream reading from aStream and adding the
+ * data read to aDigest.
+ */
++ (id) streamWithInputStream: (NSInputStream*)aStream
+		      digest: (GSDigest*)aDigest;
+
+/** Returns the digest the receiver updates.
+ */
+- (GSDigest*) digest;
+
+/** <init />
+ * Initialises the receiver to read from aStream and add the data read
+ * to aDigest.
+ */
+- (id) initWithInputStream: (NSInputStream*)aStream
+		    digest: (GSDigest*)aDigest;
+@end
+
+@interface	NSData (GSDigest)
+/**
+ * Returns the CRC32C checksum of the receiver as 4 big-endian bytes.
+ */
+- (NSData*) crc32cDigest;
+
+/**
+ * Returns the digest of the receiver computed using algorithm.<br />
+ * For a large file, using this on the result of
+ * [NSData+dataWithContentsOfMappedFile:] avoids reading the file into
+ * memory first.
+ */
+- (NSData*) digestUsingAlgorithm: (GSDigestAlgorithm)algorithm;
+
+/** Returns the SHA-1 digest of the receiver as 20 bytes.
+ */
+- (NSData*) sha1Digest;
+
+/** Returns the SHA-256 digest of the receiver as 32 bytes.
+ */
+- (NSData*) sha256Digest;
+
+/** Returns the SHA-512 digest of the receiver as 64 bytes.
+ */
+- (NSData*) sha512Digest;
+@end
+
+#if	defined(__cplusplus)
+}
+#endif
+
+#endif	/* OS_API_VERSION(GS_API_NONE,GS_API_LATEST) */
+
+#endif	/* __GSDigest_h_GNUSTEP_BASE_INCLUDE */
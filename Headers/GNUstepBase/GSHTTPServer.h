@@ -0,0 +1,320 @@
+/** Interface for an embedded HTTP/1.1 server
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNUstep Base Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02111 USA.
+
+   AutogsdocSource: Additions/GSHTTPServer.m
+*/
+
+#ifndef __GSHTTPServer_h_GNUSTEP_BASE_INCLUDE
+#define __GSHTTPServer_h_GNUSTEP_BASE_INCLUDE
+#import <GNUstepBase/GSVersionMacros.h>
+
+#if	OS_API_VERSION(GS_API_NONE,GS_API_LATEST)
+
+#ifdef NeXT_Foundation_LIBRARY
+#import <Foundation/Foundation.h>
+#else
+#import	<Foundation/NSObject.h>
+#import	<Foundation/NSDate.h>
+#endif
+
+#if	defined(__cplusplus)
+extern "C" {
+#endif
+
+@class	GSMimeDocument;
+@class	GSMimeHeader;
+@class	NSConditionLock;
+@class	NSData;
+@class	NSDictionary;
+@class	NSMutableArray;
+@class	NSMutableData;
+@class	NSString;
+@class	NSThread;
+
+/**
+ * An HTTP request received by a [GSHTTPServer], and the means of
+ * sending the response to it.<br />
+ * The server passes each complete request to its delegate, which
+ * must eventually complete the response by calling -finish or
+ * -respondWithStatus:data: (possibly after some calls to -sendBodyData:).
+ * The response need not be completed before the delegate method
+ * returns, and the response methods may be called from any thread.<br />
+ * Requests on a connection are handled one at a time, so the response
+ * to a request must be finished before the server will go on to handle
+ * a further (pipelined) request from the same client.
+ */
+@interface	GSHTTPServerRequest : NSObject
+{
+@private
+  id			_connection;
+  NSThread		*_thread;
+  NSString		*_method;
+  NSString		*_path;
+  NSString		*_version;
+  GSMimeDocument	*_headers;
+  NSMutableData		*_body;
+  NSMutableArray	*_response;
+  NSInteger		_status;
+  NSString		*_reason;
+  int			_state;
+  BOOL			_keepAlive;
+  BOOL			_chunked;
+  BOOL			_noBody;
+}
+
+/** Returns the body of the request, or nil if the request had no body
+ * or if the body was passed to the server delegate piece by piece as
+ * it arrived.
+ */
+- (NSData*) body;
+
+/** Returns the first header of the request with the specified name
+ * (matched case insensitively), or nil if there is no such header.
+ */
+- (GSMimeHeader*) headerNamed: (NSString*)name;
+
+/** Returns a document holding all the headers of the request.
+ */
+- (GSMimeDocument*) headers;
+
+/** Returns the protocol version from the request line (eg 'HTTP/1.1').
+ */
+- (NSString*) HTTPVersion;
+
+/** Returns the request method (eg 'GET').
+ */
+- (NSString*) method;
+
+/** Returns the request target from the request line, as sent by the
+ * client (normally a path with an optional query string).
+ */
+- (NSString*) path;
+
+/** Returns the IP address of the client.
+ */
+- (NSString*) remoteAddress;
+
+/**
+ * Completes the response.  If no body data has been sent yet, the
+ * response is sent as a single message with a Content-Length header.
+ */
+- (void) finish;
+
+/**
+ * Sets the status and completes the response using data (which may
+ * be nil) as its body.
+ */
+- (void) respondWithStatus: (NSInteger)status data: (NSData*)data;
+
+/**
+ * Sends part of the response body.<br />
+ * The first call sends the status line and headers, and unless a
+ * Content-Length header has been set the body is then sent using
+ * chunked transfer encoding (or, for an HTTP/1.0 client, by closing
+ * the connection after the response).  Use this to stream a large or
+ * slowly generated response, and call -finish after the last part.
+ */
+- (void) sendBodyData: (NSData*)data;
+
+/**
+ * Sets the status code of the response (the default is 200) along
+ * with the reason phrase to be sent with it.  If reason is nil a
+ * standard phrase is used.<br />
+ * This must be called before any of the response has been sent.
+ */
+- (void) setStatus: (NSInteger)status reason: (NSString*)reason;
+
+/**
+ * Adds a header to the response.<br />
+ * This must be called before any of the response has been sent.
+ */
+- (void) setValue: (NSString*)value forHeader: (NSString*)name;
+@end
+
+/**
+ * <p>An embedded HTTP/1.1 server, built on [GSServerStream] and
+ * [GSMimeParser], for use where a program needs to answer HTTP
+ * requests itself rather than sit behind a separate web server.
+ * </p>
+ * <p>The server supports persistent connections, pipelined requests
+ * (answered in order), chunked transfer encoding in both directions
+ * and 'Expect: 100-continue'.  Request bodies are either collected
+ * for the delegate or passed to it piece by piece as they arrive.
+ * </p>
+ * <p>Connections are handled by a pool of worker threads, each running
+ * its own run loop, and a connection stays with one worker for its
+ * whole life.  With -setReusePort: each worker also has its own
+ * listening socket so that the kernel shares out new connections,
+ * otherwise one worker accepts connections and hands them to the
+ * others in turn.
+ * </p>
+ */
+@interface	GSHTTPServer : NSObject
+{
+@private
+  NSString		*_address;
+  NSInteger		_port;
+  id			_delegate;
+  NSUInteger		_workerCount;
+  NSTimeInterval	_idleTimeout;
+  NSUInteger		_maxBodySize;
+  BOOL			_reusePort;
+  BOOL			_running;
+  NSMutableArray	*_workers;
+  NSConditionLock	*_started;
+  NSUInteger		_next;
+  NSUInteger		_connections;
+  NSUInteger		_requests;
+  NSUInteger		_open;
+}
+
+/** Returns the delegate set by -setDelegate:
+ */
+- (id) delegate;
+
+/**
+ * Returns a dictionary of counters (as NSNumber objects) describing
+ * the work done since the server was started:<br />
+ * Connections (the number of connections accepted),
+ * Requests (the number of requests handled) and
+ * Open (the number of connections currently open).
+ */
+- (NSDictionary*) statistics;
+
+/** Returns the idle timeout set by -setIdleTimeout:
+ */
+- (NSTimeInterval) idleTimeout;
+
+/** Returns the limit set by -setMaxBodySize:
+ */
+- (NSUInteger) maxBodySize;
+
+/** <init />
+ * Initialises the receiver to listen on the specified IP address
+ * (an empty string or nil for all addresses) and port.  A port of
+ * zero lets the system choose a free port, which may then be found
+ * using the -port method once the server has been started.
+ */
+- (id) initWithAddress: (NSString*)address port: (NSInteger)port;
+
+/** Returns the port the receiver listens on.
+ */
+- (NSInteger) port;
+
+/** Returns whether SO_REUSEPORT sharding is to be used.
+ */
+- (BOOL) reusePort;
+
+/**
+ * Sets the object to which requests are passed.  The delegate is not
+ * retained, and should implement the methods of the informal
+ * [NSObject(GSHTTPServer)] protocol.
+ */
+- (void) setDelegate: (id)anObject;
+
+/**
+ * Sets the time for which a connection may be idle (with no request
+ * in progress) before the server closes it.  The default is thirty
+ * seconds, and a value of zero or less disables the timeout.
+ */
+- (void) setIdleTimeout: (NSTimeInterval)seconds;
+
+/**
+ * Sets the largest request body (in bytes) which the server will
+ * collect in memory for the delegate.  A request with a larger
+ * Content-Length, or a chunked body which grows larger, is answered
+ * with a 413 status and the connection is closed.  The default is
+ * eight megabytes, and zero means no limit.<br />
+ * Bodies passed to the delegate piece by piece (see
+ * -HTTPServer:request:receivedData:) are not limited.
+ */
+- (void) setMaxBodySize: (NSUInteger)size;
+
+/**
+ * Sets whether each worker thread should have its own listening
+ * socket (using SO_REUSEPORT where the system supports it) rather
+ * than one thread accepting all new connections.  The default is NO,
+ * and this has no effect on systems without SO_REUSEPORT.<br />
+ * This must be set before the server is started.
+ */
+- (void) setReusePort: (BOOL)flag;
+
+/**
+ * Sets the number of worker threads used.  The default of zero means
+ * that no threads are created and all connections are handled in the
+ * run loop of the thread which starts the server, which must then run
+ * its run loop in the default mode.<br />
+ * This must be set before the server is started.
+ */
+- (void) setWorkers: (NSUInteger)count;
+
+/**
+ * Starts listening for connections.  Returns NO if the server could
+ * not listen on the requested address and port (or was already running).
+ */
+- (BOOL) start;
+
+/**
+ * Stops listening and closes all connections.
+ */
+- (void) stop;
+
+/** Returns the number of worker threads set by -setWorkers:
+ */
+- (NSUInteger) workers;
+@end
+
+/**
+ * The informal protocol for the delegate of a [GSHTTPServer].<br />
+ * The delegate methods are called in the worker thread which handles
+ * the connection, so the delegate must be thread-safe if the server
+ * uses more than one worker.
+ */
+@interface	NSObject (GSHTTPServer)
+
+/**
+ * Called when a request (including any body) has been read.  The
+ * delegate must respond using the methods of the request object,
+ * either before returning or later.<br />
+ * If the delegate does not implement this, the server responds with
+ * a 404 status.
+ */
+- (void) HTTPServer: (GSHTTPServer*)server
+      handleRequest: (GSHTTPServerRequest*)request;
+
+/**
+ * If the delegate implements this, the body of each request is passed
+ * to it in pieces as it is read (after the request headers are known,
+ * before -HTTPServer:handleRequest: is called) rather than collected
+ * in memory by the server.
+ */
+- (void) HTTPServer: (GSHTTPServer*)server
+	    request: (GSHTTPServerRequest*)request
+       receivedData: (NSData*)data;
+@end
+
+#if	defined(__cplusplus)
+}
+#endif
+
+#endif	/* OS_API_VERSION(GS_API_NONE,GS_API_LATEST) */
+
+#endif	/* __GSHTTPServer_h_GNUSTEP_BASE_INCLUDE */
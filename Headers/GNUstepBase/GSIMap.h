@@ -110,6 +110,18 @@ extern "C" {
  *      GSI_MAP_ZEROED()
  *              Define this macro to check whether a map uses keys which may
  *              be zeroed weak pointers.  
+ *
+ *      GSI_MAP_PURGE_CURSOR()
+ *              Define this macro as an lvalue (of type uintptr_t) in the
+ *              map, to have each addition of a node to a map for which
+ *              GSI_MAP_ZEROED() is true first remove the zeroed nodes
+ *              from the next GSI_MAP_PURGE_BUCKETS buckets (default 4),
+ *              the lvalue recording where to carry on next time.  This
+ *              stops dead entries building up between full purges.
+ *
+ *      GSI_MAP_PURGED()
+ *              Define this macro to be told the number of zeroed nodes
+ *              removed from a map each time some are purged.
  */
 
 #ifndef	GSI_MAP_HAS_VALUE
@@ -141,6 +153,12 @@ extern "C" {
 #ifndef GSI_MAP_ZEROED
 #define GSI_MAP_ZEROED(M)		0
 #endif
+#ifndef GSI_MAP_PURGE_BUCKETS
+#define GSI_MAP_PURGE_BUCKETS		4
+#endif
+#ifndef GSI_MAP_PURGED
+#define GSI_MAP_PURGED(M, N)
+#endif
 #ifndef GSI_MAP_READ_KEY
 #  define GSI_MAP_READ_KEY(M, x) (*(x))
 #endif
@@ -154,9 +172,9 @@ extern "C" {
 #  define GSI_MAP_WRITE_VAL(M, addr, obj) (*(addr) = obj)
 #endif
 #if	GSI_MAP_HAS_VALUE
-#define GSI_MAP_NODE_IS_EMPTY(M, node) (((GSI_MAP_READ_VALUE(M, &node->key).addr) == 0) || ((GSI_MAP_READ_VALUE(M, &node->value).addr == 0)))
+#define GSI_MAP_NODE_IS_EMPTY(M, node) (((GSI_MAP_READ_KEY(M, &node->key).addr) == 0) || ((GSI_MAP_READ_VALUE(M, &node->value).addr == 0)))
 #else
-#define GSI_MAP_NODE_IS_EMPTY(M, node) (((GSI_MAP_READ_VALUE(M, &node->key).addr) == 0))
+#define GSI_MAP_NODE_IS_EMPTY(M, node) (((GSI_MAP_READ_KEY(M, &node->key).addr) == 0))
 #endif
 
 /*
@@ -488,6 +506,8 @@ GSIMapRemoveWeak(GSIMapTable map)
   GSIMapBucket bucket = map->buckets;
   if (GSI_MAP_ZEROED(map))
     {
+      uintptr_t	removed = 0;
+
       while (bucketCount-- > 0)
         {
           GSIMapNode node = bucket->firstNode;
@@ -499,15 +519,73 @@ GSIMapRemoveWeak(GSIMapTable map)
                 {
                   GSIMapRemoveNodeFromMap(map, bucket, node);
                   GSIMapFreeNode(map, node);
+		  removed++;
                 }
               node = next;
             }
           bucket++;
         }
+      if (removed > 0)
+	{
+	  GSI_MAP_PURGED(map, removed);
+	}
       return;
     }
 }
 
+#ifdef	GSI_MAP_PURGE_CURSOR
+/**
+ * Removes zeroed nodes from up to 'limit' buckets, starting at the
+ * bucket after the last one examined, so that a weak map is purged
+ * a little at a time rather than in one long pass.
+ */
+static INLINE void
+GSIMapPurgeWeakBuckets(GSIMapTable map, uintptr_t limit)
+{
+  uintptr_t	bucketCount = map->bucketCount;
+  uintptr_t	index = GSI_MAP_PURGE_CURSOR(map);
+  uintptr_t	removed = 0;
+
+  if (limit > bucketCount)
+    {
+      limit = bucketCount;
+    }
+  while (limit-- > 0)
+    {
+      GSIMapBucket	bucket;
+      GSIMapNode	node;
+
+      if (index >= bucketCount)
+	{
+	  index = 0;
+	}
+      bucket = map->buckets + index++;
+      node = bucket->firstNode;
+      while (node != 0)
+	{
+	  GSIMapNode	next = node->nextInBucket;
+
+	  if (GSI_MAP_NODE_IS_EMPTY(map, node))
+	    {
+	      GSIMapRemoveNodeFromMap(map, bucket, node);
+	      GSIMapFreeNode(map, node);
+	      removed++;
+	    }
+	  node = next;
+	}
+    }
+  GSI_MAP_PURGE_CURSOR(map) = index;
+  if (removed > 0)
+    {
+      GSI_MAP_PURGED(map, removed);
+    }
+}
+#define	GSI_MAP_PURGE_SOME(M) \
+  if (GSI_MAP_ZEROED(M)) GSIMapPurgeWeakBuckets(M, GSI_MAP_PURGE_BUCKETS)
+#else
+#define	GSI_MAP_PURGE_SOME(M)
+#endif
+
 static INLINE void
 GSIMapRemangleBuckets(GSIMapTable map,
   GSIMapBucket old_buckets, uintptr_t old_bucketCount,
@@ -525,6 +603,7 @@ GSIMapRemangleBuckets(GSIMapTable map,
 		{
 		  GSIMapRemoveNodeFromMap(map, old_buckets, node);
 		  GSIMapFreeNode(map, node);
+		  GSI_MAP_PURGED(map, 1);
 		}
 	      else
 		{
@@ -627,7 +706,10 @@ GSIMapNodeForKeyInBucket(GSIMapTable map, GSIMapBucket bucket, GSIMapKey key)
 
   if (GSI_MAP_ZEROED(map))
     {
-      while ((node != 0) && GSI_MAP_EQUAL(map, GSI_MAP_READ_KEY(map, &node->key), key) == NO)
+      /* Zeroed nodes are removed as we come to them, before comparing
+       * keys, so a dead entry is never compared or returned.
+       */
+      while (node != 0)
 	{
 	  GSIMapNode	tmp = node->nextInBucket;
 
@@ -635,6 +717,11 @@ GSIMapNodeForKeyInBucket(GSIMapTable map, GSIMapBucket bucket, GSIMapKey key)
 	    {
 	      GSIMapRemoveNodeFromMap(map, bucket, node);
 	      GSIMapFreeNode(map, node);
+	      GSI_MAP_PURGED(map, 1);
+	    }
+	  else if (GSI_MAP_EQUAL(map, GSI_MAP_READ_KEY(map, &node->key), key))
+	    {
+	      break;
 	    }
 	  node = tmp;
 	}
@@ -725,7 +812,7 @@ GSIMapNodeForSimpleKey(GSIMapTable map, GSIMapKey key)
   node = bucket->firstNode;
   if (GSI_MAP_ZEROED(map))
     {
-      while ((node != 0) && GSI_MAP_READ_KEY(map, &node->key).addr != key.addr)
+      while (node != 0)
 	{
 	  GSIMapNode	tmp = node->nextInBucket;
 
@@ -733,6 +820,11 @@ GSIMapNodeForSimpleKey(GSIMapTable map, GSIMapKey key)
 	    {
 	      GSIMapRemoveNodeFromMap(map, bucket, node);
 	      GSIMapFreeNode(map, node);
+	      GSI_MAP_PURGED(map, 1);
+	    }
+	  else if (GSI_MAP_READ_KEY(map, &node->key).addr == key.addr)
+	    {
+	      break;
 	    }
 	  node = tmp;
 	}
@@ -1046,8 +1138,10 @@ GSIMapCountByEnumeratingWithStateObjectsCount(GSIMapTable map,
 static INLINE GSIMapNode
 GSIMapAddPairNoRetain(GSIMapTable map, GSIMapKey key, GSIMapVal value)
 {
-  GSIMapNode	node = map->freeNodes;
+  GSIMapNode	node;
 
+  GSI_MAP_PURGE_SOME(map);
+  node = map->freeNodes;
   if (node == 0)
     {
       GSIMapMoreNodes(map, map->nodeCount < map->increment ? 0: map->increment);
@@ -1069,8 +1163,10 @@ GSIMapAddPairNoRetain(GSIMapTable map, GSIMapKey key, GSIMapVal value)
 static INLINE GSIMapNode
 GSIMapAddPair(GSIMapTable map, GSIMapKey key, GSIMapVal value)
 {
-  GSIMapNode	node = map->freeNodes;
+  GSIMapNode	node;
 
+  GSI_MAP_PURGE_SOME(map);
+  node = map->freeNodes;
   if (node == 0)
     {
       GSIMapMoreNodes(map, map->nodeCount < map->increment ? 0: map->increment);
@@ -1094,8 +1190,10 @@ GSIMapAddPair(GSIMapTable map, GSIMapKey key, GSIMapVal value)
 static INLINE GSIMapNode
 GSIMapAddKeyNoRetain(GSIMapTable map, GSIMapKey key)
 {
-  GSIMapNode	node = map->freeNodes;
+  GSIMapNode	node;
 
+  GSI_MAP_PURGE_SOME(map);
+  node = map->freeNodes;
   if (node == 0)
     {
       GSIMapMoreNodes(map, map->nodeCount < map->increment ? 0: map->increment);
@@ -1116,8 +1214,10 @@ GSIMapAddKeyNoRetain(GSIMapTable map, GSIMapKey key)
 static INLINE GSIMapNode
 GSIMapAddKey(GSIMapTable map, GSIMapKey key)
 {
-  GSIMapNode	node = map->freeNodes;
+  GSIMapNode	node;
 
+  GSI_MAP_PURGE_SOME(map);
+  node = map->freeNodes;
   if (node == 0)
     {
       GSIMapMoreNodes(map, map->nodeCount < map->increment ? 0: map->increment);
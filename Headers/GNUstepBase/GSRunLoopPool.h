@@ -0,0 +1,204 @@
+/** Interface for a pool of threads running run loops for I/O
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNUstep Base Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02111 USA.
+
+   AutogsdocSource: GSRunLoopPool.m
+*/
+
+#ifndef __GSRunLoopPool_h_GNUSTEP_BASE_INCLUDE
+#define __GSRunLoopPool_h_GNUSTEP_BASE_INCLUDE
+#import <GNUstepBase/GSVersionMacros.h>
+
+#if	OS_API_VERSION(GS_API_NONE,GS_API_LATEST)
+
+#import	<Foundation/NSObject.h>
+
+#if	defined(__cplusplus)
+extern "C" {
+#endif
+
+@class	NSArray;
+@class	NSInputStream;
+@class	NSLock;
+@class	NSMapTable;
+@class	NSMutableArray;
+@class	NSOutputStream;
+@class	NSRunLoop;
+@class	NSStream;
+@class	NSString;
+@class	NSThread;
+
+/**
+ * <p>A pool of threads, each running its own run loop in the default
+ * mode, over which a program can spread its streams, file handles and
+ * other run loop driven I/O so that the work is shared between several
+ * processors.
+ * </p>
+ * <p>The pool keeps a count of the objects it has placed in each loop,
+ * and new objects go to the loop with the fewest.  An object stays in
+ * its loop, and the delegate methods or notifications it causes happen
+ * in that loop's thread, until it is moved with -moveStream:toLoop: or
+ * removed with -unscheduleObject:.  The pool retains the objects
+ * scheduled in it until they are removed.
+ * </p>
+ * <p>Scheduling is always done in the thread of the loop concerned
+ * (using [NSObject-performSelector:onThread:withObject:waitUntilDone:])
+ * since a run loop may not be altered from another thread.  The methods
+ * of the pool may be called from any thread, and never wait for a loop.
+ * </p>
+ */
+@interface	GSRunLoopPool : NSObject
+{
+@private
+  NSString		*_name;
+  NSMutableArray	*_loops;
+  NSMapTable		*_objects;
+  NSLock		*_lock;
+}
+
+/**
+ * Returns a pool shared by the whole process, with one thread for each
+ * active processor.
+ */
++ (GSRunLoopPool*) sharedPool;
+
+/** Returns the number of loops (threads) in the pool.
+ */
+- (NSUInteger) count;
+
+/** <init />
+ * Initialises the receiver with count threads, which are started
+ * immediately and named after aName (with the number of the loop
+ * appended).
+ */
+- (id) initWithCount: (NSUInteger)count name: (NSString*)aName;
+
+/**
+ * Stops the threads of the pool.  Objects still scheduled in the loops
+ * will receive no further events.
+ */
+- (void) invalidate;
+
+/**
+ * Returns the index of the loop with the fewest objects scheduled in it
+ * (or, where several have the same number, the one which has spent the
+ * least time handling events).
+ */
+- (NSUInteger) leastLoadedLoop;
+
+/** Returns the index of the loop in which anObject is scheduled, or
+ * NSNotFound if it is not scheduled in any.
+ */
+- (NSUInteger) loopForObject: (id)anObject;
+
+/**
+ * Moves a stream to another loop.  The stream is removed from its
+ * current loop in that loop's thread before being added to the new
+ * loop in the new thread, so its delegate is never called in both
+ * threads at once, but the delegate must expect subsequent events in
+ * the new thread.<br />
+ * The two streams of a socket should be moved together, using the
+ * same index for both.
+ */
+- (void) moveStream: (NSStream*)aStream toLoop: (NSUInteger)index;
+
+/** Returns the run loop at the specified index.
+ */
+- (NSRunLoop*) runLoopAtIndex: (NSUInteger)index;
+
+/**
+ * Places anObject in the least loaded loop by sending it aSelector
+ * with the argument anArgument in that loop's thread, and returns the
+ * index of the loop.<br />
+ * This is the way to use the pool for objects which schedule
+ * themselves in the current run loop, such as an [NSFileHandle] sent
+ * -readInBackgroundAndNotify or -acceptConnectionInBackgroundAndNotify
+ * (whose notifications are then posted in the chosen thread).
+ */
+- (NSUInteger) scheduleObject: (id)anObject
+		   performing: (SEL)aSelector
+		   withObject: (id)anArgument;
+
+/**
+ * Schedules both streams (normally the two halves of a socket
+ * connection) in the least loaded loop and returns its index.  Either
+ * stream may be nil.<br />
+ * Any stream which has not yet been opened is opened in the loop's
+ * thread, so once this has been called the streams should only be
+ * used by their delegates.
+ */
+- (NSUInteger) scheduleInputStream: (NSInputStream*)input
+		      outputStream: (NSOutputStream*)output;
+
+/**
+ * Schedules aStream in the least loaded loop and returns its index.<br />
+ * If the stream has not yet been opened it is opened in the loop's
+ * thread, so once this has been called the stream should only be used
+ * by its delegate.
+ */
+- (NSUInteger) scheduleStream: (NSStream*)aStream;
+
+/**
+ * <p>Returns an array holding a dictionary of statistics for each loop.
+ * The values in each dictionary are NSNumber objects with the keys:
+ * </p>
+ * <deflist>
+ *   <term>Objects</term>
+ *   <desc>The number of objects scheduled in the loop</desc>
+ *   <term>Events</term>
+ *   <desc>The number of events (inputs found ready) the loop has handled</desc>
+ *   <term>EventsPerSecond</term>
+ *   <desc>The rate of events since the previous call to this method</desc>
+ *   <term>CallbackTime</term>
+ *   <desc>The total time (in seconds) spent handling events</desc>
+ *   <term>Busy</term>
+ *   <desc>The fraction of the time since the previous call to this
+ *   method which was spent handling events</desc>
+ *   <term>QueueDepth</term>
+ *   <desc>The number of messages sent to the thread with
+ *   -performSelector:onThread:withObject:waitUntilDone: which are
+ *   waiting to be handled</desc>
+ * </deflist>
+ * <p>Events and callback times are only recorded on systems where the
+ * run loop uses poll() or select().
+ * </p>
+ */
+- (NSArray*) statistics;
+
+/** Returns the thread running the loop at the specified index.
+ */
+- (NSThread*) threadAtIndex: (NSUInteger)index;
+
+/**
+ * Removes anObject from the pool.  If it is a stream, it is removed
+ * from its run loop (in that loop's thread) before this method returns,
+ * so it may be scheduled again at once.  Other objects are just no
+ * longer counted as load on their loop.
+ */
+- (void) unscheduleObject: (id)anObject;
+@end
+
+#if	defined(__cplusplus)
+}
+#endif
+
+#endif	/* OS_API_VERSION(GS_API_NONE,GS_API_LATEST) */
+
+#endif	/* __GSRunLoopPool_h_GNUSTEP_BASE_INCLUDE */
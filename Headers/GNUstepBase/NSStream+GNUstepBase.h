@@ -118,6 +118,14 @@ GS_EXPORT NSString * const GSStreamLocalPortKey;
 GS_EXPORT NSString * const GSStreamRemoteAddressKey;
 /** May be used to read the remote port of a tcp/ip network stream. */
 GS_EXPORT NSString * const GSStreamRemotePortKey;
+/** May be set to a true value (eg an NSNumber containing YES) on a
+ * [GSServerStream] before it is opened, to let several server streams
+ * listen on the same address and port.  Where the system supports the
+ * SO_REUSEPORT socket option the kernel then shares incoming connections
+ * between the listeners, so that each of several threads or processes
+ * may accept on its own socket.  Ignored where the option is unsupported.
+ */
+GS_EXPORT NSString * const GSStreamReusePortKey;
 
 #endif	/* OS_API_VERSION */
 
@@ -0,0 +1,610 @@
+/* Base64 and hexadecimal coding functions
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNUstep Base Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02111 USA.
+*/
+
+#import "common.h"
+#import "../GSPrivate.h"
+
+#include <string.h>
+
+/* The vector implementations are compiled using function target
+ * attributes, so the library as a whole does not need to be built for
+ * a particular processor.  The best implementation supported by the
+ * processor we are running on is chosen the first time a function is
+ * called.
+ */
+#if	(defined(__x86_64__) || defined(__i386__)) \
+  && ((defined(__clang__) && __clang_major__ >= 4) \
+  || (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 5))
+#define	GS_CODEC_X86	1
+#include <immintrin.h>
+#define	SSSE3	__attribute__((target("ssse3")))
+#define	AVX2	__attribute__((target("avx2")))
+#endif
+
+static const char	b64[]
+  = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* Value of each character in the standard base64 alphabet, or -1.
+ */
+const signed char	GSPrivateBase64Values[256] = {
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+  52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+  -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+  15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+  -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+  41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+/* Value of each hexadecimal digit, or -1.
+ */
+static const signed char	hexValues[256] = {
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+  -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+static NSUInteger	(*b64Encode)(uint8_t*, const uint8_t*, NSUInteger) = 0;
+static NSUInteger	(*b64Decode)(uint8_t*, const uint8_t*, NSUInteger) = 0;
+static void		(*hexEncode)(uint8_t*, const uint8_t*, NSUInteger,
+  const char*) = 0;
+static NSUInteger	(*hexDecode)(uint8_t*, const uint8_t*, NSUInteger) = 0;
+
+
+/* The scalar implementations, used for the ends of buffers and when no
+ * vector implementation is available.
+ */
+
+static NSUInteger
+b64EncodeScalar(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  uint8_t	*start = dst;
+
+  while (length >= 3)
+    {
+      uint32_t	v = (src[0] << 16) | (src[1] << 8) | src[2];
+
+      dst[0] = b64[v >> 18];
+      dst[1] = b64[(v >> 12) & 077];
+      dst[2] = b64[(v >> 6) & 077];
+      dst[3] = b64[v & 077];
+      src += 3;
+      dst += 4;
+      length -= 3;
+    }
+  if (length > 0)
+    {
+      uint32_t	v = src[0] << 16;
+
+      if (length > 1)
+	{
+	  v |= src[1] << 8;
+	}
+      dst[0] = b64[v >> 18];
+      dst[1] = b64[(v >> 12) & 077];
+      dst[2] = (length > 1) ? b64[(v >> 6) & 077] : '=';
+      dst[3] = '=';
+      dst += 4;
+    }
+  return dst - start;
+}
+
+static NSUInteger
+b64DecodeScalar(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  const uint8_t	*start = src;
+
+  while (length >= 4)
+    {
+      int	a = GSPrivateBase64Values[src[0]];
+      int	b = GSPrivateBase64Values[src[1]];
+      int	c = GSPrivateBase64Values[src[2]];
+      int	d = GSPrivateBase64Values[src[3]];
+
+      if ((a | b | c | d) < 0)
+	{
+	  break;
+	}
+      dst[0] = (a << 2) | (b >> 4);
+      dst[1] = (b << 4) | (c >> 2);
+      dst[2] = (c << 6) | d;
+      src += 4;
+      dst += 3;
+      length -= 4;
+    }
+  return src - start;
+}
+
+static void
+hexEncodeScalar(uint8_t *dst, const uint8_t *src, NSUInteger length,
+  const char *digits)
+{
+  while (length-- > 0)
+    {
+      uint8_t	c = *src++;
+
+      *dst++ = digits[c >> 4];
+      *dst++ = digits[c & 0x0f];
+    }
+}
+
+static NSUInteger
+hexDecodeScalar(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  const uint8_t	*start = src;
+
+  while (length >= 2)
+    {
+      int	h = hexValues[src[0]];
+      int	l = hexValues[src[1]];
+
+      if ((h | l) < 0)
+	{
+	  break;
+	}
+      *dst++ = (h << 4) | l;
+      src += 2;
+      length -= 2;
+    }
+  return src - start;
+}
+
+#if	defined(GS_CODEC_X86)
+
+/* Base64 using the approach described by Wojciech Muła and Daniel Lemire:
+ * bytes are spread into 6-bit fields with multiplies and translated to
+ * or from ASCII with nibble-indexed table lookups.
+ */
+
+static inline SSSE3 __m128i
+b64EncodeVector128(__m128i in)
+{
+  const __m128i	shift = _mm_setr_epi8(
+    'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+    '/' - 63, 'A', 0, 0);
+  __m128i	t0;
+  __m128i	t1;
+  __m128i	r;
+
+  in = _mm_shuffle_epi8(in, _mm_set_epi8(
+    10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)),
+    _mm_set1_epi32(0x04000040));
+  t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)),
+    _mm_set1_epi32(0x01000010));
+  in = _mm_or_si128(t0, t1);
+
+  r = _mm_subs_epu8(in, _mm_set1_epi8(51));
+  r = _mm_or_si128(r, _mm_and_si128(
+    _mm_cmpgt_epi8(_mm_set1_epi8(26), in), _mm_set1_epi8(13)));
+  return _mm_add_epi8(in, _mm_shuffle_epi8(shift, r));
+}
+
+static SSSE3 NSUInteger
+b64EncodeSSSE3(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  uint8_t	*start = dst;
+
+  /* Each step consumes 12 bytes but loads 16.
+   */
+  while (length >= 16)
+    {
+      __m128i	in = _mm_loadu_si128((const __m128i*)src);
+
+      _mm_storeu_si128((__m128i*)dst, b64EncodeVector128(in));
+      src += 12;
+      dst += 16;
+      length -= 12;
+    }
+  return (dst - start) + b64EncodeScalar(dst, src, length);
+}
+
+static AVX2 NSUInteger
+b64EncodeAVX2(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  const __m256i	shift = _mm256_setr_epi8(
+    'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+    '/' - 63, 'A', 0, 0,
+    'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+    '/' - 63, 'A', 0, 0);
+  const __m256i	spread = _mm256_set_epi8(
+    10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+    10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+  uint8_t	*start = dst;
+
+  /* Each step consumes 24 bytes (12 in each lane) but loads 28.
+   */
+  while (length >= 28)
+    {
+      __m256i	in;
+      __m256i	t0;
+      __m256i	t1;
+      __m256i	r;
+
+      in = _mm256_inserti128_si256(_mm256_castsi128_si256(
+	_mm_loadu_si128((const __m128i*)src)),
+	_mm_loadu_si128((const __m128i*)(src + 12)), 1);
+      in = _mm256_shuffle_epi8(in, spread);
+      t0 = _mm256_mulhi_epu16(
+	_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)),
+	_mm256_set1_epi32(0x04000040));
+      t1 = _mm256_mullo_epi16(
+	_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)),
+	_mm256_set1_epi32(0x01000010));
+      in = _mm256_or_si256(t0, t1);
+      r = _mm256_subs_epu8(in, _mm256_set1_epi8(51));
+      r = _mm256_or_si256(r, _mm256_and_si256(
+	_mm256_cmpgt_epi8(_mm256_set1_epi8(26), in), _mm256_set1_epi8(13)));
+      r = _mm256_add_epi8(in, _mm256_shuffle_epi8(shift, r));
+      _mm256_storeu_si256((__m256i*)dst, r);
+      src += 24;
+      dst += 32;
+      length -= 24;
+    }
+  return (dst - start) + b64EncodeSSSE3(dst, src, length);
+}
+
+/* Translates 16 characters to their 6-bit values, returning NO if any
+ * of them is not in the standard alphabet.
+ */
+static inline SSSE3 BOOL
+b64DecodeVector128(__m128i *v)
+{
+  const __m128i	lutLo = _mm_setr_epi8(
+    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  const __m128i	lutHi = _mm_setr_epi8(
+    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m128i	lutRoll = _mm_setr_epi8(
+    0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i	mask = _mm_set1_epi8(0x2f);
+  __m128i	in = *v;
+  __m128i	hiNibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask);
+  __m128i	lo = _mm_shuffle_epi8(lutLo, _mm_and_si128(in, mask));
+  __m128i	hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+  __m128i	roll;
+
+  if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi),
+    _mm_setzero_si128())) != 0)
+    {
+      return NO;
+    }
+  roll = _mm_shuffle_epi8(lutRoll,
+    _mm_add_epi8(_mm_cmpeq_epi8(in, mask), hiNibbles));
+  *v = _mm_add_epi8(in, roll);
+  return YES;
+}
+
+static SSSE3 NSUInteger
+b64DecodeSSSE3(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  const uint8_t	*start = src;
+
+  while (length >= 16)
+    {
+      __m128i	v = _mm_loadu_si128((const __m128i*)src);
+      uint32_t	tail;
+
+      if (NO == b64DecodeVector128(&v))
+	{
+	  break;
+	}
+      /* Pack the 6-bit fields of each group of four into three bytes.
+       */
+      v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+      v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+      v = _mm_shuffle_epi8(v, _mm_setr_epi8(
+	2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+      _mm_storel_epi64((__m128i*)dst, v);
+      tail = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+      memcpy(dst + 8, &tail, 4);
+      src += 16;
+      dst += 12;
+      length -= 16;
+    }
+  return (src - start) + b64DecodeScalar(dst, src, length);
+}
+
+static AVX2 NSUInteger
+b64DecodeAVX2(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  const __m256i	lutLo = _mm256_setr_epi8(
+    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  const __m256i	lutHi = _mm256_setr_epi8(
+    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m256i	lutRoll = _mm256_setr_epi8(
+    0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i	mask = _mm256_set1_epi8(0x2f);
+  const uint8_t	*start = src;
+
+  while (length >= 32)
+    {
+      __m256i	in = _mm256_loadu_si256((const __m256i*)src);
+      __m256i	hiNibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask);
+      __m256i	lo = _mm256_shuffle_epi8(lutLo, _mm256_and_si256(in, mask));
+      __m256i	hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+      __m256i	v;
+
+      if (_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_and_si256(lo, hi),
+	_mm256_setzero_si256())) != 0)
+	{
+	  break;
+	}
+      v = _mm256_add_epi8(in, _mm256_shuffle_epi8(lutRoll,
+	_mm256_add_epi8(_mm256_cmpeq_epi8(in, mask), hiNibbles)));
+      v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+      v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+      v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(
+	2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+	2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+      /* Bring the 12 bytes from each lane together.
+       */
+      v = _mm256_permutevar8x32_epi32(v,
+	_mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+      _mm_storeu_si128((__m128i*)dst, _mm256_castsi256_si128(v));
+      _mm_storel_epi64((__m128i*)(dst + 16), _mm256_extracti128_si256(v, 1));
+      src += 32;
+      dst += 24;
+      length -= 32;
+    }
+  return (src - start) + b64DecodeSSSE3(dst, src, length);
+}
+
+static SSSE3 void
+hexEncodeSSSE3(uint8_t *dst, const uint8_t *src, NSUInteger length,
+  const char *digits)
+{
+  const __m128i	lut = _mm_loadu_si128((const __m128i*)digits);
+  const __m128i	mask = _mm_set1_epi8(0x0f);
+
+  while (length >= 16)
+    {
+      __m128i	in = _mm_loadu_si128((const __m128i*)src);
+      __m128i	hi = _mm_shuffle_epi8(lut,
+	_mm_and_si128(_mm_srli_epi16(in, 4), mask));
+      __m128i	lo = _mm_shuffle_epi8(lut, _mm_and_si128(in, mask));
+
+      _mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi8(hi, lo));
+      _mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi8(hi, lo));
+      src += 16;
+      dst += 32;
+      length -= 16;
+    }
+  hexEncodeScalar(dst, src, length, digits);
+}
+
+static AVX2 void
+hexEncodeAVX2(uint8_t *dst, const uint8_t *src, NSUInteger length,
+  const char *digits)
+{
+  const __m256i	lut = _mm256_broadcastsi128_si256(
+    _mm_loadu_si128((const __m128i*)digits));
+
+  while (length >= 16)
+    {
+      /* Widen each byte to 16 bits then put the high nibble in the
+       * first byte and the low nibble in the second.
+       */
+      __m256i	w = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)src));
+      __m256i	n = _mm256_or_si256(_mm256_srli_epi16(w, 4),
+	_mm256_slli_epi16(_mm256_and_si256(w, _mm256_set1_epi16(0x0f)), 8));
+
+      _mm256_storeu_si256((__m256i*)dst, _mm256_shuffle_epi8(lut, n));
+      src += 16;
+      dst += 32;
+      length -= 16;
+    }
+  hexEncodeScalar(dst, src, length, digits);
+}
+
+/* Translates 16 hexadecimal digits to their values and combines them in
+ * pairs, returning NO if any character is not a hexadecimal digit.
+ */
+static inline SSSE3 BOOL
+hexDecodeVector128(__m128i in, __m128i *out)
+{
+  __m128i	d = _mm_sub_epi8(in, _mm_set1_epi8('0'));
+  __m128i	l = _mm_sub_epi8(_mm_or_si128(in, _mm_set1_epi8(0x20)),
+    _mm_set1_epi8('a'));
+  __m128i	isD = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+  __m128i	isL = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(5)), l);
+
+  if (_mm_movemask_epi8(_mm_or_si128(isD, isL)) != 0xffff)
+    {
+      return NO;
+    }
+  d = _mm_or_si128(_mm_and_si128(isD, d),
+    _mm_and_si128(isL, _mm_add_epi8(l, _mm_set1_epi8(10))));
+  *out = _mm_maddubs_epi16(d, _mm_set1_epi16(0x0110));
+  return YES;
+}
+
+static SSSE3 NSUInteger
+hexDecodeSSSE3(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  const uint8_t	*start = src;
+
+  while (length >= 32)
+    {
+      __m128i	a;
+      __m128i	b;
+
+      if (NO == hexDecodeVector128(_mm_loadu_si128((const __m128i*)src), &a)
+	|| NO == hexDecodeVector128(
+	_mm_loadu_si128((const __m128i*)(src + 16)), &b))
+	{
+	  break;
+	}
+      _mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(a, b));
+      src += 32;
+      dst += 16;
+      length -= 32;
+    }
+  return (src - start) + hexDecodeScalar(dst, src, length);
+}
+
+static AVX2 NSUInteger
+hexDecodeAVX2(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  const uint8_t	*start = src;
+
+  while (length >= 64)
+    {
+      __m256i	w[2];
+      int	i;
+
+      for (i = 0; i < 2; i++)
+	{
+	  __m256i	in = _mm256_loadu_si256((const __m256i*)(src + 32 * i));
+	  __m256i	d = _mm256_sub_epi8(in, _mm256_set1_epi8('0'));
+	  __m256i	l = _mm256_sub_epi8(
+	    _mm256_or_si256(in, _mm256_set1_epi8(0x20)),
+	    _mm256_set1_epi8('a'));
+	  __m256i	isD = _mm256_cmpeq_epi8(
+	    _mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+	  __m256i	isL = _mm256_cmpeq_epi8(
+	    _mm256_min_epu8(l, _mm256_set1_epi8(5)), l);
+
+	  if (_mm256_movemask_epi8(_mm256_or_si256(isD, isL)) != -1)
+	    {
+	      break;
+	    }
+	  d = _mm256_or_si256(_mm256_and_si256(isD, d),
+	    _mm256_and_si256(isL, _mm256_add_epi8(l, _mm256_set1_epi8(10))));
+	  w[i] = _mm256_maddubs_epi16(d, _mm256_set1_epi16(0x0110));
+	}
+      if (i < 2)
+	{
+	  break;
+	}
+      /* Packing works within lanes, so restore the order afterwards.
+       */
+      _mm256_storeu_si256((__m256i*)dst, _mm256_permute4x64_epi64(
+	_mm256_packus_epi16(w[0], w[1]), 0xd8));
+      src += 64;
+      dst += 32;
+      length -= 64;
+    }
+  return (src - start) + hexDecodeSSSE3(dst, src, length);
+}
+
+#endif	/* GS_CODEC_X86 */
+
+static void
+setup(void)
+{
+  b64Encode = b64EncodeScalar;
+  b64Decode = b64DecodeScalar;
+  hexEncode = hexEncodeScalar;
+  hexDecode = hexDecodeScalar;
+#if	defined(GS_CODEC_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("ssse3"))
+    {
+      b64Encode = b64EncodeSSSE3;
+      b64Decode = b64DecodeSSSE3;
+      hexEncode = hexEncodeSSSE3;
+      hexDecode = hexDecodeSSSE3;
+    }
+  if (__builtin_cpu_supports("avx2"))
+    {
+      b64Encode = b64EncodeAVX2;
+      b64Decode = b64DecodeAVX2;
+      hexEncode = hexEncodeAVX2;
+      hexDecode = hexDecodeAVX2;
+    }
+#endif
+}
+
+NSUInteger
+GSPrivateBase64Encode(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  if (0 == b64Encode)
+    {
+      setup();
+    }
+  return (*b64Encode)(dst, src, length);
+}
+
+NSUInteger
+GSPrivateBase64DecodeRun(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  if (0 == b64Decode)
+    {
+      setup();
+    }
+  return (*b64Decode)(dst, src, length);
+}
+
+void
+GSPrivateHexEncode(uint8_t *dst, const uint8_t *src, NSUInteger length,
+  BOOL upper)
+{
+  if (0 == hexEncode)
+    {
+      setup();
+    }
+  (*hexEncode)(dst, src, length,
+    upper ? "0123456789ABCDEF" : "0123456789abcdef");
+}
+
+NSUInteger
+GSPrivateHexDecodeRun(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  if (0 == hexDecode)
+    {
+      setup();
+    }
+  return (*hexDecode)(dst, src, length);
+}
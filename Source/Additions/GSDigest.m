@@ -0,0 +1,1394 @@
+/** Implementation of incremental message digests
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNUstep Base Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02111 USA.
+
+   <title>GSDigest class reference</title>
+*/
+
+#import "common.h"
+#import "Foundation/NSData.h"
+#import "Foundation/NSException.h"
+#import "Foundation/NSFileHandle.h"
+#import "Foundation/NSNotification.h"
+#import "GNUstepBase/GSDigest.h"
+#import "../GSPrivate.h"
+
+#include <string.h>
+
+/* As in GSCodec.m, the hardware implementations are compiled using
+ * function target attributes and chosen at runtime when the GSDigest
+ * class is initialised.
+ */
+#if	(defined(__x86_64__) || defined(__i386__)) \
+  && ((defined(__clang__) && __clang_major__ >= 4) \
+  || (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 5))
+#define	GS_DIGEST_X86	1
+#include <immintrin.h>
+#include <cpuid.h>
+#define	SHANI	__attribute__((target("sha,sse4.1")))
+#define	SSE42	__attribute__((target("sse4.2")))
+#endif
+
+typedef struct {
+  uint64_t	count;		/* Total bytes added.		*/
+  unsigned	used;		/* Bytes held in buffer.	*/
+  union {
+    uint32_t	w32[16];
+    uint64_t	w64[8];
+  } h;				/* Hash state.			*/
+  uint8_t	buffer[128];	/* Partial block.		*/
+} DigestContext;
+
+typedef void (*BlockFunction)(void *state, const uint8_t *data, size_t blocks);
+typedef uint32_t (*CRCFunction)(uint32_t crc, const uint8_t *data, size_t len);
+
+static inline uint32_t
+load32be(const uint8_t *p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16)
+    | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static inline uint32_t
+load32le(const uint8_t *p)
+{
+  return ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16)
+    | ((uint32_t)p[1] << 8) | (uint32_t)p[0];
+}
+
+static inline uint64_t
+load64be(const uint8_t *p)
+{
+  return ((uint64_t)load32be(p) << 32) | load32be(p + 4);
+}
+
+static inline void
+store32be(uint8_t *p, uint32_t v)
+{
+  p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+static inline void
+store32le(uint8_t *p, uint32_t v)
+{
+  p[3] = v >> 24; p[2] = v >> 16; p[1] = v >> 8; p[0] = v;
+}
+
+static inline void
+store64be(uint8_t *p, uint64_t v)
+{
+  store32be(p, (uint32_t)(v >> 32));
+  store32be(p + 4, (uint32_t)v);
+}
+
+#define	ROL32(x, n)	(((x) << (n)) | ((x) >> (32 - (n))))
+#define	ROR32(x, n)	(((x) >> (n)) | ((x) << (32 - (n))))
+#define	ROR64(x, n)	(((x) >> (n)) | ((x) << (64 - (n))))
+
+/*
+ * The MD5 transform below was written by Colin Plumb in 1993, no
+ * copyright is claimed.  This code is in the public domain; do with it
+ * what you wish.
+ */
+
+/* The four core functions - F1 is optimized somewhat */
+
+/* #define F1(x, y, z) (x & y | ~x & z) */
+#define F1(x, y, z) (z ^ (x & (y ^ z)))
+#define F2(x, y, z) F1(z, x, y)
+#define F3(x, y, z) (x ^ y ^ z)
+#define F4(x, y, z) (y ^ (x | ~z))
+
+/* This is the central step in the MD5 algorithm. */
+#define MD5STEP(f, w, x, y, z, data, s) \
+  (w += f(x, y, z) + data,  w = w<<s | w>>(32-s),  w += x)
+
+/*
+ * The core of the MD5 algorithm, this alters an existing MD5 hash to
+ * reflect the addition of 16 32bit words of new data.
+ */
+static void
+MD5Transform(uint32_t buf[4], uint32_t const in[16])
+{
+  register uint32_t a, b, c, d;
+
+  a = buf[0];
+  b = buf[1];
+  c = buf[2];
+  d = buf[3];
+
+  MD5STEP (F1, a, b, c, d, in[0] + 0xd76aa478, 7);
+  MD5STEP (F1, d, a, b, c, in[1] + 0xe8c7b756, 12);
+  MD5STEP (F1, c, d, a, b, in[2] + 0x242070db, 17);
+  MD5STEP (F1, b, c, d, a, in[3] + 0xc1bdceee, 22);
+  MD5STEP (F1, a, b, c, d, in[4] + 0xf57c0faf, 7);
+  MD5STEP (F1, d, a, b, c, in[5] + 0x4787c62a, 12);
+  MD5STEP (F1, c, d, a, b, in[6] + 0xa8304613, 17);
+  MD5STEP (F1, b, c, d, a, in[7] + 0xfd469501, 22);
+  MD5STEP (F1, a, b, c, d, in[8] + 0x698098d8, 7);
+  MD5STEP (F1, d, a, b, c, in[9] + 0x8b44f7af, 12);
+  MD5STEP (F1, c, d, a, b, in[10] + 0xffff5bb1, 17);
+  MD5STEP (F1, b, c, d, a, in[11] + 0x895cd7be, 22);
+  MD5STEP (F1, a, b, c, d, in[12] + 0x6b901122, 7);
+  MD5STEP (F1, d, a, b, c, in[13] + 0xfd987193, 12);
+  MD5STEP (F1, c, d, a, b, in[14] + 0xa679438e, 17);
+  MD5STEP (F1, b, c, d, a, in[15] + 0x49b40821, 22);
+
+  MD5STEP (F2, a, b, c, d, in[1] + 0xf61e2562, 5);
+  MD5STEP (F2, d, a, b, c, in[6] + 0xc040b340, 9);
+  MD5STEP (F2, c, d, a, b, in[11] + 0x265e5a51, 14);
+  MD5STEP (F2, b, c, d, a, in[0] + 0xe9b6c7aa, 20);
+  MD5STEP (F2, a, b, c, d, in[5] + 0xd62f105d, 5);
+  MD5STEP (F2, d, a, b, c, in[10] + 0x02441453, 9);
+  MD5STEP (F2, c, d, a, b, in[15] + 0xd8a1e681, 14);
+  MD5STEP (F2, b, c, d, a, in[4] + 0xe7d3fbc8, 20);
+  MD5STEP (F2, a, b, c, d, in[9] + 0x21e1cde6, 5);
+  MD5STEP (F2, d, a, b, c, in[14] + 0xc33707d6, 9);
+  MD5STEP (F2, c, d, a, b, in[3] + 0xf4d50d87, 14);
+  MD5STEP (F2, b, c, d, a, in[8] + 0x455a14ed, 20);
+  MD5STEP (F2, a, b, c, d, in[13] + 0xa9e3e905, 5);
+  MD5STEP (F2, d, a, b, c, in[2] + 0xfcefa3f8, 9);
+  MD5STEP (F2, c, d, a, b, in[7] + 0x676f02d9, 14);
+  MD5STEP (F2, b, c, d, a, in[12] + 0x8d2a4c8a, 20);
+
+  MD5STEP (F3, a, b, c, d, in[5] + 0xfffa3942, 4);
+  MD5STEP (F3, d, a, b, c, in[8] + 0x8771f681, 11);
+  MD5STEP (F3, c, d, a, b, in[11] + 0x6d9d6122, 16);
+  MD5STEP (F3, b, c, d, a, in[14] + 0xfde5380c, 23);
+  MD5STEP (F3, a, b, c, d, in[1] + 0xa4beea44, 4);
+  MD5STEP (F3, d, a, b, c, in[4] + 0x4bdecfa9, 11);
+  MD5STEP (F3, c, d, a, b, in[7] + 0xf6bb4b60, 16);
+  MD5STEP (F3, b, c, d, a, in[10] + 0xbebfbc70, 23);
+  MD5STEP (F3, a, b, c, d, in[13] + 0x289b7ec6, 4);
+  MD5STEP (F3, d, a, b, c, in[0] + 0xeaa127fa, 11);
+  MD5STEP (F3, c, d, a, b, in[3] + 0xd4ef3085, 16);
+  MD5STEP (F3, b, c, d, a, in[6] + 0x04881d05, 23);
+  MD5STEP (F3, a, b, c, d, in[9] + 0xd9d4d039, 4);
+  MD5STEP (F3, d, a, b, c, in[12] + 0xe6db99e5, 11);
+  MD5STEP (F3, c, d, a, b, in[15] + 0x1fa27cf8, 16);
+  MD5STEP (F3, b, c, d, a, in[2] + 0xc4ac5665, 23);
+
+  MD5STEP (F4, a, b, c, d, in[0] + 0xf4292244, 6);
+  MD5STEP (F4, d, a, b, c, in[7] + 0x432aff97, 10);
+  MD5STEP (F4, c, d, a, b, in[14] + 0xab9423a7, 15);
+  MD5STEP (F4, b, c, d, a, in[5] + 0xfc93a039, 21);
+  MD5STEP (F4, a, b, c, d, in[12] + 0x655b59c3, 6);
+  MD5STEP (F4, d, a, b, c, in[3] + 0x8f0ccc92, 10);
+  MD5STEP (F4, c, d, a, b, in[10] + 0xffeff47d, 15);
+  MD5STEP (F4, b, c, d, a, in[1] + 0x85845dd1, 21);
+  MD5STEP (F4, a, b, c, d, in[8] + 0x6fa87e4f, 6);
+  MD5STEP (F4, d, a, b, c, in[15] + 0xfe2ce6e0, 10);
+  MD5STEP (F4, c, d, a, b, in[6] + 0xa3014314, 15);
+  MD5STEP (F4, b, c, d, a, in[13] + 0x4e0811a1, 21);
+  MD5STEP (F4, a, b, c, d, in[4] + 0xf7537e82, 6);
+  MD5STEP (F4, d, a, b, c, in[11] + 0xbd3af235, 10);
+  MD5STEP (F4, c, d, a, b, in[2] + 0x2ad7d2bb, 15);
+  MD5STEP (F4, b, c, d, a, in[9] + 0xeb86d391, 21);
+
+  buf[0] += a;
+  buf[1] += b;
+  buf[2] += c;
+  buf[3] += d;
+}
+
+static void
+md5Blocks(void *state, const uint8_t *data, size_t blocks)
+{
+  uint32_t	in[16];
+  unsigned	i;
+
+  while (blocks-- > 0)
+    {
+      for (i = 0; i < 16; i++)
+	{
+	  in[i] = load32le(data + 4 * i);
+	}
+      MD5Transform((uint32_t*)state, in);
+      data += 64;
+    }
+}
+
+static void
+sha1Blocks(void *state, const uint8_t *data, size_t blocks)
+{
+  uint32_t	*h = (uint32_t*)state;
+  uint32_t	w[80];
+  unsigned	i;
+
+  while (blocks-- > 0)
+    {
+      uint32_t	a = h[0];
+      uint32_t	b = h[1];
+      uint32_t	c = h[2];
+      uint32_t	d = h[3];
+      uint32_t	e = h[4];
+      uint32_t	t;
+
+      for (i = 0; i < 16; i++)
+	{
+	  w[i] = load32be(data + 4 * i);
+	}
+      for (; i < 80; i++)
+	{
+	  t = w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16];
+	  w[i] = ROL32(t, 1);
+	}
+      for (i = 0; i < 80; i++)
+	{
+	  if (i < 20)
+	    t = (d ^ (b & (c ^ d))) + 0x5a827999;
+	  else if (i < 40)
+	    t = (b ^ c ^ d) + 0x6ed9eba1;
+	  else if (i < 60)
+	    t = ((b & c) | (d & (b | c))) + 0x8f1bbcdc;
+	  else
+	    t = (b ^ c ^ d) + 0xca62c1d6;
+	  t += ROL32(a, 5) + e + w[i];
+	  e = d;
+	  d = c;
+	  c = ROL32(b, 30);
+	  b = a;
+	  a = t;
+	}
+      h[0] += a;
+      h[1] += b;
+      h[2] += c;
+      h[3] += d;
+      h[4] += e;
+      data += 64;
+    }
+}
+
+static const uint32_t	k256[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+  0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+  0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+  0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+  0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+  0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static void
+sha256Blocks(void *state, const uint8_t *data, size_t blocks)
+{
+  uint32_t	*h = (uint32_t*)state;
+  uint32_t	w[64];
+  unsigned	i;
+
+  while (blocks-- > 0)
+    {
+      uint32_t	a = h[0];
+      uint32_t	b = h[1];
+      uint32_t	c = h[2];
+      uint32_t	d = h[3];
+      uint32_t	e = h[4];
+      uint32_t	f = h[5];
+      uint32_t	g = h[6];
+      uint32_t	hh = h[7];
+
+      for (i = 0; i < 16; i++)
+	{
+	  w[i] = load32be(data + 4 * i);
+	}
+      for (; i < 64; i++)
+	{
+	  uint32_t	s0;
+	  uint32_t	s1;
+
+	  s0 = ROR32(w[i-15], 7) ^ ROR32(w[i-15], 18) ^ (w[i-15] >> 3);
+	  s1 = ROR32(w[i-2], 17) ^ ROR32(w[i-2], 19) ^ (w[i-2] >> 10);
+	  w[i] = w[i-16] + s0 + w[i-7] + s1;
+	}
+      for (i = 0; i < 64; i++)
+	{
+	  uint32_t	t1;
+	  uint32_t	t2;
+
+	  t1 = hh + (ROR32(e, 6) ^ ROR32(e, 11) ^ ROR32(e, 25))
+	    + (g ^ (e & (f ^ g))) + k256[i] + w[i];
+	  t2 = (ROR32(a, 2) ^ ROR32(a, 13) ^ ROR32(a, 22))
+	    + ((a & b) | (c & (a | b)));
+	  hh = g;
+	  g = f;
+	  f = e;
+	  e = d + t1;
+	  d = c;
+	  c = b;
+	  b = a;
+	  a = t1 + t2;
+	}
+      h[0] += a;
+      h[1] += b;
+      h[2] += c;
+      h[3] += d;
+      h[4] += e;
+      h[5] += f;
+      h[6] += g;
+      h[7] += hh;
+      data += 64;
+    }
+}
+
+static const uint64_t	k512[80] = {
+  0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL,
+  0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL,
+  0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL, 0xd807aa98a3030242ULL,
+  0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+  0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL,
+  0xc19bf174cf692694ULL, 0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL,
+  0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL, 0x2de92c6f592b0275ULL,
+  0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+  0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL,
+  0xbf597fc7beef0ee4ULL, 0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL,
+  0x06ca6351e003826fULL, 0x142929670a0e6e70ULL, 0x27b70a8546d22ffcULL,
+  0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+  0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL,
+  0x92722c851482353bULL, 0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL,
+  0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL, 0xd192e819d6ef5218ULL,
+  0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+  0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL,
+  0x34b0bcb5e19b48a8ULL, 0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL,
+  0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL, 0x748f82ee5defb2fcULL,
+  0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+  0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL,
+  0xc67178f2e372532bULL, 0xca273eceea26619cULL, 0xd186b8c721c0c207ULL,
+  0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL, 0x06f067aa72176fbaULL,
+  0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+  0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL,
+  0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL,
+  0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+static void
+sha512Blocks(void *state, const uint8_t *data, size_t blocks)
+{
+  uint64_t	*h = (uint64_t*)state;
+  uint64_t	w[80];
+  unsigned	i;
+
+  while (blocks-- > 0)
+    {
+      uint64_t	a = h[0];
+      uint64_t	b = h[1];
+      uint64_t	c = h[2];
+      uint64_t	d = h[3];
+      uint64_t	e = h[4];
+      uint64_t	f = h[5];
+      uint64_t	g = h[6];
+      uint64_t	hh = h[7];
+
+      for (i = 0; i < 16; i++)
+	{
+	  w[i] = load64be(data + 8 * i);
+	}
+      for (; i < 80; i++)
+	{
+	  uint64_t	s0;
+	  uint64_t	s1;
+
+	  s0 = ROR64(w[i-15], 1) ^ ROR64(w[i-15], 8) ^ (w[i-15] >> 7);
+	  s1 = ROR64(w[i-2], 19) ^ ROR64(w[i-2], 61) ^ (w[i-2] >> 6);
+	  w[i] = w[i-16] + s0 + w[i-7] + s1;
+	}
+      for (i = 0; i < 80; i++)
+	{
+	  uint64_t	t1;
+	  uint64_t	t2;
+
+	  t1 = hh + (ROR64(e, 14) ^ ROR64(e, 18) ^ ROR64(e, 41))
+	    + (g ^ (e & (f ^ g))) + k512[i] + w[i];
+	  t2 = (ROR64(a, 28) ^ ROR64(a, 34) ^ ROR64(a, 39))
+	    + ((a & b) | (c & (a | b)));
+	  hh = g;
+	  g = f;
+	  f = e;
+	  e = d + t1;
+	  d = c;
+	  c = b;
+	  b = a;
+	  a = t1 + t2;
+	}
+      h[0] += a;
+      h[1] += b;
+      h[2] += c;
+      h[3] += d;
+      h[4] += e;
+      h[5] += f;
+      h[6] += g;
+      h[7] += hh;
+      data += 128;
+    }
+}
+
+/* Slicing-by-8 tables for the reflected Castagnoli polynomial.
+ */
+static uint32_t	crcTable[8][256];
+
+static uint32_t
+crc32cScalar(uint32_t crc, const uint8_t *p, size_t len)
+{
+  while (len > 0 && ((uintptr_t)p & 7) != 0)
+    {
+      crc = crcTable[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+      len--;
+    }
+  while (len >= 8)
+    {
+      uint32_t	lo = crc ^ load32le(p);
+      uint32_t	hi = load32le(p + 4);
+
+      crc = crcTable[7][lo & 0xff] ^ crcTable[6][(lo >> 8) & 0xff]
+	^ crcTable[5][(lo >> 16) & 0xff] ^ crcTable[4][lo >> 24]
+	^ crcTable[3][hi & 0xff] ^ crcTable[2][(hi >> 8) & 0xff]
+	^ crcTable[1][(hi >> 16) & 0xff] ^ crcTable[0][hi >> 24];
+      p += 8;
+      len -= 8;
+    }
+  while (len-- > 0)
+    {
+      crc = crcTable[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+  return crc;
+}
+
+#if	defined(GS_DIGEST_X86)
+
+static SHANI void
+sha1NI(void *state, const uint8_t *data, size_t blocks)
+{
+  uint32_t	*h = (uint32_t*)state;
+  const __m128i	mask = _mm_set_epi64x(0x0001020304050607ULL,
+    0x08090a0b0c0d0e0fULL);
+  __m128i	abcd;
+  __m128i	e0;
+  __m128i	e1;
+  __m128i	m0;
+  __m128i	m1;
+  __m128i	m2;
+  __m128i	m3;
+
+  abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)h), 0x1b);
+  e0 = _mm_set_epi32(h[4], 0, 0, 0);
+  while (blocks-- > 0)
+    {
+      __m128i	abcdSave = abcd;
+      __m128i	e0Save = e0;
+
+      /* Rounds 0-3 */
+      m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 0)), mask);
+      e0 = _mm_add_epi32(e0, m0);
+      e1 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+      /* Rounds 4-7 */
+      m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), mask);
+      e1 = _mm_sha1nexte_epu32(e1, m1);
+      e0 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+      m0 = _mm_sha1msg1_epu32(m0, m1);
+      /* Rounds 8-11 */
+      m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), mask);
+      e0 = _mm_sha1nexte_epu32(e0, m2);
+      e1 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+      m1 = _mm_sha1msg1_epu32(m1, m2);
+      m0 = _mm_xor_si128(m0, m2);
+      /* Rounds 12-15 */
+      m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), mask);
+      e1 = _mm_sha1nexte_epu32(e1, m3);
+      e0 = abcd;
+      m0 = _mm_sha1msg2_epu32(m0, m3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+      m2 = _mm_sha1msg1_epu32(m2, m3);
+      m1 = _mm_xor_si128(m1, m3);
+      /* Rounds 16-19 */
+      e0 = _mm_sha1nexte_epu32(e0, m0);
+      e1 = abcd;
+      m1 = _mm_sha1msg2_epu32(m1, m0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+      m3 = _mm_sha1msg1_epu32(m3, m0);
+      m2 = _mm_xor_si128(m2, m0);
+      /* Rounds 20-23 */
+      e1 = _mm_sha1nexte_epu32(e1, m1);
+      e0 = abcd;
+      m2 = _mm_sha1msg2_epu32(m2, m1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+      m0 = _mm_sha1msg1_epu32(m0, m1);
+      m3 = _mm_xor_si128(m3, m1);
+      /* Rounds 24-27 */
+      e0 = _mm_sha1nexte_epu32(e0, m2);
+      e1 = abcd;
+      m3 = _mm_sha1msg2_epu32(m3, m2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+      m1 = _mm_sha1msg1_epu32(m1, m2);
+      m0 = _mm_xor_si128(m0, m2);
+      /* Rounds 28-31 */
+      e1 = _mm_sha1nexte_epu32(e1, m3);
+      e0 = abcd;
+      m0 = _mm_sha1msg2_epu32(m0, m3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+      m2 = _mm_sha1msg1_epu32(m2, m3);
+      m1 = _mm_xor_si128(m1, m3);
+      /* Rounds 32-35 */
+      e0 = _mm_sha1nexte_epu32(e0, m0);
+      e1 = abcd;
+      m1 = _mm_sha1msg2_epu32(m1, m0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+      m3 = _mm_sha1msg1_epu32(m3, m0);
+      m2 = _mm_xor_si128(m2, m0);
+      /* Rounds 36-39 */
+      e1 = _mm_sha1nexte_epu32(e1, m1);
+      e0 = abcd;
+      m2 = _mm_sha1msg2_epu32(m2, m1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+      m0 = _mm_sha1msg1_epu32(m0, m1);
+      m3 = _mm_xor_si128(m3, m1);
+      /* Rounds 40-43 */
+      e0 = _mm_sha1nexte_epu32(e0, m2);
+      e1 = abcd;
+      m3 = _mm_sha1msg2_epu32(m3, m2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+      m1 = _mm_sha1msg1_epu32(m1, m2);
+      m0 = _mm_xor_si128(m0, m2);
+      /* Rounds 44-47 */
+      e1 = _mm_sha1nexte_epu32(e1, m3);
+      e0 = abcd;
+      m0 = _mm_sha1msg2_epu32(m0, m3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+      m2 = _mm_sha1msg1_epu32(m2, m3);
+      m1 = _mm_xor_si128(m1, m3);
+      /* Rounds 48-51 */
+      e0 = _mm_sha1nexte_epu32(e0, m0);
+      e1 = abcd;
+      m1 = _mm_sha1msg2_epu32(m1, m0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+      m3 = _mm_sha1msg1_epu32(m3, m0);
+      m2 = _mm_xor_si128(m2, m0);
+      /* Rounds 52-55 */
+      e1 = _mm_sha1nexte_epu32(e1, m1);
+      e0 = abcd;
+      m2 = _mm_sha1msg2_epu32(m2, m1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+      m0 = _mm_sha1msg1_epu32(m0, m1);
+      m3 = _mm_xor_si128(m3, m1);
+      /* Rounds 56-59 */
+      e0 = _mm_sha1nexte_epu32(e0, m2);
+      e1 = abcd;
+      m3 = _mm_sha1msg2_epu32(m3, m2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+      m1 = _mm_sha1msg1_epu32(m1, m2);
+      m0 = _mm_xor_si128(m0, m2);
+      /* Rounds 60-63 */
+      e1 = _mm_sha1nexte_epu32(e1, m3);
+      e0 = abcd;
+      m0 = _mm_sha1msg2_epu32(m0, m3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+      m2 = _mm_sha1msg1_epu32(m2, m3);
+      m1 = _mm_xor_si128(m1, m3);
+      /* Rounds 64-67 */
+      e0 = _mm_sha1nexte_epu32(e0, m0);
+      e1 = abcd;
+      m1 = _mm_sha1msg2_epu32(m1, m0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+      m3 = _mm_sha1msg1_epu32(m3, m0);
+      m2 = _mm_xor_si128(m2, m0);
+      /* Rounds 68-71 */
+      e1 = _mm_sha1nexte_epu32(e1, m1);
+      e0 = abcd;
+      m2 = _mm_sha1msg2_epu32(m2, m1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+      m3 = _mm_xor_si128(m3, m1);
+      /* Rounds 72-75 */
+      e0 = _mm_sha1nexte_epu32(e0, m2);
+      e1 = abcd;
+      m3 = _mm_sha1msg2_epu32(m3, m2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+      /* Rounds 76-79 */
+      e1 = _mm_sha1nexte_epu32(e1, m3);
+      e0 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+
+      e0 = _mm_sha1nexte_epu32(e0, e0Save);
+      abcd = _mm_add_epi32(abcd, abcdSave);
+      data += 64;
+    }
+  _mm_storeu_si128((__m128i*)h, _mm_shuffle_epi32(abcd, 0x1b));
+  h[4] = _mm_extract_epi32(e0, 3);
+}
+
+/* Four SHA-256 rounds using the message words in m.
+ */
+#define	SHA256_ROUNDS(m, i) \
+  msg = _mm_add_epi32(m, _mm_loadu_si128((const __m128i*)&k256[i])); \
+  s1 = _mm_sha256rnds2_epu32(s1, s0, msg); \
+  s0 = _mm_sha256rnds2_epu32(s0, s1, _mm_shuffle_epi32(msg, 0x0e))
+
+/* Computes the next four message words in m0 from the previous sixteen
+ * (in m0 to m3, oldest first) then performs four rounds with them.
+ */
+#define	SHA256_SCHEDULE(m0, m1, m2, m3, i) \
+  m0 = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(m0, m1), \
+    _mm_alignr_epi8(m3, m2, 4)), m3); \
+  SHA256_ROUNDS(m0, i)
+
+static SHANI void
+sha256NI(void *state, const uint8_t *data, size_t blocks)
+{
+  uint32_t	*h = (uint32_t*)state;
+  const __m128i	mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+    0x0405060700010203ULL);
+  __m128i	s0;
+  __m128i	s1;
+  __m128i	tmp;
+  __m128i	msg;
+  __m128i	m0;
+  __m128i	m1;
+  __m128i	m2;
+  __m128i	m3;
+
+  /* The instructions want the state as ABEF and CDGH.
+   */
+  tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&h[0]), 0xb1);
+  s1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&h[4]), 0x1b);
+  s0 = _mm_alignr_epi8(tmp, s1, 8);
+  s1 = _mm_blend_epi16(s1, tmp, 0xf0);
+
+  while (blocks-- > 0)
+    {
+      __m128i	s0Save = s0;
+      __m128i	s1Save = s1;
+      unsigned	i;
+
+      m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), mask);
+      SHA256_ROUNDS(m0, 0);
+      m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data+16)), mask);
+      SHA256_ROUNDS(m1, 4);
+      m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data+32)), mask);
+      SHA256_ROUNDS(m2, 8);
+      m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data+48)), mask);
+      SHA256_ROUNDS(m3, 12);
+      for (i = 16; i < 64; i += 16)
+	{
+	  SHA256_SCHEDULE(m0, m1, m2, m3, i);
+	  SHA256_SCHEDULE(m1, m2, m3, m0, i + 4);
+	  SHA256_SCHEDULE(m2, m3, m0, m1, i + 8);
+	  SHA256_SCHEDULE(m3, m0, m1, m2, i + 12);
+	}
+      s0 = _mm_add_epi32(s0, s0Save);
+      s1 = _mm_add_epi32(s1, s1Save);
+      data += 64;
+    }
+
+  tmp = _mm_shuffle_epi32(s0, 0x1b);
+  s1 = _mm_shuffle_epi32(s1, 0xb1);
+  _mm_storeu_si128((__m128i*)&h[0], _mm_blend_epi16(tmp, s1, 0xf0));
+  _mm_storeu_si128((__m128i*)&h[4], _mm_alignr_epi8(s1, tmp, 8));
+}
+
+static SSE42 uint32_t
+crc32cSSE42(uint32_t crc, const uint8_t *p, size_t len)
+{
+  while (len > 0 && ((uintptr_t)p & 7) != 0)
+    {
+      crc = _mm_crc32_u8(crc, *p++);
+      len--;
+    }
+#if	defined(__x86_64__)
+  {
+    uint64_t	c = crc;
+
+    while (len >= 8)
+      {
+	uint64_t	v;
+
+	memcpy(&v, p, 8);
+	c = _mm_crc32_u64(c, v);
+	p += 8;
+	len -= 8;
+      }
+    crc = (uint32_t)c;
+  }
+#else
+  while (len >= 4)
+    {
+      uint32_t	v;
+
+      memcpy(&v, p, 4);
+      crc = _mm_crc32_u32(crc, v);
+      p += 4;
+      len -= 4;
+    }
+#endif
+  while (len-- > 0)
+    {
+      crc = _mm_crc32_u8(crc, *p++);
+    }
+  return crc;
+}
+
+#endif	/* GS_DIGEST_X86 */
+
+typedef struct {
+  unsigned	blockSize;
+  unsigned	digestLength;
+  BlockFunction	blocks;
+} AlgorithmInfo;
+
+/* Indexed by GSDigestAlgorithm.  The block functions for SHA-1 and
+ * SHA-256 are replaced by hardware versions in setup() if possible.
+ */
+static AlgorithmInfo	algorithms[] = {
+  { 64, 16, md5Blocks },
+  { 64, 20, sha1Blocks },
+  { 64, 32, sha256Blocks },
+  { 128, 64, sha512Blocks },
+  { 0, 4, 0 }
+};
+static CRCFunction	crc32c = crc32cScalar;
+
+static void
+setup(void)
+{
+  unsigned	i;
+  unsigned	j;
+
+  for (i = 0; i < 256; i++)
+    {
+      uint32_t	c = i;
+
+      for (j = 0; j < 8; j++)
+	{
+	  c = (c & 1) ? (c >> 1) ^ 0x82f63b78 : c >> 1;
+	}
+      crcTable[0][i] = c;
+    }
+  for (i = 0; i < 256; i++)
+    {
+      for (j = 1; j < 8; j++)
+	{
+	  uint32_t	c = crcTable[j-1][i];
+
+	  crcTable[j][i] = crcTable[0][c & 0xff] ^ (c >> 8);
+	}
+    }
+
+#if	defined(GS_DIGEST_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse4.2"))
+    {
+      crc32c = crc32cSSE42;
+    }
+  if (__builtin_cpu_supports("sse4.1") && __get_cpuid_max(0, 0) >= 7)
+    {
+      unsigned	a, b, c, d;
+
+      __cpuid_count(7, 0, a, b, c, d);
+      if (b & (1 << 29))
+	{
+	  algorithms[GSDigestSHA1].blocks = sha1NI;
+	  algorithms[GSDigestSHA256].blocks = sha256NI;
+	}
+    }
+#endif
+}
+
+static void
+digestInit(GSDigestAlgorithm a, DigestContext *c)
+{
+  memset(c, '\0', sizeof(*c));
+  switch (a)
+    {
+      case GSDigestMD5:
+	c->h.w32[0] = 0x67452301;
+	c->h.w32[1] = 0xefcdab89;
+	c->h.w32[2] = 0x98badcfe;
+	c->h.w32[3] = 0x10325476;
+	break;
+      case GSDigestSHA1:
+	c->h.w32[0] = 0x67452301;
+	c->h.w32[1] = 0xefcdab89;
+	c->h.w32[2] = 0x98badcfe;
+	c->h.w32[3] = 0x10325476;
+	c->h.w32[4] = 0xc3d2e1f0;
+	break;
+      case GSDigestSHA256:
+	c->h.w32[0] = 0x6a09e667;
+	c->h.w32[1] = 0xbb67ae85;
+	c->h.w32[2] = 0x3c6ef372;
+	c->h.w32[3] = 0xa54ff53a;
+	c->h.w32[4] = 0x510e527f;
+	c->h.w32[5] = 0x9b05688c;
+	c->h.w32[6] = 0x1f83d9ab;
+	c->h.w32[7] = 0x5be0cd19;
+	break;
+      case GSDigestSHA512:
+	c->h.w64[0] = 0x6a09e667f3bcc908ULL;
+	c->h.w64[1] = 0xbb67ae8584caa73bULL;
+	c->h.w64[2] = 0x3c6ef372fe94f82bULL;
+	c->h.w64[3] = 0xa54ff53a5f1d36f1ULL;
+	c->h.w64[4] = 0x510e527fade682d1ULL;
+	c->h.w64[5] = 0x9b05688c2b3e6c1fULL;
+	c->h.w64[6] = 0x1f83d9abfb41bd6bULL;
+	c->h.w64[7] = 0x5be0cd19137e2179ULL;
+	break;
+      case GSDigestCRC32C:
+	c->h.w32[0] = 0xffffffff;
+	break;
+    }
+}
+
+static void
+digestUpdate(GSDigestAlgorithm a, DigestContext *c, const uint8_t *p, size_t n)
+{
+  unsigned	bs;
+  BlockFunction	blocks;
+
+  if (GSDigestCRC32C == a)
+    {
+      c->h.w32[0] = (*crc32c)(c->h.w32[0], p, n);
+      c->count += n;
+      return;
+    }
+  bs = algorithms[a].blockSize;
+  blocks = algorithms[a].blocks;
+  c->count += n;
+  if (c->used > 0)
+    {
+      size_t	take = bs - c->used;
+
+      if (take > n)
+	{
+	  take = n;
+	}
+      memcpy(c->buffer + c->used, p, take);
+      c->used += take;
+      p += take;
+      n -= take;
+      if (c->used < bs)
+	{
+	  return;
+	}
+      (*blocks)(&c->h, c->buffer, 1);
+      c->used = 0;
+    }
+  if (n >= bs)
+    {
+      size_t	count = n / bs;
+
+      (*blocks)(&c->h, p, count);
+      p += count * bs;
+      n -= count * bs;
+    }
+  if (n > 0)
+    {
+      memcpy(c->buffer, p, n);
+      c->used = n;
+    }
+}
+
+/* Pads the message in c and writes the digest to out.  This destroys
+ * the context, so callers wanting to continue should work on a copy.
+ */
+static void
+digestFinal(GSDigestAlgorithm a, DigestContext *c, uint8_t *out)
+{
+  uint8_t	pad[256];
+  unsigned	bs;
+  unsigned	lenBytes;
+  unsigned	padLen;
+  uint64_t	bits;
+  unsigned	i;
+
+  if (GSDigestCRC32C == a)
+    {
+      store32be(out, ~c->h.w32[0]);
+      return;
+    }
+  bs = algorithms[a].blockSize;
+  lenBytes = (128 == bs) ? 16 : 8;
+  bits = c->count << 3;
+  padLen = bs - lenBytes - c->used;
+  if (c->used >= bs - lenBytes)
+    {
+      padLen += bs;
+    }
+  memset(pad, '\0', padLen + lenBytes);
+  pad[0] = 0x80;
+  if (GSDigestMD5 == a)
+    {
+      store32le(pad + padLen, (uint32_t)bits);
+      store32le(pad + padLen + 4, (uint32_t)(bits >> 32));
+    }
+  else
+    {
+      if (16 == lenBytes)
+	{
+	  store64be(pad + padLen, c->count >> 61);
+	  padLen += 8;
+	}
+      store64be(pad + padLen, bits);
+    }
+  digestUpdate(a, c, pad, padLen + 8);
+
+  switch (a)
+    {
+      case GSDigestMD5:
+	for (i = 0; i < 4; i++)
+	  {
+	    store32le(out + 4 * i, c->h.w32[i]);
+	  }
+	break;
+      case GSDigestSHA512:
+	for (i = 0; i < 8; i++)
+	  {
+	    store64be(out + 8 * i, c->h.w64[i]);
+	  }
+	break;
+      default:
+	for (i = 0; i < algorithms[a].digestLength / 4; i++)
+	  {
+	    store32be(out + 4 * i, c->h.w32[i]);
+	  }
+	break;
+    }
+}
+
+#define	CHUNK	(1024 * 1024)
+
+/**
+ * <p>An incremental message digest.
+ * </p>
+ * <p>The digest is updated by adding data to it in pieces of any size,
+ * and -digest may be called at any point to obtain the digest of the
+ * data added so far.  A GSDigest may also be attached to a file handle
+ * (so that data read in the background is added as it arrives) or
+ * wrapped around an input stream using [GSDigestInputStream].
+ * </p>
+ * <p>Where the processor supports it, SHA-1 and SHA-256 use the x86
+ * SHA extensions and CRC32C uses the SSE4.2 crc32 instruction.
+ * </p>
+ */
+@implementation	GSDigest
+
++ (NSData*) digestOfContentsOfFile: (NSString*)path
+			 algorithm: (GSDigestAlgorithm)algorithm
+{
+  GSDigest	*d;
+  NSData	*m;
+  NSData	*result = nil;
+
+  d = [[self alloc] initWithAlgorithm: algorithm];
+  /* Mapping the file lets the digest read straight from the page cache,
+   * but files too large to map are read in chunks instead.
+   */
+  m = [[NSData alloc] initWithContentsOfMappedFile: path];
+  if (m != nil)
+    {
+      [d updateWithData: m];
+      RELEASE(m);
+      result = [d digest];
+    }
+  else if ([d updateWithContentsOfFile: path] == YES)
+    {
+      result = [d digest];
+    }
+  RELEASE(d);
+  return result;
+}
+
++ (GSDigest*) digestWithAlgorithm: (GSDigestAlgorithm)algorithm
+{
+  return AUTORELEASE([[self alloc] initWithAlgorithm: algorithm]);
+}
+
++ (void) initialize
+{
+  if (self == [GSDigest class])
+    {
+      setup();
+    }
+}
+
+- (GSDigestAlgorithm) algorithm
+{
+  return _algorithm;
+}
+
+- (void) attachToFileHandle: (NSFileHandle*)aHandle
+{
+  NSNotificationCenter	*nc = [NSNotificationCenter defaultCenter];
+
+  [nc addObserver: self
+	 selector: @selector(_read:)
+	     name: NSFileHandleReadCompletionNotification
+	   object: aHandle];
+  [nc addObserver: self
+	 selector: @selector(_read:)
+	     name: NSFileHandleReadToEndOfFileCompletionNotification
+	   object: aHandle];
+}
+
+- (id) copyWithZone: (NSZone*)z
+{
+  GSDigest	*c = [[[self class] allocWithZone: z] init];
+
+  c->_algorithm = _algorithm;
+  memcpy(c->_context, _context, sizeof(DigestContext));
+  return c;
+}
+
+- (void) dealloc
+{
+  [[NSNotificationCenter defaultCenter] removeObserver: self];
+  if (_context != 0)
+    {
+      memset(_context, '\0', sizeof(DigestContext));
+      NSZoneFree(NSDefaultMallocZone(), _context);
+    }
+  [super dealloc];
+}
+
+- (NSString*) description
+{
+  static NSString	*names[] = {
+    @"MD5", @"SHA-1", @"SHA-256", @"SHA-512", @"CRC32C" };
+
+  return [NSString stringWithFormat: @"%@ %@ (%llu bytes)",
+    [super description], names[_algorithm],
+    (unsigned long long)((DigestContext*)_context)->count];
+}
+
+- (void) detachFromFileHandle: (NSFileHandle*)aHandle
+{
+  NSNotificationCenter	*nc = [NSNotificationCenter defaultCenter];
+
+  [nc removeObserver: self
+		name: NSFileHandleReadCompletionNotification
+	      object: aHandle];
+  [nc removeObserver: self
+		name: NSFileHandleReadToEndOfFileCompletionNotification
+	      object: aHandle];
+}
+
+- (NSData*) digest
+{
+  DigestContext	tmp;
+  uint8_t	out[64];
+
+  memcpy(&tmp, _context, sizeof(tmp));
+  digestFinal(_algorithm, &tmp, out);
+  memset(&tmp, '\0', sizeof(tmp));
+  return [NSData dataWithBytes: out length: algorithms[_algorithm].digestLength];
+}
+
+- (NSUInteger) digestLength
+{
+  return algorithms[_algorithm].digestLength;
+}
+
+- (id) init
+{
+  return [self initWithAlgorithm: GSDigestSHA256];
+}
+
+- (id) initWithAlgorithm: (GSDigestAlgorithm)algorithm
+{
+  if ((unsigned)algorithm > GSDigestCRC32C)
+    {
+      DESTROY(self);
+      [NSException raise: NSInvalidArgumentException
+		  format: @"[GSDigest-initWithAlgorithm:] bad algorithm %d",
+	(int)algorithm];
+    }
+  if (nil != (self = [super init]))
+    {
+      _algorithm = algorithm;
+      _context = NSZoneMalloc(NSDefaultMallocZone(), sizeof(DigestContext));
+      digestInit(_algorithm, (DigestContext*)_context);
+    }
+  return self;
+}
+
+- (void) reset
+{
+  digestInit(_algorithm, (DigestContext*)_context);
+}
+
+- (void) updateWithBytes: (const void*)bytes length: (NSUInteger)length
+{
+  digestUpdate(_algorithm, (DigestContext*)_context,
+    (const uint8_t*)bytes, length);
+}
+
+- (BOOL) updateWithContentsOfFile: (NSString*)path
+{
+  NSFileHandle	*h = [NSFileHandle fileHandleForReadingAtPath: path];
+
+  if (nil == h)
+    {
+      return NO;
+    }
+  return [self updateWithFileHandle: h];
+}
+
+- (void) updateWithData: (NSData*)data
+{
+  digestUpdate(_algorithm, (DigestContext*)_context,
+    (const uint8_t*)[data bytes], [data length]);
+}
+
+- (BOOL) updateWithFileHandle: (NSFileHandle*)aHandle
+{
+  BOOL	ok = YES;
+
+  NS_DURING
+    {
+      for (;;)
+	{
+	  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+	  NSData		*d = [aHandle readDataOfLength: CHUNK];
+	  NSUInteger		l = [d length];
+
+	  [self updateWithData: d];
+	  [arp release];
+	  if (0 == l)
+	    {
+	      break;
+	    }
+	}
+    }
+  NS_HANDLER
+    {
+      ok = NO;
+    }
+  NS_ENDHANDLER
+  return ok;
+}
+
+- (BOOL) updateWithStream: (NSInputStream*)aStream
+{
+  uint8_t	*buf;
+  NSInteger	n;
+
+  if ([aStream streamStatus] == NSStreamStatusNotOpen)
+    {
+      [aStream open];
+    }
+  buf = NSZoneMalloc(NSDefaultMallocZone(), 65536);
+  while ((n = [aStream read: buf maxLength: 65536]) > 0)
+    {
+      digestUpdate(_algorithm, (DigestContext*)_context, buf, n);
+    }
+  NSZoneFree(NSDefaultMallocZone(), buf);
+  return (n < 0) ? NO : YES;
+}
+
+- (void) _read: (NSNotification*)n
+{
+  NSData	*d;
+
+  d = [[n userInfo] objectForKey: NSFileHandleNotificationDataItem];
+  [self updateWithData: d];
+}
+
+@end
+
+
+
+/**
+ * <p>An input stream which passes on the data read from another stream
+ * while adding it to a [GSDigest].  Once the consumer of the stream has
+ * reached its end, the digest holds the checksum of everything read.
+ * </p>
+ * <p>The receiver does not buffer data, so -getBuffer:length: always
+ * returns NO.
+ * </p>
+ */
+@implementation	GSDigestInputStream
+
++ (id) streamWithInputStream: (NSInputStream*)aStream
+		      digest: (GSDigest*)aDigest
+{
+  return AUTORELEASE([[self alloc] initWithInputStream: aStream
+						digest: aDigest]);
+}
+
+- (void) close
+{
+  [_stream close];
+}
+
+- (void) dealloc
+{
+  if ([_stream delegate] == self)
+    {
+      [_stream setDelegate: nil];
+    }
+  DESTROY(_stream);
+  DESTROY(_digest);
+  [super dealloc];
+}
+
+- (id) delegate
+{
+  return _delegate;
+}
+
+- (GSDigest*) digest
+{
+  return _digest;
+}
+
+- (BOOL) getBuffer: (uint8_t **)buffer length: (NSUInteger *)len
+{
+  return NO;
+}
+
+- (BOOL) hasBytesAvailable
+{
+  return [_stream hasBytesAvailable];
+}
+
+- (id) initWithInputStream: (NSInputStream*)aStream
+		    digest: (GSDigest*)aDigest
+{
+  if (nil != (self = [super init]))
+    {
+      ASSIGN(_stream, aStream);
+      ASSIGN(_digest, aDigest);
+      _delegate = self;
+      [_stream setDelegate: self];
+    }
+  return self;
+}
+
+- (void) open
+{
+  [_stream open];
+}
+
+- (id) propertyForKey: (NSString *)key
+{
+  return [_stream propertyForKey: key];
+}
+
+- (NSInteger) read: (uint8_t *)buffer maxLength: (NSUInteger)len
+{
+  NSInteger	n = [_stream read: buffer maxLength: len];
+
+  if (n > 0)
+    {
+      [_digest updateWithBytes: buffer length: n];
+    }
+  return n;
+}
+
+- (void) removeFromRunLoop: (NSRunLoop *)aRunLoop forMode: (NSString *)mode
+{
+  [_stream removeFromRunLoop: aRunLoop forMode: mode];
+}
+
+- (void) scheduleInRunLoop: (NSRunLoop *)aRunLoop forMode: (NSString *)mode
+{
+  [_stream scheduleInRunLoop: aRunLoop forMode: mode];
+}
+
+- (void) setDelegate: (id)delegate
+{
+  /* As with other streams, the delegate is not retained and a nil
+   * delegate means the receiver is its own delegate.
+   */
+  _delegate = (nil == delegate) ? (id)self : delegate;
+}
+
+- (BOOL) setProperty: (id)property forKey: (NSString *)key
+{
+  return [_stream setProperty: property forKey: key];
+}
+
+- (void) stream: (NSStream*)aStream handleEvent: (NSStreamEvent)anEvent
+{
+  if (aStream == _stream && _delegate != self
+    && [_delegate respondsToSelector: @selector(stream:handleEvent:)])
+    {
+      [_delegate stream: self handleEvent: anEvent];
+    }
+}
+
+- (NSError *) streamError
+{
+  return [_stream streamError];
+}
+
+- (NSStreamStatus) streamStatus
+{
+  return [_stream streamStatus];
+}
+
+@end
+
+
+
+/**
+ * Digest methods for the NSData class.  See [GSDigest] for computing a
+ * digest of data which is not all in memory at once.
+ */
+@implementation	NSData (GSDigest)
+
+- (NSData*) crc32cDigest
+{
+  return [self digestUsingAlgorithm: GSDigestCRC32C];
+}
+
+- (NSData*) digestUsingAlgorithm: (GSDigestAlgorithm)algorithm
+{
+  GSDigest	*d = [[GSDigest alloc] initWithAlgorithm: algorithm];
+  NSData	*result;
+
+  [d updateWithData: self];
+  result = [d digest];
+  RELEASE(d);
+  return result;
+}
+
+- (NSData*) sha1Digest
+{
+  return [self digestUsingAlgorithm: GSDigestSHA1];
+}
+
+- (NSData*) sha256Digest
+{
+  return [self digestUsingAlgorithm: GSDigestSHA256];
+}
+
+- (NSData*) sha512Digest
+{
+  return [self digestUsingAlgorithm: GSDigestSHA512];
+}
+
+@end
@@ -0,0 +1,1673 @@
+/** Implementation of an embedded HTTP/1.1 server
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNUstep Base Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02111 USA.
+
+   <title>GSHTTPServer class reference</title>
+*/
+
+#import "common.h"
+#import "Foundation/NSArray.h"
+#import "Foundation/NSAutoreleasePool.h"
+#import "Foundation/NSData.h"
+#import "Foundation/NSDictionary.h"
+#import "Foundation/NSException.h"
+#import "Foundation/NSLock.h"
+#import "Foundation/NSRunLoop.h"
+#import "Foundation/NSSet.h"
+#import "Foundation/NSStream.h"
+#import "Foundation/NSThread.h"
+#import "Foundation/NSTimer.h"
+#import "Foundation/NSValue.h"
+#import "GNUstepBase/GSMime.h"
+#import "GNUstepBase/GSHTTPServer.h"
+#import "GNUstepBase/NSStream+GNUstepBase.h"
+#import "GNUstepBase/NSString+GNUstepBase.h"
+#import "../GSPrivate.h"
+
+#include <ctype.h>
+#include <string.h>
+#include <time.h>
+#if	!defined(_WIN32)
+#include <sys/socket.h>
+#endif
+
+/* Limits protecting the server from misbehaving clients.  A request line
+ * and headers larger than MAX_HEADER are rejected, and a connection stops
+ * reading while it has more than MAX_HEADER bytes of pipelined requests
+ * waiting or more than MAX_OUTPUT bytes of responses not yet sent.
+ * Request bodies collected in memory are limited to MAX_BODY bytes
+ * unless the server is configured otherwise.
+ */
+#define	MAX_HEADER	(64 * 1024)
+#define	MAX_OUTPUT	(256 * 1024)
+#define	MAX_BODY	(8 * 1024 * 1024)
+#define	READ_SIZE	(16 * 1024)
+
+/* Where a connection is in reading its current request.
+ */
+typedef enum {
+  ReadHeaders,		/* Waiting for the request line and headers.	*/
+  ReadLength,		/* Reading a body of known length.		*/
+  ReadChunkSize,	/* Reading the size line of a chunk.		*/
+  ReadChunkData,	/* Reading the data in a chunk.			*/
+  ReadChunkEnd,		/* Reading the line end after chunk data.	*/
+  ReadTrailer,		/* Reading trailers after the last chunk.	*/
+  ReadDone		/* Waiting for the response to be finished.	*/
+} ReadState;
+
+/* Where a request is in sending its response.
+ */
+enum {
+  RespNone = 0,		/* Nothing sent yet.				*/
+  RespBody,		/* Headers sent, body being sent in parts.	*/
+  RespDone		/* Response finished.				*/
+};
+
+@class	GSHTTPServerWorker;
+
+/* One client connection, owned by the worker whose run loop it uses.
+ */
+@interface	GSHTTPServerConnection : NSObject
+{
+@public
+  GSHTTPServerWorker	*worker;	/* Not retained.		*/
+  NSInputStream		*istream;
+  NSOutputStream	*ostream;
+  NSMutableData		*inBuf;
+  NSUInteger		inPos;		/* Start of unprocessed input.	*/
+  NSMutableData		*outBuf;
+  NSUInteger		outPos;		/* Start of unsent output.	*/
+  GSHTTPServerRequest	*request;
+  ReadState		state;
+  uint64_t		remaining;	/* Body or chunk bytes left.	*/
+  uint64_t		bodySize;	/* Chunked body bytes so far.	*/
+  uint64_t		bodyLimit;	/* Zero if body is unlimited.	*/
+  NSTimeInterval	lastActivity;
+  BOOL			streamBody;
+  BOOL			processing;
+  BOOL			paused;
+  BOOL			readClosed;
+  BOOL			closeAfterWrite;
+  BOOL			closed;
+}
+- (void) close;
+- (id) initWithWorker: (GSHTTPServerWorker*)w
+		input: (NSInputStream*)i
+	       output: (NSOutputStream*)o;
+- (void) requestFinished: (GSHTTPServerRequest*)r;
+- (void) sendBytes: (const void*)bytes length: (NSUInteger)length;
+@end
+
+/* A thread with its own run loop (or, for a server with no worker
+ * threads, the thread which started the server) and the connections
+ * it handles.
+ */
+@interface	GSHTTPServerWorker : NSObject
+{
+@public
+  GSHTTPServer		*server;	/* Not retained.		*/
+  NSThread		*thread;
+  GSServerStream	*listener;
+  NSMutableSet		*connections;
+  NSTimer		*timer;		/* Not retained.		*/
+  BOOL			stopping;
+  time_t		dateTime;
+  char			date[32];
+}
+- (void) adopt: (NSArray*)streams;
+- (void) attach;
+- (const char*) date;
+- (void) detach;
+- (id) initWithServer: (GSHTTPServer*)s;
+@end
+
+@interface	GSHTTPServer (Private)
+- (void) _accepted: (NSArray*)streams by: (GSHTTPServerWorker*)w;
+- (void) _countOpen: (int)delta;
+- (void) _countRequest;
+- (GSServerStream*) _listen;
+- (void) _workerStarted;
+@end
+
+@interface	GSHTTPServerRequest (Private)
+- (void) _appendBody: (const uint8_t*)bytes length: (NSUInteger)length;
+- (void) _detach;
+- (void) _failed;
+- (void) _finishWith: (NSData*)data;
+- (id) _initWithConnection: (GSHTTPServerConnection*)c
+		    method: (NSString*)m
+		      path: (NSString*)p
+		   version: (NSString*)v
+		   headers: (GSMimeDocument*)h;
+- (BOOL) _keepAlive;
+@end
+
+static const char *
+statusReason(NSInteger status)
+{
+  switch (status)
+    {
+      case 100: return "Continue";
+      case 200: return "OK";
+      case 201: return "Created";
+      case 202: return "Accepted";
+      case 204: return "No Content";
+      case 206: return "Partial Content";
+      case 301: return "Moved Permanently";
+      case 302: return "Found";
+      case 303: return "See Other";
+      case 304: return "Not Modified";
+      case 307: return "Temporary Redirect";
+      case 308: return "Permanent Redirect";
+      case 400: return "Bad Request";
+      case 401: return "Unauthorized";
+      case 403: return "Forbidden";
+      case 404: return "Not Found";
+      case 405: return "Method Not Allowed";
+      case 408: return "Request Timeout";
+      case 411: return "Length Required";
+      case 413: return "Content Too Large";
+      case 414: return "URI Too Long";
+      case 415: return "Unsupported Media Type";
+      case 417: return "Expectation Failed";
+      case 431: return "Request Header Fields Too Large";
+      case 500: return "Internal Server Error";
+      case 501: return "Not Implemented";
+      case 503: return "Service Unavailable";
+      case 505: return "HTTP Version Not Supported";
+      default: return "Unknown";
+    }
+}
+
+/* Returns the length of the header block (request line and headers,
+ * including the empty line ending them) at the start of the buffer,
+ * or zero if the end of the headers has not been received yet.
+ * Lines may end in either CRLF or a bare LF.
+ */
+static NSUInteger
+headerEnd(const uint8_t *b, NSUInteger length)
+{
+  const uint8_t	*e = b + length;
+  const uint8_t	*p = b;
+
+  while ((p = memchr(p, '\n', e - p)) != 0)
+    {
+      p++;
+      if (p < e && *p == '\n')
+	{
+	  return p + 1 - b;
+	}
+      if (p + 1 < e && p[0] == '\r' && p[1] == '\n')
+	{
+	  return p + 2 - b;
+	}
+    }
+  return 0;
+}
+
+/* Returns YES if the comma separated list in a header value contains
+ * the token (case insensitive).
+ */
+static BOOL
+hasToken(GSMimeHeader *h, NSString *token)
+{
+  NSEnumerator	*e;
+  NSString	*s;
+
+  if (h == nil)
+    {
+      return NO;
+    }
+  e = [[[h value] componentsSeparatedByString: @","] objectEnumerator];
+  while ((s = [e nextObject]) != nil)
+    {
+      s = [s stringByTrimmingSpaces];
+      if ([s caseInsensitiveCompare: token] == NSOrderedSame)
+	{
+	  return YES;
+	}
+    }
+  return NO;
+}
+
+@implementation	GSHTTPServerConnection
+
+- (void) close
+{
+  NSRunLoop	*loop;
+
+  if (closed == YES)
+    {
+      return;
+    }
+  closed = YES;
+  AUTORELEASE(RETAIN(self));
+  loop = [NSRunLoop currentRunLoop];
+  [istream setDelegate: nil];
+  [ostream setDelegate: nil];
+  if (paused == NO)
+    {
+      [istream removeFromRunLoop: loop forMode: NSDefaultRunLoopMode];
+    }
+  [ostream removeFromRunLoop: loop forMode: NSDefaultRunLoopMode];
+  [istream close];
+  [ostream close];
+  [request _detach];
+  DESTROY(request);
+  [worker->server _countOpen: -1];
+  [worker->connections removeObject: self];
+}
+
+- (void) dealloc
+{
+  RELEASE(istream);
+  RELEASE(ostream);
+  RELEASE(inBuf);
+  RELEASE(outBuf);
+  RELEASE(request);
+  [super dealloc];
+}
+
+/* Passes part of a request body to the delegate or the request object.
+ */
+- (void) deliver: (const uint8_t*)bytes length: (NSUInteger)length
+{
+  if (request == nil)
+    {
+      return;	/* Response finished early ... discard the body.	*/
+    }
+  if (streamBody == YES)
+    {
+      GSHTTPServer	*s = worker->server;
+
+      [[s delegate] HTTPServer: s
+		       request: request
+		  receivedData: [NSData dataWithBytes: bytes length: length]];
+    }
+  else
+    {
+      [request _appendBody: bytes length: length];
+    }
+}
+
+/* Passes a complete request to the delegate.
+ */
+- (void) dispatch
+{
+  GSHTTPServer		*s = worker->server;
+  id			delegate = [s delegate];
+  GSHTTPServerRequest	*r = RETAIN(request);
+
+  state = ReadDone;
+  lastActivity = GSPrivateTimeNow();
+  if (r == nil)
+    {
+      return;
+    }
+  [s _countRequest];
+  NS_DURING
+    {
+      if ([delegate respondsToSelector: @selector(HTTPServer:handleRequest:)])
+	{
+	  [delegate HTTPServer: s handleRequest: r];
+	}
+      else
+	{
+	  [r respondWithStatus: 404 data: nil];
+	}
+    }
+  NS_HANDLER
+    {
+      NSLog(@"GSHTTPServer: exception handling %@ %@: %@",
+	[r method], [r path], localException);
+      [r _failed];
+    }
+  NS_ENDHANDLER
+  RELEASE(r);
+}
+
+/* Responds to a request we can't handle and closes the connection
+ * once the response has been sent.
+ */
+- (void) fail: (NSInteger)status
+{
+  char	buf[128];
+  int	len;
+
+  len = snprintf(buf, sizeof(buf),
+    "HTTP/1.1 %d %s\r\nDate: %s\r\nContent-Length: 0\r\n"
+    "Connection: close\r\n\r\n",
+    (int)status, statusReason(status), [worker date]);
+  [request _detach];
+  DESTROY(request);
+  state = ReadDone;
+  closeAfterWrite = YES;
+  [self sendBytes: buf length: len];
+}
+
+/* Reads pipelined requests while we are able to send their
+ * responses, and stops reading when too much data is waiting.
+ */
+- (void) flowControl
+{
+  BOOL	shouldPause;
+
+  shouldPause = ([outBuf length] - outPos > MAX_OUTPUT)
+    || (state == ReadDone && [inBuf length] - inPos > MAX_HEADER);
+  if (shouldPause == YES && paused == NO)
+    {
+      paused = YES;
+      [istream removeFromRunLoop: [NSRunLoop currentRunLoop]
+			 forMode: NSDefaultRunLoopMode];
+    }
+  else if (shouldPause == NO && paused == YES && closed == NO)
+    {
+      paused = NO;
+      [istream scheduleInRunLoop: [NSRunLoop currentRunLoop]
+			 forMode: NSDefaultRunLoopMode];
+      /* Data may have arrived while we were not listening for events.
+       */
+      [self readData];
+    }
+}
+
+- (id) initWithWorker: (GSHTTPServerWorker*)w
+		input: (NSInputStream*)i
+	       output: (NSOutputStream*)o
+{
+  if ((self = [super init]) != nil)
+    {
+      worker = w;
+      istream = RETAIN(i);
+      ostream = RETAIN(o);
+      inBuf = [[NSMutableData alloc] initWithCapacity: READ_SIZE];
+      outBuf = [[NSMutableData alloc] initWithCapacity: READ_SIZE];
+      state = ReadHeaders;
+      lastActivity = GSPrivateTimeNow();
+    }
+  return self;
+}
+
+- (void) open
+{
+  NSRunLoop	*loop = [NSRunLoop currentRunLoop];
+
+  [worker->server _countOpen: 1];
+  [istream setDelegate: self];
+  [ostream setDelegate: self];
+  [istream scheduleInRunLoop: loop forMode: NSDefaultRunLoopMode];
+  [ostream scheduleInRunLoop: loop forMode: NSDefaultRunLoopMode];
+  [istream open];
+  [ostream open];
+}
+
+/* Works through the data read so far.  Each complete request is
+ * passed to the delegate, and we go on to the next (pipelined)
+ * request only once the response to the current one is finished.
+ */
+- (void) process
+{
+  if (processing == YES)
+    {
+      return;	/* Called again as a request finished; carry on below.	*/
+    }
+  processing = YES;
+  while (closed == NO && state != ReadDone)
+    {
+      const uint8_t	*bytes = (const uint8_t*)[inBuf bytes] + inPos;
+      NSUInteger	avail = [inBuf length] - inPos;
+      NSUInteger	used;
+
+      if (state == ReadHeaders)
+	{
+	  /* Ignore empty lines before a request.
+	   */
+	  while (avail > 0 && (*bytes == '\r' || *bytes == '\n'))
+	    {
+	      bytes++;
+	      avail--;
+	      inPos++;
+	    }
+	  used = headerEnd(bytes, avail);
+	  if (used == 0 || used > MAX_HEADER)
+	    {
+	      if (used > MAX_HEADER || avail > MAX_HEADER)
+		{
+		  [self fail: 431];
+		}
+	      break;
+	    }
+	  inPos += used;
+	  [self startRequest: bytes length: used];
+	}
+      else if (state == ReadLength || state == ReadChunkData)
+	{
+	  if (avail == 0)
+	    {
+	      break;
+	    }
+	  used = (avail < remaining) ? avail : (NSUInteger)remaining;
+	  inPos += used;
+	  remaining -= used;
+	  [self deliver: bytes length: used];
+	  if (remaining == 0)
+	    {
+	      if (state == ReadLength)
+		{
+		  [self dispatch];
+		}
+	      else
+		{
+		  state = ReadChunkEnd;
+		}
+	    }
+	}
+      else if (state == ReadChunkEnd)
+	{
+	  if (avail > 0 && bytes[0] == '\n')
+	    {
+	      inPos += 1;
+	    }
+	  else if (avail > 1 && bytes[0] == '\r' && bytes[1] == '\n')
+	    {
+	      inPos += 2;
+	    }
+	  else
+	    {
+	      if (avail > 1 || (avail == 1 && bytes[0] != '\r'))
+		{
+		  [self fail: 400];
+		}
+	      break;
+	    }
+	  state = ReadChunkSize;
+	}
+      else
+	{
+	  const uint8_t	*eol = memchr(bytes, '\n', avail);
+	  NSUInteger	len;
+
+	  if (eol == 0)
+	    {
+	      if (avail > 1024)
+		{
+		  [self fail: 400];
+		}
+	      break;
+	    }
+	  used = eol + 1 - bytes;
+	  len = used - 1;
+	  if (len > 0 && bytes[len - 1] == '\r')
+	    {
+	      len--;
+	    }
+	  inPos += used;
+	  if (state == ReadTrailer)
+	    {
+	      if (len == 0)
+		{
+		  [self dispatch];
+		}
+	    }
+	  else
+	    {
+	      uint64_t		size = 0;
+	      NSUInteger	i;
+
+	      /* Chunk size in hex, possibly followed by extensions.
+	       */
+	      for (i = 0; i < len && isxdigit(bytes[i]) && i < 16; i++)
+		{
+		  uint8_t	c = bytes[i];
+
+		  size = size * 16
+		    + (isdigit(c) ? c - '0' : (c | 0x20) - 'a' + 10);
+		}
+	      if (i == 0 || (i < len && bytes[i] != ';'
+		&& bytes[i] != ' ' && bytes[i] != '\t'))
+		{
+		  [self fail: 400];
+		  break;
+		}
+	      if (size == 0)
+		{
+		  state = ReadTrailer;
+		}
+	      else if (bodyLimit > 0 && size > bodyLimit - bodySize)
+		{
+		  [self fail: 413];
+		  break;
+		}
+	      else
+		{
+		  bodySize += size;
+		  remaining = size;
+		  state = ReadChunkData;
+		}
+	    }
+	}
+    }
+  if (inPos == [inBuf length])
+    {
+      [inBuf setLength: 0];
+      inPos = 0;
+    }
+  else if (inPos > READ_SIZE)
+    {
+      [inBuf replaceBytesInRange: NSMakeRange(0, inPos)
+		       withBytes: 0
+			  length: 0];
+      inPos = 0;
+    }
+  if (readClosed == YES && state == ReadHeaders)
+    {
+      closeAfterWrite = YES;	/* No more requests will arrive.	*/
+    }
+  processing = NO;
+  [self writeData];
+  if (closed == NO)
+    {
+      [self flowControl];
+    }
+}
+
+- (void) readData
+{
+  uint8_t	buf[READ_SIZE];
+  NSInteger	length;
+
+  length = [istream read: buf maxLength: sizeof(buf)];
+  if (length > 0)
+    {
+      lastActivity = GSPrivateTimeNow();
+      [inBuf appendBytes: buf length: length];
+      [self process];
+    }
+  else if (length < 0 && [istream streamStatus] == NSStreamStatusError)
+    {
+      [self close];
+    }
+}
+
+- (void) requestFinished: (GSHTTPServerRequest*)r
+{
+  if (r != request || closed == YES)
+    {
+      return;
+    }
+  if ([r _keepAlive] == NO || state != ReadDone)
+    {
+      /* If the response was sent before the whole request was read,
+       * we can't tell where the next request would start.
+       */
+      closeAfterWrite = YES;
+    }
+  DESTROY(request);
+  lastActivity = GSPrivateTimeNow();
+  if (closeAfterWrite == NO)
+    {
+      state = ReadHeaders;
+      /* Handle any pipelined request already read (unless this was
+       * called during -process, which will continue by itself).
+       */
+      [self process];
+    }
+  else if (processing == NO)
+    {
+      [self writeData];
+    }
+}
+
+- (void) sendBytes: (const void*)bytes length: (NSUInteger)length
+{
+  [outBuf appendBytes: bytes length: length];
+  if (processing == NO)
+    {
+      [self writeData];
+    }
+}
+
+/* Parses the request line and headers, then sets up for reading
+ * the request body.
+ */
+- (void) startRequest: (const uint8_t*)bytes length: (NSUInteger)length
+{
+  const uint8_t		*eol = memchr(bytes, '\n', length);
+  const uint8_t		*sp1;
+  const uint8_t		*sp2;
+  NSUInteger		lineLength = eol - bytes;
+  NSString		*method;
+  NSString		*path;
+  NSString		*version;
+  GSMimeParser		*parser;
+  GSMimeDocument	*doc;
+  GSMimeHeader		*h;
+  NSData		*d;
+  BOOL			http11;
+
+  if (lineLength > 0 && bytes[lineLength - 1] == '\r')
+    {
+      lineLength--;
+    }
+  sp1 = memchr(bytes, ' ', lineLength);
+  sp2 = (sp1 == 0) ? 0 : memchr(sp1 + 1, ' ', bytes + lineLength - sp1 - 1);
+  if (sp1 == 0 || sp2 == 0 || sp1 == bytes || sp2 == sp1 + 1
+    || bytes + lineLength - sp2 < 9 || memcmp(sp2 + 1, "HTTP/", 5) != 0)
+    {
+      [self fail: 400];
+      return;
+    }
+  if (sp2[6] != '1' || sp2[7] != '.')
+    {
+      [self fail: 505];
+      return;
+    }
+  method = [[NSString alloc] initWithBytes: bytes
+				    length: sp1 - bytes
+				  encoding: NSASCIIStringEncoding];
+  path = [[NSString alloc] initWithBytes: sp1 + 1
+				  length: sp2 - sp1 - 1
+				encoding: NSISOLatin1StringEncoding];
+  version = [[NSString alloc] initWithBytes: sp2 + 1
+				     length: bytes + lineLength - sp2 - 1
+				   encoding: NSASCIIStringEncoding];
+  AUTORELEASE(method);
+  AUTORELEASE(path);
+  AUTORELEASE(version);
+  if (method == nil || path == nil || version == nil)
+    {
+      [self fail: 400];
+      return;
+    }
+  http11 = (sp2[8] != '0');
+
+  /* The headers are passed to the parser in one go, so it doesn't
+   * need to look for the end of them again.  If there were none we
+   * pass an empty buffer to mark the end.
+   */
+  parser = AUTORELEASE([GSMimeParser new]);
+  d = [NSData dataWithBytesNoCopy: (void*)(eol + 1)
+			   length: bytes + length - eol - 1
+		     freeWhenDone: NO];
+  if ([parser parseHeaders: d remaining: 0] == YES)
+    {
+      [parser parseHeaders: [NSData data] remaining: 0];
+    }
+  doc = [parser mimeDocument];
+
+  request = [[GSHTTPServerRequest alloc] _initWithConnection: self
+						      method: method
+							path: path
+						     version: version
+						     headers: doc];
+  streamBody = [[worker->server delegate] respondsToSelector:
+    @selector(HTTPServer:request:receivedData:)];
+  bodyLimit = (streamBody == YES) ? 0 : [worker->server maxBodySize];
+  bodySize = 0;
+
+  if ((h = [doc headerNamed: @"transfer-encoding"]) != nil)
+    {
+      NSString	*coding;
+
+      /* The body is only delimited by chunks if chunked is the last
+       * coding applied.
+       */
+      coding = [[[h value] componentsSeparatedByString: @","] lastObject];
+      coding = [coding stringByTrimmingSpaces];
+      if ([coding caseInsensitiveCompare: @"chunked"] != NSOrderedSame)
+	{
+	  [self fail: 400];
+	  return;
+	}
+      state = ReadChunkSize;
+    }
+  else if ((h = [doc headerNamed: @"content-length"]) != nil)
+    {
+      const char	*s = [[h value] UTF8String];
+      uint64_t		v = 0;
+
+      if (*s == '\0' || strlen(s) > 18 || strspn(s, "0123456789") != strlen(s))
+	{
+	  [self fail: 400];
+	  return;
+	}
+      while (*s != '\0')
+	{
+	  v = v * 10 + (*s++ - '0');
+	}
+      if (bodyLimit > 0 && v > bodyLimit)
+	{
+	  [self fail: 413];
+	  return;
+	}
+      remaining = v;
+      state = (v == 0) ? ReadDone : ReadLength;
+    }
+  else
+    {
+      state = ReadDone;
+    }
+
+  if (state != ReadDone && http11 == YES
+    && hasToken([doc headerNamed: @"expect"], @"100-continue"))
+    {
+      static const char	*cont = "HTTP/1.1 100 Continue\r\n\r\n";
+
+      [outBuf appendBytes: cont length: strlen(cont)];
+    }
+  if (state == ReadDone)
+    {
+      [self dispatch];
+    }
+}
+
+- (void) stream: (NSStream*)stream handleEvent: (NSStreamEvent)event
+{
+  if (closed == YES)
+    {
+      return;
+    }
+  switch (event)
+    {
+      case NSStreamEventHasBytesAvailable:
+	[self readData];
+	break;
+
+      case NSStreamEventHasSpaceAvailable:
+	[self writeData];
+	break;
+
+      case NSStreamEventEndEncountered:
+	if (stream == istream)
+	  {
+	    /* The client will send no more, but we finish the responses
+	     * to requests already received before closing.
+	     */
+	    readClosed = YES;
+	    if (state == ReadHeaders)
+	      {
+		closeAfterWrite = YES;
+		[self writeData];
+	      }
+	    else if (state != ReadDone)
+	      {
+		[self close];	/* Request body incomplete.	*/
+	      }
+	  }
+	else
+	  {
+	    [self close];
+	  }
+	break;
+
+      case NSStreamEventErrorOccurred:
+	[self close];
+	break;
+
+      default:
+	break;
+    }
+}
+
+- (void) writeData
+{
+  NSUInteger	length = [outBuf length];
+
+  while (outPos < length && closed == NO)
+    {
+      NSInteger	written;
+
+      written = [ostream write: (const uint8_t*)[outBuf bytes] + outPos
+		     maxLength: length - outPos];
+      if (written <= 0)
+	{
+	  if (written < 0 && [ostream streamStatus] == NSStreamStatusError)
+	    {
+	      [self close];
+	    }
+	  break;	/* Wait for space to become available.	*/
+	}
+      outPos += written;
+    }
+  if (closed == NO && outPos == length)
+    {
+      [outBuf setLength: 0];
+      outPos = 0;
+      if (closeAfterWrite == YES)
+	{
+	  [self close];
+	}
+      else if (paused == YES && processing == NO)
+	{
+	  [self flowControl];
+	}
+    }
+}
+
+@end
+
+
+@implementation	GSHTTPServerWorker
+
+- (void) adopt: (NSArray*)streams
+{
+  GSHTTPServerConnection	*c;
+
+  if (stopping == YES)
+    {
+      [[streams objectAtIndex: 0] close];
+      [[streams objectAtIndex: 1] close];
+      return;
+    }
+  c = [[GSHTTPServerConnection alloc] initWithWorker: self
+					       input: [streams objectAtIndex: 0]
+					      output: [streams objectAtIndex: 1]];
+  [connections addObject: c];
+  RELEASE(c);
+  [c open];
+}
+
+/* Schedules the listener (if any) and the idle connection timer
+ * in the run loop of the current thread.
+ */
+- (void) attach
+{
+  if (listener != nil)
+    {
+      [listener setDelegate: self];
+      [listener scheduleInRunLoop: [NSRunLoop currentRunLoop]
+			  forMode: NSDefaultRunLoopMode];
+    }
+  timer = [NSTimer scheduledTimerWithTimeInterval: 1.0
+					   target: self
+					 selector: @selector(sweep:)
+					 userInfo: nil
+					  repeats: YES];
+}
+
+/* Returns the current time in the format used for the Date header,
+ * recalculating it at most once a second.
+ */
+- (const char*) date
+{
+  static const char	*days[] = {
+    "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+  };
+  static const char	*months[] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+    "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+  };
+  time_t		now = time(0);
+
+  if (now != dateTime)
+    {
+      struct tm	t;
+
+#if	defined(_WIN32)
+      t = *gmtime(&now);
+#else
+      gmtime_r(&now, &t);
+#endif
+      snprintf(date, sizeof(date), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+	days[t.tm_wday], t.tm_mday, months[t.tm_mon], t.tm_year + 1900,
+	t.tm_hour, t.tm_min, t.tm_sec);
+      dateTime = now;
+    }
+  return date;
+}
+
+- (void) dealloc
+{
+  [listener close];
+  RELEASE(listener);
+  RELEASE(connections);
+  RELEASE(thread);
+  [super dealloc];
+}
+
+/* Stops listening and closes all connections.
+ */
+- (void) detach
+{
+  NSEnumerator			*e;
+  GSHTTPServerConnection	*c;
+
+  stopping = YES;
+  [timer invalidate];
+  timer = nil;
+  if (listener != nil)
+    {
+      [listener setDelegate: nil];
+      [listener removeFromRunLoop: [NSRunLoop currentRunLoop]
+			  forMode: NSDefaultRunLoopMode];
+      [listener close];
+      DESTROY(listener);
+    }
+  e = [[connections allObjects] objectEnumerator];
+  while ((c = [e nextObject]) != nil)
+    {
+      [c close];
+    }
+}
+
+- (id) initWithServer: (GSHTTPServer*)s
+{
+  if ((self = [super init]) != nil)
+    {
+      server = s;
+      connections = [NSMutableSet new];
+    }
+  return self;
+}
+
+- (void) run
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSRunLoop		*loop = [NSRunLoop currentRunLoop];
+
+  [self attach];
+  [server _workerStarted];
+  while (stopping == NO)
+    {
+      NSAutoreleasePool	*pool = [NSAutoreleasePool new];
+
+      [loop runMode: NSDefaultRunLoopMode
+	 beforeDate: [NSDate distantFuture]];
+      [pool release];
+    }
+  [arp release];
+}
+
+/* A connection on the listening socket.
+ */
+- (void) stream: (NSStream*)stream handleEvent: (NSStreamEvent)event
+{
+  if (event == NSStreamEventHasBytesAvailable)
+    {
+      NSInputStream	*i = nil;
+      NSOutputStream	*o = nil;
+
+      [listener acceptWithInputStream: &i outputStream: &o];
+      if (i != nil && o != nil)
+	{
+	  [server _accepted: [NSArray arrayWithObjects: i, o, nil] by: self];
+	}
+    }
+  else if (event == NSStreamEventErrorOccurred)
+    {
+      NSLog(@"GSHTTPServer: error on listening socket: %@",
+	[stream streamError]);
+    }
+}
+
+/* Closes connections which have had no request in progress for
+ * longer than the idle timeout.
+ */
+- (void) sweep: (NSTimer*)t
+{
+  NSTimeInterval	limit = [server idleTimeout];
+
+  if (limit > 0)
+    {
+      NSTimeInterval		now = GSPrivateTimeNow();
+      NSEnumerator		*e;
+      GSHTTPServerConnection	*c;
+
+      e = [[connections allObjects] objectEnumerator];
+      while ((c = [e nextObject]) != nil)
+	{
+	  if (c->request == nil && c->state != ReadDone
+	    && now - c->lastActivity > limit)
+	    {
+	      [c close];
+	    }
+	}
+    }
+}
+
+@end
+
+
+@implementation	GSHTTPServerRequest
+
+- (NSData*) body
+{
+  return _body;
+}
+
+- (void) dealloc
+{
+  RELEASE(_connection);
+  RELEASE(_thread);
+  RELEASE(_method);
+  RELEASE(_path);
+  RELEASE(_version);
+  RELEASE(_headers);
+  RELEASE(_body);
+  RELEASE(_response);
+  RELEASE(_reason);
+  [super dealloc];
+}
+
+- (NSString*) description
+{
+  return [NSString stringWithFormat: @"%@ %@ %@ %@",
+    [super description], _method, _path, _version];
+}
+
+- (void) finish
+{
+  [self _finishWith: nil];
+}
+
+- (GSMimeHeader*) headerNamed: (NSString*)name
+{
+  return [_headers headerNamed: name];
+}
+
+- (GSMimeDocument*) headers
+{
+  return _headers;
+}
+
+- (NSString*) HTTPVersion
+{
+  return _version;
+}
+
+- (NSString*) method
+{
+  return _method;
+}
+
+- (NSString*) path
+{
+  return _path;
+}
+
+- (NSString*) remoteAddress
+{
+  GSHTTPServerConnection	*c = _connection;
+
+  if (c == nil)
+    {
+      return nil;
+    }
+  return [c->istream propertyForKey: GSStreamRemoteAddressKey];
+}
+
+- (void) respondWithStatus: (NSInteger)status data: (NSData*)data
+{
+  [self setStatus: status reason: nil];
+  [self _finishWith: data];
+}
+
+- (void) sendBodyData: (NSData*)data
+{
+  GSHTTPServerConnection	*c;
+  NSUInteger			length;
+
+  if ([NSThread currentThread] != _thread)
+    {
+      [self performSelector: _cmd
+		   onThread: _thread
+		 withObject: data
+	      waitUntilDone: NO];
+      return;
+    }
+  c = _connection;
+  length = [data length];
+  if (c == nil || _state == RespDone || length == 0)
+    {
+      return;
+    }
+  if (_state == RespNone)
+    {
+      NSMutableData	*head = [self _head: -1];
+
+      [c sendBytes: [head bytes] length: [head length]];
+      _state = RespBody;
+    }
+  if (_noBody == NO)
+    {
+      if (_chunked == YES)
+	{
+	  char	buf[24];
+	  int	len = snprintf(buf, sizeof(buf), "%lx\r\n", (unsigned long)length);
+
+	  [c sendBytes: buf length: len];
+	  [c sendBytes: [data bytes] length: length];
+	  [c sendBytes: "\r\n" length: 2];
+	}
+      else
+	{
+	  [c sendBytes: [data bytes] length: length];
+	}
+    }
+}
+
+- (void) setStatus: (NSInteger)status reason: (NSString*)reason
+{
+  _status = status;
+  ASSIGNCOPY(_reason, reason);
+}
+
+- (void) setValue: (NSString*)value forHeader: (NSString*)name
+{
+  [_response addObject: name];
+  [_response addObject: value];
+}
+
+@end
+
+@implementation	GSHTTPServerRequest (Private)
+
+- (void) _appendBody: (const uint8_t*)bytes length: (NSUInteger)length
+{
+  if (_body == nil)
+    {
+      _body = [[NSMutableData alloc] initWithCapacity: length];
+    }
+  [_body appendBytes: bytes length: length];
+}
+
+/* The connection has closed, so nothing more can be sent.
+ */
+- (void) _detach
+{
+  _state = RespDone;
+  DESTROY(_connection);
+}
+
+/* The delegate raised an exception.
+ */
+- (void) _failed
+{
+  if (_state == RespNone)
+    {
+      [_response removeAllObjects];
+      [self respondWithStatus: 500 data: nil];
+    }
+  else if (_state == RespBody)
+    {
+      GSHTTPServerConnection	*c = RETAIN(_connection);
+
+      /* Part of the response has gone, so we can only drop the
+       * connection to let the client know it is incomplete.
+       */
+      [self _detach];
+      [c close];
+      RELEASE(c);
+    }
+}
+
+- (void) _finishWith: (NSData*)data
+{
+  GSHTTPServerConnection	*c;
+  NSUInteger			length;
+
+  if ([NSThread currentThread] != _thread)
+    {
+      [self performSelector: _cmd
+		   onThread: _thread
+		 withObject: data
+	      waitUntilDone: NO];
+      return;
+    }
+  c = AUTORELEASE(RETAIN(_connection));
+  if (c == nil || _state == RespDone)
+    {
+      return;
+    }
+  length = [data length];
+  if (_state == RespNone)
+    {
+      NSMutableData	*head = [self _head: length];
+
+      if (_noBody == NO && length > 0)
+	{
+	  [head appendData: data];
+	}
+      [c sendBytes: [head bytes] length: [head length]];
+    }
+  else
+    {
+      [self sendBodyData: data];
+      if (_chunked == YES && _noBody == NO)
+	{
+	  [c sendBytes: "0\r\n\r\n" length: 5];
+	}
+    }
+  _state = RespDone;
+  DESTROY(_connection);
+  [c requestFinished: self];
+}
+
+/* Builds the status line and headers of the response.  If length
+ * is negative, the body is to be sent in parts of unknown size.
+ */
+- (NSMutableData*) _head: (NSInteger)length
+{
+  NSMutableData	*d = [NSMutableData dataWithCapacity: 256];
+  NSUInteger	count = [_response count];
+  NSUInteger	i;
+  BOOL		haveLength = NO;
+  BOOL		haveConnection = NO;
+  char		buf[128];
+  int		len;
+
+  if (_status < 200 || _status == 204 || _status == 304)
+    {
+      _noBody = YES;
+    }
+  if (_reason == nil)
+    {
+      len = snprintf(buf, sizeof(buf), "HTTP/1.1 %d %s\r\n",
+	(int)_status, statusReason(_status));
+      [d appendBytes: buf length: len];
+    }
+  else
+    {
+      len = snprintf(buf, sizeof(buf), "HTTP/1.1 %d ", (int)_status);
+      [d appendBytes: buf length: len];
+      [d appendData: [_reason dataUsingEncoding: NSISOLatin1StringEncoding
+			   allowLossyConversion: YES]];
+      [d appendBytes: "\r\n" length: 2];
+    }
+
+  for (i = 0; i < count; i += 2)
+    {
+      NSString	*n = [_response objectAtIndex: i];
+      NSString	*v = [_response objectAtIndex: i + 1];
+
+      if ([n caseInsensitiveCompare: @"content-length"] == NSOrderedSame)
+	{
+	  haveLength = YES;
+	}
+      else if ([n caseInsensitiveCompare: @"connection"] == NSOrderedSame)
+	{
+	  haveConnection = YES;
+	  if ([v caseInsensitiveCompare: @"close"] == NSOrderedSame)
+	    {
+	      _keepAlive = NO;
+	    }
+	}
+      [d appendData: [n dataUsingEncoding: NSASCIIStringEncoding
+		     allowLossyConversion: YES]];
+      [d appendBytes: ": " length: 2];
+      [d appendData: [v dataUsingEncoding: NSISOLatin1StringEncoding
+		     allowLossyConversion: YES]];
+      [d appendBytes: "\r\n" length: 2];
+    }
+
+  if (haveLength == NO && (_status >= 200 && _status != 204))
+    {
+      if (length >= 0)
+	{
+	  if (_status != 304)
+	    {
+	      len = snprintf(buf, sizeof(buf), "Content-Length: %lu\r\n",
+		(unsigned long)length);
+	      [d appendBytes: buf length: len];
+	    }
+	}
+      else if ([_version isEqualToString: @"HTTP/1.0"] == NO)
+	{
+	  static const char	*te = "Transfer-Encoding: chunked\r\n";
+
+	  [d appendBytes: te length: strlen(te)];
+	  _chunked = YES;
+	}
+      else
+	{
+	  _keepAlive = NO;	/* End of body marked by closing.	*/
+	}
+    }
+
+  len = snprintf(buf, sizeof(buf), "Date: %s\r\n",
+    [((GSHTTPServerConnection*)_connection)->worker date]);
+  [d appendBytes: buf length: len];
+  if (haveConnection == NO)
+    {
+      if (_keepAlive == NO)
+	{
+	  static const char	*cl = "Connection: close\r\n";
+
+	  [d appendBytes: cl length: strlen(cl)];
+	}
+      else if ([_version isEqualToString: @"HTTP/1.0"] == YES)
+	{
+	  static const char	*ka = "Connection: keep-alive\r\n";
+
+	  [d appendBytes: ka length: strlen(ka)];
+	}
+    }
+  [d appendBytes: "\r\n" length: 2];
+  return d;
+}
+
+- (id) _initWithConnection: (GSHTTPServerConnection*)c
+		    method: (NSString*)m
+		      path: (NSString*)p
+		   version: (NSString*)v
+		   headers: (GSMimeDocument*)h
+{
+  if ((self = [super init]) != nil)
+    {
+      GSMimeHeader	*hdr = [h headerNamed: @"connection"];
+
+      _connection = RETAIN(c);
+      _thread = RETAIN([NSThread currentThread]);
+      _method = RETAIN(m);
+      _path = RETAIN(p);
+      _version = RETAIN(v);
+      _headers = RETAIN(h);
+      _response = [NSMutableArray new];
+      _status = 200;
+      if ([v isEqualToString: @"HTTP/1.0"] == YES)
+	{
+	  _keepAlive = hasToken(hdr, @"keep-alive");
+	}
+      else
+	{
+	  _keepAlive = (hasToken(hdr, @"close") == NO);
+	}
+      if ([m isEqualToString: @"HEAD"] == YES)
+	{
+	  _noBody = YES;
+	}
+    }
+  return self;
+}
+
+- (BOOL) _keepAlive
+{
+  return _keepAlive;
+}
+
+@end
+
+
+@implementation	GSHTTPServer
+
+- (void) dealloc
+{
+  [self stop];
+  RELEASE(_address);
+  [super dealloc];
+}
+
+- (id) delegate
+{
+  return _delegate;
+}
+
+- (NSTimeInterval) idleTimeout
+{
+  return _idleTimeout;
+}
+
+- (id) init
+{
+  return [self initWithAddress: nil port: 0];
+}
+
+- (id) initWithAddress: (NSString*)address port: (NSInteger)port
+{
+  if ((self = [super init]) != nil)
+    {
+      if ([address length] == 0)
+	{
+	  address = @"0.0.0.0";
+	}
+      _address = [address copy];
+      _port = port;
+      _idleTimeout = 30.0;
+      _maxBodySize = MAX_BODY;
+    }
+  return self;
+}
+
+- (NSUInteger) maxBodySize
+{
+  return _maxBodySize;
+}
+
+- (NSInteger) port
+{
+  return _port;
+}
+
+- (BOOL) reusePort
+{
+  return _reusePort;
+}
+
+- (void) setDelegate: (id)anObject
+{
+  _delegate = anObject;
+}
+
+- (void) setIdleTimeout: (NSTimeInterval)seconds
+{
+  _idleTimeout = seconds;
+}
+
+- (void) setMaxBodySize: (NSUInteger)size
+{
+  _maxBodySize = size;
+}
+
+- (void) setReusePort: (BOOL)flag
+{
+  _reusePort = flag;
+}
+
+- (void) setWorkers: (NSUInteger)count
+{
+  _workerCount = count;
+}
+
+- (BOOL) start
+{
+  NSUInteger	count = (_workerCount == 0) ? 1 : _workerCount;
+#ifdef	SO_REUSEPORT
+  BOOL		shard = (_reusePort == YES && count > 1);
+#else
+  BOOL		shard = NO;	/* Only one socket may listen on the port. */
+#endif
+  NSUInteger	i;
+
+  if (_running == YES)
+    {
+      return NO;
+    }
+  _workers = [[NSMutableArray alloc] initWithCapacity: count];
+  for (i = 0; i < count; i++)
+    {
+      GSHTTPServerWorker	*w;
+
+      w = [[GSHTTPServerWorker alloc] initWithServer: self];
+      [_workers addObject: w];
+      RELEASE(w);
+      if (i == 0 || shard == YES)
+	{
+	  if ((w->listener = RETAIN([self _listen])) == nil)
+	    {
+	      DESTROY(_workers);
+	      return NO;
+	    }
+	}
+    }
+
+  _running = YES;
+  _connections = 0;
+  _requests = 0;
+  if (_workerCount == 0)
+    {
+      GSHTTPServerWorker	*w = [_workers objectAtIndex: 0];
+
+      ASSIGN(w->thread, [NSThread currentThread]);
+      [w attach];
+    }
+  else
+    {
+      _started = [[NSConditionLock alloc] initWithCondition: 0];
+      for (i = 0; i < count; i++)
+	{
+	  GSHTTPServerWorker	*w = [_workers objectAtIndex: i];
+
+	  w->thread = [[NSThread alloc] initWithTarget: w
+					      selector: @selector(run)
+						object: nil];
+	  [w->thread start];
+	}
+      /* Wait until every worker is running its run loop, so that
+       * connections may be handed to it.
+       */
+      [_started lockWhenCondition: count];
+      [_started unlock];
+      DESTROY(_started);
+    }
+  return YES;
+}
+
+- (NSDictionary*) statistics
+{
+  return [NSDictionary dictionaryWithObjectsAndKeys:
+    [NSNumber numberWithUnsignedInteger: _connections], @"Connections",
+    [NSNumber numberWithUnsignedInteger: _requests], @"Requests",
+    [NSNumber numberWithUnsignedInteger: _open], @"Open",
+    nil];
+}
+
+- (void) stop
+{
+  NSThread	*current = [NSThread currentThread];
+  NSUInteger	count;
+  NSUInteger	i;
+
+  if (_running == NO)
+    {
+      return;
+    }
+  _running = NO;
+  count = [_workers count];
+  for (i = 0; i < count; i++)
+    {
+      GSHTTPServerWorker	*w = [_workers objectAtIndex: i];
+
+      if (w->thread == current)
+	{
+	  [w detach];
+	}
+      else
+	{
+	  [w performSelector: @selector(detach)
+		    onThread: w->thread
+		  withObject: nil
+	       waitUntilDone: YES];
+	}
+    }
+  DESTROY(_workers);
+}
+
+- (NSUInteger) workers
+{
+  return _workerCount;
+}
+
+@end
+
+@implementation	GSHTTPServer (Private)
+
+/* Hands a new connection to a worker; the one which accepted it if
+ * each worker has its own listener, otherwise each worker in turn.
+ */
+- (void) _accepted: (NSArray*)streams by: (GSHTTPServerWorker*)w
+{
+  NSUInteger	count = [_workers count];
+
+  __sync_fetch_and_add(&_connections, 1);
+  if (count > 1
+    && ((GSHTTPServerWorker*)[_workers objectAtIndex: 1])->listener == nil)
+    {
+      w = [_workers objectAtIndex: _next++ % count];
+    }
+  if (w->thread == [NSThread currentThread])
+    {
+      [w adopt: streams];
+    }
+  else
+    {
+      [w performSelector: @selector(adopt:)
+		onThread: w->thread
+	      withObject: streams
+	   waitUntilDone: NO];
+    }
+}
+
+- (void) _countOpen: (int)delta
+{
+  __sync_fetch_and_add(&_open, delta);
+}
+
+- (void) _countRequest
+{
+  __sync_fetch_and_add(&_requests, 1);
+}
+
+/* Returns a new listening socket, or nil on failure.  After the first
+ * is opened we know the port, in case the system was to choose it.
+ */
+- (GSServerStream*) _listen
+{
+  GSServerStream	*l;
+
+  l = [GSServerStream serverStreamToAddr: _address port: _port];
+  if (l == nil)
+    {
+      return nil;
+    }
+  if (_reusePort == YES)
+    {
+      [l setProperty: [NSNumber numberWithBool: YES]
+	      forKey: GSStreamReusePortKey];
+    }
+  [l open];
+  if ([l streamStatus] != NSStreamStatusOpen)
+    {
+      NSLog(@"GSHTTPServer: unable to listen on %@:%ld: %@",
+	_address, (long)_port, [l streamError]);
+      return nil;
+    }
+  if (_port == 0)
+    {
+      _port = [[l propertyForKey: GSStreamLocalPortKey] integerValue];
+    }
+  return l;
+}
+
+- (void) _workerStarted
+{
+  [_started lock];
+  [_started unlockWithCondition: [_started condition] + 1];
+}
+
+@end
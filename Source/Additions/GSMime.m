@@ -121,6 +121,147 @@ static	Class		documentClass = 0;
 
 typedef BOOL (*boolIMP)(id, SEL, id);
 
+/*
+ * Well known header names, interned so that parsing does not need to
+ * create a string for them and so that the lowercase form of a name
+ * can be found without creating a new string.  The special flag marks
+ * the headers which -parseHeader: or -scanHeaderBody:into: treat
+ * specially, and which are therefore never parsed by the fast path.
+ */
+typedef struct {
+  const char	*text;		/* As usually written.	*/
+  unsigned	length;
+  BOOL		special;
+  char		lowerText[32];
+  NSString	*name;		/* Interned, as usually written.	*/
+  NSString	*lower;		/* Interned, lowercase.	*/
+} HeaderName;
+
+#define	HN(X, S)	{ X, sizeof(X) - 1, S }
+static HeaderName	headerNames[] = {
+  HN("Accept", NO),
+  HN("Accept-Charset", NO),
+  HN("Accept-Encoding", NO),
+  HN("Accept-Language", NO),
+  HN("Accept-Ranges", NO),
+  HN("Age", NO),
+  HN("Authorization", NO),
+  HN("Cache-Control", NO),
+  HN("Connection", NO),
+  HN("Content-Disposition", YES),
+  HN("Content-Encoding", NO),
+  HN("Content-ID", NO),
+  HN("Content-Language", NO),
+  HN("Content-Length", NO),
+  HN("Content-Location", NO),
+  HN("Content-Transfer-Encoding", YES),
+  HN("Content-Type", YES),
+  HN("Cookie", NO),
+  HN("Date", NO),
+  HN("ETag", NO),
+  HN("Expect", NO),
+  HN("Expires", NO),
+  HN("From", NO),
+  HN("Host", NO),
+  HN("HTTP", YES),
+  HN("If-Modified-Since", NO),
+  HN("If-None-Match", NO),
+  HN("Keep-Alive", NO),
+  HN("Last-Modified", NO),
+  HN("Location", NO),
+  HN("Message-ID", NO),
+  HN("MIME-Version", YES),
+  HN("Pragma", NO),
+  HN("Range", NO),
+  HN("Referer", NO),
+  HN("Server", NO),
+  HN("Set-Cookie", NO),
+  HN("Subject", NO),
+  HN("To", NO),
+  HN("Transfer-Encoding", YES),
+  HN("Upgrade", NO),
+  HN("User-Agent", NO),
+  HN("Vary", NO),
+  HN("Via", NO),
+  HN("WWW-Authenticate", NO),
+};
+#undef	HN
+#define	HEADER_NAMES	(sizeof(headerNames) / sizeof(*headerNames))
+
+/* Maps each interned name (in either form) to its lowercase form.
+ */
+static NSMapTable	*headerNameMap = 0;
+
+static void
+setupHeaderNames(void)
+{
+  if (headerNameMap == 0)
+    {
+      NSMapTable	*m;
+      unsigned		i;
+
+      m = NSCreateMapTable(NSObjectMapKeyCallBacks,
+	NSObjectMapValueCallBacks, HEADER_NAMES * 2);
+      for (i = 0; i < HEADER_NAMES; i++)
+	{
+	  HeaderName	*h = &headerNames[i];
+	  unsigned	j;
+
+	  for (j = 0; j < h->length; j++)
+	    {
+	      h->lowerText[j] = tolower(h->text[j]);
+	    }
+	  h->name = [[NSString alloc] initWithBytes: h->text
+					     length: h->length
+					   encoding: NSASCIIStringEncoding];
+	  h->lower = [[NSString alloc] initWithBytes: h->lowerText
+					      length: h->length
+					    encoding: NSASCIIStringEncoding];
+	  NSMapInsert(m, h->name, h->lower);
+	  NSMapInsert(m, h->lower, h->lower);
+	}
+      headerNameMap = m;
+    }
+}
+
+/* Returns the interned entry for the header name in bytes (ignoring case)
+ * or 0 if it is not a well known name.
+ */
+static HeaderName *
+findHeaderName(const unsigned char *bytes, unsigned length)
+{
+  unsigned	i;
+
+  for (i = 0; i < HEADER_NAMES; i++)
+    {
+      if (headerNames[i].length == length
+	&& strncasecmp((const char*)bytes, headerNames[i].text, length) == 0)
+	{
+	  return &headerNames[i];
+	}
+    }
+  return 0;
+}
+
+/* Returns the lowercase token for a header name, avoiding the work of
+ * +[GSMimeHeader makeToken:preservingCase:] for well known names.
+ */
+static inline NSString *
+lowerHeaderName(NSString *name)
+{
+  NSString	*lower = nil;
+
+  if (name != nil && headerNameMap != 0)
+    {
+      lower = NSMapGet(headerNameMap, name);
+    }
+  if (lower == nil)
+    {
+      lower = [GSMimeHeader makeToken: name preservingCase: NO];
+    }
+  return lower;
+}
+
 @interface GSMimeDocument (Private)
 - (GSMimeHeader*) _lastHeaderNamed: (NSString*)name;
 - (NSUInteger) _indexOfHeaderNamed: (NSString*)name;
@@ -138,45 +279,6 @@ decodebase64(unsigned char *dst, const unsigned char *src)
   dst[2] = ((src[2] & 0x03) << 6) |  (src[3] & 0x3F);
 }
 
-static char b64[]
-  = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-
-static int
-encodebase64(unsigned char *dst, const unsigned char *src, int length)
-{
-  int	dIndex = 0;
-  int	sIndex;
-
-  for (sIndex = 0; sIndex < length; sIndex += 3)
-    {
-      int	c0 = src[sIndex];
-      int	c1 = (sIndex+1 < length) ? src[sIndex+1] : 0;
-      int	c2 = (sIndex+2 < length) ? src[sIndex+2] : 0;
-
-      dst[dIndex++] = b64[(c0 >> 2) & 077];
-      dst[dIndex++] = b64[((c0 << 4) & 060) | ((c1 >> 4) & 017)];
-      dst[dIndex++] = b64[((c1 << 2) & 074) | ((c2 >> 6) & 03)];
-      dst[dIndex++] = b64[c2 & 077];
-    }
-
-   /* If len was not a multiple of 3, then we have encoded too
-    * many characters.  Adjust appropriately.
-    */
-   if (sIndex == length + 1)
-     {
-       /* There were only 2 bytes in that last group */
-       dst[dIndex - 1] = '=';
-     }
-   else if (sIndex == length + 2)
-     {
-       /* There was only 1 byte in that last group */
-       dst[dIndex - 1] = '=';
-       dst[dIndex - 2] = '=';
-     }
-  return dIndex;
-}
-
-
 static void
 encodeQuotedPrintable(NSMutableData *result,
   const unsigned char *src, unsigned length)
@@ -612,12 +714,25 @@ wordData(NSString *word)
 
   /*
    * Now decode data into buffer, keeping count and temporary
-   * data in context.
+   * data in context.  Whenever we are at the start of a group of
+   * four characters, runs of clean base64 are decoded in bulk.
    */
   while (src < end)
     {
-      int	cc = *src++;
+      int	cc;
+
+      if (pos == 0)
+	{
+	  NSUInteger	used = GSPrivateBase64DecodeRun(dst, src, end - src);
 
+	  src += used;
+	  dst += used / 4 * 3;
+	  if (src == end)
+	    {
+	      break;
+	    }
+	}
+      cc = *src++;
       if (isupper(cc))
 	{
 	  cc -= 'A';
@@ -850,6 +965,7 @@ wordData(NSString *word)
 - (void) _child;
 - (BOOL) _decodeBody: (NSData*)d;
 - (NSString*) _decodeHeader;
+- (BOOL) _decodeSimpleHeader;
 - (NSRange) _endOfHeaders: (NSData*)newData;
 - (BOOL) _scanHeaderParameters: (NSScanner*)scanner into: (GSMimeHeader*)info;
 @end
@@ -878,6 +994,12 @@ wordData(NSString *word)
  *   are designed to cope with the most common faults.
  * </p>
  */
+/* The standard header parsing methods.  If a subclass overrides either
+ * of them, headers are always parsed by way of them.
+ */
+static IMP	parseHeaderImp = 0;
+static IMP	scanHeaderBodyImp = 0;
+
 @implementation	GSMimeParser
 
 /**
@@ -916,6 +1038,14 @@ wordData(NSString *word)
     {
       documentClass = [GSMimeDocument class];
     }
+  if (self == [GSMimeParser class])
+    {
+      [GSMimeHeader class];	/* Sets up the well known header names. */
+      parseHeaderImp = [self instanceMethodForSelector:
+	@selector(parseHeader:)];
+      scanHeaderBodyImp = [self instanceMethodForSelector:
+	@selector(scanHeaderBody:into:)];
+    }
 }
 
 /**
@@ -1510,6 +1640,7 @@ wordData(NSString *word)
   GSMimeHeader	*hdr;
   NSRange	r;
   NSUInteger	l = [d length];
+  BOOL		simple;
 
   if (flags.complete == 1 || flags.inBody == 1)
     {
@@ -1568,10 +1699,18 @@ wordData(NSString *word)
 	}
     }
 
+  simple = ([self methodForSelector: @selector(parseHeader:)]
+    == parseHeaderImp
+    && [self methodForSelector: @selector(scanHeaderBody:into:)]
+    == scanHeaderBodyImp) ? YES : NO;
   while (flags.inBody == 0)
     {
       NSString		*header;
 
+      if (YES == simple && YES == [self _decodeSimpleHeader])
+	{
+	  continue;
+	}
       header = [self _decodeHeader];
       if (header == nil)
 	{
@@ -2873,6 +3012,148 @@ unfold(const unsigned char *src, const unsigned char *end, BOOL *folded)
   return src;	// Pointer to first non-space data
 }
 
+/* Characters permitted in a header name (as in the tokenSet used by
+ * GSMimeHeader).
+ */
+static inline BOOL
+isTokenChar(unsigned char c)
+{
+  if (c <= 32 || c >= 127)
+    {
+      return NO;
+    }
+  switch (c)
+    {
+      case '(': case ')': case '<': case '>': case '@':
+      case ',': case ';': case ':': case '\\': case '"':
+      case '/': case '[': case ']': case '?': case '=':
+	return NO;
+      default:
+	return YES;
+    }
+}
+
+/*
+ * This method parses the next header line straight from the buffered
+ * bytes if it is a simple one ... a name which is a token, a colon, and
+ * a value of printable ASCII with no encoded words, not folded onto the
+ * following line.  The header is created with an interned name if it is
+ * a well known one, so the only string needed is the value.
+ * Returns NO, having done nothing, for anything else (including the
+ * headers which need special treatment), leaving the line to
+ * -_decodeHeader and -parseHeader:.
+ */
+- (BOOL) _decodeSimpleHeader
+{
+  const unsigned char	*beg = &bytes[input];
+  const unsigned char	*end = &bytes[dataEnd];
+  const unsigned char	*src = beg;
+  const unsigned char	*val;
+  const unsigned char	*eol;
+  unsigned		length;
+  HeaderName		*known;
+  NSString		*name = nil;
+  NSString		*value;
+  GSMimeHeader		*info;
+
+  while (src < end && isTokenChar(*src))
+    {
+      src++;
+    }
+  if (src == beg || src >= end || *src != ':')
+    {
+      return NO;
+    }
+  length = src - beg;
+  if (length == 7 && strncasecmp((const char*)beg, "unknown", 7) == 0)
+    {
+      return NO;	// Let -parseHeader: reject it.
+    }
+  src++;
+  while (src < end && (*src == ' ' || *src == '\t'))
+    {
+      src++;
+    }
+  val = src;
+  while (src < end && ((*src >= ' ' && *src < 127) || *src == '\t'))
+    {
+      if (*src == '=' && src + 1 < end && src[1] == '?')
+	{
+	  return NO;	// Encoded word
+	}
+      src++;
+    }
+  if (src >= end)
+    {
+      return NO;
+    }
+  eol = src;
+  if (*src == '\r')
+    {
+      src++;
+      if (src >= end || *src != '\n')
+	{
+	  return NO;
+	}
+    }
+  else if (*src != '\n')
+    {
+      return NO;	// Not printable ASCII
+    }
+  src++;
+  if (src >= end
+    || (*src != '\r' && *src != '\n' && isspace(*src)))
+    {
+      return NO;	// Folded (or we can't tell yet)
+    }
+
+  known = findHeaderName(beg, length);
+  if (known != 0)
+    {
+      if (YES == known->special)
+	{
+	  return NO;
+	}
+      if (memcmp(beg, known->text, length) == 0)
+	{
+	  name = RETAIN(known->name);
+	}
+      else if (memcmp(beg, known->lowerText, length) == 0)
+	{
+	  name = RETAIN(known->lower);
+	}
+    }
+  if (name == nil)
+    {
+      name = [NSStringClass allocWithZone: NSDefaultMallocZone()];
+      name = [name initWithBytes: beg
+			  length: length
+			encoding: NSASCIIStringEncoding];
+    }
+  if (eol == val)
+    {
+      value = @"";
+    }
+  else
+    {
+      value = [NSStringClass allocWithZone: NSDefaultMallocZone()];
+      value = [value initWithBytes: val
+			    length: eol - val
+			  encoding: NSASCIIStringEncoding];
+    }
+
+  /* The name is already a valid token, so we set the instance variables
+   * directly rather than having -setName: check it again.
+   */
+  info = [GSMimeHeader alloc];
+  info->name = name;
+  info->value = value;
+  input = src - bytes;
+  [document addHeader: info];
+  RELEASE(info);
+  return YES;
+}
+
 /*
  * This method takes the raw data of an unfolded header line, and handles
  * RFC2047 word encoding in the header by creating a
@@ -3271,6 +3552,7 @@ static NSCharacterSet	*tokenSet = nil;
       tokenSet = [ms copy];
       RELEASE(ms);
       nonToken = RETAIN([tokenSet invertedSet]);
+      setupHeaderNames();
       if (NSArrayClass == 0)
 	{
 	  NSArrayClass = [NSArray class];
@@ -3541,7 +3823,13 @@ static NSCharacterSet	*tokenSet = nil;
     }
   else
     {
-      return [name lowercaseString];
+      NSString	*lower = NSMapGet(headerNameMap, name);
+
+      if (lower == nil)
+	{
+	  lower = [name lowercaseString];
+	}
+      return lower;
     }
 }
 
@@ -4210,8 +4498,20 @@ appendString(NSMutableData *m, NSUInteger offset, NSUInteger fold,
 
   while ((src != end) && *src != '\0')
     {
-      int	c = *src++;
+      int	c;
+
+      if (pos == 0)
+	{
+	  NSUInteger	used = GSPrivateBase64DecodeRun(dst, src, end - src);
 
+	  src += used;
+	  dst += used / 4 * 3;
+	  if (src == end)
+	    {
+	      break;
+	    }
+	}
+      c = *src++;
       if (isupper(c))
 	{
 	  c -= 'A';
@@ -4349,7 +4649,7 @@ appendString(NSMutableData *m, NSUInteger offset, NSUInteger fold,
   dBuf = NSZoneMalloc(NSDefaultMallocZone(), destlen);
 #endif
 
-  destlen = encodebase64(dBuf, sBuf, length);
+  destlen = GSPrivateBase64Encode(dBuf, sBuf, length);
 
   return AUTORELEASE([[NSData allocWithZone: NSDefaultMallocZone()]
     initWithBytesNoCopy: dBuf length: destlen]);
@@ -5463,7 +5763,7 @@ appendString(NSMutableData *m, NSUInteger offset, NSUInteger fold,
       IMP		imp1;
       boolIMP		imp2;
 
-      name = [GSMimeHeader makeToken: name preservingCase: NO];
+      name = lowerHeaderName(name);
       imp1 = [headers methodForSelector: @selector(objectAtIndex:)];
       imp2 = (boolIMP)[name methodForSelector: @selector(isEqualToString:)];
       for (index = 0; index < count; index++)
@@ -5488,7 +5788,7 @@ appendString(NSMutableData *m, NSUInteger offset, NSUInteger fold,
 {
   NSUInteger	count;
 
-  name = [GSMimeHeader makeToken: name preservingCase: NO];
+  name = lowerHeaderName(name);
   count = [headers count];
   if (count > 0)
     {
@@ -5584,7 +5884,7 @@ appendString(NSMutableData *m, NSUInteger offset, NSUInteger fold,
 
   md = [NSMutableData allocWithZone: NSDefaultMallocZone()];
   md = [md initWithLength: 40];
-  length = encodebase64([md mutableBytes], output, 20);
+  length = GSPrivateBase64Encode([md mutableBytes], output, 20);
   [md setLength: length + 2];
   ptr = (unsigned char*)[md mutableBytes];
   ptr[length] = '=';
@@ -0,0 +1,583 @@
+/* Direct conversions between ISO-8859-1, ASCII, UTF-8 and UTF-16
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNUstep Base Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02111 USA.
+*/
+
+#import "common.h"
+#import "../GSPrivate.h"
+
+#include <string.h>
+
+/* Most text is largely ASCII, so each conversion here handles runs of
+ * ASCII characters a vector at a time and only deals with the other
+ * characters one by one.  As in GSCodec.m the x86 vector code is
+ * compiled using function target attributes and chosen the first time
+ * a function is called.  NEON is part of the base aarch64 architecture,
+ * so that is used unconditionally when available.
+ */
+#if	(defined(__x86_64__) || defined(__i386__)) \
+  && ((defined(__clang__) && __clang_major__ >= 4) \
+  || (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 5))
+#define	GS_TRANSCODE_X86	1
+#include <immintrin.h>
+#define	SSE2	__attribute__((target("sse2")))
+#define	AVX2	__attribute__((target("avx2")))
+#elif	defined(__aarch64__) && defined(__ARM_NEON)
+#define	GS_TRANSCODE_NEON	1
+#include <arm_neon.h>
+#endif
+
+static NSUInteger	(*asciiPrefix)(const uint8_t*, NSUInteger) = 0;
+static NSUInteger	(*asciiCopy)(uint8_t*, const uint8_t*, NSUInteger) = 0;
+static NSUInteger	(*asciiWiden)(unichar*, const uint8_t*, NSUInteger) = 0;
+
+
+/* The scalar implementations, used for the ends of buffers and when no
+ * vector implementation is available.  Each returns the length of the
+ * leading ASCII run of src, and the copying ones copy that run to dst.
+ */
+
+#define	HIGH_BITS	0x8080808080808080ULL
+
+static NSUInteger
+asciiPrefixScalar(const uint8_t *src, NSUInteger length)
+{
+  NSUInteger	i = 0;
+
+  while (i + 8 <= length)
+    {
+      uint64_t	w;
+
+      memcpy(&w, src + i, 8);
+      if (w & HIGH_BITS)
+	{
+	  break;
+	}
+      i += 8;
+    }
+  while (i < length && src[i] < 0x80)
+    {
+      i++;
+    }
+  return i;
+}
+
+static NSUInteger
+asciiCopyScalar(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  NSUInteger	n = asciiPrefixScalar(src, length);
+
+  memcpy(dst, src, n);
+  return n;
+}
+
+static NSUInteger
+asciiWidenScalar(unichar *dst, const uint8_t *src, NSUInteger length)
+{
+  NSUInteger	i = 0;
+
+  while (i < length && src[i] < 0x80)
+    {
+      dst[i] = src[i];
+      i++;
+    }
+  return i;
+}
+
+/* The vector versions store a whole vector before looking to see how
+ * much of it was ASCII.  That is safe because every caller has at least
+ * as much space left in dst as there are characters left in src.
+ */
+
+#if	defined(GS_TRANSCODE_X86)
+
+static SSE2 NSUInteger
+asciiPrefixSSE2(const uint8_t *src, NSUInteger length)
+{
+  NSUInteger	i = 0;
+
+  while (i + 16 <= length)
+    {
+      int	m = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(src + i)));
+
+      if (m != 0)
+	{
+	  return i + __builtin_ctz(m);
+	}
+      i += 16;
+    }
+  return i + asciiPrefixScalar(src + i, length - i);
+}
+
+static SSE2 NSUInteger
+asciiCopySSE2(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  NSUInteger	i = 0;
+
+  while (i + 16 <= length)
+    {
+      __m128i	v = _mm_loadu_si128((const __m128i*)(src + i));
+      int	m = _mm_movemask_epi8(v);
+
+      _mm_storeu_si128((__m128i*)(dst + i), v);
+      if (m != 0)
+	{
+	  return i + __builtin_ctz(m);
+	}
+      i += 16;
+    }
+  return i + asciiCopyScalar(dst + i, src + i, length - i);
+}
+
+static SSE2 NSUInteger
+asciiWidenSSE2(unichar *dst, const uint8_t *src, NSUInteger length)
+{
+  const __m128i	zero = _mm_setzero_si128();
+  NSUInteger	i = 0;
+
+  while (i + 16 <= length)
+    {
+      __m128i	v = _mm_loadu_si128((const __m128i*)(src + i));
+      int	m = _mm_movemask_epi8(v);
+
+      _mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi8(v, zero));
+      _mm_storeu_si128((__m128i*)(dst + i + 8), _mm_unpackhi_epi8(v, zero));
+      if (m != 0)
+	{
+	  return i + __builtin_ctz(m);
+	}
+      i += 16;
+    }
+  return i + asciiWidenScalar(dst + i, src + i, length - i);
+}
+
+static AVX2 NSUInteger
+asciiPrefixAVX2(const uint8_t *src, NSUInteger length)
+{
+  NSUInteger	i = 0;
+
+  /* Check two vectors per step and only work out where the first
+   * non-ASCII byte is once we know there is one.
+   */
+  while (i + 64 <= length)
+    {
+      __m256i	a = _mm256_loadu_si256((const __m256i*)(src + i));
+      __m256i	b = _mm256_loadu_si256((const __m256i*)(src + i + 32));
+
+      if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) != 0)
+	{
+	  break;
+	}
+      i += 64;
+    }
+  while (i + 32 <= length)
+    {
+      uint32_t	m = (uint32_t)_mm256_movemask_epi8(
+	_mm256_loadu_si256((const __m256i*)(src + i)));
+
+      if (m != 0)
+	{
+	  return i + __builtin_ctz(m);
+	}
+      i += 32;
+    }
+  return i + asciiPrefixSSE2(src + i, length - i);
+}
+
+static AVX2 NSUInteger
+asciiCopyAVX2(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  NSUInteger	i = 0;
+
+  while (i + 32 <= length)
+    {
+      __m256i	v = _mm256_loadu_si256((const __m256i*)(src + i));
+      uint32_t	m = (uint32_t)_mm256_movemask_epi8(v);
+
+      _mm256_storeu_si256((__m256i*)(dst + i), v);
+      if (m != 0)
+	{
+	  return i + __builtin_ctz(m);
+	}
+      i += 32;
+    }
+  return i + asciiCopySSE2(dst + i, src + i, length - i);
+}
+
+static AVX2 NSUInteger
+asciiWidenAVX2(unichar *dst, const uint8_t *src, NSUInteger length)
+{
+  NSUInteger	i = 0;
+
+  while (i + 32 <= length)
+    {
+      __m256i	v = _mm256_loadu_si256((const __m256i*)(src + i));
+      uint32_t	m = (uint32_t)_mm256_movemask_epi8(v);
+
+      _mm256_storeu_si256((__m256i*)(dst + i),
+	_mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+      _mm256_storeu_si256((__m256i*)(dst + i + 16),
+	_mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+      if (m != 0)
+	{
+	  return i + __builtin_ctz(m);
+	}
+      i += 32;
+    }
+  return i + asciiWidenSSE2(dst + i, src + i, length - i);
+}
+
+#endif	/* GS_TRANSCODE_X86 */
+
+#if	defined(GS_TRANSCODE_NEON)
+
+/* NEON has no equivalent of movemask, so when a vector holds a
+ * non-ASCII byte the scalar code finds out where it is.
+ */
+
+static NSUInteger
+asciiPrefixNEON(const uint8_t *src, NSUInteger length)
+{
+  NSUInteger	i = 0;
+
+  while (i + 16 <= length)
+    {
+      if (vmaxvq_u8(vld1q_u8(src + i)) >= 0x80)
+	{
+	  break;
+	}
+      i += 16;
+    }
+  return i + asciiPrefixScalar(src + i, length - i);
+}
+
+static NSUInteger
+asciiCopyNEON(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  NSUInteger	i = 0;
+
+  while (i + 16 <= length)
+    {
+      uint8x16_t	v = vld1q_u8(src + i);
+
+      if (vmaxvq_u8(v) >= 0x80)
+	{
+	  break;
+	}
+      vst1q_u8(dst + i, v);
+      i += 16;
+    }
+  return i + asciiCopyScalar(dst + i, src + i, length - i);
+}
+
+static NSUInteger
+asciiWidenNEON(unichar *dst, const uint8_t *src, NSUInteger length)
+{
+  NSUInteger	i = 0;
+
+  while (i + 16 <= length)
+    {
+      uint8x16_t	v = vld1q_u8(src + i);
+
+      if (vmaxvq_u8(v) >= 0x80)
+	{
+	  break;
+	}
+      vst1q_u16((uint16_t*)(dst + i), vmovl_u8(vget_low_u8(v)));
+      vst1q_u16((uint16_t*)(dst + i + 8), vmovl_high_u8(v));
+      i += 16;
+    }
+  return i + asciiWidenScalar(dst + i, src + i, length - i);
+}
+
+#endif	/* GS_TRANSCODE_NEON */
+
+static void
+setup(void)
+{
+  asciiPrefix = asciiPrefixScalar;
+  asciiCopy = asciiCopyScalar;
+  asciiWiden = asciiWidenScalar;
+#if	defined(GS_TRANSCODE_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2"))
+    {
+      asciiPrefix = asciiPrefixSSE2;
+      asciiCopy = asciiCopySSE2;
+      asciiWiden = asciiWidenSSE2;
+    }
+  if (__builtin_cpu_supports("avx2"))
+    {
+      asciiPrefix = asciiPrefixAVX2;
+      asciiCopy = asciiCopyAVX2;
+      asciiWiden = asciiWidenAVX2;
+    }
+#elif	defined(GS_TRANSCODE_NEON)
+  asciiPrefix = asciiPrefixNEON;
+  asciiCopy = asciiCopyNEON;
+  asciiWiden = asciiWidenNEON;
+#endif
+}
+
+NSUInteger
+GSPrivateASCIIPrefix(const uint8_t *src, NSUInteger length)
+{
+  if (0 == asciiPrefix)
+    {
+      setup();
+    }
+  return (*asciiPrefix)(src, length);
+}
+
+NSUInteger
+GSPrivateLatin1UTF8Length(const uint8_t *src, NSUInteger length)
+{
+  NSUInteger	count = length;
+  NSUInteger	i = 0;
+
+  /* Each byte with the top bit set needs one more byte in UTF-8.
+   */
+  while (i + 8 <= length)
+    {
+      uint64_t	w;
+
+      memcpy(&w, src + i, 8);
+      count += __builtin_popcountll(w & HIGH_BITS);
+      i += 8;
+    }
+  while (i < length)
+    {
+      count += src[i++] >> 7;
+    }
+  return count;
+}
+
+NSUInteger
+GSPrivateLatin1ToUTF8(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  const uint8_t	*end = src + length;
+  uint8_t	*start = dst;
+
+  if (0 == asciiCopy)
+    {
+      setup();
+    }
+  while (src < end)
+    {
+      uint8_t	c = *src;
+
+      if (c < 0x80)
+	{
+	  NSUInteger	n = (*asciiCopy)(dst, src, end - src);
+
+	  src += n;
+	  dst += n;
+	}
+      else
+	{
+	  dst[0] = 0xc0 | (c >> 6);
+	  dst[1] = 0x80 | (c & 0x3f);
+	  src++;
+	  dst += 2;
+	}
+    }
+  return dst - start;
+}
+
+NSUInteger
+GSPrivateUTF8ToLatin1(uint8_t *dst, const uint8_t *src, NSUInteger length)
+{
+  const uint8_t	*end = src + length;
+  uint8_t	*start = dst;
+
+  if (0 == asciiCopy)
+    {
+      setup();
+    }
+  while (src < end)
+    {
+      uint8_t	c = *src;
+
+      if (c < 0x80)
+	{
+	  NSUInteger	n = (*asciiCopy)(dst, src, end - src);
+
+	  src += n;
+	  dst += n;
+	}
+      else if ((c == 0xc2 || c == 0xc3) && src + 1 < end
+	&& (src[1] & 0xc0) == 0x80)
+	{
+	  *dst++ = ((c & 0x03) << 6) | (src[1] & 0x3f);
+	  src += 2;
+	}
+      else
+	{
+	  return NSNotFound;
+	}
+    }
+  return dst - start;
+}
+
+/* Decodes the well formed UTF-8 sequence for a non-ASCII character at
+ * src, returning its length in bytes, or zero if it is not well formed
+ * or is one of the non-characters GSToUnicode() rejects.
+ */
+static inline NSUInteger
+decodeSequence(const uint8_t *src, const uint8_t *end, uint32_t *u)
+{
+  uint32_t	c = *src;
+  uint32_t	v;
+
+  if (c < 0xc2)
+    {
+      return 0;		// Continuation byte or overlong form.
+    }
+  else if (c < 0xe0)
+    {
+      if (end - src < 2 || (src[1] & 0xc0) != 0x80)
+	{
+	  return 0;
+	}
+      *u = ((c & 0x1f) << 6) | (src[1] & 0x3f);
+      return 2;
+    }
+  else if (c < 0xf0)
+    {
+      if (end - src < 3 || (src[1] & 0xc0) != 0x80
+	|| (src[2] & 0xc0) != 0x80)
+	{
+	  return 0;
+	}
+      v = ((c & 0x0f) << 12) | ((src[1] & 0x3f) << 6) | (src[2] & 0x3f);
+      if (v < 0x800 || (v >= 0xd800 && v <= 0xdfff)
+	|| (v >= 0xfdd0 && v <= 0xfdef) || v >= 0xfffe)
+	{
+	  return 0;
+	}
+      *u = v;
+      return 3;
+    }
+  else if (c < 0xf5)
+    {
+      if (end - src < 4 || (src[1] & 0xc0) != 0x80
+	|| (src[2] & 0xc0) != 0x80 || (src[3] & 0xc0) != 0x80)
+	{
+	  return 0;
+	}
+      v = ((c & 0x07) << 18) | ((src[1] & 0x3f) << 12)
+	| ((src[2] & 0x3f) << 6) | (src[3] & 0x3f);
+      if (v < 0x10000 || v > 0x10ffff)
+	{
+	  return 0;
+	}
+      *u = v;
+      return 4;
+    }
+  return 0;
+}
+
+NSUInteger
+GSPrivateUTF8Length(const uint8_t *src, NSUInteger length, BOOL *latin1)
+{
+  const uint8_t	*end = src + length;
+  NSUInteger	count = 0;
+  uint32_t	max = 0;
+
+  if (0 == asciiPrefix)
+    {
+      setup();
+    }
+  while (src < end)
+    {
+      if (*src < 0x80)
+	{
+	  NSUInteger	n = (*asciiPrefix)(src, end - src);
+
+	  src += n;
+	  count += n;
+	}
+      else
+	{
+	  uint32_t	u;
+	  NSUInteger	n = decodeSequence(src, end, &u);
+
+	  if (0 == n)
+	    {
+	      return NSNotFound;
+	    }
+	  src += n;
+	  count += (u > 0xffff) ? 2 : 1;
+	  if (u > max)
+	    {
+	      max = u;
+	    }
+	}
+    }
+  if (0 != latin1)
+    {
+      *latin1 = (max <= 0xff) ? YES : NO;
+    }
+  return count;
+}
+
+NSUInteger
+GSPrivateUTF8ToUnicode(unichar *dst, const uint8_t *src, NSUInteger length)
+{
+  const uint8_t	*end = src + length;
+  unichar	*start = dst;
+
+  if (0 == asciiWiden)
+    {
+      setup();
+    }
+  while (src < end)
+    {
+      if (*src < 0x80)
+	{
+	  NSUInteger	n = (*asciiWiden)(dst, src, end - src);
+
+	  src += n;
+	  dst += n;
+	}
+      else
+	{
+	  uint32_t	u;
+	  NSUInteger	n = decodeSequence(src, end, &u);
+
+	  if (0 == n)
+	    {
+	      return NSNotFound;
+	    }
+	  src += n;
+	  if (u > 0xffff)
+	    {
+	      u -= 0x10000;
+	      dst[0] = 0xd800 + (u >> 10);
+	      dst[1] = 0xdc00 + (u & 0x3ff);
+	      dst += 2;
+	    }
+	  else
+	    {
+	      *dst++ = u;
+	    }
+	}
+    }
+  return dst - start;
+}
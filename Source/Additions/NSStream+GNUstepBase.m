@@ -37,6 +37,8 @@ NSString * const GSStreamRemoteAddressKey
   = @"GSStreamRemoteAddressKey";
 NSString * const GSStreamRemotePortKey
   = @"GSStreamRemotePortKey";
+NSString * const GSStreamReusePortKey
+  = @"GSStreamReusePortKey";
 
 
 /* The remaining code is specific to the Apple Foundation
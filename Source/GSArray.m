@@ -437,6 +437,102 @@ static Class	GSInlineArrayClass;
 
 @implementation GSMutableArray
 
+/* A mutable array's buffer may have unused slots before the first
+ * object (_offset of them), so that objects can be removed from or
+ * inserted at the start by moving _contents_array rather than every
+ * object in the array.  This makes the array an efficient queue while
+ * keeping the objects contiguous, as the sorting code, the methods
+ * shared with GSArray and fast enumeration expect.  _capacity is the
+ * number of slots from _contents_array to the end of the buffer.
+ */
+
+/* Moves the objects to the start of the buffer.
+ */
+static void
+slideToStart(GSMutableArray *a)
+{
+  if (a->_offset > 0)
+    {
+      id	*base = a->_contents_array - a->_offset;
+
+      memmove(base, a->_contents_array, a->_count * sizeof(id));
+      a->_contents_array = base;
+      a->_capacity += a->_offset;
+      a->_offset = 0;
+    }
+}
+
+/* Makes room for at least one more object at the end of the array.
+ * If at least half the buffer is free space at the start, the objects
+ * are moved down rather than the buffer being enlarged, so an array
+ * used as a queue stays no bigger than twice its maximum length and
+ * the cost of moving is spread over the removals which made the space.
+ */
+static void
+makeRoomAtEnd(GSMutableArray *a)
+{
+  if (a->_offset > 0 && a->_offset >= a->_count)
+    {
+      slideToStart(a);
+    }
+  else
+    {
+      id	*ptr;
+      size_t	size;
+
+      size = (a->_offset + a->_capacity + a->_grow_factor) * sizeof(id);
+      ptr = NSZoneRealloc([a zone], a->_contents_array - a->_offset, size);
+      if (ptr == 0)
+	{
+	  [NSException raise: NSMallocException
+		      format: @"Unable to grow array"];
+	}
+      a->_contents_array = ptr + a->_offset;
+      a->_capacity += a->_grow_factor;
+      a->_grow_factor = a->_capacity/2;
+    }
+}
+
+/* Makes room for at least one more object at the start of the array,
+ * using free space at the end of the buffer if at least half of it is
+ * unused, or growing the buffer otherwise.  Either way the free space
+ * at the start is proportional to the number of objects, so repeated
+ * insertion at the start takes amortised constant time.
+ */
+static void
+makeRoomAtStart(GSMutableArray *a)
+{
+  NSUInteger	spare = a->_capacity - a->_count;
+  NSUInteger	shift;
+
+  if (spare > a->_count)
+    {
+      shift = (spare + 1) / 2;
+    }
+  else
+    {
+      id	*ptr;
+      size_t	size;
+
+      shift = a->_grow_factor;
+      size = (a->_offset + a->_capacity + shift) * sizeof(id);
+      ptr = NSZoneRealloc([a zone], a->_contents_array - a->_offset, size);
+      if (ptr == 0)
+	{
+	  [NSException raise: NSMallocException
+		      format: @"Unable to grow array"];
+	}
+      a->_contents_array = ptr + a->_offset;
+      a->_capacity += shift;
+      a->_grow_factor = (a->_offset + a->_capacity)/2;
+    }
+  memmove(a->_contents_array + shift, a->_contents_array,
+    a->_count * sizeof(id));
+  a->_contents_array += shift;
+  a->_offset += shift;
+  a->_capacity -= shift;
+}
+
 + (void) initialize
 {
   if (self == [GSMutableArray class])
@@ -456,18 +552,7 @@ static Class	GSInlineArrayClass;
     }
   if (_count >= _capacity)
     {
-      id	*ptr;
-      size_t	size = (_capacity + _grow_factor)*sizeof(id);
-
-      ptr = NSZoneRealloc([self zone], _contents_array, size);
-      if (ptr == 0)
-	{
-	  [NSException raise: NSMallocException
-		      format: @"Unable to grow array"];
-	}
-      _contents_array = ptr;
-      _capacity += _grow_factor;
-      _grow_factor = _capacity/2;
+      makeRoomAtEnd(self);
     }
   _contents_array[_count] = RETAIN(anObject);
   _count++;	/* Do this AFTER we have retained the object.	*/
@@ -489,6 +574,24 @@ static Class	GSInlineArrayClass;
   return [copy initWithObjects: _contents_array count: _count];
 }
 
+- (void) dealloc
+{
+  if (_contents_array)
+    {
+#if	!GS_WITH_GC
+      NSUInteger	i;
+
+      for (i = 0; i < _count; i++)
+	{
+	  [_contents_array[i] release];
+	}
+#endif
+      NSZoneFree([self zone], _contents_array - _offset);
+      _contents_array = 0;
+    }
+  [super dealloc];
+}
+
 - (void) exchangeObjectAtIndex: (NSUInteger)i1
              withObjectAtIndex: (NSUInteger)i2
 {
@@ -603,23 +706,28 @@ static Class	GSInlineArrayClass;
     {
       [self _raiseRangeExceptionWithIndex: index from: _cmd];
     }
-  if (_count == _capacity)
+  if (index < _count - index)
     {
-      id	*ptr;
-      size_t	size = (_capacity + _grow_factor)*sizeof(id);
-
-      ptr = NSZoneRealloc([self zone], _contents_array, size);
-      if (ptr == 0)
+      /* Nearer the start, so move the preceding objects down.
+       */
+      if (_offset == 0)
 	{
-	  [NSException raise: NSMallocException
-		      format: @"Unable to grow"];
+	  makeRoomAtStart(self);
 	}
-      _contents_array = ptr;
-      _capacity += _grow_factor;
-      _grow_factor = _capacity/2;
+      _contents_array--;
+      _offset--;
+      _capacity++;
+      memmove(&_contents_array[0], &_contents_array[1], index * sizeof(id));
+    }
+  else
+    {
+      if (_count == _capacity)
+	{
+	  makeRoomAtEnd(self);
+	}
+      memmove(&_contents_array[index+1], &_contents_array[index],
+	(_count - index) * sizeof(id));
     }
-  memmove(&_contents_array[index+1], &_contents_array[index],
-    (_count - index) * sizeof(id));
   /*
    *	Make sure the array is 'sane' so that it can be deallocated
    *	safely by an autorelease pool if the '[anObject retain]' causes
@@ -633,6 +741,7 @@ static Class	GSInlineArrayClass;
 
 - (id) makeImmutableCopyOnFail: (BOOL)force
 {
+  slideToStart(self);	// GSArray frees _contents_array itself
   GSClassSwizzle(self, [GSArray class]);
   return self;
 }
@@ -648,6 +757,10 @@ static Class	GSInlineArrayClass;
   _count--;
   RELEASE(_contents_array[_count]);
   _contents_array[_count] = 0;
+  if (_count == 0)
+    {
+      slideToStart(self);
+    }
   _version++;
 }
 
@@ -715,12 +828,26 @@ static Class	GSInlineArrayClass;
     }
   obj = _contents_array[index];
   _count--;
-  while (index < _count)
+  if (index < _count - index)
     {
-      _contents_array[index] = _contents_array[index+1];
-      index++;
+      /* Nearer the start, so move the preceding objects up.
+       */
+      memmove(&_contents_array[1], &_contents_array[0], index * sizeof(id));
+      _contents_array[0] = 0;
+      _contents_array++;
+      _offset++;
+      _capacity--;
+    }
+  else
+    {
+      memmove(&_contents_array[index], &_contents_array[index+1],
+	(_count - index) * sizeof(id));
+      _contents_array[_count] = 0;
+    }
+  if (_count == 0)
+    {
+      slideToStart(self);
     }
-  _contents_array[_count] = 0;
   [obj release];	/* Adjust array BEFORE releasing object.	*/
   _version++;
 }
@@ -202,6 +202,9 @@ static IMP gs_objc_msg_forward2 (id receiver, SEL sel)
 	}
     }
       
+  /* The closure is cached and shared by all messages forwarded with
+   * the same type signature, so this is cheap after the first time.
+   */
   memory = cifframe_closure(sig, GSFFIInvocationCallback);
 
   return (IMP)[memory executable];
@@ -335,8 +338,8 @@ static id gs_objc_proxy_lookup(id receiver, SEL op)
 }
 
 /* Initializer used when we get a callback. uses the data provided by
-   the callback. The cifframe was allocated by the forwarding function,
-   but we own it now so we can free it */
+   the callback. The cifframe is the template shared by all closures
+   for the signature, so we work with a private copy of it */
 - (id) initWithCallback: (ffi_cif *)cif
 		 values: (void **)vals
 		  frame: (void *)frame
@@ -348,11 +351,10 @@ static id gs_objc_proxy_lookup(id receiver, SEL op)
   _sig = RETAIN(aSignature);
   _numArgs = [aSignature numberOfArguments];
   _info = [aSignature methodInfo];
-  _frame = (NSMutableData*)frame;
+  _frame = cifframe_copy((NSMutableData*)frame);
   [_frame retain];
   _cframe = [_frame mutableBytes];
   f = (cifframe_t *)_cframe;
-  f->cif = *cif;
 
   /* Copy the arguments into our frame so that they are preserved
    * in the NSInvocation if the stack is changed before the
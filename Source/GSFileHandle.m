@@ -65,6 +65,10 @@
 #endif
 
 #include <sys/ioctl.h>
+#include <sys/uio.h>
+#if	defined(__linux__)
+#include <sys/sendfile.h>
+#endif
 #ifdef	__svr4__
 #  ifdef HAVE_SYS_FILIO_H
 #    include <sys/filio.h>
@@ -99,6 +103,14 @@
 #define	NETBUF_SIZE	4096
 #define	READ_SIZE	NETBUF_SIZE*10
 
+/* Maximum number of queued background writes sent in one writev().
+ */
+#define	WRITEV_MAX	16
+#if	defined(IOV_MAX) && IOV_MAX < WRITEV_MAX
+#undef	WRITEV_MAX
+#define	WRITEV_MAX	IOV_MAX
+#endif
+
 static GSFileHandle*	fh_stdin = nil;
 static GSFileHandle*	fh_stdout = nil;
 static GSFileHandle*	fh_stderr = nil;
@@ -109,10 +121,35 @@ static NSString*	NotificationKey = @"NSFileHandleNotificationKey";
 @interface GSFileHandle(private)
 - (void) receivedEventRead;
 - (void) receivedEventWrite;
+- (void) receivedEventWritev;
 @end
 
 @implementation GSFileHandle
 
+/* Return YES if the -write:length: method of the handle is our own
+ * plain implementation (no subclass override for TLS etc, and no
+ * compression), so that data may be written directly to the descriptor
+ * by other system calls such as writev() or sendfile().
+ */
+static BOOL
+canWriteDirectly(GSFileHandle *h)
+{
+  static IMP	plainWrite = 0;
+  SEL		sel = @selector(write:length:);
+
+#if	USE_ZLIB
+  if (h->gzDescriptor != 0)
+    {
+      return NO;
+    }
+#endif
+  if (plainWrite == 0)
+    {
+      plainWrite = [GSFileHandle instanceMethodForSelector: sel];
+    }
+  return ([h methodForSelector: sel] == plainWrite) ? YES : NO;
+}
+
 /**
  * Encapsulates low level read operation to get data from the operating
  * system.
@@ -1290,9 +1327,29 @@ NSString * const GSSOCKSRecvAddr = @"GSSOCKSRecvAddr";
       [self setNonBlocking: NO];
     }
   d = [NSMutableData dataWithCapacity: 0];
-  while ((len = [self read: buf length: sizeof(buf)]) > 0)
+  for (;;)
     {
-      [d appendBytes: buf length: len];
+      void	*space = GSPrivateDataSpace(d, sizeof(buf));
+
+      /* Read straight into the data object if possible, to avoid
+       * copying through our buffer.
+       */
+      if (space != 0)
+	{
+	  if ((len = [self read: space length: sizeof(buf)]) <= 0)
+	    {
+	      break;
+	    }
+	  GSPrivateDataExtend(d, len);
+	}
+      else
+	{
+	  if ((len = [self read: buf length: sizeof(buf)]) <= 0)
+	    {
+	      break;
+	    }
+	  [d appendBytes: buf length: len];
+	}
     }
   if (len < 0)
     {
@@ -1319,14 +1376,27 @@ NSString * const GSSOCKSRecvAddr = @"GSSOCKSRecvAddr";
   do
     {
       int	chunk = len > sizeof(buf) ? sizeof(buf) : len;
+      void	*space = GSPrivateDataSpace(d, chunk);
 
-      got = [self read: buf length: chunk];
-      if (got > 0)
+      if (space != 0)
 	{
-	  [d appendBytes: buf length: got];
-	  len -= got;
+	  got = [self read: space length: chunk];
+	  if (got > 0)
+	    {
+	      GSPrivateDataExtend(d, got);
+	      len -= got;
+	    }
 	}
-      else if (got < 0)
+      else
+	{
+	  got = [self read: buf length: chunk];
+	  if (got > 0)
+	    {
+	      [d appendBytes: buf length: got];
+	      len -= got;
+	    }
+	}
+      if (got < 0)
 	{
 	  [NSException raise: NSFileHandleOperationException
 		      format: @"unable to read from descriptor - %@",
@@ -1381,6 +1451,71 @@ NSString * const GSSOCKSRecvAddr = @"GSSOCKSRecvAddr";
 }
 
 
+- (unsigned long long) writeFromFileHandle: (NSFileHandle*)source
+				    offset: (unsigned long long)offset
+				    length: (unsigned long long)length
+{
+#if	defined(__linux__)
+  if (canWriteDirectly(self) == YES
+    && [source isKindOfClass: [GSFileHandle class]] == YES
+    && ((GSFileHandle*)source)->isStandardFile == YES
+#if	USE_ZLIB
+    && ((GSFileHandle*)source)->gzDescriptor == 0
+#endif
+    )
+    {
+      int			src = ((GSFileHandle*)source)->descriptor;
+      off_t			pos = (off_t)offset;
+      unsigned long long	done = 0;
+
+      [self checkWrite];
+      if (isNonBlocking == YES)
+	{
+	  [self setNonBlocking: NO];
+	}
+      while (done < length)
+	{
+	  unsigned long long	chunk = length - done;
+	  ssize_t		rval;
+
+	  if (chunk > 0x40000000)
+	    {
+	      chunk = 0x40000000;
+	    }
+	  rval = sendfile(descriptor, src, &pos, (size_t)chunk);
+	  if (rval < 0)
+	    {
+	      if (errno == EINTR || errno == EAGAIN)
+		{
+		  continue;
+		}
+	      if (done == 0 && (errno == EINVAL || errno == ENOSYS))
+		{
+		  /* The kernel can't do this for these descriptors,
+		   * so fall back to copying the data.
+		   */
+		  break;
+		}
+	      [NSException raise: NSFileHandleOperationException
+			  format: @"unable to send file data - %@",
+			  [NSError _last]];
+	    }
+	  if (rval == 0)
+	    {
+	      return done;	// End of file.
+	    }
+	  done += rval;
+	}
+      if (done > 0 || length == 0)
+	{
+	  return done;
+	}
+    }
+#endif
+  return [super writeFromFileHandle: source offset: offset length: length];
+}
+
+
 // Asynchronous I/O operations
 
 - (void) acceptConnectionInBackgroundAndNotifyForModes: (NSArray*)modes
@@ -1904,6 +2039,7 @@ NSString * const GSSOCKSRecvAddr = @"GSSOCKSRecvAddr";
       int		length;
       int		received = 0;
       char		buf[READ_SIZE];
+      void		*space;
 
       item = [readInfo objectForKey: NSFileHandleNotificationDataItem];
       /*
@@ -1922,7 +2058,11 @@ NSString * const GSSOCKSRecvAddr = @"GSSOCKSRecvAddr";
 	  length = sizeof(buf);
 	}
 
-      received = [self read: buf length: length];
+      /* Read directly into the spare capacity of the data item if we
+       * can, so the data is not copied through an intermediate buffer.
+       */
+      space = GSPrivateDataSpace(item, length);
+      received = [self read: (space ? space : buf) length: length];
       if (received == 0)
         { // Read up to end of file.
           [self postReadNotification];
@@ -1941,10 +2081,23 @@ NSString * const GSSOCKSRecvAddr = @"GSSOCKSRecvAddr";
 	}
       else
 	{
-	  [item appendBytes: buf length: received];
+	  if (space != 0)
+	    {
+	      GSPrivateDataExtend(item, received);
+	    }
+	  else
+	    {
+	      [item appendBytes: buf length: received];
+	    }
 	  if (readMax < 0 || (readMax > 0 && (int)[item length] == readMax))
 	    {
 	      // Read a single chunk of data
+	      if (readMax < 0 && [item capacity] - [item length] > NETBUF_SIZE)
+		{
+		  /* Don't hand out a small chunk in a big buffer.
+		   */
+		  [item setCapacity: [item length]];
+		}
 	      [self postReadNotification];
 	    }
 	}
@@ -1990,6 +2143,11 @@ NSString * const GSSOCKSRecvAddr = @"GSSOCKSRecvAddr";
       connectOK = NO;
       [self postWriteNotification];
     }
+  else if (operation == GSFileHandleWriteCompletionNotification
+    && [writeInfo count] > 1 && canWriteDirectly(self) == YES)
+    {
+      [self receivedEventWritev];
+    }
   else
     {
       NSData	*item;
@@ -2029,6 +2187,68 @@ NSString * const GSSOCKSRecvAddr = @"GSSOCKSRecvAddr";
     }
 }
 
+/* Send as many of the queued background writes as possible with a
+ * single writev(), posting a completion notification for each one
+ * which has been written in full.
+ */
+- (void) receivedEventWritev
+{
+  struct iovec	iov[WRITEV_MAX];
+  NSUInteger	count = [writeInfo count];
+  NSUInteger	i;
+  int		n = 0;
+  ssize_t	written;
+
+  for (i = 0; i < count && n < WRITEV_MAX; i++)
+    {
+      NSDictionary	*info = [writeInfo objectAtIndex: i];
+      NSData		*item;
+      NSUInteger	offset = (i == 0) ? writePos : 0;
+
+      if ([info objectForKey: NotificationKey]
+	!= GSFileHandleWriteCompletionNotification)
+	{
+	  break;	// Only gather plain data writes.
+	}
+      item = [info objectForKey: NSFileHandleNotificationDataItem];
+      iov[n].iov_base = (char*)[item bytes] + offset;
+      iov[n].iov_len = [item length] - offset;
+      n++;
+    }
+
+  do
+    {
+      written = writev(descriptor, iov, n);
+    }
+  while (written < 0 && EINTR == errno);
+
+  if (written < 0)
+    {
+      if (errno != EAGAIN)
+	{
+	  NSMutableDictionary	*info = [writeInfo objectAtIndex: 0];
+	  NSString		*s;
+
+	  s = [NSString stringWithFormat:
+	    @"Write attempt failed - %@", [NSError _last]];
+	  [info setObject: s forKey: GSFileHandleNotificationError];
+	  [self postWriteNotification];
+	}
+      return;
+    }
+
+  for (i = 0; i < (NSUInteger)n; i++)
+    {
+      if ((size_t)written < iov[i].iov_len)
+	{
+	  writePos += written;	// Partial write of current item.
+	  break;
+	}
+      written -= iov[i].iov_len;
+      [self postWriteNotification];	// Removes item, resets writePos.
+    }
+}
+
 - (void) receivedEvent: (void*)data
                   type: (RunLoopEventType)type
 		 extra: (void*)extra
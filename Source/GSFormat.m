@@ -79,6 +79,7 @@
 #import "GNUstepBase/GSLocale.h"
 
 #import "GSPrivate.h"
+#import "GSPThread.h"
 
 #include <string.h>		// for strstr()
 #include <sys/stat.h>
@@ -746,6 +747,175 @@ parse_one_spec (const unichar *format, size_t posn, struct printf_spec *spec,
   return nargs;
 }
 
+/* Fill in the types of all the arguments consumed by the NSPECS
+   format specifiers in SPECS.  ARGS_TYPE must have been zeroed.  */
+static inline void
+fill_arg_types (const struct printf_spec *specs, size_t nspecs,
+		int *args_type)
+{
+  size_t cnt;
+
+  for (cnt = 0; cnt < nspecs; ++cnt)
+    {
+      /* If the width is determined by an argument this is an int.  */
+      if (specs[cnt].width_arg != -1)
+	args_type[specs[cnt].width_arg] = PA_INT;
+
+      /* If the precision is determined by an argument this is an int.  */
+      if (specs[cnt].prec_arg != -1)
+	args_type[specs[cnt].prec_arg] = PA_INT;
+
+      switch (specs[cnt].ndata_args)
+	{
+	case 0:		/* No arguments.  */
+	  break;
+	case 1:		/* One argument; we already have the type.  */
+	  args_type[specs[cnt].data_arg] = specs[cnt].data_arg_type;
+	  break;
+	default:
+	  /* ??? */
+	  break;
+	}
+    }
+}
+
+
+/* A format string parsed once and kept for reuse.
+ * Format strings which are compile-time constants (NXConstantString
+ * instances) exist for the lifetime of the process, so we can cache
+ * their parsed specifiers keyed on the address of the string object.
+ * Cached entries are never modified or removed once they have been
+ * added to the cache, so they can be used without locking.
+ */
+typedef struct {
+  unichar		*format;	/* Nul terminated format.	*/
+  const unichar		*lead_str_end;	/* End of leading literal text.	*/
+  size_t		nspecs;		/* Number of format specifiers.	*/
+  size_t		nargs;		/* Number of arguments used.	*/
+  struct printf_spec	*specs;
+  int			*args_type;
+} GSCompiledFormat;
+
+/* Limits to stop the cache growing without bound if a program contains
+ * a huge number of constant format strings.
+ */
+#define	FORMAT_CACHE_MAX_ENTRIES	4096
+#define	FORMAT_CACHE_MAX_LENGTH		1024
+
+static NSMapTable	*formatCache = 0;
+static pthread_mutex_t	formatCacheLock = PTHREAD_MUTEX_INITIALIZER;
+static Class		constantStringClass = Nil;
+
+static GSCompiledFormat *
+compile_format (NSString *fmt, size_t len)
+{
+  NSZone		*z = NSDefaultMallocZone();
+  GSCompiledFormat	*c;
+  const unichar		*f;
+  size_t		nspecs_max = 8;
+  size_t		max_ref_arg = 0;
+
+  c = NSZoneCalloc(z, 1, sizeof(GSCompiledFormat));
+  c->format = NSZoneMalloc(z, (len + 1) * sizeof(unichar));
+  [fmt getCharacters: c->format range: ((NSRange){0, len})];
+  c->format[len] = '\0';
+  c->lead_str_end = find_spec (c->format);
+  c->specs = NSZoneMalloc(z, nspecs_max * sizeof(struct printf_spec));
+
+  for (f = c->lead_str_end; *f != '\0'; f = c->specs[c->nspecs++].next_fmt)
+    {
+      if (c->nspecs >= nspecs_max)
+	{
+	  nspecs_max *= 2;
+	  c->specs = NSZoneRealloc(z, c->specs,
+	    nspecs_max * sizeof(struct printf_spec));
+	}
+      c->nargs += parse_one_spec (f, c->nargs, &c->specs[c->nspecs],
+	&max_ref_arg);
+    }
+  c->nargs = MAX (c->nargs, max_ref_arg);
+
+  /* Allocate at least one element so that a format with no arguments
+     still has a valid (if unused) array.  */
+  c->args_type = NSZoneCalloc(z, c->nargs + 1, sizeof(int));
+  fill_arg_types (c->specs, c->nspecs, c->args_type);
+  return c;
+}
+
+static void
+free_compiled_format (GSCompiledFormat *c)
+{
+  NSZone	*z = NSDefaultMallocZone();
+
+  NSZoneFree(z, c->args_type);
+  NSZoneFree(z, c->specs);
+  NSZoneFree(z, c->format);
+  NSZoneFree(z, c);
+}
+
+/* Return the cached parse of FMT, creating it if necessary, or NULL if
+   FMT is not a constant string or can't be cached.  */
+static GSCompiledFormat *
+cached_format (NSString *fmt)
+{
+  GSCompiledFormat	*c;
+  size_t		len;
+
+  if (constantStringClass == Nil)
+    {
+      constantStringClass = [NXConstantString class];
+    }
+  if (object_getClass(fmt) != constantStringClass)
+    {
+      return NULL;
+    }
+
+  pthread_mutex_lock(&formatCacheLock);
+  if (formatCache == 0)
+    {
+      formatCache = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
+	NSNonOwnedPointerMapValueCallBacks, 0);
+    }
+  c = (GSCompiledFormat*)NSMapGet(formatCache, (void*)fmt);
+  if (c == NULL && NSCountMapTable(formatCache) >= FORMAT_CACHE_MAX_ENTRIES)
+    {
+      pthread_mutex_unlock(&formatCacheLock);
+      return NULL;
+    }
+  pthread_mutex_unlock(&formatCacheLock);
+  if (c != NULL)
+    {
+      return c;
+    }
+
+  /* Parse outside the lock ... if another thread parsed the same format
+     in the meantime we discard our copy and use the one in the cache.  */
+  len = [fmt length];
+  if (len > FORMAT_CACHE_MAX_LENGTH)
+    {
+      return NULL;
+    }
+  c = compile_format (fmt, len);
+
+  pthread_mutex_lock(&formatCacheLock);
+  {
+    GSCompiledFormat	*old;
+
+    old = (GSCompiledFormat*)NSMapGet(formatCache, (void*)fmt);
+    if (old == NULL)
+      {
+	NSMapInsertKnownAbsent(formatCache, (void*)fmt, (void*)c);
+      }
+    else
+      {
+	free_compiled_format (c);
+	c = old;
+      }
+  }
+  pthread_mutex_unlock(&formatCacheLock);
+  return c;
+}
+
 static inline void GSStrAppendUnichar(GSStr s, unichar u)
 {
   GSPrivateStrAppendUnichars(s, &u, 1);
@@ -811,9 +981,19 @@ static unichar *group_number (unichar *, unichar *, const char *, NSString *);
 
 /* The function itself.  */
 void
-GSPrivateFormat (GSStr s, const unichar *format, va_list ap,
+GSPrivateFormat (GSStr s, NSString *fmt, va_list ap,
 NSDictionary *locale)
 {
+  /* The parsed format if it came from the cache.  */
+  GSCompiledFormat *compiled;
+
+  /* The characters of the format string.  */
+  const unichar *format;
+
+  /* On-stack buffer for the characters of an uncached format.  */
+  unichar fbuf[1024];
+  unichar *fmt_malloced = NULL;
+
   /* The character used as thousands separator.  */
   NSString *thousands_sep = @"";
 
@@ -893,8 +1073,33 @@ NSDictionary *locale)
 #endif
   nspecs_done = 0;
 
+  /* Get the characters of the format string, either from a cached
+     parse of a constant string or by copying them into a buffer
+     (on the stack unless the format is really big, a rare occurrence).  */
+  compiled = cached_format (fmt);
+  if (compiled != NULL)
+    {
+      format = compiled->format;
+      lead_str_end = compiled->lead_str_end;
+    }
+  else
+    {
+      unichar	*buf = fbuf;
+      size_t	len = [fmt length];
+
+      if (len >= sizeof(fbuf) / sizeof(unichar))
+	{
+	  buf = fmt_malloced
+	    = NSZoneMalloc(NSDefaultMallocZone(), (len+1)*sizeof(unichar));
+	}
+      [fmt getCharacters: buf range: ((NSRange){0, len})];
+      buf[len] = '\0';
+      format = buf;
+      lead_str_end = find_spec (format);
+    }
+
   /* Find the first format specifier.  */
-  f = lead_str_end = find_spec ((const unichar *) format);
+  f = lead_str_end;
 
 
   /* Write the literal text before the first format.  */
@@ -944,71 +1149,67 @@ NSDictionary *locale)
 	  grouping = NULL;
       }
 
-    for (f = lead_str_end; *f != '\0'; f = specs[nspecs++].next_fmt)
+    if (compiled != NULL)
       {
-	if (nspecs >= nspecs_max)
+	/* The specifiers are modified while processing arguments
+	   (for '*' width and precision), so work on a private copy
+	   of the cached ones.  */
+	nspecs = compiled->nspecs;
+	nargs = compiled->nargs;
+	specs = alloca (nspecs * sizeof (struct printf_spec) + 1);
+	memcpy (specs, compiled->specs, nspecs * sizeof (struct printf_spec));
+	args_type = compiled->args_type;
+      }
+    else
+      {
+	int	*types;
+
+	for (f = lead_str_end; *f != '\0'; f = specs[nspecs++].next_fmt)
 	  {
-	    /* Extend the array of format specifiers.  */
-	    struct printf_spec *old = specs;
+	    if (nspecs >= nspecs_max)
+	      {
+		/* Extend the array of format specifiers.  */
+		struct printf_spec *old = specs;
 
-	    nspecs_max *= 2;
-	    specs = alloca (nspecs_max * sizeof (struct printf_spec));
+		nspecs_max *= 2;
+		specs = alloca (nspecs_max * sizeof (struct printf_spec));
 
-	    if (specs == &old[nspecs])
-	      /* Stack grows up, OLD was the last thing allocated;
-		 extend it.  */
-	      nspecs_max += nspecs_max / 2;
-	    else
-	      {
-		/* Copy the old array's elements to the new space.  */
-		memcpy (specs, old, nspecs * sizeof (struct printf_spec));
-		if (old == &specs[nspecs])
-		  /* Stack grows down, OLD was just below the new
-		     SPECS.  We can use that space when the new space
-		     runs out.  */
+		if (specs == &old[nspecs])
+		  /* Stack grows up, OLD was the last thing allocated;
+		     extend it.  */
 		  nspecs_max += nspecs_max / 2;
+		else
+		  {
+		    /* Copy the old array's elements to the new space.  */
+		    memcpy (specs, old, nspecs * sizeof (struct printf_spec));
+		    if (old == &specs[nspecs])
+		      /* Stack grows down, OLD was just below the new
+			 SPECS.  We can use that space when the new space
+			 runs out.  */
+		      nspecs_max += nspecs_max / 2;
+		  }
 	      }
-	  }
 
-	/* Parse the format specifier.  */
-	nargs += parse_one_spec (f, nargs, &specs[nspecs], &max_ref_arg);
-      }
-
-    /* Determine the number of arguments the format string consumes.  */
-    nargs = MAX (nargs, max_ref_arg);
-
-    /* Allocate memory for the argument descriptions.  */
-    args_type = alloca (nargs * sizeof (int));
-    memset (args_type, 0, nargs * sizeof (int));
-    args_value = alloca (nargs * sizeof (union printf_arg));
+	    /* Parse the format specifier.  */
+	    nargs += parse_one_spec (f, nargs, &specs[nspecs], &max_ref_arg);
+	  }
 
-    /* XXX Could do sanity check here: If any element in ARGS_TYPE is
-       still zero after this loop, format is invalid.  For now we
-       simply use 0 as the value.  */
+	/* Determine the number of arguments the format string consumes.  */
+	nargs = MAX (nargs, max_ref_arg);
 
-    /* Fill in the types of all the arguments.  */
-    for (cnt = 0; cnt < nspecs; ++cnt)
-      {
-	/* If the width is determined by an argument this is an int.  */
-	if (specs[cnt].width_arg != -1)
-	  args_type[specs[cnt].width_arg] = PA_INT;
+	/* Allocate memory for the argument descriptions.  */
+	types = alloca (nargs * sizeof (int));
+	memset (types, 0, nargs * sizeof (int));
 
-	/* If the precision is determined by an argument this is an int.  */
-	if (specs[cnt].prec_arg != -1)
-	  args_type[specs[cnt].prec_arg] = PA_INT;
+	/* XXX Could do sanity check here: If any element in ARGS_TYPE is
+	   still zero after this loop, format is invalid.  For now we
+	   simply use 0 as the value.  */
 
-	switch (specs[cnt].ndata_args)
-	  {
-	  case 0:		/* No arguments.  */
-	    break;
-	  case 1:		/* One argument; we already have the type.  */
-	    args_type[specs[cnt].data_arg] = specs[cnt].data_arg_type;
-	    break;
-	  default:
-	    /* ??? */
-	    break;
-	  }
+	/* Fill in the types of all the arguments.  */
+	fill_arg_types (specs, nspecs, types);
+	args_type = types;
       }
+    args_value = alloca (nargs * sizeof (union printf_arg));
 
     /* Now we know all the types and the order.  Fill in the argument
        values.  */
@@ -1861,14 +2062,20 @@ NSDictionary *locale)
 	if (!dsc) dsc = @"(null)";
 
 	len = [dsc length];
+	if (prec >= 0 && prec < (int)len) len = prec;
 
-	string_malloced = 0;
+	width -= len;
+	if (!left)
+	  PAD (' ');
+
+	/* If both the description and the result are 8-bit strings we
+	   can copy the bytes directly, otherwise we have to transform the
+	   NSString into a unicode string.  */
+	if (GSPrivateStrAppendString(s, dsc, len) == NO)
 	  {
-	    /* This is complicated.  We have to transform the
-	       NSString into a unicode string.  */
 	    NSRange r;
 
-	    if (prec >= 0 && prec < (int)len) len = prec;
+	    string_malloced = 0;
 
 	    /* Allocate dynamically an array which definitely is long
 	       enough for the wide character version.  */
@@ -1882,22 +2089,13 @@ NSDictionary *locale)
 	    r.location = 0;
 	    r.length = len;
 	    [dsc getCharacters: string range: r];
-	  }
-
-	if ((width -= len) < 0)
-	  {
 	    outstring (string, len);
+	    if (string_malloced)
+	      NSZoneFree(s->_zone, string);
 	  }
-	else
-	  {
-	    if (!left)
-	      PAD (' ');
-	    outstring (string, len);
-	    if (left)
-	      PAD (' ');
-	  }
-	if (string_malloced)
-	  NSZoneFree(s->_zone, string);
+
+	if (left)
+	  PAD (' ');
       }
       break;
 
@@ -1934,7 +2132,10 @@ NSDictionary *locale)
   }
 
 all_done:
-  /* Unlock the stream.  */
+  if (fmt_malloced != NULL)
+    {
+      NSZoneFree(NSDefaultMallocZone(), fmt_malloced);
+    }
   return;
 }
 
@@ -0,0 +1,152 @@
+/* Header for compressed bitmaps of indexes used by NSIndexSet
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNUstep Base Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02111 USA.
+   */
+
+#ifndef __GSIndexBitmap_h_GNUSTEP_BASE_INCLUDE
+#define __GSIndexBitmap_h_GNUSTEP_BASE_INCLUDE
+
+#import "GSPrivate.h"
+
+/* A set of indexes held in the manner of a 'Roaring' bitmap:
+ * the indexes are split into blocks of 65536 by their high bits, and
+ * each block present is held in a container which is a sorted array
+ * of the low 16 bits (for up to 4096 indexes), a bitset of 65536 bits,
+ * or a list of runs of consecutive indexes ... whichever is smallest.
+ * This uses little memory for sets which are too scattered to be held
+ * efficiently as ranges, and allows whole blocks to be combined at once
+ * in unions, intersections and differences.
+ */
+typedef struct GSIndexBitmap	GSIndexBitmap;
+
+/* State for stepping through the runs of consecutive indexes in a
+ * bitmap in ascending order.
+ */
+typedef struct {
+  GSIndexBitmap	*bitmap;
+  NSUInteger	container;	/* Current container.		*/
+  uint32_t	low;		/* Next low value to look at.	*/
+  uint32_t	slot;		/* Hint for array/run position.	*/
+} GSIndexBitmapCursor;
+
+/* Adds the indexes in aRange (which must not be empty).
+ */
+void
+GSIndexBitmapAddRange(GSIndexBitmap *b, NSRange aRange) GS_ATTRIB_PRIVATE;
+
+/* Returns the number of 65536 index blocks in use.
+ */
+NSUInteger
+GSIndexBitmapBlocks(GSIndexBitmap *b) GS_ATTRIB_PRIVATE;
+
+/* Returns YES if the index is in the bitmap.
+ */
+BOOL
+GSIndexBitmapContains(GSIndexBitmap *b, NSUInteger index) GS_ATTRIB_PRIVATE;
+
+/* Returns YES if every index in o is also in b.
+ */
+BOOL
+GSIndexBitmapContainsBitmap(GSIndexBitmap *b, GSIndexBitmap *o)
+  GS_ATTRIB_PRIVATE;
+
+/* Returns a copy of b in zone z, with each container in its most
+ * compact form.
+ */
+GSIndexBitmap *
+GSIndexBitmapCopy(GSIndexBitmap *b, NSZone *z) GS_ATTRIB_PRIVATE;
+
+/* Returns the total number of indexes in b.
+ */
+NSUInteger
+GSIndexBitmapCount(GSIndexBitmap *b) GS_ATTRIB_PRIVATE;
+
+/* Returns the number of indexes of b lying in aRange.
+ */
+NSUInteger
+GSIndexBitmapCountInRange(GSIndexBitmap *b, NSRange aRange) GS_ATTRIB_PRIVATE;
+
+/* Returns a new, empty, bitmap allocated in zone z.
+ */
+GSIndexBitmap *
+GSIndexBitmapCreate(NSZone *z) GS_ATTRIB_PRIVATE;
+
+/* Positions a cursor so that GSIndexBitmapCursorNext() returns the
+ * runs of indexes from index onwards.
+ */
+void
+GSIndexBitmapCursorInit(GSIndexBitmapCursor *c, GSIndexBitmap *b,
+  NSUInteger index) GS_ATTRIB_PRIVATE;
+
+/* Returns the next run of consecutive indexes (each run is as long as
+ * possible), or a range with a length of zero when there are no more.
+ */
+NSRange
+GSIndexBitmapCursorNext(GSIndexBitmapCursor *c) GS_ATTRIB_PRIVATE;
+
+/* Returns YES if the two bitmaps contain the same indexes.
+ */
+BOOL
+GSIndexBitmapEqual(GSIndexBitmap *b, GSIndexBitmap *o) GS_ATTRIB_PRIVATE;
+
+/* Releases a bitmap and all its memory.
+ */
+void
+GSIndexBitmapFree(GSIndexBitmap *b) GS_ATTRIB_PRIVATE;
+
+/* Removes from b any index which is not also in o.
+ */
+void
+GSIndexBitmapIntersect(GSIndexBitmap *b, GSIndexBitmap *o) GS_ATTRIB_PRIVATE;
+
+/* Returns the smallest index greater than or equal to index, or
+ * NSNotFound if there is none.
+ */
+NSUInteger
+GSIndexBitmapNext(GSIndexBitmap *b, NSUInteger index) GS_ATTRIB_PRIVATE;
+
+/* Returns the largest index less than or equal to index, or
+ * NSNotFound if there is none.
+ */
+NSUInteger
+GSIndexBitmapPrevious(GSIndexBitmap *b, NSUInteger index) GS_ATTRIB_PRIVATE;
+
+/* Returns the run of consecutive indexes starting with the first index
+ * greater than or equal to index.  The range has a location of
+ * NSNotFound if there is no such index.
+ */
+NSRange
+GSIndexBitmapRangeFrom(GSIndexBitmap *b, NSUInteger index) GS_ATTRIB_PRIVATE;
+
+/* Removes the indexes in aRange (which must not be empty).
+ */
+void
+GSIndexBitmapRemoveRange(GSIndexBitmap *b, NSRange aRange) GS_ATTRIB_PRIVATE;
+
+/* Removes from b every index which is in o.
+ */
+void
+GSIndexBitmapSubtract(GSIndexBitmap *b, GSIndexBitmap *o) GS_ATTRIB_PRIVATE;
+
+/* Adds every index in o to b.
+ */
+void
+GSIndexBitmapUnion(GSIndexBitmap *b, GSIndexBitmap *o) GS_ATTRIB_PRIVATE;
+
+#endif
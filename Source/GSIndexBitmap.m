@@ -0,0 +1,1744 @@
+/* Compressed bitmaps of indexes used by NSIndexSet
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNUstep Base Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02111 USA.
+   */
+
+#import "common.h"
+#import "GSIndexBitmap.h"
+
+#include <string.h>
+
+#define	ARRAY_MAX	4096	/* Most values in an array container.	*/
+#define	RUNS_MAX	2048	/* Most runs in a run container.	*/
+#define	WORDS		1024	/* 64bit words in a bitset container.	*/
+#define	SMALL		32	/* Ranges shorter than this are added or
+				 * removed one value at a time.		*/
+
+#if	defined(__GNUC__)
+#define	POPCOUNT(x)	__builtin_popcountll(x)
+#define	CTZ(x)		__builtin_ctzll(x)
+#define	CLZ(x)		__builtin_clzll(x)
+#else
+static inline unsigned
+POPCOUNT(uint64_t x)
+{
+  x = x - ((x >> 1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return (unsigned)((x * 0x0101010101010101ULL) >> 56);
+}
+static inline unsigned
+CTZ(uint64_t x)
+{
+  unsigned	n = 0;
+
+  while ((x & 1) == 0) { x >>= 1; n++; }
+  return n;
+}
+static inline unsigned
+CLZ(uint64_t x)
+{
+  unsigned	n = 0;
+
+  while ((x & 0x8000000000000000ULL) == 0) { x <<= 1; n++; }
+  return n;
+}
+#endif
+
+enum {
+  CArray = 0,		/* Sorted array of 16bit values.	*/
+  CBits,		/* Bitset of 65536 bits.		*/
+  CRuns			/* Sorted array of runs of values.	*/
+};
+
+typedef struct {
+  uint16_t	first;
+  uint16_t	last;		/* Inclusive.			*/
+} Run;
+
+typedef struct {
+  NSUInteger	key;		/* The high bits of the indexes.	*/
+  uint32_t	card;		/* Number of indexes.			*/
+  uint32_t	used;		/* Values or runs in use.		*/
+  uint32_t	cap;		/* Values or runs allocated.		*/
+  uint32_t	type;
+  union {
+    uint16_t	*values;
+    uint64_t	*words;
+    Run		*runs;
+    void	*ptr;
+  } u;
+} Container;
+
+struct GSIndexBitmap {
+  NSZone	*zone;
+  NSUInteger	count;		/* Total number of indexes.	*/
+  NSUInteger	used;		/* Containers in use.		*/
+  NSUInteger	cap;		/* Containers allocated.	*/
+  Container	*c;		/* Containers sorted by key.	*/
+};
+
+#define	KEY(i)	((i) >> 16)
+#define	LOW(i)	((uint32_t)((i) & 0xffff))
+#define	INDEX(key, low)	(((key) << 16) | (NSUInteger)(low))
+
+/*
+ * Operations on a bitset held as 1024 64bit words.
+ */
+
+static inline BOOL
+bitTest(const uint64_t *w, uint32_t v)
+{
+  return (w[v >> 6] >> (v & 63)) & 1;
+}
+
+static void
+bitSetRange(uint64_t *w, uint32_t lo, uint32_t hi)
+{
+  uint32_t	lw = lo >> 6;
+  uint32_t	hw = hi >> 6;
+  uint64_t	lm = ~0ULL << (lo & 63);
+  uint64_t	hm = ~0ULL >> (63 - (hi & 63));
+
+  if (lw == hw)
+    {
+      w[lw] |= (lm & hm);
+    }
+  else
+    {
+      w[lw] |= lm;
+      while (++lw < hw)
+	{
+	  w[lw] = ~0ULL;
+	}
+      w[hw] |= hm;
+    }
+}
+
+static void
+bitClearRange(uint64_t *w, uint32_t lo, uint32_t hi)
+{
+  uint32_t	lw = lo >> 6;
+  uint32_t	hw = hi >> 6;
+  uint64_t	lm = ~0ULL << (lo & 63);
+  uint64_t	hm = ~0ULL >> (63 - (hi & 63));
+
+  if (lw == hw)
+    {
+      w[lw] &= ~(lm & hm);
+    }
+  else
+    {
+      w[lw] &= ~lm;
+      while (++lw < hw)
+	{
+	  w[lw] = 0;
+	}
+      w[hw] &= ~hm;
+    }
+}
+
+/* Returns the first set bit at or after v, or 65536.
+ */
+static uint32_t
+bitNextSet(const uint64_t *w, uint32_t v)
+{
+  uint32_t	i;
+  uint64_t	x;
+
+  if (v >= 65536)
+    {
+      return 65536;
+    }
+  i = v >> 6;
+  x = w[i] & (~0ULL << (v & 63));
+  while (x == 0)
+    {
+      if (++i == WORDS)
+	{
+	  return 65536;
+	}
+      x = w[i];
+    }
+  return (i << 6) + CTZ(x);
+}
+
+/* Returns the first clear bit at or after v, or 65536.
+ */
+static uint32_t
+bitNextClear(const uint64_t *w, uint32_t v)
+{
+  uint32_t	i;
+  uint64_t	x;
+
+  if (v >= 65536)
+    {
+      return 65536;
+    }
+  i = v >> 6;
+  x = ~w[i] & (~0ULL << (v & 63));
+  while (x == 0)
+    {
+      if (++i == WORDS)
+	{
+	  return 65536;
+	}
+      x = ~w[i];
+    }
+  return (i << 6) + CTZ(x);
+}
+
+/* Returns the last set bit at or before v, or -1.
+ */
+static int32_t
+bitPrevSet(const uint64_t *w, uint32_t v)
+{
+  int32_t	i = v >> 6;
+  uint64_t	x = w[i] & (~0ULL >> (63 - (v & 63)));
+
+  while (x == 0)
+    {
+      if (--i < 0)
+	{
+	  return -1;
+	}
+      x = w[i];
+    }
+  return (i << 6) + 63 - CLZ(x);
+}
+
+/*
+ * Searches in sorted arrays.
+ */
+
+/* Returns the position of the first value >= v in values[from..n).
+ */
+static inline uint32_t
+lowerBound(const uint16_t *values, uint32_t from, uint32_t n, uint32_t v)
+{
+  while (from < n)
+    {
+      uint32_t	mid = (from + n) / 2;
+
+      if (values[mid] < v)
+	{
+	  from = mid + 1;
+	}
+      else
+	{
+	  n = mid;
+	}
+    }
+  return from;
+}
+
+/* Returns the position of the last run starting at or before v, or -1.
+ */
+static inline int32_t
+runFind(const Run *runs, uint32_t n, uint32_t v)
+{
+  uint32_t	lo = 0;
+
+  while (lo < n)
+    {
+      uint32_t	mid = (lo + n) / 2;
+
+      if (runs[mid].first <= v)
+	{
+	  lo = mid + 1;
+	}
+      else
+	{
+	  n = mid;
+	}
+    }
+  return (int32_t)lo - 1;
+}
+
+/*
+ * Operations on containers.
+ */
+
+static void
+cFree(NSZone *z, Container *c)
+{
+  if (c->u.ptr != 0)
+    {
+      NSZoneFree(z, c->u.ptr);
+      c->u.ptr = 0;
+    }
+  c->card = c->used = c->cap = 0;
+  c->type = CArray;
+}
+
+/* Ensures there is space for n values or runs.
+ */
+static void
+cReserve(NSZone *z, Container *c, uint32_t n, size_t size)
+{
+  if (n > c->cap)
+    {
+      uint32_t	cap = (c->cap < 4) ? 4 : c->cap;
+
+      while (cap < n)
+	{
+	  cap *= 2;
+	}
+      if (c->u.ptr == 0)
+	{
+	  c->u.ptr = NSZoneMalloc(z, cap * size);
+	}
+      else
+	{
+	  c->u.ptr = NSZoneRealloc(z, c->u.ptr, cap * size);
+	}
+      c->cap = cap;
+    }
+}
+
+static void
+cToBits(const Container *c, uint64_t *w)
+{
+  uint32_t	i;
+
+  if (CBits == c->type)
+    {
+      memcpy(w, c->u.words, WORDS * sizeof(uint64_t));
+      return;
+    }
+  memset(w, '\0', WORDS * sizeof(uint64_t));
+  if (CArray == c->type)
+    {
+      for (i = 0; i < c->used; i++)
+	{
+	  uint32_t	v = c->u.values[i];
+
+	  w[v >> 6] |= 1ULL << (v & 63);
+	}
+    }
+  else
+    {
+      for (i = 0; i < c->used; i++)
+	{
+	  bitSetRange(w, c->u.runs[i].first, c->u.runs[i].last);
+	}
+    }
+}
+
+/* Replaces the contents of c with the bits in w, using whichever
+ * representation is smallest.
+ */
+static void
+cFromBits(NSZone *z, Container *c, const uint64_t *w)
+{
+  uint32_t	card = 0;
+  uint32_t	runs = 0;
+  uint64_t	carry = 0;
+  size_t	asize;
+  size_t	rsize;
+  uint32_t	i;
+
+  for (i = 0; i < WORDS; i++)
+    {
+      uint64_t	x = w[i];
+
+      card += POPCOUNT(x);
+      runs += POPCOUNT(x & ~((x << 1) | carry));
+      carry = x >> 63;
+    }
+  if (0 == card)
+    {
+      cFree(z, c);
+      return;
+    }
+  asize = (card <= ARRAY_MAX) ? 2 * card : (size_t)-1;
+  rsize = 4 * runs;
+  if (rsize <= asize && rsize < WORDS * sizeof(uint64_t))
+    {
+      Run	*r = NSZoneMalloc(z, runs * sizeof(Run));
+      uint32_t	v = 0;
+
+      for (i = 0; i < runs; i++)
+	{
+	  v = bitNextSet(w, v);
+	  r[i].first = v;
+	  v = bitNextClear(w, v);
+	  r[i].last = v - 1;
+	}
+      cFree(z, c);
+      c->type = CRuns;
+      c->u.runs = r;
+      c->used = c->cap = runs;
+    }
+  else if (asize <= WORDS * sizeof(uint64_t))
+    {
+      uint16_t	*a = NSZoneMalloc(z, card * sizeof(uint16_t));
+      uint32_t	n = 0;
+
+      for (i = 0; i < WORDS; i++)
+	{
+	  uint64_t	x = w[i];
+
+	  while (x != 0)
+	    {
+	      a[n++] = (i << 6) + CTZ(x);
+	      x &= x - 1;
+	    }
+	}
+      cFree(z, c);
+      c->type = CArray;
+      c->u.values = a;
+      c->used = c->cap = card;
+    }
+  else
+    {
+      if (c->type != CBits)
+	{
+	  cFree(z, c);
+	  c->type = CBits;
+	  c->u.words = NSZoneMalloc(z, WORDS * sizeof(uint64_t));
+	}
+      if (c->u.words != w)
+	{
+	  memcpy(c->u.words, w, WORDS * sizeof(uint64_t));
+	}
+      c->used = c->cap = 0;
+    }
+  c->card = card;
+}
+
+static void
+cSetFull(NSZone *z, Container *c)
+{
+  if (c->type != CRuns || c->cap < 1)
+    {
+      cFree(z, c);
+      c->type = CRuns;
+      c->u.runs = NSZoneMalloc(z, sizeof(Run));
+      c->cap = 1;
+    }
+  c->u.runs[0].first = 0;
+  c->u.runs[0].last = 0xffff;
+  c->used = 1;
+  c->card = 65536;
+}
+
+static BOOL
+cContains(const Container *c, uint32_t v)
+{
+  if (CArray == c->type)
+    {
+      uint32_t	p = lowerBound(c->u.values, 0, c->used, v);
+
+      return (p < c->used && c->u.values[p] == v) ? YES : NO;
+    }
+  else if (CBits == c->type)
+    {
+      return bitTest(c->u.words, v);
+    }
+  else
+    {
+      int32_t	i = runFind(c->u.runs, c->used, v);
+
+      return (i >= 0 && v <= c->u.runs[i].last) ? YES : NO;
+    }
+}
+
+/* Returns the first value at or after v, or -1.
+ */
+static int32_t
+cNext(const Container *c, uint32_t v)
+{
+  if (v > 0xffff)
+    {
+      return -1;
+    }
+  if (CArray == c->type)
+    {
+      uint32_t	p = lowerBound(c->u.values, 0, c->used, v);
+
+      return (p < c->used) ? (int32_t)c->u.values[p] : -1;
+    }
+  else if (CBits == c->type)
+    {
+      uint32_t	n = bitNextSet(c->u.words, v);
+
+      return (n < 65536) ? (int32_t)n : -1;
+    }
+  else
+    {
+      int32_t	i = runFind(c->u.runs, c->used, v);
+
+      if (i >= 0 && v <= c->u.runs[i].last)
+	{
+	  return v;
+	}
+      return ((uint32_t)(i + 1) < c->used) ? c->u.runs[i + 1].first : -1;
+    }
+}
+
+/* Returns the last value at or before v, or -1.
+ */
+static int32_t
+cPrevious(const Container *c, uint32_t v)
+{
+  if (CArray == c->type)
+    {
+      uint32_t	p = lowerBound(c->u.values, 0, c->used, v + 1);
+
+      return (p > 0) ? (int32_t)c->u.values[p - 1] : -1;
+    }
+  else if (CBits == c->type)
+    {
+      return bitPrevSet(c->u.words, v);
+    }
+  else
+    {
+      int32_t	i = runFind(c->u.runs, c->used, v);
+
+      if (i < 0)
+	{
+	  return -1;
+	}
+      return (v < c->u.runs[i].last) ? (int32_t)v : c->u.runs[i].last;
+    }
+}
+
+/* Returns the last value of the run of consecutive values containing v.
+ */
+static uint32_t
+cRunEnd(const Container *c, uint32_t v)
+{
+  if (CArray == c->type)
+    {
+      uint32_t	p = lowerBound(c->u.values, 0, c->used, v);
+
+      while (p + 1 < c->used && c->u.values[p + 1] == c->u.values[p] + 1)
+	{
+	  p++;
+	}
+      return c->u.values[p];
+    }
+  else if (CBits == c->type)
+    {
+      return bitNextClear(c->u.words, v) - 1;
+    }
+  else
+    {
+      return c->u.runs[runFind(c->u.runs, c->used, v)].last;
+    }
+}
+
+/* Returns the number of values less than v (which may be 65536).
+ */
+static uint32_t
+cRank(const Container *c, uint32_t v)
+{
+  uint32_t	n = 0;
+  uint32_t	i;
+
+  if (CArray == c->type)
+    {
+      return lowerBound(c->u.values, 0, c->used, v);
+    }
+  else if (CBits == c->type)
+    {
+      for (i = 0; i < (v >> 6); i++)
+	{
+	  n += POPCOUNT(c->u.words[i]);
+	}
+      if (v < 65536 && (v & 63) != 0)
+	{
+	  n += POPCOUNT(c->u.words[v >> 6] & ((1ULL << (v & 63)) - 1));
+	}
+      return n;
+    }
+  else
+    {
+      for (i = 0; i < c->used && c->u.runs[i].first < v; i++)
+	{
+	  uint32_t	last = c->u.runs[i].last;
+
+	  if (last >= v)
+	    {
+	      last = v - 1;
+	    }
+	  n += last - c->u.runs[i].first + 1;
+	}
+      return n;
+    }
+}
+
+/* Adds v, returning 1 if it was not already present.
+ */
+static uint32_t
+cAdd(NSZone *z, Container *c, uint32_t v)
+{
+  if (CArray == c->type)
+    {
+      uint32_t	p = lowerBound(c->u.values, 0, c->used, v);
+
+      if (p < c->used && c->u.values[p] == v)
+	{
+	  return 0;
+	}
+      if (c->used == ARRAY_MAX)
+	{
+	  uint64_t	w[WORDS];
+
+	  cToBits(c, w);
+	  w[v >> 6] |= 1ULL << (v & 63);
+	  cFromBits(z, c, w);
+	  return 1;
+	}
+      cReserve(z, c, c->used + 1, sizeof(uint16_t));
+      memmove(c->u.values + p + 1, c->u.values + p,
+	(c->used - p) * sizeof(uint16_t));
+      c->u.values[p] = v;
+      c->used++;
+    }
+  else if (CBits == c->type)
+    {
+      if (bitTest(c->u.words, v))
+	{
+	  return 0;
+	}
+      c->u.words[v >> 6] |= 1ULL << (v & 63);
+    }
+  else
+    {
+      Run	*r = c->u.runs;
+      int32_t	i = runFind(r, c->used, v);
+      BOOL	joinPrev;
+      BOOL	joinNext;
+
+      if (i >= 0 && v <= r[i].last)
+	{
+	  return 0;
+	}
+      joinPrev = (i >= 0 && (uint32_t)r[i].last + 1 == v) ? YES : NO;
+      joinNext = ((uint32_t)(i + 1) < c->used && r[i + 1].first == v + 1)
+	? YES : NO;
+      if (joinPrev && joinNext)
+	{
+	  r[i].last = r[i + 1].last;
+	  memmove(r + i + 1, r + i + 2, (c->used - i - 2) * sizeof(Run));
+	  c->used--;
+	}
+      else if (joinPrev)
+	{
+	  r[i].last = v;
+	}
+      else if (joinNext)
+	{
+	  r[i + 1].first = v;
+	}
+      else if (c->used == RUNS_MAX)
+	{
+	  uint64_t	w[WORDS];
+
+	  cToBits(c, w);
+	  w[v >> 6] |= 1ULL << (v & 63);
+	  cFromBits(z, c, w);
+	  return 1;
+	}
+      else
+	{
+	  cReserve(z, c, c->used + 1, sizeof(Run));
+	  r = c->u.runs;
+	  memmove(r + i + 2, r + i + 1, (c->used - i - 1) * sizeof(Run));
+	  r[i + 1].first = r[i + 1].last = v;
+	  c->used++;
+	}
+    }
+  c->card++;
+  return 1;
+}
+
+/* Removes v, returning 1 if it was present.
+ */
+static uint32_t
+cRemove(NSZone *z, Container *c, uint32_t v)
+{
+  if (CArray == c->type)
+    {
+      uint32_t	p = lowerBound(c->u.values, 0, c->used, v);
+
+      if (p == c->used || c->u.values[p] != v)
+	{
+	  return 0;
+	}
+      memmove(c->u.values + p, c->u.values + p + 1,
+	(c->used - p - 1) * sizeof(uint16_t));
+      c->used--;
+      c->card--;
+    }
+  else if (CBits == c->type)
+    {
+      if (!bitTest(c->u.words, v))
+	{
+	  return 0;
+	}
+      c->u.words[v >> 6] &= ~(1ULL << (v & 63));
+      /* Convert back to a smaller form once the bitset is well below
+       * the size at which we converted to it, so that adding and
+       * removing a value at the boundary does not repeatedly convert.
+       */
+      if (--c->card <= ARRAY_MAX / 2)
+	{
+	  uint64_t	w[WORDS];
+
+	  memcpy(w, c->u.words, sizeof(w));
+	  cFromBits(z, c, w);
+	}
+    }
+  else
+    {
+      Run	*r = c->u.runs;
+      int32_t	i = runFind(r, c->used, v);
+
+      if (i < 0 || v > r[i].last)
+	{
+	  return 0;
+	}
+      if (r[i].first == r[i].last)
+	{
+	  memmove(r + i, r + i + 1, (c->used - i - 1) * sizeof(Run));
+	  c->used--;
+	}
+      else if (r[i].first == v)
+	{
+	  r[i].first++;
+	}
+      else if (r[i].last == v)
+	{
+	  r[i].last--;
+	}
+      else if (c->used == RUNS_MAX)
+	{
+	  uint64_t	w[WORDS];
+
+	  cToBits(c, w);
+	  w[v >> 6] &= ~(1ULL << (v & 63));
+	  cFromBits(z, c, w);
+	  return 1;
+	}
+      else
+	{
+	  cReserve(z, c, c->used + 1, sizeof(Run));
+	  r = c->u.runs;
+	  memmove(r + i + 2, r + i + 1, (c->used - i - 1) * sizeof(Run));
+	  r[i + 1].first = v + 1;
+	  r[i + 1].last = r[i].last;
+	  r[i].last = v - 1;
+	  c->used++;
+	}
+      c->card--;
+    }
+  return 1;
+}
+
+/* Adds the values lo to hi inclusive, returning the number added.
+ */
+static uint32_t
+cAddRange(NSZone *z, Container *c, uint32_t lo, uint32_t hi)
+{
+  uint32_t	old = c->card;
+
+  if (0 == lo && 0xffff == hi)
+    {
+      cSetFull(z, c);
+    }
+  else if (hi - lo < SMALL)
+    {
+      while (lo <= hi)
+	{
+	  cAdd(z, c, lo++);
+	}
+    }
+  else if (CBits == c->type)
+    {
+      uint64_t	w[WORDS];
+
+      memcpy(w, c->u.words, sizeof(w));
+      bitSetRange(w, lo, hi);
+      cFromBits(z, c, w);
+    }
+  else
+    {
+      uint64_t	w[WORDS];
+
+      cToBits(c, w);
+      bitSetRange(w, lo, hi);
+      cFromBits(z, c, w);
+    }
+  return c->card - old;
+}
+
+/* Removes the values lo to hi inclusive, returning the number removed.
+ */
+static uint32_t
+cRemoveRange(NSZone *z, Container *c, uint32_t lo, uint32_t hi)
+{
+  uint32_t	old = c->card;
+
+  if (0 == lo && 0xffff == hi)
+    {
+      cFree(z, c);
+    }
+  else if (hi - lo < SMALL)
+    {
+      while (lo <= hi && c->card > 0)
+	{
+	  cRemove(z, c, lo++);
+	}
+    }
+  else
+    {
+      uint64_t	w[WORDS];
+
+      cToBits(c, w);
+      bitClearRange(w, lo, hi);
+      cFromBits(z, c, w);
+    }
+  return old - c->card;
+}
+
+/* Copies src into dst, converting arrays to runs where that is smaller.
+ */
+static void
+cCopy(NSZone *z, Container *dst, const Container *src)
+{
+  *dst = *src;
+  dst->u.ptr = 0;
+  dst->used = dst->cap = 0;
+  if (CArray == src->type)
+    {
+      uint32_t	runs = 1;
+      uint32_t	i;
+
+      for (i = 1; i < src->used; i++)
+	{
+	  if (src->u.values[i] != src->u.values[i - 1] + 1)
+	    {
+	      runs++;
+	    }
+	}
+      if (2 * runs < src->used)
+	{
+	  Run	*r = NSZoneMalloc(z, runs * sizeof(Run));
+	  uint32_t	n = 0;
+
+	  r[0].first = r[0].last = src->u.values[0];
+	  for (i = 1; i < src->used; i++)
+	    {
+	      if (src->u.values[i] == r[n].last + 1)
+		{
+		  r[n].last++;
+		}
+	      else
+		{
+		  n++;
+		  r[n].first = r[n].last = src->u.values[i];
+		}
+	    }
+	  dst->type = CRuns;
+	  dst->u.runs = r;
+	  dst->used = dst->cap = runs;
+	}
+      else
+	{
+	  dst->u.values = NSZoneMalloc(z, src->used * sizeof(uint16_t));
+	  memcpy(dst->u.values, src->u.values, src->used * sizeof(uint16_t));
+	  dst->used = dst->cap = src->used;
+	}
+    }
+  else if (CBits == src->type)
+    {
+      dst->type = CArray;
+      dst->card = 0;
+      cFromBits(z, dst, src->u.words);
+    }
+  else
+    {
+      dst->u.runs = NSZoneMalloc(z, src->used * sizeof(Run));
+      memcpy(dst->u.runs, src->u.runs, src->used * sizeof(Run));
+      dst->used = dst->cap = src->used;
+    }
+}
+
+static void
+cUnion(NSZone *z, Container *a, const Container *b)
+{
+  if (65536 == a->card)
+    {
+      return;
+    }
+  if (65536 == b->card)
+    {
+      cSetFull(z, a);
+    }
+  else if (CArray == a->type && CArray == b->type
+    && a->card + b->card <= ARRAY_MAX)
+    {
+      uint16_t	*m = NSZoneMalloc(z, (a->used + b->used) * sizeof(uint16_t));
+      uint32_t	i = 0;
+      uint32_t	j = 0;
+      uint32_t	n = 0;
+
+      while (i < a->used && j < b->used)
+	{
+	  uint16_t	x = a->u.values[i];
+	  uint16_t	y = b->u.values[j];
+
+	  if (x < y)
+	    {
+	      m[n++] = x; i++;
+	    }
+	  else if (y < x)
+	    {
+	      m[n++] = y; j++;
+	    }
+	  else
+	    {
+	      m[n++] = x; i++; j++;
+	    }
+	}
+      while (i < a->used)
+	{
+	  m[n++] = a->u.values[i++];
+	}
+      while (j < b->used)
+	{
+	  m[n++] = b->u.values[j++];
+	}
+      cFree(z, a);
+      a->type = CArray;
+      a->u.values = m;
+      a->cap = a->card + b->card;
+      a->used = a->card = n;
+    }
+  else
+    {
+      uint64_t	w[WORDS];
+      uint32_t	i;
+
+      cToBits(a, w);
+      if (CBits == b->type)
+	{
+	  for (i = 0; i < WORDS; i++)
+	    {
+	      w[i] |= b->u.words[i];
+	    }
+	}
+      else if (CRuns == b->type)
+	{
+	  for (i = 0; i < b->used; i++)
+	    {
+	      bitSetRange(w, b->u.runs[i].first, b->u.runs[i].last);
+	    }
+	}
+      else
+	{
+	  for (i = 0; i < b->used; i++)
+	    {
+	      uint32_t	v = b->u.values[i];
+
+	      w[v >> 6] |= 1ULL << (v & 63);
+	    }
+	}
+      cFromBits(z, a, w);
+    }
+}
+
+static void
+cIntersect(NSZone *z, Container *a, const Container *b)
+{
+  if (65536 == b->card)
+    {
+      return;
+    }
+  if (CArray == a->type)
+    {
+      uint32_t	i;
+      uint32_t	n = 0;
+
+      for (i = 0; i < a->used; i++)
+	{
+	  if (cContains(b, a->u.values[i]))
+	    {
+	      a->u.values[n++] = a->u.values[i];
+	    }
+	}
+      a->used = a->card = n;
+      if (0 == n)
+	{
+	  cFree(z, a);
+	}
+    }
+  else if (CArray == b->type)
+    {
+      uint16_t	*m = NSZoneMalloc(z, b->used * sizeof(uint16_t));
+      uint32_t	i;
+      uint32_t	n = 0;
+
+      for (i = 0; i < b->used; i++)
+	{
+	  if (cContains(a, b->u.values[i]))
+	    {
+	      m[n++] = b->u.values[i];
+	    }
+	}
+      cFree(z, a);
+      if (n > 0)
+	{
+	  a->type = CArray;
+	  a->u.values = m;
+	  a->cap = b->used;
+	  a->used = a->card = n;
+	}
+      else
+	{
+	  NSZoneFree(z, m);
+	}
+    }
+  else
+    {
+      uint64_t	w[WORDS];
+      uint64_t	x[WORDS];
+      uint32_t	i;
+
+      cToBits(a, w);
+      cToBits(b, x);
+      for (i = 0; i < WORDS; i++)
+	{
+	  w[i] &= x[i];
+	}
+      cFromBits(z, a, w);
+    }
+}
+
+static void
+cSubtract(NSZone *z, Container *a, const Container *b)
+{
+  if (65536 == b->card)
+    {
+      cFree(z, a);
+    }
+  else if (CArray == a->type)
+    {
+      uint32_t	i;
+      uint32_t	n = 0;
+
+      for (i = 0; i < a->used; i++)
+	{
+	  if (!cContains(b, a->u.values[i]))
+	    {
+	      a->u.values[n++] = a->u.values[i];
+	    }
+	}
+      a->used = a->card = n;
+      if (0 == n)
+	{
+	  cFree(z, a);
+	}
+    }
+  else
+    {
+      uint64_t	w[WORDS];
+      uint32_t	i;
+
+      cToBits(a, w);
+      if (CBits == b->type)
+	{
+	  for (i = 0; i < WORDS; i++)
+	    {
+	      w[i] &= ~b->u.words[i];
+	    }
+	}
+      else if (CRuns == b->type)
+	{
+	  for (i = 0; i < b->used; i++)
+	    {
+	      bitClearRange(w, b->u.runs[i].first, b->u.runs[i].last);
+	    }
+	}
+      else
+	{
+	  for (i = 0; i < b->used; i++)
+	    {
+	      uint32_t	v = b->u.values[i];
+
+	      w[v >> 6] &= ~(1ULL << (v & 63));
+	    }
+	}
+      cFromBits(z, a, w);
+    }
+}
+
+/* Returns YES if every value in b is in a.
+ */
+static BOOL
+cContainsAll(const Container *a, const Container *b)
+{
+  uint32_t	i;
+
+  if (b->card > a->card)
+    {
+      return NO;
+    }
+  if (CArray == b->type)
+    {
+      for (i = 0; i < b->used; i++)
+	{
+	  if (!cContains(a, b->u.values[i]))
+	    {
+	      return NO;
+	    }
+	}
+    }
+  else
+    {
+      uint64_t	w[WORDS];
+      uint64_t	x[WORDS];
+
+      cToBits(a, w);
+      cToBits(b, x);
+      for (i = 0; i < WORDS; i++)
+	{
+	  if (x[i] & ~w[i])
+	    {
+	      return NO;
+	    }
+	}
+    }
+  return YES;
+}
+
+static BOOL
+cEqual(const Container *a, const Container *b)
+{
+  if (a->card != b->card)
+    {
+      return NO;
+    }
+  if (a->type == b->type)
+    {
+      if (CArray == a->type)
+	{
+	  return memcmp(a->u.values, b->u.values,
+	    a->used * sizeof(uint16_t)) ? NO : YES;
+	}
+      if (CBits == a->type)
+	{
+	  return memcmp(a->u.words, b->u.words,
+	    WORDS * sizeof(uint64_t)) ? NO : YES;
+	}
+      return (a->used == b->used && 0 == memcmp(a->u.runs, b->u.runs,
+	a->used * sizeof(Run))) ? YES : NO;
+    }
+  return cContainsAll(a, b);
+}
+
+/*
+ * Operations on the bitmap as a whole.
+ */
+
+/* Returns the position of the first container whose key is >= key.
+ */
+static NSUInteger
+findKey(GSIndexBitmap *b, NSUInteger key)
+{
+  NSUInteger	lo = 0;
+  NSUInteger	hi = b->used;
+
+  while (lo < hi)
+    {
+      NSUInteger	mid = (lo + hi) / 2;
+
+      if (b->c[mid].key < key)
+	{
+	  lo = mid + 1;
+	}
+      else
+	{
+	  hi = mid;
+	}
+    }
+  return lo;
+}
+
+static void
+ensureCapacity(GSIndexBitmap *b, NSUInteger n)
+{
+  if (n > b->cap)
+    {
+      NSUInteger	cap = (b->cap < 4) ? 4 : b->cap;
+
+      while (cap < n)
+	{
+	  cap *= 2;
+	}
+      if (b->c == 0)
+	{
+	  b->c = NSZoneMalloc(b->zone, cap * sizeof(Container));
+	}
+      else
+	{
+	  b->c = NSZoneRealloc(b->zone, b->c, cap * sizeof(Container));
+	}
+      b->cap = cap;
+    }
+}
+
+/* Removes the empty containers from position p onwards, freeing any
+ * storage they still hold.
+ */
+static void
+compact(GSIndexBitmap *b, NSUInteger p)
+{
+  NSUInteger	n = p;
+
+  while (p < b->used)
+    {
+      if (b->c[p].card > 0)
+	{
+	  b->c[n++] = b->c[p];
+	}
+      else
+	{
+	  cFree(b->zone, &b->c[p]);
+	}
+      p++;
+    }
+  b->used = n;
+}
+
+/* Returns the container for key, creating an empty one if needed.
+ */
+static Container *
+containerFor(GSIndexBitmap *b, NSUInteger key)
+{
+  NSUInteger	p = findKey(b, key);
+  Container	*c;
+
+  if (p < b->used && b->c[p].key == key)
+    {
+      return &b->c[p];
+    }
+  ensureCapacity(b, b->used + 1);
+  memmove(b->c + p + 1, b->c + p, (b->used - p) * sizeof(Container));
+  b->used++;
+  c = &b->c[p];
+  memset(c, '\0', sizeof(Container));
+  c->key = key;
+  c->type = CArray;
+  return c;
+}
+
+void
+GSIndexBitmapAddRange(GSIndexBitmap *b, NSRange aRange)
+{
+  NSUInteger	lo = aRange.location;
+  NSUInteger	hi = NSMaxRange(aRange) - 1;
+  NSUInteger	lk = KEY(lo);
+  NSUInteger	hk = KEY(hi);
+
+  if (lk == hk)
+    {
+      Container	*c = containerFor(b, lk);
+
+      b->count += cAddRange(b->zone, c, LOW(lo), LOW(hi));
+    }
+  else
+    {
+      NSUInteger	p0 = findKey(b, lk);
+      NSUInteger	p1 = findKey(b, hk + 1);
+      NSUInteger	k = hk - lk + 1;
+      NSUInteger	missing = k - (p1 - p0);
+      NSUInteger	src = p1;
+      NSUInteger	j;
+
+      /* Open up space for a container for every key in the range,
+       * then move the existing ones into place working backwards.
+       */
+      ensureCapacity(b, b->used + missing);
+      memmove(b->c + p0 + k, b->c + p1, (b->used - p1) * sizeof(Container));
+      b->used += missing;
+      j = k;
+      while (j-- > 0)
+	{
+	  Container	*c = &b->c[p0 + j];
+
+	  if (src > p0 && b->c[src - 1].key == lk + j)
+	    {
+	      src--;
+	      if (c != &b->c[src])
+		{
+		  *c = b->c[src];
+		}
+	    }
+	  else
+	    {
+	      memset(c, '\0', sizeof(Container));
+	      c->key = lk + j;
+	      c->type = CArray;
+	    }
+	}
+      for (j = 0; j < k; j++)
+	{
+	  uint32_t	clo = (0 == j) ? LOW(lo) : 0;
+	  uint32_t	chi = (k - 1 == j) ? LOW(hi) : 0xffff;
+
+	  b->count += cAddRange(b->zone, &b->c[p0 + j], clo, chi);
+	}
+    }
+}
+
+NSUInteger
+GSIndexBitmapBlocks(GSIndexBitmap *b)
+{
+  return b->used;
+}
+
+BOOL
+GSIndexBitmapContains(GSIndexBitmap *b, NSUInteger index)
+{
+  NSUInteger	p = findKey(b, KEY(index));
+
+  if (p < b->used && b->c[p].key == KEY(index))
+    {
+      return cContains(&b->c[p], LOW(index));
+    }
+  return NO;
+}
+
+BOOL
+GSIndexBitmapContainsBitmap(GSIndexBitmap *b, GSIndexBitmap *o)
+{
+  NSUInteger	i = 0;
+  NSUInteger	j;
+
+  if (o->count > b->count)
+    {
+      return NO;
+    }
+  for (j = 0; j < o->used; j++)
+    {
+      while (i < b->used && b->c[i].key < o->c[j].key)
+	{
+	  i++;
+	}
+      if (i == b->used || b->c[i].key != o->c[j].key
+	|| !cContainsAll(&b->c[i], &o->c[j]))
+	{
+	  return NO;
+	}
+    }
+  return YES;
+}
+
+GSIndexBitmap *
+GSIndexBitmapCopy(GSIndexBitmap *b, NSZone *z)
+{
+  GSIndexBitmap	*n = GSIndexBitmapCreate(z);
+  NSUInteger	i;
+
+  ensureCapacity(n, b->used);
+  for (i = 0; i < b->used; i++)
+    {
+      cCopy(z, &n->c[i], &b->c[i]);
+    }
+  n->used = b->used;
+  n->count = b->count;
+  return n;
+}
+
+NSUInteger
+GSIndexBitmapCount(GSIndexBitmap *b)
+{
+  return b->count;
+}
+
+NSUInteger
+GSIndexBitmapCountInRange(GSIndexBitmap *b, NSRange aRange)
+{
+  NSUInteger	lo;
+  NSUInteger	hi;
+  NSUInteger	p;
+  NSUInteger	total = 0;
+
+  if (0 == aRange.length)
+    {
+      return 0;
+    }
+  lo = aRange.location;
+  hi = NSMaxRange(aRange) - 1;
+  for (p = findKey(b, KEY(lo)); p < b->used && b->c[p].key <= KEY(hi); p++)
+    {
+      Container	*c = &b->c[p];
+      uint32_t	clo = (c->key == KEY(lo)) ? LOW(lo) : 0;
+      uint32_t	chi = (c->key == KEY(hi)) ? LOW(hi) + 1 : 65536;
+
+      if (0 == clo && 65536 == chi)
+	{
+	  total += c->card;
+	}
+      else
+	{
+	  total += cRank(c, chi) - cRank(c, clo);
+	}
+    }
+  return total;
+}
+
+GSIndexBitmap *
+GSIndexBitmapCreate(NSZone *z)
+{
+  GSIndexBitmap	*b = NSZoneMalloc(z, sizeof(GSIndexBitmap));
+
+  memset(b, '\0', sizeof(*b));
+  b->zone = z;
+  return b;
+}
+
+void
+GSIndexBitmapCursorInit(GSIndexBitmapCursor *c, GSIndexBitmap *b,
+  NSUInteger index)
+{
+  c->bitmap = b;
+  c->container = findKey(b, KEY(index));
+  c->low = 0;
+  c->slot = 0;
+  if (c->container < b->used && b->c[c->container].key == KEY(index))
+    {
+      Container	*ct = &b->c[c->container];
+
+      c->low = LOW(index);
+      if (CArray == ct->type)
+	{
+	  c->slot = lowerBound(ct->u.values, 0, ct->used, c->low);
+	}
+      else if (CRuns == ct->type)
+	{
+	  int32_t	i = runFind(ct->u.runs, ct->used, c->low);
+
+	  c->slot = (i >= 0 && c->low <= ct->u.runs[i].last) ? i : i + 1;
+	}
+    }
+}
+
+/* The cursor keeps the position in an array or run container of the
+ * next value or run to look at, so stepping through a set takes
+ * constant time per run.
+ */
+NSRange
+GSIndexBitmapCursorNext(GSIndexBitmapCursor *cur)
+{
+  GSIndexBitmap	*b = cur->bitmap;
+
+  while (cur->container < b->used)
+    {
+      Container	*c = &b->c[cur->container];
+      uint32_t	start;
+      uint32_t	end;
+      NSUInteger	first;
+
+      if (cur->low > 0xffff)
+	{
+	  cur->container++;
+	  cur->low = cur->slot = 0;
+	  continue;
+	}
+      if (CArray == c->type)
+	{
+	  uint32_t	s = cur->slot;
+
+	  while (s < c->used && c->u.values[s] < cur->low)
+	    {
+	      s++;
+	    }
+	  if (s == c->used)
+	    {
+	      cur->container++;
+	      cur->low = cur->slot = 0;
+	      continue;
+	    }
+	  start = end = c->u.values[s];
+	  while (s + 1 < c->used && c->u.values[s + 1] == end + 1)
+	    {
+	      s++;
+	      end++;
+	    }
+	  cur->slot = s + 1;
+	}
+      else if (CRuns == c->type)
+	{
+	  uint32_t	s = cur->slot;
+
+	  while (s < c->used && c->u.runs[s].last < cur->low)
+	    {
+	      s++;
+	    }
+	  if (s == c->used)
+	    {
+	      cur->container++;
+	      cur->low = cur->slot = 0;
+	      continue;
+	    }
+	  start = c->u.runs[s].first;
+	  if (start < cur->low)
+	    {
+	      start = cur->low;
+	    }
+	  end = c->u.runs[s].last;
+	  cur->slot = s + 1;
+	}
+      else
+	{
+	  start = bitNextSet(c->u.words, cur->low);
+	  if (start > 0xffff)
+	    {
+	      cur->container++;
+	      cur->low = cur->slot = 0;
+	      continue;
+	    }
+	  end = bitNextClear(c->u.words, start) - 1;
+	}
+      first = INDEX(c->key, start);
+
+      /* Continue the run into following blocks while each block starts
+       * where the previous one finished.
+       */
+      while (0xffff == end && cur->container + 1 < b->used
+	&& b->c[cur->container + 1].key == c->key + 1
+	&& cContains(&b->c[cur->container + 1], 0))
+	{
+	  c = &b->c[++cur->container];
+	  end = cRunEnd(c, 0);
+	  cur->slot = (CArray == c->type) ? end + 1 : 1;
+	}
+      cur->low = end + 1;
+      return NSMakeRange(first, INDEX(c->key, end) - first + 1);
+    }
+  return NSMakeRange(NSNotFound, 0);
+}
+
+BOOL
+GSIndexBitmapEqual(GSIndexBitmap *b, GSIndexBitmap *o)
+{
+  NSUInteger	i;
+
+  if (b->count != o->count || b->used != o->used)
+    {
+      return NO;
+    }
+  for (i = 0; i < b->used; i++)
+    {
+      if (b->c[i].key != o->c[i].key || !cEqual(&b->c[i], &o->c[i]))
+	{
+	  return NO;
+	}
+    }
+  return YES;
+}
+
+void
+GSIndexBitmapFree(GSIndexBitmap *b)
+{
+  NSUInteger	i;
+
+  for (i = 0; i < b->used; i++)
+    {
+      cFree(b->zone, &b->c[i]);
+    }
+  if (b->c != 0)
+    {
+      NSZoneFree(b->zone, b->c);
+    }
+  NSZoneFree(b->zone, b);
+}
+
+void
+GSIndexBitmapIntersect(GSIndexBitmap *b, GSIndexBitmap *o)
+{
+  NSUInteger	i;
+  NSUInteger	j = 0;
+
+  b->count = 0;
+  for (i = 0; i < b->used; i++)
+    {
+      Container	*c = &b->c[i];
+
+      while (j < o->used && o->c[j].key < c->key)
+	{
+	  j++;
+	}
+      if (j < o->used && o->c[j].key == c->key)
+	{
+	  cIntersect(b->zone, c, &o->c[j]);
+	}
+      else
+	{
+	  cFree(b->zone, c);
+	}
+      b->count += c->card;
+    }
+  compact(b, 0);
+}
+
+NSUInteger
+GSIndexBitmapNext(GSIndexBitmap *b, NSUInteger index)
+{
+  NSUInteger	p = findKey(b, KEY(index));
+
+  if (p < b->used && b->c[p].key == KEY(index))
+    {
+      int32_t	v = cNext(&b->c[p], LOW(index));
+
+      if (v >= 0)
+	{
+	  return INDEX(b->c[p].key, v);
+	}
+      p++;
+    }
+  if (p < b->used)
+    {
+      return INDEX(b->c[p].key, cNext(&b->c[p], 0));
+    }
+  return NSNotFound;
+}
+
+NSUInteger
+GSIndexBitmapPrevious(GSIndexBitmap *b, NSUInteger index)
+{
+  NSUInteger	p = findKey(b, KEY(index) + 1);
+
+  if (p-- == 0)
+    {
+      return NSNotFound;
+    }
+  if (b->c[p].key == KEY(index))
+    {
+      int32_t	v = cPrevious(&b->c[p], LOW(index));
+
+      if (v >= 0)
+	{
+	  return INDEX(b->c[p].key, v);
+	}
+      if (p-- == 0)
+	{
+	  return NSNotFound;
+	}
+    }
+  return INDEX(b->c[p].key, cPrevious(&b->c[p], 0xffff));
+}
+
+NSRange
+GSIndexBitmapRangeFrom(GSIndexBitmap *b, NSUInteger index)
+{
+  GSIndexBitmapCursor	cur;
+
+  GSIndexBitmapCursorInit(&cur, b, index);
+  return GSIndexBitmapCursorNext(&cur);
+}
+
+void
+GSIndexBitmapRemoveRange(GSIndexBitmap *b, NSRange aRange)
+{
+  NSUInteger	lo = aRange.location;
+  NSUInteger	hi = NSMaxRange(aRange) - 1;
+  NSUInteger	p0 = findKey(b, KEY(lo));
+  NSUInteger	p;
+
+  for (p = p0; p < b->used && b->c[p].key <= KEY(hi); p++)
+    {
+      Container	*c = &b->c[p];
+      uint32_t	clo = (c->key == KEY(lo)) ? LOW(lo) : 0;
+      uint32_t	chi = (c->key == KEY(hi)) ? LOW(hi) : 0xffff;
+
+      b->count -= cRemoveRange(b->zone, c, clo, chi);
+    }
+  compact(b, p0);
+}
+
+void
+GSIndexBitmapSubtract(GSIndexBitmap *b, GSIndexBitmap *o)
+{
+  NSUInteger	i;
+  NSUInteger	j = 0;
+
+  b->count = 0;
+  for (i = 0; i < b->used; i++)
+    {
+      Container	*c = &b->c[i];
+
+      while (j < o->used && o->c[j].key < c->key)
+	{
+	  j++;
+	}
+      if (j < o->used && o->c[j].key == c->key)
+	{
+	  cSubtract(b->zone, c, &o->c[j]);
+	}
+      b->count += c->card;
+    }
+  compact(b, 0);
+}
+
+void
+GSIndexBitmapUnion(GSIndexBitmap *b, GSIndexBitmap *o)
+{
+  Container	*m;
+  NSUInteger	cap = b->used + o->used;
+  NSUInteger	i = 0;
+  NSUInteger	j = 0;
+  NSUInteger	n = 0;
+
+  if (0 == o->used)
+    {
+      return;
+    }
+  m = NSZoneMalloc(b->zone, cap * sizeof(Container));
+  b->count = 0;
+  while (i < b->used || j < o->used)
+    {
+      if (j == o->used || (i < b->used && b->c[i].key < o->c[j].key))
+	{
+	  m[n] = b->c[i++];
+	}
+      else if (i == b->used || o->c[j].key < b->c[i].key)
+	{
+	  cCopy(b->zone, &m[n], &o->c[j++]);
+	}
+      else
+	{
+	  m[n] = b->c[i++];
+	  cUnion(b->zone, &m[n], &o->c[j++]);
+	}
+      b->count += m[n++].card;
+    }
+  if (b->c != 0)
+    {
+      NSZoneFree(b->zone, b->c);
+    }
+  b->c = m;
+  b->used = n;
+  b->cap = cap;
+}
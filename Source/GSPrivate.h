@@ -31,7 +31,10 @@
 @class	_GSInsensitiveDictionary;
 @class	_GSMutableInsensitiveDictionary;
 
+@class	NSDate;
+@class	NSMutableData;
 @class	NSNotification;
+@class	NSTimeZone;
 
 #if ( (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 3) ) && HAVE_VISIBILITY_ATTRIBUTE )
 #define GS_ATTRIB_PRIVATE __attribute__ ((visibility("internal")))
@@ -53,6 +56,50 @@
 
 NSTimeInterval   GSPrivateTimeNow() GS_ATTRIB_PRIVATE;
 
+/* Convert a time interval since the reference date into broken out
+ * elements (implemented in NSCalendarDate.m, used by NSTimeZone.m).
+ */
+void GSBreakTime(NSTimeInterval when, int *year, int *month, int *day,
+  int *hour, int *minute, int *second, int *mil) GS_ATTRIB_PRIVATE;
+
+/* A date pattern (in the Unicode syntax used by NSDateFormatter) made up
+ * only of fixed width numbers, english day and month abbreviations,
+ * numeric time zone offsets and literal text, as used for ISO-8601 and
+ * RFC-1123 timestamps.  Dates in such a pattern can be formatted into
+ * and parsed from byte buffers directly (implemented in NSCalendarDate.m)
+ * giving the same results as ICU would.
+ */
+#define	GS_FIXED_DATE_FIELDS	32	/* Most fields in a pattern	*/
+#define	GS_FIXED_DATE_LENGTH	128	/* Longest formatted date	*/
+typedef struct {
+  uint8_t	count;			/* Number of fields (0 if unusable) */
+  uint8_t	hasNames;		/* Uses english day/month names	*/
+  uint16_t	seen;			/* Bitmap of kinds of field	*/
+  uint8_t	kind[GS_FIXED_DATE_FIELDS];
+  uint8_t	arg[GS_FIXED_DATE_FIELDS];	/* Literal char or digits */
+} GSFixedDateFormat;
+
+/* Compiles pattern into f, returning NO if it is not a fixed pattern.
+ */
+BOOL GSPrivateFixedDateCompile(NSString *pattern, GSFixedDateFormat *f)
+  GS_ATTRIB_PRIVATE;
+
+/* Formats date in the time zone tz into buf (at least GS_FIXED_DATE_LENGTH
+ * bytes) and returns the length, or returns zero if the date can't be
+ * formatted exactly as ICU would (eg. it's before the gregorian calendar).
+ */
+NSUInteger GSPrivateFixedDateFormat(const GSFixedDateFormat *f,
+  NSDate *date, NSTimeZone *tz, char *buf) GS_ATTRIB_PRIVATE;
+
+/* Parses length bytes from buf as a date in the time zone tz (used if
+ * the pattern has no offset), setting *since1970 to the result in whole
+ * milliseconds as ICU would.  Returns NO if the bytes do not exactly
+ * match the pattern with valid values for each field.
+ */
+BOOL GSPrivateFixedDateParse(const GSFixedDateFormat *f,
+  const char *buf, NSUInteger length, NSTimeZone *tz,
+  NSTimeInterval *since1970) GS_ATTRIB_PRIVATE;
+
 #include "GNUstepBase/GSObjCRuntime.h"
 
 #include "Foundation/NSArray.h"
@@ -78,6 +125,7 @@ typedef struct objc_category* Category;
   unsigned	_capacity;
   int		_grow_factor;
   unsigned long		_version;
+  unsigned	_offset;	/* Unused slots before _contents_array	*/
 }
 @end
 
@@ -233,6 +281,7 @@ typedef enum {
   GSOldStyleGeometry,			// Control geometry string output.
   GSLogSyslog,				// Force logging to go to syslog.
   GSLogThread,				// Include thread ID in log message.
+  GSLogAsynchronous,			// Write log messages in background.
   NSWriteOldStylePropertyLists,		// Control PList output.
   GSUserDefaultMaxFlag			// End marker.
 } GSUserDefaultFlagType;
@@ -285,6 +334,10 @@ typedef enum {
   int                   inputFd;
   int                   outputFd;
 #endif	
+  /* Counters updated by the loop's own thread as it handles events.
+   */
+  NSUInteger            events;         /* Events (ready inputs) handled. */
+  NSTimeInterval        busy;           /* Time spent handling them.      */
 }
 /* Add a performer to be run in the loop's thread.  May be called from
  * any thread.
@@ -297,6 +350,10 @@ typedef enum {
 /* Cancel all pending performers.
  */
 - (void) invalidate;
+/* Return the number of performers waiting to be run.  May be called from
+ * any thread.
+ */
+- (NSUInteger) pending;
 @end
 
 /* Return (and optionally create) GSRunLoopThreadInfo for the specified
@@ -318,6 +375,28 @@ GSPrivateArgZero() GS_ATTRIB_PRIVATE;
 NSStringEncoding *
 GSPrivateAvailableEncodings() GS_ATTRIB_PRIVATE;
 
+/* Base64 encodes length bytes from src into dst, which must have space
+ * for 4 * ((length + 2) / 3) bytes, padding the output with '='.
+ * Returns the number of bytes written.
+ */
+NSUInteger
+GSPrivateBase64Encode(uint8_t *dst, const uint8_t *src, NSUInteger length)
+  GS_ATTRIB_PRIVATE;
+
+/* Decodes the longest leading run of src made of complete groups of four
+ * characters from the standard base64 alphabet, writing three bytes to
+ * dst for each group.  Stops at the first group containing any other
+ * character (including padding and white space) so that the caller can
+ * deal with it.  Returns the number of characters consumed.
+ */
+NSUInteger
+GSPrivateBase64DecodeRun(uint8_t *dst, const uint8_t *src, NSUInteger length)
+  GS_ATTRIB_PRIVATE;
+
+/* The value of each character in the standard base64 alphabet, or -1.
+ */
+extern const signed char	GSPrivateBase64Values[256] GS_ATTRIB_PRIVATE;
+
 /* Initialise constant strings
  */
 void
@@ -359,10 +438,90 @@ GSPrivateEnvironmentFlag(const char *name, BOOL def) GS_ATTRIB_PRIVATE;
 NSString *
 GSPrivateExecutablePath(void) GS_ATTRIB_PRIVATE;
 
+/* Return a pointer to at least size bytes of unused capacity at the end
+ * of a mutable data object, growing its buffer (geometrically) if needed,
+ * so that data can be read directly into the object.  Returns NULL if the
+ * object is not of a concrete class which supports this.
+ * After writing into the space, use GSPrivateDataExtend() to add the
+ * bytes written to the length of the data (without clearing them).
+ */
+void *
+GSPrivateDataSpace(NSMutableData *d, NSUInteger size) GS_ATTRIB_PRIVATE;
+
+void
+GSPrivateDataExtend(NSMutableData *d, NSUInteger size) GS_ATTRIB_PRIVATE;
+
 /* Format arguments into an internal string.
+ * The parsed form of a constant (compiler generated) format string is
+ * cached, so repeated use of the same literal format is cheap.
+ */
+void
+GSPrivateFormat(GSStr fb, NSString *fmt, va_list ap, NSDictionary *loc)
+  GS_ATTRIB_PRIVATE;
+
+/* Decodes the longest leading run of src made of pairs of hexadecimal
+ * digits (of either case), writing one byte to dst for each pair.
+ * Returns the number of characters consumed.
+ */
+NSUInteger
+GSPrivateHexDecodeRun(uint8_t *dst, const uint8_t *src, NSUInteger length)
+  GS_ATTRIB_PRIVATE;
+
+/* Writes two hexadecimal digits (using upper or lower case letters) to
+ * dst for each of the length bytes in src.
  */
 void
-GSPrivateFormat(GSStr fb, const unichar *fmt, va_list ap, NSDictionary *loc)
+GSPrivateHexEncode(uint8_t *dst, const uint8_t *src, NSUInteger length,
+  BOOL upper) GS_ATTRIB_PRIVATE;
+
+/* Returns the length of the leading run of src which is ASCII (bytes
+ * below 0x80).
+ */
+NSUInteger
+GSPrivateASCIIPrefix(const uint8_t *src, NSUInteger length)
+  GS_ATTRIB_PRIVATE;
+
+/* Returns the number of bytes needed to hold length ISO-8859-1
+ * characters from src as UTF-8.
+ */
+NSUInteger
+GSPrivateLatin1UTF8Length(const uint8_t *src, NSUInteger length)
+  GS_ATTRIB_PRIVATE;
+
+/* Converts length ISO-8859-1 characters from src to UTF-8 in dst, which
+ * must have space for GSPrivateLatin1UTF8Length() bytes.
+ * Returns the number of bytes written.
+ */
+NSUInteger
+GSPrivateLatin1ToUTF8(uint8_t *dst, const uint8_t *src, NSUInteger length)
+  GS_ATTRIB_PRIVATE;
+
+/* Converts length bytes of UTF-8 from src to ISO-8859-1 in dst, which
+ * must have space for length bytes.  Returns the number of characters
+ * written, or NSNotFound if src holds anything other than well formed
+ * UTF-8 for characters in the ISO-8859-1 range.
+ */
+NSUInteger
+GSPrivateUTF8ToLatin1(uint8_t *dst, const uint8_t *src, NSUInteger length)
+  GS_ATTRIB_PRIVATE;
+
+/* Returns the number of UTF-16 characters in length bytes of UTF-8 from
+ * src, or NSNotFound if it would be rejected by GSPrivateUTF8ToUnicode().
+ * If latin1 is not null, sets it to say whether every character is in
+ * the ISO-8859-1 range.
+ */
+NSUInteger
+GSPrivateUTF8Length(const uint8_t *src, NSUInteger length, BOOL *latin1)
+  GS_ATTRIB_PRIVATE;
+
+/* Converts length bytes of UTF-8 from src to UTF-16 in dst, which must
+ * have space for length characters.  Returns the number of characters
+ * written, or NSNotFound if src is not well formed (overlong forms,
+ * surrogates, values above 0x10ffff or truncated sequences) or holds
+ * one of the non-characters GSToUnicode() rejects.
+ */
+NSUInteger
+GSPrivateUTF8ToUnicode(unichar *dst, const uint8_t *src, NSUInteger length)
   GS_ATTRIB_PRIVATE;
 
 /* determine whether data in a particular encoding can
@@ -383,6 +542,12 @@ GSPrivateLoadModule(NSString *filename, FILE *errorStream,
   void (*loadCallback)(Class, struct objc_category *),
   void **header, NSString *debugFilename) GS_ATTRIB_PRIVATE;
 
+/* Write out queued asynchronous log messages when the process is exiting
+ * or has crashed, without waiting indefinitely for the log lock.
+ */
+void
+GSPrivateLogFlushAtExit() GS_ATTRIB_PRIVATE;
+
 /* Get the native C-string encoding as used by locale specific code in the
  * operating system.  This may differ from the default C-string encoding
  * if the latter has bewen set via an environment variable.
@@ -427,6 +592,14 @@ void
 GSPrivateStrAppendUnichars(GSStr s, const unichar *u, unsigned l)
   GS_ATTRIB_PRIVATE;
 
+/* Function to append the first l characters of another string to a GSStr
+ * by copying 8-bit data directly.  Returns NO (and appends nothing) if
+ * the source string is not suitable for a direct byte copy.
+ */
+BOOL
+GSPrivateStrAppendString(GSStr s, NSString *str, unsigned l)
+  GS_ATTRIB_PRIVATE;
+
 /* Make the content of this string into unicode if it is not in
  * the external defaults C string encoding.
  */
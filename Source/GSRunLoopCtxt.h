@@ -45,6 +45,7 @@
 #endif
 
 #include "GNUstepBase/GSIArray.h"
+#include "GSTimerHeap.h"
 
 #ifdef  HAVE_POLL
 typedef struct{
@@ -63,7 +64,7 @@ typedef struct{
   NSString	*mode;		/** The mode for this context.		*/
   GSIArray	performers;	/** The actions to perform regularly.	*/
   unsigned	maxPerformers;
-  GSIArray	timers;		/** The timers set for the runloop mode */
+  GSTimerHeap	timers;		/** The timers set for the runloop mode */
   unsigned	maxTimers;
   GSIArray	watchers;	/** The inputs set for the runloop mode */
   unsigned	maxWatchers;
@@ -0,0 +1,655 @@
+/** Implementation of a pool of threads running run loops for I/O
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNUstep Base Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02111 USA.
+
+   <title>GSRunLoopPool class reference</title>
+*/
+
+#import "common.h"
+#import "Foundation/NSArray.h"
+#import "Foundation/NSAutoreleasePool.h"
+#import "Foundation/NSDictionary.h"
+#import "Foundation/NSException.h"
+#import "Foundation/NSLock.h"
+#import "Foundation/NSMapTable.h"
+#import "Foundation/NSProcessInfo.h"
+#import "Foundation/NSRunLoop.h"
+#import "Foundation/NSStream.h"
+#import "Foundation/NSThread.h"
+#import "Foundation/NSTimer.h"
+#import "Foundation/NSValue.h"
+#import "GNUstepBase/GSRunLoopPool.h"
+#import "GSPrivate.h"
+
+/* One thread of the pool and its run loop.
+ * The pool pointer is cleared (with the lock held) when the pool is
+ * invalidated, so a thread which still has work queued for it only
+ * uses the pool while holding the lock and finding it set.
+ */
+@interface	GSRunLoopPoolLoop : NSObject
+{
+@public
+  GSRunLoopPool		*pool;		/* Not retained.		*/
+  NSLock		*lock;		/* The pool's lock.		*/
+  NSThread		*thread;
+  NSRunLoop		*loop;		/* Set by the thread.		*/
+  GSRunLoopThreadInfo	*info;		/* Set by the thread.		*/
+  NSConditionLock	*started;
+  NSUInteger		objects;	/* Objects scheduled here.	*/
+  NSTimeInterval	when;		/* When statistics were taken.	*/
+  NSUInteger		lastEvents;
+  NSTimeInterval	lastBusy;
+}
+- (void) attach: (NSArray*)streams;
+- (void) detach: (NSStream*)aStream;
+@end
+
+/* Where an object is scheduled.  The loop is where the object is
+ * counted (and where it is going, if it is being moved), while home
+ * is the loop it is actually in, or which it is leaving.
+ * An entry travels with a moving stream, and the move is abandoned if
+ * the entry is no longer the one in the pool when it gets there.
+ */
+@interface	GSRunLoopPoolEntry : NSObject
+{
+@public
+  id			object;
+  GSRunLoopPoolLoop	*loop;
+  GSRunLoopPoolLoop	*home;
+  BOOL			moving;
+}
+@end
+
+@interface	GSRunLoopPoolLoop (Moving)
+- (void) moveIn: (GSRunLoopPoolEntry*)e;
+- (void) moveOut: (GSRunLoopPoolEntry*)e;
+@end
+
+@interface	GSRunLoopPool (Private)
+- (GSRunLoopPoolLoop*) _arrived: (GSRunLoopPoolEntry*)e
+			     in: (GSRunLoopPoolLoop*)l;
+- (NSUInteger) _assign: (NSArray*)objects;
+- (GSRunLoopPoolLoop*) _destination: (GSRunLoopPoolEntry*)e;
+@end
+
+
+@implementation	GSRunLoopPoolEntry
+- (void) dealloc
+{
+  RELEASE(object);
+  [super dealloc];
+}
+@end
+
+@implementation	GSRunLoopPoolLoop
+
+/* Schedules (and if necessary opens) streams in this thread's loop.
+ */
+- (void) attach: (NSArray*)streams
+{
+  NSUInteger	count = [streams count];
+  NSUInteger	i;
+
+  for (i = 0; i < count; i++)
+    {
+      NSStream	*s = [streams objectAtIndex: i];
+
+      [s scheduleInRunLoop: loop forMode: NSDefaultRunLoopMode];
+      if ([s streamStatus] == NSStreamStatusNotOpen)
+	{
+	  [s open];
+	}
+    }
+}
+
+- (void) dealloc
+{
+  RELEASE(thread);
+  RELEASE(started);
+  RELEASE(lock);
+  [super dealloc];
+}
+
+- (void) detach: (NSStream*)aStream
+{
+  [aStream removeFromRunLoop: loop forMode: NSDefaultRunLoopMode];
+}
+
+- (void) ignore: (NSTimer*)t
+{
+  return;
+}
+
+- (void) run
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSTimer		*timer;
+
+  loop = [NSRunLoop currentRunLoop];
+  info = GSRunLoopInfoForThread(nil);
+  /* A timer which never fires keeps the loop running while nothing
+   * else is scheduled in it.
+   */
+  timer = [[NSTimer alloc] initWithFireDate: [NSDate distantFuture]
+				   interval: 0.0
+				     target: self
+				   selector: @selector(ignore:)
+				   userInfo: nil
+				    repeats: NO];
+  [loop addTimer: timer forMode: NSDefaultRunLoopMode];
+  [started lock];
+  [started unlockWithCondition: 1];
+
+  while ([thread isCancelled] == NO)
+    {
+      NSAutoreleasePool	*pool = [NSAutoreleasePool new];
+
+      [loop runMode: NSDefaultRunLoopMode
+	 beforeDate: [NSDate distantFuture]];
+      [pool release];
+    }
+  [timer invalidate];
+  RELEASE(timer);
+  [arp release];
+}
+
+- (void) wake
+{
+  return;
+}
+
+@end
+
+@implementation	GSRunLoopPoolLoop (Moving)
+
+/* The second half of a move, in the thread of the destination.  If the
+ * stream was moved again while on its way here we pass it on.
+ * While the pool is valid (checked with the lock held) its loops and
+ * their threads are too.
+ */
+- (void) moveIn: (GSRunLoopPoolEntry*)e
+{
+  GSRunLoopPoolLoop	*next = nil;
+
+  [lock lock];
+  if (pool != nil)
+    {
+      next = [pool _arrived: e in: self];
+      if (next != nil && next != self)
+	{
+	  [next performSelector: @selector(moveIn:)
+		       onThread: next->thread
+		     withObject: e
+		  waitUntilDone: NO];
+	}
+    }
+  [lock unlock];
+  if (next == self)
+    {
+      [e->object scheduleInRunLoop: loop forMode: NSDefaultRunLoopMode];
+    }
+}
+
+/* The first half of a move, in the thread of the loop the stream is
+ * leaving, so that no event for it can be in progress.  If the stream
+ * has been unscheduled meanwhile, the -detach: which follows removes it.
+ */
+- (void) moveOut: (GSRunLoopPoolEntry*)e
+{
+  GSRunLoopPoolLoop	*next = nil;
+
+  [lock lock];
+  if (pool != nil)
+    {
+      next = [pool _destination: e];
+      if (next != nil)
+	{
+	  [e->object removeFromRunLoop: loop forMode: NSDefaultRunLoopMode];
+	  [next performSelector: @selector(moveIn:)
+		       onThread: next->thread
+		     withObject: e
+		  waitUntilDone: NO];
+	}
+    }
+  [lock unlock];
+}
+
+@end
+
+
+@implementation	GSRunLoopPool
+
++ (GSRunLoopPool*) sharedPool
+{
+  static GSRunLoopPool	*shared = nil;
+
+  if (shared == nil)
+    {
+      [gnustep_global_lock lock];
+      if (shared == nil)
+	{
+	  NSUInteger	count;
+
+	  count = [[NSProcessInfo processInfo] activeProcessorCount];
+	  shared = [[self alloc] initWithCount: (count > 0) ? count : 1
+					  name: @"GSRunLoopPool"];
+	}
+      [gnustep_global_lock unlock];
+    }
+  return shared;
+}
+
+- (NSUInteger) count
+{
+  return [_loops count];
+}
+
+- (void) dealloc
+{
+  [self invalidate];
+  RELEASE(_loops);
+  if (_objects != 0)
+    {
+      NSFreeMapTable(_objects);
+    }
+  RELEASE(_lock);
+  RELEASE(_name);
+  [super dealloc];
+}
+
+- (NSString*) description
+{
+  return [NSString stringWithFormat: @"%@ %@ (%lu loops)",
+    [super description], _name, (unsigned long)[_loops count]];
+}
+
+- (id) init
+{
+  return [self initWithCount: 1 name: @"GSRunLoopPool"];
+}
+
+- (id) initWithCount: (NSUInteger)count name: (NSString*)aName
+{
+  if ((self = [super init]) != nil)
+    {
+      NSUInteger	i;
+
+      if (count == 0)
+	{
+	  count = 1;
+	}
+      _name = [aName copy];
+      _lock = [NSLock new];
+      _objects = NSCreateMapTable(NSObjectMapKeyCallBacks,
+	NSObjectMapValueCallBacks, 0);
+      _loops = [[NSMutableArray alloc] initWithCapacity: count];
+      for (i = 0; i < count; i++)
+	{
+	  GSRunLoopPoolLoop	*l = [GSRunLoopPoolLoop new];
+
+	  l->pool = self;
+	  l->lock = RETAIN(_lock);
+	  l->when = GSPrivateTimeNow();
+	  l->started = [[NSConditionLock alloc] initWithCondition: 0];
+	  l->thread = [[NSThread alloc] initWithTarget: l
+					      selector: @selector(run)
+						object: nil];
+	  [l->thread setName:
+	    [NSString stringWithFormat: @"%@-%lu", _name, (unsigned long)i]];
+	  [_loops addObject: l];
+	  RELEASE(l);
+	  [l->thread start];
+	}
+      /* Wait for every thread to have a run loop, so that scheduling
+       * in a loop can't happen before it exists.
+       */
+      for (i = 0; i < count; i++)
+	{
+	  GSRunLoopPoolLoop	*l = [_loops objectAtIndex: i];
+
+	  [l->started lockWhenCondition: 1];
+	  [l->started unlock];
+	}
+    }
+  return self;
+}
+
+- (void) invalidate
+{
+  NSUInteger	count = [_loops count];
+  NSUInteger	i;
+
+  /* Once this is done no loop thread will use the pool, so it may be
+   * deallocated while moves are still queued.
+   */
+  [_lock lock];
+  for (i = 0; i < count; i++)
+    {
+      ((GSRunLoopPoolLoop*)[_loops objectAtIndex: i])->pool = nil;
+    }
+  [_lock unlock];
+
+  for (i = 0; i < count; i++)
+    {
+      GSRunLoopPoolLoop	*l = [_loops objectAtIndex: i];
+
+      if ([l->thread isCancelled] == NO)
+	{
+	  [l->thread cancel];
+	  [l performSelector: @selector(wake)
+		    onThread: l->thread
+		  withObject: nil
+	       waitUntilDone: NO];
+	}
+    }
+}
+
+- (NSUInteger) leastLoadedLoop
+{
+  NSUInteger	count = [_loops count];
+  NSUInteger	best = 0;
+  NSUInteger	i;
+
+  [_lock lock];
+  for (i = 1; i < count; i++)
+    {
+      GSRunLoopPoolLoop	*l = [_loops objectAtIndex: i];
+      GSRunLoopPoolLoop	*b = [_loops objectAtIndex: best];
+
+      if (l->objects < b->objects
+	|| (l->objects == b->objects && l->info->busy < b->info->busy))
+	{
+	  best = i;
+	}
+    }
+  [_lock unlock];
+  return best;
+}
+
+- (NSUInteger) loopForObject: (id)anObject
+{
+  GSRunLoopPoolEntry	*e;
+  NSUInteger		index = NSNotFound;
+
+  [_lock lock];
+  e = (GSRunLoopPoolEntry*)NSMapGet(_objects, (void*)anObject);
+  if (e != nil)
+    {
+      index = [_loops indexOfObjectIdenticalTo: e->loop];
+    }
+  [_lock unlock];
+  return index;
+}
+
+- (void) moveStream: (NSStream*)aStream toLoop: (NSUInteger)index
+{
+  GSRunLoopPoolLoop	*target = [_loops objectAtIndex: index];
+  GSRunLoopPoolLoop	*from = nil;
+  GSRunLoopPoolEntry	*e;
+  GSRunLoopPoolEntry	*moving = nil;
+
+  [_lock lock];
+  e = (GSRunLoopPoolEntry*)NSMapGet(_objects, (void*)aStream);
+  if (e == nil)
+    {
+      [_lock unlock];
+      [NSException raise: NSInvalidArgumentException
+		  format: @"[%@-%@] stream is not scheduled in the pool",
+	NSStringFromClass([self class]), NSStringFromSelector(_cmd)];
+    }
+  e->loop->objects--;
+  target->objects++;
+  e->loop = target;
+  /* If a move is already under way, the stream will go on to the new
+   * destination when it arrives at the old one.
+   */
+  if (e->moving == NO && e->home != target)
+    {
+      e->moving = YES;
+      from = e->home;
+      moving = RETAIN(e);
+    }
+  [_lock unlock];
+
+  if (from != nil)
+    {
+      [from performSelector: @selector(moveOut:)
+		   onThread: from->thread
+		 withObject: moving
+	      waitUntilDone: NO];
+      RELEASE(moving);
+    }
+}
+
+- (NSRunLoop*) runLoopAtIndex: (NSUInteger)index
+{
+  return ((GSRunLoopPoolLoop*)[_loops objectAtIndex: index])->loop;
+}
+
+- (NSUInteger) scheduleInputStream: (NSInputStream*)input
+		      outputStream: (NSOutputStream*)output
+{
+  NSMutableArray	*a = [NSMutableArray arrayWithCapacity: 2];
+  NSUInteger		index;
+  GSRunLoopPoolLoop	*l;
+
+  if (input != nil)
+    {
+      [a addObject: input];
+    }
+  if (output != nil)
+    {
+      [a addObject: output];
+    }
+  index = [self _assign: a];
+  l = [_loops objectAtIndex: index];
+  [l performSelector: @selector(attach:)
+	    onThread: l->thread
+	  withObject: a
+       waitUntilDone: NO];
+  return index;
+}
+
+- (NSUInteger) scheduleObject: (id)anObject
+		   performing: (SEL)aSelector
+		   withObject: (id)anArgument
+{
+  NSUInteger		index;
+  GSRunLoopPoolLoop	*l;
+
+  index = [self _assign: [NSArray arrayWithObject: anObject]];
+  l = [_loops objectAtIndex: index];
+  [anObject performSelector: aSelector
+		   onThread: l->thread
+		 withObject: anArgument
+	      waitUntilDone: NO];
+  return index;
+}
+
+- (NSUInteger) scheduleStream: (NSStream*)aStream
+{
+  NSArray		*a = [NSArray arrayWithObject: aStream];
+  NSUInteger		index;
+  GSRunLoopPoolLoop	*l;
+
+  index = [self _assign: a];
+  l = [_loops objectAtIndex: index];
+  [l performSelector: @selector(attach:)
+	    onThread: l->thread
+	  withObject: a
+       waitUntilDone: NO];
+  return index;
+}
+
+- (NSArray*) statistics
+{
+  NSUInteger		count = [_loops count];
+  NSMutableArray	*a = [NSMutableArray arrayWithCapacity: count];
+  NSTimeInterval	now = GSPrivateTimeNow();
+  NSUInteger		i;
+
+  [_lock lock];
+  for (i = 0; i < count; i++)
+    {
+      GSRunLoopPoolLoop	*l = [_loops objectAtIndex: i];
+      NSUInteger	events = l->info->events;
+      NSTimeInterval	busy = l->info->busy;
+      NSTimeInterval	interval = now - l->when;
+      double		rate = 0.0;
+      double		fraction = 0.0;
+
+      if (interval > 0.0)
+	{
+	  rate = (events - l->lastEvents) / interval;
+	  fraction = (busy - l->lastBusy) / interval;
+	}
+      l->when = now;
+      l->lastEvents = events;
+      l->lastBusy = busy;
+      [a addObject: [NSDictionary dictionaryWithObjectsAndKeys:
+	[NSNumber numberWithUnsignedInteger: l->objects], @"Objects",
+	[NSNumber numberWithUnsignedInteger: events], @"Events",
+	[NSNumber numberWithDouble: rate], @"EventsPerSecond",
+	[NSNumber numberWithDouble: busy], @"CallbackTime",
+	[NSNumber numberWithDouble: fraction], @"Busy",
+	[NSNumber numberWithUnsignedInteger: [l->info pending]], @"QueueDepth",
+	nil]];
+    }
+  [_lock unlock];
+  return a;
+}
+
+- (NSThread*) threadAtIndex: (NSUInteger)index
+{
+  return ((GSRunLoopPoolLoop*)[_loops objectAtIndex: index])->thread;
+}
+
+- (void) unscheduleObject: (id)anObject
+{
+  GSRunLoopPoolEntry	*e;
+  GSRunLoopPoolLoop	*home = nil;
+
+  [_lock lock];
+  e = (GSRunLoopPoolEntry*)NSMapGet(_objects, (void*)anObject);
+  if (e != nil)
+    {
+      e->loop->objects--;
+      /* A moving stream is still in (or has just left) its home loop,
+       * and any move still queued is abandoned when it finds the entry
+       * gone, so we always detach from home.
+       */
+      if (e->home->pool != nil && [anObject isKindOfClass: [NSStream class]])
+	{
+	  home = e->home;
+	}
+      RETAIN(e);	/* Keep anObject until it is detached.	*/
+      NSMapRemove(_objects, (void*)anObject);
+    }
+  [_lock unlock];
+
+  if (home != nil)
+    {
+      /* Wait, so that the stream may be scheduled again (perhaps in
+       * another loop) as soon as we return.
+       */
+      [home performSelector: @selector(detach:)
+		   onThread: home->thread
+		 withObject: anObject
+	      waitUntilDone: YES];
+    }
+  RELEASE(e);
+}
+
+@end
+
+@implementation	GSRunLoopPool (Private)
+
+/* A moving stream has reached l.  Returns l if it should stay there,
+ * the loop it should go on to if it was moved again, or nil if it has
+ * been removed from the pool.  Called with the lock held.
+ */
+- (GSRunLoopPoolLoop*) _arrived: (GSRunLoopPoolEntry*)e
+			     in: (GSRunLoopPoolLoop*)l
+{
+  GSRunLoopPoolLoop	*next = nil;
+
+  if (NSMapGet(_objects, (void*)e->object) == (void*)e)
+    {
+      next = e->loop;
+      if (next == l)
+	{
+	  e->home = l;
+	  e->moving = NO;
+	}
+    }
+  return next;
+}
+
+/* Records objects as scheduled in the least loaded loop.
+ */
+- (NSUInteger) _assign: (NSArray*)objects
+{
+  NSUInteger		count = [objects count];
+  NSUInteger		index;
+  NSUInteger		i;
+  GSRunLoopPoolLoop	*l;
+
+  index = [self leastLoadedLoop];
+  l = [_loops objectAtIndex: index];
+  [_lock lock];
+  for (i = 0; i < count; i++)
+    {
+      id	o = [objects objectAtIndex: i];
+
+      if (NSMapGet(_objects, (void*)o) != 0)
+	{
+	  [_lock unlock];
+	  [NSException raise: NSInvalidArgumentException
+		      format: @"[%@-%@] %@ is already scheduled",
+	    NSStringFromClass([self class]), NSStringFromSelector(_cmd), o];
+	}
+    }
+  for (i = 0; i < count; i++)
+    {
+      GSRunLoopPoolEntry	*e = [GSRunLoopPoolEntry new];
+
+      e->object = RETAIN([objects objectAtIndex: i]);
+      e->loop = l;
+      e->home = l;
+      NSMapInsert(_objects, (void*)[objects objectAtIndex: i], (void*)e);
+      RELEASE(e);
+      l->objects++;
+    }
+  [_lock unlock];
+  return index;
+}
+
+/* A stream is leaving its loop.  Returns the loop it is to go to, or
+ * nil if it has been removed from the pool.  Called with the lock held.
+ */
+- (GSRunLoopPoolLoop*) _destination: (GSRunLoopPoolEntry*)e
+{
+  if (NSMapGet(_objects, (void*)e->object) == (void*)e)
+    {
+      return e->loop;
+    }
+  return nil;
+}
+
+@end
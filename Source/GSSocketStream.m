@@ -438,6 +438,7 @@ static NSArray  *keys = nil;
         GSTLSPriority,
         GSTLSRemoteHosts,
         GSTLSRevokeFile,
+        GSTLSSessionKey,
         GSTLSVerify,
         nil];
     }
@@ -567,7 +568,31 @@ static NSArray  *keys = nil;
       if (nil == str) str = [i propertyForKey: key];
       if (nil != str) [opts setObject: str forKey: key];
     }
-  
+
+  /* An outgoing session may be resumed by a later connection to the
+   * same remote end (and for the same host names, since those are
+   * used to verify the certificate).
+   */
+  if (NO == server && nil == [opts objectForKey: GSTLSSessionKey])
+    {
+      struct sockaddr   *sa = [i _address];
+
+      if (AF_INET == sa->sa_family
+#if     defined(AF_INET6)
+        || AF_INET6 == sa->sa_family
+#endif
+        )
+        {
+          str = GSPrivateSockaddrName(sa);
+          if (nil != [opts objectForKey: GSTLSRemoteHosts])
+            {
+              str = [NSString stringWithFormat: @"%@@%@",
+                [opts objectForKey: GSTLSRemoteHosts], str];
+            }
+          [opts setObject: str forKey: GSTLSSessionKey];
+        }
+    }
+
   session = [[GSTLSSession alloc] initWithOptions: opts
                                         direction: (server ? NO : YES)
                                         transport: (void*)self
@@ -2462,6 +2487,19 @@ setNonBlocking(SOCKET fd)
     }
 #endif
 
+#ifdef	SO_REUSEPORT
+  if ([[self propertyForKey: GSStreamReusePortKey] boolValue] == YES)
+    {
+      int	status = 1;
+
+      /* Several listeners have asked to share this port, and the
+       * kernel will balance incoming connections between them.
+       */
+      setsockopt([self _sock], SOL_SOCKET, SO_REUSEPORT,
+        (char *)&status, sizeof(status));
+    }
+#endif
+
   bindReturn = bind([self _sock],
     &_address.s, GSPrivateSockaddrLength(&_address.s));
   if (socketError(bindReturn))
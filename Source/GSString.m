@@ -555,6 +555,38 @@ instance.
 }
 @end
 
+/*
+GSUTF8String, a concrete class holding well formed UTF-8, used for text
+created from UTF-8 which will not fit in the internal 8-bit encoding.
+Keeping the UTF-8 saves widening mostly ASCII text to twice its size in
+UTF-16, and lets -UTF8String return the contents directly.  It is not a
+subclass of GSString, since the code in this file takes any GSString to
+hold its characters in _contents.
+
+Characters before the first non-ASCII byte are found directly.  Beyond
+that the first lookup builds a table (breadcrumbs) of the byte offset
+of every GSUTF8_STRIDE'th character, so that any character is found by
+decoding at most that many characters from the nearest breadcrumb.
+*/
+#define	GSUTF8_STRIDE	32
+
+@interface GSUTF8String : NSString
+{
+@public
+  uint8_t	*_bytes;
+  NSUInteger	_size;		// Bytes of UTF-8
+  NSUInteger	_count;		// Number of UTF-16 characters
+  NSUInteger	_ascii;		// Number of leading ASCII characters
+  NSUInteger	*_crumbs;	// Offsets doubled, plus 1 if at a low surrogate
+  struct {
+    unsigned int	owned: 1;	// Set if we must free _bytes
+    unsigned int	terminated: 1;	// Set if _bytes[_size] is a nul
+    unsigned int	unused: 2;
+    unsigned int	hash: 28;
+  } _flags;
+}
+@end
+
 /*
  *	Include sequence handling code with instructions to generate search
  *	and compare functions for NSString objects.
@@ -611,6 +643,7 @@ static Class GSUnicodeStringClass = 0;
 static Class GSUnicodeBufferStringClass = 0;
 static Class GSUnicodeSubStringClass = 0;
 static Class GSUInlineStringClass = 0;
+static Class GSUTF8StringClass = 0;
 static Class GSMutableStringClass = 0;
 static Class NSConstantStringClass = 0;
 
@@ -664,6 +697,7 @@ setup(BOOL rerun)
       GSUInlineStringClass = [GSUInlineString class];
       GSCSubStringClass = [GSCSubString class];
       GSUnicodeSubStringClass = [GSUnicodeSubString class];
+      GSUTF8StringClass = [GSUTF8String class];
       GSMutableStringClass = [GSMutableString class];
       NSConstantStringClass = [NXConstantString class];
 
@@ -719,6 +753,161 @@ newUInline(unsigned length, NSZone *zone)
   return me;
 }
 
+static GSUTF8String*
+newUTF8(uint8_t *bytes, NSUInteger size, NSUInteger count, NSUInteger ascii,
+  BOOL owned, BOOL terminated, NSZone *zone)
+{
+  GSUTF8String	*me;
+
+  me = (GSUTF8String*)NSAllocateObject(GSUTF8StringClass, 0, zone);
+  me->_bytes = bytes;
+  me->_size = size;
+  me->_count = count;
+  me->_ascii = ascii;
+  me->_flags.owned = owned;
+  me->_flags.terminated = terminated;
+  return me;
+}
+
+/* Builds the breadcrumbs for a UTF-8 string.  The string is immutable,
+ * so if another thread gets there first we just use its table.
+ */
+static NSUInteger*
+crumbsUTF8(GSUTF8String *s)
+{
+  NSUInteger	n = (s->_count + GSUTF8_STRIDE - 1) / GSUTF8_STRIDE;
+  NSUInteger	*crumbs;
+  NSUInteger	offset = 0;
+  NSUInteger	pos = 0;
+  NSUInteger	k;
+
+  crumbs = NSZoneMalloc(NSDefaultMallocZone(), n * sizeof(NSUInteger));
+  for (k = 0; k < n; k++)
+    {
+      NSUInteger	target = k * GSUTF8_STRIDE;
+
+      for (;;)
+	{
+	  uint8_t	c = s->_bytes[offset];
+	  NSUInteger	w = (c >= 0xf0) ? 2 : 1;
+
+	  if (pos + w > target)
+	    {
+	      break;
+	    }
+	  pos += w;
+	  offset += UTF8_BYTE_COUNT(c);
+	}
+      crumbs[k] = (offset << 1) | ((pos == target) ? 0 : 1);
+    }
+  if (NO == __sync_bool_compare_and_swap(&s->_crumbs, 0, crumbs))
+    {
+      NSZoneFree(NSDefaultMallocZone(), crumbs);
+    }
+  return s->_crumbs;
+}
+
+/* Returns the offset of the UTF-8 sequence for the character at index,
+ * setting *low to say whether that character is the second half of a
+ * surrogate pair.  An index at the end of the string gives its size.
+ */
+static NSUInteger
+offsetUTF8(GSUTF8String *s, NSUInteger index, BOOL *low)
+{
+  NSUInteger	*crumbs;
+  NSUInteger	offset;
+  NSUInteger	pos;
+  NSUInteger	k;
+
+  *low = NO;
+  if (index < s->_ascii)
+    {
+      return index;
+    }
+  if (index >= s->_count)
+    {
+      return s->_size;
+    }
+  if ((crumbs = s->_crumbs) == 0)
+    {
+      crumbs = crumbsUTF8(s);
+    }
+  k = index / GSUTF8_STRIDE;
+  offset = crumbs[k] >> 1;
+  pos = k * GSUTF8_STRIDE - (crumbs[k] & 1);
+  for (;;)
+    {
+      uint8_t		c = s->_bytes[offset];
+      NSUInteger	w = (c >= 0xf0) ? 2 : 1;
+
+      if (pos + w > index)
+	{
+	  *low = (pos == index) ? NO : YES;
+	  return offset;
+	}
+      pos += w;
+      offset += UTF8_BYTE_COUNT(c);
+    }
+}
+
+/* Decodes count characters of well formed UTF-8 from p into buf, where
+ * low says to start with the second half of the first surrogate pair.
+ */
+static void
+charactersUTF8(const uint8_t *p, unichar *buf, NSUInteger count, BOOL low)
+{
+  unichar	*end = buf + count;
+
+  while (buf < end)
+    {
+      uint32_t	u = *p;
+
+      if (u < 0x80)
+	{
+	  NSUInteger	n;
+	  NSUInteger	i;
+
+	  /* There are at least as many bytes left as characters wanted.
+	   */
+	  n = GSPrivateASCIIPrefix(p, end - buf);
+	  for (i = 0; i < n; i++)
+	    {
+	      buf[i] = p[i];
+	    }
+	  buf += n;
+	  p += n;
+	  continue;
+	}
+      if (u < 0xe0)
+	{
+	  u = ((u & 0x1f) << 6) | (p[1] & 0x3f);
+	  p += 2;
+	}
+      else if (u < 0xf0)
+	{
+	  u = ((u & 0x0f) << 12) | ((p[1] & 0x3f) << 6) | (p[2] & 0x3f);
+	  p += 3;
+	}
+      else
+	{
+	  u = (((u & 0x07) << 18) | ((p[1] & 0x3f) << 12)
+	    | ((p[2] & 0x3f) << 6) | (p[3] & 0x3f)) - 0x10000;
+	  p += 4;
+	  if (NO == low)
+	    {
+	      *buf++ = 0xd800 + (u >> 10);
+	      if (buf == end)
+		{
+		  break;
+		}
+	    }
+	  u = 0xdc00 + (u & 0x3ff);
+	}
+      *buf++ = u;
+      low = NO;
+    }
+}
+
 /* Predeclare a few functions
  */
 static void GSStrWiden(GSStr s);
@@ -1083,7 +1272,9 @@ fixBOM(unsigned char **bytes, NSUInteger*length, BOOL *owned,
 #if	GS_WITH_GC
 	  chars = NSAllocateCollectable(length, 0);
 #else
-	  chars = NSZoneMalloc([self zone], length);
+	  /* Allow for a nul terminator in case the data is kept as UTF-8.
+	   */
+	  chars = NSZoneMalloc([self zone], length + 1);
 #endif
 	  memcpy(chars, bytes, length);
 	}
@@ -1136,16 +1327,11 @@ fixBOM(unsigned char **bytes, NSUInteger*length, BOOL *owned,
 
   if (encoding == NSUTF8StringEncoding)
     {
-      unsigned i;
+      NSUInteger	ascii = GSPrivateASCIIPrefix(chars.c, length);
+      NSUInteger	count;
+      BOOL		latin1;
 
-      for (i = 0; i < length; i++)
-        {
-	  if ((chars.c)[i] > 127)
-	    {
-	      break;
-	    }
-        }
-      if (i == length)
+      if (ascii == length)
 	{
 	  /*
 	   * This is actually ASCII data ... so we can just store it as if
@@ -1153,26 +1339,62 @@ fixBOM(unsigned char **bytes, NSUInteger*length, BOOL *owned,
 	   */
 	  encoding = internalEncoding;
 	}
+      else if ((count = GSPrivateUTF8Length(chars.c + ascii, length - ascii,
+	&latin1)) == NSNotFound)
+	{
+	  /*
+	   * Not well formed, so leave it to GSToUnicode() below to
+	   * decide whether to accept it.
+	   */
+	}
+      else if (YES == latin1 && internalEncoding == NSISOLatin1StringEncoding)
+	{
+	  uint8_t	*l = NSZoneMalloc([self zone], length);
+
+	  /*
+	   * All the characters are in ISO-8859-1, so we can decode them
+	   * straight into the internal 8bit encoding.
+	   */
+	  length = GSPrivateUTF8ToLatin1(l, chars.c, length);
+	  if (flag == YES)
+	    {
+	      NSZoneFree(NSZoneFromPointer(chars.c), chars.c);
+	    }
+	  chars.c = l;
+	  flag = YES;
+	  encoding = internalEncoding;
+	}
+      else
+	{
+	  BOOL	terminated = NO;
+
+	  /*
+	   * Keep the UTF-8 rather than widening it to UTF-16.  If we own
+	   * the buffer we can add a nul terminator for -UTF8String.
+	   */
+	  if (flag == YES)
+	    {
+	      chars.c = NSZoneRealloc(NSZoneFromPointer(chars.c), chars.c,
+		length + 1);
+	      chars.c[length] = '\0';
+	      terminated = YES;
+	    }
+	  return (id)newUTF8(chars.c, length, ascii + count, ascii,
+	    flag, terminated, [self zone]);
+	}
     }
   else if (encoding != internalEncoding && isByteEncoding(encoding) == YES)
     {
-      unsigned i;
+      NSUInteger	i = GSPrivateASCIIPrefix(chars.c, length);
 
-      for (i = 0; i < length; i++)
-        {
-	  if ((chars.c)[i] > 127)
+      if (i < length && encoding == NSASCIIStringEncoding)
+	{
+	  if (flag == YES && chars.c != 0)
 	    {
-	      if (encoding == NSASCIIStringEncoding)
-		{
-		  if (flag == YES && chars.c != 0)
-		    {
-		      NSZoneFree(NSZoneFromPointer(chars.c), chars.c);
-		    }
-		  return nil;	// Invalid data
-		}
-	      break;
+	      NSZoneFree(NSZoneFromPointer(chars.c), chars.c);
 	    }
-        }
+	  return nil;	// Invalid data
+	}
       if (i == length)
 	{
 	  /*
@@ -1214,7 +1436,31 @@ fixBOM(unsigned char **bytes, NSUInteger*length, BOOL *owned,
       unichar	*u = 0;
       unsigned	l = 0;
 
-      if (GSToUnicode(&u, &l, chars.c, length, encoding,
+      if (encoding == NSUTF8StringEncoding)
+	{
+	  NSUInteger	n;
+
+	  /*
+	   * Well formed UTF-8 is decoded directly.  Anything else is left
+	   * to GSToUnicode() so the same data is accepted as before.
+	   */
+	  u = NSZoneMalloc([self zone], length * sizeof(unichar));
+	  n = GSPrivateUTF8ToUnicode(u, chars.c, length);
+	  if (n == NSNotFound)
+	    {
+	      NSZoneFree([self zone], u);
+	      u = 0;
+	    }
+	  else
+	    {
+	      if (n < length)
+		{
+		  u = NSZoneRealloc([self zone], u, n * sizeof(unichar));
+		}
+	      l = n;
+	    }
+	}
+      if (u == 0 && GSToUnicode(&u, &l, chars.c, length, encoding,
 	[self zone], 0) == NO)
 	{
 	  if (flag == YES && chars.c != 0)
@@ -1321,27 +1567,10 @@ fixBOM(unsigned char **bytes, NSUInteger*length, BOOL *owned,
 {
   GSStr		f;
   unsigned char	buf[2048];
-  unichar	fbuf[1024];
-  unichar	*fmt = fbuf;
-  size_t	len;
   GSStr		me;
 
   /*
-   * First we provide an array of unichar characters containing the
-   * format string.  For performance reasons we try to use an on-stack
-   * buffer if the format string is small enough ... it almost always
-   * will be.
-   */
-  len = [format length];
-  if (len >= 1024)
-    {
-      fmt = NSZoneMalloc(NSDefaultMallocZone(), (len+1)*sizeof(unichar));
-    }
-  [format getCharacters: fmt];
-  fmt[len] = '\0';
-
-  /*
-   * Now set up 'f' as a GSMutableString object whose initial buffer is
+   * Set up 'f' as a GSMutableString object whose initial buffer is
    * allocated on the stack.  The GSPrivateFormat function can write into it.
    */
   f = (GSStr)alloca(class_getInstanceSize(GSMutableStringClass));
@@ -1352,11 +1581,7 @@ fixBOM(unsigned char **bytes, NSUInteger*length, BOOL *owned,
   f->_count = 0;
   f->_flags.wide = 0;
   f->_flags.owned = 0;
-  GSPrivateFormat(f, fmt, argList, locale);
-  if (fmt != fbuf)
-    {
-      NSZoneFree(NSDefaultMallocZone(), fmt);
-    }
+  GSPrivateFormat(f, format, argList, locale);
 
   /*
    * Don't use noCopy because f->_contents.u may be memory on the stack,
@@ -1496,6 +1721,22 @@ UTF8String_c(GSStr self)
 	}
       r[self->_count] = '\0';
     }
+  else if (internalEncoding == NSISOLatin1StringEncoding)
+    {
+      NSUInteger	n;
+
+      n = GSPrivateLatin1UTF8Length(self->_contents.c, self->_count);
+      r = (unsigned char*)GSAutoreleasedBuffer(n + 1);
+      GSPrivateLatin1ToUTF8(r, self->_contents.c, self->_count);
+      r[n] = '\0';
+    }
+  else if (GSPrivateASCIIPrefix(self->_contents.c, self->_count)
+    == self->_count)
+    {
+      r = (unsigned char*)GSAutoreleasedBuffer(self->_count+1);
+      memcpy(r, self->_contents.c, self->_count);
+      r[self->_count] = '\0';
+    }
   else
     {
       unichar	*u = 0;
@@ -1988,6 +2229,28 @@ dataUsingEncoding_c(GSStr self, NSStringEncoding encoding, BOOL lossy)
       memcpy(buff, self->_contents.c, len);
       return [NSDataClass dataWithBytesNoCopy: buff length: len];
     }
+  else if (encoding == NSUTF8StringEncoding
+    && internalEncoding == NSISOLatin1StringEncoding)
+    {
+      unsigned char	*buff;
+      NSUInteger	l;
+
+      l = GSPrivateLatin1UTF8Length(self->_contents.c, len);
+      buff = (unsigned char*)NSZoneMalloc(NSDefaultMallocZone(), l);
+      GSPrivateLatin1ToUTF8(buff, self->_contents.c, len);
+      return [NSDataClass dataWithBytesNoCopy: buff length: l];
+    }
+  else if ((encoding == NSUTF8StringEncoding || isByteEncoding(encoding))
+    && GSPrivateASCIIPrefix(self->_contents.c, len) == len)
+    {
+      unsigned char *buff;
+
+      /* ASCII is the same in the internal encoding and the one wanted.
+       */
+      buff = (unsigned char*)NSZoneMalloc(NSDefaultMallocZone(), len);
+      memcpy(buff, self->_contents.c, len);
+      return [NSDataClass dataWithBytesNoCopy: buff length: len];
+    }
   else if (encoding == NSUnicodeStringEncoding)
     {
       unsigned int	l = 0;
@@ -2420,10 +2683,23 @@ getCStringE_c(GSStr self, char *buffer, unsigned int maxLength,
 	    }
 
 	  if (enc == NSUTF8StringEncoding
-	    && isByteEncoding(internalEncoding))
+	    && internalEncoding == NSISOLatin1StringEncoding)
 	    {
-	      unsigned	i;
+	      NSUInteger	n;
 
+	      n = GSPrivateLatin1UTF8Length(self->_contents.c, self->_count);
+	      if (n <= bytes)
+		{
+		  GSPrivateLatin1ToUTF8((uint8_t*)buffer,
+		    self->_contents.c, self->_count);
+		  buffer[n] = '\0';
+		  return YES;
+		}
+	    }
+
+	  if (enc == NSUTF8StringEncoding
+	    && isByteEncoding(internalEncoding))
+	    {
 	      /*
 	       * Maybe we actually contain ascii data, which can be
 	       * copied out directly as a utf-8 string.
@@ -2432,18 +2708,9 @@ getCStringE_c(GSStr self, char *buffer, unsigned int maxLength,
 		{
 		  bytes = self->_count;
 		}
-	      for (i = 0; i < bytes; i++)
-		{
-		  unsigned char	c = self->_contents.c[i];
-
-		  if (c > 127)
-		    {
-		      break;
-		    }
-		  buffer[i] = c;
-		}
-	      if (i == bytes)
+	      if (GSPrivateASCIIPrefix(self->_contents.c, bytes) == bytes)
 	        {
+		  memcpy(buffer, self->_contents.c, bytes);
 	          buffer[bytes] = '\0';
 	          if (bytes < self->_count)
 		    {
@@ -2456,23 +2723,16 @@ getCStringE_c(GSStr self, char *buffer, unsigned int maxLength,
 	  if (enc == NSASCIIStringEncoding
 	    && isByteEncoding(internalEncoding))
 	    {
-	      unsigned	i;
-
 	      if (bytes > self->_count)
 		{
 		  bytes = self->_count;
 		}
-	      for (i = 0; i < bytes; i++)
+	      if (GSPrivateASCIIPrefix(self->_contents.c, bytes) < bytes)
 		{
-		  unsigned char	c = self->_contents.c[i];
-
-		  if (c > 127)
-		    {
-		      [NSException raise: NSCharacterConversionException
-				  format: @"unable to convert to encoding"];
-		    }
-		  buffer[i] = c;
+		  [NSException raise: NSCharacterConversionException
+			      format: @"unable to convert to encoding"];
 		}
+	      memcpy(buffer, self->_contents.c, bytes);
 	      buffer[bytes] = '\0';
 	      if (bytes < self->_count)
 		{
@@ -4268,6 +4528,215 @@ agree, create a new GSUInlineString otherwise.
 
 @end
 
+
+
+@implementation	GSUTF8String
+
++ (void) initialize
+{
+  setup(NO);
+}
+
+- (BOOL) canBeConvertedToEncoding: (NSStringEncoding)encoding
+{
+  if (NSUTF8StringEncoding == encoding || NSUnicodeStringEncoding == encoding
+    || (_ascii == _count && isByteEncoding(encoding)))
+    {
+      return YES;
+    }
+  return [super canBeConvertedToEncoding: encoding];
+}
+
+- (unichar) characterAtIndex: (NSUInteger)index
+{
+  NSUInteger	offset;
+  BOOL		low;
+  unichar	u;
+
+  if (index >= _count)
+    [NSException raise: NSRangeException format: @"Invalid index."];
+  if (index < _ascii)
+    {
+      return _bytes[index];
+    }
+  offset = offsetUTF8(self, index, &low);
+  charactersUTF8(_bytes + offset, &u, 1, low);
+  return u;
+}
+
+/*
+Retain if we own the buffer and the zones agree, otherwise copy the
+UTF-8 into a new buffer of our own.
+*/
+- (id) copyWithZone: (NSZone*)z
+{
+  if (!_flags.owned || NSShouldRetainWithZone(self, z) == NO)
+    {
+      uint8_t	*b = NSZoneMalloc(z, _size + 1);
+
+      memcpy(b, _bytes, _size);
+      b[_size] = '\0';
+      return newUTF8(b, _size, _count, _ascii, YES, YES, z);
+    }
+  else
+    {
+      return RETAIN(self);
+    }
+}
+
+- (const char *) cStringUsingEncoding: (NSStringEncoding)encoding
+{
+  if (NSUTF8StringEncoding == encoding)
+    {
+      return [self UTF8String];
+    }
+  return [super cStringUsingEncoding: encoding];
+}
+
+- (NSData*) dataUsingEncoding: (NSStringEncoding)encoding
+	 allowLossyConversion: (BOOL)flag
+{
+  if (NSUTF8StringEncoding == encoding
+    || (_ascii == _count && isByteEncoding(encoding)))
+    {
+      return [NSDataClass dataWithBytes: _bytes length: _size];
+    }
+  return [super dataUsingEncoding: encoding allowLossyConversion: flag];
+}
+
+- (void) dealloc
+{
+  if (_bytes != 0 && _flags.owned)
+    {
+      NSZoneFree(NSZoneFromPointer(_bytes), _bytes);
+    }
+  if (_crumbs != 0)
+    {
+      NSZoneFree(NSDefaultMallocZone(), _crumbs);
+    }
+  [super dealloc];
+}
+
+- (NSStringEncoding) fastestEncoding
+{
+  return NSUTF8StringEncoding;
+}
+
+- (void) getCharacters: (unichar*)buffer range: (NSRange)aRange
+{
+  NSUInteger	offset;
+  BOOL		low;
+
+  GS_RANGE_CHECK(aRange, _count);
+  offset = offsetUTF8(self, aRange.location, &low);
+  charactersUTF8(_bytes + offset, buffer, aRange.length, low);
+}
+
+- (BOOL) getCString: (char*)buffer
+	  maxLength: (NSUInteger)maxLength
+	   encoding: (NSStringEncoding)encoding
+{
+  if (NSUTF8StringEncoding == encoding
+    || (_ascii == _count && isByteEncoding(encoding)))
+    {
+      if (buffer == 0 || maxLength <= _size)
+	{
+	  return NO;	// Can't fit in here
+	}
+      memcpy(buffer, _bytes, _size);
+      buffer[_size] = '\0';
+      return YES;
+    }
+  return [super getCString: buffer maxLength: maxLength encoding: encoding];
+}
+
+- (NSUInteger) hash
+{
+  if (_flags.hash == 0)
+    {
+      _flags.hash = [super hash];
+    }
+  return _flags.hash;
+}
+
+- (BOOL) isEqual: (id)anObject
+{
+  if (anObject != nil && object_getClass(anObject) == GSUTF8StringClass)
+    {
+      GSUTF8String	*other = (GSUTF8String*)anObject;
+
+      /* Well formed UTF-8 for the same characters has the same bytes.
+       */
+      return (other->_size == _size
+	&& memcmp(other->_bytes, _bytes, _size) == 0) ? YES : NO;
+    }
+  return [super isEqual: anObject];
+}
+
+- (BOOL) isEqualToString: (NSString*)aString
+{
+  if (aString != nil && object_getClass(aString) == GSUTF8StringClass)
+    {
+      return [self isEqual: aString];
+    }
+  return [super isEqualToString: aString];
+}
+
+- (NSUInteger) length
+{
+  return _count;
+}
+
+- (NSUInteger) lengthOfBytesUsingEncoding: (NSStringEncoding)encoding
+{
+  if (NSUTF8StringEncoding == encoding)
+    {
+      return _size;
+    }
+  return [super lengthOfBytesUsingEncoding: encoding];
+}
+
+- (NSStringEncoding) smallestEncoding
+{
+  return NSUTF8StringEncoding;
+}
+
+- (NSString*) substringWithRange: (NSRange)aRange
+{
+  NSUInteger	start;
+  NSUInteger	end;
+  BOOL		low;
+  BOOL		split;
+
+  GS_RANGE_CHECK(aRange, _count);
+  start = offsetUTF8(self, aRange.location, &low);
+  end = offsetUTF8(self, NSMaxRange(aRange), &split);
+  if (low || split)
+    {
+      return [super substringWithRange: aRange];
+    }
+  return AUTORELEASE([[NSStringClass allocWithZone: NSDefaultMallocZone()]
+    initWithBytes: _bytes + start
+	   length: end - start
+	 encoding: NSUTF8StringEncoding]);
+}
+
+- (const char *) UTF8String
+{
+  char	*r;
+
+  if (_flags.terminated)
+    {
+      return (const char*)_bytes;
+    }
+  r = GSAutoreleasedBuffer(_size + 1);
+  memcpy(r, _bytes, _size);
+  r[_size] = '\0';
+  return r;
+}
+
+@end
+
 
 
 /*
@@ -4289,26 +4758,9 @@ agree, create a new GSUInlineString otherwise.
 - (void) appendFormat: (NSString*)format, ...
 {
   va_list	ap;
-  unichar	buf[1024];
-  unichar	*fmt = buf;
-  size_t	len;
 
   va_start(ap, format);
 
-  /*
-   * Make sure we have the format string in a nul terminated array of
-   * unichars for passing to GSPrivateFormat.  Use on-stack memory for
-   * performance unless the size of the format string is really big
-   * (a rare occurrence).
-   */
-  len = [format length];
-  if (len >= 1024)
-    {
-      fmt = NSZoneMalloc(NSDefaultMallocZone(), (len+1)*sizeof(unichar));
-    }
-  [format getCharacters: fmt];
-  fmt[len] = '\0';
-
   /*
    * If no zone is set, make sure we have one so any memory mangement
    * (buffer growth) is done with the correct zone.
@@ -4321,12 +4773,8 @@ agree, create a new GSUInlineString otherwise.
       _zone = [self zone];
 #endif
     }
-  GSPrivateFormat((GSStr)self, fmt, ap, nil);
+  GSPrivateFormat((GSStr)self, format, ap, nil);
   _flags.hash = 0;	// Invalidate the hash for this string.
-  if (fmt != buf)
-    {
-      NSZoneFree(NSDefaultMallocZone(), fmt);
-    }
   va_end(ap);
 }
 
@@ -4790,29 +5238,7 @@ NSAssert(_flags.owned == 1 && _zone != 0, NSInternalInconsistencyException);
                locale: (NSDictionary*)locale
 	    arguments: (va_list)argList
 {
-  unichar	fbuf[1024];
-  unichar	*fmt = fbuf;
-  size_t	len;
-
-  /*
-   * First we provide an array of unichar characters containing the
-   * format string.  For performance reasons we try to use an on-stack
-   * buffer if the format string is small enough ... it almost always
-   * will be.
-   */
-  len = [format length];
-  if (len >= 1024)
-    {
-      fmt = NSZoneMalloc(NSDefaultMallocZone(), (len+1)*sizeof(unichar));
-    }
-  [format getCharacters: fmt];
-  fmt[len] = '\0';
-
-  GSPrivateFormat((GSStr)self, fmt, argList, locale);
-  if (fmt != fbuf)
-    {
-      NSZoneFree(NSDefaultMallocZone(), fmt);
-    }
+  GSPrivateFormat((GSStr)self, format, argList, locale);
   return self;
 }
 
@@ -5839,6 +6265,35 @@ GSPrivateStrAppendUnichars(GSStr s, const unichar *u, unsigned l)
     }
 }
 
+BOOL
+GSPrivateStrAppendString(GSStr s, NSString *str, unsigned l)
+{
+  Class	c;
+
+  if (s->_flags.wide == 1 || str == nil)
+    {
+      return NO;
+    }
+  c = object_getClass(str);
+  if (GSObjCIsKindOf(c, GSCStringClass) == NO
+    && (GSObjCIsKindOf(c, GSMutableStringClass) == NO
+      || ((GSStr)str)->_flags.wide == 1))
+    {
+      return NO;
+    }
+
+  /*
+   * Both strings hold 8-bit characters in the internal encoding,
+   * so we can simply copy the bytes.
+   */
+  if (s->_count + l + 1 >= s->_capacity)
+    {
+      GSStrMakeSpace(s, l);
+    }
+  memcpy(s->_contents.c + s->_count, ((GSStr)str)->_contents.c, l);
+  s->_count += l;
+  return YES;
+}
 
 void
 GSPrivateStrExternalize(GSStr s)
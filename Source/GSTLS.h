@@ -36,6 +36,7 @@ extern NSString * const GSTLSDebug;
 extern NSString * const GSTLSPriority;
 extern NSString * const GSTLSRemoteHosts;
 extern NSString * const GSTLSRevokeFile;
+extern NSString * const GSTLSSessionKey;
 extern NSString * const GSTLSVerify;
 
 #if     defined(HAVE_GNUTLS)
@@ -159,6 +160,8 @@ typedef ssize_t (*GSTLSIOW)(gnutls_transport_ptr_t, const void *, size_t);
   BOOL                                  handshake;
   BOOL                                  setup;
   BOOL                                  debug;
+  BOOL                                  established;
+  BOOL                                  resumed;
 @public
   gnutls_session_t                      session;
 }
@@ -174,6 +177,16 @@ typedef ssize_t (*GSTLSIOW)(gnutls_transport_ptr_t, const void *, size_t);
                   push: (GSTLSIOW)pushFunc
                   pull: (GSTLSIOR)pullFunc;
 
+/* Return the number of handshakes (by sessions in this process) which
+ * completed by negotiating a new session.
+ */
++ (NSUInteger) fullHandshakes;
+
+/* Return the number of handshakes (by sessions in this process) which
+ * completed by resuming a cached session.
+ */
++ (NSUInteger) resumedHandshakes;
+
 /* Return YES if the session is active (handshake has succeeded and the
  * session has not been disconnected), NO otherwise.
  */
@@ -197,6 +210,11 @@ typedef ssize_t (*GSTLSIOW)(gnutls_transport_ptr_t, const void *, size_t);
  */
 - (NSInteger) read: (void*)buf length: (NSUInteger)len;
 
+/* Return YES if the handshake resumed an earlier session rather than
+ * negotiating a new one.
+ */
+- (BOOL) resumed;
+
 /** Get a report of the SSL/TLS status of the current session.
  */
 - (NSString*) sessionInfo;
@@ -51,6 +51,7 @@ NSString * const GSTLSDebug = @"GSTLSDebug";
 NSString * const GSTLSPriority = @"GSTLSPriority";
 NSString * const GSTLSRemoteHosts = @"GSTLSRemoteHosts";
 NSString * const GSTLSRevokeFile = @"GSTLSRevokeFile";
+NSString * const GSTLSSessionKey = @"GSTLSSessionKey";
 NSString * const GSTLSVerify = @"GSTLSVerify";
 
 
@@ -1199,8 +1200,235 @@ static NSMutableDictionary      *credentialsCache = nil;
 
 
 
+/* Cached session data used for resumption.  Entries expire after
+ * sessionLifetime seconds, and each cache holds at most
+ * SESSION_CACHE_MAX entries.
+ */
+#define	SESSION_CACHE_MAX	1024
+
+@interface	GSTLSSessionData : NSObject
+{
+@public
+  NSData		*data;
+  NSTimeInterval	expires;
+}
+@end
+
+@implementation	GSTLSSessionData
+- (void) dealloc
+{
+  DESTROY(data);
+  [super dealloc];
+}
+@end
+
+static NSLock                   *sessionLock = nil;
+static NSMutableDictionary      *clientSessions = nil;   // By GSTLSSessionKey
+static NSMutableDictionary      *serverSessions = nil;   // By session ID
+static NSTimeInterval           sessionLifetime = 3600.0;
+static NSUInteger               fullCount = 0;
+static NSUInteger               resumedCount = 0;
+#if GNUTLS_VERSION_NUMBER >= 0x020A00
+static gnutls_datum_t           ticketKey = { 0, 0 };
+#endif
+
+/* Returns the (retained) data for key in cache, or nil if there is no
+ * data or it has expired.
+ */
+static NSData *
+retainedSessionData(NSMutableDictionary *cache, id key)
+{
+  GSTLSSessionData      *s;
+  NSData                *d = nil;
+
+  [sessionLock lock];
+  s = [cache objectForKey: key];
+  if (nil != s)
+    {
+      if (s->expires > [NSDate timeIntervalSinceReferenceDate])
+        {
+          d = RETAIN(s->data);
+        }
+      else
+        {
+          [cache removeObjectForKey: key];
+        }
+    }
+  [sessionLock unlock];
+  return d;
+}
+
+static void
+storeSessionData(NSMutableDictionary *cache, id key, NSData *data)
+{
+  NSTimeInterval        now = [NSDate timeIntervalSinceReferenceDate];
+  GSTLSSessionData      *s;
+
+  s = [GSTLSSessionData new];
+  s->data = RETAIN(data);
+  s->expires = now + sessionLifetime;
+  [sessionLock lock];
+  if ([cache count] >= SESSION_CACHE_MAX
+    && [cache objectForKey: key] == nil)
+    {
+      NSEnumerator      *e = [[cache allKeys] objectEnumerator];
+      NSUInteger        count = [cache count];
+      id                k;
+
+      /* Remove expired entries, and if that doesn't free enough space,
+       * discard entries until the cache is half full.
+       */
+      while (nil != (k = [e nextObject]))
+        {
+          GSTLSSessionData      *o = [cache objectForKey: k];
+
+          if (o->expires <= now || count > SESSION_CACHE_MAX / 2)
+            {
+              [cache removeObjectForKey: k];
+              count--;
+            }
+        }
+    }
+  [cache setObject: s forKey: key];
+  [sessionLock unlock];
+  RELEASE(s);
+}
+
+static void
+removeSessionData(NSMutableDictionary *cache, id key)
+{
+  [sessionLock lock];
+  [cache removeObjectForKey: key];
+  [sessionLock unlock];
+}
+
+/* Callbacks used by gnutls to maintain the server side session cache.
+ */
+static int
+GSTLSDbStore(void *ptr, gnutls_datum_t key, gnutls_datum_t data)
+{
+  NSData        *k;
+  NSData        *d;
+
+  k = [[NSData alloc] initWithBytes: key.data length: key.size];
+  d = [[NSData alloc] initWithBytes: data.data length: data.size];
+  storeSessionData(serverSessions, k, d);
+  RELEASE(d);
+  RELEASE(k);
+  return 0;
+}
+
+static gnutls_datum_t
+GSTLSDbRetrieve(void *ptr, gnutls_datum_t key)
+{
+  gnutls_datum_t        result = { 0, 0 };
+  NSData                *k;
+  NSData                *d;
+
+  k = [[NSData alloc] initWithBytesNoCopy: key.data
+                                   length: key.size
+                             freeWhenDone: NO];
+  d = retainedSessionData(serverSessions, k);
+  RELEASE(k);
+  if (nil != d)
+    {
+      /* The result is freed by gnutls, so we must allocate it
+       * using the gnutls allocator.
+       */
+      result.data = gnutls_malloc([d length]);
+      if (0 != result.data)
+        {
+          memcpy(result.data, [d bytes], [d length]);
+          result.size = [d length];
+        }
+      RELEASE(d);
+    }
+  return result;
+}
+
+static int
+GSTLSDbRemove(void *ptr, gnutls_datum_t key)
+{
+  NSData        *k;
+
+  k = [[NSData alloc] initWithBytesNoCopy: key.data
+                                   length: key.size
+                             freeWhenDone: NO];
+  removeSessionData(serverSessions, k);
+  RELEASE(k);
+  return 0;
+}
+
 @implementation GSTLSSession
 
+/* Save the data for an outgoing session so that a later connection to
+ * the same remote end can try to resume it.
+ */
+- (void) _storeSession
+{
+  NSString      *key = [opts objectForKey: GSTLSSessionKey];
+
+  if (YES == outgoing && nil != key)
+    {
+      gnutls_datum_t    d = { 0, 0 };
+
+#if GNUTLS_VERSION_NUMBER >= 0x030605
+      /* With TLS 1.3 there is nothing worth saving until the server
+       * has sent us a ticket.
+       */
+      if (GNUTLS_TLS1_3 == gnutls_protocol_get_version(session)
+        && 0 == (gnutls_session_get_flags(session)
+          & GNUTLS_SFLAGS_SESSION_TICKET))
+        {
+          return;
+        }
+#endif
+      if (gnutls_session_get_data2(session, &d) >= 0 && d.size > 0)
+        {
+          NSData        *data;
+
+          data = [[NSData alloc] initWithBytes: d.data length: d.size];
+          storeSessionData(clientSessions, key, data);
+          RELEASE(data);
+        }
+      if (0 != d.data)
+        {
+          gnutls_free(d.data);
+        }
+    }
+}
+
++ (NSUInteger) fullHandshakes
+{
+  return fullCount;
+}
+
++ (void) initialize
+{
+  if ([GSTLSSession class] == self && nil == sessionLock)
+    {
+      sessionLock = [NSLock new];
+      clientSessions = [NSMutableDictionary new];
+      serverSessions = [NSMutableDictionary new];
+#if GNUTLS_VERSION_NUMBER >= 0x020A00
+      /* Servers issue session tickets encrypted with a key generated
+       * afresh for each process, so clients can resume without the
+       * server needing to find the session in its cache.
+       */
+      if (gnutls_session_ticket_key_generate(&ticketKey) < 0)
+        {
+          ticketKey.data = 0;
+          ticketKey.size = 0;
+        }
+#endif
+    }
+}
+
++ (NSUInteger) resumedHandshakes
+{
+  return resumedCount;
+}
+
 + (GSTLSSession*) sessionWithOptions: (NSDictionary*)options
                            direction: (BOOL)isOutgoing
                            transport: (void*)handle
@@ -1233,6 +1461,14 @@ static NSMutableDictionary      *credentialsCache = nil;
 
 - (void) disconnect
 {
+  if (YES == active && YES == established)
+    {
+      /* Newer protocol versions may only deliver the session ticket
+       * after the handshake, so refresh the cached session data before
+       * we close.
+       */
+      [self _storeSession];
+    }
   if (YES == active || YES == handshake)
     {
       active = NO;
@@ -1242,7 +1478,18 @@ static NSMutableDictionary      *credentialsCache = nil;
   if (YES == setup)
     {
       setup = NO;
-      gnutls_db_remove_session(session);
+      if (NO == established)
+        {
+          NSString      *key = [opts objectForKey: GSTLSSessionKey];
+
+          /* The session failed, so it must not be used for resumption.
+           */
+          gnutls_db_remove_session(session);
+          if (YES == outgoing && nil != key)
+            {
+              removeSessionData(clientSessions, key);
+            }
+        }
       gnutls_deinit(session);
     }
 }
@@ -1446,6 +1693,41 @@ static NSMutableDictionary      *credentialsCache = nil;
       gnutls_transport_set_pull_function(session, pullFunc);
       gnutls_transport_set_push_function(session, pushFunc);
       gnutls_transport_set_ptr(session, (gnutls_transport_ptr_t)handle);
+
+      /* Set up session resumption.  A client offers any session data
+       * cached from an earlier connection to the same remote end, while
+       * a server keeps a cache of sessions and issues session tickets.
+       */
+      if (YES == outgoing)
+        {
+          str = [opts objectForKey: GSTLSSessionKey];
+          if (nil != str)
+            {
+              NSData    *d = retainedSessionData(clientSessions, str);
+
+              if (nil != d)
+                {
+                  gnutls_session_set_data(session, [d bytes], [d length]);
+                  RELEASE(d);
+                }
+            }
+#if GNUTLS_VERSION_NUMBER >= 0x020A00 && GNUTLS_VERSION_NUMBER < 0x030600
+          gnutls_session_ticket_enable_client(session);
+#endif
+        }
+      else
+        {
+          gnutls_db_set_cache_expiration(session, (int)sessionLifetime);
+          gnutls_db_set_retrieve_function(session, GSTLSDbRetrieve);
+          gnutls_db_set_store_function(session, GSTLSDbStore);
+          gnutls_db_set_remove_function(session, GSTLSDbRemove);
+#if GNUTLS_VERSION_NUMBER >= 0x020A00
+          if (ticketKey.size > 0)
+            {
+              gnutls_session_ticket_enable_server(session, &ticketKey);
+            }
+#endif
+        }
     }
 
   return self;
@@ -1540,6 +1822,22 @@ static NSMutableDictionary      *credentialsCache = nil;
               [self disconnect];
             }
         }
+      if (YES == active)
+        {
+          established = YES;
+          resumed = gnutls_session_is_resumed(session) ? YES : NO;
+          [sessionLock lock];
+          if (YES == resumed)
+            {
+              resumedCount++;
+            }
+          else
+            {
+              fullCount++;
+            }
+          [sessionLock unlock];
+          [self _storeSession];
+        }
       return YES;       // Handshake complete
     }
 }
@@ -1554,6 +1852,11 @@ static NSMutableDictionary      *credentialsCache = nil;
   return gnutls_record_recv(session, buf, len);
 }
 
+- (BOOL) resumed
+{
+  return resumed;
+}
+
 - (NSInteger) write: (const void*)buf length: (NSUInteger)len
 {
   return gnutls_record_send(session, buf, len);
@@ -1712,6 +2015,9 @@ static NSMutableDictionary      *credentialsCache = nil;
   tmp = gnutls_protocol_get_name(gnutls_protocol_get_version(session));
   [str appendFormat: _(@"- Protocol: %s\n"), tmp];
 
+  [str appendFormat: _(@"- Session resumed: %s\n"),
+    (YES == resumed) ? "yes" : "no"];
+
   /* print the certificate type of the peer.
    * ie X.509
    */
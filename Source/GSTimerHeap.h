@@ -0,0 +1,357 @@
+#ifndef __GSTimerHeap_h_GNUSTEP_BASE_INCLUDE
+#define __GSTimerHeap_h_GNUSTEP_BASE_INCLUDE
+/**
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNUstep Base Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02111 USA.
+*/
+
+/*
+ *	A binary min-heap of the timers in a run loop mode, ordered by the
+ *	time at which each timer should be fired.
+ *
+ *	Removal is lazy: an invalidated timer stays in the heap until it
+ *	reaches the top (or until the heap is purged when it has grown),
+ *	so cancelling a timer costs nothing beyond -invalidate.  Each entry
+ *	records (and retains) the fire date its key was calculated from, so
+ *	a timer whose date has since been moved later can be spotted by the
+ *	run loop when it reaches the top, and put back in the heap with a
+ *	key calculated from its new date.
+ *
+ *	A date moved earlier would be seen too late that way, so each timer
+ *	knows the heaps holding it, and -[NSTimer setFireDate:] adds the
+ *	timer to the 'moved' table of each of them.  When the run loop next
+ *	looks at the heap it adds a new entry for each of those timers, and
+ *	the entry it supersedes is dropped when it reaches the top.  The
+ *	members table maps each timer to the sequence number of its current
+ *	entry so that superseded entries can be recognised.
+ *
+ *	The key of a timer with a tolerance is its fire date pushed later
+ *	(within the tolerance) onto a boundary of a power of two fraction
+ *	of a second, so that timers due at about the same time end up with
+ *	the same key and are handled in one wakeup of the run loop.
+ *	Timers with equal keys are fired in the order they were added.
+ */
+
+#import "Foundation/NSHashTable.h"
+#import "Foundation/NSMapTable.h"
+#import "Foundation/NSTimer.h"
+#import "GSPrivate.h"
+
+#include <math.h>
+
+typedef struct {
+  NSTimeInterval	key;	/* When the timer should be fired.	*/
+  unsigned long		seq;	/* Order of addition to the heap.	*/
+  NSTimer		*timer;	/* Retained.				*/
+  NSDate		*date;	/* Retained, the date the key is from.	*/
+} GSTimerEntry;
+
+typedef struct GSTimerHeap_s {
+  GSTimerEntry		*ptr;
+  unsigned		count;
+  unsigned		cap;
+  unsigned		purged;		/* Count after last purge.	*/
+  unsigned long		seq;
+  NSZone		*zone;
+  NSMapTable		*members;	/* Timers to current entry seq.	*/
+  NSHashTable		*moved;		/* Timers moved earlier.	*/
+  volatile BOOL		changed;	/* Set when moved is not empty.	*/
+  NSUInteger		fires;		/* Statistics ...		*/
+  NSTimeInterval	lateness;
+  NSTimeInterval	maxLateness;
+} GSTimerHeap_t;
+typedef GSTimerHeap_t	*GSTimerHeap;
+
+@interface	NSTimer (GSTimerHeap)
+/* Record that a heap holds, or no longer holds, the receiver, so that
+ * the heap can be told if the fire date is moved earlier.
+ */
+- (void) _addedToHeap: (GSTimerHeap)heap;
+- (void) _removedFromHeap: (GSTimerHeap)heap;
+@end
+
+/* Puts the timers in the moved table of the heap back in the heap
+ * (defined in NSTimer.m, which does the locking for the moved tables).
+ */
+extern void
+GSTimerHeapReorder(GSTimerHeap heap, NSTimeInterval now) GS_ATTRIB_PRIVATE;
+
+static inline BOOL
+GSTimerHeapLess(GSTimerEntry *a, GSTimerEntry *b)
+{
+  if (a->key < b->key)
+    {
+      return YES;
+    }
+  if (a->key == b->key && a->seq < b->seq)
+    {
+      return YES;
+    }
+  return NO;
+}
+
+static inline void
+GSTimerHeapSiftUp(GSTimerHeap heap, unsigned index)
+{
+  GSTimerEntry	e = heap->ptr[index];
+
+  while (index > 0)
+    {
+      unsigned	parent = (index - 1) / 2;
+
+      if (GSTimerHeapLess(&e, &heap->ptr[parent]) == NO)
+	{
+	  break;
+	}
+      heap->ptr[index] = heap->ptr[parent];
+      index = parent;
+    }
+  heap->ptr[index] = e;
+}
+
+static inline void
+GSTimerHeapSiftDown(GSTimerHeap heap, unsigned index)
+{
+  GSTimerEntry	e = heap->ptr[index];
+  unsigned	count = heap->count;
+
+  for (;;)
+    {
+      unsigned	child = 2 * index + 1;
+
+      if (child >= count)
+	{
+	  break;
+	}
+      if (child + 1 < count
+	&& GSTimerHeapLess(&heap->ptr[child + 1], &heap->ptr[child]))
+	{
+	  child++;
+	}
+      if (GSTimerHeapLess(&heap->ptr[child], &e) == NO)
+	{
+	  break;
+	}
+      heap->ptr[index] = heap->ptr[child];
+      index = child;
+    }
+  heap->ptr[index] = e;
+}
+
+/* Restores the heap order after keys have been changed or entries
+ * removed in place.
+ */
+static inline void
+GSTimerHeapHeapify(GSTimerHeap heap)
+{
+  unsigned	i = heap->count / 2;
+
+  while (i-- > 0)
+    {
+      GSTimerHeapSiftDown(heap, i);
+    }
+}
+
+/* Returns the key for a timer due at 'when' with the given tolerance,
+ * never earlier than 'now' so that a timer added with a date in the
+ * past can't jump ahead of timers which are already overdue.
+ */
+static inline NSTimeInterval
+GSTimerHeapKey(NSTimeInterval when, NSTimeInterval tolerance,
+  NSTimeInterval now)
+{
+  if (tolerance > 0.0)
+    {
+      NSTimeInterval	grid;
+      int		exp;
+
+      /* The largest power of two not greater than the tolerance.
+       */
+      frexp(tolerance, &exp);
+      grid = ldexp(0.5, exp);
+      when = floor((when + tolerance) / grid) * grid;
+    }
+  if (when < now)
+    {
+      when = now;
+    }
+  return when;
+}
+
+static inline void
+GSTimerHeapInitWithZone(GSTimerHeap heap, NSZone *zone)
+{
+  heap->zone = zone;
+  heap->cap = 8;
+  heap->ptr = NSZoneMalloc(zone, heap->cap * sizeof(GSTimerEntry));
+  heap->count = 0;
+  heap->purged = 0;
+  heap->seq = 1;
+  heap->members = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
+    NSIntegerMapValueCallBacks, 0);
+  heap->moved = NSCreateHashTable(NSNonOwnedPointerHashCallBacks, 0);
+  heap->changed = NO;
+  heap->fires = 0;
+  heap->lateness = 0.0;
+  heap->maxLateness = 0.0;
+}
+
+/* Returns YES if the entry is the current one for its timer, NO if it
+ * has been superseded by one added when the timer was moved earlier.
+ */
+static inline BOOL
+GSTimerHeapIsCurrent(GSTimerHeap heap, GSTimerEntry *e)
+{
+  NSUInteger	seq = (NSUInteger)NSMapGet(heap->members, e->timer);
+
+  return (seq == e->seq) ? YES : NO;
+}
+
+/* Releases all the entries and frees the memory used by the heap
+ * (but not the heap structure itself).
+ */
+static inline void
+GSTimerHeapEmpty(GSTimerHeap heap)
+{
+  while (heap->count > 0)
+    {
+      GSTimerEntry	*e = &heap->ptr[--heap->count];
+
+      if (GSTimerHeapIsCurrent(heap, e) == YES)
+	{
+	  [e->timer _removedFromHeap: heap];
+	}
+      RELEASE(e->timer);
+      RELEASE(e->date);
+    }
+  NSZoneFree(heap->zone, heap->ptr);
+  heap->ptr = 0;
+  heap->cap = 0;
+  NSFreeMapTable(heap->members);
+  heap->members = 0;
+  NSFreeHashTable(heap->moved);
+  heap->moved = 0;
+}
+
+static inline BOOL
+GSTimerHeapContains(GSTimerHeap heap, NSTimer *timer)
+{
+  return (NSMapGet(heap->members, timer) != 0) ? YES : NO;
+}
+
+/* Adds an entry for a timer which is already retained on behalf of the
+ * heap (and already linked to it), keyed on its current date.  Any
+ * older entry for the timer is superseded.
+ */
+static inline void
+GSTimerHeapPushNoRetain(GSTimerHeap heap, NSTimer *timer,
+  NSTimeInterval now)
+{
+  GSTimerEntry	*e;
+
+  if (heap->count == heap->cap)
+    {
+      heap->cap *= 2;
+      heap->ptr = NSZoneRealloc(heap->zone, heap->ptr,
+	heap->cap * sizeof(GSTimerEntry));
+    }
+  e = &heap->ptr[heap->count];
+  e->timer = timer;
+  e->date = RETAIN([timer fireDate]);
+  e->key = GSTimerHeapKey([e->date timeIntervalSinceReferenceDate],
+    [timer tolerance], now);
+  e->seq = heap->seq++;
+  NSMapInsert(heap->members, timer, (void*)(NSUInteger)e->seq);
+  GSTimerHeapSiftUp(heap, heap->count++);
+}
+
+/* Adds a timer to the heap, retaining it.
+ */
+static inline void
+GSTimerHeapAdd(GSTimerHeap heap, NSTimer *timer, NSTimeInterval now)
+{
+  [timer _addedToHeap: heap];
+  GSTimerHeapPushNoRetain(heap, RETAIN(timer), now);
+}
+
+/* Removes the first entry, whose timer and date are then owned by
+ * the caller.
+ */
+static inline GSTimerEntry
+GSTimerHeapPop(GSTimerHeap heap)
+{
+  GSTimerEntry	e = heap->ptr[0];
+
+  if (--heap->count > 0)
+    {
+      heap->ptr[0] = heap->ptr[heap->count];
+      GSTimerHeapSiftDown(heap, 0);
+    }
+  return e;
+}
+
+/* Forgets an entry popped from the heap (which is not put back), and
+ * the timer too if this was its current entry.
+ */
+static inline void
+GSTimerHeapDiscard(GSTimerHeap heap, GSTimerEntry *e)
+{
+  if (GSTimerHeapIsCurrent(heap, e) == YES)
+    {
+      NSMapRemove(heap->members, e->timer);
+      [e->timer _removedFromHeap: heap];
+    }
+  RELEASE(e->timer);
+  RELEASE(e->date);
+}
+
+/* Removes invalidated timers and superseded entries from the heap once
+ * it has doubled in size since the last purge, so that cancelled timers
+ * due far in the future don't accumulate.  The cost is linear in the
+ * size of the heap, but is spread over the additions which made it grow.
+ */
+static inline void
+GSTimerHeapPurge(GSTimerHeap heap)
+{
+  unsigned	from;
+  unsigned	to = 0;
+
+  if (heap->count < 64 || heap->count < 2 * heap->purged)
+    {
+      return;
+    }
+  for (from = 0; from < heap->count; from++)
+    {
+      GSTimerEntry	*e = &heap->ptr[from];
+
+      if ([e->timer isValid] == NO || GSTimerHeapIsCurrent(heap, e) == NO)
+	{
+	  GSTimerHeapDiscard(heap, e);
+	}
+      else
+	{
+	  heap->ptr[to++] = *e;
+	}
+    }
+  heap->count = to;
+  heap->purged = to;
+  GSTimerHeapHeapify(heap);
+}
+
+#endif /* __GSTimerHeap_h_GNUSTEP_BASE_INCLUDE */
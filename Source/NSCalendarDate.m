@@ -165,9 +165,38 @@ lastDayOfGregorianMonth(NSUInteger month, NSUInteger year)
     }
 }
 
+/*
+ * Return the day of the common era (1 for 1st January 1 AD) of a date in
+ * the proleptic gregorian calendar.
+ * For all dates in the era we do this in constant time by counting from
+ * the 1st of March in year 0 (so that any leap day falls at the end of
+ * the year) in whole four hundred year cycles of 146097 days (as in
+ * Howard Hinnant's chrono-compatible low-level date algorithms).
+ * Other dates (and out of range months) are handled by the old method
+ * of adding up the lengths of the months.
+ */
 static inline NSUInteger
 absoluteGregorianDay(NSUInteger day, NSUInteger month, NSUInteger year)
 {
+  if (year > 0 && month >= 1 && month <= 12)
+    {
+      NSUInteger	y = year - (month <= 2 ? 1 : 0);
+      NSUInteger	cycle = y / 400;
+      NSUInteger	yearOfCycle = y - cycle * 400;
+      NSUInteger	dayOfYear;
+      NSUInteger	dayOfCycle;
+
+      /* Days since 1st March, with months of 31 30 31 30 31 31 30 31 30 31
+       * 31 28/29 days (always adding to 153 days per five months).
+       */
+      dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5
+	+ day - 1;
+      dayOfCycle = yearOfCycle * 365 + yearOfCycle / 4 - yearOfCycle / 100
+	+ dayOfYear;
+      /* 1st January 1 AD is 306 days after 1st March 0 AD.
+       */
+      return cycle * 146097 + dayOfCycle - 305;
+    }
   if (month > 1)
     {
       while (--month > 0)
@@ -187,22 +216,36 @@ absoluteGregorianDay(NSUInteger day, NSUInteger month, NSUInteger year)
      + year/400);   // ...plus prior years divisible by 400
 }
 
-static inline int
-dayOfCommonEra(NSTimeInterval when)
-{
-  int r;
-
-  // Get reference date in terms of days
-  when /= 86400.0;
-  // Offset by Gregorian reference
-  when += GREGORIAN_REFERENCE;
-  r = (NSInteger)when;
-  return r;
-}
-
+/*
+ * The inverse of absoluteGregorianDay() ... constant time for any day
+ * in the common era, falling back to searching year by year and month
+ * by month for earlier days.
+ */
 static void
 gregorianDateFromAbsolute(NSInteger abs, int *day, int *month, int *year)
 {
+  if (abs >= 1)
+    {
+      NSUInteger	z = abs + 305;	// Days since 1st March 0 AD
+      NSUInteger	cycle = z / 146097;
+      NSUInteger	dayOfCycle = z - cycle * 146097;
+      NSUInteger	yearOfCycle;
+      NSUInteger	dayOfYear;
+      NSUInteger	m;
+
+      /* Allow for the leap days in a cycle (one every 1460 days, except
+       * every 36524 days, except the last day of the cycle).
+       */
+      yearOfCycle = (dayOfCycle - dayOfCycle / 1460 + dayOfCycle / 36524
+	- dayOfCycle / 146096) / 365;
+      dayOfYear = dayOfCycle
+	- (365 * yearOfCycle + yearOfCycle / 4 - yearOfCycle / 100);
+      m = (5 * dayOfYear + 2) / 153;	// Month starting at March as 0
+      *day = dayOfYear - (153 * m + 2) / 5 + 1;
+      *month = (m < 10) ? m + 3 : m - 9;
+      *year = cycle * 400 + yearOfCycle + (*month <= 2 ? 1 : 0);
+      return;
+    }
   // Search forward year by year from approximate year
   *year = abs/366;
   while (abs >= absoluteGregorianDay(1, 1, (*year)+1))
@@ -240,6 +283,113 @@ GSTime(unsigned day, unsigned month, unsigned year, unsigned hour, unsigned minu
   return a;
 }
 
+/* Days in the months before each month of a year which is not a leap year.
+ */
+static const uint16_t	daysBeforeMonth[13] = {
+  0, 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+};
+
+/*
+ * Set the time of day fields from a number of seconds into the day.
+ */
+static inline void
+breakTimeOfDay(double secs, GSCalendarFields *f)
+{
+  int	s = (int)secs;
+  int	mil = (int)((secs - s) * 1000.0 + 0.5);
+
+  if (mil > 999)
+    {
+      mil = 999;
+    }
+  f->hour = s / 3600;
+  f->minute = (s % 3600) / 60;
+  f->second = s % 60;
+  f->millisecond = mil;
+}
+
+/*
+ * Break a time interval since the reference date (already adjusted by
+ * the time zone offset) into calendar fields, leaving the offset field
+ * of the result untouched.
+ */
+static void
+breakDown(NSTimeInterval when, GSCalendarFields *f)
+{
+  double	days = floor(when / 86400.0);
+  double	secs = when - days * 86400.0;
+  NSInteger	dayOfEra;
+  int		year;
+  int		month;
+  int		day;
+
+  /* Guard against rounding putting us just outside the day.
+   */
+  if (secs < 0.0)
+    {
+      days -= 1.0;
+      secs += 86400.0;
+    }
+  else if (secs >= 86400.0)
+    {
+      days += 1.0;
+      secs -= 86400.0;
+    }
+  dayOfEra = (NSInteger)days + GREGORIAN_REFERENCE;
+  gregorianDateFromAbsolute(dayOfEra, &day, &month, &year);
+
+  f->year = year;
+  f->month = month;
+  f->day = day;
+  f->dayOfYear = day;
+  if (month >= 1 && month <= 12)
+    {
+      f->dayOfYear += daysBeforeMonth[month];
+      if (month > 2 && lastDayOfGregorianMonth(2, year) == 29)
+	{
+	  f->dayOfYear++;
+	}
+    }
+  f->dayOfCommonEra = dayOfEra;
+  /* The era started on a sunday.
+     Did we always have a seven day week?
+     Did we lose week days changing from Julian to Gregorian?
+     AFAIK seven days a week is ok for all reasonable dates.  */
+  dayOfEra %= 7;
+  if (dayOfEra < 0)
+    {
+      dayOfEra += 7;
+    }
+  f->dayOfWeek = dayOfEra;
+  breakTimeOfDay(secs, f);
+}
+
+/*
+ * As breakDown(), but when the time falls within the day starting at
+ * *dayStart, copy the date fields from *last rather than working them
+ * out again.  Otherwise *last and *dayStart are set for the new day.
+ * Used to break down runs of times in the same day cheaply.
+ */
+static inline void
+breakDownNear(NSTimeInterval when, GSCalendarFields *f,
+  GSCalendarFields *last, NSTimeInterval *dayStart)
+{
+  NSTimeInterval	secs = when - *dayStart;
+
+  if (secs >= 0.0 && secs < 86400.0)
+    {
+      *f = *last;
+      breakTimeOfDay(secs, f);
+    }
+  else
+    {
+      breakDown(when, f);
+      *last = *f;
+      *dayStart = (NSTimeInterval)(f->dayOfCommonEra - GREGORIAN_REFERENCE)
+	* 86400.0;
+    }
+}
+
 /**
  * Convert a time interval since the reference date into broken out
  * elements.<br />
@@ -249,35 +399,16 @@ void
 GSBreakTime(NSTimeInterval when, int *year, int *month, int *day,
   int *hour, int *minute, int *second, int *mil)
 {
-  int h, m, dayOfEra;
-  double a, b, c, d;
-
-  // Get reference date in terms of days
-  a = when / 86400.0;
-  // Offset by Gregorian reference
-  a += GREGORIAN_REFERENCE;
-  // result is the day of common era.
-  dayOfEra = (NSInteger)a;
-
-  // Calculate year, month, and day
-  gregorianDateFromAbsolute(dayOfEra, day, month, year);
-
-  // Calculate hour, minute, and seconds
-  d = dayOfEra - GREGORIAN_REFERENCE;
-  d *= 86400;
-  a = abs(d - when);
-  b = a / 3600;
-  *hour = (NSInteger)b;
-  h = *hour;
-  h = h * 3600;
-  b = a - h;
-  b = b / 60;
-  *minute = (NSInteger)b;
-  m = *minute;
-  m = m * 60;
-  c = a - h - m;
-  *second = (NSInteger)c;
-  *mil = (NSInteger)((a - h - m - c) * 1000.0 + 0.5);
+  GSCalendarFields	f;
+
+  breakDown(when, &f);
+  *year = f.year;
+  *month = f.month;
+  *day = f.day;
+  *hour = f.hour;
+  *minute = f.minute;
+  *second = f.second;
+  *mil = f.millisecond;
 }
 
 /**
@@ -1622,16 +1753,27 @@ static inline int getDigits(const char *from, char *to, int limit, BOOL *error)
   return self;
 }
 
+/*
+ * Return the calendar fields of a date in its time zone, looking up the
+ * offset and breaking the date down only once for all the fields needed.
+ */
+static inline GSCalendarFields
+fieldsOf(NSCalendarDate *d)
+{
+  GSCalendarFields	f;
+
+  f.offset = offset(d->_time_zone, d);
+  breakDown(d->_seconds_since_ref + f.offset, &f);
+  return f;
+}
+
 /**
  * Return the day number (ie number of days since the start of) in the
  * 'common' era of the receiving date.  The era starts at 1 A.D.
  */
 - (NSInteger) dayOfCommonEra
 {
-  NSTimeInterval	when;
-
-  when = _seconds_since_ref + offset(_time_zone, self);
-  return dayOfCommonEra(when);
+  return fieldsOf(self).dayOfCommonEra;
 }
 
 /**
@@ -1639,13 +1781,7 @@ static inline int getDigits(const char *from, char *to, int limit, BOOL *error)
  */
 - (NSInteger) dayOfMonth
 {
-  int m, d, y;
-  NSTimeInterval	when;
-
-  when = _seconds_since_ref + offset(_time_zone, self);
-  gregorianDateFromAbsolute(dayOfCommonEra(when), &d, &m, &y);
-
-  return d;
+  return fieldsOf(self).day;
 }
 
 /**
@@ -1662,20 +1798,7 @@ static inline int getDigits(const char *from, char *to, int limit, BOOL *error)
  */
 - (NSInteger) dayOfWeek
 {
-  int	d;
-  NSTimeInterval	when;
-
-  when = _seconds_since_ref + offset(_time_zone, self);
-  d = dayOfCommonEra(when);
-
-  /* The era started on a sunday.
-     Did we always have a seven day week?
-     Did we lose week days changing from Julian to Gregorian?
-     AFAIK seven days a week is ok for all reasonable dates.  */
-  d = d % 7;
-  if (d < 0)
-    d += 7;
-  return d;
+  return fieldsOf(self).dayOfWeek;
 }
 
 /**
@@ -1683,16 +1806,7 @@ static inline int getDigits(const char *from, char *to, int limit, BOOL *error)
  */
 - (NSInteger) dayOfYear
 {
-  int m, d, y, days, i;
-  NSTimeInterval	when;
-
-  when = _seconds_since_ref + offset(_time_zone, self);
-  gregorianDateFromAbsolute(dayOfCommonEra(when), &d, &m, &y);
-  days = d;
-  for (i = m - 1;  i > 0; i--) // days in prior months this year
-    days = days + lastDayOfGregorianMonth(i, y);
-
-  return days;
+  return fieldsOf(self).dayOfYear;
 }
 
 /**
@@ -1700,24 +1814,7 @@ static inline int getDigits(const char *from, char *to, int limit, BOOL *error)
  */
 - (NSInteger) hourOfDay
 {
-  int h;
-  double a, d;
-  NSTimeInterval	when;
-
-  when = _seconds_since_ref + offset(_time_zone, self);
-  d = dayOfCommonEra(when);
-  d -= GREGORIAN_REFERENCE;
-  d *= 86400;
-  a = abs(d - (_seconds_since_ref + offset(_time_zone, self)));
-  a = a / 3600;
-  h = (NSInteger)a;
-
-  // There is a small chance of getting
-  // it right at the stroke of midnight
-  if (h == 24)
-    h = 0;
-
-  return h;
+  return fieldsOf(self).hour;
 }
 
 /**
@@ -1725,23 +1822,7 @@ static inline int getDigits(const char *from, char *to, int limit, BOOL *error)
  */
 - (NSInteger) minuteOfHour
 {
-  int h, m;
-  double a, b, d;
-  NSTimeInterval	when;
-
-  when = _seconds_since_ref + offset(_time_zone, self);
-  d = dayOfCommonEra(when);
-  d -= GREGORIAN_REFERENCE;
-  d *= 86400;
-  a = abs(d - (_seconds_since_ref + offset(_time_zone, self)));
-  b = a / 3600;
-  h = (NSInteger)b;
-  h = h * 3600;
-  b = a - h;
-  b = b / 60;
-  m = (NSInteger)b;
-
-  return m;
+  return fieldsOf(self).minute;
 }
 
 /**
@@ -1749,13 +1830,7 @@ static inline int getDigits(const char *from, char *to, int limit, BOOL *error)
  */
 - (NSInteger) monthOfYear
 {
-  int m, d, y;
-  NSTimeInterval	when;
-
-  when = _seconds_since_ref + offset(_time_zone, self);
-  gregorianDateFromAbsolute(dayOfCommonEra(when), &d, &m, &y);
-
-  return m;
+  return fieldsOf(self).month;
 }
 
 /**
@@ -1763,26 +1838,7 @@ static inline int getDigits(const char *from, char *to, int limit, BOOL *error)
  */
 - (NSInteger) secondOfMinute
 {
-  int h, m, s;
-  double a, b, c, d;
-  NSTimeInterval	when;
-
-  when = _seconds_since_ref + offset(_time_zone, self);
-  d = dayOfCommonEra(when);
-  d -= GREGORIAN_REFERENCE;
-  d *= 86400;
-  a = abs(d - (_seconds_since_ref + offset(_time_zone, self)));
-  b = a / 3600;
-  h = (NSInteger)b;
-  h = h * 3600;
-  b = a - h;
-  b = b / 60;
-  m = (NSInteger)b;
-  m = m * 60;
-  c = a - h - m;
-  s = (NSInteger)c;
-
-  return s;
+  return fieldsOf(self).second;
 }
 
 /**
@@ -1791,13 +1847,7 @@ static inline int getDigits(const char *from, char *to, int limit, BOOL *error)
  */
 - (NSInteger) yearOfCommonEra
 {
-  int m, d, y;
-  NSTimeInterval	when;
-
-  when = _seconds_since_ref + offset(_time_zone, self);
-  gregorianDateFromAbsolute(dayOfCommonEra(when), &d, &m, &y);
-
-  return y;
+  return fieldsOf(self).year;
 }
 
 /**
@@ -1853,6 +1903,9 @@ typedef struct {
   int		mnd;
   int		sd;
   int		mil;
+  int		doy;
+  int		dow;
+  int		tzOffset;
 } DescriptionInfo;
 
 static void Grow(DescriptionInfo *info, unsigned size)
@@ -2094,16 +2147,7 @@ static void outputValueWithFormat(int v, char *fldfmt, DescriptionInfo *info)
 		break;
 
 	      case 'F': 	// milliseconds
-		{
-		  double	s;
-
-		  s = ([self dayOfCommonEra] - GREGORIAN_REFERENCE) * 86400.0;
-		  s -= (_seconds_since_ref + offset(_time_zone, self));
-		  s = fabs(s);
-		  s -= floor(s);
-		  s *= 1000.0;
-		  v = (NSInteger)(s + 0.5);
-		}
+		v = info->mil;
 		if (fmtlen == 1) // no format width specified; supply default
 		  {
 		    fldfmt[fmtlen++] = '0';
@@ -2115,7 +2159,7 @@ static void outputValueWithFormat(int v, char *fldfmt, DescriptionInfo *info)
 		break;
 
 	      case 'j': 	// day of year
-		v = [self dayOfYear];
+		v = info->doy;
 		if (fmtlen == 1) // no format width specified; supply default
 		  {
 		    fldfmt[fmtlen++] = '0';
@@ -2133,7 +2177,7 @@ static void outputValueWithFormat(int v, char *fldfmt, DescriptionInfo *info)
 		dtag = YES;   // Day is character string
 	      case 'w':
 		{
-		  v = [self dayOfWeek];
+		  v = info->dow;
 		  if (dtag == YES)
 		    {
 		      NSArray	*days;
@@ -2286,7 +2330,7 @@ static void outputValueWithFormat(int v, char *fldfmt, DescriptionInfo *info)
 		  int	z;
 
 		  Grow(info, 5);
-		  z = offset(_time_zone, self);
+		  z = info->tzOffset;
 		  if (z < 0)
 		    {
 		      z = -z;
@@ -2425,14 +2469,24 @@ static void outputValueWithFormat(int v, char *fldfmt, DescriptionInfo *info)
   unichar		tbuf[512];
   NSString		*result;
   DescriptionInfo	info;
+  GSCalendarFields	f;
 
   if (locale == nil)
     locale = GSPrivateDefaultLocale();
   if (format == nil)
     format = [locale objectForKey: NSTimeDateFormatString];
 
-  GSBreakTime(_seconds_since_ref + offset(_time_zone, self),
-    &info.yd, &info.md, &info.dom, &info.hd, &info.mnd, &info.sd, &info.mil);
+  f = fieldsOf(self);
+  info.yd = f.year;
+  info.md = f.month;
+  info.dom = f.day;
+  info.hd = f.hour;
+  info.mnd = f.minute;
+  info.sd = f.second;
+  info.mil = f.millisecond;
+  info.doy = f.dayOfYear;
+  info.dow = f.dayOfWeek;
+  info.tzOffset = f.offset;
 
   info.base = tbuf;
   info.t = tbuf;
@@ -2451,6 +2505,583 @@ static void outputValueWithFormat(int v, char *fldfmt, DescriptionInfo *info)
   return result;
 }
 
+/*
+ * Fixed format dates (see GSPrivate.h) for NSDateFormatter and for the
+ * timestamps in HTTP headers and property lists.
+ * We only handle fields whose text is the same in all the locales we are
+ * used for, and dates in the gregorian calendar (ICU uses the julian
+ * calendar before October 1582), so that the results match ICU exactly.
+ */
+enum {
+  FixedLiteral = 0,
+  FixedYear,
+  FixedMonth,
+  FixedMonthName,
+  FixedDay,
+  FixedWeekdayName,
+  FixedHour,
+  FixedMinute,
+  FixedSecond,
+  FixedFraction,
+  FixedZoneBasic,		// +hhmm
+  FixedZoneExtended,		// +hh:mm
+  FixedZoneISOBasic,		// Z or +hhmm
+  FixedZoneISOExtended,		// Z or +hh:mm
+  FixedZoneName,		// GMT or UTC
+  FixedInvalid
+};
+#define	FixedZones	((1<<FixedZoneBasic) | (1<<FixedZoneExtended) \
+  | (1<<FixedZoneISOBasic) | (1<<FixedZoneISOExtended) | (1<<FixedZoneName))
+#define	FixedFirstYear	1583
+#define	FixedLastYear	9999
+
+static const char	*fixedMonths[12] = {
+  "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+  "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+};
+static const char	*fixedDays[7] = {
+  "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+};
+
+static BOOL
+fixedAdd(GSFixedDateFormat *f, unsigned kind, unichar arg, NSUInteger *size)
+{
+  static const uint8_t	widths[] = {1, 4, 2, 3, 2, 3, 2, 2, 2, 0, 5, 6, 6, 6, 3};
+
+  if (kind == FixedInvalid || f->count == GS_FIXED_DATE_FIELDS)
+    {
+      return NO;
+    }
+  if (kind == FixedLiteral)
+    {
+      if (arg < ' ' || arg > '~')
+	{
+	  return NO;	// Only printable ASCII literals.
+	}
+    }
+  else
+    {
+      /* Each field may appear only once, and there may be one offset.
+       */
+      if ((f->seen & (1 << kind)) != 0
+	|| (((1 << kind) & FixedZones) != 0 && (f->seen & FixedZones) != 0))
+	{
+	  return NO;
+	}
+      f->seen |= (1 << kind);
+    }
+  *size += (kind == FixedFraction) ? arg : widths[kind];
+  if (*size > GS_FIXED_DATE_LENGTH)
+    {
+      return NO;
+    }
+  f->kind[f->count] = kind;
+  f->arg[f->count] = arg;
+  f->count++;
+  return YES;
+}
+
+BOOL
+GSPrivateFixedDateCompile(NSString *pattern, GSFixedDateFormat *f)
+{
+  NSUInteger	length = [pattern length];
+  NSUInteger	size = 0;
+  NSUInteger	i = 0;
+  unichar	buf[GS_FIXED_DATE_LENGTH];
+
+  f->count = 0;
+  f->hasNames = 0;
+  f->seen = 0;
+  if (length == 0 || length > GS_FIXED_DATE_LENGTH)
+    {
+      return NO;
+    }
+  [pattern getCharacters: buf range: NSMakeRange(0, length)];
+  while (i < length)
+    {
+      unichar	c = buf[i];
+      NSUInteger	n = 1;
+      unsigned	kind = FixedLiteral;
+      unichar	arg = c;
+
+      if (c == '\'' && i + 1 < length && buf[i + 1] == '\'')
+	{
+	  n = 2;	// Two quotes stand for one.
+	}
+      else if (c == '\'')
+	{
+	  /* Quoted literal text (in which two quotes stand for one).
+	   */
+	  for (i++; i < length; i++)
+	    {
+	      c = buf[i];
+	      if (c == '\'')
+		{
+		  if (i + 1 == length || buf[i + 1] != '\'')
+		    {
+		      break;
+		    }
+		  i++;
+		}
+	      if (fixedAdd(f, FixedLiteral, c, &size) == NO)
+		{
+		  f->count = 0;
+		  return NO;
+		}
+	    }
+	  if (i == length)
+	    {
+	      f->count = 0;
+	      return NO;	// Unterminated quote.
+	    }
+	  i++;
+	  continue;
+	}
+      else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+	{
+	  while (i + n < length && buf[i + n] == c)
+	    {
+	      n++;
+	    }
+	  arg = 0;
+	  switch (c)
+	    {
+	      case 'y':
+		kind = (n == 1 || n == 4) ? FixedYear : FixedInvalid;
+		break;
+	      case 'M':
+		kind = (n == 2) ? FixedMonth
+		  : (n == 3) ? FixedMonthName : FixedInvalid;
+		break;
+	      case 'd':
+		kind = (n == 2) ? FixedDay : FixedInvalid;
+		break;
+	      case 'E':
+		kind = (n <= 3) ? FixedWeekdayName : FixedInvalid;
+		break;
+	      case 'H':
+		kind = (n == 2) ? FixedHour : FixedInvalid;
+		break;
+	      case 'm':
+		kind = (n == 2) ? FixedMinute : FixedInvalid;
+		break;
+	      case 's':
+		kind = (n == 2) ? FixedSecond : FixedInvalid;
+		break;
+	      case 'S':
+		kind = (n <= 9) ? FixedFraction : FixedInvalid;
+		arg = n;
+		break;
+	      case 'Z':
+		kind = (n <= 3) ? FixedZoneBasic
+		  : (n == 5) ? FixedZoneISOExtended : FixedInvalid;
+		break;
+	      case 'X':
+		kind = (n == 2) ? FixedZoneISOBasic
+		  : (n == 3) ? FixedZoneISOExtended : FixedInvalid;
+		break;
+	      case 'x':
+		kind = (n == 2) ? FixedZoneBasic
+		  : (n == 3) ? FixedZoneExtended : FixedInvalid;
+		break;
+	      case 'z':
+		kind = (n <= 3) ? FixedZoneName : FixedInvalid;
+		break;
+	      default:
+		kind = FixedInvalid;
+	    }
+	  if (kind == FixedMonthName || kind == FixedWeekdayName)
+	    {
+	      f->hasNames = 1;
+	    }
+	}
+      if (fixedAdd(f, kind, arg, &size) == NO)
+	{
+	  f->count = 0;
+	  return NO;
+	}
+      i += n;
+    }
+
+  /* We need a complete date so that parsing doesn't depend on defaults.
+   */
+  if ((f->seen & (1 << FixedYear)) == 0
+    || (f->seen & ((1 << FixedMonth) | (1 << FixedMonthName))) == 0
+    || (f->seen & (1 << FixedDay)) == 0)
+    {
+      f->count = 0;
+      return NO;
+    }
+  return YES;
+}
+
+static inline char*
+fixedDigits(char *p, unsigned v, unsigned width)
+{
+  char	*e = p + width;
+
+  while (e > p)
+    {
+      *--e = '0' + v % 10;
+      v /= 10;
+    }
+  return p + width;
+}
+
+NSUInteger
+GSPrivateFixedDateFormat(const GSFixedDateFormat *f, NSDate *date,
+  NSTimeZone *tz, char *buf)
+{
+  GSCalendarFields	fields;
+  NSTimeInterval	millis;
+  NSTimeInterval	secs;
+  const char		*zoneName = "GMT";
+  unsigned		ms;
+  int			off;
+  char			*p = buf;
+  unsigned		i;
+
+  if (f->count == 0)
+    {
+      return 0;
+    }
+
+  /* Work in whole milliseconds since 1970 as ICU does, so that fractions
+   * of a second are truncated in the same way.
+   */
+  millis = floor([date timeIntervalSince1970] * 1000.0);
+  if (!(millis > -1.0e16 && millis < 1.0e16))
+    {
+      return 0;		// Not a number, or nowhere near our range of years.
+    }
+  secs = floor(millis / 1000.0);
+  ms = (unsigned)(millis - secs * 1000.0);
+
+  if (tz == nil)
+    {
+      off = 0;
+    }
+  else if ([date isKindOfClass: NSCalendarDateClass]
+    && ((NSCalendarDate*)date)->_time_zone == tz)
+    {
+      /* A calendar date in the same zone may have its offset cached.
+       */
+      off = fieldsOf((NSCalendarDate*)date).offset;
+    }
+  else
+    {
+      off = offset(tz, date);
+    }
+  if (off % 60 != 0)
+    {
+      return 0;		// ICU would show the seconds of the offset.
+    }
+  if (f->seen & (1 << FixedZoneName))
+    {
+      if (off != 0)
+	{
+	  return 0;	// ICU would use a localised name.
+	}
+      if (tz != nil)
+	{
+	  NSString	*name = [tz name];
+
+	  if ([name isEqualToString: @"UTC"])
+	    {
+	      zoneName = "UTC";
+	    }
+	  else if ([name isEqualToString: @"GMT"] == NO)
+	    {
+	      return 0;
+	    }
+	}
+    }
+
+  breakDown(secs - NSTimeIntervalSince1970 + off, &fields);
+  if (fields.year < FixedFirstYear || fields.year > FixedLastYear)
+    {
+      return 0;
+    }
+
+  for (i = 0; i < f->count; i++)
+    {
+      unsigned	kind = f->kind[i];
+
+      switch (kind)
+	{
+	  case FixedLiteral:
+	    *p++ = f->arg[i];
+	    break;
+	  case FixedYear:
+	    p = fixedDigits(p, fields.year, 4);
+	    break;
+	  case FixedMonth:
+	    p = fixedDigits(p, fields.month, 2);
+	    break;
+	  case FixedMonthName:
+	    memcpy(p, fixedMonths[fields.month - 1], 3);
+	    p += 3;
+	    break;
+	  case FixedDay:
+	    p = fixedDigits(p, fields.day, 2);
+	    break;
+	  case FixedWeekdayName:
+	    memcpy(p, fixedDays[fields.dayOfWeek], 3);
+	    p += 3;
+	    break;
+	  case FixedHour:
+	    p = fixedDigits(p, fields.hour, 2);
+	    break;
+	  case FixedMinute:
+	    p = fixedDigits(p, fields.minute, 2);
+	    break;
+	  case FixedSecond:
+	    p = fixedDigits(p, fields.second, 2);
+	    break;
+	  case FixedFraction:
+	    {
+	      unsigned	n = f->arg[i];
+
+	      /* Truncate to fewer than three digits, pad to more.
+	       */
+	      if (n < 3)
+		{
+		  p = fixedDigits(p, (n == 1) ? ms / 100 : ms / 10, n);
+		}
+	      else
+		{
+		  p = fixedDigits(p, ms, 3);
+		  while (n-- > 3)
+		    {
+		      *p++ = '0';
+		    }
+		}
+	    }
+	    break;
+	  case FixedZoneName:
+	    memcpy(p, zoneName, 3);
+	    p += 3;
+	    break;
+	  default:
+	    {
+	      unsigned	mins = (off < 0 ? -off : off) / 60;
+
+	      if (off == 0
+		&& (kind == FixedZoneISOBasic || kind == FixedZoneISOExtended))
+		{
+		  *p++ = 'Z';
+		  break;
+		}
+	      *p++ = (off < 0) ? '-' : '+';
+	      p = fixedDigits(p, mins / 60, 2);
+	      if (kind == FixedZoneExtended || kind == FixedZoneISOExtended)
+		{
+		  *p++ = ':';
+		}
+	      p = fixedDigits(p, mins % 60, 2);
+	    }
+	}
+    }
+  return p - buf;
+}
+
+static inline BOOL
+fixedNumber(const char **pp, const char *end, unsigned width, unsigned *v)
+{
+  const char	*p = *pp;
+  unsigned	n = 0;
+
+  if (end - p < (NSInteger)width)
+    {
+      return NO;
+    }
+  while (width-- > 0)
+    {
+      char	c = *p++;
+
+      if (c < '0' || c > '9')
+	{
+	  return NO;
+	}
+      n = n * 10 + c - '0';
+    }
+  *pp = p;
+  *v = n;
+  return YES;
+}
+
+static inline int
+fixedName(const char **pp, const char *end, const char **names, int count)
+{
+  if (end - *pp >= 3)
+    {
+      int	i;
+
+      for (i = 0; i < count; i++)
+	{
+	  if (memcmp(*pp, names[i], 3) == 0)
+	    {
+	      *pp += 3;
+	      return i;
+	    }
+	}
+    }
+  return -1;
+}
+
+BOOL
+GSPrivateFixedDateParse(const GSFixedDateFormat *f, const char *buf,
+  NSUInteger length, NSTimeZone *tz, NSTimeInterval *since1970)
+{
+  const char		*p = buf;
+  const char		*end = buf + length;
+  unsigned		year = 0;
+  unsigned		month = 0;
+  unsigned		day = 0;
+  unsigned		hour = 0;
+  unsigned		minute = 0;
+  unsigned		second = 0;
+  unsigned		ms = 0;
+  int			weekday = -1;
+  int			off = 0;
+  BOOL			hasOffset = NO;
+  NSUInteger		abs;
+  NSTimeInterval	secs;
+  unsigned		i;
+
+  if (f->count == 0)
+    {
+      return NO;
+    }
+  for (i = 0; i < f->count; i++)
+    {
+      unsigned	kind = f->kind[i];
+      BOOL	ok = YES;
+      int	v;
+
+      switch (kind)
+	{
+	  case FixedLiteral:
+	    ok = (p < end && *p++ == (char)f->arg[i]);
+	    break;
+	  case FixedYear:
+	    ok = fixedNumber(&p, end, 4, &year);
+	    break;
+	  case FixedMonth:
+	    ok = fixedNumber(&p, end, 2, &month);
+	    break;
+	  case FixedMonthName:
+	    v = fixedName(&p, end, fixedMonths, 12);
+	    month = v + 1;
+	    ok = (v >= 0);
+	    break;
+	  case FixedDay:
+	    ok = fixedNumber(&p, end, 2, &day);
+	    break;
+	  case FixedWeekdayName:
+	    weekday = fixedName(&p, end, fixedDays, 7);
+	    ok = (weekday >= 0);
+	    break;
+	  case FixedHour:
+	    ok = fixedNumber(&p, end, 2, &hour);
+	    break;
+	  case FixedMinute:
+	    ok = fixedNumber(&p, end, 2, &minute);
+	    break;
+	  case FixedSecond:
+	    ok = fixedNumber(&p, end, 2, &second);
+	    break;
+	  case FixedFraction:
+	    {
+	      unsigned	n = f->arg[i];
+
+	      /* Scale to milliseconds, truncating any extra digits.
+	       */
+	      ok = fixedNumber(&p, end, n, &ms);
+	      while (n < 3)
+		{
+		  ms *= 10;
+		  n++;
+		}
+	      while (n-- > 3)
+		{
+		  ms /= 10;
+		}
+	    }
+	    break;
+	  case FixedZoneName:
+	    ok = (end - p >= 3
+	      && (memcmp(p, "GMT", 3) == 0 || memcmp(p, "UTC", 3) == 0));
+	    p += 3;
+	    hasOffset = YES;
+	    break;
+	  default:
+	    hasOffset = YES;
+	    if (p < end && *p == 'Z'
+	      && (kind == FixedZoneISOBasic || kind == FixedZoneISOExtended))
+	      {
+		p++;
+	      }
+	    else
+	      {
+		unsigned	h;
+		unsigned	m;
+		int		sign;
+
+		if (p == end || (*p != '+' && *p != '-'))
+		  {
+		    return NO;
+		  }
+		sign = (*p++ == '-') ? -1 : 1;
+		ok = fixedNumber(&p, end, 2, &h);
+		if (ok == YES
+		  && (kind == FixedZoneExtended || kind == FixedZoneISOExtended))
+		  {
+		    ok = (p < end && *p++ == ':');
+		  }
+		ok = ok && fixedNumber(&p, end, 2, &m) && h < 24 && m < 60;
+		off = sign * (int)(h * 3600 + m * 60);
+	      }
+	}
+      if (ok == NO)
+	{
+	  return NO;
+	}
+    }
+  if (p != end
+    || year < FixedFirstYear || year > FixedLastYear
+    || month < 1 || month > 12
+    || day < 1 || day > lastDayOfGregorianMonth(month, year)
+    || hour > 23 || minute > 59 || second > 59)
+    {
+      return NO;
+    }
+  abs = absoluteGregorianDay(day, month, year);
+  if (weekday >= 0 && weekday != (int)(abs % 7))
+    {
+      return NO;	// Let ICU decide what an inconsistent date means.
+    }
+  if (hasOffset == NO && tz != nil)
+    {
+      /* Without an offset in the text we can only be sure of getting the
+       * same answer as ICU if the time zone has no daylight saving time.
+       */
+      if (tz == localTZ)
+	{
+	  tz = [NSTimeZone defaultTimeZone];
+	}
+      if (object_getClass(tz) != absClass)
+	{
+	  return NO;
+	}
+      off = offset(tz, nil);
+    }
+  secs = ((NSTimeInterval)abs - GREGORIAN_REFERENCE) * 86400.0
+    + hour * 3600 + minute * 60 + second - off;
+  *since1970 = ((secs + NSTimeIntervalSince1970) * 1000.0 + ms) / 1000.0;
+  return YES;
+}
+
 - (id) copyWithZone: (NSZone*)zone
 {
   NSCalendarDate	*newDate;
@@ -2543,6 +3174,62 @@ static void outputValueWithFormat(int v, char *fldfmt, DescriptionInfo *info)
 
 @end
 
+@implementation NSCalendarDate (GSCalendarFields)
+
++ (void) getFields: (GSCalendarFields*)fields
+  forTimeIntervals: (const NSTimeInterval*)intervals
+	     count: (NSUInteger)count
+	  timeZone: (NSTimeZone*)aTimeZone
+{
+  GSCalendarFields	day;
+  NSTimeInterval	dayStart = HUGE_VAL;
+  NSUInteger		i;
+
+  if (aTimeZone == nil || aTimeZone == localTZ)
+    {
+      /* Look up the default zone once rather than for each interval.
+       */
+      aTimeZone = [NSTimeZone defaultTimeZone];
+    }
+  if (object_getClass(aTimeZone) == absClass)
+    {
+      int	o = offset(aTimeZone, nil);
+
+      /* A fixed offset from GMT, so there is no need to create any date.
+       */
+      for (i = 0; i < count; i++)
+	{
+	  breakDownNear(intervals[i] + o, &fields[i], &day, &dayStart);
+	  fields[i].offset = o;
+	}
+    }
+  else
+    {
+      NSCalendarDate	*d;
+      int		o = 0;
+
+      /* We need a date to ask the zone for each offset, but can reuse a
+       * single one for all the intervals, and the offset can only differ
+       * from the last one we looked up at a different time.
+       */
+      d = [[NSCalendarDateClass alloc]
+	initWithTimeIntervalSinceReferenceDate: 0.0];
+      for (i = 0; i < count; i++)
+	{
+	  if (i == 0 || intervals[i] != intervals[i - 1])
+	    {
+	      d->_seconds_since_ref = intervals[i];
+	      o = offset(aTimeZone, d);
+	    }
+	  breakDownNear(intervals[i] + o, &fields[i], &day, &dayStart);
+	  fields[i].offset = o;
+	}
+      RELEASE(d);
+    }
+}
+
+@end
+
 /**
  * Routines for manipulating Gregorian dates.
  */
@@ -2608,14 +3295,20 @@ static void outputValueWithFormat(int v, char *fldfmt, DescriptionInfo *info)
   NSTimeInterval	s;
   NSTimeInterval	oldOffset;
   NSTimeInterval	newOffset;
+  GSCalendarFields	f;
   int			i, year, month, day, hour, minute, second, mil;
 
-  /* Apply timezone offset to _seconds_since_ref from GMT to local time,
-   * then break into components in local time zone.
+  /* Get the components of _seconds_since_ref in the local time zone.
    */
-  oldOffset = offset(_time_zone, self);
-  s = _seconds_since_ref + oldOffset;
-  GSBreakTime(s, &year, &month, &day, &hour, &minute, &second, &mil);
+  f = fieldsOf(self);
+  oldOffset = f.offset;
+  year = f.year;
+  month = f.month;
+  day = f.day;
+  hour = f.hour;
+  minute = f.minute;
+  second = f.second;
+  mil = f.millisecond;
 
   /* Apply required offsets to get new local time.
    */
@@ -2768,7 +3461,7 @@ static void outputValueWithFormat(int v, char *fldfmt, DescriptionInfo *info)
   int			diff;
   int			extra;
   int			sign;
-  int			mil;
+  GSCalendarFields	f;
   int			syear, smonth, sday, shour, sminute, ssecond;
   int			eyear, emonth, eday, ehour, eminute, esecond;
 
@@ -2804,11 +3497,21 @@ static void outputValueWithFormat(int v, char *fldfmt, DescriptionInfo *info)
       sign = -1;
     }
 
-  GSBreakTime(start->_seconds_since_ref + offset(start->_time_zone, start),
-    &syear, &smonth, &sday, &shour, &sminute, &ssecond, &mil);
-
-  GSBreakTime(end->_seconds_since_ref + offset(end->_time_zone, end),
-    &eyear, &emonth, &eday, &ehour, &eminute, &esecond, &mil);
+  f = fieldsOf(start);
+  syear = f.year;
+  smonth = f.month;
+  sday = f.day;
+  shour = f.hour;
+  sminute = f.minute;
+  ssecond = f.second;
+
+  f = fieldsOf(end);
+  eyear = f.year;
+  emonth = f.month;
+  eday = f.day;
+  ehour = f.hour;
+  eminute = f.minute;
+  esecond = f.second;
 
   if (esecond < ssecond)
     {
@@ -62,6 +62,9 @@ typedef GSIMapNode_t *GSIMapNode;
   size_t	chunkCount;	/* Number of chunks in array.	*/
   size_t	increment;	/* Amount to grow by.		*/
   unsigned long	version;	/* For fast enumeration.	*/
+  uintptr_t	purgeBucket;	/* Next bucket to purge.	*/
+  NSUInteger	purged;		/* Zeroed entries removed.	*/
+  NSUInteger	sweeps;		/* Full purges done.		*/
   BOOL		legacy;		/* old style callbacks?		*/
   union {
     PFInfo	pf;
@@ -73,6 +76,8 @@ typedef GSIMapNode_t *GSIMapNode;
 #define	GSI_MAP_HAS_VALUE	0
 #define	GSI_MAP_KTYPES	GSUNION_PTR | GSUNION_OBJ
 #define	GSI_MAP_TABLE_T	NSConcreteHashTable
+#define	GSI_MAP_PURGE_CURSOR(M)	(M->purgeBucket)
+#define	GSI_MAP_PURGED(M, N)	(M->purged += (N))
 
 #define GSI_MAP_HASH(M, X)\
  (M->legacy ? M->cb.old.hash(M, X.ptr) \
@@ -926,7 +931,11 @@ const NSHashTableCallBacks NSPointerToStructHashCallBacks =
 
 - (NSUInteger) count
 {
-  GSIMapRemoveWeak(self);
+  if (GSI_MAP_ZEROED(self) && nodeCount > 0)
+    {
+      GSIMapRemoveWeak(self);
+      sweeps++;
+    }
   return (NSUInteger)nodeCount;
 }
 
@@ -1066,6 +1075,12 @@ const NSHashTableCallBacks NSPointerToStructHashCallBacks =
     }
 }
 
+- (void) getPurged: (NSUInteger*)p sweeps: (NSUInteger*)s
+{
+  if (p) *p = purged;
+  if (s) *s = sweeps;
+}
+
 @end
 
 @implementation NSConcreteHashTableEnumerator
@@ -61,6 +61,9 @@ typedef GSIMapNode_t *GSIMapNode;
   size_t	chunkCount;	/* Number of chunks in array.	*/
   size_t	increment;	/* Amount to grow by.		*/
   unsigned long	version;	/* For fast enumeration.	*/
+  uintptr_t	purgeBucket;	/* Next bucket to purge.	*/
+  NSUInteger	purged;		/* Zeroed entries removed.	*/
+  NSUInteger	sweeps;		/* Full purges done.		*/
   BOOL		legacy;		/* old style callbacks?		*/
   union {
     struct {
@@ -76,6 +79,8 @@ typedef GSIMapNode_t *GSIMapNode;
 @end
 
 #define	GSI_MAP_TABLE_T	NSConcreteMapTable
+#define	GSI_MAP_PURGE_CURSOR(M)	(M->purgeBucket)
+#define	GSI_MAP_PURGED(M, N)	(M->purged += (N))
 
 #define	GSI_MAP_KTYPES	GSUNION_PTR | GSUNION_OBJ
 #define	GSI_MAP_VTYPES	GSUNION_PTR | GSUNION_OBJ
@@ -1202,7 +1207,11 @@ const NSMapTableValueCallBacks NSOwnedPointerMapValueCallBacks =
 
 - (NSUInteger) count
 {
-  GSIMapRemoveWeak(self);
+  if (GSI_MAP_ZEROED(self) && nodeCount > 0)
+    {
+      GSIMapRemoveWeak(self);
+      sweeps++;
+    }
   return (NSUInteger)nodeCount;
 }
 
@@ -1415,6 +1424,12 @@ const NSMapTableValueCallBacks NSOwnedPointerMapValueCallBacks =
   p->_x = self->cb.pf.v;
   return [p autorelease];
 }
+
+- (void) getPurged: (NSUInteger*)p sweeps: (NSUInteger*)s
+{
+  if (p) *p = purged;
+  if (s) *s = sweeps;
+}
 @end
 
 @implementation NSConcreteMapTableKeyEnumerator
@@ -68,6 +68,15 @@
   NSString		*_remoteName; \
   NSString		*_registeredName; \
   NSPortNameServer	*_nameServer; \
+  BOOL			_batchRequests; \
+  unsigned		_batchCount; \
+  NSMutableData		*_batchHeader; \
+  NSMutableArray	*_batchComponents; \
+  NSMutableArray	*_batchPending; \
+  NSMutableDictionary	*_classSignatures; \
+  NSMapTable		*_targetSignatures; \
+  NSTimer		*_asyncTimer; \
+  NSTimeInterval	_asyncDeadline; \
   int			_lastKeepalive
 
 #define	EXPOSE_NSDistantObject_IVARS	1
@@ -129,6 +138,7 @@ static GC_descr	nodeDesc;	// Type descriptor for map node.
 
 #import "Foundation/NSHashTable.h"
 #import "Foundation/NSMapTable.h"
+#import "Foundation/NSByteOrder.h"
 #import "Foundation/NSData.h"
 #import "Foundation/NSRunLoop.h"
 #import "Foundation/NSArray.h"
@@ -141,6 +151,7 @@ static GC_descr	nodeDesc;	// Type descriptor for map node.
 #import "Foundation/NSPort.h"
 #import "Foundation/NSPortMessage.h"
 #import "Foundation/NSPortNameServer.h"
+#import "Foundation/NSProxy.h"
 #import "Foundation/NSNotification.h"
 #import "GSInvocation.h"
 #import "GSPortPrivate.h"
@@ -206,6 +217,7 @@ static Class	distantObjectClass;
 static Class	sendCoderClass;
 static Class	recvCoderClass;
 static Class	runLoopClass;
+static Class	requestClass;
 
 static NSString*
 stringFromMsgType(int type)
@@ -232,6 +244,8 @@ stringFromMsgType(int type)
 	return @"proxy retain";
       case RETAIN_REPLY:
 	return @"retain replay";
+      case MESSAGE_BATCH:
+	return @"message batch";
       default:
 	return @"unknown operation type!";
     }
@@ -286,6 +300,90 @@ stringFromMsgType(int type)
 
 @end
 
+
+
+/*
+ * A peer asks a remote object for -_classNameForSignatures before it
+ * fetches the first method signature for it, and shares the signatures
+ * it obtains between all the remote objects with the same answer.
+ * Only an object whose signatures are those of its class may answer
+ * with a name.  Proxies (including protocol checkers) and instances of
+ * classes which override -methodSignatureForSelector: answer nil, so the
+ * peer keeps their signatures for each object.
+ */
+@interface	NSObject (GSSignatureSharing)
+- (NSString*) _classNameForSignatures;
+@end
+
+@implementation	NSObject (GSSignatureSharing)
+- (NSString*) _classNameForSignatures
+{
+  static IMP	sigImp = 0;
+  Class		c = object_getClass(self);
+
+  if (sigImp == 0)
+    {
+      sigImp = class_getMethodImplementation([NSObject class],
+	@selector(methodSignatureForSelector:));
+    }
+  if (class_getMethodImplementation(c,
+    @selector(methodSignatureForSelector:)) != sigImp)
+    {
+      return nil;
+    }
+  return NSStringFromClass(c);
+}
+@end
+
+@interface	NSProxy (GSSignatureSharing)
+- (NSString*) _classNameForSignatures;
+@end
+
+@implementation	NSProxy (GSSignatureSharing)
+- (NSString*) _classNameForSignatures
+{
+  return nil;
+}
+@end
+
+
+
+/*
+ * GSConnectionRequest records an asynchronous request which is awaiting
+ * its reply.  Instances are stored in the reply map of the connection in
+ * place of the placeholder used for synchronous requests, so the reply
+ * is matched to the request by its sequence number.
+ */
+@interface	GSConnectionRequest : NSObject
+{
+@public
+  NSInvocation			*inv;
+  GSConnectionCompletionBlock	block;
+  char				*type;
+  unsigned			seq;
+  BOOL				outParams;
+  NSTimeInterval		deadline;	/* Zero if none.	*/
+}
+@end
+
+@implementation	GSConnectionRequest
+
+- (void) dealloc
+{
+  RELEASE(inv);
+  if (block != 0)
+    {
+      [(id)block release];
+    }
+  if (type != 0)
+    {
+      NSZoneFree(NSDefaultMallocZone(), type);
+    }
+  [super dealloc];
+}
+
+@end
+
 
 
 /** <ignore> */
@@ -327,6 +425,15 @@ GS_PRIVATE_INTERNAL(NSConnection)
 #define	IregisteredName		(internal->_registeredName)
 #define	InameServer		(internal->_nameServer)
 #define	IlastKeepalive		(internal->_lastKeepalive)
+#define	IbatchRequests		(internal->_batchRequests)
+#define	IbatchCount		(internal->_batchCount)
+#define	IbatchHeader		(internal->_batchHeader)
+#define	IbatchComponents	(internal->_batchComponents)
+#define	IbatchPending		(internal->_batchPending)
+#define	IclassSignatures	(internal->_classSignatures)
+#define	ItargetSignatures	(internal->_targetSignatures)
+#define	IasyncTimer		(internal->_asyncTimer)
+#define	IasyncDeadline		(internal->_asyncDeadline)
 
 /** </ignore> */
 
@@ -340,14 +447,33 @@ GS_PRIVATE_INTERNAL(NSConnection)
 - (void) addLocalObject: (NSDistantObject*)anObj;
 - (void) removeLocalObject: (NSDistantObject*)anObj;
 
+- (void) _addAuthentication: (NSPortCoder*)c type: (int)msgid;
+- (void) _completeRequest: (GSConnectionRequest*)req
+		    reply: (NSPortCoder*)rmc
+		exception: (NSException*)exc;
+- (NSException*) _decodeReply: (NSPortCoder*)aRmc
+		forInvocation: (NSInvocation*)inv
+			 type: (const char*)type
+		    outParams: (BOOL)outParams;
 - (void) _doneInReply: (NSPortCoder*)c;
 - (void) _doneInRmc: (NSPortCoder*)c;
+- (NSPortCoder*) _encodeInvocation: (NSInvocation*)inv
+			  forProxy: (NSDistantObject*)object
+			      type: (const char**)typePtr
+			  sequence: (unsigned*)seqPtr
+			 outParams: (BOOL*)outPtr
+		     needsResponse: (BOOL*)needsPtr;
 - (void) _failInRmc: (NSPortCoder*)c;
 - (void) _failOutRmc: (NSPortCoder*)c;
+- (void) _failRequests: (NSArray*)requests withException: (NSException*)exc;
 - (NSPortCoder*) _getReplyRmc: (int)sn;
+- (void) _replyTimeout: (NSTimer*)t;
+- (void) _scheduleReplyTimeout: (NSTimeInterval)when;
+- (void) _handleBatch: (NSPortMessage*)msg;
 - (NSPortCoder*) _makeInRmc: (NSMutableArray*)components;
 - (NSPortCoder*) _makeOutRmc: (int)sequence generate: (int*)sno reply: (BOOL)f;
 - (void) _portIsInvalid: (NSNotification*)notification;
+- (void) _queueOutRmc: (NSPortCoder*)c request: (GSConnectionRequest*)req;
 - (void) _sendOutRmc: (NSPortCoder*)c type: (int)msgid;
 
 - (void) _service_forwardForProxy: (NSPortCoder*)rmc;
@@ -366,6 +492,12 @@ GS_PRIVATE_INTERNAL(NSConnection)
 static NSTimer		*timer = nil;
 
 static BOOL cacheCoders = NO;
+
+/*
+ * Maximum number of asynchronous requests sent in one message batch.
+ */
+#define	BATCH_MAX	32
+
 static int debug_connection = 0;
 
 static NSHashTable	*connection_table;
@@ -659,6 +791,7 @@ static NSLock	*cached_proxies_gate = nil;
       sendCoderClass = [NSPortCoder class];
       recvCoderClass = [NSPortCoder class];
       runLoopClass = [NSRunLoop class];
+      requestClass = [GSConnectionRequest class];
 
       dummyObject = [NSObject new];
 
@@ -1246,6 +1379,8 @@ static NSLock	*cached_proxies_gate = nil;
  */
 - (void) invalidate
 {
+  NSMutableArray	*pending = nil;
+
   GS_M_LOCK(IrefGate);
   if (IisValid == NO)
     {
@@ -1266,8 +1401,50 @@ static NSLock	*cached_proxies_gate = nil;
   NSHashRemove(connection_table, self);
   GSM_UNLOCK(connection_table_gate);
 
+  /*
+   * Discard any batched requests and find any asynchronous requests
+   * still awaiting replies, so we can tell them they have failed.
+   */
+  IbatchCount = 0;
+  DESTROY(IbatchHeader);
+  DESTROY(IbatchComponents);
+  DESTROY(IbatchPending);
+  [IasyncTimer invalidate];
+  DESTROY(IasyncTimer);
+  if (IreplyMap != 0)
+    {
+      GSIMapEnumerator_t	enumerator;
+      GSIMapNode 		node;
+
+      enumerator = GSIMapEnumeratorForMap(IreplyMap);
+      node = GSIMapEnumeratorNextNode(&enumerator);
+      while (node != 0)
+	{
+	  if ([node->value.obj isKindOfClass: requestClass] == YES)
+	    {
+	      if (pending == nil)
+		{
+		  pending = [NSMutableArray new];
+		}
+	      [pending addObject: node->value.obj];
+	    }
+	  node = GSIMapEnumeratorNextNode(&enumerator);
+	}
+    }
+
   GSM_UNLOCK(IrefGate);
 
+  if (pending != nil)
+    {
+      NSException	*exc;
+
+      exc = [NSException exceptionWithName: NSInvalidReceivePortException
+				    reason: @"invalidated while awaiting reply"
+				  userInfo: nil];
+      [self _failRequests: pending withException: exc];
+      RELEASE(pending);
+    }
+
   /*
    * Don't need notifications any more - so remove self as observer.
    */
@@ -1954,6 +2131,19 @@ static NSLock	*cached_proxies_gate = nil;
   DESTROY(IcachedDecoders);
   DESTROY(IcachedEncoders);
 
+  DESTROY(IbatchHeader);
+  DESTROY(IbatchComponents);
+  DESTROY(IbatchPending);
+  [IasyncTimer invalidate];
+  DESTROY(IasyncTimer);
+
+  DESTROY(IclassSignatures);
+  if (ItargetSignatures != 0)
+    {
+      NSFreeMapTable(ItargetSignatures);
+      ItargetSignatures = 0;
+    }
+
   DESTROY(IremoteName);
 
   DESTROY(IrefGate);
@@ -1973,70 +2163,13 @@ static NSLock	*cached_proxies_gate = nil;
   BOOL		needsResponse;
   const char	*type;
   unsigned	seq;
-  NSRunLoop	*runLoop = GSRunLoopForThread(nil);
-
-  if ([IrunLoops indexOfObjectIdenticalTo: runLoop] == NSNotFound)
-    {
-      if (ImultipleThreads == NO)
-	{
-	  [NSException raise: NSObjectInaccessibleException
-		      format: @"Forwarding message in wrong thread"];
-	}
-      else
-	{
-	  [self addRunLoop: runLoop];
-	}
-    }
-
-  /* Encode the method on an RMC, and send it. */
-
-  NSParameterAssert (IisValid);
-
-  /* get the method types from the selector */
-  type = [[inv methodSignature] methodType];
-  if (type == 0 || *type == '\0')
-    {
-      type = [[object methodSignatureForSelector: [inv selector]] methodType];
-      if (type)
-	{
-	  GSSelectorFromNameAndTypes(sel_getName([inv selector]), type);
-	}
-    }
-  NSParameterAssert(type);
-  NSParameterAssert(*type);
-
-  op = [self _makeOutRmc: 0 generate: (int*)&seq reply: YES];
-
-  if (debug_connection > 4)
-    NSLog(@"building packet seq %d", seq);
-
-  [inv setTarget: object];
-  outParams = [inv encodeWithDistantCoder: op passPointers: NO];
-
-  if (outParams == YES)
-    {
-      needsResponse = YES;
-    }
-  else
-    {
-      int		flags;
-
-      needsResponse = NO;
-      flags = objc_get_type_qualifiers(type);
-      if ((flags & _F_ONEWAY) == 0)
-	{
-	  needsResponse = YES;
-	}
-      else
-	{
-	  const char	*tmptype = objc_skip_type_qualifiers(type);
 
-	  if (*tmptype != _C_VOID)
-	    {
-	      needsResponse = YES;
-	    }
-	}
-    }
+  op = [self _encodeInvocation: inv
+		      forProxy: object
+			  type: &type
+		      sequence: &seq
+		     outParams: &outParams
+		 needsResponse: &needsResponse];
 
   [self _sendOutRmc: op type: METHOD_REQUEST];
   NSDebugMLLog(@"NSConnection", @"Sent message %s RMC %d to 0x%x",
@@ -2071,12 +2204,8 @@ static NSLock	*cached_proxies_gate = nil;
     }
   else
     {
-      int		argnum;
-      int		flags;
-      const char	*tmptype;
-      void		*datum;
       NSPortCoder	*aRmc;
-      BOOL		is_exception;
+      NSException	*exc;
 
       if ([self isValid] == NO)
 	{
@@ -2084,111 +2213,14 @@ static NSLock	*cached_proxies_gate = nil;
 	    format: @"connection waiting for request was shut down"];
 	}
       aRmc = [self _getReplyRmc: seq];
- 
-      /*
-       * Find out if the server is returning an exception instead
-       * of the return values.
-       */
-      [aRmc decodeValueOfObjCType: @encode(BOOL) at: &is_exception];
-      if (is_exception == YES)
+      exc = [self _decodeReply: aRmc
+		 forInvocation: inv
+			  type: type
+		     outParams: outParams];
+      if (exc != nil)
 	{
-	  /* Decode the exception object, and raise it. */
-	  id exc = [aRmc decodeObject];
-
-	  [self _doneInReply: aRmc];
 	  [exc raise];
 	}
-
-      /* Get the return type qualifier flags, and the return type. */
-      flags = objc_get_type_qualifiers(type);
-      tmptype = objc_skip_type_qualifiers(type);
-
-      /* Decode the return value and pass-by-reference values, if there
-	 are any.  OUT_PARAMETERS should be the value returned by
-	 cifframe_dissect_call(). */
-      if (outParams || *tmptype != _C_VOID || (flags & _F_ONEWAY) == 0)
-	/* xxx What happens with method declared "- (oneway) foo: (out int*)ip;" */
-	/* xxx What happens with method declared "- (in char *) bar;" */
-	/* xxx Is this right?  Do we also have to check _F_ONEWAY? */
-	{
-	  id	obj;
-
-	  /* If there is a return value, decode it, and put it in datum. */
-	  if (*tmptype != _C_VOID || (flags & _F_ONEWAY) == 0)
-	    {	
-	      switch (*tmptype)
-		{
-		  case _C_ID:
-		    datum = &obj;
-		    [aRmc decodeValueOfObjCType: tmptype at: datum];
-		    [obj autorelease];
-		    break;
-		  case _C_PTR:
-		    /* We are returning a pointer to something. */
-		    tmptype++;
-		    datum = alloca (objc_sizeof_type (tmptype));
-		    [aRmc decodeValueOfObjCType: tmptype at: datum];
-		    break;
-
-		  case _C_VOID:
-		    datum = alloca (sizeof (int));
-		    [aRmc decodeValueOfObjCType: @encode(int) at: datum];
-		    break;
-
-		  default:
-		    datum = alloca (objc_sizeof_type (tmptype));
-		    [aRmc decodeValueOfObjCType: tmptype at: datum];
-		    break;
-		}
-	    }
-	  else
-	    {
-	      datum = 0;
-	    }
-	  [inv setReturnValue: datum];
-
-	  /* Decode the values returned by reference.  Note: this logic
-	     must match exactly the code in _service_forwardForProxy:
-	     */
-	  if (outParams)
-	    {
-	      /* Step through all the arguments, finding the ones that were
-		 passed by reference. */
-	      for (tmptype = skip_argspec (tmptype), argnum = 0;
-	        *tmptype != '\0';
-	        tmptype = skip_argspec (tmptype), argnum++)
-		{
-		  /* Get the type qualifiers, like IN, OUT, INOUT, ONEWAY. */
-		  flags = objc_get_type_qualifiers(tmptype);
-		  /* Skip over the type qualifiers, so now TYPE is
-		     pointing directly at the char corresponding to the
-		     argument's type. */
-		  tmptype = objc_skip_type_qualifiers(tmptype);
-
-		  if (*tmptype == _C_PTR
-		    && ((flags & _F_OUT) || !(flags & _F_IN)))
-		    {
-		      /* If the arg was byref, we obtain its address
-		       * and decode the data directly to it.
-		       */
-		      tmptype++;
-		      [inv getArgument: &datum atIndex: argnum];
-		      [aRmc decodeValueOfObjCType: tmptype at: datum];
-		      if (*tmptype == _C_ID)
-			{
-			  [*(id*)datum autorelease];
-			}
-		    }
-		  else if (*tmptype == _C_CHARPTR
-		    && ((flags & _F_OUT) || !(flags & _F_IN)))
-		    {
-		      [aRmc decodeValueOfObjCType: tmptype at: &datum];
-		      [inv setArgument: datum atIndex: argnum];
-		    }
-		}
-	    }
-	}
-      [self _doneInReply: aRmc];
     }
 }
 
@@ -2252,68 +2284,309 @@ static NSLock	*cached_proxies_gate = nil;
 
 
 
-@implementation	NSConnection (Private)
+@implementation	NSConnection (GSAsynchronous)
 
-- (void) handlePortMessage: (NSPortMessage*)msg
+/**
+ * Returns YES if asynchronous requests are batched, NO otherwise.<br />
+ * See -setBatchesRequests: for details.
+ */
+- (BOOL) batchesRequests
 {
-  NSPortCoder		*rmc;
-  int			type = [msg msgid];
-  NSMutableArray	*components = [msg _components];
-  NSPort		*rp = [msg receivePort];
-  NSPort		*sp = [msg sendPort];
-  NSConnection		*conn;
+  return IbatchRequests;
+}
 
-  if (debug_connection > 4)
+/**
+ * Sends any batched asynchronous requests which have not yet been sent.
+ * <br />
+ * A batch is flushed automatically when it becomes full, before any
+ * other message is sent on the connection, and when the run loop of
+ * the thread which started the batch next runs in one of the
+ * connection's request modes.  So you only need to call this method if
+ * you want the requests sent without running the run loop.
+ */
+- (void) flushBatchedRequests
+{
+  NSMutableData		*header;
+  NSMutableArray	*components;
+  NSMutableArray	*pending;
+  NSDate		*limit;
+  NSUInteger		rl;
+  unsigned		count;
+  uint32_t		n;
+  BOOL			sent;
+
+  GS_M_LOCK(IrefGate);
+  count = IbatchCount;
+  header = IbatchHeader;
+  components = IbatchComponents;
+  pending = IbatchPending;
+  IbatchCount = 0;
+  IbatchHeader = nil;
+  IbatchComponents = nil;
+  IbatchPending = nil;
+  GSM_UNLOCK(IrefGate);
+
+  if (count == 0)
     {
-      NSLog(@"handling packet of type %d (%@)", type, stringFromMsgType(type));
+      return;
     }
-  conn = [connectionClass connectionWithReceivePort: rp sendPort: sp];
-  if (conn == nil)
+  AUTORELEASE(header);
+  AUTORELEASE(components);
+  AUTORELEASE(pending);
+
+  /*
+   * The header starts with the space reserved for the port, followed by
+   * the number of messages in the batch.  The message type and number of
+   * components of each message were appended as the messages were queued.
+   */
+  rl = [IsendPort reservedSpaceLength];
+  n = GSSwapHostI32ToBig(count);
+  [header replaceBytesInRange: NSMakeRange(rl, sizeof(n)) withBytes: &n];
+  [components insertObject: header atIndex: 0];
+
+  NSDebugMLLog(@"NSConnection", 
+    @"Sending %@ of %u on %@", stringFromMsgType(MESSAGE_BATCH), count, self);
+
+  limit = [dateClass dateWithTimeIntervalSinceNow: IrequestTimeout];
+  sent = [IsendPort sendBeforeDate: limit
+			     msgid: MESSAGE_BATCH
+			components: components
+			      from: IreceivePort
+			  reserved: rl];
+  if (sent == YES)
     {
-      NSLog(@"Received port message for unknown connection - %@", msg);
-      NSLog(@"All connections: %@", [NSConnection allConnections]);
-      return;
+      GS_M_LOCK(IrefGate);
+      IreqOutCount += count;
+      GSM_UNLOCK(IrefGate);
     }
-  else if ([conn isValid] == NO)
+  else
     {
-      if (debug_connection)
+      NSString		*text = stringFromMsgType(MESSAGE_BATCH);
+      NSException	*exc;
+
+      if ([IsendPort isValid] == NO)
 	{
-	  NSLog(@"received port message for invalid connection - %@", msg);
+	  text = [text stringByAppendingFormat: @" - port was invalidated"];
 	}
-      return;
-    }
-  if (debug_connection > 4)
-    {
-      NSLog(@"  connection is %@", conn);
+      exc = [NSException exceptionWithName: NSPortTimeoutException
+				    reason: text
+				  userInfo: nil];
+      [self _failRequests: pending withException: exc];
     }
+}
 
-  if (GSIVar(conn, _authenticateIn) == YES
-    && (type == METHOD_REQUEST || type == METHOD_REPLY))
+/**
+ * Sends inv to the remote object represented by proxy without waiting
+ * for the reply, so that many requests from one thread may be in
+ * flight on the connection at once.<br />
+ * The reply is matched to the request by its sequence number, and is
+ * handled when the run loop of a thread using the connection runs in
+ * one of the connection's request modes.  The return value and any
+ * pass-by-reference arguments are then decoded into inv and block is
+ * called with inv and a nil exception, or with the exception raised by
+ * the remote method.<br />
+ * If the connection is invalidated (or a batch containing the request
+ * cannot be sent) before the reply arrives, block is called with an
+ * exception describing the problem.<br />
+ * For a oneway void method no reply is expected, and block is called
+ * as soon as the request has been sent or added to a batch.<br />
+ * If no reply arrives within the reply timeout of the connection (see
+ * -setReplyTimeout:), block is called with an NSPortTimeoutException
+ * when the run loop of the sending thread next runs in one of the
+ * connection's request modes after the timeout.<br />
+ * The arguments of inv are retained, but any memory passed by reference
+ * must remain valid until block has been called.<br />
+ * Raises an exception (and does not call block) if the request cannot
+ * be encoded or sent.
+ */
+- (void) sendInvocation: (NSInvocation*)inv
+	       forProxy: (NSDistantObject*)proxy
+	     completion: (GSConnectionCompletionBlock)block
+{
+  GSConnectionRequest	*req = nil;
+  NSPortCoder		*op;
+  BOOL			outParams;
+  BOOL			needsResponse;
+  const char		*type;
+  unsigned		seq;
+
+  NSParameterAssert(block != 0);
+
+  [inv retainArguments];
+  op = [self _encodeInvocation: inv
+		      forProxy: proxy
+			  type: &type
+		      sequence: &seq
+		     outParams: &outParams
+		 needsResponse: &needsResponse];
+
+  GS_M_LOCK(IrefGate);
+  if (needsResponse == YES)
     {
-      NSData	        *d;
-      NSUInteger	count = [components count];
+      GSIMapNode	node;
 
-      d = RETAIN([components objectAtIndex: --count]);
-      [components removeObjectAtIndex: count];
-      if ([[conn delegate] authenticateComponents: components
-					 withData: d] == NO)
+      req = [requestClass new];
+      req->inv = RETAIN(inv);
+      req->block = (GSConnectionCompletionBlock)[(id)block copy];
+      req->type = NSZoneMalloc(NSDefaultMallocZone(), strlen(type) + 1);
+      strcpy(req->type, type);
+      req->seq = seq;
+      req->outParams = outParams;
+      if (IreplyTimeout < 1.0E12)
 	{
-	  RELEASE(d);
-	  [NSException raise: NSFailedAuthenticationException
-		      format: @"message not authenticated by delegate"];
+	  req->deadline = GSPrivateTimeNow() + IreplyTimeout;
 	}
-      RELEASE(d);
-    }
 
-  rmc = [conn _makeInRmc: components];
-  if (debug_connection > 5)
+      /*
+       * Replace the placeholder in the reply map so that the reply is
+       * passed to the request rather than saved for a waiting thread.
+       * The map now owns the request.
+       */
+      node = GSIMapNodeForKey(IreplyMap, (GSIMapKey)(NSUInteger)seq);
+      node->value.obj = req;
+    }
+  else
     {
-      NSLog(@"made rmc %p for %d", rmc, type);
+      GSIMapRemoveKey(IreplyMap, (GSIMapKey)(NSUInteger)seq);
     }
+  GSM_UNLOCK(IrefGate);
 
-  switch (type)
+  NS_DURING
     {
-      case ROOTPROXY_REQUEST:
+      if (IbatchRequests == YES)
+	{
+	  [self _queueOutRmc: op request: req];
+	}
+      else
+	{
+	  [self _sendOutRmc: op type: METHOD_REQUEST];
+	}
+    }
+  NS_HANDLER
+    {
+      if (req != nil)
+	{
+	  GSIMapNode	node;
+
+	  GS_M_LOCK(IrefGate);
+	  node = GSIMapNodeForKey(IreplyMap, (GSIMapKey)(NSUInteger)seq);
+	  if (node != 0 && node->value.obj == req)
+	    {
+	      GSIMapRemoveKey(IreplyMap, (GSIMapKey)(NSUInteger)seq);
+	      RELEASE(req);
+	    }
+	  GSM_UNLOCK(IrefGate);
+	}
+      [localException raise];
+    }
+  NS_ENDHANDLER
+  NSDebugMLLog(@"NSConnection", @"Sent async message %s RMC %d to 0x%x",
+    sel_getName([inv selector]), seq, (uintptr_t)self);
+
+  if (req != nil && req->deadline > 0.0)
+    {
+      [self _scheduleReplyTimeout: req->deadline];
+    }
+
+  if (needsResponse == NO)
+    {
+      CALL_BLOCK(block, inv, nil);
+    }
+}
+
+/**
+ * Sets whether asynchronous requests sent using
+ * -sendInvocation:forProxy:completion: are batched.<br />
+ * When batching is on, consecutive asynchronous requests are collected
+ * and sent to the remote connection together in a single port message,
+ * saving a write (and a wakeup of the remote process) per request.<br />
+ * The remote process must be using a version of the library which
+ * understands batched messages, so batching is off by default.<br />
+ * Turning batching off flushes any batched requests.
+ */
+- (void) setBatchesRequests: (BOOL)flag
+{
+  IbatchRequests = flag;
+  if (flag == NO)
+    {
+      [self flushBatchedRequests];
+    }
+}
+
+@end
+
+
+
+@implementation	NSConnection (Private)
+
+- (void) handlePortMessage: (NSPortMessage*)msg
+{
+  NSPortCoder		*rmc;
+  int			type = [msg msgid];
+  NSMutableArray	*components = [msg _components];
+  NSPort		*rp = [msg receivePort];
+  NSPort		*sp = [msg sendPort];
+  NSConnection		*conn;
+
+  if (debug_connection > 4)
+    {
+      NSLog(@"handling packet of type %d (%@)", type, stringFromMsgType(type));
+    }
+  conn = [connectionClass connectionWithReceivePort: rp sendPort: sp];
+  if (conn == nil)
+    {
+      NSLog(@"Received port message for unknown connection - %@", msg);
+      NSLog(@"All connections: %@", [NSConnection allConnections]);
+      return;
+    }
+  else if ([conn isValid] == NO)
+    {
+      if (debug_connection)
+	{
+	  NSLog(@"received port message for invalid connection - %@", msg);
+	}
+      return;
+    }
+  if (debug_connection > 4)
+    {
+      NSLog(@"  connection is %@", conn);
+    }
+
+  if (type == MESSAGE_BATCH)
+    {
+      /* Each message in the batch is authenticated separately.
+       */
+      [self _handleBatch: msg];
+      return;
+    }
+
+  if (GSIVar(conn, _authenticateIn) == YES
+    && (type == METHOD_REQUEST || type == METHOD_REPLY))
+    {
+      NSData	        *d;
+      NSUInteger	count = [components count];
+
+      d = RETAIN([components objectAtIndex: --count]);
+      [components removeObjectAtIndex: count];
+      if ([[conn delegate] authenticateComponents: components
+					 withData: d] == NO)
+	{
+	  RELEASE(d);
+	  [NSException raise: NSFailedAuthenticationException
+		      format: @"message not authenticated by delegate"];
+	}
+      RELEASE(d);
+    }
+
+  rmc = [conn _makeInRmc: components];
+  if (debug_connection > 5)
+    {
+      NSLog(@"made rmc %p for %d", rmc, type);
+    }
+
+  switch (type)
+    {
+      case ROOTPROXY_REQUEST:
 	/* It won't take much time to handle this, so go ahead and service
 	   it, even if we are waiting for a reply. */
 	[conn _service_rootObject: rmc];
@@ -2402,6 +2675,19 @@ static NSLock	*cached_proxies_gate = nil;
 		sequence, conn);
 	      node->value.obj = rmc;
 	    }
+	  else if ([node->value.obj isKindOfClass: requestClass] == YES)
+	    {
+	      GSConnectionRequest	*req = node->value.obj;
+
+	      NSDebugMLLog(@"NSConnection", @"Completing reply RMC %d on %@",
+		sequence, conn);
+	      GSIMapRemoveKey(GSIVar(conn, _replyMap),
+		(GSIMapKey)(NSUInteger)sequence);
+	      GSM_UNLOCK(GSIVar(conn, _refGate));
+	      [conn _completeRequest: req reply: rmc exception: nil];
+	      RELEASE(req);
+	      break;
+	    }
 	  else
 	    {
 	      NSDebugMLLog(@"NSConnection", @"Replace reply RMC %d on %@",
@@ -2434,6 +2720,66 @@ static NSLock	*cached_proxies_gate = nil;
     }
 }
 
+/*
+ * Split a batch of messages sent by -flushBatchedRequests into its
+ * individual port messages, and handle each in turn.
+ */
+- (void) _handleBatch: (NSPortMessage*)msg
+{
+  NSArray		*components = [msg _components];
+  NSUInteger		total = [components count];
+  NSUInteger		pos = 1;
+  NSData		*header;
+  const uint8_t		*bytes;
+  uint32_t		count;
+  uint32_t		i;
+
+  header = (total > 0) ? [components objectAtIndex: 0] : nil;
+  if ([header length] < sizeof(count))
+    {
+      [NSException raise: NSGenericException
+		  format: @"bad message batch header"];
+    }
+  bytes = [header bytes];
+  memcpy(&count, bytes, sizeof(count));
+  count = GSSwapBigI32ToHost(count);
+  if ([header length] != sizeof(count) + 2 * sizeof(uint32_t) * count)
+    {
+      [NSException raise: NSGenericException
+		  format: @"bad message batch header"];
+    }
+  bytes += sizeof(count);
+
+  for (i = 0; i < count; i++)
+    {
+      NSAutoreleasePool	*arp;
+      NSPortMessage	*sub;
+      uint32_t		entry[2];
+      uint32_t		msgid;
+      uint32_t		n;
+
+      memcpy(entry, bytes, sizeof(entry));
+      bytes += sizeof(entry);
+      msgid = GSSwapBigI32ToHost(entry[0]);
+      n = GSSwapBigI32ToHost(entry[1]);
+      if (msgid == MESSAGE_BATCH || n == 0 || n > total - pos)
+	{
+	  [NSException raise: NSGenericException
+		      format: @"bad message in batch"];
+	}
+      arp = [NSAutoreleasePool new];
+      sub = [[NSPortMessage alloc] initWithSendPort: [msg sendPort]
+					receivePort: [msg receivePort]
+					 components: [components
+	subarrayWithRange: NSMakeRange(pos, n)]];
+      AUTORELEASE(sub);
+      [sub setMsgid: msgid];
+      pos += n;
+      [self handlePortMessage: sub];
+      [arp drain];
+    }
+}
+
 - (void) _runInNewThread
 {
   NSRunLoop	*loop = GSRunLoopForThread(nil);
@@ -3052,6 +3398,388 @@ static NSLock	*cached_proxies_gate = nil;
 
 
 
+/*
+ * Called when the reply to an asynchronous request arrives (rmc is the
+ * reply) or when the request has failed (rmc is nil and exc describes
+ * the failure).  Decodes the reply into the invocation and calls the
+ * completion block.
+ */
+- (void) _completeRequest: (GSConnectionRequest*)req
+		    reply: (NSPortCoder*)rmc
+		exception: (NSException*)exc
+{
+  if (rmc != nil)
+    {
+      NS_DURING
+	{
+	  exc = [self _decodeReply: rmc
+		     forInvocation: req->inv
+			      type: req->type
+			 outParams: req->outParams];
+	}
+      NS_HANDLER
+	{
+	  exc = localException;
+	}
+      NS_ENDHANDLER
+    }
+  NS_DURING
+    {
+      CALL_BLOCK(req->block, req->inv, exc);
+    }
+  NS_HANDLER
+    {
+      NSLog(@"Exception in completion of %@ on %@ - %@",
+	NSStringFromSelector([req->inv selector]), self, localException);
+    }
+  NS_ENDHANDLER
+}
+
+/*
+ * Decode a reply to a method request into the invocation, and release
+ * the reply coder.  Returns the exception sent back by the remote end
+ * if there was one, nil otherwise.
+ */
+- (NSException*) _decodeReply: (NSPortCoder*)aRmc
+		forInvocation: (NSInvocation*)inv
+			 type: (const char*)type
+		    outParams: (BOOL)outParams
+{
+  int		argnum;
+  int		flags;
+  const char	*tmptype;
+  void		*datum;
+  BOOL		is_exception;
+
+  /*
+   * Find out if the server is returning an exception instead
+   * of the return values.
+   */
+  [aRmc decodeValueOfObjCType: @encode(BOOL) at: &is_exception];
+  if (is_exception == YES)
+    {
+      /* Decode the exception object, and return it. */
+      id exc = [aRmc decodeObject];
+
+      [self _doneInReply: aRmc];
+      return exc;
+    }
+
+  /* Get the return type qualifier flags, and the return type. */
+  flags = objc_get_type_qualifiers(type);
+  tmptype = objc_skip_type_qualifiers(type);
+
+  /* Decode the return value and pass-by-reference values, if there
+     are any.  OUT_PARAMETERS should be the value returned by
+     cifframe_dissect_call(). */
+  if (outParams || *tmptype != _C_VOID || (flags & _F_ONEWAY) == 0)
+    /* xxx What happens with method declared "- (oneway) foo: (out int*)ip;" */
+    /* xxx What happens with method declared "- (in char *) bar;" */
+    /* xxx Is this right?  Do we also have to check _F_ONEWAY? */
+    {
+      id	obj;
+
+      /* If there is a return value, decode it, and put it in datum. */
+      if (*tmptype != _C_VOID || (flags & _F_ONEWAY) == 0)
+	{	
+	  switch (*tmptype)
+	    {
+	      case _C_ID:
+		datum = &obj;
+		[aRmc decodeValueOfObjCType: tmptype at: datum];
+		[obj autorelease];
+		break;
+	      case _C_PTR:
+		/* We are returning a pointer to something. */
+		tmptype++;
+		datum = alloca (objc_sizeof_type (tmptype));
+		[aRmc decodeValueOfObjCType: tmptype at: datum];
+		break;
+
+	      case _C_VOID:
+		datum = alloca (sizeof (int));
+		[aRmc decodeValueOfObjCType: @encode(int) at: datum];
+		break;
+
+	      default:
+		datum = alloca (objc_sizeof_type (tmptype));
+		[aRmc decodeValueOfObjCType: tmptype at: datum];
+		break;
+	    }
+	}
+      else
+	{
+	  datum = 0;
+	}
+      [inv setReturnValue: datum];
+
+      /* Decode the values returned by reference.  Note: this logic
+	 must match exactly the code in _service_forwardForProxy:
+	 */
+      if (outParams)
+	{
+	  /* Step through all the arguments, finding the ones that were
+	     passed by reference. */
+	  for (tmptype = skip_argspec (tmptype), argnum = 0;
+	    *tmptype != '\0';
+	    tmptype = skip_argspec (tmptype), argnum++)
+	    {
+	      /* Get the type qualifiers, like IN, OUT, INOUT, ONEWAY. */
+	      flags = objc_get_type_qualifiers(tmptype);
+	      /* Skip over the type qualifiers, so now TYPE is
+		 pointing directly at the char corresponding to the
+		 argument's type. */
+	      tmptype = objc_skip_type_qualifiers(tmptype);
+
+	      if (*tmptype == _C_PTR
+		&& ((flags & _F_OUT) || !(flags & _F_IN)))
+		{
+		  /* If the arg was byref, we obtain its address
+		   * and decode the data directly to it.
+		   */
+		  tmptype++;
+		  [inv getArgument: &datum atIndex: argnum];
+		  [aRmc decodeValueOfObjCType: tmptype at: datum];
+		  if (*tmptype == _C_ID)
+		    {
+		      [*(id*)datum autorelease];
+		    }
+		}
+	      else if (*tmptype == _C_CHARPTR
+		&& ((flags & _F_OUT) || !(flags & _F_IN)))
+		{
+		  [aRmc decodeValueOfObjCType: tmptype at: &datum];
+		  [inv setArgument: datum atIndex: argnum];
+		}
+	    }
+	}
+    }
+  [self _doneInReply: aRmc];
+  return nil;
+}
+
+/*
+ * Encode inv as a method request for the remote object.  Returns the
+ * coder (ready to send) and sets the method type, the sequence number
+ * of the request (for which a placeholder has been added to the reply
+ * map), whether there are pass-by-reference arguments to be returned,
+ * and whether a reply is expected.
+ */
+- (NSPortCoder*) _encodeInvocation: (NSInvocation*)inv
+			  forProxy: (NSDistantObject*)object
+			      type: (const char**)typePtr
+			  sequence: (unsigned*)seqPtr
+			 outParams: (BOOL*)outPtr
+		     needsResponse: (BOOL*)needsPtr
+{
+  NSPortCoder	*op;
+  BOOL		outParams;
+  BOOL		needsResponse;
+  const char	*type;
+  unsigned	seq;
+  NSRunLoop	*runLoop = GSRunLoopForThread(nil);
+
+  if ([IrunLoops indexOfObjectIdenticalTo: runLoop] == NSNotFound)
+    {
+      if (ImultipleThreads == NO)
+	{
+	  [NSException raise: NSObjectInaccessibleException
+		      format: @"Forwarding message in wrong thread"];
+	}
+      else
+	{
+	  [self addRunLoop: runLoop];
+	}
+    }
+
+  /* Encode the method on an RMC. */
+
+  NSParameterAssert (IisValid);
+
+  /* get the method types from the selector */
+  type = [[inv methodSignature] methodType];
+  if (type == 0 || *type == '\0')
+    {
+      type = [[object methodSignatureForSelector: [inv selector]] methodType];
+      if (type)
+	{
+	  GSSelectorFromNameAndTypes(sel_getName([inv selector]), type);
+	}
+    }
+  NSParameterAssert(type);
+  NSParameterAssert(*type);
+
+  op = [self _makeOutRmc: 0 generate: (int*)&seq reply: YES];
+
+  if (debug_connection > 4)
+    NSLog(@"building packet seq %d", seq);
+
+  [inv setTarget: object];
+  outParams = [inv encodeWithDistantCoder: op passPointers: NO];
+
+  if (outParams == YES)
+    {
+      needsResponse = YES;
+    }
+  else
+    {
+      int		flags;
+
+      needsResponse = NO;
+      flags = objc_get_type_qualifiers(type);
+      if ((flags & _F_ONEWAY) == 0)
+	{
+	  needsResponse = YES;
+	}
+      else
+	{
+	  const char	*tmptype = objc_skip_type_qualifiers(type);
+
+	  if (*tmptype != _C_VOID)
+	    {
+	      needsResponse = YES;
+	    }
+	}
+    }
+
+  *typePtr = type;
+  *seqPtr = seq;
+  *outPtr = outParams;
+  *needsPtr = needsResponse;
+  return op;
+}
+
+/*
+ * Complete asynchronous requests which will not receive a reply, by
+ * calling their completion blocks with the exception.  Requests which
+ * are no longer in the reply map have already been completed.
+ */
+- (void) _failRequests: (NSArray*)requests withException: (NSException*)exc
+{
+  NSUInteger	count = [requests count];
+  NSUInteger	i;
+
+  for (i = 0; i < count; i++)
+    {
+      GSConnectionRequest	*req = [requests objectAtIndex: i];
+      GSIMapNode		node = 0;
+
+      GS_M_LOCK(IrefGate);
+      if (IreplyMap != 0)
+	{
+	  node = GSIMapNodeForKey(IreplyMap, (GSIMapKey)(NSUInteger)req->seq);
+	  if (node != 0 && node->value.obj == req)
+	    {
+	      GSIMapRemoveKey(IreplyMap, (GSIMapKey)(NSUInteger)req->seq);
+	    }
+	  else
+	    {
+	      node = 0;
+	    }
+	}
+      GSM_UNLOCK(IrefGate);
+      if (node != 0)
+	{
+	  [self _completeRequest: req reply: nil exception: exc];
+	  RELEASE(req);
+	}
+    }
+}
+
+/*
+ * Called by the timer set up by -_scheduleReplyTimeout: to fail any
+ * asynchronous requests whose replies have not arrived in time, and
+ * to set the timer again for the earliest remaining deadline.
+ */
+- (void) _replyTimeout: (NSTimer*)t
+{
+  NSMutableArray	*expired = nil;
+  NSTimeInterval	now = GSPrivateTimeNow();
+  NSTimeInterval	next = 0.0;
+
+  GS_M_LOCK(IrefGate);
+  if (IasyncTimer == t)
+    {
+      DESTROY(IasyncTimer);
+    }
+  if (IreplyMap != 0)
+    {
+      GSIMapEnumerator_t	enumerator;
+      GSIMapNode 		node;
+
+      enumerator = GSIMapEnumeratorForMap(IreplyMap);
+      node = GSIMapEnumeratorNextNode(&enumerator);
+      while (node != 0)
+	{
+	  if ([node->value.obj isKindOfClass: requestClass] == YES)
+	    {
+	      GSConnectionRequest	*req = node->value.obj;
+
+	      if (req->deadline > 0.0 && req->deadline <= now)
+		{
+		  if (expired == nil)
+		    {
+		      expired = [NSMutableArray array];
+		    }
+		  [expired addObject: req];
+		}
+	      else if (req->deadline > 0.0
+		&& (next == 0.0 || req->deadline < next))
+		{
+		  next = req->deadline;
+		}
+	    }
+	  node = GSIMapEnumeratorNextNode(&enumerator);
+	}
+    }
+  GSM_UNLOCK(IrefGate);
+
+  if (expired != nil)
+    {
+      NSException	*exc;
+
+      exc = [NSException exceptionWithName: NSPortTimeoutException
+				    reason: @"timed out waiting for reply"
+				  userInfo: nil];
+      [self _failRequests: expired withException: exc];
+    }
+  if (next > 0.0)
+    {
+      [self _scheduleReplyTimeout: next];
+    }
+}
+
+/*
+ * Make sure that the current thread's run loop will check for timed out
+ * asynchronous requests no later than 'when'.
+ */
+- (void) _scheduleReplyTimeout: (NSTimeInterval)when
+{
+  GS_M_LOCK(IrefGate);
+  if ([self isValid] == YES
+    && (IasyncTimer == nil || when < IasyncDeadline))
+    {
+      NSRunLoop	*loop = GSRunLoopForThread(nil);
+      NSUInteger	count = [IrequestModes count];
+      NSUInteger	i;
+
+      [IasyncTimer invalidate];
+      DESTROY(IasyncTimer);
+      IasyncTimer = RETAIN([NSTimer timerWithTimeInterval:
+	when - GSPrivateTimeNow()
+	target: self
+	selector: @selector(_replyTimeout:)
+	userInfo: nil
+	repeats: NO]);
+      IasyncDeadline = when;
+      for (i = 0; i < count; i++)
+	{
+	  [loop addTimer: IasyncTimer forMode: [IrequestModes objectAtIndex: i]];
+	}
+    }
+  GSM_UNLOCK(IrefGate);
+}
+
 /*
  * Check the queue, then try to get it from the network by waiting
  * while we run the NSRunLoop.  Raise exception if we don't get anything
@@ -3377,17 +4105,18 @@ static NSLock	*cached_proxies_gate = nil;
   return coder;
 }
 
-- (void) _sendOutRmc: (NSPortCoder*)c type: (int)msgid
+/*
+ * Add authentication data from the delegate to an outgoing message
+ * if required.  Releases the coder and raises an exception if the
+ * delegate fails to provide the data.
+ */
+- (void) _addAuthentication: (NSPortCoder*)c type: (int)msgid
 {
-  NSDate		*limit;
-  BOOL			sent = NO;
-  BOOL			raiseException = NO;
-  NSMutableArray	*components = [c _components];
-
   if (IauthenticateOut == YES
     && (msgid == METHOD_REQUEST || msgid == METHOD_REPLY))
     {
-      NSData	*d;
+      NSMutableArray	*components = [c _components];
+      NSData		*d;
 
       d = [[self delegate] authenticationDataForComponents: components];
       if (d == nil)
@@ -3398,6 +4127,106 @@ static NSLock	*cached_proxies_gate = nil;
 	}
       [components addObject: d];
     }
+}
+
+/*
+ * Add an asynchronous method request to the current batch (starting a
+ * new batch if necessary) rather than sending it immediately.
+ * The request (if any) is recorded so that it can be failed if the
+ * batch cannot be sent.
+ */
+- (void) _queueOutRmc: (NSPortCoder*)c request: (GSConnectionRequest*)req
+{
+  NSMutableArray	*components;
+  NSUInteger		rl = [IsendPort reservedSpaceLength];
+  NSUInteger		count;
+  NSData		*d;
+  uint32_t		entry[2];
+  BOOL			schedule = NO;
+  BOOL			full;
+
+  [self _addAuthentication: c type: METHOD_REQUEST];
+  components = [c _components];
+  count = [components count];
+
+  /*
+   * The first component starts with space reserved for the port, which
+   * is only needed once at the start of the batch, so we strip it.
+   * We must copy the data anyway, since the coder may be reused.
+   */
+  d = [components objectAtIndex: 0];
+  d = [[NSData alloc] initWithBytes: (const char*)[d bytes] + rl
+			     length: [d length] - rl];
+  entry[0] = GSSwapHostI32ToBig(METHOD_REQUEST);
+  entry[1] = GSSwapHostI32ToBig(count);
+
+  GS_M_LOCK(IrefGate);
+  if (IbatchCount == 0)
+    {
+      IbatchHeader = [[NSMutableData alloc]
+	initWithLength: rl + sizeof(uint32_t)];
+      IbatchComponents = [NSMutableArray new];
+      IbatchPending = [NSMutableArray new];
+      schedule = YES;
+    }
+  [IbatchHeader appendBytes: entry length: sizeof(entry)];
+  [IbatchComponents addObject: d];
+  RELEASE(d);
+  if (count > 1)
+    {
+      [IbatchComponents addObjectsFromArray:
+	[components subarrayWithRange: NSMakeRange(1, count - 1)]];
+    }
+  if (req != nil)
+    {
+      [IbatchPending addObject: req];
+    }
+  full = (++IbatchCount >= BATCH_MAX) ? YES : NO;
+
+  /*
+   * The coder is finished with, so we return it to the cache.
+   */
+  if (cacheCoders == YES && IcachedEncoders != nil)
+    {
+      [IcachedEncoders addObject: c];
+    }
+  [c dispatch];	/* Tell NSPortCoder to release the connection.	*/
+  RELEASE(c);
+  GSM_UNLOCK(IrefGate);
+
+  if (full == YES)
+    {
+      [self flushBatchedRequests];
+    }
+  else if (schedule == YES)
+    {
+      NSArray	*modes = AUTORELEASE([IrequestModes copy]);
+
+      [GSRunLoopForThread(nil) performSelector: @selector(flushBatchedRequests)
+					target: self
+				      argument: nil
+					 order: 0
+					 modes: modes];
+    }
+}
+
+- (void) _sendOutRmc: (NSPortCoder*)c type: (int)msgid
+{
+  NSDate		*limit;
+  BOOL			sent = NO;
+  BOOL			raiseException = NO;
+  NSMutableArray	*components = [c _components];
+
+  /*
+   * Any batched requests must be sent before this message, so that
+   * the remote end sees messages in the order they were sent.
+   */
+  if (IbatchCount > 0)
+    {
+      [self flushBatchedRequests];
+    }
+
+  [self _addAuthentication: c type: msgid];
 
   switch (msgid)
     {
@@ -3824,6 +4653,153 @@ static NSLock	*cached_proxies_gate = nil;
   return [super retain];
 }
 
+/*
+ * Maximum number of remote targets whose signature cache we remember.
+ */
+#define	TARGET_SIGNATURES_MAX	4096
+
+/*
+ * Method signatures for remote objects are cached per remote class, so
+ * that all proxies on the connection for objects of the same class share
+ * them.  The remote process names the class (see -_classNameForSignatures
+ * above), and names none for objects whose signatures may differ from
+ * those of other instances of their class, in which case the cache is
+ * kept for that object alone.
+ * The proxy's _sigs ivar points to the (retained) dictionary for its
+ * remote object, and the dictionary for each target is remembered, so
+ * that a new proxy for the same target finds it without asking the
+ * remote process for anything.  Target handles are never reused within
+ * a process, so an entry can not be found for the wrong object.
+ * The dictionaries are only accessed with the connection locked.
+ */
+- (NSMethodSignature*) cachedSignatureForSelector: (SEL)aSelector
+					    proxy: (NSDistantObject*)aProxy
+{
+  NSMutableDictionary	*d;
+  NSMethodSignature	*sig = nil;
+  NSString		*name = nil;
+
+  GS_M_LOCK(IrefGate);
+  d = (NSMutableDictionary*)aProxy->_sigs;
+  if (d == nil && ItargetSignatures != 0)
+    {
+      d = NSMapGet(ItargetSignatures, (void*)(uintptr_t)aProxy->_handle);
+      aProxy->_sigs = (void*)RETAIN(d);
+    }
+  if (d != nil)
+    {
+      sig = AUTORELEASE(RETAIN([d objectForKey:
+	NSStringFromSelector(aSelector)]));
+    }
+  GSM_UNLOCK(IrefGate);
+  if (d != nil)
+    {
+      return sig;
+    }
+
+  /*
+   * First signature needed for this target ... find out whether the
+   * remote object shares the signatures of its class.
+   * We build the invocation by hand since asking the remote object for
+   * the signature of -_classNameForSignatures would recurse.
+   */
+  NS_DURING
+    {
+      static NSMethodSignature	*nameSig = nil;
+      NSInvocation		*inv;
+
+      if (nameSig == nil)
+	{
+	  nameSig = RETAIN([NSMethodSignature signatureWithObjCTypes: "@@:"]);
+	}
+      inv = [NSInvocation invocationWithMethodSignature: nameSig];
+      [inv setSelector: @selector(_classNameForSignatures)];
+      [self forwardInvocation: inv forProxy: aProxy];
+      [inv getReturnValue: &name];
+    }
+  NS_HANDLER
+    {
+      /* An older peer, or an object refusing the message.
+       */
+      name = nil;
+    }
+  NS_ENDHANDLER
+  if ([name isKindOfClass: [NSString class]] == NO)
+    {
+      name = nil;
+    }
+
+  GS_M_LOCK(IrefGate);
+  if (aProxy->_sigs == 0)
+    {
+      if (ItargetSignatures == 0)
+	{
+	  ItargetSignatures = NSCreateMapTable(NSIntegerMapKeyCallBacks,
+	    NSObjectMapValueCallBacks, 0);
+	}
+      else if (NSCountMapTable(ItargetSignatures) >= TARGET_SIGNATURES_MAX)
+	{
+	  NSResetMapTable(ItargetSignatures);
+	}
+      if (name == nil)
+	{
+	  d = AUTORELEASE([NSMutableDictionary new]);
+	}
+      else
+	{
+	  if (IclassSignatures == nil)
+	    {
+	      IclassSignatures = [NSMutableDictionary new];
+	    }
+	  d = [IclassSignatures objectForKey: name];
+	  if (d == nil)
+	    {
+	      d = [NSMutableDictionary new];
+	      [IclassSignatures setObject: d forKey: name];
+	      RELEASE(d);
+	    }
+	}
+      NSMapInsert(ItargetSignatures, (void*)(uintptr_t)aProxy->_handle, d);
+      aProxy->_sigs = (void*)RETAIN(d);
+    }
+  d = (NSMutableDictionary*)aProxy->_sigs;
+  sig = AUTORELEASE(RETAIN([d objectForKey: NSStringFromSelector(aSelector)]));
+  GSM_UNLOCK(IrefGate);
+  return sig;
+}
+
+/*
+ * Record the method signature obtained from the remote object so that
+ * it is found by -cachedSignatureForSelector:proxy: for this proxy and
+ * any other proxy sharing its cache.
+ */
+- (void) cacheSignature: (NSMethodSignature*)aSignature
+	    forSelector: (SEL)aSelector
+		  proxy: (NSDistantObject*)aProxy
+{
+  NSMutableDictionary	*d;
+
+  GS_M_LOCK(IrefGate);
+  d = (NSMutableDictionary*)aProxy->_sigs;
+  if (d == nil)
+    {
+      if (ItargetSignatures == 0)
+	{
+	  ItargetSignatures = NSCreateMapTable(NSIntegerMapKeyCallBacks,
+	    NSObjectMapValueCallBacks, 0);
+	}
+      else if (NSCountMapTable(ItargetSignatures) >= TARGET_SIGNATURES_MAX)
+	{
+	  NSResetMapTable(ItargetSignatures);
+	}
+      d = [NSMutableDictionary new];
+      NSMapInsert(ItargetSignatures, (void*)(uintptr_t)aProxy->_handle, d);
+      aProxy->_sigs = (void*)d;
+    }
+  [d setObject: aSignature forKey: NSStringFromSelector(aSelector)];
+  GSM_UNLOCK(IrefGate);
+}
+
 - (void) removeProxy: (NSDistantObject*)aProxy
 {
   GS_M_LOCK(IrefGate);
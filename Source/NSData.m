@@ -1636,6 +1636,174 @@ failure:
     }
   return NO;
 }
+
+- (NSData*) base64EncodedDataWithOptions: (NSDataBase64EncodingOptions)options
+{
+  NSUInteger	length = [self length];
+  const uint8_t	*src = (const uint8_t*)[self bytes];
+  NSUInteger	size = 4 * ((length + 2) / 3);
+  NSUInteger	lineLength = 0;
+  NSUInteger	endLength = 0;
+  uint8_t	end[2];
+  uint8_t	*result;
+  uint8_t	*dst;
+
+  if (0 == length)
+    {
+      return [NSData data];
+    }
+  if (options & NSDataBase64Encoding64CharacterLineLength)
+    {
+      lineLength = 64;
+    }
+  else if (options & NSDataBase64Encoding76CharacterLineLength)
+    {
+      lineLength = 76;
+    }
+  if (lineLength > 0)
+    {
+      if (options & NSDataBase64EncodingEndLineWithCarriageReturn)
+	{
+	  end[endLength++] = '\r';
+	}
+      if (options & NSDataBase64EncodingEndLineWithLineFeed)
+	{
+	  end[endLength++] = '\n';
+	}
+      if (0 == endLength)
+	{
+	  end[endLength++] = '\r';
+	  end[endLength++] = '\n';
+	}
+      size += ((size - 1) / lineLength) * endLength;
+    }
+  result = NSZoneMalloc(NSDefaultMallocZone(), size);
+  dst = result;
+  if (0 == lineLength)
+    {
+      dst += GSPrivateBase64Encode(dst, src, length);
+    }
+  else
+    {
+      NSUInteger	chunk = lineLength / 4 * 3;
+
+      while (length > chunk)
+	{
+	  dst += GSPrivateBase64Encode(dst, src, chunk);
+	  memcpy(dst, end, endLength);
+	  dst += endLength;
+	  src += chunk;
+	  length -= chunk;
+	}
+      dst += GSPrivateBase64Encode(dst, src, length);
+    }
+  return AUTORELEASE([[NSData allocWithZone: NSDefaultMallocZone()]
+    initWithBytesNoCopy: result length: dst - result]);
+}
+
+- (NSString*) base64EncodedStringWithOptions:
+  (NSDataBase64EncodingOptions)options
+{
+  NSData	*d = [self base64EncodedDataWithOptions: options];
+
+  return AUTORELEASE([[NSString alloc] initWithData: d
+					   encoding: NSASCIIStringEncoding]);
+}
+
+- (id) initWithBase64EncodedData: (NSData*)base64Data
+			 options: (NSDataBase64DecodingOptions)options
+{
+  NSUInteger	length = [base64Data length];
+  const uint8_t	*src = (const uint8_t*)[base64Data bytes];
+  const uint8_t	*end = src + length;
+  uint8_t	*result;
+  uint8_t	*dst;
+  uint8_t	buf[4];
+  NSUInteger	pos = 0;
+  NSUInteger	pad = 0;
+  BOOL		valid = YES;
+
+  if (nil == base64Data)
+    {
+      DESTROY(self);
+      [NSException raise: NSInvalidArgumentException
+	format: @"[NSData-initWithBase64EncodedData:options:] nil data"];
+    }
+  result = NSZoneMalloc(NSDefaultMallocZone(), length / 4 * 3 + 3);
+  dst = result;
+  while (src < end)
+    {
+      int	c;
+      int	v;
+
+      if (0 == pos && 0 == pad)
+	{
+	  NSUInteger	used = GSPrivateBase64DecodeRun(dst, src, end - src);
+
+	  src += used;
+	  dst += used / 4 * 3;
+	  if (src == end)
+	    {
+	      break;
+	    }
+	}
+      c = *src++;
+      v = GSPrivateBase64Values[c];
+      if (v >= 0 && 0 == pad)
+	{
+	  buf[pos++] = v;
+	  if (4 == pos)
+	    {
+	      dst[0] = (buf[0] << 2) | (buf[1] >> 4);
+	      dst[1] = (buf[1] << 4) | (buf[2] >> 2);
+	      dst[2] = (buf[2] << 6) | buf[3];
+	      dst += 3;
+	      pos = 0;
+	    }
+	}
+      else if ('=' == c && pos >= 2 && pos + pad < 4)
+	{
+	  pad++;
+	}
+      else if (0 == (options & NSDataBase64DecodingIgnoreUnknownCharacters))
+	{
+	  valid = NO;
+	  break;
+	}
+    }
+  if (NO == valid || 1 == pos)
+    {
+      NSZoneFree(NSDefaultMallocZone(), result);
+      DESTROY(self);
+      return nil;
+    }
+  if (pos > 1)
+    {
+      dst[0] = (buf[0] << 2) | (buf[1] >> 4);
+      if (3 == pos)
+	{
+	  dst[1] = (buf[1] << 4) | (buf[2] >> 2);
+	}
+      dst += pos - 1;
+    }
+  return [self initWithBytesNoCopy: result length: dst - result];
+}
+
+- (id) initWithBase64EncodedString: (NSString*)base64String
+			   options: (NSDataBase64DecodingOptions)options
+{
+  NSData	*d;
+
+  if (nil == base64String)
+    {
+      DESTROY(self);
+      [NSException raise: NSInvalidArgumentException
+	format: @"[NSData-initWithBase64EncodedString:options:] nil string"];
+    }
+  d = [base64String dataUsingEncoding: NSASCIIStringEncoding
+		 allowLossyConversion: YES];
+  return [self initWithBase64EncodedData: d options: options];
+}
 @end
 
 /**
@@ -3792,6 +3960,31 @@ getBytes(void* dst, void* src, unsigned len, unsigned limit, unsigned *pos)
 
 @end
 
+void *
+GSPrivateDataSpace(NSMutableData *d, NSUInteger size)
+{
+  if (GSObjCIsKindOf(object_getClass(d), mutableDataMalloc) == YES)
+    {
+      NSMutableDataMalloc	*m = (NSMutableDataMalloc*)d;
+
+      if (m->length + size > m->capacity)
+	{
+	  [m _grow: m->length + size];
+	}
+      return m->bytes + m->length;
+    }
+  return 0;
+}
+
+void
+GSPrivateDataExtend(NSMutableData *d, NSUInteger size)
+{
+  NSMutableDataMalloc	*m = (NSMutableDataMalloc*)d;
+
+  NSCAssert(m->length + size <= m->capacity, NSInternalInconsistencyException);
+  m->length += size;
+}
+
 #if	GS_WITH_GC
 @implementation	NSMutableDataFinalized
 - (void) finalize
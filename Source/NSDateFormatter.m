@@ -31,7 +31,9 @@
   NSTimeZone *_tz; \
   NSDateFormatterStyle _timeStyle; \
   NSDateFormatterStyle _dateStyle; \
-  void      *_formatter
+  void      *_formatter; \
+  BOOL      _explicitFormat; \
+  GSFixedDateFormat _fixed
 
 #define	EXPOSE_NSDateFormatter_IVARS	1
 #import "common.h"
@@ -43,6 +45,9 @@
 #import "Foundation/NSLocale.h"
 #import "Foundation/NSTimeZone.h"
 #import "Foundation/NSFormatter.h"
+/* Before NSDateFormatter.h as the ivars use GSFixedDateFormat.
+ */
+#import "GSPrivate.h"
 #import "Foundation/NSDateFormatter.h"
 #import "Foundation/NSCoder.h"
 
@@ -62,6 +67,7 @@
 #define BUFFER_SIZE 1024
 
 @interface NSDateFormatter (PrivateMethods)
+- (void) _resetFixedFormat;
 - (void) _resetUDateFormat;
 - (void) _setSymbols: (NSArray *) array : (NSInteger) symbol;
 - (NSArray *) _getSymbols: (NSInteger) symbol;
@@ -349,7 +355,23 @@ static NSDateFormatterBehavior _defaultBehavior = 0;
   int32_t textLength;
   UErrorCode err = U_ZERO_ERROR;
   int32_t pPos = 0;
-  
+#endif
+
+  if (internal->_fixed.count > 0)
+    {
+      char		buf[GS_FIXED_DATE_LENGTH + 1];
+      NSTimeInterval	t;
+
+      if ([string getCString: buf
+		   maxLength: sizeof(buf)
+		    encoding: NSASCIIStringEncoding] == YES
+	&& GSPrivateFixedDateParse(&internal->_fixed, buf, strlen(buf),
+	  internal->_tz, &t) == YES)
+	{
+	  return [NSDate dateWithTimeIntervalSince1970: t];
+	}
+    }
+#if GS_USE_ICU == 1
   textLength = [string length];
   text = NSZoneMalloc ([self zone], sizeof(UChar) * textLength);
   if (text == NULL)
@@ -376,9 +398,27 @@ static NSDateFormatterBehavior _defaultBehavior = 0;
   int32_t length;
   unichar *string;
   NSZone *z = [self zone];
-  UDate udate = [date timeIntervalSince1970] * 1000.0;
+  UDate udate;
   UErrorCode err = U_ZERO_ERROR;
-  
+#endif
+
+  if (internal->_fixed.count > 0)
+    {
+      char		buf[GS_FIXED_DATE_LENGTH];
+      NSUInteger	len;
+
+      len = GSPrivateFixedDateFormat(&internal->_fixed, date,
+	internal->_tz, buf);
+      if (len > 0)
+	{
+	  return AUTORELEASE([[NSString allocWithZone: NSDefaultMallocZone()]
+	    initWithBytes: buf
+		   length: len
+		 encoding: NSASCIIStringEncoding]);
+	}
+    }
+#if GS_USE_ICU == 1
+  udate = [date timeIntervalSince1970] * 1000.0;
   length = udat_format (internal->_formatter, udate, NULL, 0, NULL, &err);
   string = NSZoneMalloc (z, sizeof(UChar) * (length + 1));
   err = U_ZERO_ERROR;
@@ -425,6 +465,8 @@ static NSDateFormatterBehavior _defaultBehavior = 0;
   if (_dateFormat)
     RELEASE(_dateFormat);
   _dateFormat = RETAIN(string);
+  internal->_explicitFormat = YES;
+  [self _resetFixedFormat];
 }
 
 - (NSDateFormatterStyle) dateStyle
@@ -435,6 +477,7 @@ static NSDateFormatterBehavior _defaultBehavior = 0;
 - (void) setDateStyle: (NSDateFormatterStyle) style
 {
   internal->_dateStyle = style;
+  internal->_explicitFormat = NO;
   [self _resetUDateFormat];
 }
 
@@ -446,6 +489,7 @@ static NSDateFormatterBehavior _defaultBehavior = 0;
 - (void) setTimeStyle: (NSDateFormatterStyle) style
 {
   internal->_timeStyle = style;
+  internal->_explicitFormat = NO;
   [self _resetUDateFormat];
 }
 
@@ -964,6 +1008,32 @@ static NSDateFormatterBehavior _defaultBehavior = 0;
 @end
 
 @implementation NSDateFormatter (PrivateMethods)
+/* Dates in a fixed pattern of numbers (such as ISO-8601) are formatted
+ * and parsed without ICU in the english locales (which all use western
+ * digits), and those with english day and month names (such as RFC-1123)
+ * only in the locales where the names are those of en_US_POSIX.
+ */
+- (void) _resetFixedFormat
+{
+  NSString	*ident = [internal->_locale localeIdentifier];
+
+  internal->_fixed.count = 0;
+  if (internal->_explicitFormat == NO || _dateFormat == nil
+    || [ident hasPrefix: @"en"] == NO
+    || [ident rangeOfString: @"@"].length > 0)
+    {
+      return;
+    }
+  if (GSPrivateFixedDateCompile(_dateFormat, &internal->_fixed) == YES
+    && internal->_fixed.hasNames
+    && [ident isEqualToString: @"en"] == NO
+    && [ident isEqualToString: @"en_US"] == NO
+    && [ident isEqualToString: @"en_US_POSIX"] == NO)
+    {
+      internal->_fixed.count = 0;
+    }
+}
+
 - (void) _resetUDateFormat
 {
 #if GS_USE_ICU == 1
@@ -990,9 +1060,23 @@ static NSDateFormatterBehavior _defaultBehavior = 0;
     internal->_formatter = NULL;
   
   NSZoneFree ([self zone], tzID);
-#else
-  return;
+
+  /* A new locale or time zone should not lose any pattern we were given.
+   */
+  if (internal->_explicitFormat && internal->_formatter && _dateFormat)
+    {
+      UChar	*pattern;
+      int32_t	patternLength;
+
+      patternLength = [_dateFormat length];
+      pattern = NSZoneMalloc ([self zone], sizeof(UChar) * patternLength);
+      [_dateFormat getCharacters: pattern
+			   range: NSMakeRange(0, patternLength)];
+      udat_applyPattern (internal->_formatter, 0, pattern, patternLength);
+      NSZoneFree ([self zone], pattern);
+    }
 #endif
+  [self _resetFixedFormat];
 }
 
 - (void) _setSymbols: (NSArray *) array : (NSInteger) symbol
@@ -670,6 +670,13 @@ GS_ROOT_CLASS @interface	GSDistantObjectPlaceHolder
  * sending a distributed objects message, so you are advised to use the
  * -setProtocolForProxy: method to avoid this occurring.
  * </p>
+ * <p>Signatures obtained from the remote process are cached by the
+ * connection and shared between all proxies for remote objects of the
+ * same class, so the cost is normally paid once per remote class and
+ * selector.  Objects whose signatures may differ from those of their
+ * class (proxies, protocol checkers and instances of classes overriding
+ * -methodSignatureForSelector:) have their signatures cached alone.
+ * </p>
  */
 - (NSMethodSignature*) methodSignatureForSelector: (SEL)aSelector
 {
@@ -725,20 +732,20 @@ GS_ROOT_CLASS @interface	GSDistantObjectPlaceHolder
 	    return [NSMethodSignature signatureWithObjCTypes: mth.types];
 	}
 
-      if (_sigs != 0)
-	{
-	  NSMutableDictionary	*d = (NSMutableDictionary*)_sigs;
-	  NSString		*s = NSStringFromSelector(aSelector);
-	  NSMethodSignature	*m = [d objectForKey: s];
-
-	  if (m != nil) return m;
-	}
-
 	{
-	  id		m = nil;
+	  id		m;
 	  id		inv;
 	  id		sig;
 
+	  /* The connection shares cached signatures between all the
+	   * proxies for remote objects of the same class.
+	   */
+	  m = [_connection cachedSignatureForSelector: aSelector proxy: self];
+	  if (m != nil)
+	    {
+	      return m;
+	    }
+
 	  DO_FORWARD_INVOCATION(methodSignatureForSelector:, aSelector);
 
 	  if ([m isProxy] == YES)
@@ -752,15 +759,7 @@ GS_ROOT_CLASS @interface	GSDistantObjectPlaceHolder
 	    }
 	  if (m != nil)
 	    {
-	      NSMutableDictionary	*d = (NSMutableDictionary*)_sigs;
-	      NSString			*s = NSStringFromSelector(aSelector);
-
-	      if (d == nil)
-		{
-		  d = [NSMutableDictionary new];
-		  _sigs = (void*)d;
-		}
-	      [d setObject: m forKey: s];
+	      [_connection cacheSignature: m forSelector: aSelector proxy: self];
 	    }
 	  return m;
 	}
@@ -33,6 +33,8 @@
 #import	"Foundation/NSFileManager.h"
 #import	"Foundation/NSArchiver.h"
 #import	"Foundation/NSNotification.h"
+#import	"Foundation/NSNull.h"
+#import	"Foundation/NSValue.h"
 #import	"Foundation/NSDate.h"
 #import	"Foundation/NSPathUtilities.h"
 #import	"Foundation/NSRunLoop.h"
@@ -55,6 +57,7 @@
 		     userInfo: (NSData*)info
 		     selector: (NSString*)aSelector
 			   to: (uint64_t)observer;
+- (void) postNotifications: (NSData*)batch;
 @end
 
 /**
@@ -820,5 +823,55 @@ static NSDistributedNotificationCenter	*netCenter = nil;
 		  withObject: notification];
 }
 
+/*
+ * Receives a batch of notifications from gdnc (see gdnc.h for the format).
+ * Each userInfo is unarchived once however many observers it goes to.
+ */
+- (void) postNotifications: (NSData*)batch
+{
+  NSArray	*entries = [NSUnarchiver unarchiveObjectWithData: batch];
+  NSNull	*null = [NSNull null];
+  NSUInteger	count = [entries count];
+  NSUInteger	pos;
+
+  for (pos = 0; pos < count; pos++)
+    {
+      NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+      NSArray		*entry = [entries objectAtIndex: pos];
+      NSString		*object = [entry objectAtIndex: 1];
+      id		info = [entry objectAtIndex: 2];
+      NSArray		*targets = [entry objectAtIndex: 3];
+      NSUInteger	tCount = [targets count];
+      NSUInteger	tPos;
+      id		userInfo = nil;
+      NSNotification	*notification;
+
+      if (object == (NSString*)null)
+	{
+	  object = nil;
+	}
+      if (info != null)
+	{
+	  userInfo = [NSUnarchiver unarchiveObjectWithData: info];
+	}
+      notification = [NSNotification
+	notificationWithName: [entry objectAtIndex: 0]
+		      object: object
+		    userInfo: userInfo];
+      for (tPos = 0; tPos + 1 < tCount; tPos += 2)
+	{
+	  NSString	*aSelector = [targets objectAtIndex: tPos];
+	  id		recipient;
+
+	  recipient = (id)(uintptr_t)
+	    [[targets objectAtIndex: tPos + 1] unsignedLongLongValue];
+	  [recipient performSelector:
+	    GSSelectorFromNameAndTypes([aSelector cString], 0)
+			  withObject: notification];
+	}
+      [arp release];
+    }
+}
+
 @end
 
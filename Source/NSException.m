@@ -746,6 +746,7 @@ static void _terminate()
   shouldAbort = NO;		// exit() by default.
 #endif
   shouldAbort = GSPrivateEnvironmentFlag("CRASH_ON_ABORT", shouldAbort);
+  GSPrivateLogFlushAtExit();	// Don't lose queued log messages.
   if (shouldAbort == YES)
     {
       abort();
@@ -761,6 +762,7 @@ _NSFoundationUncaughtExceptionHandler (NSException *exception)
 {
   NSAutoreleasePool	*pool = [NSAutoreleasePool new];
 
+  GSPrivateLogFlushAtExit();	// Write queued messages before the report.
   fprintf(stderr, "%s: Uncaught exception %s, reason: %s\n",
     GSPrivateArgZero(),
     [[exception name] lossyCString], [[exception reason] lossyCString]);
@@ -708,6 +708,51 @@ NSString * const NSFileHandleOperationException
   return NO;
 }
 
+/**
+ * Copies up to length bytes of the file represented by source (starting
+ * at offset) to the receiver, returning when all the data has been
+ * written or the end of the source file has been reached.<br />
+ * Returns the number of bytes copied.<br />
+ * Where the operating system permits, the data is passed directly from
+ * the source file to the receiver (eg. using sendfile() on linux)
+ * without being copied into the process, which makes this an efficient
+ * way to send the contents of a file over a network connection.<br />
+ * The file offset of source is unspecified after this method returns.<br />
+ * Raises an NSFileHandleOperationException if the data can't be written.
+ */
+- (unsigned long long) writeFromFileHandle: (NSFileHandle*)source
+				    offset: (unsigned long long)offset
+				    length: (unsigned long long)length
+{
+  unsigned long long	done = 0;
+
+  [source seekToFileOffset: offset];
+  while (done < length)
+    {
+      unsigned long long	chunk = length - done;
+      NSData			*d;
+      CREATE_AUTORELEASE_POOL(pool);
+
+      if (chunk > 65536)
+	{
+	  chunk = 65536;
+	}
+      d = [source readDataOfLength: (unsigned)chunk];
+      chunk = [d length];
+      if (chunk > 0)
+	{
+	  [self writeData: d];
+	  done += chunk;
+	}
+      RELEASE(pool);
+      if (chunk == 0)
+	{
+	  break;	// End of file.
+	}
+    }
+  return done;
+}
+
 @end
 
 @implementation NSFileHandle (GNUstepTLS)
@@ -1015,6 +1060,41 @@ GSTLSHandlePush(gnutls_transport_ptr_t handle, const void *buffer, size_t len)
               [d release];
             }
         }
+      /* Identify the remote end (and the host names used to verify it)
+       * so that the session may be resumed by a later connection.
+       * As for GSSocketStream, the key is built from the address of
+       * the peer, and the session is not cached if there is none.
+       */
+      if (YES == isOutgoing && nil == [opts objectForKey: GSTLSSessionKey])
+        {
+          struct sockaddr_storage       sstore;
+          struct sockaddr               *sa = (struct sockaddr*)&sstore;
+          socklen_t                     size = sizeof(sstore);
+
+          if (getpeername(descriptor, sa, &size) == 0
+            && (AF_INET == sa->sa_family
+#if     defined(AF_INET6)
+            || AF_INET6 == sa->sa_family
+#endif
+            ))
+            {
+              NSMutableDictionary       *d = [opts mutableCopy];
+              NSString                  *k = GSPrivateSockaddrName(sa);
+
+              if (nil == d)
+                {
+                  d = [NSMutableDictionary new];
+                }
+              if (nil != [opts objectForKey: GSTLSRemoteHosts])
+                {
+                  k = [NSString stringWithFormat: @"%@@%@",
+                    [opts objectForKey: GSTLSRemoteHosts], k];
+                }
+              [d setObject: k forKey: GSTLSSessionKey];
+              ASSIGNCOPY(opts, d);
+              [d release];
+            }
+        }
       [self setNonBlocking: YES];
       session = [[GSTLSSession alloc] initWithOptions: opts
                                             direction: isOutgoing
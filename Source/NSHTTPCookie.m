@@ -46,6 +46,7 @@
 #import "Foundation/NSCalendarDate.h"
 #import "GNUstepBase/Unicode.h"
 #import "GNUstepBase/NSObject+GNUstepBase.h"
+#import "GSPrivate.h"
 
 NSString * const NSHTTPCookieComment = @"Comment";
 NSString * const NSHTTPCookieCommentURL = @"CommentURL";
@@ -116,8 +117,24 @@ static const unsigned char whitespace[32] = {
 static id GSPropertyListFromCookieFormat(NSString *string, int version);
 static NSRange GSRangeOfCookie(NSString *string);
 
+/* Formats of the expires attribute, set up in +initialize.
+ */
+static GSFixedDateFormat	rfc1123;
+static GSFixedDateFormat	netscape;
+
 @implementation NSHTTPCookie
 
++ (void) initialize
+{
+  if (self == [NSHTTPCookie class])
+    {
+      GSPrivateFixedDateCompile(@"EEE, dd-MMM-yyyy HH:mm:ss zzz",
+	&netscape);
+      GSPrivateFixedDateCompile(@"EEE, dd MMM yyyy HH:mm:ss zzz",
+	&rfc1123);
+    }
+}
+
 + (id) allocWithZone: (NSZone*)z
 {
   NSHTTPCookie	*o = [super allocWithZone: z];
@@ -674,9 +691,26 @@ _setCookieKey(NSMutableDictionary *dict, NSString *key, NSString *value)
     [dict setObject: value forKey: NSHTTPCookieDomain];
   else if ([[key lowercaseString] isEqual: @"expires"])
     {
-      NSDate *expireDate;
-      expireDate = [NSCalendarDate dateWithString: value
-				calendarFormat: @"%a, %d-%b-%Y %I:%M:%S %Z"];
+      NSDate			*expireDate;
+      char			buf[GS_FIXED_DATE_LENGTH + 1];
+      NSTimeInterval		t;
+
+      /* Parse the usual formats directly from the bytes of the value,
+       * only using NSCalendarDate for anything unusual.
+       */
+      if ([value getCString: buf
+		  maxLength: sizeof(buf)
+		   encoding: NSASCIIStringEncoding] == YES
+	&& (GSPrivateFixedDateParse(&netscape, buf, strlen(buf), nil, &t)
+	  || GSPrivateFixedDateParse(&rfc1123, buf, strlen(buf), nil, &t)))
+	{
+	  expireDate = [NSDate dateWithTimeIntervalSince1970: t];
+	}
+      else
+	{
+	  expireDate = [NSCalendarDate dateWithString: value
+				    calendarFormat: @"%a, %d-%b-%Y %I:%M:%S %Z"];
+	}
       if (expireDate)
         [dict setObject: expireDate forKey: NSHTTPCookieExpires];
     }
@@ -318,3 +318,22 @@ static Class	concreteClass = 0;
 
 @end
 
+@implementation	NSHashTable (GNUstep)
+
+/**
+ * Returns counters for the removal of entries whose weak references
+ * have been zeroed: the number of such entries removed, and the number
+ * of times the whole table has been checked for them (which -count
+ * must do).  Entries are otherwise removed as lookups come across them
+ * and a few buckets at a time as entries are added.<br />
+ * Either argument may be NULL.  Tables which hold no weak references
+ * return zero for both.
+ */
+- (void) getPurged: (NSUInteger*)purged sweeps: (NSUInteger*)sweeps
+{
+  if (purged) *purged = 0;
+  if (sweeps) *sweeps = 0;
+}
+
+@end
+
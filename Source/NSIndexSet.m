@@ -30,6 +30,7 @@
 #import	"Foundation/NSIndexSet.h"
 #import	"Foundation/NSException.h"
 #import "GSDispatch.h"
+#import "GSIndexBitmap.h"
 
 #define	GSI_ARRAY_TYPE	NSRange
 
@@ -41,6 +42,30 @@
 #define	_array	((GSIArray)(self->_data))
 #define	_other	((GSIArray)(aSet->_data))
 
+/*
+ * A set normally holds its indexes as a sorted array of ranges.  Once a
+ * mutable set has so many ranges that they are packed densely into
+ * blocks of 65536 indexes, it holds them in a compressed bitmap instead,
+ * storing the bitmap pointer in _data with the low bit set.
+ */
+#define	IS_BITMAP(d)	((((uintptr_t)(d)) & 1) != 0)
+#define	BITMAP(d)	((GSIndexBitmap*)(((uintptr_t)(d)) & ~(uintptr_t)1))
+#define	TAG_BITMAP(b)	((void*)(((uintptr_t)(b)) | 1))
+
+#define	_isBitmap	IS_BITMAP(self->_data)
+#define	_bitmap		BITMAP(self->_data)
+#define	_otherIsBitmap	IS_BITMAP(aSet->_data)
+#define	_otherBitmap	BITMAP(aSet->_data)
+
+/* The fewest ranges for which a set is considered for conversion to
+ * a bitmap.
+ */
+#define	BITMAP_MIN_RANGES	1024
+
+/* A range spanning more blocks than this is never put in a bitmap.
+ */
+#define	BITMAP_MAX_BLOCKS	4096
+
 #ifdef	SANITY_CHECKS
 static void sanity(GSIArray array)
 {
@@ -117,6 +142,129 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
   return pos;
 }
 
+/*
+ * Returns the run of consecutive indexes in the set whose contents are
+ * in data, starting at the first index greater than or equal to index.
+ * The location of the result is NSNotFound if there is no such index.
+ */
+static NSRange rangeFrom(void *data, NSUInteger index)
+{
+  if (IS_BITMAP(data))
+    {
+      return GSIndexBitmapRangeFrom(BITMAP(data), index);
+    }
+  if (data != 0)
+    {
+      GSIArray		array = (GSIArray)data;
+      NSUInteger	pos = posForIndex(array, index);
+
+      if (pos < GSIArrayCount(array))
+	{
+	  NSRange	r = GSIArrayItemAtIndex(array, pos).ext;
+
+	  if (r.location < index)
+	    {
+	      r.length -= (index - r.location);
+	      r.location = index;
+	    }
+	  return r;
+	}
+    }
+  return NSMakeRange(NSNotFound, 0);
+}
+
+/*
+ * Returns the number of blocks of 65536 indexes touched by the ranges
+ * in array, giving up as soon as the number exceeds limit.
+ */
+static NSUInteger blocksInArray(GSIArray array, NSUInteger limit)
+{
+  NSUInteger	count = GSIArrayCount(array);
+  NSUInteger	blocks = 0;
+  NSUInteger	last = NSNotFound;
+  NSUInteger	i;
+
+  for (i = 0; i < count && blocks <= limit; i++)
+    {
+      NSRange		r = GSIArrayItemAtIndex(array, i).ext;
+      NSUInteger	first = r.location >> 16;
+      NSUInteger	final = (NSMaxRange(r) - 1) >> 16;
+
+      blocks += (final - first + 1);
+      if (first == last)
+	{
+	  blocks--;
+	}
+      last = final;
+    }
+  return blocks;
+}
+
+/*
+ * Returns YES if the ranges in array are dense enough that a bitmap
+ * would hold them more compactly ... that is, if they lie in fewer than
+ * a quarter as many blocks of 65536 indexes as there are ranges.
+ */
+static BOOL shouldUseBitmap(GSIArray array)
+{
+#if	GS_WITH_GC
+  return NO;
+#else
+  NSUInteger	limit = GSIArrayCount(array) / 4;
+
+  return (blocksInArray(array, limit) < limit) ? YES : NO;
+#endif
+}
+
+/*
+ * Replaces the array of ranges in *data with a bitmap.
+ */
+static void useBitmap(void **data, NSZone *zone)
+{
+  GSIArray	array = (GSIArray)*data;
+  GSIndexBitmap	*b = GSIndexBitmapCreate(zone);
+  NSUInteger	count = GSIArrayCount(array);
+  NSUInteger	i;
+
+  for (i = 0; i < count; i++)
+    {
+      GSIndexBitmapAddRange(b, GSIArrayItemAtIndex(array, i).ext);
+    }
+  GSIArrayClear(array);
+  NSZoneFree(zone, array);
+  *data = TAG_BITMAP(b);
+}
+
+/*
+ * Returns a new array holding the indexes of a bitmap as ranges.
+ */
+static GSIArray arrayFromBitmap(GSIndexBitmap *b, NSZone *zone)
+{
+  GSIArray		array;
+  GSIndexBitmapCursor	cursor;
+  NSRange		r;
+
+  array = (GSIArray)NSZoneMalloc(zone, sizeof(GSIArray_t));
+  GSIArrayInitWithZoneAndCapacity(array, zone, 8);
+  GSIndexBitmapCursorInit(&cursor, b, 0);
+  while ((r = GSIndexBitmapCursorNext(&cursor)).length > 0)
+    {
+      GSIArrayAddItem(array, (GSIArrayItem)r);
+    }
+  return array;
+}
+
+/*
+ * Replaces the bitmap in *data with an array of ranges.
+ */
+static void useRanges(void **data, NSZone *zone)
+{
+  GSIndexBitmap	*b = BITMAP(*data);
+
+  *data = arrayFromBitmap(b, zone);
+  GSIndexBitmapFree(b);
+}
+
 @implementation	NSIndexSet
 + (id) indexSet
 {
@@ -147,6 +295,10 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
   NSUInteger	pos;
   NSRange	r;
 
+  if (_isBitmap)
+    {
+      return GSIndexBitmapContains(_bitmap, anIndex);
+    }
   if (_array == 0 || GSIArrayCount(_array) == 0
     || (pos = posForIndex(_array, anIndex)) >= GSIArrayCount(_array))
     {
@@ -158,8 +310,28 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 
 - (BOOL) containsIndexes: (NSIndexSet*)aSet
 {
-  NSUInteger	count = _other ? GSIArrayCount(_other) : 0;
+  NSUInteger	count;
+
+  if (_otherIsBitmap)
+    {
+      GSIndexBitmapCursor	cursor;
+      NSRange			r;
 
+      if (_isBitmap)
+	{
+	  return GSIndexBitmapContainsBitmap(_bitmap, _otherBitmap);
+	}
+      GSIndexBitmapCursorInit(&cursor, _otherBitmap, 0);
+      while ((r = GSIndexBitmapCursorNext(&cursor)).length > 0)
+	{
+	  if ([self containsIndexesInRange: r] == NO)
+	    {
+	      return NO;
+	    }
+	}
+      return YES;
+    }
+  count = _other ? GSIArrayCount(_other) : 0;
   if (count > 0)
     {
       NSUInteger	i;
@@ -188,6 +360,20 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 		  format: @"[%@-%@]: Bad range",
         NSStringFromClass([self class]), NSStringFromSelector(_cmd)];
     }
+  if (_isBitmap)
+    {
+      r = GSIndexBitmapRangeFrom(_bitmap, aRange.location);
+      if (r.location == NSNotFound)
+	{
+	  return NO;
+	}
+      if (aRange.length == 0)
+	{
+	  return YES;
+	}
+      return (r.location == aRange.location && r.length >= aRange.length)
+	? YES : NO;
+    }
   if (_array == 0 || GSIArrayCount(_array) == 0
     || (pos = posForIndex(_array, aRange.location)) >= GSIArrayCount(_array))
     {
@@ -222,6 +408,10 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 
 - (NSUInteger) count
 {
+  if (_isBitmap)
+    {
+      return GSIndexBitmapCount(_bitmap);
+    }
   if (_array == 0 || GSIArrayCount(_array) == 0)
     {
       return 0;
@@ -243,6 +433,10 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 
 - (NSUInteger) countOfIndexesInRange: (NSRange)range
 {
+  if (_isBitmap)
+    {
+      return GSIndexBitmapCountInRange(_bitmap, range);
+    }
   if (_array == 0 || GSIArrayCount(_array) == 0)
     {
       return 0;
@@ -267,7 +461,12 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 
 - (void) dealloc
 {
-  if (_array != 0)
+  if (_isBitmap)
+    {
+      GSIndexBitmapFree(_bitmap);
+      _data = 0;
+    }
+  else if (_array != 0)
     {
       GSIArrayClear(_array);
       NSZoneFree([self zone], _array);
@@ -279,11 +478,22 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 - (NSString*) description
 {
   NSMutableString	*m;
-  NSUInteger		c = (_array == 0) ? 0 : GSIArrayCount(_array);
+  GSIArray		array = _array;
+  NSUInteger		c;
   NSUInteger		i;
 
+  if (_isBitmap)
+    {
+      array = arrayFromBitmap(_bitmap, NSDefaultMallocZone());
+    }
+  c = (array == 0) ? 0 : GSIArrayCount(array);
   if (c == 0)
     {
+      if (array != _array)
+	{
+	  GSIArrayClear(array);
+	  NSZoneFree(NSDefaultMallocZone(), array);
+	}
       return [NSString stringWithFormat: @"%@(no indexes)",
         [super description]];
     }
@@ -292,7 +502,7 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
     [super description], [self count], c];
   for (i = 0; i < c; i++)
     {
-      NSRange	r = GSIArrayItemAtIndex(_array, i).ext;
+      NSRange	r = GSIArrayItemAtIndex(array, i).ext;
 
       if (r.length > 1)
         {
@@ -304,16 +514,28 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 	}
     }
   [m appendString: @"]"];
+  if (array != _array)
+    {
+      GSIArrayClear(array);
+      NSZoneFree(NSDefaultMallocZone(), array);
+    }
   return m;
 }
 
 - (void) encodeWithCoder: (NSCoder*)aCoder
 {
-  NSUInteger rangeCount = 0;
+  GSIArray	array = _array;
+  NSUInteger	rangeCount = 0;
 
-  if (_array != 0)
+  if (_isBitmap)
+    {
+      /* The archived form is the same whichever way the indexes are held.
+       */
+      array = arrayFromBitmap(_bitmap, NSDefaultMallocZone());
+    }
+  if (array != 0)
     {
-      rangeCount = GSIArrayCount(_array);
+      rangeCount = GSIArrayCount(array);
     }
 
   if ([aCoder allowsKeyedCoding])
@@ -334,7 +556,7 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
     {
       NSRange	r;
 
-      r = GSIArrayItemAtIndex(_array, 0).ext;
+      r = GSIArrayItemAtIndex(array, 0).ext;
       if ([aCoder allowsKeyedCoding])
         {
           [aCoder encodeInt: r.location forKey: @"NSLocation"];
@@ -359,7 +581,7 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
           NSUInteger    v;
           uint8_t       b;
 
-          r = GSIArrayItemAtIndex(_array, i).ext;
+          r = GSIArrayItemAtIndex(array, i).ext;
           v = r.location;
           do
             {
@@ -400,10 +622,19 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
           [aCoder encodeObject: m];
         }
     }
+  if (array != _array)
+    {
+      GSIArrayClear(array);
+      NSZoneFree(NSDefaultMallocZone(), array);
+    }
 }
 
 - (NSUInteger) firstIndex
 {
+  if (_isBitmap)
+    {
+      return GSIndexBitmapNext(_bitmap, 0);
+    }
   if (_array == 0 || GSIArrayCount(_array) == 0)
     {
       return NSNotFound;
@@ -437,6 +668,40 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 		  format: @"[%@-%@]: Bad range",
         NSStringFromClass([self class]), NSStringFromSelector(_cmd)];
     }
+  if (_isBitmap)
+    {
+      GSIndexBitmapCursor	cursor;
+
+      GSIndexBitmapCursorInit(&cursor, _bitmap, aRange->location);
+      r = GSIndexBitmapCursorNext(&cursor);
+      if (r.length == 0)
+	{
+	  *aRange = NSMakeRange(NSMaxRange(*aRange), 0);
+	  return 0;
+	}
+      while (aRange->length > 0 && i < aCount && r.length > 0)
+	{
+	  if (aRange->location < r.location)
+	    {
+	      NSUInteger	skip = r.location - aRange->location;
+
+	      if (skip > aRange->length)
+		{
+		  skip = aRange->length;
+		}
+	      aRange->location += skip;
+	      aRange->length -= skip;
+	    }
+	  while (aRange->length > 0 && i < aCount
+	    && aRange->location < NSMaxRange(r))
+	    {
+	      aBuffer[i++] = aRange->location++;
+	      aRange->length--;
+	    }
+	  r = GSIndexBitmapCursorNext(&cursor);
+	}
+      return i;
+    }
   if (_array == 0 || GSIArrayCount(_array) == 0
     || (pos = posForIndex(_array, aRange->location)) >= GSIArrayCount(_array))
     {
@@ -489,6 +754,10 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
     {
       return NSNotFound;
     }
+  if (_isBitmap)
+    {
+      return GSIndexBitmapNext(_bitmap, anIndex);
+    }
   if (_array == 0 || GSIArrayCount(_array) == 0
     || (pos = posForIndex(_array, anIndex)) >= GSIArrayCount(_array))
     {
@@ -511,6 +780,10 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
     {
       return NSNotFound;
     }
+  if (_isBitmap)
+    {
+      return GSIndexBitmapNext(_bitmap, anIndex);
+    }
   if (_array == 0 || GSIArrayCount(_array) == 0
     || (pos = posForIndex(_array, anIndex)) >= GSIArrayCount(_array))
     {
@@ -533,6 +806,10 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
     {
       return NSNotFound;
     }
+  if (_isBitmap)
+    {
+      return GSIndexBitmapPrevious(_bitmap, anIndex);
+    }
   if (_array == 0 || GSIArrayCount(_array) == 0
     || (pos = posForIndex(_array, anIndex)) >= GSIArrayCount(_array))
     {
@@ -556,6 +833,10 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
   NSUInteger	pos;
   NSRange	r;
 
+  if (_isBitmap)
+    {
+      return GSIndexBitmapPrevious(_bitmap, anIndex);
+    }
   if (_array == 0 || GSIArrayCount(_array) == 0
     || (pos = posForIndex(_array, anIndex)) >= GSIArrayCount(_array))
     {
@@ -750,6 +1031,13 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
     {
       DESTROY(self);
     }
+  else if (_otherIsBitmap)
+    {
+      if (GSIndexBitmapCount(_otherBitmap) > 0)
+	{
+	  _data = TAG_BITMAP(GSIndexBitmapCopy(_otherBitmap, [self zone]));
+	}
+    }
   else
     {
       NSUInteger count = _other ? GSIArrayCount(_other) : 0;
@@ -786,6 +1074,15 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 		  format: @"[%@-%@]: Bad range",
         NSStringFromClass([self class]), NSStringFromSelector(_cmd)];
     }
+  if (_isBitmap)
+    {
+      if (aRange.length == 0)
+	{
+	  return NO;
+	}
+      return (GSIndexBitmapNext(_bitmap, aRange.location) < NSMaxRange(aRange))
+	? YES : NO;
+    }
   if (aRange.length == 0 || _array == 0 || GSIArrayCount(_array) == 0)
     {
       return NO;	// Empty
@@ -823,8 +1120,34 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 
 - (BOOL) isEqualToIndexSet: (NSIndexSet*)aSet
 {
-  NSUInteger	count = _other ? GSIArrayCount(_other) : 0;
+  NSUInteger	count;
+
+  if (_isBitmap || _otherIsBitmap)
+    {
+      NSRange	r0;
+      NSRange	r1;
 
+      if (_isBitmap && _otherIsBitmap)
+	{
+	  return GSIndexBitmapEqual(_bitmap, _otherBitmap);
+	}
+      /* Both representations hold maximal runs of indexes, so the sets
+       * are equal if they produce the same sequence of runs.
+       */
+      r0 = rangeFrom(self->_data, 0);
+      r1 = rangeFrom(aSet->_data, 0);
+      while (r0.location != NSNotFound)
+	{
+	  if (NSEqualRanges(r0, r1) == NO)
+	    {
+	      return NO;
+	    }
+	  r0 = rangeFrom(self->_data, NSMaxRange(r0));
+	  r1 = rangeFrom(aSet->_data, NSMaxRange(r1));
+	}
+      return (r1.location == NSNotFound) ? YES : NO;
+    }
+  count = _other ? GSIArrayCount(_other) : 0;
   if (count != (_array ? GSIArrayCount(_array) : 0))
     {
       return NO;
@@ -849,6 +1172,10 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 
 - (NSUInteger) lastIndex
 {
+  if (_isBitmap)
+    {
+      return GSIndexBitmapPrevious(_bitmap, NSNotFound - 1);
+    }
   if (_array == 0 || GSIArrayCount(_array) == 0)
     {
       return NSNotFound;
@@ -881,6 +1208,48 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
       return;
     }
 
+  if (_isBitmap)
+    {
+      if (0 == range.length)
+	{
+	  return;
+	}
+      lastInRange = (NSMaxRange(range) - 1);
+      GS_DISPATCH_CREATE_QUEUE_AND_GROUP_FOR_ENUMERATION(enumQueue, opts)
+      if (isReverse)
+	{
+	  i = GSIndexBitmapPrevious(_bitmap, lastInRange);
+	  while (NO == shouldStop && i != NSNotFound && i >= range.location)
+	    {
+	      GS_DISPATCH_SUBMIT_BLOCK(enumQueueGroup, enumQueue,
+		if (shouldStop) {return;}, return;,
+		aBlock, i, &shouldStop);
+	      i = (0 == i) ? NSNotFound : GSIndexBitmapPrevious(_bitmap, i - 1);
+	    }
+	}
+      else
+	{
+	  GSIndexBitmapCursor	cursor;
+	  NSRange		r;
+
+	  GSIndexBitmapCursorInit(&cursor, _bitmap, range.location);
+	  while (NO == shouldStop
+	    && (r = GSIndexBitmapCursorNext(&cursor)).length > 0
+	    && r.location <= lastInRange)
+	    {
+	      c = MIN(NSMaxRange(r) - 1, lastInRange);
+	      for (i = r.location; NO == shouldStop && i <= c; i++)
+		{
+		  GS_DISPATCH_SUBMIT_BLOCK(enumQueueGroup, enumQueue,
+		    if (shouldStop) {return;}, return;,
+		    aBlock, i, &shouldStop);
+		}
+	    }
+	}
+      GS_DISPATCH_TEARDOWN_QUEUE_AND_GROUP_FOR_ENUMERATION(enumQueue, opts)
+      return;
+    }
+
   startArrayIndex = posForIndex(_array, range.location);
   if (NSNotFound == startArrayIndex)
     {
@@ -1003,6 +1372,10 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 
 #undef	_other
 #define	_other	((GSIArray)(((NSMutableIndexSet*)aSet)->_data))
+#undef	_otherIsBitmap
+#define	_otherIsBitmap	IS_BITMAP(((NSMutableIndexSet*)aSet)->_data)
+#undef	_otherBitmap
+#define	_otherBitmap	BITMAP(((NSMutableIndexSet*)aSet)->_data)
 
 - (void) addIndex: (NSUInteger)anIndex
 {
@@ -1011,8 +1384,45 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 
 - (void) addIndexes: (NSIndexSet*)aSet
 {
-  NSUInteger	count = _other ? GSIArrayCount(_other) : 0;
+  NSUInteger	count;
+
+  if (aSet == self)
+    {
+      return;
+    }
+  if (_otherIsBitmap)
+    {
+      GSIndexBitmapCursor	cursor;
+      NSRange			r;
 
+      /* Adopt the bitmap representation unless we hold ranges which
+       * would be too large to put in a bitmap.
+       */
+      if (!_isBitmap && (_array == 0
+	|| blocksInArray(_array, BITMAP_MAX_BLOCKS) <= BITMAP_MAX_BLOCKS))
+	{
+	  if (_array == 0)
+	    {
+	      _data = TAG_BITMAP(GSIndexBitmapCreate([self zone]));
+	    }
+	  else
+	    {
+	      useBitmap(&_data, [self zone]);
+	    }
+	}
+      if (_isBitmap)
+	{
+	  GSIndexBitmapUnion(_bitmap, _otherBitmap);
+	  return;
+	}
+      GSIndexBitmapCursorInit(&cursor, _otherBitmap, 0);
+      while ((r = GSIndexBitmapCursorNext(&cursor)).length > 0)
+	{
+	  [self addIndexesInRange: r];
+	}
+      return;
+    }
+  count = _other ? GSIArrayCount(_other) : 0;
   if (count > 0)
     {
       NSUInteger	i;
@@ -1029,6 +1439,7 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 - (void) addIndexesInRange: (NSRange)aRange
 {
   NSUInteger	pos;
+  NSUInteger	count;
 
   if (NSNotFound - aRange.length < aRange.location)
     {
@@ -1040,6 +1451,17 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
     {
       return;
     }
+  if (_isBitmap)
+    {
+      if ((aRange.length >> 16) <= BITMAP_MAX_BLOCKS)
+	{
+	  GSIndexBitmapAddRange(_bitmap, aRange);
+	  return;
+	}
+      /* A huge range is held far more compactly as a range.
+       */
+      useRanges(&_data, [self zone]);
+    }
   if (_array == 0)
     {
 #if	GS_WITH_GC
@@ -1117,6 +1539,18 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 	}
     }
   SANITY();
+
+  /*
+   * A set with very many ranges may be better held as a bitmap.  We only
+   * check each time the number of ranges reaches a power of two, so the
+   * cost of checking is spread over the insertions.
+   */
+  count = GSIArrayCount(_array);
+  if (count >= BITMAP_MIN_RANGES && (count & (count - 1)) == 0
+    && shouldUseBitmap(_array))
+    {
+      useBitmap(&_data, [self zone]);
+    }
 }
 
 - (id) copyWithZone: (NSZone*)aZone
@@ -1126,9 +1560,48 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
   return [c initWithIndexSet: self];
 }
 
+- (void) intersectIndexes: (NSIndexSet*)aSet
+{
+  void		*other = ((NSMutableIndexSet*)aSet)->_data;
+  NSUInteger	next = 0;
+  NSRange	r;
+
+  if (aSet == self)
+    {
+      return;
+    }
+  if (_isBitmap && _otherIsBitmap)
+    {
+      GSIndexBitmapIntersect(_bitmap, _otherBitmap);
+      return;
+    }
+  /*
+   * Remove every gap between the runs of indexes in aSet.
+   */
+  r = rangeFrom(other, 0);
+  while (r.location != NSNotFound)
+    {
+      if (r.location > next)
+	{
+	  [self removeIndexesInRange: NSMakeRange(next, r.location - next)];
+	}
+      next = NSMaxRange(r);
+      r = rangeFrom(other, next);
+    }
+  if (next < NSNotFound)
+    {
+      [self removeIndexesInRange: NSMakeRange(next, NSNotFound - next)];
+    }
+}
+
 - (void) removeAllIndexes
 {
-  if (_array != 0)
+  if (_isBitmap)
+    {
+      GSIndexBitmapFree(_bitmap);
+      _data = 0;
+    }
+  else if (_array != 0)
     {
       GSIArrayRemoveAllItems(_array);
     }
@@ -1141,8 +1614,31 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 
 - (void) removeIndexes: (NSIndexSet*)aSet
 {
-  NSUInteger	count = _other ? GSIArrayCount(_other) : 0;
+  NSUInteger	count;
+
+  if (aSet == self)
+    {
+      [self removeAllIndexes];
+      return;
+    }
+  if (_otherIsBitmap)
+    {
+      GSIndexBitmapCursor	cursor;
+      NSRange			r;
 
+      if (_isBitmap)
+	{
+	  GSIndexBitmapSubtract(_bitmap, _otherBitmap);
+	  return;
+	}
+      GSIndexBitmapCursorInit(&cursor, _otherBitmap, 0);
+      while ((r = GSIndexBitmapCursorNext(&cursor)).length > 0)
+	{
+	  [self removeIndexesInRange: r];
+	}
+      return;
+    }
+  count = _other ? GSIArrayCount(_other) : 0;
   if (count > 0)
     {
       NSUInteger	i;
@@ -1167,6 +1663,14 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 		  format: @"[%@-%@]: Bad range",
         NSStringFromClass([self class]), NSStringFromSelector(_cmd)];
     }
+  if (_isBitmap)
+    {
+      if (aRange.length > 0)
+	{
+	  GSIndexBitmapRemoveRange(_bitmap, aRange);
+	}
+      return;
+    }
   if (aRange.length == 0 || _array == 0
     || (pos = posForIndex(_array, aRange.location)) >= GSIArrayCount(_array))
     {
@@ -1271,6 +1775,12 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
 
 - (void) shiftIndexesStartingAtIndex: (NSUInteger)anIndex by: (NSInteger)amount
 {
+  if (_isBitmap && amount != 0)
+    {
+      /* Shifting moves indexes between blocks, so we do it on ranges.
+       */
+      useRanges(&_data, [self zone]);
+    }
   if (amount != 0 && _array != 0 && GSIArrayCount(_array) > 0)
     {
       NSUInteger	c;
@@ -1406,6 +1916,26 @@ static NSUInteger posForIndex(GSIArray array, NSUInteger index)
     {
       return NSNotFound;
     }
+  if (_isBitmap)
+    {
+      NSUInteger	last;
+
+      r = GSIndexBitmapRangeFrom(_bitmap, anIndex);
+      if (r.location == NSNotFound)
+	{
+	  last = GSIndexBitmapPrevious(_bitmap, NSNotFound - 1);
+	  if (last == NSNotFound || anIndex > last + 1)
+	    {
+	      return NSNotFound;
+	    }
+	  return anIndex;	// anIndex is the gap after the last index.
+	}
+      if (r.location > anIndex)
+	{
+	  return anIndex;	// anIndex is in a gap between index ranges.
+	}
+      return NSMaxRange(r);	// Return start of gap after the index range.
+    }
   if (_array == 0 || GSIArrayCount(_array) == 0)
     {
       return NSNotFound;
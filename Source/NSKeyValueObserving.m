@@ -43,6 +43,7 @@
 #import "GNUstepBase/GSLock.h"
 #import "GNUstepBase/NSObject+GNUstepBase.h"
 #import "GSInvocation.h"
+#import "GSPThread.h"
 
 #if defined(USE_LIBFFI)
 #import "cifframe.h"
@@ -76,10 +77,21 @@ NSString *const NSKeyValueChangeNotificationIsPriorKey = @"notificationIsPrior";
 
 static NSRecursiveLock	*kvoLock = nil;
 static NSMapTable	*classTable = 0;
-static NSMapTable	*infoTable = 0;
 static NSMapTable       *dependentKeyTable;
 static Class		baseClass;
 static id               null;
+static IMP		defaultInfoImp = 0;
+
+/* The observation information for instances is held in a number of
+ * separately locked tables, chosen by the address of the instance, so
+ * that changes to different objects do not contend for kvoLock.
+ */
+#define	INFO_STRIPES	64
+typedef struct {
+  pthread_mutex_t	lock;
+  NSMapTable		*table;
+} GSKVOInfoStripe;
+static GSKVOInfoStripe	infoStripes[INFO_STRIPES];
 
 static inline void
 setup()
@@ -89,15 +101,27 @@ setup()
       [gnustep_global_lock lock];
       if (nil == kvoLock)
 	{
-	  kvoLock = [GSLazyRecursiveLock new];
+	  unsigned	i;
+
 	  null = [[NSNull null] retain];
 	  classTable = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
 	    NSNonOwnedPointerMapValueCallBacks, 128);
-	  infoTable = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
-	    NSNonOwnedPointerMapValueCallBacks, 1024);
+	  for (i = 0; i < INFO_STRIPES; i++)
+	    {
+	      pthread_mutex_init(&infoStripes[i].lock, NULL);
+	      infoStripes[i].table = NSCreateMapTable(
+		NSNonOwnedPointerMapKeyCallBacks,
+		NSNonOwnedPointerMapValueCallBacks, 32);
+	    }
 	  dependentKeyTable = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
 	      NSOwnedPointerMapValueCallBacks, 128);
 	  baseClass = NSClassFromString(@"GSKVOBase");
+	  defaultInfoImp = [NSObject instanceMethodForSelector:
+	    @selector(observationInfo)];
+	  /* Everything must be set up before other threads see the lock.
+	   */
+	  __sync_synchronize();
+	  kvoLock = [GSLazyRecursiveLock new];
 	}
       [gnustep_global_lock unlock];
     }
@@ -210,6 +234,41 @@ setup()
 - (void) keyPathChanged: (id)objectToObserve;
 @end
 
+static inline GSKVOInfoStripe *
+stripeFor(id o)
+{
+  uintptr_t	h = (uintptr_t)o;
+
+  return &infoStripes[((h >> 4) ^ (h >> 10)) % INFO_STRIPES];
+}
+
+/* Returns the observation information for an instance, retained so
+ * that it can't go away while a change is being notified.  Unless the
+ * class stores the information itself, this locks only the table
+ * holding the information for the instance.
+ */
+static inline GSKVOInfo *
+retainedInfo(NSObject *o)
+{
+  GSKVOInfo	*info;
+
+  setup();
+  if (class_getMethodImplementation(object_getClass(o),
+    @selector(observationInfo)) == defaultInfoImp)
+    {
+      GSKVOInfoStripe	*s = stripeFor(o);
+
+      pthread_mutex_lock(&s->lock);
+      info = RETAIN((GSKVOInfo*)NSMapGet(s->table, (void*)o));
+      pthread_mutex_unlock(&s->lock);
+    }
+  else
+    {
+      info = RETAIN((GSKVOInfo*)[o observationInfo]);
+    }
+  return info;
+}
+
 @implementation	GSKVOBase
 
 - (void) dealloc
@@ -389,35 +448,167 @@ replacementForClass(Class c)
   return r;
 }
 
+/* The replacement setters find what they need to know about the setter
+ * they replace (the key it sets, its implementation and whether the
+ * class wants automatic notification) in this table, keyed by the
+ * replacement class and the selector, rather than working it out on
+ * every call.  Records are added the first time a replacement setter
+ * is called and are never removed, so the table is read without
+ * locking: a slot is written only once, after the record it points to
+ * is complete, and a table which has been outgrown is left in place
+ * for any readers still using it.
+ */
+typedef struct {
+  Class		cls;		/* The replacement class */
+  SEL		sel;		/* The setter selector */
+  NSString	*key;		/* The key set by the setter */
+  IMP		imp;		/* The original setter */
+  BOOL		notify;		/* Notify observers automatically */
+} GSKVOSetterInfo;
+
+typedef struct {
+  unsigned		mask;
+  unsigned		count;
+  GSKVOSetterInfo	*slot[1];
+} GSKVOSetterTable;
+
+static GSKVOSetterTable * volatile setterTable = 0;
+
+static inline unsigned
+setterHash(Class c, SEL s)
+{
+  uintptr_t	h = ((uintptr_t)c >> 3) * 31 + ((uintptr_t)s >> 3);
+
+  return (unsigned)(h ^ (h >> 16));
+}
+
+static inline GSKVOSetterInfo *
+setterFind(GSKVOSetterTable *t, Class c, SEL s)
+{
+  if (t != 0)
+    {
+      unsigned		i = setterHash(c, s) & t->mask;
+      GSKVOSetterInfo	*info;
+
+      while ((info = t->slot[i]) != 0)
+	{
+	  if (info->cls == c && info->sel == s)
+	    {
+	      return info;
+	    }
+	  i = (i + 1) & t->mask;
+	}
+    }
+  return 0;
+}
+
+/* Adds a record to the table, growing it when it is half full.
+ * The caller must hold kvoLock.
+ */
+static void
+setterAdd(GSKVOSetterInfo *info)
+{
+  GSKVOSetterTable	*t = setterTable;
+  unsigned		i;
+
+  if (t == 0 || (t->count + 1) * 2 > t->mask + 1)
+    {
+      unsigned		size = (t == 0) ? 64 : (t->mask + 1) * 2;
+      GSKVOSetterTable	*n;
+
+      n = calloc(1, sizeof(GSKVOSetterTable)
+	+ (size - 1) * sizeof(GSKVOSetterInfo*));
+      n->mask = size - 1;
+      if (t != 0)
+	{
+	  for (i = 0; i <= t->mask; i++)
+	    {
+	      GSKVOSetterInfo	*old = t->slot[i];
+
+	      if (old != 0)
+		{
+		  unsigned	j = setterHash(old->cls, old->sel) & n->mask;
+
+		  while (n->slot[j] != 0)
+		    {
+		      j = (j + 1) & n->mask;
+		    }
+		  n->slot[j] = old;
+		  n->count++;
+		}
+	    }
+	}
+      __sync_synchronize();
+      setterTable = t = n;
+    }
+  i = setterHash(info->cls, info->sel) & t->mask;
+  while (t->slot[i] != 0)
+    {
+      i = (i + 1) & t->mask;
+    }
+  __sync_synchronize();
+  t->slot[i] = info;
+  t->count++;
+}
+
+/* Returns the record for the replacement setter sel called on o,
+ * creating it the first time.
+ */
+static GSKVOSetterInfo *
+setterInfo(id o, SEL sel)
+{
+  Class			c = object_getClass(o);
+  GSKVOSetterInfo	*info = setterFind(setterTable, c, sel);
+
+  if (info == 0)
+    {
+      Class		original = [o class];
+      NSString		*key = newKey(sel);
+      IMP		imp = [original instanceMethodForSelector: sel];
+      BOOL		notify;
+
+      notify = [original automaticallyNotifiesObserversForKey: key];
+      setup();
+      [kvoLock lock];
+      info = setterFind(setterTable, c, sel);
+      if (info == 0)
+	{
+	  info = malloc(sizeof(GSKVOSetterInfo));
+	  info->cls = c;
+	  info->sel = sel;
+	  info->key = key;
+	  info->imp = imp;
+	  info->notify = notify;
+	  setterAdd(info);
+	  key = nil;
+	}
+      [kvoLock unlock];
+      RELEASE(key);
+    }
+  return info;
+}
+
 #if defined(USE_LIBFFI)
 static void
 cifframe_callback(ffi_cif *cif, void *retp, void **args, void *user)
 {
-  id            obj;
-  SEL           sel;
-  NSString	*key;
-  Class		c;
-  void		(*imp)(id,SEL,void*);
+  id			obj;
+  GSKVOSetterInfo	*s;
 
   obj = *(id *)args[0];
-  sel = *(SEL *)args[1];
-  c = [obj class];
-
-  imp = (void (*)(id,SEL,void*))[c instanceMethodForSelector: sel];
-  key = newKey(sel);
-  if ([c automaticallyNotifiesObserversForKey: key] == YES)
+  s = setterInfo(obj, *(SEL *)args[1]);
+  if (s->notify == YES)
     {
       // pre setting code here
-      [obj willChangeValueForKey: key];
-      ffi_call(cif, (void*)imp, retp, args);
+      [obj willChangeValueForKey: s->key];
+      ffi_call(cif, (void*)s->imp, retp, args);
       // post setting code here
-      [obj didChangeValueForKey: key];
+      [obj didChangeValueForKey: s->key];
     }
   else
     {
-      ffi_call(cif, (void*)imp, retp, args);
+      ffi_call(cif, (void*)s->imp, retp, args);
     }
-  RELEASE(key);
 }
 #endif
 
@@ -685,293 +876,244 @@ cifframe_callback(ffi_cif *cif, void *retp, void **args, void *user)
 @implementation	GSKVOSetter
 - (void) setter: (void*)val
 {
-  NSString	*key;
-  Class		c = [self class];
-  void		(*imp)(id,SEL,void*);
-
-  imp = (void (*)(id,SEL,void*))[c instanceMethodForSelector: _cmd];
+  GSKVOSetterInfo	*s = setterInfo(self, _cmd);
+  void			(*imp)(id,SEL,void*);
 
-  key = newKey(_cmd);
-  if ([c automaticallyNotifiesObserversForKey: key] == YES)
+  imp = (void (*)(id,SEL,void*))s->imp;
+  if (s->notify == YES)
     {
       // pre setting code here
-      [self willChangeValueForKey: key];
+      [self willChangeValueForKey: s->key];
       (*imp)(self, _cmd, val);
       // post setting code here
-      [self didChangeValueForKey: key];
+      [self didChangeValueForKey: s->key];
     }
   else
     {
       (*imp)(self, _cmd, val);
     }
-  RELEASE(key);
 }
 
 - (void) setterChar: (unsigned char)val
 {
-  NSString	*key;
-  Class		c = [self class];
-  void		(*imp)(id,SEL,unsigned char);
-
-  imp = (void (*)(id,SEL,unsigned char))[c instanceMethodForSelector: _cmd];
+  GSKVOSetterInfo	*s = setterInfo(self, _cmd);
+  void			(*imp)(id,SEL,unsigned char);
 
-  key = newKey(_cmd);
-  if ([c automaticallyNotifiesObserversForKey: key] == YES)
+  imp = (void (*)(id,SEL,unsigned char))s->imp;
+  if (s->notify == YES)
     {
       // pre setting code here
-      [self willChangeValueForKey: key];
+      [self willChangeValueForKey: s->key];
       (*imp)(self, _cmd, val);
       // post setting code here
-      [self didChangeValueForKey: key];
+      [self didChangeValueForKey: s->key];
     }
   else
     {
       (*imp)(self, _cmd, val);
     }
-  RELEASE(key);
 }
 
 - (void) setterDouble: (double)val
 {
-  NSString	*key;
-  Class		c = [self class];
-  void		(*imp)(id,SEL,double);
+  GSKVOSetterInfo	*s = setterInfo(self, _cmd);
+  void			(*imp)(id,SEL,double);
 
-  imp = (void (*)(id,SEL,double))[c instanceMethodForSelector: _cmd];
-
-  key = newKey(_cmd);
-  if ([c automaticallyNotifiesObserversForKey: key] == YES)
+  imp = (void (*)(id,SEL,double))s->imp;
+  if (s->notify == YES)
     {
       // pre setting code here
-      [self willChangeValueForKey: key];
+      [self willChangeValueForKey: s->key];
       (*imp)(self, _cmd, val);
       // post setting code here
-      [self didChangeValueForKey: key];
+      [self didChangeValueForKey: s->key];
     }
   else
     {
       (*imp)(self, _cmd, val);
     }
-  RELEASE(key);
 }
 
 - (void) setterFloat: (float)val
 {
-  NSString	*key;
-  Class		c = [self class];
-  void		(*imp)(id,SEL,float);
-
-  imp = (void (*)(id,SEL,float))[c instanceMethodForSelector: _cmd];
+  GSKVOSetterInfo	*s = setterInfo(self, _cmd);
+  void			(*imp)(id,SEL,float);
 
-  key = newKey(_cmd);
-  if ([c automaticallyNotifiesObserversForKey: key] == YES)
+  imp = (void (*)(id,SEL,float))s->imp;
+  if (s->notify == YES)
     {
       // pre setting code here
-      [self willChangeValueForKey: key];
+      [self willChangeValueForKey: s->key];
       (*imp)(self, _cmd, val);
       // post setting code here
-      [self didChangeValueForKey: key];
+      [self didChangeValueForKey: s->key];
     }
   else
     {
       (*imp)(self, _cmd, val);
     }
-  RELEASE(key);
 }
 
 - (void) setterInt: (unsigned int)val
 {
-  NSString	*key;
-  Class		c = [self class];
-  void		(*imp)(id,SEL,unsigned int);
-
-  imp = (void (*)(id,SEL,unsigned int))[c instanceMethodForSelector: _cmd];
+  GSKVOSetterInfo	*s = setterInfo(self, _cmd);
+  void			(*imp)(id,SEL,unsigned int);
 
-  key = newKey(_cmd);
-  if ([c automaticallyNotifiesObserversForKey: key] == YES)
+  imp = (void (*)(id,SEL,unsigned int))s->imp;
+  if (s->notify == YES)
     {
       // pre setting code here
-      [self willChangeValueForKey: key];
+      [self willChangeValueForKey: s->key];
       (*imp)(self, _cmd, val);
       // post setting code here
-      [self didChangeValueForKey: key];
+      [self didChangeValueForKey: s->key];
     }
   else
     {
       (*imp)(self, _cmd, val);
     }
-  RELEASE(key);
 }
 
 - (void) setterLong: (unsigned long)val
 {
-  NSString	*key;
-  Class		c = [self class];
-  void		(*imp)(id,SEL,unsigned long);
+  GSKVOSetterInfo	*s = setterInfo(self, _cmd);
+  void			(*imp)(id,SEL,unsigned long);
 
-  imp = (void (*)(id,SEL,unsigned long))[c instanceMethodForSelector: _cmd];
-
-  key = newKey(_cmd);
-  if ([c automaticallyNotifiesObserversForKey: key] == YES)
+  imp = (void (*)(id,SEL,unsigned long))s->imp;
+  if (s->notify == YES)
     {
       // pre setting code here
-      [self willChangeValueForKey: key];
+      [self willChangeValueForKey: s->key];
       (*imp)(self, _cmd, val);
       // post setting code here
-      [self didChangeValueForKey: key];
+      [self didChangeValueForKey: s->key];
     }
   else
     {
       (*imp)(self, _cmd, val);
     }
-  RELEASE(key);
 }
 
 #ifdef  _C_LNG_LNG
 - (void) setterLongLong: (unsigned long long)val
 {
-  NSString	*key;
-  Class		c = [self class];
-  void		(*imp)(id,SEL,unsigned long long);
+  GSKVOSetterInfo	*s = setterInfo(self, _cmd);
+  void			(*imp)(id,SEL,unsigned long long);
 
-  imp = (void (*)(id,SEL,unsigned long long))
-    [c instanceMethodForSelector: _cmd];
-
-  key = newKey(_cmd);
-  if ([c automaticallyNotifiesObserversForKey: key] == YES)
+  imp = (void (*)(id,SEL,unsigned long long))s->imp;
+  if (s->notify == YES)
     {
       // pre setting code here
-      [self willChangeValueForKey: key];
+      [self willChangeValueForKey: s->key];
       (*imp)(self, _cmd, val);
       // post setting code here
-      [self didChangeValueForKey: key];
+      [self didChangeValueForKey: s->key];
     }
   else
     {
       (*imp)(self, _cmd, val);
     }
-  RELEASE(key);
 }
 #endif
 
 - (void) setterShort: (unsigned short)val
 {
-  NSString	*key;
-  Class		c = [self class];
-  void		(*imp)(id,SEL,unsigned short);
-
-  imp = (void (*)(id,SEL,unsigned short))[c instanceMethodForSelector: _cmd];
+  GSKVOSetterInfo	*s = setterInfo(self, _cmd);
+  void			(*imp)(id,SEL,unsigned short);
 
-  key = newKey(_cmd);
-  if ([c automaticallyNotifiesObserversForKey: key] == YES)
+  imp = (void (*)(id,SEL,unsigned short))s->imp;
+  if (s->notify == YES)
     {
       // pre setting code here
-      [self willChangeValueForKey: key];
+      [self willChangeValueForKey: s->key];
       (*imp)(self, _cmd, val);
       // post setting code here
-      [self didChangeValueForKey: key];
+      [self didChangeValueForKey: s->key];
     }
   else
     {
       (*imp)(self, _cmd, val);
     }
-  RELEASE(key);
 }
 
 - (void) setterRange: (NSRange)val
 {
-  NSString  *key;
-  Class     c = [self class];
-  void      (*imp)(id,SEL,NSRange);
+  GSKVOSetterInfo	*s = setterInfo(self, _cmd);
+  void			(*imp)(id,SEL,NSRange);
 
-  imp = (void (*)(id,SEL,NSRange))[c instanceMethodForSelector: _cmd];
-
-  key = newKey(_cmd);
-  if ([c automaticallyNotifiesObserversForKey: key] == YES)
+  imp = (void (*)(id,SEL,NSRange))s->imp;
+  if (s->notify == YES)
     {
       // pre setting code here
-      [self willChangeValueForKey: key];
+      [self willChangeValueForKey: s->key];
       (*imp)(self, _cmd, val);
       // post setting code here
-      [self didChangeValueForKey: key];
+      [self didChangeValueForKey: s->key];
     }
   else
     {
       (*imp)(self, _cmd, val);
     }
-  RELEASE(key);
 }
 
 - (void) setterPoint: (NSPoint)val
 {
-  NSString  *key;
-  Class     c = [self class];
-  void      (*imp)(id,SEL,NSPoint);
-
-  imp = (void (*)(id,SEL,NSPoint))[c instanceMethodForSelector: _cmd];
+  GSKVOSetterInfo	*s = setterInfo(self, _cmd);
+  void			(*imp)(id,SEL,NSPoint);
 
-  key = newKey(_cmd);
-  if ([c automaticallyNotifiesObserversForKey: key] == YES)
+  imp = (void (*)(id,SEL,NSPoint))s->imp;
+  if (s->notify == YES)
     {
       // pre setting code here
-      [self willChangeValueForKey: key];
+      [self willChangeValueForKey: s->key];
       (*imp)(self, _cmd, val);
       // post setting code here
-      [self didChangeValueForKey: key];
+      [self didChangeValueForKey: s->key];
     }
   else
     {
       (*imp)(self, _cmd, val);
     }
-  RELEASE(key);
 }
 
 - (void) setterSize: (NSSize)val
 {
-  NSString  *key;
-  Class     c = [self class];
-  void      (*imp)(id,SEL,NSSize);
-
-  imp = (void (*)(id,SEL,NSSize))[c instanceMethodForSelector: _cmd];
+  GSKVOSetterInfo	*s = setterInfo(self, _cmd);
+  void			(*imp)(id,SEL,NSSize);
 
-  key = newKey(_cmd);
-  if ([c automaticallyNotifiesObserversForKey: key] == YES)
+  imp = (void (*)(id,SEL,NSSize))s->imp;
+  if (s->notify == YES)
     {
       // pre setting code here
-      [self willChangeValueForKey: key];
+      [self willChangeValueForKey: s->key];
       (*imp)(self, _cmd, val);
       // post setting code here
-      [self didChangeValueForKey: key];
+      [self didChangeValueForKey: s->key];
     }
   else
     {
       (*imp)(self, _cmd, val);
     }
-  RELEASE(key);
 }
 
 - (void) setterRect: (NSRect)val
 {
-  NSString  *key;
-  Class     c = [self class];
-  void      (*imp)(id,SEL,NSRect);
+  GSKVOSetterInfo	*s = setterInfo(self, _cmd);
+  void			(*imp)(id,SEL,NSRect);
 
-  imp = (void (*)(id,SEL,NSRect))[c instanceMethodForSelector: _cmd];
-
-  key = newKey(_cmd);
-  if ([c automaticallyNotifiesObserversForKey: key] == YES)
+  imp = (void (*)(id,SEL,NSRect))s->imp;
+  if (s->notify == YES)
     {
       // pre setting code here
-      [self willChangeValueForKey: key];
+      [self willChangeValueForKey: s->key];
       (*imp)(self, _cmd, val);
       // post setting code here
-      [self didChangeValueForKey: key];
+      [self didChangeValueForKey: s->key];
     }
   else
     {
       (*imp)(self, _cmd, val);
     }
-  RELEASE(key);
 }
 @end
 
@@ -1689,7 +1831,7 @@ cifframe_callback(ffi_cif *cif, void *retp, void **args, void *user)
   GSKVOPathInfo *pathInfo;
   GSKVOInfo     *info;
 
-  info = (GSKVOInfo *)[self observationInfo];
+  info = retainedInfo(self);
   if (info == nil)
     {
       return;
@@ -1733,6 +1875,7 @@ cifframe_callback(ffi_cif *cif, void *retp, void **args, void *user)
         }
       [info unlock];
     }
+  RELEASE(info);
 
   [self willChangeValueForDependentsOfKey: aKey];
 }
@@ -1742,7 +1885,7 @@ cifframe_callback(ffi_cif *cif, void *retp, void **args, void *user)
   GSKVOPathInfo *pathInfo;
   GSKVOInfo	*info;
 
-  info = (GSKVOInfo *)[self observationInfo];
+  info = retainedInfo(self);
   if (info == nil)
     {
       return;
@@ -1772,6 +1915,7 @@ cifframe_callback(ffi_cif *cif, void *retp, void **args, void *user)
         }
       [info unlock];
     }
+  RELEASE(info);
 
   [self didChangeValueForDependentsOfKey: aKey];
 }
@@ -1783,7 +1927,7 @@ cifframe_callback(ffi_cif *cif, void *retp, void **args, void *user)
   GSKVOPathInfo *pathInfo;
   GSKVOInfo	*info;
 
-  info = [self observationInfo];
+  info = retainedInfo(self);
   if (info == nil)
     {
       return;
@@ -1816,6 +1960,7 @@ cifframe_callback(ffi_cif *cif, void *retp, void **args, void *user)
         }
       [info unlock];
     }
+  RELEASE(info);
 
   [self didChangeValueForDependentsOfKey: aKey];
 }
@@ -1827,7 +1972,7 @@ cifframe_callback(ffi_cif *cif, void *retp, void **args, void *user)
   GSKVOPathInfo *pathInfo;
   GSKVOInfo	*info;
 
-  info = [self observationInfo];
+  info = retainedInfo(self);
   if (info == nil)
     {
       return;
@@ -1853,6 +1998,7 @@ cifframe_callback(ffi_cif *cif, void *retp, void **args, void *user)
         }
       [info unlock];
     }
+  RELEASE(info);
 
   [self willChangeValueForDependentsOfKey: aKey];
 }
@@ -1864,7 +2010,7 @@ cifframe_callback(ffi_cif *cif, void *retp, void **args, void *user)
   GSKVOPathInfo *pathInfo;
   GSKVOInfo	*info;
 
-  info = [self observationInfo];
+  info = retainedInfo(self);
   if (info == nil)
     {
       return;
@@ -1886,6 +2032,7 @@ cifframe_callback(ffi_cif *cif, void *retp, void **args, void *user)
         }
       [info unlock];
     }
+  RELEASE(info);
 
   [self willChangeValueForDependentsOfKey: aKey];
 }
@@ -1897,7 +2044,7 @@ cifframe_callback(ffi_cif *cif, void *retp, void **args, void *user)
   GSKVOPathInfo *pathInfo;
   GSKVOInfo	*info;
 
-  info = [self observationInfo];
+  info = retainedInfo(self);
   if (info == nil)
     {
       return;
@@ -1964,6 +2111,7 @@ cifframe_callback(ffi_cif *cif, void *retp, void **args, void *user)
         }
       [info unlock];
     }
+  RELEASE(info);
   [self didChangeValueForDependentsOfKey: aKey];
 }
 
@@ -2007,29 +2155,34 @@ triggerChangeNotificationsForDependentKey: (NSString*)dependentKey
 
 - (void*) observationInfo
 {
-  void	*info;
+  GSKVOInfoStripe	*s;
+  void			*info;
 
   setup();
-  [kvoLock lock];
-  info = NSMapGet(infoTable, (void*)self);
+  s = stripeFor(self);
+  pthread_mutex_lock(&s->lock);
+  info = NSMapGet(s->table, (void*)self);
   IF_NO_GC(AUTORELEASE(RETAIN((id)info));)
-  [kvoLock unlock];
+  pthread_mutex_unlock(&s->lock);
   return info;
 }
 
 - (void) setObservationInfo: (void*)observationInfo
 {
+  GSKVOInfoStripe	*s;
+
   setup();
-  [kvoLock lock];
+  s = stripeFor(self);
+  pthread_mutex_lock(&s->lock);
   if (observationInfo == 0)
     {
-      NSMapRemove(infoTable, (void*)self);
+      NSMapRemove(s->table, (void*)self);
     }
   else
     {
-      NSMapInsert(infoTable, (void*)self, observationInfo);
+      NSMapInsert(s->table, (void*)self, observationInfo);
     }
-  [kvoLock unlock];
+  pthread_mutex_unlock(&s->lock);
 }
 
 @end
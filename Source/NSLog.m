@@ -222,6 +222,466 @@ _NSLog_standard_printf_handler (NSString* message)
 #endif // __MINGW__
 }
 
+/* Asynchronous logging.
+ * When the GSLogAsynchronous user default is set (and messages are going
+ * to the standard handler rather than to syslog), NSLogv() does not write
+ * to _NSLogDescriptor itself.  Instead each logging thread copies the
+ * message bytes into its own single-producer/single-consumer ring buffer
+ * without taking any lock, and a background flusher thread gathers the
+ * queued messages from all the rings and writes them with writev().
+ * Each slot in a ring holds a short message inline, so only a message
+ * too long for a slot needs memory to be allocated.
+ * If a ring is full the logging thread waits briefly for the flusher to
+ * catch up, and then drops the message (counting it) rather than
+ * blocking indefinitely.
+ * GSLogFlush() writes out everything that has been queued, from the
+ * calling thread, and is called when the process exits or terminates
+ * because of an uncaught exception, so that crash logs are not lost.
+ * On those paths the lock is only tried for a short time (it may be held
+ * by a thread which will never release it), and if it can't be taken the
+ * queued messages are written without it.
+ * After a fork() the child discards the messages queued by other threads
+ * (which the parent writes) and starts its own flusher when it next logs.
+ */
+#if	!defined(__MINGW__) && (defined(__llvm__) || defined(USE_ATOMIC_BUILTINS))
+#define	GS_ASYNC_LOG	1
+#endif
+
+#if	defined(GS_ASYNC_LOG)
+
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <limits.h>
+
+#define	LOG_RING_SIZE	256	/* Messages queued per thread.		*/
+#define	LOG_SLOT_SIZE	240	/* Bytes of a message held inline.	*/
+#define	LOG_BATCH_SIZE	64	/* Maximum messages per writev().	*/
+#define	LOG_FLUSH_MS	10	/* Flusher wakes at least this often.	*/
+#define	LOG_WAIT_MS	10	/* Wait when a ring is full, then drop.	*/
+#define	LOG_EXIT_MS	100	/* Wait for the lock when exiting.	*/
+
+#if	defined(IOV_MAX) && IOV_MAX < LOG_BATCH_SIZE
+#undef	LOG_BATCH_SIZE
+#define	LOG_BATCH_SIZE	IOV_MAX
+#endif
+
+/* A message longer than LOG_SLOT_SIZE is held in 'heap', which is only
+ * freed when the slot is reused (or the ring is freed), so a slot between
+ * the tail and head of a ring can always be read safely.
+ */
+typedef struct GSLogEntry {
+  unsigned	length;
+  char		*heap;
+  char		bytes[LOG_SLOT_SIZE];
+} GSLogEntry;
+
+typedef struct GSLogRing {
+  struct GSLogRing	*next;		/* List of all rings.		*/
+  volatile unsigned	head;		/* Written only by producer.	*/
+  volatile unsigned	tail;		/* Written only by consumer.	*/
+  volatile BOOL		orphaned;	/* Owning thread has exited.	*/
+  GSLogEntry		entries[LOG_RING_SIZE];
+} GSLogRing;
+
+static pthread_mutex_t	asyncLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	asyncCond = PTHREAD_COND_INITIALIZER;
+static pthread_once_t	asyncOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t	asyncKey;
+static GSLogRing	*asyncRings = 0;
+static volatile BOOL	asyncNeedFlusher = NO;
+
+static volatile NSUInteger	asyncQueued = 0;
+static volatile NSUInteger	asyncWritten = 0;
+static volatile NSUInteger	asyncDelayed = 0;
+static volatile NSUInteger	asyncDropped = 0;
+
+/* Called when a logging thread exits ... the flusher releases the ring
+ * once everything in it has been written.
+ */
+static void
+asyncRingOrphan(void *r)
+{
+  ((GSLogRing*)r)->orphaned = YES;
+}
+
+static void
+asyncRingFree(GSLogRing *r)
+{
+  unsigned	i;
+
+  for (i = 0; i < LOG_RING_SIZE; i++)
+    {
+      free(r->entries[i].heap);
+    }
+  free(r);
+}
+
+/* Write the entries to the log descriptor, falling back to syslog
+ * (where available) for any which could not be written.
+ */
+static void
+asyncWrite(GSLogEntry **entries, int count)
+{
+  struct iovec	iov[LOG_BATCH_SIZE];
+  struct iovec	*v = iov;
+  int		n = count;
+  int		i;
+
+  for (i = 0; i < count; i++)
+    {
+      GSLogEntry	*e = entries[i];
+
+      iov[i].iov_base = (e->heap == 0) ? e->bytes : e->heap;
+      iov[i].iov_len = e->length;
+    }
+  while (n > 0)
+    {
+      ssize_t	w = writev(_NSLogDescriptor, v, n);
+
+      if (w < 0)
+	{
+	  if (errno == EINTR)
+	    {
+	      continue;
+	    }
+	  break;
+	}
+      /* Skip past whatever was written, allowing for partial writes.
+       */
+      while (n > 0 && (size_t)w >= v->iov_len)
+	{
+	  w -= v->iov_len;
+	  v++;
+	  n--;
+	}
+      if (n > 0)
+	{
+	  v->iov_base = (char*)v->iov_base + w;
+	  v->iov_len -= w;
+	}
+    }
+#if	defined(HAVE_SYSLOG)
+  while (n-- > 0)
+    {
+      syslog(SYSLOGMASK, "%.*s", (int)v->iov_len, (char*)v->iov_base);
+      v++;
+    }
+#endif
+  __sync_fetch_and_add(&asyncWritten, count);
+}
+
+/* Gather and write everything currently queued in all rings.
+ * Must be called with asyncLock held, unless 'locked' is NO, in which
+ * case the rings are written but not changed (used when exiting).
+ */
+static void
+asyncDrain(BOOL locked)
+{
+  GSLogRing	**rp = &asyncRings;
+  GSLogRing	*r;
+
+  while ((r = *rp) != 0)
+    {
+      unsigned	head = r->head;
+      unsigned	tail = r->tail;
+
+      __sync_synchronize();
+      while (tail != head)
+	{
+	  GSLogEntry	*batch[LOG_BATCH_SIZE];
+	  int		count = 0;
+
+	  while (tail != head && count < LOG_BATCH_SIZE)
+	    {
+	      batch[count++] = &r->entries[tail % LOG_RING_SIZE];
+	      tail++;
+	    }
+	  asyncWrite(batch, count);
+	  if (locked == YES)
+	    {
+	      __sync_synchronize();
+	      r->tail = tail;
+	    }
+	}
+      if (locked == YES && r->orphaned == YES && r->head == r->tail)
+	{
+	  *rp = r->next;
+	  asyncRingFree(r);
+	}
+      else
+	{
+	  rp = &r->next;
+	}
+    }
+}
+
+static void *
+asyncFlusher(void *arg)
+{
+  pthread_mutex_lock(&asyncLock);
+  for (;;)
+    {
+      struct timeval	now;
+      struct timespec	until;
+
+      asyncDrain(YES);
+      gettimeofday(&now, 0);
+      until.tv_sec = now.tv_sec;
+      until.tv_nsec = (now.tv_usec + LOG_FLUSH_MS * 1000) * 1000;
+      if (until.tv_nsec >= 1000000000)
+	{
+	  until.tv_sec++;
+	  until.tv_nsec -= 1000000000;
+	}
+      pthread_cond_timedwait(&asyncCond, &asyncLock, &until);
+    }
+  return 0;
+}
+
+static void
+asyncStartFlusher()
+{
+  pthread_t	t;
+  pthread_attr_t	attr;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  pthread_create(&t, &attr, asyncFlusher, 0);
+  pthread_attr_destroy(&attr);
+}
+
+/* Before a fork() we write out everything queued and hold the lock, so
+ * that the child gets the lock and the rings in a consistent state.
+ */
+static void
+asyncForkPrepare()
+{
+  pthread_mutex_lock(&asyncLock);
+  asyncDrain(YES);
+}
+
+static void
+asyncForkParent()
+{
+  pthread_mutex_unlock(&asyncLock);
+}
+
+/* The child has only the thread which called fork(), so the flusher is
+ * gone and the rings of all other threads are orphaned.  Anything they
+ * queued since the drain is written by the parent, so it is discarded.
+ */
+static void
+asyncForkChild()
+{
+  GSLogRing	*mine = (GSLogRing*)pthread_getspecific(asyncKey);
+  GSLogRing	*r;
+
+  pthread_mutex_init(&asyncLock, 0);
+  pthread_cond_init(&asyncCond, 0);
+  for (r = asyncRings; r != 0; r = r->next)
+    {
+      if (r != mine)
+	{
+	  r->orphaned = YES;
+	  r->tail = r->head;
+	}
+    }
+  asyncNeedFlusher = YES;
+}
+
+static void
+asyncSetup()
+{
+  pthread_key_create(&asyncKey, asyncRingOrphan);
+  pthread_atfork(asyncForkPrepare, asyncForkParent, asyncForkChild);
+  asyncStartFlusher();
+  atexit(GSPrivateLogFlushAtExit);
+}
+
+/* Queue a message for the flusher thread.
+ */
+static void
+asyncLog(NSString *message)
+{
+  static NSStringEncoding	enc = 0;
+  GSLogRing			*r;
+  GSLogEntry			*e;
+  NSUInteger			len;
+  NSRange			left;
+  unsigned			head;
+
+  if (enc == 0)
+    {
+      enc = [NSString defaultCStringEncoding];
+    }
+  pthread_once(&asyncOnce, asyncSetup);
+  if (asyncNeedFlusher == YES)
+    {
+      pthread_mutex_lock(&asyncLock);
+      if (asyncNeedFlusher == YES)
+	{
+	  asyncNeedFlusher = NO;
+	  asyncStartFlusher();
+	}
+      pthread_mutex_unlock(&asyncLock);
+    }
+  r = (GSLogRing*)pthread_getspecific(asyncKey);
+  if (r == 0)
+    {
+      r = (GSLogRing*)calloc(1, sizeof(GSLogRing));
+      if (r == 0)
+	{
+	  __sync_fetch_and_add(&asyncDropped, 1);
+	  return;
+	}
+      pthread_setspecific(asyncKey, r);
+      pthread_mutex_lock(&asyncLock);
+      r->next = asyncRings;
+      asyncRings = r;
+      pthread_mutex_unlock(&asyncLock);
+    }
+
+  head = r->head;
+  if (head - r->tail >= LOG_RING_SIZE)
+    {
+      unsigned	waited = 0;
+
+      /* The ring is full ... apply back pressure by waiting for the
+       * flusher for a limited time, then drop the message.
+       */
+      __sync_fetch_and_add(&asyncDelayed, 1);
+      while (head - r->tail >= LOG_RING_SIZE)
+	{
+	  if (waited++ >= LOG_WAIT_MS)
+	    {
+	      __sync_fetch_and_add(&asyncDropped, 1);
+	      return;
+	    }
+	  pthread_cond_signal(&asyncCond);
+	  usleep(1000);
+	}
+    }
+
+  /* The slot is ours until head is advanced, so we can encode the
+   * message straight into it, or into heap memory if it is too long
+   * (or can't be represented in the default encoding).
+   */
+  e = &r->entries[head % LOG_RING_SIZE];
+  if (e->heap != 0)
+    {
+      free(e->heap);
+      e->heap = 0;
+    }
+  [message getBytes: e->bytes
+	  maxLength: LOG_SLOT_SIZE
+	 usedLength: &len
+	   encoding: enc
+	    options: 0
+	      range: NSMakeRange(0, [message length])
+     remainingRange: &left];
+  if (left.length > 0)
+    {
+      NSData	*d;
+
+      d = [message dataUsingEncoding: enc allowLossyConversion: NO];
+      if (d == nil)
+	{
+	  d = [message dataUsingEncoding: NSUTF8StringEncoding
+		    allowLossyConversion: YES];
+	}
+      len = [d length];
+      e->heap = (char*)malloc(len);
+      if (e->heap == 0)
+	{
+	  __sync_fetch_and_add(&asyncDropped, 1);
+	  return;
+	}
+      memcpy(e->heap, [d bytes], len);
+    }
+  e->length = len;
+  __sync_synchronize();
+  r->head = head + 1;
+  __sync_fetch_and_add(&asyncQueued, 1);
+
+  /* Wake the flusher early if the ring is filling up.
+   */
+  if (head - r->tail == LOG_RING_SIZE / 2)
+    {
+      pthread_cond_signal(&asyncCond);
+    }
+}
+
+#endif	/* GS_ASYNC_LOG */
+
+/**
+ * Writes out any messages which have been queued by NSLogv() for
+ * asynchronous logging (see the GSLogAsynchronous user default),
+ * returning once they have all been written.<br />
+ * Queued messages are also written automatically when the process
+ * exits or is terminated by an uncaught exception.
+ */
+void
+GSLogFlush()
+{
+#if	defined(GS_ASYNC_LOG)
+  pthread_mutex_lock(&asyncLock);
+  asyncDrain(YES);
+  pthread_mutex_unlock(&asyncLock);
+#endif
+}
+
+/* Like GSLogFlush(), but for use when the process is exiting or has
+ * crashed, so it must not block for ever on a lock which may never be
+ * released.  If the lock can't be had, the queued messages are written
+ * directly (some may then be written twice, but none is lost).
+ */
+void
+GSPrivateLogFlushAtExit()
+{
+#if	defined(GS_ASYNC_LOG)
+  unsigned	waited = 0;
+
+  while (pthread_mutex_trylock(&asyncLock) != 0)
+    {
+      if (waited++ >= LOG_EXIT_MS)
+	{
+	  asyncDrain(NO);
+	  return;
+	}
+      usleep(1000);
+    }
+  asyncDrain(YES);
+  pthread_mutex_unlock(&asyncLock);
+#endif
+}
+
+/**
+ * Returns counters for messages logged asynchronously by NSLogv().
+ * The number of messages queued and written, the number of times a
+ * logging thread had to wait because its queue was full, and the
+ * number of messages dropped because the flusher did not catch up
+ * in time.<br />
+ * Any of the arguments may be NULL if you are not interested in
+ * the corresponding counter.
+ */
+void
+GSLogCounters(NSUInteger *queued, NSUInteger *written,
+  NSUInteger *delayed, NSUInteger *dropped)
+{
+#if	defined(GS_ASYNC_LOG)
+  if (queued) *queued = asyncQueued;
+  if (written) *written = asyncWritten;
+  if (delayed) *delayed = asyncDelayed;
+  if (dropped) *dropped = asyncDropped;
+#else
+  if (queued) *queued = 0;
+  if (written) *written = 0;
+  if (delayed) *delayed = 0;
+  if (dropped) *dropped = 0;
+#endif
+}
+
 /**
  * A pointer to a function used to actually write the log data.
  * <p>
@@ -313,6 +773,15 @@ NSLog (NSString* format, ...)
  *   The function to write the data is pointed to by
  *   <ref type="variable" id="_NSLog_printf_handler">_NSLog_printf_handler</ref>
  * </p>
+ * <p>
+ *   In GNUstep, the GSLogAsynchronous user default may be set to YES
+ *   in order to have messages which would be written by the standard
+ *   handler queued and written by a background thread instead, so that
+ *   logging threads do not wait for the output or for each other.
+ *   Messages from any one thread stay in order, but messages from
+ *   different threads may be interleaved differently than they would
+ *   be with synchronous logging.  See GSLogFlush() and GSLogCounters().
+ * </p>
  */
 void
 NSLogv (NSString* format, va_list args)
@@ -386,6 +855,17 @@ NSLogv (NSString* format, va_list args)
       GSLogLock();
     }
 
+#if	defined(GS_ASYNC_LOG)
+  if (_NSLog_printf_handler == _NSLog_standard_printf_handler
+    && GSPrivateDefaultsFlag(GSLogAsynchronous) == YES
+    && GSPrivateDefaultsFlag(GSLogSyslog) == NO)
+    {
+      asyncLog(prefix);
+      [arp drain];
+      return;
+    }
+#endif
+
   [myLock lock];
 
   _NSLog_printf_handler(prefix);
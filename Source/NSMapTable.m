@@ -273,3 +273,17 @@ static Class	concreteClass = 0;
 }
 @end
 
+@implementation	NSMapTable (GNUstep)
+
+/**
+ * Returns the same counters as [NSHashTable-getPurged:sweeps:], for
+ * entries removed because a weak key or value had been zeroed.
+ */
+- (void) getPurged: (NSUInteger*)purged sweeps: (NSUInteger*)sweeps
+{
+  if (purged) *purged = 0;
+  if (sweeps) *sweeps = 0;
+}
+
+@end
+
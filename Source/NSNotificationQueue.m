@@ -35,6 +35,8 @@
 #import "Foundation/NSNotification.h"
 #import "Foundation/NSDictionary.h"
 #import "Foundation/NSArray.h"
+#import "Foundation/NSAutoreleasePool.h"
+#import "Foundation/NSMapTable.h"
 #import "Foundation/NSThread.h"
 
 #import "GSPrivate.h"
@@ -164,6 +166,10 @@ typedef struct _NSNotificationQueueRegistration
 {
   struct _NSNotificationQueueRegistration	*next;
   struct _NSNotificationQueueRegistration	*prev;
+  struct _NSNotificationQueueRegistration	*nextSame;
+  struct _NSNotificationQueueRegistration	*prevSame;
+  struct _NSNotificationQueueRegistration	*nextObject;
+  struct _NSNotificationQueueRegistration	*prevObject;
   NSNotification				*notification;
   id						name;
   id						object;
@@ -172,10 +178,25 @@ typedef struct _NSNotificationQueueRegistration
 
 struct _NSNotificationQueueList;
 
+/* As well as the list of items in the order they were queued, each
+ * queue indexes its items so that coalescing does not need to search
+ * the whole queue:
+ *   named maps each name to a table mapping each object to the first
+ *   of the items with that name and object (linked by nextSame).
+ *   objects maps each object to the first of the items with that
+ *   object (linked by nextObject).
+ * Items whose notification has a nil name are never coalesced on name
+ * (as nil is not equal to anything) so they only appear in objects.
+ */
 typedef struct _NSNotificationQueueList
 {
   struct _NSNotificationQueueRegistration	*head;
   struct _NSNotificationQueueRegistration	*tail;
+  NSMapTable					*named;
+  NSMapTable					*objects;
+  NSUInteger					enqueued;
+  NSUInteger					coalesced;
+  NSUInteger					posted;
 } NSNotificationQueueList;
 
 /*
@@ -187,6 +208,97 @@ typedef struct _NSNotificationQueueList
  *    tail --------------------------------------------->
  */
 
+static inline void
+remove_from_index(NSNotificationQueueList *queue,
+  NSNotificationQueueRegistration *item)
+{
+  if (item->prevObject != 0)
+    {
+      item->prevObject->nextObject = item->nextObject;
+    }
+  else if (item->nextObject != 0)
+    {
+      NSMapInsert(queue->objects, item->object, item->nextObject);
+    }
+  else
+    {
+      NSMapRemove(queue->objects, item->object);
+    }
+  if (item->nextObject != 0)
+    {
+      item->nextObject->prevObject = item->prevObject;
+    }
+
+  if (item->name != nil)
+    {
+      if (item->prevSame != 0)
+	{
+	  item->prevSame->nextSame = item->nextSame;
+	}
+      else
+	{
+	  NSMapTable	*m = (NSMapTable*)NSMapGet(queue->named, item->name);
+
+	  if (item->nextSame != 0)
+	    {
+	      NSMapInsert(m, item->object, item->nextSame);
+	    }
+	  else
+	    {
+	      NSMapRemove(m, item->object);
+	      if (NSCountMapTable(m) == 0)
+		{
+		  NSMapRemove(queue->named, item->name);
+		}
+	    }
+	}
+      if (item->nextSame != 0)
+	{
+	  item->nextSame->prevSame = item->prevSame;
+	}
+    }
+}
+
+static inline void
+add_to_index(NSNotificationQueueList *queue,
+  NSNotificationQueueRegistration *item)
+{
+  NSNotificationQueueRegistration	*first;
+
+  first = (NSNotificationQueueRegistration*)NSMapGet(queue->objects,
+    item->object);
+  item->nextObject = first;
+  if (first != 0)
+    {
+      first->prevObject = item;
+    }
+  NSMapInsert(queue->objects, item->object, item);
+
+  if (item->name != nil)
+    {
+      NSMapTable	*m = (NSMapTable*)NSMapGet(queue->named, item->name);
+
+      if (m == 0)
+	{
+	  m = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
+	    NSNonOwnedPointerMapValueCallBacks, 4);
+	  NSMapInsert(queue->named, item->name, m);
+	  NSFreeMapTable(m);	/* Retained in named table.	*/
+	  first = 0;
+	}
+      else
+	{
+	  first = (NSNotificationQueueRegistration*)NSMapGet(m, item->object);
+	}
+      item->nextSame = first;
+      if (first != 0)
+	{
+	  first->prevSame = item;
+	}
+      NSMapInsert(m, item->object, item);
+    }
+}
+
 static inline void
 remove_from_queue_no_release(NSNotificationQueueList *queue,
   NSNotificationQueueRegistration *item)
@@ -210,6 +322,7 @@ remove_from_queue_no_release(NSNotificationQueueList *queue,
       NSCAssert(queue->head == item, @"head item not at head of queue!");
       queue->head = item->next;
     }
+  remove_from_index(queue, item);
 }
 
 static void
@@ -256,9 +369,114 @@ add_to_queue(NSNotificationQueueList *queue, NSNotification *notification,
     {
       queue->head = item;
     }
+  add_to_index(queue, item);
+  queue->enqueued++;
+}
+
+static NSNotificationQueueList *
+new_queue(NSZone *_zone)
+{
+  NSNotificationQueueList	*queue;
+
+#if	GS_WITH_GC
+  queue = NSAllocateCollectable(sizeof(NSNotificationQueueList),
+    NSScannedOption);
+#else
+  queue = NSZoneCalloc(_zone, 1, sizeof(NSNotificationQueueList));
+#endif
+  if (queue != 0)
+    {
+      queue->named = NSCreateMapTable(NSObjectMapKeyCallBacks,
+	NSObjectMapValueCallBacks, 16);
+      queue->objects = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
+	NSNonOwnedPointerMapValueCallBacks, 16);
+    }
+  return queue;
+}
+
+static void
+free_queue(NSNotificationQueueList *queue, NSZone *_zone)
+{
+  NSNotificationQueueRegistration	*item;
+
+  if (queue != 0)
+    {
+      while ((item = queue->head) != 0)
+	{
+	  remove_from_queue(queue, item, _zone);
+	}
+      NSFreeMapTable(queue->named);
+      NSFreeMapTable(queue->objects);
+      NSZoneFree(_zone, queue);
+    }
+}
+
+/* Removes (without posting) the queued items matching name and/or
+ * object as specified by coalesceMask.
+ */
+static void
+coalesce(NSNotificationQueueList *queue, id name, id object,
+  NSUInteger coalesceMask, NSZone *_zone)
+{
+  NSNotificationQueueRegistration	*item;
+  NSNotificationQueueRegistration	*next;
+  NSMapTable				*m;
+
+  if ((coalesceMask & NSNotificationCoalescingOnName)
+    && (coalesceMask & NSNotificationCoalescingOnSender))
+    {
+      //PENDING: should object comparison be '==' instead of isEqual?!
+      if (name != nil
+	&& (m = (NSMapTable*)NSMapGet(queue->named, name)) != 0)
+	{
+	  item = (NSNotificationQueueRegistration*)NSMapGet(m, object);
+	  while (item != 0)
+	    {
+	      next = item->nextSame;
+	      remove_from_queue(queue, item, _zone);
+	      queue->coalesced++;
+	      item = next;
+	    }
+	}
+    }
+  else if ((coalesceMask & NSNotificationCoalescingOnName))
+    {
+      /* Remove the items for each object in turn, fetching the table
+       * again each time as it is freed when its last item goes.
+       */
+      while (name != nil
+	&& (m = (NSMapTable*)NSMapGet(queue->named, name)) != 0)
+	{
+	  NSMapEnumerator	e = NSEnumerateMapTable(m);
+	  void			*k;
+
+	  item = 0;
+	  NSNextMapEnumeratorPair(&e, &k, (void**)&item);
+	  NSEndMapTableEnumeration(&e);
+	  while (item != 0)
+	    {
+	      next = item->nextSame;
+	      remove_from_queue(queue, item, _zone);
+	      queue->coalesced++;
+	      item = next;
+	    }
+	}
+    }
+  else if ((coalesceMask & NSNotificationCoalescingOnSender))
+    {
+      item = (NSNotificationQueueRegistration*)NSMapGet(queue->objects,
+	object);
+      while (item != 0)
+	{
+	  next = item->nextObject;
+	  remove_from_queue(queue, item, _zone);
+	  queue->coalesced++;
+	  item = next;
+	}
+    }
 }
 
-
+
 
 /*
  * NSNotificationQueue class implementation
@@ -335,15 +553,8 @@ static NSArray	*defaultMode = nil;
 
   // init queue
   _center = RETAIN(notificationCenter);
-#if	GS_WITH_GC
-  _asapQueue = NSAllocateCollectable(sizeof(NSNotificationQueueList),
-    NSScannedOption);
-  _idleQueue = NSAllocateCollectable(sizeof(NSNotificationQueueList),
-    NSScannedOption);
-#else
-  _asapQueue = NSZoneCalloc(_zone, 1, sizeof(NSNotificationQueueList));
-  _idleQueue = NSZoneCalloc(_zone, 1, sizeof(NSNotificationQueueList));
-#endif
+  _asapQueue = new_queue(_zone);
+  _idleQueue = new_queue(_zone);
   if (_asapQueue == 0 || _idleQueue == 0)
     {
       DESTROY(self);
@@ -360,8 +571,6 @@ static NSArray	*defaultMode = nil;
 
 - (void) dealloc
 {
-  NSNotificationQueueRegistration	*item;
-
   /*
    * remove from class instances list
    */
@@ -370,17 +579,8 @@ static NSArray	*defaultMode = nil;
   /*
    * release items from our queues
    */
-  while ((item = _asapQueue->head) != 0)
-    {
-      remove_from_queue(_asapQueue, item, _zone);
-    }
-  NSZoneFree(_zone, _asapQueue);
-
-  while ((item = _idleQueue->head) != 0)
-    {
-      remove_from_queue(_idleQueue, item, _zone);
-    }
-  NSZoneFree(_zone, _idleQueue);
+  free_queue(_asapQueue, _zone);
+  free_queue(_idleQueue, _zone);
 
   RELEASE(_center);
   [super dealloc];
@@ -402,88 +602,11 @@ static NSArray	*defaultMode = nil;
 - (void) dequeueNotificationsMatching: (NSNotification*)notification
 			 coalesceMask: (NSUInteger)coalesceMask
 {
-  NSNotificationQueueRegistration	*item;
-  NSNotificationQueueRegistration	*prev;
-  id					name   = [notification name];
-  id					object = [notification object];
+  id	name   = [notification name];
+  id	object = [notification object];
 
-  if ((coalesceMask & NSNotificationCoalescingOnName)
-    && (coalesceMask & NSNotificationCoalescingOnSender))
-    {
-      /*
-       * find in ASAP notification in queue matching both
-       */
-      for (item = _asapQueue->tail; item; item = prev)
-	{
-          prev = item->prev;
-          //PENDING: should object comparison be '==' instead of isEqual?!
-          if ((object == item->object) && [name isEqual: item->name])
-	    {
-              remove_from_queue(_asapQueue, item, _zone);
-	    }
-	}
-      /*
-       * find in idle notification in queue matching both
-       */
-      for (item = _idleQueue->tail; item; item = prev)
-	{
-          prev = item->prev;
-          if ((object == item->object) && [name isEqual: item->name])
-	    {
-              remove_from_queue(_idleQueue, item, _zone);
-	    }
-	}
-    }
-  else if ((coalesceMask & NSNotificationCoalescingOnName))
-    {
-      /*
-       * find in ASAP notification in queue matching name
-       */
-      for (item = _asapQueue->tail; item; item = prev)
-	{
-          prev = item->prev;
-          if ([name isEqual: item->name])
-	    {
-              remove_from_queue(_asapQueue, item, _zone);
-	    }
-	}
-      /*
-       * find in idle notification in queue matching name
-       */
-      for (item = _idleQueue->tail; item; item = prev)
-	{
-          prev = item->prev;
-          if ([name isEqual: item->name])
-	    {
-              remove_from_queue(_idleQueue, item, _zone);
-	    }
-	}
-    }
-  else if ((coalesceMask & NSNotificationCoalescingOnSender))
-    {
-      /*
-       * find in ASAP notification in queue matching sender
-       */
-      for (item = _asapQueue->tail; item; item = prev)
-	{
-          prev = item->prev;
-          if (object == item->object)
-	    {
-              remove_from_queue(_asapQueue, item, _zone);
-	    }
-	}
-      /*
-       * find in idle notification in queue matching sender
-       */
-      for (item = _idleQueue->tail; item; item = prev)
-	{
-          prev = item->prev;
-          if (object == item->object)
-	    {
-              remove_from_queue(_idleQueue, item, _zone);
-	    }
-	}
-    }
+  coalesce(_asapQueue, name, object, coalesceMask, _zone);
+  coalesce(_idleQueue, name, object, coalesceMask, _zone);
 }
 
 /**
@@ -553,6 +676,28 @@ static NSArray	*defaultMode = nil;
 
 @end
 
+@implementation NSNotificationQueue (GNUstep)
+
+/**
+ * Returns counters for the notifications handled by the receiver:
+ * the number added to its ASAP and idle queues, the number of those
+ * removed again without being posted (by coalescing or by
+ * -dequeueNotificationsMatching:coalesceMask:), and the number posted
+ * from the queues.<br />
+ * Any of the arguments may be NULL if you are not interested in the
+ * corresponding counter.
+ */
+- (void) getEnqueued: (NSUInteger*)enqueued
+	   coalesced: (NSUInteger*)coalesced
+	      posted: (NSUInteger*)posted
+{
+  if (enqueued) *enqueued = _asapQueue->enqueued + _idleQueue->enqueued;
+  if (coalesced) *coalesced = _asapQueue->coalesced + _idleQueue->coalesced;
+  if (posted) *posted = _asapQueue->posted + _idleQueue->posted;
+}
+
+@end
+
 @implementation NSNotificationQueue (Private)
 
 - (NSNotificationCenter*) _center
@@ -562,6 +707,11 @@ static NSArray	*defaultMode = nil;
 
 @end
 
+/* When posting a long run of queued notifications, the autorelease
+ * pool is emptied after each batch of this many.
+ */
+#define	NOTIFY_BATCH	64
+
 static void
 notify(NSNotificationCenter *center, NSNotificationQueueList *list,
   NSString *mode, NSZone *zone)
@@ -571,13 +721,27 @@ notify(NSNotificationCenter *center, NSNotificationQueueList *list,
   void					**ptr = buf;
   unsigned				len = sizeof(buf) / sizeof(*buf);
   unsigned				pos = 0;
+  NSArray				*matched = nil;
   NSNotificationQueueRegistration	*item = list->head;
 
-  /* Gather matching items into a buffer.
+  /* Gather matching items into a buffer.  Items usually share a modes
+   * array, so we remember the last one which matched rather than
+   * searching it again for each item.
    */
   while (item != 0)
     {
-      if (mode == nil || [item->modes indexOfObject: mode] != NSNotFound)
+      BOOL	match = NO;
+
+      if (mode == nil || item->modes == matched)
+	{
+	  match = YES;
+	}
+      else if ([item->modes indexOfObject: mode] != NSNotFound)
+	{
+	  matched = item->modes;
+	  match = YES;
+	}
+      if (match == YES)
 	{
 	  if (pos == len)
 	    {
@@ -613,6 +777,8 @@ notify(NSNotificationCenter *center, NSNotificationQueueList *list,
    */
   if (len > 0)
     {
+      NSAutoreleasePool	*arp = nil;
+
       /* First, we make a note of each notification while removing the
        * corresponding list item from the queue ... so that when we get
        * round to posting the notifications we will not get problems
@@ -624,17 +790,29 @@ notify(NSNotificationCenter *center, NSNotificationQueueList *list,
 	  ptr[pos] = RETAIN(item->notification);
 	  remove_from_queue(list, item, zone);
 	}
+      list->posted += len;
 
       /* Now that we no longer need to worry about r-entrancy,
-       * we step through our notifications, posting each one in turn.
+       * we step through our notifications, posting each one in turn,
+       * in batches so that a long queue does not build up the
+       * autoreleased objects of every observer.
        */
+      if (len > NOTIFY_BATCH)
+	{
+	  arp = [NSAutoreleasePool new];
+	}
       for (pos = 0; pos < len; pos++)
 	{
 	  NSNotification	*n = (NSNotification*)ptr[pos];
 
 	  [center postNotification: n];
 	  RELEASE(n);
+	  if (arp != nil && (pos + 1) % NOTIFY_BATCH == 0)
+	    {
+	      IF_NO_GC([arp emptyPool];)
+	    }
 	}
+      RELEASE(arp);
 
       if (allocated)
 	{
@@ -46,6 +46,7 @@
 #import "Foundation/NSAutoreleasePool.h"
 #import "Foundation/NSData.h"
 #import "Foundation/NSPort.h"
+#import "Foundation/NSMapTable.h"
 
 @class	NSMutableDataMalloc;
 @interface NSMutableDataMalloc : NSObject	// Help the compiler
@@ -89,6 +90,7 @@ static GC_descr	nodeDesc;	// Type descriptor for map node.
 #undef	_IN_PORT_CODER_M
 
 #import "GNUstepBase/DistributedObjects.h"
+#import "GSPThread.h"
 
 typedef	unsigned char	uchar;
 
@@ -282,35 +284,79 @@ typeCheck(char t1, char t2)
     }
 }
 
+/*
+ * GSClassInfo records a class and the version it was encoded with.
+ * Instances are shared ... the first instance created for each class and
+ * version is kept in a table, and decoders reuse it for every message
+ * rather than building new class information each time.
+ */
 @interface	GSClassInfo : NSObject
 {
 @public
   Class		class;
   unsigned	version;
   NSString	*name;
+  GSClassInfo	*next;	// Other versions of the same class.
 }
 + (id) newWithClass: (Class)c andVersion: (unsigned)v;
 - (NSString*) className;
 @end
 
+static NSMapTable	*classInfoTable = 0;
+static pthread_mutex_t	classInfoLock = PTHREAD_MUTEX_INITIALIZER;
+
 @implementation	GSClassInfo
+/*
+ * Returns a retained instance for the class and version, which is shared
+ * with all other users of the same class and version.
+ */
 + (id) newWithClass: (Class)c andVersion: (unsigned)v;
 {
   GSClassInfo	*info;
+  GSClassInfo	*first;
 
-  info = (GSClassInfo*)NSAllocateObject(self, 0, NSDefaultMallocZone());
-  if (info != nil)
+  pthread_mutex_lock(&classInfoLock);
+  if (classInfoTable == 0)
+    {
+      classInfoTable = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
+	NSNonOwnedPointerMapValueCallBacks, 0);
+    }
+  first = (GSClassInfo*)NSMapGet(classInfoTable, (void*)c);
+  for (info = first; info != nil; info = info->next)
     {
+      if (info->version == v)
+	{
+	  break;
+	}
+    }
+  if (info == nil)
+    {
+      /* The table owns the new instance, so it is never deallocated.
+       */
+      info = (GSClassInfo*)NSAllocateObject(self, 0, NSDefaultMallocZone());
       info->class = c;
       info->version = v;
+      info->next = first;
+      NSMapInsert(classInfoTable, (void*)c, (void*)info);
     }
+  RETAIN(info);
+  pthread_mutex_unlock(&classInfoLock);
   return info;
 }
 - (NSString*) className
 {
   if (name == nil)
     {
-      name = RETAIN(NSStringFromClass(class));
+      NSString	*n = RETAIN(NSStringFromClass(class));
+
+      pthread_mutex_lock(&classInfoLock);
+      if (name == nil)
+	{
+	  name = n;
+	  n = nil;
+	}
+      pthread_mutex_unlock(&classInfoLock);
+      RELEASE(n);
     }
   return name;
 }
@@ -409,7 +455,6 @@ static unsigned	encodingVersion;
   RELEASE(_dst);	/* Decoders retain their output data object.	*/
   RELEASE(_comp);
   RELEASE(_conn);
-  RELEASE(_cInfo);
   if (_clsMap != 0)
     {
       GSIMapEmptyMap(_clsMap);
@@ -1932,15 +1977,6 @@ static unsigned	encodingVersion;
 	  _dTagImp = (void (*)(id, SEL, unsigned char*, unsigned*, unsigned*))
 	    [_src methodForSelector: dTagSel];
 
-	  /*
-	   *	_cInfo is a dictionary of objects for keeping track of the
-	   *	version numbers that the classes were encoded with.
-	   */
-	  if (firstTime == NO)
-	    {
-	      [_cInfo removeAllObjects];
-	    }
-
 	  /*
 	   *	Read header including version and crossref table sizes.
 	   */
@@ -2028,35 +2064,23 @@ static unsigned	encodingVersion;
 
 - (NSInteger) versionForClassName: (NSString*)className
 {
-  GSClassInfo	*info = nil;
-  NSInteger	version = NSNotFound;
   unsigned	count = GSIArrayCount(_clsAry);
 
   /*
-   * Lazy ... we construct a dictionary of all the class information in
-   * the request the first time that class version info is asked for.
+   * The class information objects are shared between messages and cache
+   * their class names, so a scan of the (usually very short) list of
+   * classes in the message is cheaper than building a dictionary.
    */
-  if (_cInfo == nil)
-    {
-      _cInfo = [[mutableDictionaryClass alloc] initWithCapacity: count];
-    }
-  if ([_cInfo count] == 0)
+  while (count-- > 1)
     {
-      while (count-- > 0)
+      GSClassInfo	*info = GSIArrayItemAtIndex(_clsAry, count).obj;
+
+      if (info->class != 0 && [[info className] isEqual: className])
 	{
-	  info = GSIArrayItemAtIndex(_clsAry, count).obj;
-	  if (info->class != 0)
-	    {
-	      [_cInfo setObject: info forKey: NSStringFromClass(info->class)];
-	    }
+	  return info->version;
 	}
     }
-  info = [_cInfo objectForKey: className];
-  if (info != nil)
-    {
-      version = info->version;
-    }
-  return version;
+  return NSNotFound;
 }
 
 @end
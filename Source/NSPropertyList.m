@@ -1952,28 +1952,51 @@ OAppend(id obj, NSDictionary *loc, unsigned lev, unsigned step,
     }
   else if ([obj isKindOfClass: NSDateClass])
     {
-      static NSTimeZone	*z = nil;
+      static NSTimeZone		*z = nil;
+      static GSFixedDateFormat	xmlDate;
+      static GSFixedDateFormat	gsDate;
+      char			buf[GS_FIXED_DATE_LENGTH];
+      NSUInteger		len;
 
       if (z == nil)
 	{
+	  GSPrivateFixedDateCompile(@"yyyy-MM-dd'T'HH:mm:ss'Z'", &xmlDate);
+	  GSPrivateFixedDateCompile(@"yyyy-MM-dd HH:mm:ss Z", &gsDate);
 	  z = RETAIN([NSTimeZone timeZoneForSecondsFromGMT: 0]);
 	}
       if (x == NSPropertyListXMLFormat_v1_0)
 	{
 	  [dest appendBytes: "<date>" length: 6];
-	  obj = [obj descriptionWithCalendarFormat: @"%Y-%m-%dT%H:%M:%SZ"
-	    timeZone: z locale: nil];
-	  obj = [obj dataUsingEncoding: NSASCIIStringEncoding];
-	  [dest appendData: obj];
+	  /* Most dates can be written directly, others (outside the range
+	   * of years the fixed formats handle) go through NSCalendarDate.
+	   */
+	  if ((len = GSPrivateFixedDateFormat(&xmlDate, obj, z, buf)) > 0)
+	    {
+	      [dest appendBytes: buf length: len];
+	    }
+	  else
+	    {
+	      obj = [obj descriptionWithCalendarFormat: @"%Y-%m-%dT%H:%M:%SZ"
+		timeZone: z locale: nil];
+	      obj = [obj dataUsingEncoding: NSASCIIStringEncoding];
+	      [dest appendData: obj];
+	    }
 	  [dest appendBytes: "</date>\n" length: 8];
 	}
       else if (x == NSPropertyListGNUstepFormat)
 	{
 	  [dest appendBytes: "<*D" length: 3];
-	  obj = [obj descriptionWithCalendarFormat: @"%Y-%m-%d %H:%M:%S %z"
-	    timeZone: z locale: nil];
-	  obj = [obj dataUsingEncoding: NSASCIIStringEncoding];
-	  [dest appendData: obj];
+	  if ((len = GSPrivateFixedDateFormat(&gsDate, obj, z, buf)) > 0)
+	    {
+	      [dest appendBytes: buf length: len];
+	    }
+	  else
+	    {
+	      obj = [obj descriptionWithCalendarFormat: @"%Y-%m-%d %H:%M:%S %z"
+		timeZone: z locale: nil];
+	      obj = [obj dataUsingEncoding: NSASCIIStringEncoding];
+	      [dest appendData: obj];
+	    }
 	  [dest appendBytes: ">" length: 1];
 	}
       else
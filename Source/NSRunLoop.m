@@ -33,6 +33,7 @@
 #define	EXPOSE_NSRunLoop_IVARS	1
 #define	EXPOSE_NSTimer_IVARS	1
 #import "Foundation/NSMapTable.h"
+#import "Foundation/NSDictionary.h"
 #import "Foundation/NSDate.h"
 #import "Foundation/NSValue.h"
 #import "Foundation/NSAutoreleasePool.h"
@@ -678,6 +679,25 @@ static inline BOOL timerInvalidated(NSTimer *t)
     }
 }
 
+- (NSDictionary*) timerStatisticsForMode: (NSString*)mode
+{
+  GSRunLoopCtxt	*context = NSMapGet(_contextMap, mode);
+  GSTimerHeap	timers;
+
+  if (context == nil)
+    {
+      return nil;
+    }
+  timers = context->timers;
+  return [NSDictionary dictionaryWithObjectsAndKeys:
+    [NSNumber numberWithUnsignedInteger: NSCountMapTable(timers->members)],
+    @"Timers",
+    [NSNumber numberWithUnsignedInteger: timers->fires], @"Fires",
+    [NSNumber numberWithDouble: timers->lateness], @"Lateness",
+    [NSNumber numberWithDouble: timers->maxLateness], @"MaxLateness",
+    nil];
+}
+
 @end
 
 /**
@@ -815,7 +835,7 @@ static inline BOOL timerInvalidated(NSTimer *t)
 	  forMode: (NSString*)mode
 {
   GSRunLoopCtxt	*context;
-  GSIArray	timers;
+  GSTimerHeap	timers;
   unsigned      i;
 
   if ([timer isKindOfClass: [NSTimer class]] == NO
@@ -843,31 +863,21 @@ static inline BOOL timerInvalidated(NSTimer *t)
       RELEASE(context);
     }
   timers = context->timers;
-  i = GSIArrayCount(timers);
-  while (i-- > 0)
+  if (GSTimerHeapContains(timers, timer) == YES)
     {
-      if (timer == GSIArrayItemAtIndex(timers, i).obj)
-        {
-          return;       /* Timer already present */
-        }
+      return;       /* Timer already present */
     }
   /*
    * NB. A previous version of the timer code maintained an ordered
-   * array on the theory that we could improve performance by only
-   * checking the first few timers (up to the first one whose fire
-   * date is in the future) each time -limitDateForMode: is called.
-   * The problem with this was that it's possible for one timer to
-   * be added in multiple modes (or to different run loops) and for
-   * a repeated timer this could mean that the firing of the timer
-   * in one mode/loop adjusts its date ... without changing the
-   * ordering of the timers in the other modes/loops which contain
-   * the timer.  When the ordering of timers in an array was broken
-   * we could get delays in processing timeouts, so we reverted to
-   * simply having timers in an unordered array and checking them
-   * all each time -limitDateForMode: is called.
+   * array, and broke when a timer in more than one mode/loop had its
+   * date adjusted by firing in one of them without the others being
+   * reordered.  The heap copes with that by remembering the date each
+   * entry was ordered by, and checking it when the entry comes to the
+   * top (see GSTimerHeap.h), so each mode/loop reorders lazily.
    */
-  GSIArrayAddItem(timers, (GSIArrayItem)((id)timer));
-  i = GSIArrayCount(timers);
+  GSTimerHeapPurge(timers);
+  GSTimerHeapAdd(timers, timer, GSPrivateTimeNow());
+  i = timers->count;
   if (i % 1000 == 0 && i > context->maxTimers)
     {
       context->maxTimers = i;
@@ -955,17 +965,11 @@ updateTimer(NSTimer *t, NSDate *d, NSTimeInterval now)
       _currentMode = mode;
       NS_DURING
 	{
-	  GSIArray		timers = context->timers;
+	  GSTimerHeap		timers = context->timers;
 	  NSTimeInterval	now;
-          NSDate                *earliest;
 	  NSDate		*d;
 	  NSTimer		*t;
 	  NSTimeInterval	ti;
-	  NSTimeInterval	ei;
-          unsigned              c;
-          unsigned              i;
-
-	  ei = 0.0;	// Only needed to avoid compiler warning
 
 	  /*
 	   * Save current time so we don't keep redoing system call to
@@ -995,78 +999,104 @@ updateTimer(NSTimer *t, NSDate *d, NSTimeInterval now)
                 }
             }
 
-	  /* Fire the oldest/first valid timer whose fire date has passed
-	   * and fire it.
-	   * We fire timers in the order in which they were added to the
-	   * run loop rather than in date order.  This prevents code
-	   * from blocking other timers by adding timers whose fire date
-	   * is some time in the past... we guarantee fair handling.
+	  /* Put back any timers whose dates have been moved earlier.
 	   */
-	  c = GSIArrayCount(timers);
-	  for (i = 0; i < c; i++)
+	  if (__atomic_load_n(&timers->changed, __ATOMIC_ACQUIRE))
 	    {
-	      t = GSIArrayItemAtIndex(timers, i).obj;
-	      if (timerInvalidated(t) == NO)
+	      GSTimerHeapReorder(timers, now);
+	    }
+
+	  /* Fire the first valid timer due.  Timers with the same key
+	   * are fired in the order in which they were added to the run
+	   * loop, and a timer added with a date in the past is keyed as
+	   * due when it was added, so code adding such timers can't
+	   * block those already waiting ... we guarantee fair handling.
+	   * Invalidated timers, superseded entries and timers whose
+	   * date has changed since they were ordered are dealt with as
+	   * they reach the top.
+	   */
+	  while (timers->count > 0 && timers->ptr[0].key <= now)
+	    {
+	      GSTimerEntry	e = GSTimerHeapPop(timers);
+
+	      t = e.timer;
+	      d = timerDate(t);
+	      if (timerInvalidated(t) == YES
+		|| GSTimerHeapIsCurrent(timers, &e) == NO)
 		{
-		  d = timerDate(t);
-		  ti = [d timeIntervalSinceReferenceDate];
-		  if (ti < now)
-		    {
-		      GSIArrayRemoveItemAtIndexNoRelease(timers, i);
-		      [t fire];
-		      GSPrivateNotifyASAP(_currentMode);
-		      IF_NO_GC([arp emptyPool];)
-		      if (updateTimer(t, d, now) == YES)
-			{
-			  /* Updated ... replace in array.
-			   */
-			  GSIArrayAddItemNoRetain(timers,
-			    (GSIArrayItem)((id)t));
-			}
-		      else
-			{
-			  /* The timer was invalidated, so we can
-			   * release it as we aren't putting it back
-			   * in the array.
-			   */
-			  RELEASE(t);
-			}
-		      break;
-		    }
+		  GSTimerHeapDiscard(timers, &e);
+		  continue;
+		}
+	      if (d != e.date)
+		{
+		  RELEASE(e.date);
+		  GSTimerHeapPushNoRetain(timers, t, now);
+		  continue;
+		}
+	      RELEASE(e.date);
+	      ti = now - [d timeIntervalSinceReferenceDate];
+	      timers->fires++;
+	      timers->lateness += ti;
+	      if (ti > timers->maxLateness)
+		{
+		  timers->maxLateness = ti;
+		}
+	      [t fire];
+	      GSPrivateNotifyASAP(_currentMode);
+	      IF_NO_GC([arp emptyPool];)
+	      if (updateTimer(t, d, now) == YES)
+		{
+		  /* Updated ... put back in the heap.
+		   */
+		  GSTimerHeapPushNoRetain(timers, t, now);
+		}
+	      else
+		{
+		  /* The timer was invalidated, so we can
+		   * release it as we aren't putting it back
+		   * in the heap.
+		   */
+		  e.date = nil;
+		  GSTimerHeapDiscard(timers, &e);
 		}
+	      break;
 	    }
 
-	  /* Now, find the earliest remaining timer date while removing
-	   * any invalidated timers.  We iterate from the end of the
-	   * array to minimise the amount of array alteration needed.
+	  /* Now, remove any invalidated, superseded or reordered timers
+	   * from the top of the heap so that the first entry is the next
+	   * one due.
 	   */
-	  earliest = nil;
-	  i = GSIArrayCount(timers);
-	  while (i-- > 0)
+	  while (timers->count > 0)
 	    {
-	      t = GSIArrayItemAtIndex(timers, i).obj;
-	      if (timerInvalidated(t) == YES)
+	      GSTimerEntry	*f = &timers->ptr[0];
+
+	      t = f->timer;
+	      if (timerInvalidated(t) == YES
+		|| GSTimerHeapIsCurrent(timers, f) == NO)
+		{
+		  GSTimerEntry	e = GSTimerHeapPop(timers);
+
+		  GSTimerHeapDiscard(timers, &e);
+		}
+	      else if (timerDate(t) != f->date)
 		{
-		  GSIArrayRemoveItemAtIndex(timers, i);
+		  GSTimerEntry	e = GSTimerHeapPop(timers);
+
+		  RELEASE(e.date);
+		  GSTimerHeapPushNoRetain(timers, t, now);
 		}
 	      else
 		{
-		  d = timerDate(t);
-		  ti = [d timeIntervalSinceReferenceDate];
-		  if (earliest == nil || ti < ei)
-		    {
-		      earliest = d;
-		      ei = ti;
-		    }
+		  break;
 		}
 	    }
 
-          /* The earliest date of a valid timeout is copied into 'when'
-           * and used as our limit date.
+          /* The time of the first valid timeout is used as our limit date.
            */
-          if (earliest != nil)
+          if (timers->count > 0)
             {
-              when = [earliest copy];
+              when = [[NSDate alloc] initWithTimeIntervalSinceReferenceDate:
+		timers->ptr[0].key];
             }
 	  _currentMode = savedMode;
 	}
@@ -1155,7 +1185,7 @@ updateTimer(NSTimer *t, NSDate *d, NSTimeInterval now)
 
       if (context == nil
 	|| (GSIArrayCount(context->watchers) == 0
-	  && GSIArrayCount(context->timers) == 0))
+	  && context->timers->count == 0))
 	{
 	  NSDebugMLLog(@"NSRunLoop", @"no inputs or timers in mode %@", mode);
 	  GSPrivateNotifyASAP(_currentMode);
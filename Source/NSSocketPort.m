@@ -75,6 +75,7 @@
 #include <sys/resource.h>
 #include <netdb.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #if	defined(HAVE_SYS_FILE_H)
 #  include	<sys/file.h>
@@ -128,6 +129,15 @@ static uint32_t	maxDataLength = 32 * 1024 * 1024;
 #define	GS_CONNECTION_MSG	0
 #define	NETBLOCK	8192
 
+/*
+ * Maximum number of data items gathered into a single write.
+ */
+#define	WRITEV_MAX	64
+#if	defined(IOV_MAX) && IOV_MAX < WRITEV_MAX
+#undef	WRITEV_MAX
+#define	WRITEV_MAX	IOV_MAX
+#endif
+
 #ifndef INADDR_NONE
 #define	INADDR_NONE	-1
 #endif
@@ -199,9 +209,10 @@ typedef enum {
 {
   SOCKET		desc;		/* File descriptor for I/O.	*/
   unsigned		wItem;		/* Index of item being written.	*/
-  NSMutableData		*wData;		/* Data object being written.	*/
   unsigned		wLength;	/* Ammount written so far.	*/
   NSMutableArray	*wMsgs;		/* Message in progress.		*/
+  uint64_t		wQueued;	/* Number of messages queued.	*/
+  uint64_t		wDone;		/* Number of messages written.	*/
   NSMutableData		*rData;		/* Buffer for incoming data	*/
   uint32_t		rLength;	/* Amount read so far.		*/
   uint32_t		rWant;		/* Amount desired.		*/
@@ -1132,27 +1143,66 @@ static Class	runLoopClass;
   else
     {
       int		res;
-      unsigned	l;
+#if	defined(__MINGW__)
+      NSData		*d;
+      unsigned		l;
       const void	*b;
 
-      if (wData == nil)
-        {
-          if ([wMsgs count] > 0)
-            {
-	      NSArray	*components = [wMsgs objectAtIndex: 0];
+      if ([wMsgs count] == 0)
+	{
+	  // NSLog(@"No messages to write on 0x%x.", self);
+	  return;
+	}
+      d = [[wMsgs objectAtIndex: 0] objectAtIndex: wItem];
+      b = [d bytes];
+      l = [d length];
+      res = send(desc, b + wLength,  l - wLength, 0);
+#else
+      struct iovec	iov[WRITEV_MAX];
+      unsigned		msgCount = [wMsgs count];
+      unsigned		cnt = 0;
+      unsigned		m;
 
-	      wData = [components objectAtIndex: wItem++];
-	      wLength = 0;
-	    }
-	  else
+      if (msgCount == 0)
+	{
+	  // NSLog(@"No messages to write on 0x%x.", self);
+	  return;
+	}
+      /*
+       * Gather the remaining items of the current message, and of as many
+       * following messages as will fit, so that everything queued on this
+       * handle goes out in a single system call without being copied.
+       */
+      for (m = 0; m < msgCount && cnt < WRITEV_MAX; m++)
+	{
+	  NSArray	*components = [wMsgs objectAtIndex: m];
+	  unsigned	c = [components count];
+	  unsigned	i = (m == 0) ? wItem : 0;
+
+	  while (i < c && cnt < WRITEV_MAX)
 	    {
-	      // NSLog(@"No messages to write on 0x%x.", self);
-	      return;
+	      NSData	*d = [components objectAtIndex: i];
+	      unsigned	off = (m == 0 && i == wItem) ? wLength : 0;
+	      unsigned	l = [d length];
+
+	      if (l > off)
+		{
+		  iov[cnt].iov_base = (char*)[d bytes] + off;
+		  iov[cnt].iov_len = l - off;
+		  cnt++;
+		}
+	      i++;
 	    }
 	}
-      b = [wData bytes];
-      l = [wData length];
-      res = send(desc, b + wLength,  l - wLength, 0);
+      if (cnt == 0)
+	{
+	  res = 0;	// Only empty items remain.
+	}
+      else
+	{
+	  res = writev(desc, iov, cnt);
+	}
+#endif
       if (res < 0)
         {
 #ifdef __MINGW__
@@ -1175,35 +1225,33 @@ static Class	runLoopClass;
 	}
       else
         {
+	  unsigned	left = res;
+
           NSDebugMLLog(@"GSTcpHandle",
             @"wrote %d bytes on 0x%x", res, self);
-	  wLength += res;
-          if (wLength == l)
-            {
-	      NSArray	*components;
+	  /*
+	   * Step through the items covered by the data written, removing
+	   * each message from the list as it is completed.
+	   */
+	  while ([wMsgs count] > 0)
+	    {
+	      NSArray	*components = [wMsgs objectAtIndex: 0];
+	      unsigned	remaining;
 
-	      /*
-	       * We have completed a data item so see what is
-	       * left of the message components.
-	       */
-	      components = [wMsgs objectAtIndex: 0];
+	      remaining = [[components objectAtIndex: wItem] length] - wLength;
+	      if (remaining > left)
+		{
+		  wLength += left;
+		  break;
+		}
+	      left -= remaining;
 	      wLength = 0;
-	      if ([components count] > wItem)
+	      if (++wItem == [components count])
 	        {
-	          /*
-	           * More to write - get next item.
-	           */
-	          wData = [components objectAtIndex: wItem++];
-	        }
-	      else
-	        {
-	          /*
-	           * message completed - remove from list.
-	           */
 	          NSDebugMLLog(@"GSTcpHandle",
 	            @"completed 0x%x on 0x%x", components, self);
-		  wData = nil;
 	          wItem = 0;
+		  wDone++;
 	          [wMsgs removeObjectAtIndex: 0];
 	        }
 	    }
@@ -1332,6 +1380,7 @@ static Class	runLoopClass;
 - (BOOL) sendMessage: (NSArray*)components beforeDate: (NSDate*)when
 {
   NSRunLoop	*l;
+  uint64_t	seq;
   BOOL		sent = NO;
 
   NSAssert([components count] > 0, NSInternalInconsistencyException);
@@ -1340,11 +1389,32 @@ static Class	runLoopClass;
     components, components, self, desc, when);
   M_LOCK(myLock);
   [wMsgs addObject: components];
-
-  l = [runLoopClass currentRunLoop];
+  seq = ++wQueued;
 
   IF_NO_GC(RETAIN(self);)
 
+#if	!defined(__MINGW__)
+  /*
+   * The socket is non-blocking, so if we are connected we can try to
+   * write at once (along with anything queued before us) rather than
+   * waiting for the run loop to tell us the descriptor is writable.
+   */
+  if (state == GS_H_CONNECTED && valid == YES)
+    {
+      [self receivedEventWrite];
+      if (wDone >= seq)
+	{
+	  M_UNLOCK(myLock);
+	  NSDebugMLLog(@"GSTcpHandle",
+	    @"Message send 0x%x on 0x%x status %d", components, self, YES);
+	  RELEASE(self);
+	  return YES;
+	}
+    }
+#endif
+
+  l = [runLoopClass currentRunLoop];
+
 #if	defined(__MINGW__)
   NSAssert(event != WSA_INVALID_EVENT, @"Socket without win32 event!");
   [l addEvent: (void*)(uintptr_t)event
@@ -1376,7 +1446,7 @@ static Class	runLoopClass;
 #endif
 
   while (valid == YES
-    && [wMsgs indexOfObjectIdenticalTo: components] != NSNotFound
+    && wDone < seq
     && [when timeIntervalSinceNow] > 0)
     {
       M_UNLOCK(myLock);
@@ -1424,7 +1494,7 @@ static Class	runLoopClass;
 	     all: NO];
 #endif
 
-  if ([wMsgs indexOfObjectIdenticalTo: components] == NSNotFound)
+  if (wDone >= seq)
     {
       sent = YES;
     }
@@ -2410,15 +2480,19 @@ static Class		tcpPortClass;
 		{
 		  NSMutableData	*d;
 
+		  /*
+		   * Too big to pack ... put the item header in a data
+		   * object of its own and leave the item data where it
+		   * is, since the handle writes all items together
+		   * without needing them to be contiguous.
+		   */
 		  pack = NO;
-		  d = [[NSMutableData alloc] initWithLength: l + h];
-		  b = [d mutableBytes];
-		  pih = (GSPortItemHeader*)b;
-		  memcpy(b+h, [o bytes], l);
+		  d = [[mutableDataClass alloc] initWithLength: h];
+		  pih = (GSPortItemHeader*)[d mutableBytes];
 		  pih->type = GSSwapHostI32ToBig(GSP_DATA);
 		  pih->length = GSSwapHostI32ToBig(l);
-		  [components replaceObjectAtIndex: i
-					withObject: d];
+		  [components insertObject: d atIndex: i++];
+		  c++;
 		  RELEASE(d);
 		}
 	    }
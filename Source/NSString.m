@@ -1252,26 +1252,9 @@ static UCollator *GSICUCollatorOpen(NSStringCompareOptions mask, NSLocale *local
 {
   unsigned char	buf[2048];
   GSStr		f;
-  unichar	fbuf[1024];
-  unichar	*fmt = fbuf;
-  size_t	len;
 
   /*
-   * First we provide an array of unichar characters containing the
-   * format string.  For performance reasons we try to use an on-stack
-   * buffer if the format string is small enough ... it almost always
-   * will be.
-   */
-  len = [format length];
-  if (len >= 1024)
-    {
-      fmt = NSZoneMalloc(NSDefaultMallocZone(), (len+1)*sizeof(unichar));
-    }
-  [format getCharacters: fmt range: ((NSRange){0, len})];
-  fmt[len] = '\0';
-
-  /*
-   * Now set up 'f' as a GSMutableString object whose initial buffer is
+   * Set up 'f' as a GSMutableString object whose initial buffer is
    * allocated on the stack.  The GSPrivateFormat function can write into it.
    */
   f = (GSStr)alloca(class_getInstanceSize(GSMutableStringClass));
@@ -1284,12 +1267,8 @@ static UCollator *GSICUCollatorOpen(NSStringCompareOptions mask, NSLocale *local
   f->_flags.owned = 0;
   f->_flags.unused = 0;
   f->_flags.hash = 0;
-  GSPrivateFormat(f, fmt, argList, locale);
+  GSPrivateFormat(f, format, argList, locale);
   GSPrivateStrExternalize(f);
-  if (fmt != fbuf)
-    {
-      NSZoneFree(NSDefaultMallocZone(), fmt);
-    }
 
   /*
    * Don't use noCopy because f->_contents.u may be memory on the stack,
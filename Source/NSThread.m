@@ -1014,6 +1014,16 @@ static void *nsthreadLauncher(void* thread)
   [lock unlock];
 }
 
+- (NSUInteger) pending
+{
+  NSUInteger	count;
+
+  [lock lock];
+  count = [performers count];
+  [lock unlock];
+  return count;
+}
+
 - (void) fire
 {
   NSArray	*toDo;
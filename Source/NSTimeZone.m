@@ -2441,11 +2441,6 @@ lastDayOfGregorianMonth(int month, int year)
     }
 }
 
-/* IMPORT from NSCalendar date */
-void
-GSBreakTime(NSTimeInterval when, NSInteger*year, NSInteger*month, NSInteger*day,
-  NSInteger*hour, NSInteger*minute, NSInteger*second, NSInteger*mil);
-
 
 @implementation GSWindowsTimeZone
 
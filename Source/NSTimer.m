@@ -29,17 +29,80 @@
 
 #import "common.h"
 #define	EXPOSE_NSTimer_IVARS	1
+#define	GS_NSTimer_IVARS \
+  NSTimeInterval _tolerance; \
+  struct GSTimerHeap_s	**_heaps; \
+  unsigned		_heapCount
+struct GSTimerHeap_s;
 #import "Foundation/NSTimer.h"
 #import "Foundation/NSDate.h"
 #import "Foundation/NSException.h"
 #import "Foundation/NSRunLoop.h"
 #import "Foundation/NSInvocation.h"
+#import "GSPrivate.h"
+#import "GSTimerHeap.h"
+
+#include <pthread.h>
+
+#define	GSInternal	NSTimerInternal
+#include	"GSInternal.h"
+GS_PRIVATE_INTERNAL(NSTimer)
 
 @class	NSGDate;
 @interface NSGDate : NSObject	// Help the compiler
 @end
 static Class	NSDate_class;
 
+/* Protects the heaps recorded in each timer and the moved tables of
+ * those heaps.
+ */
+static pthread_mutex_t	heapsLock = PTHREAD_MUTEX_INITIALIZER;
+
+void
+GSTimerHeapReorder(GSTimerHeap heap, NSTimeInterval now)
+{
+  NSTimer		*buf[32];
+  NSTimer		**moved = buf;
+  NSUInteger		count;
+  NSUInteger		i;
+  NSHashEnumerator	enumerator;
+  NSTimer		*t;
+
+  pthread_mutex_lock(&heapsLock);
+  count = NSCountHashTable(heap->moved);
+  if (count > 32)
+    {
+      moved = NSZoneMalloc(NSDefaultMallocZone(), count * sizeof(NSTimer*));
+    }
+  i = 0;
+  enumerator = NSEnumerateHashTable(heap->moved);
+  while ((t = NSNextHashEnumeratorItem(&enumerator)) != nil)
+    {
+      moved[i++] = t;
+    }
+  NSEndHashTableEnumeration(&enumerator);
+  NSResetHashTable(heap->moved);
+  heap->changed = NO;
+  pthread_mutex_unlock(&heapsLock);
+
+  /* Each timer is still held by the heap (it would have been removed
+   * from the moved table otherwise), so adding a new entry for it is
+   * enough; the old entry is dropped when it reaches the top.
+   */
+  for (i = 0; i < count; i++)
+    {
+      t = moved[i];
+      if ([t isValid] == YES)
+	{
+	  GSTimerHeapPushNoRetain(heap, RETAIN(t), now);
+	}
+    }
+  if (moved != buf)
+    {
+      NSZoneFree(NSDefaultMallocZone(), moved);
+    }
+}
+
 /**
  * <p>An <code>NSTimer</code> provides a way to send a message at some time in
  * the future, possibly repeating every time a fixed interval has passed. To
@@ -213,6 +276,7 @@ static Class	NSDate_class;
       [self invalidate];
     }
   RELEASE(_date);
+  GS_DESTROY_INTERNAL(NSTimer)
   [super dealloc];
 }
 
@@ -328,7 +392,59 @@ static Class	NSDate_class;
  */
 - (void) setFireDate: (NSDate*)fireDate
 {
+  BOOL	earlier = NO;
+
+  if (_date != nil && fireDate != nil
+    && [fireDate timeIntervalSinceReferenceDate]
+    < [_date timeIntervalSinceReferenceDate])
+    {
+      earlier = YES;
+    }
   ASSIGN(_date, fireDate);
+  if (YES == earlier)
+    {
+      /* Run loops order their timers by date, so the heaps holding
+       * this timer must be told that it may have moved earlier.  The
+       * new date is set before the lock is taken, so a run loop which
+       * finds the timer in its moved table will see that date.
+       */
+      pthread_mutex_lock(&heapsLock);
+      if (GS_EXISTS_INTERNAL)
+	{
+	  unsigned	i;
+
+	  for (i = 0; i < internal->_heapCount; i++)
+	    {
+	      GSTimerHeap	heap = internal->_heaps[i];
+
+	      NSHashInsert(heap->moved, self);
+	      __atomic_store_n(&heap->changed, YES, __ATOMIC_RELEASE);
+	    }
+	}
+      pthread_mutex_unlock(&heapsLock);
+    }
+}
+
+- (NSTimeInterval) tolerance
+{
+  if (GS_EXISTS_INTERNAL)
+    {
+      return internal->_tolerance;
+    }
+  return 0.0;
+}
+
+- (void) setTolerance: (NSTimeInterval)tolerance
+{
+  if (tolerance < 0.0)
+    {
+      tolerance = 0.0;
+    }
+  if (tolerance > 0.0 || GS_EXISTS_INTERNAL)
+    {
+      GS_CREATE_INTERNAL(NSTimer)
+      internal->_tolerance = tolerance;
+    }
 }
 
 /**
@@ -371,3 +487,47 @@ static Class	NSDate_class;
 }
 
 @end
+
+@implementation	NSTimer (GSTimerHeap)
+
+- (void) _addedToHeap: (GSTimerHeap)heap
+{
+  pthread_mutex_lock(&heapsLock);
+  GS_CREATE_INTERNAL(NSTimer)
+  if (0 == internal->_heaps)
+    {
+      internal->_heaps = NSZoneMalloc(NSDefaultMallocZone(),
+	sizeof(GSTimerHeap));
+    }
+  else
+    {
+      internal->_heaps = NSZoneRealloc(NSDefaultMallocZone(),
+	internal->_heaps, (internal->_heapCount + 1) * sizeof(GSTimerHeap));
+    }
+  internal->_heaps[internal->_heapCount++] = heap;
+  pthread_mutex_unlock(&heapsLock);
+}
+
+- (void) _removedFromHeap: (GSTimerHeap)heap
+{
+  unsigned	i;
+
+  pthread_mutex_lock(&heapsLock);
+  for (i = 0; i < internal->_heapCount; i++)
+    {
+      if (internal->_heaps[i] == heap)
+	{
+	  internal->_heaps[i] = internal->_heaps[--internal->_heapCount];
+	  break;
+	}
+    }
+  if (0 == internal->_heapCount)
+    {
+      NSZoneFree(NSDefaultMallocZone(), internal->_heaps);
+      internal->_heaps = 0;
+    }
+  NSHashRemove(heap->moved, self);
+  pthread_mutex_unlock(&heapsLock);
+}
+
+@end
@@ -252,6 +252,8 @@ updateCache(NSUserDefaults *self)
 	= [self boolForKey: @"GSLogSyslog"];
       flags[GSLogThread]
 	= [self boolForKey: @"GSLogThread"];
+      flags[GSLogAsynchronous]
+	= [self boolForKey: @"GSLogAsynchronous"];
       flags[NSWriteOldStylePropertyLists]
 	= [self boolForKey: @"NSWriteOldStylePropertyLists"];
     }
@@ -36,6 +36,7 @@
 GS_PRIVATE_INTERNAL(NSXMLDocument)
 
 //#import <Foundation/NSXMLParser.h>
+#import <Foundation/NSAutoreleasePool.h>
 #import <Foundation/NSError.h>
 
 @implementation	NSXMLDocument
@@ -271,6 +272,7 @@ GS_PRIVATE_INTERNAL(NSXMLDocument)
   [self setChildren: nil];
 
   // FIXME: Should we use addChild: here? 
+  GSXMLChildrenChanged((xmlNodePtr)internal->node);
   xmlDocSetRootElement(internal->node, [root _node]);
 
   // Do our subNode housekeeping...
@@ -519,4 +521,119 @@ GS_PRIVATE_INTERNAL(NSXMLDocument)
 }
 @end
 
+@implementation	NSXMLDocument (GSStreaming)
+
++ (BOOL) enumerateElementsNamed: (NSString*)name
+			 inData: (NSData*)data
+			options: (NSUInteger)mask
+			  error: (NSError**)error
+		     usingBlock: (GSXMLElementEnumerationBlock)block
+{
+  BOOL	stop = NO;
+
+  if (nil == name || nil == data)
+    {
+      [NSException raise: NSInvalidArgumentException
+		  format: @"[NSXMLDocument+%@] nil argument",
+		   NSStringFromSelector(_cmd)];
+    }
+  if (error != NULL)
+    {
+      *error = nil;
+    }
+
+#ifdef	LIBXML_READER_ENABLED
+  {
+    const xmlChar	*wanted = XMLSTRING(name);
+    int			xmlOptions = XML_PARSE_NOERROR;
+    xmlTextReaderPtr	reader;
+    int			ret;
+
+    if (!(mask & NSXMLNodePreserveWhitespace))
+      {
+	xmlOptions |= XML_PARSE_NOBLANKS;
+      }
+    reader = xmlReaderForMemory([data bytes], [data length],
+      NULL, NULL, xmlOptions);
+    if (reader == NULL)
+      {
+	ret = -1;
+      }
+    else
+      {
+	ret = xmlTextReaderRead(reader);
+	while (1 == ret && NO == stop)
+	  {
+	    if (XML_READER_TYPE_ELEMENT == xmlTextReaderNodeType(reader)
+	      && xmlStrEqual(xmlTextReaderConstName(reader), wanted))
+	      {
+		xmlNodePtr		node = xmlTextReaderExpand(reader);
+		xmlDocPtr		tmp;
+		xmlNodePtr		copy;
+		NSAutoreleasePool	*arp;
+
+		if (NULL == node)
+		  {
+		    ret = -1;
+		    break;
+		  }
+		/* Copy the subtree into a private document owned by the
+		 * new element (as -detach does), so that the reader may
+		 * discard its own copy when we move on.
+		 */
+		tmp = xmlNewDoc((xmlChar *)"1.0");
+		copy = xmlDocCopyNode(node, tmp, 1);
+		arp = [NSAutoreleasePool new];
+		CALL_BLOCK(block,
+		  (NSXMLElement*)[NSXMLNode _objectForNode: copy], &stop);
+		[arp drain];
+		ret = xmlTextReaderNext(reader);
+	      }
+	    else
+	      {
+		ret = xmlTextReaderRead(reader);
+	      }
+	  }
+	xmlFreeTextReader(reader);
+      }
+    if (ret < 0)
+      {
+	if (error != NULL)
+	  {
+	    *error = [NSError errorWithDomain: @"NSXMLErrorDomain"
+					 code: 0
+				     userInfo: nil];
+	  }
+	return NO;
+      }
+  }
+#else
+  {
+    /* No streaming reader in this libxml2; parse the whole document.
+     */
+    NSXMLDocument	*doc;
+    NSEnumerator	*e;
+    NSXMLElement	*element;
+
+    doc = [[[self alloc] initWithData: data
+			      options: mask
+				error: error] autorelease];
+    if (nil == doc)
+      {
+	return NO;
+      }
+    e = [[doc nodesForXPath: [NSString stringWithFormat: @"//%@", name]
+		      error: error] objectEnumerator];
+    while (NO == stop && (element = [e nextObject]) != nil)
+      {
+	element = [[element copy] autorelease];
+	CALL_BLOCK(block, element, &stop);
+      }
+  }
+#endif
+  return YES;
+}
+
+@end
+
 #endif
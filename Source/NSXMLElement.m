@@ -346,6 +346,7 @@ extern void ensure_oldNs(xmlNodePtr node);
 	    }
 	}
     }
+  GSXMLChildrenChanged(theNode);
   xmlAddChild(theNode, (xmlNodePtr)attr);
   [self _addSubNode: attribute];
 }
@@ -715,6 +716,7 @@ joinTextNodes(xmlNodePtr nodeA, xmlNodePtr nodeB, NSMutableArray *nodesToDelete)
   NSXMLNode *objA = (nodeA->_private);
   NSXMLNode *objB = (nodeB->_private);
 
+  GSXMLChildrenChanged(nodeA->parent);
   xmlTextMerge(nodeA, nodeB); // merge nodeB into nodeA
 
   if (objA != nil) // objA gets the merged node
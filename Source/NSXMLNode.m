@@ -30,10 +30,15 @@
 #define	GS_XMLNODETYPE	xmlNode
 
 #import "Foundation/NSCharacterSet.h"
+#import "Foundation/NSThread.h"
 #import "NSXMLPrivate.h"
 #import "GSInternal.h"
 GS_PRIVATE_INTERNAL(NSXMLNode)
 
+/* Maximum number of compiled XPath expressions kept for each thread.
+ */
+#define	XPATH_CACHE_MAX	64
+
 void
 cleanup_namespaces(xmlNodePtr node, xmlNsPtr ns)
 {
@@ -309,6 +314,8 @@ isEqualTree(xmlNodePtr nodeA, xmlNodePtr nodeB)
 - (void) _setNode: (void *)_anode
 {
   DESTROY(internal->subNodes);
+  DESTROY(internal->childArray);
+  internal->childCacheValid = NO;
   internal->node = _anode;
   if (internal->node != NULL)
     {
@@ -483,29 +490,63 @@ isEqualTree(xmlNodePtr nodeA, xmlNodePtr nodeB)
 
 - (xmlNodePtr) _childNodeAtIndex: (NSUInteger)index
 {
-  NSUInteger count = 0;
-  xmlNodePtr theNode = internal->node;
-  xmlNodePtr children;
+  NSUInteger	count;
+  xmlNodePtr	*children = [self _childNodes: &count];
 
-  if ((theNode->type == XML_NAMESPACE_DECL) ||
-      (theNode->type == XML_ATTRIBUTE_NODE))
-    {
-      return NULL;
-    }
-
-  children = theNode->children;
-  if (!children)
+  if (count == 0)
     return NULL; // the Cocoa docs say it returns nil if there are no children
 
-  while (children != NULL && count++ < index)
+  if (index > count)
+    [NSException raise: NSRangeException format: @"child index too large"];
+
+  if (index == count)
+    return NULL;
+  return children[index];
+}
+
+/* Returns the libxml2 children of the receiver as a C array, setting
+ * *count to the number of children.  The array is cached and rebuilt
+ * only after some node tree has been modified, so repeated indexed
+ * access does not need to walk the list of siblings each time.
+ */
+- (xmlNodePtr*) _childNodes: (NSUInteger*)count
+{
+  xmlNodePtr	theNode = internal->node;
+
+  if ((theNode == NULL) ||
+      (theNode->type == XML_NAMESPACE_DECL) ||
+      (theNode->type == XML_ATTRIBUTE_NODE) ||
+      (theNode->children == NULL))
     {
-      children = children->next;
+      *count = 0;
+      return NULL;
     }
 
-  if (count < index)
-    [NSException raise: NSRangeException format: @"child index too large"];
+  if (internal->childCacheValid == NO)
+    {
+      xmlNodePtr	children;
+      NSUInteger	c = 0;
 
-  return children;
+      for (children = theNode->children; children; children = children->next)
+	{
+	  c++;
+	}
+      if (c > internal->childCacheCount || internal->childCache == NULL)
+	{
+	  internal->childCache = NSZoneRealloc([self zone],
+	    internal->childCache, c * sizeof(xmlNodePtr));
+	}
+      c = 0;
+      for (children = theNode->children; children; children = children->next)
+	{
+	  internal->childCache[c++] = children;
+	}
+      internal->childCacheCount = c;
+      DESTROY(internal->childArray);
+      internal->childCacheValid = YES;
+    }
+  *count = internal->childCacheCount;
+  return (xmlNodePtr*)internal->childCache;
 }
 
 - (void) _insertChild: (NSXMLNode*)child atIndex: (NSUInteger)index
@@ -611,6 +652,7 @@ isEqualTree(xmlNodePtr nodeA, xmlNodePtr nodeB)
         }
     }
 
+  GSXMLChildrenChanged(parentNode);
   if (mergeTextNodes ||
            ((childNode->type != XML_TEXT_NODE) &&
             (parentNode->type != XML_TEXT_NODE)))
@@ -692,6 +734,11 @@ isEqualTree(xmlNodePtr nodeA, xmlNodePtr nodeB)
   [self _setNode: NULL];
 }
 
+- (void) _childrenChanged
+{
+  internal->childCacheValid = NO;
+}
+
 @end
 
 static void
@@ -730,6 +777,66 @@ clearPrivatePointers(xmlNodePtr aNode)
   // FIXME: Handle more node types
 }
 
+/* Holds a compiled XPath expression so that it can be kept in a
+ * collection and freed when discarded.
+ */
+@interface	GSXPathExpression : NSObject
+{
+@public
+  xmlXPathCompExprPtr	comp;
+}
+@end
+
+@implementation	GSXPathExpression
+- (void) dealloc
+{
+  if (comp != NULL)
+    {
+      xmlXPathFreeCompExpr(comp);
+    }
+  [super dealloc];
+}
+@end
+
+static NSString	*xpathCacheKey = @"GSXPathExpressionCache";
+
+/* Returns the compiled form of the expression, using a per-thread cache
+ * so that evaluating the same query repeatedly does not parse it again.
+ */
+static xmlXPathCompExprPtr
+compiled_xpath(NSString *xpath_exp)
+{
+  NSMutableDictionary	*td = [[NSThread currentThread] threadDictionary];
+  NSMutableDictionary	*cache = [td objectForKey: xpathCacheKey];
+  GSXPathExpression	*e;
+
+  if (cache == nil)
+    {
+      cache = [NSMutableDictionary new];
+      [td setObject: cache forKey: xpathCacheKey];
+      RELEASE(cache);
+    }
+  e = [cache objectForKey: xpath_exp];
+  if (e == nil)
+    {
+      xmlXPathCompExprPtr	comp = xmlXPathCompile(XMLSTRING(xpath_exp));
+
+      if (comp == NULL)
+	{
+	  return NULL;
+	}
+      if ([cache count] >= XPATH_CACHE_MAX)
+	{
+	  [cache removeAllObjects];
+	}
+      e = [GSXPathExpression new];
+      e->comp = comp;
+      [cache setObject: e forKey: xpath_exp];
+      RELEASE(e);
+    }
+  return e->comp;
+}
+
 static NSArray *
 execute_xpath(xmlNodePtr node, NSString *xpath_exp, NSDictionary *constants,
               BOOL nodesOnly, NSError **error)
@@ -739,6 +846,7 @@ execute_xpath(xmlNodePtr node, NSString *xpath_exp, NSDictionary *constants,
   const xmlChar* xpathExpr = XMLSTRING(xpath_exp); 
   xmlXPathContextPtr xpathCtx =  NULL; 
   xmlXPathObjectPtr xpathObj = NULL; 
+  xmlXPathCompExprPtr comp = NULL;
   xmlNodePtr rootNode = NULL;
 
   if (error != NULL)
@@ -800,7 +908,11 @@ execute_xpath(xmlNodePtr node, NSString *xpath_exp, NSDictionary *constants,
     }
 
   /* Evaluate xpath expression */
-  xpathObj = xmlXPathEvalExpression(xpathExpr, xpathCtx);
+  comp = compiled_xpath(xpath_exp);
+  if (comp != NULL)
+    {
+      xpathObj = xmlXPathCompiledEval(comp, xpathCtx);
+    }
   if (xpathObj == NULL) 
     {
       NSLog(@"Error: unable to evaluate xpath expression \"%s\"", xpathExpr);
@@ -1094,58 +1206,46 @@ execute_xpath(xmlNodePtr node, NSString *xpath_exp, NSDictionary *constants,
 
 - (NSUInteger) childCount
 {
-  NSUInteger count = 0;
-  xmlNodePtr children = NULL;
-  xmlNodePtr theNode = internal->node;
-
-  if (!theNode)
-    {
-      return 0;
-    }
-
-  if ((theNode->type == XML_NAMESPACE_DECL) ||
-      (theNode->type == XML_ATTRIBUTE_NODE))
-    {
-      return 0;
-    }
-
-  for (children = theNode->children; children; children = children->next)
-    {
-      count++;
-    }
+  NSUInteger count;
 
+  [self _childNodes: &count];
   return count;
 }
 
 - (NSArray*) children
 {
-  NSMutableArray *childrenArray = nil;
-
   if (NSXMLInvalidKind == internal->kind)
     {
       return nil;
     }
   else
     {
-      xmlNodePtr children = NULL;
-      xmlNodePtr theNode = internal->node;
-      
-      if ((theNode == NULL) ||
-          (theNode->type == XML_NAMESPACE_DECL) ||
-          (theNode->type == XML_ATTRIBUTE_NODE) ||
-          (theNode->children == NULL))
+      NSUInteger	count;
+      NSUInteger	i;
+      xmlNodePtr	*children = [self _childNodes: &count];
+
+      if (count == 0)
 	{
 	  return nil;
 	}
 
-      childrenArray = [NSMutableArray array];
-      for (children = theNode->children; children; children = children->next)
+      /* The array is cached until the tree is next modified, when
+       * _childNodes: discards it.
+       */
+      if (internal->childArray == nil)
 	{
-	  NSXMLNode *n = [NSXMLNode _objectForNode: children];
-	  [childrenArray addObject: n];
+	  GS_BEGINIDBUF(objects, count);
+
+	  for (i = 0; i < count; i++)
+	    {
+	      objects[i] = [NSXMLNode _objectForNode: children[i]];
+	    }
+	  internal->childArray
+	    = [[NSArray alloc] initWithObjects: objects count: count];
+	  GS_ENDIDBUF();
 	}
+      return AUTORELEASE(RETAIN(internal->childArray));
     }
-  return childrenArray;
 }
 
 - (id) copyWithZone: (NSZone*)zone
@@ -1202,6 +1302,11 @@ execute_xpath(xmlNodePtr node, NSString *xpath_exp, NSDictionary *constants,
 
       [internal->objectValue release];
       [internal->subNodes release];
+      [internal->childArray release];
+      if (internal->childCache != NULL)
+        {
+          NSZoneFree([self zone], internal->childCache);
+        }
       if (theNode)
         {
           if (theNode->type == XML_NAMESPACE_DECL)
@@ -1254,6 +1359,7 @@ execute_xpath(xmlNodePtr node, NSString *xpath_exp, NSDictionary *constants,
     {
       NSXMLNode *parent = [self parent];
 
+      GSXMLChildrenChanged(theNode->parent);
       if (theNode->type == XML_NAMESPACE_DECL)
         {
           // FIXME
@@ -1851,6 +1957,7 @@ execute_xpath(xmlNodePtr node, NSString *xpath_exp, NSDictionary *constants,
     }
   else
     {
+      GSXMLChildrenChanged(theNode);
       // Remove all child nodes except attributes
       if (internal->subNodes)
         {
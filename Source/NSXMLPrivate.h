@@ -26,6 +26,7 @@
 #define	_INCLUDED_NSXMLPRIVATE_H
 
 #import "common.h"
+#import "GSPrivate.h"
 
 #ifdef	HAVE_LIBXML
 
@@ -43,6 +44,7 @@
 #include <libxml/xmlsave.h>
 #include <libxml/xpath.h>
 #include <libxml/xpathInternals.h>
+#include <libxml/xmlreader.h>
 
 #ifdef HAVE_LIBXSLT
 #include <libxslt/xslt.h>
@@ -117,6 +119,11 @@ StringFromXMLString(const unsigned char *bytes, unsigned length)
  * The 'options' field is a bitmask of options for this node.
  * The 'objectValue' is the object value set for the node.
  * The 'subNodes' array is used to retain the objects pointed to by subnodes.
+ * The 'childCache' array holds the libxml2 child nodes (and 'childArray'
+ * the objects for them) so that indexed access to the children does not
+ * walk the sibling list.  Both are valid only while 'childCacheValid' is
+ * set, and it is cleared whenever the NSXML classes change the children
+ * of the node.
  *
  * When we create an Objective-C object for a node we also create objects
  * for all parents up to the root object. (Reusing existing once as we find 
@@ -142,7 +149,11 @@ StringFromXMLString(const unsigned char *bytes, unsigned length)
   GS_XMLNODETYPE *node;  \
   NSUInteger      options; \
   id              objectValue; \
-  NSMutableArray *subNodes;
+  NSMutableArray *subNodes; \
+  void		**childCache; \
+  NSUInteger	  childCacheCount; \
+  BOOL		  childCacheValid; \
+  NSArray	 *childArray;
 
 
 /* When using the non-fragile ABI, the instance variables are exposed to the
@@ -215,10 +226,26 @@ StringFromXMLString(const unsigned char *bytes, unsigned length)
 - (void) _removeSubNode: (NSXMLNode *)subNode;
 - (id) _initWithNode: (xmlNodePtr)node kind: (NSXMLNodeKind)kind;
 - (xmlNodePtr) _childNodeAtIndex: (NSUInteger)index;
+- (xmlNodePtr*) _childNodes: (NSUInteger*)count;
 - (void) _insertChild: (NSXMLNode*)child atIndex: (NSUInteger)index;
 - (void) _invalidate;
+- (void) _childrenChanged;
 @end
 
+/* Must be called whenever the NSXML classes change the list of children
+ * of a libxml2 node, so that the object for the node (if there is one)
+ * discards its cached list.  Only the node itself is affected, so changes
+ * to one tree don't disturb the caches of any other.
+ */
+static inline void
+GSXMLChildrenChanged(xmlNodePtr n)
+{
+  if (n != NULL && n->_private != NULL)
+    {
+      [(NSXMLNode*)n->_private _childrenChanged];
+    }
+}
+
 #endif /* HAVE_LIBXML */
 
 #endif
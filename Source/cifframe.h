@@ -55,6 +55,8 @@ typedef struct _cifframe_t {
 
 extern NSMutableData *cifframe_from_signature (NSMethodSignature *info);
 
+extern NSMutableData *cifframe_copy (NSMutableData *frame);
+
 extern GSCodeBuffer* cifframe_closure (NSMethodSignature *sig, void (*func)());
 
 extern void cifframe_set_arg(cifframe_t *cframe, int index, void *buffer, 
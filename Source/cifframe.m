@@ -39,8 +39,10 @@
 #include "cifframe.h"
 #import "Foundation/NSException.h"
 #import "Foundation/NSData.h"
+#import "Foundation/NSMapTable.h"
 #import "GSInvocation.h"
 #import "GSPrivate.h"
+#import "GSPThread.h"
 
 #if defined(ALPHA) || (defined(MIPS) && (_MIPS_SIM == _ABIN32))
 typedef long long smallret_t;
@@ -129,8 +131,8 @@ cifframe_guess_struct_size(ffi_type *stype)
 }
 
 
-NSMutableData *
-cifframe_from_signature (NSMethodSignature *info)
+static NSMutableData *
+cifframe_build (NSMethodSignature *info)
 {
   unsigned      size = sizeof(cifframe_t);
   unsigned      align = __alignof(double);
@@ -144,10 +146,11 @@ cifframe_from_signature (NSMethodSignature *info)
   ffi_type      *arg_types[numargs];
   cifframe_t    *cframe;
 
-  /* FIXME: in cifframe_type, return values/arguments that are structures
-     have custom ffi_types with are allocated separately. We should allocate
-     them in our cifframe so we don't leak memory. Or maybe we could
-     cache structure types? */
+  /* NB. in cifframe_type, return values/arguments that are structures
+     have custom ffi_types which are allocated separately and never freed.
+     Since frames are only built once for each type signature (see
+     cifframe_from_signature() below), this costs a fixed amount of memory
+     per signature. */
   rtype = cifframe_type([info methodReturnType], NULL);
   for (i = 0; i < numargs; i++)
     {
@@ -229,6 +232,131 @@ cifframe_from_signature (NSMethodSignature *info)
   return result;
 }
 
+/* Prepared frames and closures are cached by method type string, since
+ * parsing the types and preparing the cif is expensive and the same
+ * signatures are used over and over again (eg when forwarding messages
+ * to a proxy).  Cached entries are never removed.
+ */
+typedef struct _cifclosure_t {
+  struct _cifclosure_t	*next;
+  void			(*cb)();
+  GSCodeBuffer		*memory;
+} cifclosure_t;
+
+typedef struct _cifcache_t {
+  NSMutableData		*frame;		// Template ... never modified.
+  cifclosure_t		*closures;	// Closures using the template.
+} cifcache_t;
+
+static pthread_mutex_t	cacheLock = PTHREAD_MUTEX_INITIALIZER;
+static NSMapTable	*cache = 0;
+
+static NSUInteger
+types_hash(NSMapTable *t, const void *k)
+{
+  return GSPrivateHash(0, k, strlen((const char*)k));
+}
+
+static BOOL
+types_is_equal(NSMapTable *t, const void *k1, const void *k2)
+{
+  return (strcmp((const char*)k1, (const char*)k2) == 0) ? YES : NO;
+}
+
+static const NSMapTableKeyCallBacks typesKeyCallBacks =
+{
+  types_hash,
+  types_is_equal,
+  0,
+  0,
+  0,
+  NSNotAPointerMapKey
+};
+
+/* Return the cache entry for the signature, creating it if necessary,
+ * or a null pointer if a frame can not be built for the signature.
+ */
+static cifcache_t *
+cifframe_cache_entry (NSMethodSignature *info)
+{
+  const char	*types = [info methodType];
+  cifcache_t	*entry;
+
+  pthread_mutex_lock(&cacheLock);
+  if (0 == cache)
+    {
+      cache = NSCreateMapTable(typesKeyCallBacks,
+	NSNonOwnedPointerMapValueCallBacks, 64);
+    }
+  entry = (cifcache_t*)NSMapGet(cache, types);
+  pthread_mutex_unlock(&cacheLock);
+
+  if (0 == entry)
+    {
+      NSMutableData	*frame;
+
+      /* Build the frame without holding the lock (it may raise an
+       * exception), then add it unless another thread beat us to it.
+       */
+      frame = cifframe_build(info);
+      if (nil == frame)
+	{
+	  return 0;
+	}
+      pthread_mutex_lock(&cacheLock);
+      entry = (cifcache_t*)NSMapGet(cache, types);
+      if (0 == entry)
+	{
+	  char	*key = malloc(strlen(types) + 1);
+
+	  strcpy(key, types);
+	  entry = calloc(1, sizeof(cifcache_t));
+	  entry->frame = RETAIN(frame);
+	  NSMapInsertKnownAbsent(cache, key, entry);
+	}
+      pthread_mutex_unlock(&cacheLock);
+    }
+  return entry;
+}
+
+/* Make a private copy of a frame, adjusting the internal pointers
+ * so that they refer to the new buffer.
+ */
+NSMutableData *
+cifframe_copy (NSMutableData *frame)
+{
+  NSUInteger	length = [frame length];
+  const char	*old = [frame bytes];
+  NSMutableData	*result;
+  cifframe_t	*cframe;
+  char		*buf;
+  int		i;
+
+  result = [NSMutableData dataWithBytes: old length: length];
+  buf = [result mutableBytes];
+  cframe = (cifframe_t*)buf;
+  cframe->arg_types = (ffi_type**)(buf + ((char*)cframe->arg_types - old));
+  cframe->values = (void**)(buf + ((char*)cframe->values - old));
+  for (i = 0; i < cframe->nargs; i++)
+    {
+      cframe->values[i] = buf + ((char*)cframe->values[i] - old);
+    }
+  cframe->cif.arg_types = cframe->arg_types;
+  return result;
+}
+
+NSMutableData *
+cifframe_from_signature (NSMethodSignature *info)
+{
+  cifcache_t	*entry = cifframe_cache_entry(info);
+
+  if (0 == entry)
+    {
+      return nil;
+    }
+  return cifframe_copy(entry->frame);
+}
+
 void
 cifframe_set_arg(cifframe_t *cframe, int index, void *buffer, int size)
 {
@@ -537,12 +665,35 @@ cifframe_closure (NSMethodSignature *sig, void (*cb)())
   cifframe_t            *cframe;
   ffi_closure           *cclosure;
   void			*executable;
-  GSCodeBuffer          *memory;
+  GSCodeBuffer          *memory = nil;
+  cifcache_t		*entry;
+  cifclosure_t		*c;
 
-  /* Construct the frame (stored in an NSMutableDate object) and sety it
-   * in a new closure.
+  /* Closures are shared by all callers using the same signature and
+   * callback, so the callback gets the template frame as its user data
+   * and must copy it (using cifframe_copy()) if it needs a frame.
    */
-  frame = cifframe_from_signature(sig);
+  entry = cifframe_cache_entry(sig);
+  if (0 == entry)
+    {
+      [NSException raise: NSMallocException format: @"Allocating closure"];
+    }
+  pthread_mutex_lock(&cacheLock);
+  for (c = entry->closures; c != 0; c = c->next)
+    {
+      if (c->cb == cb)
+	{
+	  memory = c->memory;
+	  break;
+	}
+    }
+  pthread_mutex_unlock(&cacheLock);
+  if (nil != memory)
+    {
+      return memory;
+    }
+
+  frame = entry->frame;
   cframe = [frame mutableBytes];
   memory = [GSCodeBuffer memoryWithSize: sizeof(ffi_closure)];
   [memory setFrame: frame];
@@ -567,6 +718,28 @@ cifframe_closure (NSMethodSignature *sig, void (*cb)())
     }
 #endif
   [memory protect];
+
+  /* Add the new closure to the cache unless another thread has done so
+   * while we were building it, in which case we use that one instead.
+   */
+  pthread_mutex_lock(&cacheLock);
+  for (c = entry->closures; c != 0; c = c->next)
+    {
+      if (c->cb == cb)
+	{
+	  break;
+	}
+    }
+  if (0 == c)
+    {
+      c = malloc(sizeof(cifclosure_t));
+      c->cb = cb;
+      c->memory = RETAIN(memory);
+      c->next = entry->closures;
+      entry->closures = c;
+    }
+  memory = c->memory;
+  pthread_mutex_unlock(&cacheLock);
   return memory;
 }
 
@@ -29,6 +29,30 @@
 
 #define	FDCOUNT	1024
 
+/* Counts the events a poll found and times how long the loop spends
+ * handling them, for the per-thread statistics reported by GSRunLoopPool.
+ * Nothing is timed when a poll simply times out.
+ */
+static inline NSTimeInterval
+startHandling(GSRunLoopThreadInfo *info, int ready, unsigned triggers)
+{
+  if (ready <= 0 && triggers == 0)
+    {
+      return 0.0;
+    }
+  info->events += (ready > 0 ? ready : 0) + triggers;
+  return GSPrivateTimeNow();
+}
+
+static inline void
+endHandling(GSRunLoopThreadInfo *info, NSTimeInterval start)
+{
+  if (start > 0.0)
+    {
+      info->busy += GSPrivateTimeNow() - start;
+    }
+}
+
 #if	GS_WITH_GC == 0
 static SEL	wRelSel;
 static SEL	wRetSel;
@@ -74,7 +98,7 @@ static const NSMapTableValueCallBacks WatcherMapValueCallBacks =
   RELEASE(mode);
   GSIArrayEmpty(performers);
   NSZoneFree(performers->zone, (void*)performers);
-  GSIArrayEmpty(timers);
+  GSTimerHeapEmpty(timers);
   NSZoneFree(timers->zone, (void*)timers);
   GSIArrayEmpty(watchers);
   NSZoneFree(watchers->zone, (void*)watchers);
@@ -179,18 +203,18 @@ static const NSMapTableValueCallBacks WatcherMapValueCallBacks =
 #if	GS_WITH_GC
       z = (NSZone*)1;
       performers = NSAllocateCollectable(sizeof(GSIArray_t), NSScannedOption);
-      timers = NSAllocateCollectable(sizeof(GSIArray_t), NSScannedOption);
+      timers = NSAllocateCollectable(sizeof(GSTimerHeap_t), NSScannedOption);
       watchers = NSAllocateCollectable(sizeof(GSIArray_t), NSScannedOption);
       _trigger = NSAllocateCollectable(sizeof(GSIArray_t), NSScannedOption);
 #else
       z = [self zone];
       performers = NSZoneMalloc(z, sizeof(GSIArray_t));
-      timers = NSZoneMalloc(z, sizeof(GSIArray_t));
+      timers = NSZoneMalloc(z, sizeof(GSTimerHeap_t));
       watchers = NSZoneMalloc(z, sizeof(GSIArray_t));
       _trigger = NSZoneMalloc(z, sizeof(GSIArray_t));
 #endif
       GSIArrayInitWithZoneAndCapacity(performers, z, 8);
-      GSIArrayInitWithZoneAndCapacity(timers, z, 8);
+      GSTimerHeapInitWithZone(timers, z);
       GSIArrayInitWithZoneAndCapacity(watchers, z, 8);
       GSIArrayInitWithZoneAndCapacity(_trigger, z, 8);
 
@@ -284,6 +308,7 @@ static void setPollfd(int fd, int event, GSRunLoopCtxt *ctxt)
   unsigned	count;
   unsigned int	i;
   BOOL		immediate = NO;
+  NSTimeInterval	start;
 
   i = GSIArrayCount(watchers);
 
@@ -467,6 +492,7 @@ static void setPollfd(int fd, int event, GSRunLoopCtxt *ctxt)
    * Trigger any watchers which are set up to for every runloop wait.
    */
   count =  GSIArrayCount(_trigger);
+  start = startHandling(threadInfo, poll_return, count);
   while (count-- > 0)
     {
       GSRunLoopWatcher	*watcher;
@@ -502,6 +528,7 @@ static void setPollfd(int fd, int event, GSRunLoopCtxt *ctxt)
   if (poll_return == 0)
     {
       completed = YES;
+      endHandling(threadInfo, start);
       return NO;
     }
 
@@ -663,6 +690,7 @@ static void setPollfd(int fd, int event, GSRunLoopCtxt *ctxt)
 	}
     }
   completed = YES;
+  endHandling(threadInfo, start);
   return YES;
 }
 
@@ -705,6 +733,7 @@ static void setPollfd(int fd, int event, GSRunLoopCtxt *ctxt)
   unsigned		count;
   unsigned		i;
   BOOL			immediate = NO;
+  NSTimeInterval	start;
 
   i = GSIArrayCount(watchers);
 
@@ -885,6 +914,7 @@ static void setPollfd(int fd, int event, GSRunLoopCtxt *ctxt)
    * Trigger any watchers which are set up to for every runloop wait.
    */
   count = GSIArrayCount(_trigger);
+  start = startHandling(threadInfo, select_return, count);
   while (count-- > 0)
     {
       GSRunLoopWatcher	*watcher;
@@ -920,6 +950,7 @@ static void setPollfd(int fd, int event, GSRunLoopCtxt *ctxt)
   if (select_return == 0)
     {
       completed = YES;
+      endHandling(threadInfo, start);
       return NO;
     }
 
@@ -1066,6 +1097,7 @@ static void setPollfd(int fd, int event, GSRunLoopCtxt *ctxt)
 	}
     }
   completed = YES;
+  endHandling(threadInfo, start);
   return YES;
 }
 
@@ -0,0 +1,89 @@
+#import <Foundation/Foundation.h>
+#import "Testing.h"
+#include <fcntl.h>
+#include <unistd.h>
+#if	!defined(_WIN32)
+#include <sys/wait.h>
+#endif
+
+#define	LINES	2000
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSUserDefaults	*defs = [NSUserDefaults standardUserDefaults];
+  NSString		*path;
+  NSString		*text;
+  NSArray		*lines;
+  NSUInteger		dropped = 0;
+  NSUInteger		found = 0;
+  NSUInteger		last = 0;
+  NSUInteger		i;
+  BOOL			ordered = YES;
+  int			old = _NSLogDescriptor;
+  int			fd;
+
+  path = [NSTemporaryDirectory() stringByAppendingPathComponent:
+    [NSString stringWithFormat: @"NSLog%d.txt", getpid()]];
+  fd = open([path fileSystemRepresentation], O_CREAT|O_TRUNC|O_WRONLY, 0600);
+  PASS(fd >= 0, "a log file is created");
+  _NSLogDescriptor = fd;
+
+  [defs setBool: YES forKey: @"GSLogAsynchronous"];
+  GSLogCounters(0, 0, 0, &dropped);
+  for (i = 0; i < LINES; i++)
+    {
+      NSLog(@"line %lu %@", (unsigned long)i, (i % 100 == 0)
+	? [@"" stringByPaddingToLength: 1000 withString: @"x" startingAtIndex: 0]
+	: @"");
+    }
+  GSLogFlush();
+  GSLogCounters(0, 0, 0, &i);
+  dropped = i - dropped;
+
+#if	!defined(_WIN32)
+  if (fork() == 0)
+    {
+      NSLog(@"child");
+      exit(0);
+    }
+  wait(0);
+#endif
+
+  _NSLogDescriptor = old;
+  [defs removeObjectForKey: @"GSLogAsynchronous"];
+  close(fd);
+
+  text = [NSString stringWithContentsOfFile: path];
+  lines = [text componentsSeparatedByString: @"\n"];
+  for (i = 0; i < [lines count]; i++)
+    {
+      NSString	*l = [lines objectAtIndex: i];
+      NSRange	r = [l rangeOfString: @" line "];
+
+      if (r.length > 0)
+	{
+	  NSUInteger	n = [[l substringFromIndex: NSMaxRange(r)] intValue];
+
+	  if (found > 0 && n <= last)
+	    {
+	      ordered = NO;
+	    }
+	  last = n;
+	  found++;
+	}
+    }
+  PASS(found + dropped == LINES && ordered,
+    "all lines logged asynchronously are written in order by GSLogFlush()");
+  testHopeful = YES;
+  PASS(dropped == 0, "no lines are dropped");
+  testHopeful = NO;
+#if	!defined(_WIN32)
+  PASS([text hasSuffix: @" child\n"],
+    "a forked child process logs asynchronously");
+#endif
+  [[NSFileManager defaultManager] removeFileAtPath: path handler: nil];
+
+  [arp release]; arp = nil;
+  return 0;
+}
@@ -0,0 +1,311 @@
+#if     defined(GNUSTEP_BASE_LIBRARY)
+#import <Foundation/Foundation.h>
+#import <GNUstepBase/GSHTTPServer.h>
+#import "Testing.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/* Checks the server over loopback using plain blocking sockets, so that
+ * what goes over the wire is exactly what the test sends.
+ */
+@interface	Handler : NSObject
+@end
+@implementation	Handler
+- (void) HTTPServer: (GSHTTPServer*)server
+      handleRequest: (GSHTTPServerRequest*)request
+{
+  NSString	*path = [request path];
+
+  if ([path isEqual: @"/echo"])
+    {
+      [request respondWithStatus: 200 data: [request body]];
+    }
+  else if ([path isEqual: @"/chunked"])
+    {
+      [request sendBodyData: [@"part1" dataUsingEncoding: NSASCIIStringEncoding]];
+      [request sendBodyData: [@"part2" dataUsingEncoding: NSASCIIStringEncoding]];
+      [request finish];
+    }
+  else
+    {
+      NSString	*s = [NSString stringWithFormat: @"%@ %@",
+	[request method], path];
+
+      [request respondWithStatus: 200
+			    data: [s dataUsingEncoding: NSASCIIStringEncoding]];
+    }
+}
+@end
+
+static int
+connectTo(NSInteger port)
+{
+  struct sockaddr_in	sin;
+  struct timeval	tv = { 5, 0 };
+  int			fd = socket(AF_INET, SOCK_STREAM, 0);
+
+  memset(&sin, '\0', sizeof(sin));
+  sin.sin_family = AF_INET;
+  sin.sin_port = htons((uint16_t)port);
+  sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, (char*)&tv, sizeof(tv));
+  if (connect(fd, (struct sockaddr*)&sin, sizeof(sin)) < 0)
+    {
+      close(fd);
+      return -1;
+    }
+  return fd;
+}
+
+static void
+sendString(int fd, const char *s)
+{
+  write(fd, s, strlen(s));
+}
+
+/* Reads a line (without its CRLF) a byte at a time, so that nothing
+ * beyond the current response is consumed.
+ */
+static NSString *
+readLine(int fd)
+{
+  NSMutableString	*s = [NSMutableString string];
+  char			c;
+
+  while (read(fd, &c, 1) == 1)
+    {
+      if (c == '\n')
+	{
+	  if ([s hasSuffix: @"\r"])
+	    {
+	      [s deleteCharactersInRange: NSMakeRange([s length] - 1, 1)];
+	    }
+	  return s;
+	}
+      [s appendFormat: @"%c", c];
+    }
+  return nil;
+}
+
+static NSString *
+readBytes(int fd, NSUInteger length)
+{
+  NSMutableData	*d = [NSMutableData dataWithLength: length];
+  NSUInteger	got = 0;
+
+  while (got < length)
+    {
+      ssize_t	n = read(fd, [d mutableBytes] + got, length - got);
+
+      if (n <= 0)
+	{
+	  return nil;
+	}
+      got += n;
+    }
+  return AUTORELEASE([[NSString alloc] initWithData: d
+					   encoding: NSASCIIStringEncoding]);
+}
+
+/* Reads a response, returning the body and setting the status code and
+ * whether the body was chunked.
+ */
+static NSString *
+readResponse(int fd, int *status, BOOL *chunked)
+{
+  NSString	*line = readLine(fd);
+  NSInteger	length = -1;
+
+  *status = 0;
+  *chunked = NO;
+  if ([line hasPrefix: @"HTTP/1.1 "] == NO)
+    {
+      return nil;
+    }
+  *status = [[line substringFromIndex: 9] intValue];
+  while ([(line = readLine(fd)) length] > 0)
+    {
+      NSString	*lower = [line lowercaseString];
+
+      if ([lower hasPrefix: @"content-length:"])
+	{
+	  length = [[line substringFromIndex: 15] intValue];
+	}
+      else if ([lower isEqual: @"transfer-encoding: chunked"])
+	{
+	  *chunked = YES;
+	}
+    }
+  if (line == nil)
+    {
+      return nil;
+    }
+  if (*chunked == YES)
+    {
+      NSMutableString	*body = [NSMutableString string];
+      unsigned		size;
+
+      while ((line = readLine(fd)) != nil
+	&& sscanf([line UTF8String], "%x", &size) == 1 && size > 0)
+	{
+	  [body appendString: readBytes(fd, size)];
+	  readLine(fd);
+	}
+      readLine(fd);
+      return body;
+    }
+  return (length > 0) ? readBytes(fd, length) : @"";
+}
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  Handler		*handler = AUTORELEASE([Handler new]);
+  GSHTTPServer		*server;
+  NSString		*body;
+  NSInteger		port;
+  int			status;
+  BOOL			chunked;
+  BOOL			ok;
+  char			c;
+  int			fd;
+  int			i;
+
+  server = AUTORELEASE([[GSHTTPServer alloc]
+    initWithAddress: @"127.0.0.1" port: 0]);
+  [server setDelegate: handler];
+  [server setWorkers: 2];
+  PASS([server maxBodySize] > 0, "request bodies are limited by default");
+  [server setMaxBodySize: 16];
+  PASS([server start], "the server starts");
+  port = [server port];
+  PASS(port > 0, "the server reports the port chosen for it");
+
+  fd = connectTo(port);
+  sendString(fd, "GET /one HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  body = readResponse(fd, &status, &chunked);
+  PASS(status == 200 && [body isEqual: @"GET /one"], "a simple GET works");
+  sendString(fd, "GET /two HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  body = readResponse(fd, &status, &chunked);
+  PASS(status == 200 && [body isEqual: @"GET /two"],
+    "the connection is kept alive for another request");
+
+  sendString(fd, "GET /a HTTP/1.1\r\n\r\nHEAD /b HTTP/1.1\r\n\r\n"
+    "GET /c HTTP/1.1\r\n\r\n");
+  ok = [readResponse(fd, &status, &chunked) isEqual: @"GET /a"];
+  readLine(fd);	/* HEAD response has headers only */
+  while ([readLine(fd) length] > 0)
+    ;
+  ok = ok && [readResponse(fd, &status, &chunked) isEqual: @"GET /c"];
+  PASS(ok, "pipelined requests are answered in order");
+
+  sendString(fd, "POST /echo HTTP/1.1\r\nContent-Length: 11\r\n\r\nhello");
+  sendString(fd, " world");
+  body = readResponse(fd, &status, &chunked);
+  PASS_EQUAL(body, @"hello world", "a body with a Content-Length is read");
+
+  sendString(fd, "POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+    "5\r\nhello\r\n6;ext=1\r\n world\r\n0\r\nTrailer: x\r\n\r\n");
+  body = readResponse(fd, &status, &chunked);
+  PASS_EQUAL(body, @"hello world", "a chunked request body is decoded");
+
+  sendString(fd, "POST /echo HTTP/1.1\r\nContent-Length: 2\r\n"
+    "Expect: 100-continue\r\n\r\n");
+  PASS_EQUAL(readLine(fd), @"HTTP/1.1 100 Continue",
+    "Expect: 100-continue is answered");
+  readLine(fd);
+  sendString(fd, "ok");
+  body = readResponse(fd, &status, &chunked);
+  PASS_EQUAL(body, @"ok", "and the body is then read");
+
+  sendString(fd, "GET /chunked HTTP/1.1\r\n\r\n");
+  body = readResponse(fd, &status, &chunked);
+  PASS(chunked && [body isEqual: @"part1part2"],
+    "a streamed response uses chunked encoding");
+
+  sendString(fd, "GET /last HTTP/1.1\r\nConnection: close\r\n\r\n");
+  body = readResponse(fd, &status, &chunked);
+  PASS([body isEqual: @"GET /last"] && read(fd, &c, 1) == 0,
+    "the connection is closed when the client asks");
+  close(fd);
+
+  fd = connectTo(port);
+  sendString(fd, "GET /old HTTP/1.0\r\n\r\n");
+  body = readResponse(fd, &status, &chunked);
+  PASS([body isEqual: @"GET /old"] && read(fd, &c, 1) == 0,
+    "an HTTP/1.0 connection is closed after the response");
+  close(fd);
+
+  fd = connectTo(port);
+  sendString(fd, "NONSENSE\r\n\r\n");
+  readResponse(fd, &status, &chunked);
+  PASS(status == 400 && read(fd, &c, 1) == 0,
+    "a malformed request gets a 400 response and the connection closes");
+  close(fd);
+
+  fd = connectTo(port);
+  sendString(fd, "POST /echo HTTP/1.1\r\nContent-Length: 17\r\n\r\n");
+  readResponse(fd, &status, &chunked);
+  PASS(status == 413 && read(fd, &c, 1) == 0,
+    "a Content-Length over the limit gets a 413 response");
+  close(fd);
+
+  fd = connectTo(port);
+  sendString(fd, "POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+    "a\r\n0123456789\r\n7\r\n");
+  readResponse(fd, &status, &chunked);
+  PASS(status == 413 && read(fd, &c, 1) == 0,
+    "a chunked body growing over the limit gets a 413 response");
+  close(fd);
+
+  fd = connectTo(port);
+  sendString(fd, "POST /echo HTTP/1.1\r\nTransfer-Encoding: xchunked\r\n\r\n"
+    "2\r\nok\r\n0\r\n\r\n");
+  readResponse(fd, &status, &chunked);
+  PASS(status == 400, "a coding merely ending in chunked is rejected");
+  close(fd);
+
+  fd = connectTo(port);
+  sendString(fd, "POST /echo HTTP/1.1\r\nTransfer-Encoding: Chunked\r\n\r\n"
+    "2\r\nok\r\n0\r\n\r\n");
+  body = readResponse(fd, &status, &chunked);
+  PASS_EQUAL(body, @"ok", "the chunked coding is matched case insensitively");
+  close(fd);
+
+  PASS([[[server statistics] objectForKey: @"Requests"] intValue] == 12,
+    "the server counts the requests handled");
+  [server stop];
+  fd = connectTo(port);
+  PASS(fd < 0, "the server stops listening");
+  if (fd >= 0) close(fd);
+
+  server = AUTORELEASE([[GSHTTPServer alloc]
+    initWithAddress: @"127.0.0.1" port: 0]);
+  [server setDelegate: handler];
+  [server setWorkers: 4];
+  [server setReusePort: YES];
+  PASS([server start], "a server with a listener per worker starts");
+  ok = YES;
+  for (i = 0; i < 20 && ok; i++)
+    {
+      fd = connectTo([server port]);
+      sendString(fd, "GET /shard HTTP/1.1\r\n\r\n");
+      ok = [readResponse(fd, &status, &chunked) isEqual: @"GET /shard"];
+      close(fd);
+    }
+  PASS(ok, "connections are handled whichever listener accepts them");
+  [server stop];
+
+  [arp release]; arp = nil;
+  return 0;
+}
+#else
+int main(int argc,char **argv)
+{
+  return 0;
+}
+#endif
@@ -0,0 +1,132 @@
+#if     defined(GNUSTEP_BASE_LIBRARY)
+#import <Foundation/Foundation.h>
+#import <GNUstepBase/GSMime.h>
+#import "Testing.h"
+
+/* A parser which handles headers itself, to check that the fast path
+ * for simple headers does not bypass an overridden method.
+ */
+@interface	CountingParser : GSMimeParser
+{
+@public
+  unsigned	count;
+}
+@end
+@implementation	CountingParser
+- (BOOL) scanHeaderBody: (NSScanner*)scanner into: (GSMimeHeader*)info
+{
+  count++;
+  return [super scanHeaderBody: scanner into: info];
+}
+@end
+
+static const char *headers =
+  "HTTP/1.1 200 OK\r\n"
+  "Date: Thu, 02 Oct 2008 17:07:20 GMT\r\n"
+  "SERVER: Test/1.0\r\n"
+  "x-custom-header:  spaced value \r\n"
+  "Empty:\r\n"
+  "Folded: first\r\n"
+  "\tsecond\r\n"
+  "Subject: =?utf-8?q?caf=C3=A9?=\r\n"
+  "Content-Type: text/plain; charset=utf-8\r\n"
+  "content-length: 5\r\n"
+  "\r\n"
+  "hello";
+
+static GSMimeDocument *
+parse(GSMimeParser *parser, BOOL byteAtATime)
+{
+  NSData	*data;
+  unsigned	length = strlen(headers);
+  unsigned	index;
+
+  if (NO == byteAtATime)
+    {
+      data = [NSData dataWithBytes: headers length: length];
+      [parser parse: data];
+    }
+  else
+    {
+      for (index = 0; index < length; index++)
+	{
+	  data = [NSData dataWithBytes: headers + index length: 1];
+	  if ([parser parse: data] == NO)
+	    {
+	      break;
+	    }
+	}
+    }
+  return [parser mimeDocument];
+}
+
+static void
+check(GSMimeDocument *doc, NSString *how)
+{
+  GSMimeHeader	*hdr;
+
+  hdr = [doc headerNamed: @"Date"];
+  PASS_EQUAL([hdr value], @"Thu, 02 Oct 2008 17:07:20 GMT",
+    "%s: a well known header has its value", [how UTF8String]);
+  PASS_EQUAL([hdr name], @"date",
+    "%s: its name is lowercase", [how UTF8String]);
+  PASS_EQUAL([hdr namePreservingCase: YES], @"Date",
+    "%s: and its original case is kept", [how UTF8String]);
+
+  hdr = [doc headerNamed: @"server"];
+  PASS_EQUAL([hdr namePreservingCase: YES], @"SERVER",
+    "%s: an unusual case is kept", [how UTF8String]);
+  PASS_EQUAL([hdr name], @"server",
+    "%s: and lowercased", [how UTF8String]);
+
+  hdr = [doc headerNamed: @"X-Custom-Header"];
+  PASS_EQUAL([hdr value], @"spaced value ",
+    "%s: an unknown header has its value", [how UTF8String]);
+  PASS_EQUAL([hdr namePreservingCase: YES], @"x-custom-header",
+    "%s: and its name", [how UTF8String]);
+
+  PASS_EQUAL([[doc headerNamed: @"empty"] value], @"",
+    "%s: an empty value is parsed", [how UTF8String]);
+  PASS_EQUAL([[doc headerNamed: @"folded"] value], @"first second",
+    "%s: a folded header is unfolded", [how UTF8String]);
+  PASS_EQUAL([[doc headerNamed: @"subject"] value],
+    [NSString stringWithUTF8String: "caf\xc3\xa9"],
+    "%s: an encoded word is decoded", [how UTF8String]);
+  PASS_EQUAL([doc contentType], @"text",
+    "%s: the content type is parsed", [how UTF8String]);
+  PASS_EQUAL([[doc headerNamed: @"content-type"]
+    parameterForKey: @"charset"], @"utf-8",
+    "%s: with its parameters", [how UTF8String]);
+  PASS_EQUAL([[doc headerNamed: @"Content-Length"] value], @"5",
+    "%s: content-length is found in any case", [how UTF8String]);
+  PASS([[[doc headerNamed: @"http"]
+    objectForKey: NSHTTPPropertyStatusCodeKey] intValue] == 200,
+    "%s: the status line is parsed", [how UTF8String]);
+  PASS_EQUAL([doc convertToText], @"hello",
+    "%s: the body follows the headers", [how UTF8String]);
+  PASS([[doc allHeaders] count] == 9,
+    "%s: all the headers are present", [how UTF8String]);
+}
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  CountingParser	*counting;
+
+  check(parse([GSMimeParser mimeParser], NO), @"in one go");
+  check(parse([GSMimeParser mimeParser], YES), @"a byte at a time");
+
+  counting = [CountingParser mimeParser];
+  check(parse(counting, NO), @"subclass");
+  PASS(counting->count == 9,
+    "an overridden -scanHeaderBody:into: sees every header");
+
+  [arp release]; arp = nil;
+  return 0;
+}
+#else
+int main(int argc,char **argv)
+{
+  return 0;
+}
+#endif
@@ -0,0 +1,158 @@
+#if     defined(GNUSTEP_BASE_LIBRARY)
+#import <Foundation/Foundation.h>
+#import <GNUstepBase/GSRunLoopPool.h>
+#import <GNUstepBase/NSStream+GNUstepBase.h>
+#import "Testing.h"
+
+/* Records the thread in which stream events (or a scheduled message)
+ * arrive.
+ */
+@interface	Reader : NSObject
+{
+@public
+  NSThread	*thread;
+  NSUInteger	bytes;
+}
+@end
+@implementation	Reader
+- (void) stream: (NSStream*)s handleEvent: (NSStreamEvent)e
+{
+  if (e == NSStreamEventHasBytesAvailable)
+    {
+      uint8_t	buf[64];
+      NSInteger	n = [(NSInputStream*)s read: buf maxLength: sizeof(buf)];
+
+      thread = [NSThread currentThread];
+      if (n > 0)
+	{
+	  bytes += n;
+	}
+    }
+}
+- (void) start: (id)arg
+{
+  thread = [NSThread currentThread];
+}
+@end
+
+static BOOL
+waitFor(Reader *r, NSUInteger bytes)
+{
+  int	i;
+
+  for (i = 0; i < 500 && r->bytes < bytes; i++)
+    {
+      [NSThread sleepForTimeInterval: 0.01];
+    }
+  return r->bytes == bytes;
+}
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  GSRunLoopPool		*pool;
+  GSRunLoopPool		*p2;
+  Reader		*r1 = AUTORELEASE([Reader new]);
+  Reader		*r2 = AUTORELEASE([Reader new]);
+  Reader		*r3 = AUTORELEASE([Reader new]);
+  NSInputStream		*i1;
+  NSInputStream		*i2;
+  NSOutputStream	*o1;
+  NSOutputStream	*o2;
+  NSArray		*stats;
+  NSUInteger		l1;
+  NSUInteger		l2;
+  NSUInteger		l3;
+  int			n;
+
+  pool = AUTORELEASE([[GSRunLoopPool alloc] initWithCount: 2 name: @"test"]);
+  PASS([pool count] == 2, "a pool has the requested number of loops");
+  PASS([pool runLoopAtIndex: 0] != nil && [pool runLoopAtIndex: 1] != nil
+    && [pool runLoopAtIndex: 0] != [pool runLoopAtIndex: 1],
+    "each loop has its own run loop");
+
+  [NSStream pipeWithInputStream: &i1 outputStream: &o1];
+  [NSStream pipeWithInputStream: &i2 outputStream: &o2];
+  [i1 setDelegate: r1];
+  [i2 setDelegate: r2];
+  [o1 open];
+  [o2 open];
+  l1 = [pool scheduleStream: i1];
+  l2 = [pool scheduleStream: i2];
+  PASS(l1 != l2, "streams are spread over the least loaded loops");
+  PASS([pool loopForObject: i1] == l1, "the pool knows where a stream is");
+
+  [o1 write: (const uint8_t*)"abc" maxLength: 3];
+  PASS(waitFor(r1, 3), "a stream opened by the pool receives data");
+  PASS(r1->thread == [pool threadAtIndex: l1],
+    "stream events happen in the thread of its loop");
+
+  [pool moveStream: i1 toLoop: l2];
+  PASS([pool loopForObject: i1] == l2, "a stream can be moved");
+  [o1 write: (const uint8_t*)"de" maxLength: 2];
+  PASS(waitFor(r1, 5), "a moved stream still receives data");
+  PASS(r1->thread == [pool threadAtIndex: l2],
+    "and its events happen in the thread of its new loop");
+  PASS([pool leastLoadedLoop] == l1, "the emptied loop is least loaded");
+
+  [o2 write: (const uint8_t*)"xyz" maxLength: 3];
+  PASS(waitFor(r2, 3), "the other stream in the loop is unaffected");
+
+  stats = [pool statistics];
+  PASS([stats count] == 2, "there are statistics for each loop");
+  n = [[[stats objectAtIndex: l2] objectForKey: @"Objects"] intValue];
+  PASS(n == 2, "the statistics count objects in a loop");
+  PASS([[[stats objectAtIndex: l2] objectForKey: @"Events"] intValue] > 0,
+    "the statistics count events handled");
+  PASS([[stats objectAtIndex: l2] objectForKey: @"QueueDepth"] != nil
+    && [[stats objectAtIndex: l2] objectForKey: @"Busy"] != nil
+    && [[stats objectAtIndex: l2] objectForKey: @"EventsPerSecond"] != nil,
+    "the statistics include queue depth, busy fraction and event rate");
+
+  [pool unscheduleObject: i1];
+  PASS([pool loopForObject: i1] == NSNotFound, "a stream can be removed");
+  PASS_EXCEPTION([pool moveStream: i1 toLoop: l1];,
+    NSInvalidArgumentException, "a removed stream can't be moved");
+
+  l3 = [pool scheduleObject: r3 performing: @selector(start:) withObject: nil];
+  for (n = 0; n < 500 && r3->thread == nil; n++)
+    {
+      [NSThread sleepForTimeInterval: 0.01];
+    }
+  PASS(r3->thread == [pool threadAtIndex: l3],
+    "an object is sent a message in the thread of its loop");
+
+  /* A stream unscheduled while it is being moved, and scheduled again
+   * at once, ends up in the new loop alone.
+   */
+  [pool moveStream: i2 toLoop: l1];
+  [pool unscheduleObject: i2];
+  l3 = [pool scheduleStream: i2];
+  [o2 write: (const uint8_t*)"uv" maxLength: 2];
+  PASS(waitFor(r2, 5), "a stream rescheduled after removal receives data");
+  PASS(r2->thread == [pool threadAtIndex: l3]
+    && [pool loopForObject: i2] == l3,
+    "and its events happen in the thread of its new loop");
+
+  /* Releasing a pool while a move is queued must not crash.
+   */
+  p2 = [[GSRunLoopPool alloc] initWithCount: 2 name: @"test2"];
+  [p2 moveStream: i1 toLoop: ([p2 scheduleStream: i1] == 0) ? 1 : 0];
+  [p2 release];
+  [NSThread sleepForTimeInterval: 0.2];
+  PASS(YES, "a pool can be released with a move under way");
+
+  [pool unscheduleObject: i2];
+  [pool unscheduleObject: r3];
+  [pool invalidate];
+  [o1 close];
+  [o2 close];
+  [arp release]; arp = nil;
+  return 0;
+}
+#else
+int main(int argc,char **argv)
+{
+  return 0;
+}
+#endif
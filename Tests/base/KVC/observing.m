@@ -0,0 +1,201 @@
+#import "Testing.h"
+#import <Foundation/Foundation.h>
+
+/* Checks that the replacement setters installed for observed keys
+ * notify with the right key and values for each argument type.
+ */
+@interface Recorder : NSObject
+{
+@public
+  NSMutableArray	*keys;
+  NSMutableArray	*changes;
+}
+@end
+
+@implementation Recorder
+- (id) init
+{
+  keys = [NSMutableArray new];
+  changes = [NSMutableArray new];
+  return self;
+}
+- (void) dealloc
+{
+  [keys release];
+  [changes release];
+  [super dealloc];
+}
+- (void) observeValueForKeyPath: (NSString *)keyPath
+                       ofObject: (id)object
+                         change: (NSDictionary *)change
+                        context: (void *)context
+{
+  [keys addObject: keyPath];
+  [changes addObject: [[change copy] autorelease]];
+}
+@end
+
+@interface Model : NSObject
+{
+  id		name;
+  int		count;
+  double	total;
+  NSRange	range;
+  char		flag;
+}
+- (void) setName: (id)n;
+- (void) setCount: (int)c;
+- (void) setTotal: (double)t;
+- (void) setRange: (NSRange)r;
+- (void) setFlag: (char)f;
+@end
+
+@implementation Model
++ (BOOL) automaticallyNotifiesObserversForKey: (NSString*)aKey
+{
+  if ([aKey isEqualToString: @"flag"])
+    {
+      return NO;
+    }
+  return [super automaticallyNotifiesObserversForKey: aKey];
+}
+- (void) dealloc
+{
+  [name release];
+  [super dealloc];
+}
+- (void) setName: (id)n
+{
+  ASSIGN(name, n);
+}
+- (void) setCount: (int)c
+{
+  count = c;
+}
+- (void) setTotal: (double)t
+{
+  total = t;
+}
+- (void) setRange: (NSRange)r
+{
+  range = r;
+}
+- (void) setFlag: (char)f
+{
+  flag = f;
+}
+@end
+
+@interface SubModel : Model
+@end
+@implementation SubModel
+- (void) setCount: (int)c
+{
+  [super setCount: c * 2];
+}
+@end
+
+/* A class keeping its own observation information.
+ */
+@interface OwnInfo : Model
+{
+  void	*info;
+}
+@end
+@implementation OwnInfo
+- (void*) observationInfo
+{
+  return info;
+}
+- (void) setObservationInfo: (void*)i
+{
+  info = i;
+}
+@end
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSKeyValueObservingOptions	o;
+  Recorder		*r = [[Recorder new] autorelease];
+  Model			*m = [[Model new] autorelease];
+  SubModel		*s = [[SubModel new] autorelease];
+  OwnInfo		*w = [[OwnInfo new] autorelease];
+  NSDictionary		*c;
+  unsigned		i;
+
+  o = NSKeyValueObservingOptionNew | NSKeyValueObservingOptionOld;
+  [m addObserver: r forKeyPath: @"name" options: o context: 0];
+  [m addObserver: r forKeyPath: @"count" options: o context: 0];
+  [m addObserver: r forKeyPath: @"total" options: o context: 0];
+  [m addObserver: r forKeyPath: @"range" options: o context: 0];
+  [m addObserver: r forKeyPath: @"flag" options: o context: 0];
+  PASS([m class] == [Model class], "an observed object keeps its class");
+
+  [m setName: @"one"];
+  [m setName: @"two"];
+  c = [r->changes lastObject];
+  PASS([r->keys count] == 2 && [[r->keys lastObject] isEqual: @"name"]
+    && [[c objectForKey: NSKeyValueChangeOldKey] isEqual: @"one"]
+    && [[c objectForKey: NSKeyValueChangeNewKey] isEqual: @"two"],
+    "object setter notifies with old and new values");
+
+  [m setCount: 3];
+  c = [r->changes lastObject];
+  PASS([[r->keys lastObject] isEqual: @"count"]
+    && [[c objectForKey: NSKeyValueChangeNewKey] intValue] == 3,
+    "int setter notifies");
+
+  [m setTotal: 2.5];
+  c = [r->changes lastObject];
+  PASS([[r->keys lastObject] isEqual: @"total"]
+    && [[c objectForKey: NSKeyValueChangeNewKey] doubleValue] == 2.5,
+    "double setter notifies");
+
+  [m setRange: NSMakeRange(4, 2)];
+  c = [r->changes lastObject];
+  PASS([[r->keys lastObject] isEqual: @"range"]
+    && NSEqualRanges([[c objectForKey: NSKeyValueChangeNewKey] rangeValue],
+    NSMakeRange(4, 2)), "struct setter notifies");
+
+  i = [r->keys count];
+  [m setFlag: 'x'];
+  PASS([r->keys count] == i,
+    "no notification when the class does not want it automatically");
+
+  for (i = 0; i < 1000; i++)
+    {
+      [m setCount: i];
+    }
+  c = [r->changes lastObject];
+  PASS([[c objectForKey: NSKeyValueChangeOldKey] intValue] == 998
+    && [[c objectForKey: NSKeyValueChangeNewKey] intValue] == 999,
+    "repeated changes report the right values");
+
+  [r->keys removeAllObjects];
+  [s addObserver: r forKeyPath: @"count" options: o context: 0];
+  [s setCount: 5];
+  c = [r->changes lastObject];
+  PASS([r->keys count] == 1
+    && [[c objectForKey: NSKeyValueChangeNewKey] intValue] == 10,
+    "a subclass setter is observed separately");
+  [s removeObserver: r forKeyPath: @"count"];
+  [s setCount: 6];
+  PASS([r->keys count] == 1 && [s class] == [SubModel class],
+    "removing the last observer stops notification");
+
+  [w addObserver: r forKeyPath: @"name" options: o context: 0];
+  [w setName: @"own"];
+  PASS([[r->keys lastObject] isEqual: @"name"] && [r->keys count] == 2,
+    "a class storing its own observation information is notified");
+  [w removeObserver: r forKeyPath: @"name"];
+
+  [m removeObserver: r forKeyPath: @"name"];
+  [m removeObserver: r forKeyPath: @"count"];
+  [m removeObserver: r forKeyPath: @"total"];
+  [m removeObserver: r forKeyPath: @"range"];
+  [m removeObserver: r forKeyPath: @"flag"];
+
+  [arp release]; arp = nil;
+  return 0;
+}
@@ -0,0 +1,171 @@
+#import "Testing.h"
+#import <Foundation/Foundation.h>
+#include <math.h>
+#include <time.h>
+
+/* Check the calendar fields of dates (individually and in bulk) against
+ * the C library's gmtime(), and check that a date's fields follow its
+ * time zone.
+ */
+#define	COUNT	20000
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSTimeZone		*gmt = [NSTimeZone timeZoneForSecondsFromGMT: 0];
+  NSTimeZone		*east = [NSTimeZone timeZoneForSecondsFromGMT: 5400];
+  NSTimeInterval	times[COUNT];
+  GSCalendarFields	fields[COUNT];
+  NSTimeZone		*tz;
+  NSCalendarDate	*d;
+  unsigned		seed = 1;
+  BOOL			ok;
+  int			i;
+
+  for (i = 0; i < COUNT; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      /* Spread over the years 1901 to 2038 which any gmtime() handles.
+       */
+      times[i] = (double)(seed % 2000000000) * 2.0 - 3124137600.0
+	+ (double)(seed % 1000) / 1000.0;
+    }
+
+  [NSCalendarDate getFields: fields
+	   forTimeIntervals: times
+		      count: COUNT
+		   timeZone: gmt];
+  ok = YES;
+  for (i = 0; i < COUNT && ok == YES; i++)
+    {
+      time_t		t = (time_t)floor(times[i]) + 978307200;
+      struct tm		*tm = gmtime(&t);
+      GSCalendarFields	*f = &fields[i];
+
+      if (f->year != tm->tm_year + 1900 || f->month != tm->tm_mon + 1
+	|| f->day != tm->tm_mday || f->hour != tm->tm_hour
+	|| f->minute != tm->tm_min || f->second != tm->tm_sec
+	|| f->dayOfWeek != tm->tm_wday || f->dayOfYear != tm->tm_yday + 1
+	|| f->offset != 0)
+	{
+	  ok = NO;
+	}
+    }
+  PASS(ok, "+getFields:forTimeIntervals:count:timeZone: matches gmtime()");
+
+  ok = YES;
+  for (i = 0; i < COUNT && ok == YES; i += 7)
+    {
+      GSCalendarFields	*f = &fields[i];
+
+      d = [NSCalendarDate dateWithTimeIntervalSinceReferenceDate: times[i]];
+      [d setTimeZone: gmt];
+      if ([d yearOfCommonEra] != f->year || [d monthOfYear] != f->month
+	|| [d dayOfMonth] != f->day || [d hourOfDay] != f->hour
+	|| [d minuteOfHour] != f->minute || [d secondOfMinute] != f->second
+	|| [d dayOfWeek] != f->dayOfWeek || [d dayOfYear] != f->dayOfYear
+	|| [d dayOfCommonEra] != f->dayOfCommonEra)
+	{
+	  ok = NO;
+	}
+      else
+	{
+	  NSCalendarDate	*c;
+
+	  c = [NSCalendarDate dateWithYear: f->year
+				     month: f->month
+				       day: f->day
+				      hour: f->hour
+				    minute: f->minute
+				    second: f->second
+				  timeZone: gmt];
+	  if ([c timeIntervalSinceReferenceDate] != floor(times[i]))
+	    {
+	      ok = NO;
+	    }
+	}
+    }
+  PASS(ok, "accessors and +dateWithYear:... agree with the bulk fields");
+
+  [NSCalendarDate getFields: fields
+	   forTimeIntervals: times
+		      count: COUNT
+		   timeZone: east];
+  ok = YES;
+  for (i = 0; i < COUNT && ok == YES; i++)
+    {
+      GSCalendarFields	f;
+
+      [NSCalendarDate getFields: &f
+	       forTimeIntervals: &times[i]
+			  count: 1
+		       timeZone: gmt];
+      if (fields[i].offset != 5400
+	|| (fields[i].hour * 60 + fields[i].minute + 1440
+	  - f.hour * 60 - f.minute) % 1440 != 90)
+	{
+	  ok = NO;
+	}
+    }
+  PASS(ok, "bulk fields use the offset of the time zone");
+
+  /* Ascending times, each given twice, through a year in a zone with
+   * daylight saving time, so that runs in the same day and repeated
+   * times are broken down from the previous fields.
+   */
+  tz = [NSTimeZone timeZoneWithName: @"Europe/London"];
+  if (tz == nil)
+    {
+      tz = [NSTimeZone localTimeZone];
+    }
+  for (i = 0; i < COUNT; i++)
+    {
+      times[i] = 757382400.0 + (i / 2) * 1801.5;
+    }
+  [NSCalendarDate getFields: fields
+	   forTimeIntervals: times
+		      count: COUNT
+		   timeZone: tz];
+  ok = YES;
+  for (i = 0; i < COUNT && ok == YES; i++)
+    {
+      GSCalendarFields	*f = &fields[i];
+
+      d = [NSCalendarDate dateWithTimeIntervalSinceReferenceDate: times[i]];
+      [d setTimeZone: tz];
+      if ([d yearOfCommonEra] != f->year || [d monthOfYear] != f->month
+	|| [d dayOfMonth] != f->day || [d hourOfDay] != f->hour
+	|| [d minuteOfHour] != f->minute || [d secondOfMinute] != f->second
+	|| [d dayOfWeek] != f->dayOfWeek || [d dayOfYear] != f->dayOfYear
+	|| [tz secondsFromGMTForDate: d] != f->offset
+	|| f->millisecond != ((i / 2) % 2) * 500)
+	{
+	  ok = NO;
+	}
+    }
+  PASS(ok, "bulk fields of runs of times in a regional zone are correct");
+
+  d = [NSCalendarDate dateWithYear: 2000 month: 2 day: 29
+    hour: 23 minute: 30 second: 0 timeZone: gmt];
+  PASS([d dayOfMonth] == 29 && [d hourOfDay] == 23 && [d dayOfYear] == 60,
+    "fields of a leap day are correct");
+  [d setTimeZone: east];
+  PASS([d dayOfMonth] == 1 && [d monthOfYear] == 3 && [d hourOfDay] == 1
+    && [d dayOfYear] == 61,
+    "fields change with the time zone");
+  PASS_EQUAL([d descriptionWithCalendarFormat: @"%Y-%m-%d %H:%M %z %j %w"],
+    @"2000-03-01 01:00 +0130 061 3",
+    "a description uses fields in the new time zone");
+
+  d = [NSCalendarDate dateWithTimeIntervalSinceReferenceDate: 0.25];
+  [d setTimeZone: gmt];
+  PASS_EQUAL([d descriptionWithCalendarFormat: @"%H:%M:%S.%F"],
+    @"00:00:00.250", "milliseconds are formatted");
+  d = [d dateByAddingYears: 1 months: 0 days: 0 hours: 0 minutes: 0
+    seconds: 0];
+  PASS_EQUAL([d descriptionWithCalendarFormat: @"%Y %H:%M:%S.%F"],
+    @"2002 00:00:00.250", "adding a year keeps the milliseconds");
+
+  [arp release]; arp = nil;
+  return 0;
+}
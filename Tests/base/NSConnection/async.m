@@ -0,0 +1,143 @@
+#import "Testing.h"
+#import <Foundation/Foundation.h>
+
+@protocol	Adder
+- (int) add: (int)a to: (int)b;
+- (int) fail;
+@end
+
+@interface	Adder : NSObject <Adder>
+@end
+
+@implementation	Adder
+- (int) add: (int)a to: (int)b
+{
+  return a + b;
+}
+- (int) fail
+{
+  [NSException raise: NSGenericException format: @"failed"];
+  return 0;
+}
+@end
+
+static unsigned	done = 0;
+static unsigned	good = 0;
+
+static void
+waitFor(unsigned count)
+{
+  NSDate	*limit = [NSDate dateWithTimeIntervalSinceNow: 10.0];
+
+  while (done < count && [limit timeIntervalSinceNow] > 0)
+    {
+      [[NSRunLoop currentRunLoop] runMode: NSDefaultRunLoopMode
+			       beforeDate: limit];
+    }
+}
+
+int main()
+{
+  START_SET("NSConnection asynchronous")
+# ifndef __has_feature
+# define __has_feature(x) 0
+# endif
+# if __has_feature(blocks)
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSConnection		*server;
+  NSConnection		*client;
+  NSPort		*port = [NSPort port];
+  id			proxy;
+  NSMethodSignature	*sig;
+  NSInvocation		*inv;
+  int			i;
+  __block NSException	*failure = nil;
+
+  server = [[NSConnection alloc] initWithReceivePort: port sendPort: nil];
+  [server setRootObject: [[Adder new] autorelease]];
+  [server runInNewThread];
+
+  client = [NSConnection connectionWithReceivePort: [NSPort port]
+					  sendPort: port];
+  proxy = [client rootProxy];
+  [proxy setProtocolForProxy: @protocol(Adder)];
+  sig = [proxy methodSignatureForSelector: @selector(add:to:)];
+
+  for (i = 0; i < 10; i++)
+    {
+      int	j = i * 10;
+
+      inv = [NSInvocation invocationWithMethodSignature: sig];
+      [inv setSelector: @selector(add:to:)];
+      [inv setArgument: &i atIndex: 2];
+      [inv setArgument: &j atIndex: 3];
+      [client sendInvocation: inv
+		    forProxy: proxy
+		  completion: ^(NSInvocation *anInv, NSException *e) {
+	int	result;
+	int	a;
+
+	[anInv getReturnValue: &result];
+	[anInv getArgument: &a atIndex: 2];
+	if (e == nil && result == a * 11) good++;
+	done++;
+      }];
+    }
+  waitFor(10);
+  PASS(done == 10 && good == 10, "many asynchronous requests may be in flight");
+
+  [client setBatchesRequests: YES];
+  PASS([client batchesRequests], "batching of requests may be turned on");
+  done = good = 0;
+  for (i = 0; i < 100; i++)
+    {
+      int	j = i * 10;
+
+      inv = [NSInvocation invocationWithMethodSignature: sig];
+      [inv setSelector: @selector(add:to:)];
+      [inv setArgument: &i atIndex: 2];
+      [inv setArgument: &j atIndex: 3];
+      [client sendInvocation: inv
+		    forProxy: proxy
+		  completion: ^(NSInvocation *anInv, NSException *e) {
+	int	result;
+	int	a;
+
+	[anInv getReturnValue: &result];
+	[anInv getArgument: &a atIndex: 2];
+	if (e == nil && result == a * 11) good++;
+	done++;
+      }];
+    }
+  waitFor(100);
+  PASS(done == 100 && good == 100, "batched asynchronous requests complete");
+
+  PASS([proxy add: 2 to: 3] == 5,
+    "synchronous requests work while batching is on");
+
+  done = 0;
+  sig = [proxy methodSignatureForSelector: @selector(fail)];
+  inv = [NSInvocation invocationWithMethodSignature: sig];
+  [inv setSelector: @selector(fail)];
+  [client sendInvocation: inv
+		forProxy: proxy
+	      completion: ^(NSInvocation *anInv, NSException *e) {
+    failure = [e retain];
+    done++;
+  }];
+  [client flushBatchedRequests];
+  waitFor(1);
+  PASS_EQUAL([failure reason], @"failed",
+    "a remote exception is passed to the completion block");
+  [failure release];
+
+  [client invalidate];
+  [server invalidate];
+  [server release];
+  [arp release]; arp = nil;
+# else
+  SKIP("No Blocks support in the compiler.")
+# endif
+  END_SET("NSConnection asynchronous")
+  return 0;
+}
@@ -0,0 +1,93 @@
+#import "Testing.h"
+#import <Foundation/Foundation.h>
+
+@protocol	Staller
+- (int) stall;
+@end
+
+@interface	Staller : NSObject <Staller>
+@end
+
+@implementation	Staller
+- (int) stall
+{
+  [NSThread sleepForTimeInterval: 3.0];
+  return 1;
+}
+@end
+
+int main()
+{
+  START_SET("NSConnection asynchronous reply timeout")
+# ifndef __has_feature
+# define __has_feature(x) 0
+# endif
+# if __has_feature(blocks)
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSConnection		*server;
+  NSConnection		*client;
+  NSPort		*port = [NSPort port];
+  NSMethodSignature	*sig;
+  NSInvocation		*inv;
+  NSDate		*start;
+  NSDate		*limit;
+  id			proxy;
+  __block NSException	*failure = nil;
+  __block BOOL		done = NO;
+
+  server = [[NSConnection alloc] initWithReceivePort: port sendPort: nil];
+  [server setRootObject: [[Staller new] autorelease]];
+  [server runInNewThread];
+
+  client = [NSConnection connectionWithReceivePort: [NSPort port]
+					  sendPort: port];
+  proxy = [client rootProxy];
+  [proxy setProtocolForProxy: @protocol(Staller)];
+  [client setReplyTimeout: 0.5];
+
+  sig = [proxy methodSignatureForSelector: @selector(stall)];
+  inv = [NSInvocation invocationWithMethodSignature: sig];
+  [inv setSelector: @selector(stall)];
+  start = [NSDate date];
+  [client sendInvocation: inv
+		forProxy: proxy
+	      completion: ^(NSInvocation *anInv, NSException *e) {
+    failure = [e retain];
+    done = YES;
+  }];
+
+  limit = [NSDate dateWithTimeIntervalSinceNow: 2.5];
+  while (done == NO && [limit timeIntervalSinceNow] > 0)
+    {
+      [[NSRunLoop currentRunLoop] runMode: NSDefaultRunLoopMode
+			       beforeDate: limit];
+    }
+  PASS(done == YES,
+    "the completion block is called when the peer does not reply");
+  PASS_EQUAL([failure name], NSPortTimeoutException,
+    "an unanswered asynchronous request fails with a timeout");
+  PASS([[NSDate date] timeIntervalSinceDate: start] >= 0.5,
+    "the request is not failed before the reply timeout");
+  [failure release];
+
+  /* Let the late reply arrive; it must be ignored.
+   */
+  done = NO;
+  limit = [NSDate dateWithTimeIntervalSinceNow: 3.0];
+  while ([limit timeIntervalSinceNow] > 0)
+    {
+      [[NSRunLoop currentRunLoop] runMode: NSDefaultRunLoopMode
+			       beforeDate: limit];
+    }
+  PASS(done == NO, "a reply arriving after the timeout is ignored");
+
+  [client invalidate];
+  [server invalidate];
+  [server release];
+  [arp release]; arp = nil;
+# else
+  SKIP("No Blocks support in the compiler.")
+# endif
+  END_SET("NSConnection asynchronous reply timeout")
+  return 0;
+}
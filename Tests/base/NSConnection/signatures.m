@@ -0,0 +1,171 @@
+#import "Testing.h"
+#import <Foundation/Foundation.h>
+
+@interface	Vendor : NSObject
+{
+  NSMutableArray	*vended;
+}
+- (int) add: (int)a to: (int)b;
+- (id) other;
+- (id) dynamic: (BOOL)isDouble;
+@end
+
+/* Instances of this class answer -value with an int or a double,
+ * so the signature depends on the instance rather than the class.
+ */
+@interface	Dynamic : NSObject
+{
+  BOOL	isDouble;
+}
+- (id) initWithDouble: (BOOL)flag;
+@end
+
+@implementation	Dynamic
+- (void) forwardInvocation: (NSInvocation*)inv
+{
+  if (sel_isEqual([inv selector], @selector(value)))
+    {
+      if (isDouble)
+	{
+	  double	d = 2.5;
+
+	  [inv setReturnValue: &d];
+	}
+      else
+	{
+	  int	i = 7;
+
+	  [inv setReturnValue: &i];
+	}
+      return;
+    }
+  [super forwardInvocation: inv];
+}
+- (id) initWithDouble: (BOOL)flag
+{
+  isDouble = flag;
+  return self;
+}
+- (NSMethodSignature*) methodSignatureForSelector: (SEL)aSelector
+{
+  if (sel_isEqual(aSelector, @selector(value)))
+    {
+      return [NSMethodSignature signatureWithObjCTypes:
+	(isDouble ? "d@:" : "i@:")];
+    }
+  return [super methodSignatureForSelector: aSelector];
+}
+@end
+
+@implementation	Vendor
+- (int) add: (int)a to: (int)b
+{
+  return a + b;
+}
+- (void) dealloc
+{
+  [vended release];
+  [super dealloc];
+}
+- (id) other
+{
+  Vendor	*o = [[Vendor new] autorelease];
+
+  if (vended == nil)
+    {
+      vended = [NSMutableArray new];
+    }
+  [vended addObject: o];
+  return o;
+}
+- (id) dynamic: (BOOL)isDouble
+{
+  Dynamic	*o = [[[Dynamic alloc] initWithDouble: isDouble] autorelease];
+
+  if (vended == nil)
+    {
+      vended = [NSMutableArray new];
+    }
+  [vended addObject: o];
+  return o;
+}
+@end
+
+static unsigned
+requestsSent(NSConnection *c)
+{
+  return [[[c statistics] objectForKey: NSConnectionRequestsSent] intValue];
+}
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSConnection		*server;
+  NSConnection		*client;
+  NSPort		*port = [NSPort port];
+  NSMethodSignature	*s1;
+  NSMethodSignature	*s2;
+  id			root;
+  id			a;
+  id			b;
+  id			i;
+  id			d;
+  NSInvocation		*inv;
+  int			ival = 0;
+  double		dval = 0.0;
+  unsigned		count;
+
+  server = [[NSConnection alloc] initWithReceivePort: port sendPort: nil];
+  [server setRootObject: [[Vendor new] autorelease]];
+  [server runInNewThread];
+
+  client = [NSConnection connectionWithReceivePort: [NSPort port]
+					  sendPort: port];
+  root = [client rootProxy];
+  a = [root other];
+  b = [root other];
+  PASS(a != nil && b != nil && a != b, "proxies for two remote objects");
+
+  s1 = [a methodSignatureForSelector: @selector(add:to:)];
+  PASS(s1 != nil, "a signature is obtained from the remote object");
+  count = requestsSent(client);
+  PASS([a methodSignatureForSelector: @selector(add:to:)] == s1
+    && requestsSent(client) == count,
+    "a signature is cached by the proxy");
+
+  count = requestsSent(client);
+  s2 = [b methodSignatureForSelector: @selector(add:to:)];
+  PASS(s2 == s1, "a proxy for an object of the same class shares signatures");
+  PASS(requestsSent(client) - count <= 1,
+    "a shared signature needs no signature request");
+  PASS([b add: 4 to: 5] == 9, "a message using a shared signature works");
+
+  i = [root dynamic: NO];
+  d = [root dynamic: YES];
+  s1 = [i methodSignatureForSelector: @selector(value)];
+  s2 = [d methodSignatureForSelector: @selector(value)];
+  PASS(s1 != nil && *[s1 methodReturnType] == 'i',
+    "an int signature is obtained from the first dynamic object");
+  PASS(s2 != nil && *[s2 methodReturnType] == 'd',
+    "a double signature is obtained from the second dynamic object");
+  inv = [NSInvocation invocationWithMethodSignature: s1];
+  [inv setSelector: @selector(value)];
+  [inv invokeWithTarget: i];
+  [inv getReturnValue: &ival];
+  PASS(ival == 7, "a message using the int signature works");
+  inv = [NSInvocation invocationWithMethodSignature: s2];
+  [inv setSelector: @selector(value)];
+  [inv invokeWithTarget: d];
+  [inv getReturnValue: &dval];
+  PASS(dval == 2.5, "a message using the double signature works");
+
+  s2 = [[root dynamic: NO] methodSignatureForSelector: @selector(value)];
+  PASS(s2 != nil && s2 != s1,
+    "objects overriding -methodSignatureForSelector: do not share signatures");
+
+  [client invalidate];
+  [server invalidate];
+  [server release];
+  [arp release]; arp = nil;
+  return 0;
+}
@@ -0,0 +1,91 @@
+#import "Testing.h"
+#import <Foundation/Foundation.h>
+#import <GNUstepBase/GSMime.h>
+#import <GNUstepBase/NSData+GNUstepBase.h>
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSMutableData		*raw = [NSMutableData dataWithLength: 1000];
+  unsigned char		*b = [raw mutableBytes];
+  NSData		*d;
+  NSData		*e;
+  NSString		*s;
+  NSUInteger		i;
+  BOOL			ok;
+
+  for (i = 0; i < [raw length]; i++)
+    {
+      b[i] = (unsigned char)(i * 31 + (i >> 3));
+    }
+
+  s = [[@"foobar" dataUsingEncoding: NSASCIIStringEncoding]
+    base64EncodedStringWithOptions: 0];
+  PASS_EQUAL(s, @"Zm9vYmFy", "a short string is encoded");
+  s = [[@"fooba" dataUsingEncoding: NSASCIIStringEncoding]
+    base64EncodedStringWithOptions: 0];
+  PASS_EQUAL(s, @"Zm9vYmE=", "encoding is padded");
+  PASS_EQUAL([[NSData data] base64EncodedStringWithOptions: 0], @"",
+    "empty data gives an empty string");
+
+  /* Every length up to a few vector widths, so that both the bulk and
+   * the tail code is used.
+   */
+  ok = YES;
+  for (i = 0; i < 200; i++)
+    {
+      d = [raw subdataWithRange: NSMakeRange(i, i)];
+      e = [d base64EncodedDataWithOptions: 0];
+      if (NO == [[GSMimeDocument encodeBase64: d] isEqual: e]
+	|| NO == [[GSMimeDocument decodeBase64: e] isEqual: d]
+	|| NO == [[[[NSData alloc] initWithBase64EncodedData: e options: 0]
+	  autorelease] isEqual: d])
+	{
+	  ok = NO;
+	}
+    }
+  PASS(ok, "base64 coding round trips for all short lengths");
+
+  e = [raw base64EncodedDataWithOptions:
+    NSDataBase64Encoding76CharacterLineLength];
+  s = [[[NSString alloc] initWithData: e encoding: NSASCIIStringEncoding]
+    autorelease];
+  PASS([[s componentsSeparatedByString: @"\r\n"] count] == 18
+    && [[[s componentsSeparatedByString: @"\r\n"] objectAtIndex: 0] length]
+    == 76, "line length option inserts CRLF every 76 characters");
+  PASS(nil == [[[NSData alloc] initWithBase64EncodedData: e options: 0]
+    autorelease], "line endings are rejected by default");
+  PASS_EQUAL([[[NSData alloc] initWithBase64EncodedData: e
+    options: NSDataBase64DecodingIgnoreUnknownCharacters] autorelease], raw,
+    "line endings may be ignored");
+  PASS_EQUAL([GSMimeDocument decodeBase64: e], raw,
+    "GSMimeDocument decodes data with line endings");
+  s = [raw base64EncodedStringWithOptions:
+    NSDataBase64Encoding64CharacterLineLength
+    | NSDataBase64EncodingEndLineWithLineFeed];
+  PASS([[[s componentsSeparatedByString: @"\n"] objectAtIndex: 0] length]
+    == 64, "line feeds may be used alone");
+
+  PASS_EQUAL([[[NSData alloc] initWithBase64EncodedString: @"Zm9vYg"
+    options: 0] autorelease],
+    [@"foob" dataUsingEncoding: NSASCIIStringEncoding],
+    "missing padding is tolerated");
+  PASS(nil == [[[NSData alloc] initWithBase64EncodedString: @"Zm9vY"
+    options: 0] autorelease], "a single trailing character is invalid");
+  PASS(nil == [[[NSData alloc] initWithBase64EncodedString: @"Zm9v=mFy"
+    options: 0] autorelease], "data after padding is invalid");
+
+  s = [raw hexadecimalRepresentation];
+  PASS([s length] == 2000 && [[s substringToIndex: 6] isEqual: @"001F3E"],
+    "hexadecimal representation is uppercase");
+  PASS_EQUAL([[[NSData alloc] initWithHexadecimalRepresentation: s]
+    autorelease], raw, "hexadecimal representation round trips");
+  PASS_EQUAL([[[NSData alloc] initWithHexadecimalRepresentation:
+    [s lowercaseString]] autorelease], raw, "lowercase digits are decoded");
+  PASS_EQUAL([[[NSData alloc] initWithHexadecimalRepresentation:
+    @"0a 0B\n0c"] autorelease],
+    [NSData dataWithBytes: "\n\v\f" length: 3], "white space is ignored");
+
+  [arp release]; arp = nil;
+  return 0;
+}
@@ -0,0 +1,181 @@
+#import "Testing.h"
+#import <Foundation/Foundation.h>
+#import <GNUstepBase/GSDigest.h>
+#import <GNUstepBase/NSData+GNUstepBase.h>
+
+static NSString *
+hex(NSData *d)
+{
+  return [[d hexadecimalRepresentation] lowercaseString];
+}
+
+/* Known answers, indexed by algorithm, for the 448 bit message below
+ * (which needs a second block for the padding of the 64 byte block
+ * algorithms) and for a million repetitions of 'a'.
+ */
+static const char	*names[] = {
+  "MD5", "SHA1", "SHA256", "SHA512", "CRC32C"
+};
+static const char	*msg448 =
+  "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+static NSString		*kat448[] = {
+  @"8215ef0796a20bcaaae116d3876c664a",
+  @"84983e441c3bd26ebaae4aa1f95129e5e54670f1",
+  @"248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+  @"204a8fc6dda82f0a0ced7beb8e08a41657c16ef468b228a8279be331a703c335"
+  @"96fd15c13b1b07f9aa1d3bea57789ca031ad85c7a71dd70354ec631238ca3445",
+  @"071325f5"
+};
+static NSString		*katMillion[] = {
+  @"7707d6ae4e027c70eea2a935c2296f21",
+  @"34aa973cd4c4daa4f61eeb2bdbad27316534016f",
+  @"cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+  @"e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973eb"
+  @"de0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b",
+  @"436fe240"
+};
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSData		*abc = [@"abc" dataUsingEncoding: NSASCIIStringEncoding];
+  NSMutableData		*raw = [NSMutableData dataWithLength: 100000];
+  unsigned char		*b = [raw mutableBytes];
+  NSData		*m448;
+  NSMutableData		*million = [NSMutableData dataWithLength: 1000000];
+  NSString		*path;
+  NSInputStream		*s;
+  GSDigest		*d;
+  GSDigest		*c;
+  uint8_t		buf[777];
+  NSUInteger		i;
+  NSUInteger		pos;
+  NSInteger		n;
+  BOOL			ok;
+
+  for (i = 0; i < [raw length]; i++)
+    {
+      b[i] = (unsigned char)(i * 31 + (i >> 3));
+    }
+  m448 = [NSData dataWithBytes: msg448 length: strlen(msg448)];
+  memset([million mutableBytes], 'a', [million length]);
+
+  PASS_EQUAL(hex([abc md5Digest]), @"900150983cd24fb0d6963f7d28e17f72",
+    "-md5Digest gives the correct result");
+  PASS_EQUAL(hex([abc sha1Digest]),
+    @"a9993e364706816aba3e25717850c26c9cd0d89d",
+    "-sha1Digest gives the correct result");
+  PASS_EQUAL(hex([abc sha256Digest]),
+    @"ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+    "-sha256Digest gives the correct result");
+  PASS_EQUAL(hex([abc sha512Digest]),
+    @"ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+    @"2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f",
+    "-sha512Digest gives the correct result");
+  PASS_EQUAL(hex([[@"123456789" dataUsingEncoding: NSASCIIStringEncoding]
+    crc32cDigest]), @"e3069283",
+    "-crc32cDigest gives the correct result");
+  PASS_EQUAL(hex([[NSData data] sha256Digest]),
+    @"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+    "the digest of empty data is correct");
+  PASS_EQUAL(hex([[@"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+    @"hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"
+    dataUsingEncoding: NSASCIIStringEncoding] sha512Digest]),
+    @"8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018"
+    @"501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909",
+    "-sha512Digest gives the correct result for a two block message");
+
+  for (i = GSDigestMD5; i <= GSDigestCRC32C; i++)
+    {
+      PASS_EQUAL(hex([m448 digestUsingAlgorithm: i]), kat448[i],
+	"%s digest of the 448 bit message is correct", names[i]);
+      PASS_EQUAL(hex([million digestUsingAlgorithm: i]), katMillion[i],
+	"%s digest of a million 'a' characters is correct", names[i]);
+    }
+
+  /* Feed the data in pieces of varying size, so that they straddle
+   * block boundaries in different ways, and check against the known
+   * answers rather than against the one-shot digest.
+   */
+  ok = YES;
+  for (i = GSDigestMD5; i <= GSDigestCRC32C; i++)
+    {
+      const unsigned char	*m = [million bytes];
+
+      d = [GSDigest digestWithAlgorithm: i];
+      for (pos = 0; pos < [million length]; pos += (pos % 200) + 1)
+	{
+	  NSUInteger	len = (pos % 200) + 1;
+
+	  if (pos + len > [million length])
+	    {
+	      len = [million length] - pos;
+	    }
+	  [d updateWithBytes: m + pos length: len];
+	}
+      if ([hex([d digest]) isEqual: katMillion[i]] == NO
+	|| [[d digest] length] != [d digestLength])
+	{
+	  ok = NO;
+	}
+      d = [GSDigest digestWithAlgorithm: i];
+      for (pos = 0; pos < [m448 length]; pos++)
+	{
+	  [d updateWithBytes: (const uint8_t*)msg448 + pos length: 1];
+	}
+      if ([hex([d digest]) isEqual: kat448[i]] == NO)
+	{
+	  ok = NO;
+	}
+    }
+  PASS(ok, "incremental digests give the known answers");
+
+  d = [GSDigest digestWithAlgorithm: GSDigestSHA1];
+  [d updateWithData: abc];
+  c = AUTORELEASE([d copy]);
+  PASS_EQUAL([d digest], [abc sha1Digest], "-digest may be called early");
+  [d updateWithData: abc];
+  PASS_EQUAL([d digest], [[@"abcabc" dataUsingEncoding:
+    NSASCIIStringEncoding] sha1Digest], "data may be added after -digest");
+  PASS_EQUAL([c digest], [abc sha1Digest], "a copy is independent");
+  [d reset];
+  PASS_EQUAL([d digest], [[NSData data] sha1Digest], "-reset discards data");
+
+  d = [GSDigest digestWithAlgorithm: GSDigestSHA256];
+  s = [GSDigestInputStream
+    streamWithInputStream: [NSInputStream inputStreamWithData: raw]
+    digest: d];
+  [s open];
+  pos = 0;
+  while ((n = [s read: buf maxLength: sizeof(buf)]) > 0)
+    {
+      pos += n;
+    }
+  [s close];
+  PASS(pos == [raw length], "a digest input stream passes on all data");
+  PASS_EQUAL([d digest], [raw sha256Digest],
+    "a digest input stream updates its digest");
+
+  d = [GSDigest digestWithAlgorithm: GSDigestSHA512];
+  PASS([d updateWithStream: [NSInputStream inputStreamWithData: raw]],
+    "-updateWithStream: reads a stream");
+  PASS_EQUAL([d digest], [raw sha512Digest],
+    "-updateWithStream: adds all the data");
+
+  path = [NSTemporaryDirectory() stringByAppendingPathComponent:
+    [[NSProcessInfo processInfo] globallyUniqueString]];
+  [raw writeToFile: path atomically: NO];
+  PASS_EQUAL([GSDigest digestOfContentsOfFile: path algorithm: GSDigestMD5],
+    [raw md5Digest], "+digestOfContentsOfFile:algorithm: works");
+  d = [GSDigest digestWithAlgorithm: GSDigestCRC32C];
+  PASS([d updateWithContentsOfFile: path],
+    "-updateWithContentsOfFile: reads a file");
+  PASS_EQUAL([d digest], [raw crc32cDigest],
+    "-updateWithContentsOfFile: adds all the data");
+  [[NSFileManager defaultManager] removeFileAtPath: path handler: nil];
+  PASS([d updateWithContentsOfFile: path] == NO,
+    "-updateWithContentsOfFile: fails for a missing file");
+
+  [arp release]; arp = nil;
+  return 0;
+}
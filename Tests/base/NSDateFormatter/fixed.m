@@ -0,0 +1,74 @@
+#import <Foundation/NSDate.h>
+#import <Foundation/NSDateFormatter.h>
+#import <Foundation/NSLocale.h>
+#import <Foundation/NSTimeZone.h>
+#import "Testing.h"
+
+/* ISO-8601 and RFC-1123 style patterns are formatted and parsed without
+ * using ICU, but should give exactly the same results.
+ */
+#if	defined(GS_USE_ICU)
+#define	NSLOCALE_SUPPORTED	GS_USE_ICU
+#else
+#define	NSLOCALE_SUPPORTED	1 /* Assume Apple support */
+#endif
+
+int main(void)
+{
+  NSDateFormatter	*fmt;
+  NSLocale		*locale;
+  NSTimeZone		*gmt;
+  NSTimeZone		*east;
+  NSDate		*date;
+  NSDate		*when;
+
+  START_SET("NSDateFormatter fixed formats")
+  if (!NSLOCALE_SUPPORTED)
+    SKIP("NSLocale not supported\nThe ICU library was not available when GNUstep-base was built")
+
+    locale = [[NSLocale alloc] initWithLocaleIdentifier: @"en_US_POSIX"];
+    gmt = [NSTimeZone timeZoneWithName: @"GMT"];
+    east = [NSTimeZone timeZoneForSecondsFromGMT: 5400];
+    when = [NSDate dateWithTimeIntervalSince1970: 1700000000.125];
+
+    fmt = [NSDateFormatter new];
+    [fmt setLocale: locale];
+    [fmt setTimeZone: gmt];
+    [fmt setDateFormat: @"yyyy-MM-dd'T'HH:mm:ss.SSSZZZZZ"];
+    PASS_EQUAL([fmt stringFromDate: when], @"2023-11-14T22:13:20.125Z",
+      "ISO-8601 with fractional seconds in GMT");
+    date = [fmt dateFromString: @"2023-11-14T22:13:20.125Z"];
+    PASS_EQUAL(date, when, "parses ISO-8601 in GMT");
+    date = [fmt dateFromString: @"2023-11-14T23:43:20.125+01:30"];
+    PASS_EQUAL(date, when, "parses ISO-8601 with an offset");
+
+    [fmt setTimeZone: east];
+    PASS_EQUAL([fmt stringFromDate: when], @"2023-11-14T23:43:20.125+01:30",
+      "the pattern is kept and the offset used after changing time zone");
+
+    [fmt setDateFormat: @"yyyy-MM-dd HH:mm:ss"];
+    PASS_EQUAL([fmt stringFromDate: when], @"2023-11-14 23:43:20",
+      "a pattern without an offset uses the time zone");
+    PASS_EQUAL([fmt dateFromString: @"2023-11-14 23:43:20"],
+      [NSDate dateWithTimeIntervalSince1970: 1700000000.0],
+      "a time without an offset is parsed in the time zone");
+
+    [fmt setTimeZone: gmt];
+    [fmt setDateFormat: @"EEE, dd MMM yyyy HH:mm:ss zzz"];
+    PASS_EQUAL([fmt stringFromDate: when], @"Tue, 14 Nov 2023 22:13:20 GMT",
+      "RFC-1123 in GMT");
+    PASS_EQUAL([fmt dateFromString: @"Tue, 14 Nov 2023 22:13:20 GMT"],
+      [NSDate dateWithTimeIntervalSince1970: 1700000000.0],
+      "parses RFC-1123");
+
+    [fmt setDateFormat: @"yyyy-MM-dd"];
+    date = [fmt dateFromString: @"2000-02-29"];
+    PASS_EQUAL([fmt stringFromDate: date], @"2000-02-29",
+      "a leap day survives parsing and formatting");
+    RELEASE(fmt);
+    RELEASE(locale);
+
+  END_SET("NSDateFormatter fixed formats")
+
+  return 0;
+}
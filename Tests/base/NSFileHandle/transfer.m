@@ -0,0 +1,100 @@
+#import "Testing.h"
+#import "ObjectTesting.h"
+#import <Foundation/Foundation.h>
+
+@interface	Counter : NSObject
+{
+@public
+  unsigned	count;
+}
+- (void) written: (NSNotification*)n;
+@end
+
+@implementation	Counter
+- (void) written: (NSNotification*)n
+{
+  count++;
+}
+@end
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSFileManager		*mgr = [NSFileManager defaultManager];
+  NSString		*base = [NSTemporaryDirectory()
+    stringByAppendingPathComponent:
+    [[NSProcessInfo processInfo] globallyUniqueString]];
+  NSString		*p1 = [base stringByAppendingString: @"1"];
+  NSString		*p2 = [base stringByAppendingString: @"2"];
+  NSMutableData		*src = [NSMutableData dataWithLength: 200000];
+  NSFileHandle		*r;
+  NSFileHandle		*w;
+  NSData		*d;
+  NSPipe		*pipe;
+  Counter		*c;
+  NSDate		*limit;
+  unsigned char		*b = [src mutableBytes];
+  unsigned		i;
+  unsigned long long	n;
+
+  for (i = 0; i < [src length]; i++)
+    {
+      b[i] = (unsigned char)(i % 251);
+    }
+  [src writeToFile: p1 atomically: NO];
+
+  r = [NSFileHandle fileHandleForReadingAtPath: p1];
+  d = [r readDataToEndOfFile];
+  PASS_EQUAL(d, src, "-readDataToEndOfFile reads a large file");
+
+  [r seekToFileOffset: 1000];
+  d = [r readDataOfLength: 100000];
+  PASS_EQUAL(d, [src subdataWithRange: NSMakeRange(1000, 100000)],
+    "-readDataOfLength: reads the requested data");
+
+  [@"" writeToFile: p2 atomically: NO];
+  w = [NSFileHandle fileHandleForWritingAtPath: p2];
+  n = [w writeFromFileHandle: r offset: 10 length: 150000];
+  PASS(n == 150000, "-writeFromFileHandle:offset:length: copies all data");
+  [w closeFile];
+  d = [NSData dataWithContentsOfFile: p2];
+  PASS_EQUAL(d, [src subdataWithRange: NSMakeRange(10, 150000)],
+    "-writeFromFileHandle:offset:length: copies the correct data");
+
+  [@"" writeToFile: p2 atomically: NO];
+  w = [NSFileHandle fileHandleForWritingAtPath: p2];
+  n = [w writeFromFileHandle: r offset: 199000 length: 5000];
+  PASS(n == 1000, "-writeFromFileHandle:offset:length: stops at end of file");
+  [w closeFile];
+
+  /* Queue several background writes so that they may be gathered.
+   */
+  pipe = [NSPipe pipe];
+  w = [pipe fileHandleForWriting];
+  c = [[Counter new] autorelease];
+  [[NSNotificationCenter defaultCenter] addObserver: c
+    selector: @selector(written:)
+    name: GSFileHandleWriteCompletionNotification
+    object: w];
+  [w writeInBackgroundAndNotify: [@"one " dataUsingEncoding: NSASCIIStringEncoding]];
+  [w writeInBackgroundAndNotify: [@"two " dataUsingEncoding: NSASCIIStringEncoding]];
+  [w writeInBackgroundAndNotify: [NSData data]];
+  [w writeInBackgroundAndNotify: [@"three" dataUsingEncoding: NSASCIIStringEncoding]];
+  limit = [NSDate dateWithTimeIntervalSinceNow: 5.0];
+  while (c->count < 4 && [limit timeIntervalSinceNow] > 0)
+    {
+      [[NSRunLoop currentRunLoop] runMode: NSDefaultRunLoopMode
+			       beforeDate: limit];
+    }
+  PASS(c->count == 4, "a notification is posted for each queued write");
+  [w closeFile];
+  d = [[pipe fileHandleForReading] readDataToEndOfFile];
+  PASS_EQUAL(d, [@"one two three" dataUsingEncoding: NSASCIIStringEncoding],
+    "queued writes are written in order");
+  [[NSNotificationCenter defaultCenter] removeObserver: c];
+
+  [mgr removeFileAtPath: p1 handler: nil];
+  [mgr removeFileAtPath: p2 handler: nil];
+  [arp release]; arp = nil;
+  return 0;
+}
@@ -53,6 +53,8 @@ int main()
   	   "NSHTTPCookie returns proper value");
   PASS([[cookie domain] isEqual: [url host]], 
   	   "NSHTTPCookie returns proper domain");
+  PASS([[cookie expiresDate] timeIntervalSince1970] == 1299711635.0,
+  	   "NSHTTPCookie returns proper expiry date");
   
   dict = [NSHTTPCookie requestHeaderFieldsWithCookies: cookies];
   PASS_EQUAL([dict objectForKey: @"Cookie"],
@@ -0,0 +1,56 @@
+#import "ObjectTesting.h"
+#import <Foundation/NSAutoreleasePool.h>
+#import <Foundation/NSHashTable.h>
+#import <Foundation/NSMapTable.h>
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSHashTable		*h;
+  NSMapTable		*m;
+  NSUInteger		purged;
+  NSUInteger		sweeps;
+  id			keep;
+  int			i;
+
+  h = [NSHashTable hashTableWithOptions: 0];
+  [h addObject: @"hello"];
+  purged = sweeps = 1;
+  [h getPurged: &purged sweeps: &sweeps];
+  PASS(purged == 0 && sweeps == 0 && [h count] == 1,
+    "a strong hash table purges nothing");
+
+  keep = [NSObject new];
+  h = [NSHashTable weakObjectsHashTable];
+  m = [NSMapTable weakToStrongObjectsMapTable];
+  [h addObject: keep];
+  [m setObject: @"kept" forKey: keep];
+  for (i = 0; i < 1000; i++)
+    {
+      id	o = [NSObject new];
+
+      [h addObject: o];
+      [m setObject: @"value" forKey: o];
+      [o release];
+    }
+  PASS([h member: keep] == keep, "a live object is still in a weak table");
+  PASS_EQUAL([m objectForKey: keep], @"kept",
+    "a live key is still in a weak map table");
+
+  /* Zeroing needs runtime support for weak references.
+   */
+  testHopeful = YES;
+  [h getPurged: &purged sweeps: 0];
+  PASS(purged > 0, "dead entries are purged as a weak table is added to");
+  PASS([h count] == 1, "dead entries are not counted");
+  [h getPurged: 0 sweeps: &sweeps];
+  PASS(sweeps == 1, "-count sweeps the table");
+  PASS([m count] == 1, "dead keys are not counted in a map table");
+  [m getPurged: &purged sweeps: 0];
+  PASS(purged == 1000, "every dead key is purged from a map table");
+  testHopeful = NO;
+
+  [keep release];
+  [arp release]; arp = nil;
+  return 0;
+}
@@ -0,0 +1,140 @@
+#import "Testing.h"
+#import <Foundation/Foundation.h>
+#import <GNUstepBase/NSObject+GNUstepBase.h>
+
+/* Checks a against a C array of the expected values.
+ */
+static BOOL
+matches(NSArray *a, int *expect, unsigned count)
+{
+  unsigned	i;
+
+  if ([a count] != count)
+    {
+      return NO;
+    }
+  for (i = 0; i < count; i++)
+    {
+      if ([[a objectAtIndex: i] intValue] != expect[i])
+	{
+	  return NO;
+	}
+    }
+  return YES;
+}
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSMutableArray	*a = [NSMutableArray array];
+  NSArray		*c;
+  NSFastEnumerationState	state;
+  id			buf[4];
+  NSUInteger		n;
+  int			expect[2000];
+  unsigned		count = 0;
+  unsigned		i;
+  int			next = 0;
+  BOOL			ok = YES;
+
+  for (i = 0; i < 1000; i++)
+    {
+      [a addObject: [NSNumber numberWithInt: i]];
+    }
+  for (i = 0; i < 990; i++)
+    {
+      if ([[a objectAtIndex: 0] intValue] != (int)i)
+	{
+	  ok = NO;
+	}
+      [a removeObjectAtIndex: 0];
+    }
+  PASS(ok && [a count] == 10 && [[a objectAtIndex: 0] intValue] == 990,
+    "objects removed from the start come out in order");
+
+  [a removeAllObjects];
+  for (i = 0; i < 1000; i++)
+    {
+      [a insertObject: [NSNumber numberWithInt: i] atIndex: 0];
+    }
+  PASS([[a objectAtIndex: 0] intValue] == 999
+    && [[a lastObject] intValue] == 0,
+    "objects inserted at the start are in reverse order");
+  [a removeAllObjects];
+
+  /* Mix operations at both ends and in the middle, checking the result
+   * against a plain C array as we go.
+   */
+  srand(1);
+  for (i = 0; i < 20000 && ok; i++)
+    {
+      unsigned	op = rand() % 10;
+      unsigned	index;
+
+      if (op < 6 && count < 2000)
+	{
+	  index = (op < 2) ? 0 : ((op < 4) ? count : rand() % (count + 1));
+	  [a insertObject: [NSNumber numberWithInt: next] atIndex: index];
+	  memmove(expect + index + 1, expect + index,
+	    (count - index) * sizeof(int));
+	  expect[index] = next++;
+	  count++;
+	}
+      else if (count > 0)
+	{
+	  index = (op < 8) ? 0 : rand() % count;
+	  [a removeObjectAtIndex: index];
+	  memmove(expect + index, expect + index + 1,
+	    (count - index - 1) * sizeof(int));
+	  count--;
+	}
+      ok = matches(a, expect, count);
+    }
+  PASS(ok, "mixed insertions and removals keep the array consistent");
+
+  while ([a count] > 10)
+    {
+      [a removeObjectAtIndex: 0];
+      memmove(expect, expect + 1, --count * sizeof(int));
+    }
+  ok = YES;
+  i = 0;
+  memset(&state, '\0', sizeof(state));
+  while ((n = [a countByEnumeratingWithState: &state
+				     objects: buf
+				       count: 4]) > 0)
+    {
+      unsigned	j;
+
+      for (j = 0; j < n; j++)
+	{
+	  if ([state.itemsPtr[j] intValue] != expect[i++])
+	    {
+	      ok = NO;
+	    }
+	}
+    }
+  PASS(ok && i == count, "fast enumeration works after removal from the start");
+
+  [a sortUsingSelector: @selector(compare:)];
+  ok = YES;
+  for (i = 1; i < count; i++)
+    {
+      if ([[a objectAtIndex: i-1] intValue] > [[a objectAtIndex: i] intValue])
+	{
+	  ok = NO;
+	}
+    }
+  PASS(ok, "sorting works after removal from the start");
+
+  c = [[a copy] autorelease];
+  PASS_EQUAL(c, a, "copying works after removal from the start");
+  [a removeObjectAtIndex: 0];
+  [a makeImmutableCopyOnFail: NO];
+  PASS([a count] == count - 1
+    && [[a objectAtIndex: 0] isEqual: [c objectAtIndex: 1]],
+    "an array made immutable after removal from the start is intact");
+
+  [arp release]; arp = nil;
+  return 0;
+}
@@ -0,0 +1,227 @@
+#import "Testing.h"
+#import <Foundation/Foundation.h>
+
+/* These sets have enough scattered indexes that they are held as
+ * compressed bitmaps rather than as ranges, so we check the results
+ * of each operation against a simple array of flags.
+ */
+#define	LIMIT	300000
+
+static unsigned	seed = 1;
+
+static unsigned
+next()
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) & 0x7fff;
+}
+
+static NSMutableIndexSet *
+build(unsigned char *flags, unsigned odds)
+{
+  NSMutableIndexSet	*s = [NSMutableIndexSet indexSet];
+  NSUInteger		i;
+
+  memset(flags, 0, LIMIT);
+  for (i = 0; i < LIMIT; i++)
+    {
+      if (next() % odds == 0)
+	{
+	  [s addIndex: i];
+	  flags[i] = 1;
+	}
+    }
+  return s;
+}
+
+static BOOL
+matches(NSIndexSet *s, unsigned char *flags)
+{
+  NSUInteger	count = 0;
+  NSUInteger	i;
+  NSUInteger	j;
+
+  for (i = 0; i < LIMIT; i++)
+    {
+      if ([s containsIndex: i] != (BOOL)flags[i])
+	{
+	  return NO;
+	}
+      count += flags[i];
+    }
+  if ([s count] != count)
+    {
+      return NO;
+    }
+  j = 0;
+  for (i = [s firstIndex]; i != NSNotFound; i = [s indexGreaterThanIndex: i])
+    {
+      while (j < i)
+	{
+	  if (flags[j++])
+	    {
+	      return NO;
+	    }
+	}
+      j++;
+    }
+  return YES;
+}
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  unsigned char		*fa = malloc(LIMIT);
+  unsigned char		*fb = malloc(LIMIT);
+  unsigned char		*fr = malloc(LIMIT);
+  NSMutableIndexSet	*a;
+  NSMutableIndexSet	*b;
+  NSMutableIndexSet	*m;
+  NSIndexSet		*c;
+  NSUInteger		buf[100];
+  NSRange		r;
+  NSUInteger		i;
+  NSUInteger		n;
+  BOOL			ok;
+  NSZone		*z;
+  size_t		used;
+
+  a = build(fa, 2);
+  b = build(fb, 3);
+  PASS(matches(a, fa), "a large scattered set holds the right indexes");
+  PASS(matches(b, fb), "another large scattered set is correct");
+
+  c = [[a copy] autorelease];
+  PASS([c isEqual: a] && [a isEqual: c], "a copy is equal to the original");
+  PASS(matches(c, fa), "a copy holds the right indexes");
+  PASS([a isEqual: b] == NO, "different sets are not equal");
+  PASS([a containsIndexes: c], "a set contains its copy");
+
+  m = [NSMutableIndexSet indexSet];
+  for (i = [a firstIndex]; i != NSNotFound; i = [a indexGreaterThanIndex: i])
+    {
+      r = NSMakeRange(i, 1);
+      while ([a containsIndex: NSMaxRange(r)])
+	{
+	  r.length++;
+	}
+      [m addIndexesInRange: r];
+      i = NSMaxRange(r) - 1;
+    }
+  PASS([m isEqual: a], "a set built from runs equals one built by index");
+
+  m = [[a mutableCopy] autorelease];
+  [m addIndexes: b];
+  for (i = 0; i < LIMIT; i++) fr[i] = fa[i] | fb[i];
+  PASS(matches(m, fr), "-addIndexes: gives the union");
+  PASS([m containsIndexes: a] && [m containsIndexes: b],
+    "the union contains both sets");
+
+  m = [[a mutableCopy] autorelease];
+  [m intersectIndexes: b];
+  for (i = 0; i < LIMIT; i++) fr[i] = fa[i] & fb[i];
+  PASS(matches(m, fr), "-intersectIndexes: gives the intersection");
+
+  m = [[a mutableCopy] autorelease];
+  [m removeIndexes: b];
+  for (i = 0; i < LIMIT; i++) fr[i] = fa[i] & !fb[i];
+  PASS(matches(m, fr), "-removeIndexes: gives the difference");
+
+  m = [[a mutableCopy] autorelease];
+  [m intersectIndexes: [NSIndexSet indexSetWithIndexesInRange:
+    NSMakeRange(1000, 5000)]];
+  for (i = 0; i < LIMIT; i++) fr[i] = (i >= 1000 && i < 6000) ? fa[i] : 0;
+  PASS(matches(m, fr), "-intersectIndexes: with a range set works");
+
+  m = [[a mutableCopy] autorelease];
+  [m removeIndexesInRange: NSMakeRange(100, 200000)];
+  [m addIndexesInRange: NSMakeRange(150000, 70000)];
+  memcpy(fr, fa, LIMIT);
+  memset(fr + 100, 0, 200000);
+  memset(fr + 150000, 1, 70000);
+  PASS(matches(m, fr), "removing and adding ranges works");
+  PASS([m countOfIndexesInRange: NSMakeRange(140000, 100000)]
+    == 70000 + [a countOfIndexesInRange: NSMakeRange(220000, 20000)],
+    "-countOfIndexesInRange: is correct");
+  PASS([m containsIndexesInRange: NSMakeRange(150000, 70000)]
+    && ![m containsIndexesInRange: NSMakeRange(149999, 2)],
+    "-containsIndexesInRange: is correct");
+  PASS([m intersectsIndexesInRange: NSMakeRange(120000, 30001)]
+    && ![m intersectsIndexesInRange: NSMakeRange(120000, 30000)],
+    "-intersectsIndexesInRange: is correct");
+
+  ok = YES;
+  for (i = 1; i < LIMIT && ok; i += 97)
+    {
+      NSUInteger	j = i - 1;
+
+      while (j > 0 && !fa[j]) j--;
+      if (!fa[j]) j = NSNotFound;
+      if ([a indexLessThanIndex: i] != j) ok = NO;
+    }
+  PASS(ok, "-indexLessThanIndex: is correct");
+
+  r = NSMakeRange(0, NSNotFound);
+  ok = YES;
+  i = 0;
+  while ((n = [a getIndexes: buf maxCount: 100 inIndexRange: &r]) > 0)
+    {
+      NSUInteger	k;
+
+      for (k = 0; k < n; k++)
+	{
+	  while (i < buf[k]) if (fa[i++]) ok = NO;
+	  i++;
+	}
+    }
+  PASS(ok, "-getIndexes:maxCount:inIndexRange: returns every index");
+
+  m = [[a mutableCopy] autorelease];
+  [m shiftIndexesStartingAtIndex: 1000 by: 10];
+  PASS([m count] == [a count] && [m containsIndex: 1010] == fa[1000]
+    && [m lastIndex] == [a lastIndex] + 10,
+    "-shiftIndexesStartingAtIndex:by: works");
+
+  c = [NSKeyedUnarchiver unarchiveObjectWithData:
+    [NSKeyedArchiver archivedDataWithRootObject: a]];
+  PASS([c isEqual: a], "a set survives keyed archiving");
+
+  m = [[a mutableCopy] autorelease];
+  for (i = 0; i < LIMIT; i++)
+    {
+      [m removeIndex: i];
+    }
+  PASS([m count] == 0 && [m firstIndex] == NSNotFound,
+    "removing every index empties the set");
+  [m addIndex: 42];
+  PASS([m count] == 1 && [m containsIndex: 42], "an emptied set is usable");
+
+  /* Adding and removing an index in a block of its own creates and
+   * empties a container each time, so the memory used by the set's
+   * zone must not grow.
+   */
+  z = NSCreateZone(65536, 4096, YES);
+  m = [[NSMutableIndexSet allocWithZone: z] init];
+  for (i = 0; i < LIMIT; i += 2)
+    {
+      [m addIndex: i];
+    }
+  [m addIndex: LIMIT * 4];
+  [m removeIndex: LIMIT * 4];
+  used = NSZoneStats(z).bytes_used;
+  for (i = 0; i < 1000; i++)
+    {
+      [m addIndex: LIMIT * 4 + i];
+      [m removeIndex: LIMIT * 4 + i];
+    }
+  PASS([m count] == LIMIT / 2 && NSZoneStats(z).bytes_used <= used,
+    "emptying a block repeatedly does not leak");
+  [m release];
+  NSRecycleZone(z);
+
+  free(fa);
+  free(fb);
+  free(fr);
+  [arp release]; arp = nil;
+  return 0;
+}
@@ -0,0 +1,159 @@
+#import "Testing.h"
+#import <Foundation/Foundation.h>
+
+@interface Counter : NSObject
+{
+@public
+  NSMutableArray	*seen;
+}
+@end
+
+@implementation Counter
+- (id) init
+{
+  seen = [NSMutableArray new];
+  return self;
+}
+- (void) dealloc
+{
+  [seen release];
+  [super dealloc];
+}
+- (void) note: (NSNotification*)n
+{
+  [seen addObject: n];
+}
+@end
+
+static void
+drain()
+{
+  [[NSRunLoop currentRunLoop] acceptInputForMode: NSDefaultRunLoopMode
+				      beforeDate: [NSDate date]];
+}
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSNotificationCenter	*c = [[NSNotificationCenter new] autorelease];
+  NSNotificationQueue	*q;
+  Counter		*o = [[Counter new] autorelease];
+  NSString		*a = @"A";
+  NSString		*b = @"B";
+  NSObject		*x = [[NSObject new] autorelease];
+  NSObject		*y = [[NSObject new] autorelease];
+  NSUInteger		enqueued;
+  NSUInteger		coalesced;
+  NSUInteger		posted;
+  NSUInteger		i;
+  BOOL			ok;
+
+  q = [[[NSNotificationQueue alloc] initWithNotificationCenter: c]
+    autorelease];
+  [c addObserver: o selector: @selector(note:) name: nil object: nil];
+
+  /* Coalescing on name and object keeps only the first of each pair.
+   */
+  [q enqueueNotification: [NSNotification notificationWithName: a object: x]
+	    postingStyle: NSPostASAP];
+  [q enqueueNotification: [NSNotification notificationWithName: a object: y]
+	    postingStyle: NSPostASAP];
+  [q enqueueNotification: [NSNotification notificationWithName: b object: x]
+	    postingStyle: NSPostASAP];
+  [q enqueueNotification: [NSNotification notificationWithName: a object: x]
+	    postingStyle: NSPostASAP];
+  drain();
+  PASS([o->seen count] == 3, "coalescing on name and object");
+  PASS([[[o->seen objectAtIndex: 0] name] isEqual: a]
+    && [[o->seen objectAtIndex: 0] object] == y
+    && [[[o->seen objectAtIndex: 1] name] isEqual: b]
+    && [[[o->seen objectAtIndex: 2] name] isEqual: a]
+    && [[o->seen objectAtIndex: 2] object] == x,
+    "coalesced notifications are posted in the order last queued");
+  [o->seen removeAllObjects];
+
+  /* Coalescing on name alone removes the name for every object.
+   */
+  [q enqueueNotification: [NSNotification notificationWithName: a object: x]
+	    postingStyle: NSPostASAP];
+  [q enqueueNotification: [NSNotification notificationWithName: a object: y]
+	    postingStyle: NSPostWhenIdle];
+  [q enqueueNotification: [NSNotification notificationWithName: b object: y]
+	    postingStyle: NSPostASAP];
+  [q enqueueNotification: [NSNotification notificationWithName: a object: nil]
+	    postingStyle: NSPostASAP
+	    coalesceMask: NSNotificationCoalescingOnName
+		forModes: nil];
+  drain();
+  PASS([o->seen count] == 2
+    && [[[o->seen objectAtIndex: 0] name] isEqual: b]
+    && [[o->seen objectAtIndex: 1] object] == nil,
+    "coalescing on name covers every object and both queues");
+  [o->seen removeAllObjects];
+
+  /* Coalescing on sender alone removes every name for the object.
+   */
+  [q enqueueNotification: [NSNotification notificationWithName: a object: x]
+	    postingStyle: NSPostASAP];
+  [q enqueueNotification: [NSNotification notificationWithName: b object: x]
+	    postingStyle: NSPostASAP];
+  [q enqueueNotification: [NSNotification notificationWithName: b object: y]
+	    postingStyle: NSPostASAP];
+  [q enqueueNotification: [NSNotification notificationWithName: @"C" object: x]
+	    postingStyle: NSPostASAP
+	    coalesceMask: NSNotificationCoalescingOnSender
+		forModes: nil];
+  drain();
+  PASS([o->seen count] == 2
+    && [[o->seen objectAtIndex: 0] object] == y
+    && [[[o->seen objectAtIndex: 1] name] isEqual: @"C"],
+    "coalescing on sender covers every name");
+  [o->seen removeAllObjects];
+
+  /* Without coalescing every notification is posted.
+   */
+  for (i = 0; i < 3; i++)
+    {
+      [q enqueueNotification:
+	[NSNotification notificationWithName: a object: x]
+		postingStyle: NSPostASAP
+		coalesceMask: NSNotificationNoCoalescing
+		    forModes: nil];
+    }
+  [q dequeueNotificationsMatching:
+    [NSNotification notificationWithName: b object: x]
+		     coalesceMask: NSNotificationCoalescingOnName
+		       + NSNotificationCoalescingOnSender];
+  drain();
+  PASS([o->seen count] == 3, "no coalescing posts every notification");
+  [o->seen removeAllObjects];
+
+  /* Many distinct notifications, each queued twice.
+   */
+  for (i = 0; i < 2000; i++)
+    {
+      [q enqueueNotification: [NSNotification notificationWithName:
+	[NSString stringWithFormat: @"N%u", (unsigned)(i % 1000)] object: x]
+		postingStyle: NSPostASAP];
+    }
+  drain();
+  ok = ([o->seen count] == 1000);
+  for (i = 0; ok && i < 1000; i++)
+    {
+      if (![[[o->seen objectAtIndex: i] name] isEqual:
+	[NSString stringWithFormat: @"N%u", (unsigned)i]])
+	{
+	  ok = NO;
+	}
+    }
+  PASS(ok, "thousands of distinct notifications coalesce correctly");
+
+  [q getEnqueued: &enqueued coalesced: &coalesced posted: &posted];
+  PASS(enqueued == coalesced + posted,
+    "every queued notification is counted as coalesced or posted");
+  PASS(posted == 1010, "posted count is correct");
+
+  [c removeObserver: o];
+  [arp release]; arp = nil;
+  return 0;
+}
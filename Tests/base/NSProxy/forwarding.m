@@ -0,0 +1,85 @@
+#import <Foundation/Foundation.h>
+#import "Testing.h"
+
+@interface	Target : NSObject
+{
+@public
+  id	inner;
+}
+- (int) depth: (int)d;
+- (NSRange) rangeFrom: (NSUInteger)l;
+@end
+
+@implementation	Target
+- (int) depth: (int)d
+{
+  /* Forward the same message (and so use the same closure) again
+   * while the outer forwarded call is still in progress.
+   */
+  if (d > 0 && inner != nil)
+    {
+      return [inner depth: d - 1] + 1;
+    }
+  return 0;
+}
+- (NSRange) rangeFrom: (NSUInteger)l
+{
+  return NSMakeRange(l, l + 1);
+}
+@end
+
+@interface	Forwarder : NSProxy
+{
+  id	target;
+}
+- (id) initWithTarget: (id)t;
+@end
+
+@implementation	Forwarder
+- (void) dealloc
+{
+  [target release];
+  [super dealloc];
+}
+- (void) forwardInvocation: (NSInvocation*)anInvocation
+{
+  [anInvocation invokeWithTarget: target];
+}
+- (id) initWithTarget: (id)t
+{
+  target = [t retain];
+  return self;
+}
+- (NSMethodSignature*) methodSignatureForSelector: (SEL)aSelector
+{
+  return [target methodSignatureForSelector: aSelector];
+}
+@end
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  Target		*t = [[Target new] autorelease];
+  id			p = [[[Forwarder alloc] initWithTarget: t] autorelease];
+  NSRange		r;
+  BOOL			ok;
+  int			i;
+
+  t->inner = p;
+  PASS([p depth: 5] == 5, "nested forwarding of the same message works");
+
+  ok = YES;
+  for (i = 0; i < 1000; i++)
+    {
+      r = [p rangeFrom: i];
+      if (r.location != i || r.length != i + 1)
+        {
+          ok = NO;
+        }
+    }
+  PASS(ok, "repeated forwarding returns the correct values");
+  t->inner = nil;
+
+  [arp release]; arp = nil;
+  return 0;
+}
@@ -0,0 +1,94 @@
+#import "ObjectTesting.h"
+#import <Foundation/NSArray.h>
+#import <Foundation/NSAutoreleasePool.h>
+#import <Foundation/NSDictionary.h>
+#import <Foundation/NSRunLoop.h>
+#import <Foundation/NSTimer.h>
+#import <Foundation/NSValue.h>
+
+@interface	Recorder : NSObject
+{
+@public
+  NSMutableArray	*order;
+}
+@end
+@implementation	Recorder
+- (void) fired: (NSTimer*)t
+{
+  [order addObject: [t userInfo]];
+}
+@end
+
+static NSTimer *
+add(Recorder *r, NSString *name, NSTimeInterval after)
+{
+  NSTimer	*t;
+
+  t = [NSTimer timerWithTimeInterval: after
+			      target: r
+			    selector: @selector(fired:)
+			    userInfo: name
+			     repeats: NO];
+  [[NSRunLoop currentRunLoop] addTimer: t forMode: NSDefaultRunLoopMode];
+  return t;
+}
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSRunLoop		*loop = [NSRunLoop currentRunLoop];
+  Recorder		*r = [[Recorder new] autorelease];
+  NSArray		*expect;
+  NSDictionary		*stats;
+  NSTimer		*t;
+
+  r->order = [NSMutableArray array];
+
+  t = add(r, @"c", 0.3);
+  PASS([t tolerance] == 0.0, "a timer has no tolerance by default");
+  [t setTolerance: -1.0];
+  PASS([t tolerance] == 0.0, "a negative tolerance is treated as zero");
+  [t setTolerance: 0.05];
+  PASS([t tolerance] == 0.05, "a tolerance can be set");
+
+  t = add(r, @"a", 0.1);
+  [loop addTimer: t forMode: NSDefaultRunLoopMode];
+  add(r, @"b", 0.2);
+  [add(r, @"x", 0.15) invalidate];
+  t = add(r, @"d", 5.0);
+  [t setFireDate: [NSDate dateWithTimeIntervalSinceNow: 0.25]];
+
+  [loop runUntilDate: [NSDate dateWithTimeIntervalSinceNow: 0.6]];
+  expect = [NSArray arrayWithObjects: @"a", @"b", @"d", @"c", nil];
+  PASS_EQUAL(r->order, expect,
+    "timers fire once each, in date order, unless invalidated");
+
+  stats = [loop timerStatisticsForMode: NSDefaultRunLoopMode];
+  PASS([[stats objectForKey: @"Fires"] intValue] == 4,
+    "timer fires are counted");
+  PASS([[stats objectForKey: @"Timers"] intValue] == 0,
+    "fired and invalidated timers are removed");
+  PASS([[stats objectForKey: @"MaxLateness"] doubleValue] >= 0.0
+    && [[stats objectForKey: @"Lateness"] doubleValue]
+    >= [[stats objectForKey: @"MaxLateness"] doubleValue],
+    "timer lateness is recorded");
+  PASS([loop timerStatisticsForMode: @"NoSuchMode"] == nil,
+    "there are no statistics for an unused mode");
+
+  [r->order removeAllObjects];
+  add(r, @"f", 0.2);
+  t = add(r, @"e", 5.0);
+  [loop addTimer: t forMode: @"OtherMode"];
+  [t setFireDate: [NSDate dateWithTimeIntervalSinceNow: 5.0]];
+  [t setFireDate: [NSDate dateWithTimeIntervalSinceNow: 0.1]];
+  [loop runUntilDate: [NSDate dateWithTimeIntervalSinceNow: 0.4]];
+  expect = [NSArray arrayWithObjects: @"e", @"f", nil];
+  PASS_EQUAL(r->order, expect,
+    "a timer in more than one mode is reordered when moved earlier");
+  stats = [loop timerStatisticsForMode: NSDefaultRunLoopMode];
+  PASS([[stats objectForKey: @"Timers"] intValue] == 0,
+    "a timer moved earlier is removed once fired");
+
+  [arp release]; arp = nil;
+  return 0;
+}
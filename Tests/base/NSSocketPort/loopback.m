@@ -0,0 +1,203 @@
+#import "Testing.h"
+#import <Foundation/Foundation.h>
+
+@interface	Receiver : NSObject
+{
+@public
+  NSSocketPort		*port;
+  NSMutableArray	*messages;
+  NSLock		*lock;
+  BOOL			ready;
+  BOOL			finished;
+}
+@end
+
+@implementation	Receiver
+- (void) dealloc
+{
+  [port release];
+  [messages release];
+  [lock release];
+  [super dealloc];
+}
+
+- (void) handlePortMessage: (NSPortMessage*)m
+{
+  [lock lock];
+  [messages addObject: m];
+  [lock unlock];
+}
+
+- (id) init
+{
+  if ((self = [super init]) != nil)
+    {
+      port = (NSSocketPort*)[NSSocketPort new];
+      messages = [NSMutableArray new];
+      lock = [NSLock new];
+      [port setDelegate: self];
+    }
+  return self;
+}
+
+- (NSUInteger) count
+{
+  NSUInteger	c;
+
+  [lock lock];
+  c = [messages count];
+  [lock unlock];
+  return c;
+}
+
+- (void) run
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSRunLoop		*loop = [NSRunLoop currentRunLoop];
+
+  [loop addPort: port forMode: NSDefaultRunLoopMode];
+  ready = YES;
+  while (finished == NO)
+    {
+      NSAutoreleasePool	*pool = [NSAutoreleasePool new];
+
+      [loop runMode: NSDefaultRunLoopMode
+	 beforeDate: [NSDate dateWithTimeIntervalSinceNow: 0.1]];
+      [pool release];
+    }
+  [loop removePort: port forMode: NSDefaultRunLoopMode];
+  [arp release];
+}
+@end
+
+static NSData *
+pattern(NSUInteger length, unsigned seed)
+{
+  NSMutableData	*d = [NSMutableData dataWithLength: length];
+  uint8_t	*p = [d mutableBytes];
+  NSUInteger	i;
+
+  for (i = 0; i < length; i++)
+    {
+      p[i] = (uint8_t)(i * 7 + seed);
+    }
+  return d;
+}
+
+static void
+waitFor(Receiver *r, NSUInteger count)
+{
+  NSDate	*limit = [NSDate dateWithTimeIntervalSinceNow: 10.0];
+
+  while ([r count] < count && [limit timeIntervalSinceNow] > 0)
+    {
+      [NSThread sleepForTimeInterval: 0.01];
+    }
+}
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  Receiver		*r = [Receiver new];
+  NSSocketPort		*local = (NSSocketPort*)[NSSocketPort port];
+  NSSocketPort		*other = (NSSocketPort*)[NSSocketPort port];
+  NSData		*small = [@"hello" dataUsingEncoding: NSASCIIStringEncoding];
+  NSData		*large = pattern(1024 * 1024 + 3, 1);
+  NSData		*medium = pattern(100000, 2);
+  NSData		*empty = [NSData data];
+  NSMutableArray	*sent = [NSMutableArray array];
+  NSPortMessage		*m;
+  NSArray		*c;
+  BOOL			ok;
+  unsigned		i;
+
+  [NSThread detachNewThreadSelector: @selector(run)
+			   toTarget: r
+			 withObject: nil];
+  while (r->ready == NO)
+    {
+      [NSThread sleepForTimeInterval: 0.01];
+    }
+
+  c = [NSArray arrayWithObjects: small, large, other, empty, medium, nil];
+  m = [[NSPortMessage alloc] initWithSendPort: r->port
+				  receivePort: local
+				   components: c];
+  [m setMsgid: 42];
+  PASS([m sendBeforeDate: [NSDate dateWithTimeIntervalSinceNow: 10.0]],
+    "a message with several items is sent");
+  [m release];
+  waitFor(r, 1);
+  PASS([r count] == 1, "the message is received");
+  if ([r count] == 1)
+    {
+      NSArray	*got;
+
+      m = [r->messages objectAtIndex: 0];
+      got = [m components];
+      PASS([m msgid] == 42, "the message id is received");
+      PASS([got count] == 5, "all the items are received");
+      if ([got count] == 5)
+	{
+	  PASS_EQUAL([got objectAtIndex: 0], small,
+	    "a small data item is received intact");
+	  PASS_EQUAL([got objectAtIndex: 1], large,
+	    "a large data item is received intact");
+	  PASS([[got objectAtIndex: 2] isKindOfClass: [NSSocketPort class]]
+	    && [[got objectAtIndex: 2] portNumber] == [other portNumber],
+	    "a port item is received");
+	  PASS_EQUAL([got objectAtIndex: 3], empty,
+	    "an empty data item is received");
+	  PASS_EQUAL([got objectAtIndex: 4], medium,
+	    "a data item following a port item is received intact");
+	}
+      PASS([[m sendPort] isKindOfClass: [NSSocketPort class]]
+	&& [(NSSocketPort*)[m sendPort] portNumber] == [local portNumber],
+	"the reply port is received");
+    }
+
+  /* A run of messages alternating small and large items.
+   */
+  [r->lock lock];
+  [r->messages removeAllObjects];
+  [r->lock unlock];
+  ok = YES;
+  for (i = 0; i < 20; i++)
+    {
+      NSData	*d = pattern((i % 2) ? 300000 + i : 10 + i, i);
+
+      [sent addObject: d];
+      c = [NSArray arrayWithObjects: d, small, nil];
+      m = [[NSPortMessage alloc] initWithSendPort: r->port
+				      receivePort: local
+				       components: c];
+      [m setMsgid: i];
+      if ([m sendBeforeDate: [NSDate dateWithTimeIntervalSinceNow: 10.0]] == NO)
+	{
+	  ok = NO;
+	}
+      [m release];
+    }
+  PASS(ok, "a run of messages is sent");
+  waitFor(r, 20);
+  ok = ([r count] == 20) ? YES : NO;
+  for (i = 0; ok == YES && i < 20; i++)
+    {
+      m = [r->messages objectAtIndex: i];
+      c = [m components];
+      if ([m msgid] != i || [c count] != 2
+	|| [[c objectAtIndex: 0] isEqual: [sent objectAtIndex: i]] == NO
+	|| [[c objectAtIndex: 1] isEqual: small] == NO)
+	{
+	  ok = NO;
+	}
+    }
+  PASS(ok, "a run of messages is received intact and in order");
+
+  r->finished = YES;
+  [NSThread sleepForTimeInterval: 0.5];
+  [r->port invalidate];
+  [r release];
+  [arp release]; arp = nil;
+  return 0;
+}
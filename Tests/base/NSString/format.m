@@ -0,0 +1,69 @@
+#import "ObjectTesting.h"
+#import <Foundation/NSAutoreleasePool.h>
+#import <Foundation/NSString.h>
+
+static NSString *
+widthFormat(int width, int value)
+{
+  return [NSString stringWithFormat: @"[%*d]", width, value];
+}
+
+int main()
+{
+  NSAutoreleasePool   *arp = [NSAutoreleasePool new];
+  NSMutableString	*m;
+  NSString		*s;
+  unichar		u[2] = { 'x', 0x20ac };
+  int			i;
+
+  /* Use the same constant formats repeatedly so that the cached
+   * parse of each format is exercised as well as the first parse.
+   */
+  for (i = 0; i < 3; i++)
+    {
+      s = [NSString stringWithFormat: @"%d-%lu-%.3f", 42, 7UL, 1.5];
+      PASS_EQUAL(s, @"42-7-1.500", "integer and float formats work");
+
+      s = [NSString stringWithFormat: @"<%@>", @"abc"];
+      PASS_EQUAL(s, @"<abc>", "%%@ with an ascii string works");
+
+      s = [NSString stringWithFormat: @"<%5@|%-5@>", @"ab", @"cd"];
+      PASS_EQUAL(s, @"<   ab|cd   >", "%%@ with padding works");
+
+      s = [NSString stringWithFormat: @"<%.2@>", @"abcdef"];
+      PASS_EQUAL(s, @"<ab>", "%%@ with precision works");
+
+      s = [NSString stringWithFormat: @"%2$@ %1$@", @"world", @"hello"];
+      PASS_EQUAL(s, @"hello world", "positional arguments work");
+
+      s = [NSString stringWithFormat: @"%@",
+	[NSString stringWithCharacters: u length: 2]];
+      PASS([s length] == 2 && [s characterAtIndex: 1] == 0x20ac,
+	"%%@ with a non-latin1 string works");
+
+      s = [NSString stringWithFormat: @"%@%@", @"ab",
+	[NSString stringWithCharacters: u length: 2]];
+      PASS([s length] == 4 && [s characterAtIndex: 3] == 0x20ac,
+	"8-bit output widens for a later unicode argument");
+
+      s = [NSString stringWithFormat: @"no specifiers"];
+      PASS_EQUAL(s, @"no specifiers", "format without specifiers works");
+    }
+
+  /* The cached parse must not retain '*' widths between calls.
+   */
+  PASS_EQUAL(widthFormat(4, 1), @"[   1]", "'*' width is used");
+  PASS_EQUAL(widthFormat(-4, 1), @"[1   ]", "negative '*' width is used");
+  PASS_EQUAL(widthFormat(2, 1), @"[ 1]", "'*' width is not cached");
+
+  m = [NSMutableString stringWithString: @"a"];
+  [m appendFormat: @"%@%d", m, 1];
+  PASS_EQUAL(m, @"aa1", "appending a string to itself works");
+
+  s = [NSString stringWithFormat: [NSString stringWithFormat: @"%@", @"%d"],
+    99];
+  PASS_EQUAL(s, @"99", "non-constant format works");
+
+  [arp release]; arp = nil;
+  return 0;
+}
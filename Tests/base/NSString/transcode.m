@@ -0,0 +1,113 @@
+#import "Testing.h"
+#import <Foundation/Foundation.h>
+
+/* Checks conversions between 8-bit strings and UTF-8, using strings
+ * long enough that runs of ASCII are handled a vector at a time and
+ * with non-ASCII characters at every position within a vector.
+ */
+static NSString *
+latin1String(NSUInteger length, NSUInteger at)
+{
+  unsigned char	*b = malloc(length);
+  NSString	*s;
+  NSUInteger	i;
+
+  for (i = 0; i < length; i++)
+    {
+      b[i] = 'a' + i % 26;
+    }
+  if (at < length)
+    {
+      b[at] = 0xe9;	// e acute
+    }
+  s = [[NSString alloc] initWithBytes: b
+			       length: length
+			     encoding: NSISOLatin1StringEncoding];
+  free(b);
+  return [s autorelease];
+}
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSString		*s;
+  NSString		*t;
+  NSData		*d;
+  const char		*u;
+  char			buf[200];
+  unichar		c;
+  NSUInteger		i;
+  BOOL			ok;
+
+  ok = YES;
+  for (i = 0; i <= 100 && ok; i++)
+    {
+      s = latin1String(100, i);
+      u = [s UTF8String];
+      if (i < 100)
+	{
+	  ok = strlen(u) == 101
+	    && (unsigned char)u[i] == 0xc3 && (unsigned char)u[i + 1] == 0xa9;
+	}
+      else
+	{
+	  ok = strlen(u) == 100;
+	}
+      t = [[[NSString alloc] initWithBytes: u
+				    length: strlen(u)
+				  encoding: NSUTF8StringEncoding] autorelease];
+      ok = ok && [t isEqual: s];
+      d = [s dataUsingEncoding: NSUTF8StringEncoding];
+      ok = ok && [d length] == strlen(u) && memcmp([d bytes], u, strlen(u)) == 0;
+      ok = ok && [s getCString: buf maxLength: sizeof(buf)
+		      encoding: NSUTF8StringEncoding]
+	&& strcmp(buf, u) == 0;
+    }
+  PASS(ok, "ISO-8859-1 text round trips through UTF-8");
+
+  s = latin1String(100, 50);
+  PASS([s getCString: buf maxLength: 101 encoding: NSUTF8StringEncoding] == NO,
+    "-getCString:maxLength:encoding: fails when UTF-8 does not fit");
+  PASS([s getCString: buf maxLength: 102 encoding: NSUTF8StringEncoding] == YES
+    && strlen(buf) == 101, "-getCString:maxLength:encoding: fits exactly");
+
+  s = latin1String(100, 100);
+  PASS([s getCString: buf maxLength: sizeof(buf)
+	    encoding: NSASCIIStringEncoding] && strlen(buf) == 100,
+    "ASCII text converts to an ASCII C string");
+  d = [s dataUsingEncoding: NSASCIIStringEncoding];
+  PASS([d length] == 100 && memcmp([d bytes], buf, 100) == 0,
+    "ASCII text converts to ASCII data");
+  s = latin1String(100, 70);
+  PASS_EXCEPTION([s getCString: buf maxLength: sizeof(buf)
+			encoding: NSASCIIStringEncoding];,
+    NSCharacterConversionException,
+    "non-ASCII text does not convert to an ASCII C string");
+  PASS([s dataUsingEncoding: NSASCIIStringEncoding] == nil,
+    "non-ASCII text does not convert to ASCII data");
+
+  u = "\xe6\x97\xa5\xe6\x9c\xac abcdefghijklmnopqrstuvwxyz \xf0\x9f\x98\x80";
+  s = [NSString stringWithUTF8String: u];
+  c = [s characterAtIndex: 0];
+  PASS([s length] == 32 && c == 0x65e5
+    && [s characterAtIndex: 30] == 0xd83d && [s characterAtIndex: 31] == 0xde00,
+    "UTF-8 outside ISO-8859-1 decodes to the right characters");
+  PASS(strcmp([s UTF8String], u) == 0, "and converts back to UTF-8");
+
+  s = [[NSString alloc] initWithBytes: "abc\xc3" length: 4
+			     encoding: NSUTF8StringEncoding];
+  PASS(s == nil, "truncated UTF-8 is rejected");
+  s = [[NSString alloc] initWithBytes: "abc\xed\xa0\x80" length: 6
+			     encoding: NSUTF8StringEncoding];
+  PASS(s == nil, "UTF-8 for a surrogate is rejected");
+  s = [[NSString alloc] initWithBytes: "abc\xef\xbf\xbe" length: 6
+			     encoding: NSUTF8StringEncoding];
+  PASS(s == nil, "UTF-8 for a non-character is rejected");
+  s = [[NSString alloc] initWithBytes: "abc\xe0\x81\x81" length: 6
+			     encoding: NSUTF8StringEncoding];
+  PASS([s isEqual: @"abcA"], "overlong UTF-8 is still accepted");
+  [s release];
+
+  [arp release]; arp = nil;
+  return 0;
+}
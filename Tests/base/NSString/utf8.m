@@ -0,0 +1,163 @@
+#import "Testing.h"
+#import <Foundation/Foundation.h>
+
+/* Strings created from UTF-8 which does not fit in eight bits keep the
+ * UTF-8, so check that they behave exactly like the same characters
+ * held as UTF-16.
+ */
+static NSData *
+utf8Data(unichar *u, NSUInteger count)
+{
+  NSMutableData	*d = [NSMutableData data];
+  NSUInteger	i;
+
+  for (i = 0; i < count; i++)
+    {
+      uint8_t	b[4];
+      uint32_t	c;
+
+      switch (i % 7)
+	{
+	  case 0: c = 0x4e00 + i % 500; break;		// three bytes
+	  case 3: c = 0x1f600 + i % 50; break;		// surrogate pair
+	  case 5: c = 0x3b1 + i % 20; break;		// two bytes
+	  default: c = 'a' + i % 26; break;
+	}
+      if (c < 0x80)
+	{
+	  b[0] = c;
+	  [d appendBytes: b length: 1];
+	}
+      else if (c < 0x800)
+	{
+	  b[0] = 0xc0 | (c >> 6);
+	  b[1] = 0x80 | (c & 0x3f);
+	  [d appendBytes: b length: 2];
+	}
+      else if (c < 0x10000)
+	{
+	  b[0] = 0xe0 | (c >> 12);
+	  b[1] = 0x80 | ((c >> 6) & 0x3f);
+	  b[2] = 0x80 | (c & 0x3f);
+	  [d appendBytes: b length: 3];
+	}
+      else
+	{
+	  b[0] = 0xf0 | (c >> 18);
+	  b[1] = 0x80 | ((c >> 12) & 0x3f);
+	  b[2] = 0x80 | ((c >> 6) & 0x3f);
+	  b[3] = 0x80 | (c & 0x3f);
+	  [d appendBytes: b length: 4];
+	}
+      if (c > 0xffff)
+	{
+	  c -= 0x10000;
+	  *u++ = 0xd800 + (c >> 10);
+	  *u++ = 0xdc00 + (c & 0x3ff);
+	}
+      else
+	{
+	  *u++ = c;
+	}
+    }
+  return d;
+}
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  unichar		u[3000];
+  unichar		buf[3000];
+  NSData		*d;
+  NSString		*s;
+  NSString		*w;
+  NSString		*t;
+  NSScanner		*scanner;
+  NSString		*word;
+  NSUInteger		len;
+  NSUInteger		i;
+  BOOL			ok;
+
+  d = utf8Data(u, 2000);
+  s = [[[NSString alloc] initWithData: d encoding: NSUTF8StringEncoding]
+    autorelease];
+  len = [s length];
+  w = [NSString stringWithCharacters: u length: len];
+  PASS(len == 2000 + 2000 / 7 + 1, "the length counts surrogate pairs");
+  PASS([s isEqual: w] && [w isEqual: s] && [s hash] == [w hash],
+    "a UTF-8 string equals the same characters in UTF-16");
+  PASS([s compare: w] == NSOrderedSame, "and compares the same");
+
+  ok = YES;
+  for (i = 0; i < len && ok; i++)
+    {
+      ok = [s characterAtIndex: i] == u[i];
+    }
+  PASS(ok, "-characterAtIndex: is right for every index");
+  ok = YES;
+  for (i = len; i-- > 0 && ok; )
+    {
+      ok = [s characterAtIndex: i] == u[i];
+    }
+  PASS(ok, "-characterAtIndex: is right going backwards");
+  PASS_EXCEPTION([s characterAtIndex: len];, NSRangeException,
+    "-characterAtIndex: raises beyond the end");
+
+  ok = YES;
+  for (i = 0; i < len && ok; i += 13)
+    {
+      NSUInteger	l = (len - i > 101) ? 101 : len - i;
+
+      [s getCharacters: buf range: NSMakeRange(i, l)];
+      ok = memcmp(buf, u + i, l * sizeof(unichar)) == 0;
+    }
+  PASS(ok, "-getCharacters:range: is right, including split pairs");
+
+  PASS(strlen([s UTF8String]) == [d length]
+    && memcmp([s UTF8String], [d bytes], [d length]) == 0,
+    "-UTF8String gives back the original UTF-8");
+  PASS([[s dataUsingEncoding: NSUTF8StringEncoding] isEqual: d],
+    "-dataUsingEncoding: gives back the original UTF-8");
+  PASS([s lengthOfBytesUsingEncoding: NSUTF8StringEncoding] == [d length],
+    "-lengthOfBytesUsingEncoding: counts the UTF-8");
+  PASS([[s dataUsingEncoding: NSUnicodeStringEncoding]
+    isEqual: [w dataUsingEncoding: NSUnicodeStringEncoding]],
+    "conversion to UTF-16 is the same");
+
+  t = [s substringWithRange: NSMakeRange(100, 50)];
+  PASS([t isEqual: [w substringWithRange: NSMakeRange(100, 50)]],
+    "-substringWithRange: is right");
+  t = [s substringWithRange: NSMakeRange(4, 2)];
+  PASS([t length] == 2 && [t characterAtIndex: 0] == u[4]
+    && [t characterAtIndex: 1] == u[5],
+    "-substringWithRange: can split a surrogate pair");
+
+  t = [[s copy] autorelease];
+  PASS([t isEqual: s], "a copy is equal");
+  t = [[s mutableCopy] autorelease];
+  PASS([t isEqual: s], "a mutable copy is equal");
+  [(NSMutableString*)t appendString: s];
+  PASS([t length] == 2 * len, "a mutable copy can be changed");
+  t = [s stringByAppendingString: @"end"];
+  PASS([t hasSuffix: @"end"] && [t hasPrefix: s],
+    "a UTF-8 string can be appended to");
+
+  t = [NSKeyedUnarchiver unarchiveObjectWithData:
+    [NSKeyedArchiver archivedDataWithRootObject: s]];
+  PASS([t isEqual: s], "a UTF-8 string survives keyed archiving");
+
+  s = [NSString stringWithUTF8String: "caf\xc3\xa9 \xe2\x82\xac 42"];
+  scanner = [NSScanner scannerWithString: s];
+  PASS([scanner scanUpToString: @" " intoString: &word]
+    && [word isEqual: [NSString stringWithUTF8String: "caf\xc3\xa9"]],
+    "a scanner can read a UTF-8 string");
+  t = [NSString stringWithUTF8String: "\xe2\x82\xac"];
+  PASS([s rangeOfString: t].location == 5,
+    "-rangeOfString: finds a character beyond ISO-8859-1");
+  PASS([s canBeConvertedToEncoding: NSUTF8StringEncoding]
+    && ![s canBeConvertedToEncoding: NSASCIIStringEncoding],
+    "-canBeConvertedToEncoding: is right");
+
+  [arp release]; arp = nil;
+  return 0;
+}
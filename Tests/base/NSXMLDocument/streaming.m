@@ -0,0 +1,78 @@
+#import "Testing.h"
+#import <Foundation/Foundation.h>
+
+int main()
+{
+  START_SET("NSXMLDocument streaming")
+# ifndef __has_feature
+# define __has_feature(x) 0
+# endif
+# if __has_feature(blocks)
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSMutableString	*xml = [NSMutableString stringWithString: @"<list>"];
+  NSData		*data;
+  NSError		*error = nil;
+  __block unsigned	count = 0;
+  __block unsigned	good = 0;
+  __block NSXMLElement	*kept = nil;
+  unsigned		i;
+  BOOL			ok;
+
+  for (i = 0; i < 1000; i++)
+    {
+      [xml appendFormat: @"<record id=\"%u\"><value>%u</value></record>",
+	i, i * 2];
+    }
+  [xml appendString: @"</list>"];
+  data = [xml dataUsingEncoding: NSUTF8StringEncoding];
+
+  ok = [NSXMLDocument enumerateElementsNamed: @"record"
+				      inData: data
+				     options: 0
+				       error: &error
+				  usingBlock: ^(NSXMLElement *e, BOOL *stop) {
+    unsigned	n = [[[e attributeForName: @"id"] stringValue] intValue];
+
+    if (nil == [e parent]
+      && [[[e childAtIndex: 0] stringValue] intValue] == n * 2)
+      {
+	good++;
+      }
+    if (n == 500)
+      {
+	kept = [e retain];
+      }
+    count++;
+  }];
+  PASS(ok && nil == error, "streaming a well formed document succeeds");
+  PASS(count == 1000 && good == 1000, "every matching element is passed");
+  PASS_EQUAL([kept XMLString],
+    @"<record id=\"500\"><value>1000</value></record>",
+    "an element may be retained beyond the block");
+  [kept release];
+
+  count = 0;
+  [NSXMLDocument enumerateElementsNamed: @"record"
+				 inData: data
+				options: 0
+				  error: NULL
+			     usingBlock: ^(NSXMLElement *e, BOOL *stop) {
+    if (++count == 10) *stop = YES;
+  }];
+  PASS(count == 10, "enumeration may be stopped");
+
+  data = [@"<list><record/><record>" dataUsingEncoding: NSUTF8StringEncoding];
+  ok = [NSXMLDocument enumerateElementsNamed: @"record"
+				      inData: data
+				     options: 0
+				       error: &error
+				  usingBlock: ^(NSXMLElement *e, BOOL *stop) {}];
+  PASS(NO == ok && nil != error, "malformed data is reported as an error");
+
+  [arp release]; arp = nil;
+# else
+  SKIP("No Blocks support in the compiler.")
+# endif
+  END_SET("NSXMLDocument streaming")
+  return 0;
+}
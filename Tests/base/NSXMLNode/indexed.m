@@ -0,0 +1,79 @@
+#import "Testing.h"
+#import <Foundation/NSAutoreleasePool.h>
+#import <Foundation/NSXMLNode.h>
+#import <Foundation/NSXMLDocument.h>
+#import <Foundation/NSXMLElement.h>
+
+int main()
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  NSXMLElement		*root = [NSXMLElement elementWithName: @"root"];
+  NSXMLDocument		*doc;
+  NSXMLElement		*e;
+  NSArray		*a;
+  NSArray		*n;
+  NSXMLElement		*other;
+  NSUInteger		count;
+  unsigned		i;
+
+  for (i = 0; i < 100; i++)
+    {
+      e = [NSXMLElement elementWithName: @"item"
+			    stringValue: [NSString stringWithFormat: @"%u", i]];
+      [root addChild: e];
+    }
+  PASS([root childCount] == 100, "children are counted");
+  PASS_EQUAL([[root childAtIndex: 42] stringValue], @"42",
+    "indexed access returns the correct child");
+  PASS(nil == [root childAtIndex: 100], "index equal to count gives nil");
+  PASS_EXCEPTION([root childAtIndex: 101], NSRangeException,
+    "index beyond count raises");
+
+  a = [root children];
+  PASS([a count] == 100 && [a objectAtIndex: 99] == [root childAtIndex: 99],
+    "children array matches indexed access");
+
+  [root removeChildAtIndex: 0];
+  PASS([root childCount] == 99, "removing a child updates the count");
+  PASS_EQUAL([[root childAtIndex: 0] stringValue], @"1",
+    "removing a child updates indexed access");
+  PASS([a count] == 100, "a previously returned array is unchanged");
+
+  e = [NSXMLElement elementWithName: @"first" stringValue: @"x"];
+  [root insertChild: e atIndex: 0];
+  PASS([root childAtIndex: 0] == e, "inserting a child updates indexed access");
+  PASS([[root children] objectAtIndex: 0] == e,
+    "inserting a child updates the children array");
+
+  [e setStringValue: @"y"];
+  PASS([e childCount] == 1, "setting the string value replaces children");
+
+  doc = [[[NSXMLDocument alloc] initWithRootElement: root] autorelease];
+  for (i = 0; i < 3; i++)
+    {
+      n = [doc nodesForXPath: @"/root/item[3]" error: NULL];
+      PASS([n count] == 1 && [n lastObject] == [root childAtIndex: 3],
+	"a repeated XPath query gives the same result");
+    }
+  n = [doc nodesForXPath: @"//first" error: NULL];
+  PASS([n count] == 1 && [n lastObject] == e, "a different query works");
+  [e detach];
+  n = [doc nodesForXPath: @"//first" error: NULL];
+  PASS([n count] == 0, "a cached query sees changes to the document");
+
+  other = [NSXMLElement elementWithName: @"other"];
+  [other addChild: [NSXMLElement elementWithName: @"a"]];
+  PASS([other childCount] == 1, "another tree has its own children");
+  count = [root childCount];
+  e = (NSXMLElement*)[root childAtIndex: 1];
+  [other childAtIndex: 0];
+  [e detach];
+  [other addChild: e];
+  PASS([root childCount] == count - 1 && [root childAtIndex: 1] != e,
+    "moving a child updates the old parent");
+  PASS([other childCount] == 2 && [other childAtIndex: 1] == e,
+    "moving a child updates the new parent");
+
+  [arp release]; arp = nil;
+  return 0;
+}
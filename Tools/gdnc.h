@@ -27,6 +27,12 @@
 			    userInfo: (NSData*)info
 			    selector: (NSString*)aSelector
 				  to: (uint64_t)observer;
+/* The batch is an NSArchiver archive of an array with an entry for each
+ * notification: an array of the name, the object (NSNull if nil), the
+ * archived userInfo and an array of selector names and observers (as
+ * NSNumber objects) to which the notification is to be posted.
+ */
+- (oneway void) postNotifications: (NSData*)batch;
 @end
 
 @protocol	GDNCProtocol
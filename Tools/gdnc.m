@@ -21,6 +21,7 @@
 
 #include <stdio.h>
 
+#import	"Foundation/NSArchiver.h"
 #import	"Foundation/NSArray.h"
 #import	"Foundation/NSAutoreleasePool.h"
 #import	"Foundation/NSBundle.h"
@@ -32,12 +33,14 @@
 #import	"Foundation/NSHashTable.h"
 #import	"Foundation/NSHost.h"
 #import	"Foundation/NSNotification.h"
+#import	"Foundation/NSNull.h"
 #import	"Foundation/NSPort.h"
 #import	"Foundation/NSPortNameServer.h"
 #import	"Foundation/NSProcessInfo.h"
 #import	"Foundation/NSRunLoop.h"
 #import	"Foundation/NSTask.h"
 #import	"Foundation/NSUserDefaults.h"
+#import	"Foundation/NSValue.h"
 
 
 #if	defined(__MINGW__)
@@ -202,6 +205,7 @@ ihandler(int sig)
                             userInfo: (NSData*)info
                             selector: (NSString*)aSelector
                                   to: (uint64_t)observer;
+- (oneway void) postNotifications: (NSData*)batch;
 @end
 @implementation	NSDistributedNotificationCenterGDNCDummy
 - (oneway void) postNotificationName: (NSString*)name
@@ -212,6 +216,10 @@ ihandler(int sig)
 {
   return;
 }
+- (oneway void) postNotifications: (NSData*)batch
+{
+  return;
+}
 @end
 
 @interface	GDNCNotification : NSObject
@@ -220,6 +228,7 @@ ihandler(int sig)
   NSString	*name;
   NSString	*object;
   NSData	*info;
+  uint64_t	sequence;	/* Order of posting.	*/
 }
 + (GDNCNotification*) notificationWithName: (NSString*)notificationName
 				    object: (NSString*)notificationObject
@@ -254,14 +263,20 @@ ihandler(int sig)
 
 
 /*
- *	Information about a notification observer.
+ *	Information about a client (an NSDistributedNotificationCenter).
+ *	The pending array holds the observers with notifications to be
+ *	delivered at the next flush.  The batching flag is positive if the
+ *	client accepts batches of notifications, negative if it only
+ *	accepts them one at a time, and zero until we find out.
  */
 @interface	GDNCClient : NSObject
 {
 @public
   BOOL			suspended;
+  int			batching;
   id <GDNCClient>	client;
   NSMutableArray	*observers;
+  NSMutableArray	*pending;
 }
 @end
 
@@ -269,12 +284,14 @@ ihandler(int sig)
 - (void) dealloc
 {
   RELEASE(observers);
+  RELEASE(pending);
   [super dealloc];
 }
 
 - (id) init
 {
   observers = [NSMutableArray new];
+  pending = [NSMutableArray new];
   return self;
 }
 @end
@@ -294,6 +311,8 @@ ihandler(int sig)
   GDNCClient		*client;
   NSMutableArray	*queue;
   NSNotificationSuspensionBehavior	behavior;
+  uint64_t		generation;	/* Last post which matched.	*/
+  BOOL			pending;	/* In the client's pending array. */
 }
 @end
 
@@ -323,6 +342,11 @@ ihandler(int sig)
   NSHashTable		*allObservers;
   NSMutableDictionary	*observersForNames;
   NSMutableDictionary	*observersForObjects;
+  NSMutableArray	*pendingClients;
+  NSTimeInterval	flushInterval;
+  BOOL			flushScheduled;
+  uint64_t		generation;
+  uint64_t		sequence;
 }
 
 - (void) addObserver: (uint64_t)anObserver
@@ -337,6 +361,8 @@ ihandler(int sig)
 
 - (id) connectionBecameInvalid: (NSNotification*)notification;
 
+- (void) flush;
+
 - (oneway void) postNotificationName: (NSString*)notificationName
 			      object: (NSString*)notificationObject
 			    userInfo: (NSData*)d
@@ -399,6 +425,7 @@ ihandler(int sig)
    */
   RELEASE(observersForNames);
   RELEASE(observersForObjects);
+  RELEASE(pendingClients);
   [super dealloc];
 }
 
@@ -418,8 +445,20 @@ ihandler(int sig)
   allObservers = NSCreateHashTable(NSNonOwnedPointerHashCallBacks, 0);
   observersForNames = [NSMutableDictionary new];
   observersForObjects = [NSMutableDictionary new];
+  pendingClients = [NSMutableArray new];
 
   defs = [NSUserDefaults standardUserDefaults];
+  /*
+   *	Notifications posted within the flush interval are sent to each
+   *	client together, so a burst of posts costs each client a single
+   *	message.  With the default of zero they are sent as soon as the
+   *	run loop has handled the messages which are already waiting.
+   */
+  flushInterval = [defs floatForKey: @"GDNCFlushInterval"];
+  if (flushInterval < 0.0)
+    {
+      flushInterval = 0.0;
+    }
   hostname = [defs stringForKey: @"NSHost"];
   if ([hostname length] > 0 || [defs boolForKey: @"GSPublic"] == YES)
     {
@@ -734,6 +773,209 @@ ihandler(int sig)
   RELEASE(info);
 }
 
+/*
+ *	Post the notifications queued for an observer one at a time, for
+ *	clients which do not accept batches.
+ */
+- (void) deliverTo: (GDNCObserver*)obs
+{
+  /*
+   *	Post notifications to the observer until:
+   *		an exception		(obs is set to nil)
+   *		the queue is empty	([obs->queue count] == 0)
+   *		the observer is removed	(obs is not in allObservers)
+   */
+  while (obs != nil && [obs->queue count] > 0
+    && NSHashGet(allObservers, obs) != 0)
+    {
+      GDNCNotification *n;
+
+      n = RETAIN([obs->queue objectAtIndex: 0]);
+      NS_DURING
+	{
+	  [obs->queue removeObjectAtIndex: 0];
+	  if (debugging)
+	    NSLog(@"Posting to observer %llu with %@",
+	      (unsigned long long)obs->observer, n);
+	  [obs->client->client postNotificationName: n->name
+					     object: n->object
+					   userInfo: n->info
+					   selector: obs->selector
+						 to: obs->observer];
+	}
+      NS_HANDLER
+	{
+	  obs = nil;
+	  NSLog(@"Problem posting notification to client: %@",
+	    localException);
+	}
+      NS_ENDHANDLER
+      RELEASE(n);
+    }
+}
+
+static NSComparisonResult
+bySequence(GDNCNotification *a, GDNCNotification *b, void *context)
+{
+  if (a->sequence < b->sequence)
+    return NSOrderedAscending;
+  if (a->sequence > b->sequence)
+    return NSOrderedDescending;
+  return NSOrderedSame;
+}
+
+/*
+ *	Send a client everything queued for its pending observers in one
+ *	message.  A notification queued for several observers in the client
+ *	is sent once, with its userInfo, and a list of the observers.
+ */
+- (void) deliverToClient: (GDNCClient*)info observers: (NSArray*)observers
+{
+  NSMapTable		*targets;
+  NSMutableArray	*entries;
+  NSMutableArray	*batch;
+  NSNull		*null = [NSNull null];
+  NSData		*data;
+  unsigned		count = [observers count];
+  unsigned		pos;
+
+  if (info->batching == 0)
+    {
+      NS_DURING
+	{
+	  if ([(id)info->client respondsToSelector:
+	    @selector(postNotifications:)] == YES)
+	    {
+	      info->batching = 1;
+	    }
+	  else
+	    {
+	      info->batching = -1;
+	    }
+	}
+      NS_HANDLER
+	{
+	  info->batching = -1;
+	}
+      NS_ENDHANDLER
+    }
+  if (info->batching < 0)
+    {
+      for (pos = 0; pos < count; pos++)
+	{
+	  [self deliverTo: [observers objectAtIndex: pos]];
+	}
+      return;
+    }
+
+  targets = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
+    NSObjectMapValueCallBacks, 0);
+  entries = [NSMutableArray arrayWithCapacity: count];
+  for (pos = 0; pos < count; pos++)
+    {
+      GDNCObserver	*obs = [observers objectAtIndex: pos];
+      NSNumber		*observer;
+      unsigned		qCount;
+      unsigned		qPos;
+
+      if (NSHashGet(allObservers, obs) == 0)
+	{
+	  continue;
+	}
+      observer = [NSNumber numberWithUnsignedLongLong: obs->observer];
+      qCount = [obs->queue count];
+      for (qPos = 0; qPos < qCount; qPos++)
+	{
+	  GDNCNotification	*n = [obs->queue objectAtIndex: qPos];
+	  NSMutableArray	*t = NSMapGet(targets, n);
+
+	  if (t == nil)
+	    {
+	      t = [NSMutableArray new];
+	      NSMapInsert(targets, n, t);
+	      RELEASE(t);
+	      [entries addObject: n];
+	    }
+	  [t addObject: obs->selector];
+	  [t addObject: observer];
+	}
+      [obs->queue removeAllObjects];
+    }
+
+  /*
+   *	Observers may have been queued the same notifications in different
+   *	orders of first appearance, so restore the order of posting.
+   */
+  [entries sortUsingFunction: bySequence context: 0];
+  count = [entries count];
+  batch = [NSMutableArray arrayWithCapacity: count];
+  for (pos = 0; pos < count; pos++)
+    {
+      GDNCNotification	*n = [entries objectAtIndex: pos];
+
+      [batch addObject: [NSArray arrayWithObjects:
+	n->name,
+	(n->object == nil ? (id)null : (id)n->object),
+	(n->info == nil ? (id)null : (id)n->info),
+	NSMapGet(targets, n),
+	nil]];
+    }
+  NSFreeMapTable(targets);
+
+  if (count > 0)
+    {
+      data = [NSArchiver archivedDataWithRootObject: batch];
+      NS_DURING
+	{
+	  if (debugging)
+	    NSLog(@"Posting %u notifications to client %@", count, batch);
+	  [info->client postNotifications: data];
+	}
+      NS_HANDLER
+	{
+	  NSLog(@"Problem posting notifications to client: %@",
+	    localException);
+	}
+      NS_ENDHANDLER
+    }
+}
+
+- (void) flush
+{
+  NSMutableArray	*clients;
+  unsigned		count;
+  unsigned		pos;
+
+  /*
+   *	Take the pending clients so that anything posted while we are
+   *	delivering goes to the next flush.
+   */
+  clients = AUTORELEASE(pendingClients);
+  pendingClients = [NSMutableArray new];
+  flushScheduled = NO;
+
+  count = [clients count];
+  for (pos = 0; pos < count; pos++)
+    {
+      GDNCClient	*info = [clients objectAtIndex: pos];
+      NSArray		*observers;
+      unsigned		oCount;
+      unsigned		oPos;
+
+      observers = AUTORELEASE(info->pending);
+      info->pending = [NSMutableArray new];
+      oCount = [observers count];
+      for (oPos = 0; oPos < oCount; oPos++)
+	{
+	  ((GDNCObserver*)[observers objectAtIndex: oPos])->pending = NO;
+	}
+      if (info->client != nil)
+	{
+	  [self deliverToClient: info observers: observers];
+	}
+    }
+}
+
 - (oneway void) postNotificationName: (NSString*)notificationName
 			      object: (NSString*)notificationObject
 			    userInfo: (NSData*)d
@@ -749,8 +991,11 @@ ihandler(int sig)
   byName = [observersForNames objectForKey: notificationName];
   byObject = [observersForObjects objectForKey: notificationObject];
   /*
-   *	Build up a list of all those observers that should get sent this.
+   *	Build up a list of all those observers that should get sent this,
+   *	marking each with the generation of this post so that an observer
+   *	found by both name and object is only listed once.
    */
+  generation++;
   for (pos = [byName count]; pos > 0; pos--)
     {
       GDNCObserver	*obs = [byName objectAtIndex: pos - 1];
@@ -758,6 +1003,7 @@ ihandler(int sig)
       if (obs->notificationObject == nil
 	|| [obs->notificationObject isEqual: notificationObject])
 	{
+	  obs->generation = generation;
 	  [observers addObject: obs];
 	}
     }
@@ -768,34 +1014,49 @@ ihandler(int sig)
       if (obs->notificationName == nil
 	|| [obs->notificationName isEqual: notificationName])
 	{
-	  if ([observers indexOfObjectIdenticalTo: obs] == NSNotFound)
+	  if (obs->generation != generation)
 	    {
+	      obs->generation = generation;
 	      [observers addObject: obs];
 	    }
 	}
     }
 
   /*
-   *	Build notification object to queue for observer.
+   *	Build notification object to queue for observer.  The same object
+   *	(and so the same userInfo data) is shared by all the observers.
    */
   if ([observers count] > 0)
     {
       notification = [GDNCNotification notificationWithName: notificationName
 						     object: notificationObject
 						       data: d];
+      notification->sequence = ++sequence;
     }
 
   /*
    *	Add the object to the queue for this observer depending on suspension
    *	state of the client NSDistributedNotificationCenter etc.
+   *	Observers which are to be sent their queue are added to the pending
+   *	list of their client, for delivery at the next flush.
    */
   for (pos = [observers count]; pos > 0; pos--)
     {
       GDNCObserver	*obs = [observers objectAtIndex: pos - 1];
+      GDNCClient	*info = obs->client;
 
-      if (obs->client->suspended == NO || deliverImmediately == YES)
+      if (info->suspended == NO || deliverImmediately == YES)
 	{
 	  [obs->queue addObject: notification];
+	  if (obs->pending == NO)
+	    {
+	      obs->pending = YES;
+	      if ([info->pending count] == 0)
+		{
+		  [pendingClients addObject: info];
+		}
+	      [info->pending addObject: obs];
+	    }
 	}
       else
 	{
@@ -817,48 +1078,12 @@ ihandler(int sig)
 	}
     }
 
-  /*
-   *	Now perform the actual posting of the notification to the observers in
-   *	our array.
-   */
-  for (pos = [observers count]; pos > 0; pos--)
+  if (flushScheduled == NO && [pendingClients count] > 0)
     {
-      GDNCObserver	*obs = [observers objectAtIndex: pos - 1];
-
-      if (obs->client->suspended == NO || deliverImmediately == YES)
-	{
-	  /*
-	   *	Post notifications to the observer until:
-	   *		an exception		(obs is set to nil)
-	   *		the queue is empty	([obs->queue count] == 0)
-	   *		the observer is removed	(obs is not in allObservers)
-	   */
-	  while (obs != nil && [obs->queue count] > 0
-	    && NSHashGet(allObservers, obs) != 0)
-	    {
-	      GDNCNotification *n;
-	      n = RETAIN([obs->queue objectAtIndex: 0]);
-	      NS_DURING
-		{
-		  [obs->queue removeObjectAtIndex: 0];
-  if (debugging)
-    NSLog(@"Posting to observer %llu with %@", (unsigned long long)obs->observer, n);
-		  [obs->client->client postNotificationName: n->name
-						     object: n->object
-						   userInfo: n->info
-						   selector: obs->selector
-							 to: obs->observer];
-		}
-	      NS_HANDLER
-		{
-		  obs = nil;
-		  NSLog(@"Problem posting notification to client: %@",
-		    localException);
-		}
-	      NS_ENDHANDLER
-	      RELEASE(n);
-	    }
-	}
+      flushScheduled = YES;
+      [self performSelector: @selector(flush)
+		 withObject: nil
+		 afterDelay: flushInterval];
     }
 }
 
@@ -907,6 +1132,7 @@ ihandler(int sig)
 	{
 	  [self removeObserver: [info->observers objectAtIndex: 0]];
 	}
+      info->client = nil;	/* Nothing more to deliver.	*/
     }
 }
 
@@ -1067,6 +1293,7 @@ ihandler(int sig)
     {
       [self removeObserver: [info->observers objectAtIndex: 0]];
     }
+  info->client = nil;	/* Nothing more to deliver.	*/
   NSMapRemove(table, client);
 }
 
@@ -0,0 +1,449 @@
+/** This tool measures the rate at which an HTTP server handles requests.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of the GNUstep Project
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either
+   version 3 of the License, or (at your option) any later version.
+
+   You should have received a copy of the GNU General Public
+   License along with this program; see the file COPYINGv3.
+   If not, write to the Free Software Foundation,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+   */
+
+#import "common.h"
+
+#import	"Foundation/NSAutoreleasePool.h"
+#import	"Foundation/NSData.h"
+#import	"Foundation/NSDate.h"
+#import	"Foundation/NSDictionary.h"
+#import	"Foundation/NSLock.h"
+#import	"Foundation/NSProcessInfo.h"
+#import	"Foundation/NSThread.h"
+#import	"Foundation/NSUserDefaults.h"
+#import	"GNUstepBase/GSHTTPServer.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/* Buffered reading of responses from a blocking socket.
+ */
+typedef struct {
+  int		fd;
+  size_t	pos;
+  size_t	len;
+  char		buf[65536];
+} Reader;
+
+static struct sockaddr_in	address;
+static NSData			*batch = nil;
+static NSUInteger		requestLength = 0;
+static NSUInteger		perConnection = 0;
+static NSUInteger		depth = 1;
+static NSConditionLock		*done = nil;
+static NSUInteger		completed = 0;
+static NSUInteger		failures = 0;
+
+static BOOL
+fill(Reader *r)
+{
+  ssize_t	n;
+
+  if (r->pos > 0)
+    {
+      memmove(r->buf, r->buf + r->pos, r->len - r->pos);
+      r->len -= r->pos;
+      r->pos = 0;
+    }
+  if (r->len == sizeof(r->buf))
+    {
+      return NO;
+    }
+  n = read(r->fd, r->buf + r->len, sizeof(r->buf) - r->len);
+  if (n <= 0)
+    {
+      return NO;
+    }
+  r->len += n;
+  return YES;
+}
+
+/* Consumes the next line, returning its length without the line end,
+ * or -1 if the connection was closed first.
+ */
+static ssize_t
+nextLine(Reader *r, char **line)
+{
+  char		*eol;
+  ssize_t	len;
+
+  while ((eol = memchr(r->buf + r->pos, '\n', r->len - r->pos)) == 0)
+    {
+      if (fill(r) == NO)
+	{
+	  return -1;
+	}
+    }
+  *line = r->buf + r->pos;
+  len = eol - *line;
+  r->pos += len + 1;
+  if (len > 0 && (*line)[len - 1] == '\r')
+    {
+      len--;
+    }
+  return len;
+}
+
+static BOOL
+skip(Reader *r, unsigned long long count)
+{
+  while (count > 0)
+    {
+      size_t	avail = r->len - r->pos;
+
+      if (avail == 0)
+	{
+	  if (fill(r) == NO)
+	    {
+	      return NO;
+	    }
+	  continue;
+	}
+      if (avail > count)
+	{
+	  avail = (size_t)count;
+	}
+      r->pos += avail;
+      count -= avail;
+    }
+  return YES;
+}
+
+/* Reads one complete response, returning NO if it was not a success
+ * or the connection failed.
+ */
+static BOOL
+readResponse(Reader *r)
+{
+  char		*line;
+  ssize_t	len;
+  int		status;
+  long long	length = -1;
+  BOOL		chunked = NO;
+
+  do
+    {
+      len = nextLine(r, &line);
+      if (len < 12 || strncmp(line, "HTTP/1.", 7) != 0)
+	{
+	  return NO;
+	}
+      status = atoi(line + 9);
+      while ((len = nextLine(r, &line)) > 0)
+	{
+	  if (len > 15 && strncasecmp(line, "content-length:", 15) == 0)
+	    {
+	      length = strtoll(line + 15, 0, 10);
+	    }
+	  else if (len > 18
+	    && strncasecmp(line, "transfer-encoding:", 18) == 0)
+	    {
+	      chunked = (strncasecmp(line + len - 7, "chunked", 7) == 0);
+	    }
+	}
+      if (len < 0)
+	{
+	  return NO;
+	}
+    }
+  while (status == 100);
+
+  if (chunked == YES)
+    {
+      for (;;)
+	{
+	  unsigned long	size;
+
+	  if (nextLine(r, &line) < 0)
+	    {
+	      return NO;
+	    }
+	  size = strtoul(line, 0, 16);
+	  if (size == 0)
+	    {
+	      break;
+	    }
+	  if (skip(r, size + 2) == NO)
+	    {
+	      return NO;
+	    }
+	}
+      while ((len = nextLine(r, &line)) > 0)
+	;	/* Trailers	*/
+      if (len < 0)
+	{
+	  return NO;
+	}
+    }
+  else if (length > 0 && skip(r, length) == NO)
+    {
+      return NO;
+    }
+  return (status >= 200 && status < 300) ? YES : NO;
+}
+
+static BOOL
+writeAll(int fd, const char *bytes, size_t length)
+{
+  while (length > 0)
+    {
+      ssize_t	n = write(fd, bytes, length);
+
+      if (n <= 0)
+	{
+	  return NO;
+	}
+      bytes += n;
+      length -= n;
+    }
+  return YES;
+}
+
+
+@interface	Loader : NSObject
+@end
+
+@implementation	Loader
+
+/* Sends requests on one connection, keeping up to 'depth' of them
+ * outstanding, until all have been answered.
+ */
+- (void) run: (id)ignored
+{
+  NSAutoreleasePool	*arp = [NSAutoreleasePool new];
+  Reader		*r = malloc(sizeof(Reader));
+  NSUInteger		sent = 0;
+  NSUInteger		received = 0;
+  int			one = 1;
+
+  r->pos = r->len = 0;
+  r->fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (r->fd < 0
+    || connect(r->fd, (struct sockaddr*)&address, sizeof(address)) < 0)
+    {
+      __sync_fetch_and_add(&failures, 1);
+    }
+  else
+    {
+      setsockopt(r->fd, IPPROTO_TCP, TCP_NODELAY, (char*)&one, sizeof(one));
+      while (received < perConnection)
+	{
+	  NSUInteger	count = 0;
+
+	  while (sent + count < perConnection
+	    && sent + count - received < depth)
+	    {
+	      count++;
+	    }
+	  if (count > 0)
+	    {
+	      if (writeAll(r->fd, [batch bytes], count * requestLength) == NO)
+		{
+		  __sync_fetch_and_add(&failures, 1);
+		  break;
+		}
+	      sent += count;
+	    }
+	  if (readResponse(r) == NO)
+	    {
+	      __sync_fetch_and_add(&failures, 1);
+	      break;
+	    }
+	  received++;
+	}
+    }
+  if (r->fd >= 0)
+    {
+      close(r->fd);
+    }
+  free(r);
+  __sync_fetch_and_add(&completed, received);
+  [done lock];
+  [done unlockWithCondition: [done condition] + 1];
+  [arp release];
+}
+
+@end
+
+/* The delegate used when the tool runs its own server.
+ */
+@interface	Responder : NSObject
+@end
+
+@implementation	Responder
+
+- (void) HTTPServer: (GSHTTPServer*)server
+      handleRequest: (GSHTTPServerRequest*)request
+{
+  static NSData	*hello = nil;
+
+  if (hello == nil)
+    {
+      hello = [[NSData alloc] initWithBytes: "Hello, world\n" length: 13];
+    }
+  [request setValue: @"text/plain" forHeader: @"Content-Type"];
+  [request respondWithStatus: 200 data: hello];
+}
+
+@end
+
+
+/** <p>This tool measures the rate at which an HTTP/1.1 server handles
+ * requests, using a number of persistent connections (each in its own
+ * thread) and optionally pipelining requests on each connection.
+ * </p>
+ * <p>The tool is configured using the user defaults system:
+ * </p>
+ * <deflist>
+ *   <term>-Host</term>
+ *   <desc>The IPv4 address of the server (default 127.0.0.1)</desc>
+ *   <term>-Port</term>
+ *   <desc>The port of the server (default 8080)</desc>
+ *   <term>-Path</term>
+ *   <desc>The path to request (default /)</desc>
+ *   <term>-Connections</term>
+ *   <desc>The number of connections (default 8)</desc>
+ *   <term>-Requests</term>
+ *   <desc>The number of requests on each connection (default 10000)</desc>
+ *   <term>-Pipeline</term>
+ *   <desc>The number of requests sent ahead of responses (default 1)</desc>
+ *   <term>-Serve</term>
+ *   <desc>If YES, a GSHTTPServer is run in the tool itself, so that the
+ *   test runs entirely over loopback.  Its configuration is set by
+ *   -Workers (default 4) and -ReusePort (default NO)</desc>
+ * </deflist>
+ */
+int
+main(int argc, char** argv, char **env)
+{
+  NSAutoreleasePool	*pool;
+  NSUserDefaults	*defs;
+  NSString		*host;
+  NSString		*path;
+  NSString		*req;
+  NSMutableData		*m;
+  GSHTTPServer		*server = nil;
+  Loader		*loader;
+  NSDate		*start;
+  NSTimeInterval	elapsed;
+  NSInteger		port;
+  NSUInteger		connections;
+  NSUInteger		i;
+
+#ifdef GS_PASS_ARGUMENTS
+  GSInitializeProcess(argc, argv, env);
+#endif
+  pool = [NSAutoreleasePool new];
+  defs = [NSUserDefaults standardUserDefaults];
+
+  host = [defs stringForKey: @"Host"];
+  if (host == nil)
+    {
+      host = @"127.0.0.1";
+    }
+  port = [defs integerForKey: @"Port"];
+  if (port <= 0)
+    {
+      port = 8080;
+    }
+  path = [defs stringForKey: @"Path"];
+  if (path == nil)
+    {
+      path = @"/";
+    }
+  connections = [defs integerForKey: @"Connections"];
+  if (connections == 0)
+    {
+      connections = 8;
+    }
+  perConnection = [defs integerForKey: @"Requests"];
+  if (perConnection == 0)
+    {
+      perConnection = 10000;
+    }
+  depth = [defs integerForKey: @"Pipeline"];
+  if (depth == 0)
+    {
+      depth = 1;
+    }
+
+  if ([defs boolForKey: @"Serve"] == YES)
+    {
+      NSUInteger	workers = [defs integerForKey: @"Workers"];
+
+      host = @"127.0.0.1";
+      server = [[GSHTTPServer alloc] initWithAddress: host port: 0];
+      [server setWorkers: (workers == 0) ? 4 : workers];
+      [server setReusePort: [defs boolForKey: @"ReusePort"]];
+      [server setDelegate: AUTORELEASE([Responder new])];
+      if ([server start] == NO)
+	{
+	  GSPrintf(stderr, @"httpload: unable to start server\n");
+	  exit(EXIT_FAILURE);
+	}
+      port = [server port];
+    }
+
+  memset(&address, '\0', sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons((uint16_t)port);
+  if (inet_pton(AF_INET, [host UTF8String], &address.sin_addr) != 1)
+    {
+      GSPrintf(stderr, @"httpload: '%@' is not an IPv4 address\n", host);
+      exit(EXIT_FAILURE);
+    }
+
+  req = [NSString stringWithFormat: @"GET %@ HTTP/1.1\r\nHost: %@:%ld\r\n"
+    @"User-Agent: httpload\r\n\r\n", path, host, (long)port];
+  requestLength = [req length];
+  m = [NSMutableData dataWithCapacity: requestLength * depth];
+  for (i = 0; i < depth; i++)
+    {
+      [m appendBytes: [req UTF8String] length: requestLength];
+    }
+  batch = RETAIN(m);
+
+  done = [[NSConditionLock alloc] initWithCondition: 0];
+  loader = AUTORELEASE([Loader new]);
+  start = [NSDate date];
+  for (i = 0; i < connections; i++)
+    {
+      [NSThread detachNewThreadSelector: @selector(run:)
+			       toTarget: loader
+			     withObject: nil];
+    }
+  [done lockWhenCondition: connections];
+  [done unlock];
+  elapsed = -[start timeIntervalSinceNow];
+
+  GSPrintf(stdout, @"%lu requests on %lu connections (pipeline %lu)"
+    @" in %.3f seconds: %.0f requests/sec, %lu failures\n",
+    (unsigned long)completed, (unsigned long)connections,
+    (unsigned long)depth, elapsed,
+    elapsed > 0.0 ? completed / elapsed : 0.0, (unsigned long)failures);
+  if (server != nil)
+    {
+      GSPrintf(stdout, @"server: %@\n", [server statistics]);
+      [server stop];
+      RELEASE(server);
+    }
+  [pool release];
+  return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}